@@ -35,6 +35,8 @@
 
 namespace itk
 {
+template< typename TPixel, unsigned int VImageDimension >
+class VectorImage;
 
 /** \class ImageSource
  *  \brief Base class for all process objects that output image data.
@@ -367,10 +369,17 @@ protected:
   struct ThreadStruct
   {
     Pointer Filter;
+    PipelineProfiler::ParallelSection * ProfilerSection{ nullptr };
   };
 
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Return the size of the pixels of the outputs of type TOutputImage. */
+  double EstimateOutputMemoryPerPixel() const override;
+
+  /** Return the size of the buffers of the outputs of type TOutputImage. */
+  SizeValueType GetOutputBulkDataSize() const override;
+
   /** Whether to use classic multi-threading infrastructure (OFF by default).
    * Classic multi-threading uses derived class' ImageRegionSplitter,
    * thus enabling custom region splitting methods. */
@@ -379,6 +388,25 @@ protected:
   itkBooleanMacro(DynamicMultiThreading);
 
   bool m_DynamicMultiThreading;
+
+private:
+  /** Size of a pixel of an image, or 0 if the image type is not known. */
+  template< typename TPixel, unsigned int VImageDimension >
+  static double GetMemorySizePerPixel( const Image< TPixel, VImageDimension > * )
+  {
+    return sizeof( TPixel );
+  }
+
+  template< typename TPixel, unsigned int VImageDimension >
+  static double GetMemorySizePerPixel( const VectorImage< TPixel, VImageDimension > *image )
+  {
+    return sizeof( TPixel ) * image->GetNumberOfComponentsPerPixel();
+  }
+
+  static double GetMemorySizePerPixel( const DataObject * )
+  {
+    return 0.0;
+  }
 };
 } // end namespace itk
 
@@ -76,6 +76,42 @@ ImageSource< TOutputImage >
   return TOutputImage::New().GetPointer();
 }
 
+template< typename TOutputImage >
+double
+ImageSource< TOutputImage >
+::EstimateOutputMemoryPerPixel() const
+{
+  double memory = 0.0;
+
+  for ( DataObjectPointerArraySizeType i = 0; i < this->GetNumberOfIndexedOutputs(); ++i )
+    {
+    const auto * output = dynamic_cast< const TOutputImage * >( this->ProcessObject::GetOutput(i) );
+    if ( output )
+      {
+      memory += Self::GetMemorySizePerPixel( output );
+      }
+    }
+  return memory;
+}
+
+template< typename TOutputImage >
+SizeValueType
+ImageSource< TOutputImage >
+::GetOutputBulkDataSize() const
+{
+  double size = 0.0;
+
+  for ( DataObjectPointerArraySizeType i = 0; i < this->GetNumberOfIndexedOutputs(); ++i )
+    {
+    const auto * output = dynamic_cast< const TOutputImage * >( this->ProcessObject::GetOutput(i) );
+    if ( output )
+      {
+      size += Self::GetMemorySizePerPixel( output ) * output->GetBufferedRegion().GetNumberOfPixels();
+      }
+    }
+  return static_cast< SizeValueType >( size );
+}
+
 template< typename TOutputImage >
 typename ImageSource< TOutputImage >::OutputImageType *
 ImageSource< TOutputImage >
@@ -205,8 +241,10 @@ void
 ImageSource<TOutputImage>
 ::ClassicMultiThread(ThreadFunctionType callbackFunction)
 {
+  PipelineProfiler::ParallelSection profilerSection;
   ThreadStruct str;
   str.Filter = this;
+  str.ProfilerSection = &profilerSection;
 
   const OutputImageType *outputPtr = this->GetOutput();
   const ImageRegionSplitterBase * splitter = this->GetImageRegionSplitter();
@@ -300,6 +338,7 @@ ImageSource< TOutputImage >
 
   if ( threadId < total )
     {
+    PipelineProfiler::WorkUnitScope profilerScope( str->ProfilerSection );
     str->Filter->ThreadedGenerateData(splitRegion, threadId);
 #if defined( ITKV4_COMPATIBILITY )
     if ( str->Filter->GetAbortGenerateData() )
@@ -153,6 +153,14 @@ protected:
    * \sa ProcessObject::ReleaseInputs() */
   void ReleaseInputs() override;
 
+  /** A filter running in place reuses the buffer of its input, when the
+   * input is produced by an upstream filter for the same requested
+   * region, so its output does not add to the memory of the pipeline. */
+  double EstimateOutputMemoryPerPixel() const override;
+
+  /** The output of a filter that ran in place does not hold its own buffer. */
+  SizeValueType GetOutputBulkDataSize() const override;
+
   /** This methods should only be called during the GenerateData phase
    *  of the pipeline. This method return true if the input image's
    *  bulk data is the same as the output image's data.
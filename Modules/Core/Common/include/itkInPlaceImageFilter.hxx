@@ -141,6 +141,32 @@ InPlaceImageFilter< TInputImage, TOutputImage >
   return IsSame<TInputImage,TOutputImage>();
 }
 
+template< typename TInputImage, typename TOutputImage >
+double
+InPlaceImageFilter< TInputImage, TOutputImage >
+::EstimateOutputMemoryPerPixel() const
+{
+  const DataObject *input = this->ProcessObject::GetInput(0);
+  if ( this->GetInPlace() && this->CanRunInPlace() && this->GetNumberOfIndexedOutputs() == 1
+       && input != nullptr && input->GetSource() )
+    {
+    return 0.0;
+    }
+  return Superclass::EstimateOutputMemoryPerPixel();
+}
+
+template< typename TInputImage, typename TOutputImage >
+SizeValueType
+InPlaceImageFilter< TInputImage, TOutputImage >
+::GetOutputBulkDataSize() const
+{
+  if ( this->m_RunningInPlace && this->GetNumberOfIndexedOutputs() == 1 )
+    {
+    return 0;
+    }
+  return Superclass::GetOutputBulkDataSize();
+}
+
 template< typename TInputImage, typename TOutputImage >
 void
 InPlaceImageFilter< TInputImage, TOutputImage >
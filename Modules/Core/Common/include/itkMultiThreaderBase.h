@@ -35,6 +35,7 @@
 #include "itkImageRegion.h"
 #include "itkImageIORegion.h"
 #include "itkSingletonMacro.h"
+#include "itkPipelineProfiler.h"
 #include <functional>
 #include <thread>
 
@@ -363,6 +364,7 @@ protected:
     ProcessObject* filter;
     std::thread::id callingThread;
     std::atomic<SizeValueType> progress;
+    PipelineProfiler::ParallelSection* profilerSection;
   };
 
   static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION ParallelizeArrayHelper(void *arg);
@@ -377,6 +379,7 @@ protected:
     std::thread::id callingThread;
     SizeValueType pixelCount;
     std::atomic<SizeValueType> pixelProgress;
+    PipelineProfiler::ParallelSection* profilerSection;
   };
 
   static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION ParallelizeImageRegionHelper(void *arg);
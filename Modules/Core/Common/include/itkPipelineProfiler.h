@@ -0,0 +1,286 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkPipelineProfiler_h
+#define itkPipelineProfiler_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkIntTypes.h"
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+class ProcessObject;
+
+/** \class PipelineProfiler
+ * \brief Record the execution of the filters of all the pipelines.
+ *
+ * Once a profiler is set with SetGlobalProfiler(), every execution of
+ * ProcessObject::GenerateData() from the pipeline, and every work unit
+ * run by a MultiThreaderBase on behalf of a filter, is recorded without
+ * any change to the code of the filters or of the application:
+ *
+ * \code
+ * itk::PipelineProfiler::Pointer profiler = itk::PipelineProfiler::New();
+ * itk::PipelineProfiler::SetGlobalProfiler( profiler );
+ * writer->Update();
+ * itk::PipelineProfiler::SetGlobalProfiler( nullptr );
+ * profiler->Report( std::cout );
+ * profiler->WriteChromeTrace( "pipeline.json" );
+ * \endcode
+ *
+ * For each filter, the profiler accumulates:
+ * - the number of executions, i.e. the number of streamed pieces;
+ * - the wall time of GenerateData(), with and without the time spent in
+ *   the filters of a mini-pipeline run by this filter;
+ * - the processor time of the process during GenerateData(), which
+ *   includes the time of all the threads;
+ * - the bytes of bulk data allocated for its outputs, see
+ *   ProcessObject::GetOutputBulkDataSize();
+ * - the number of work units and their utilization, the sum of the wall
+ *   times of the work units divided by the number of work units times the
+ *   wall time of the multi-threaded sections. A low utilization shows
+ *   unbalanced work units or too few threads for the work units.
+ *
+ * The upstream filters are updated before GenerateData() is called, so
+ * the time of a filter does not include the time of its inputs.
+ *
+ * WriteChromeTrace() writes the executions and the work units in the
+ * Trace Event Format, which can be loaded in chrome://tracing or in
+ * Perfetto to find the bottleneck of a pipeline.
+ *
+ * When no profiler is set, the cost in the pipeline is one atomic load per
+ * GenerateData() and per multi-threaded section.
+ *
+ * \sa TimeProbesCollectorBase
+ * \sa MemoryProbesCollectorBase
+ *
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT PipelineProfiler:public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PipelineProfiler);
+
+  /** Standard class type aliases. */
+  using Self = PipelineProfiler;
+  using Superclass = Object;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PipelineProfiler, Object);
+
+  using ClockType = std::chrono::steady_clock;
+  using TimePointType = ClockType::time_point;
+
+  /** Set/Get the profiler recording all the pipelines. Set nullptr, the
+   * default, to stop recording. */
+  static void SetGlobalProfiler(Self *profiler);
+  static Pointer GetGlobalProfiler();
+
+  /** Accumulated statistics of one filter. Times are in seconds. */
+  struct FilterRecord
+  {
+    std::string   Name;
+    SizeValueType NumberOfExecutions{ 0 };
+    double        WallTime{ 0.0 };
+    double        SelfWallTime{ 0.0 };
+    double        ProcessorTime{ 0.0 };
+    SizeValueType AllocatedBytes{ 0 };
+    SizeValueType NumberOfWorkUnits{ 0 };
+    double        WorkUnitTime{ 0.0 };
+    double        WorkUnitCapacity{ 0.0 };
+
+    /** Fraction of the capacity of the work units spent working. */
+    double GetWorkUnitUtilization() const
+    {
+      return WorkUnitCapacity > 0.0 ? WorkUnitTime / WorkUnitCapacity : 0.0;
+    }
+  };
+  using FilterRecordContainer = std::vector< FilterRecord >;
+
+  /** Get the statistics of the filters, in the order of their first
+   * execution. The name of a filter is its object name if set, otherwise
+   * its class name followed by the rank of the instance among the profiled
+   * filters of the same class. */
+  FilterRecordContainer GetFilterRecords() const;
+
+  /** Print the statistics of the filters, sorted by decreasing self wall
+   * time. */
+  void Report(std::ostream & os = std::cout) const;
+
+  /** Write the recorded executions and work units as a Chrome trace. */
+  void WriteChromeTrace(std::ostream & os) const;
+  void WriteChromeTrace(const std::string & fileName) const;
+
+  /** Discard all the records. */
+  void Reset();
+
+  /** Set/Get the maximum number of events kept for the trace. The
+   * statistics of the filters are still accumulated when it is reached.
+   * Default is one million. */
+  itkSetMacro(MaximumNumberOfTraceEvents, SizeValueType);
+  itkGetConstMacro(MaximumNumberOfTraceEvents, SizeValueType);
+
+  /** \class FilterScope
+   * Record one execution of a filter, from its construction to its
+   * destruction. Used by ProcessObject::UpdateOutputData(). */
+  class ITKCommon_EXPORT FilterScope
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(FilterScope);
+
+    explicit FilterScope(const ProcessObject *filter);
+    ~FilterScope();
+
+    /** Whether a profiler records this execution. */
+    bool IsRecording() const
+    {
+      return m_Profiler.IsNotNull();
+    }
+
+    void SetAllocatedBytes(SizeValueType bytes)
+    {
+      m_AllocatedBytes = bytes;
+    }
+
+  private:
+    Pointer             m_Profiler;
+    const ProcessObject *m_Filter;
+    FilterScope         *m_Parent;
+    TimePointType       m_Start;
+    std::clock_t        m_StartProcessorTime;
+    double              m_ChildrenWallTime{ 0.0 };
+    SizeValueType       m_AllocatedBytes{ 0 };
+  };
+
+  /** \class ParallelSection
+   * Record one multi-threaded section run by a MultiThreaderBase on behalf
+   * of the filter executing in the calling thread. */
+  class ITKCommon_EXPORT ParallelSection
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(ParallelSection);
+
+    ParallelSection();
+    ~ParallelSection();
+
+    /** Whether a profiler records this section. */
+    bool IsRecording() const
+    {
+      return m_Profiler.IsNotNull();
+    }
+
+    /** Record a work unit run by any thread. */
+    void AddWorkUnit(const TimePointType & start, const TimePointType & end);
+
+  private:
+    Pointer             m_Profiler;
+    const ProcessObject *m_Filter{ nullptr };
+    TimePointType       m_Start;
+    std::mutex          m_Mutex;
+    SizeValueType       m_NumberOfWorkUnits{ 0 };
+    double              m_WorkUnitTime{ 0.0 };
+  };
+
+  /** \class WorkUnitScope
+   * Record one work unit of a ParallelSection, from its construction to its
+   * destruction. Does nothing when the section is nullptr or is not
+   * recorded. */
+  class WorkUnitScope
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(WorkUnitScope);
+
+    explicit WorkUnitScope(ParallelSection *section):
+      m_Section( section != nullptr && section->IsRecording() ? section : nullptr )
+    {
+      if ( m_Section )
+        {
+        m_Start = ClockType::now();
+        }
+    }
+
+    ~WorkUnitScope()
+    {
+      if ( m_Section )
+        {
+        m_Section->AddWorkUnit( m_Start, ClockType::now() );
+        }
+    }
+
+  private:
+    ParallelSection *m_Section;
+    TimePointType    m_Start;
+  };
+
+protected:
+  PipelineProfiler();
+  ~PipelineProfiler() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  struct TraceEvent
+  {
+    SizeValueType RecordIndex;
+    bool          IsWorkUnit;
+    double        Start;
+    double        Duration;
+    unsigned int  Thread;
+    SizeValueType AllocatedBytes;
+  };
+
+  FilterRecord & GetFilterRecord(const ProcessObject *filter, SizeValueType & recordIndex);
+
+  unsigned int GetThreadNumber(std::thread::id thread);
+
+  double GetTimeSinceStart(const TimePointType & time) const;
+
+  void AddTraceEvent(const TraceEvent & event);
+
+  void RecordExecution(const ProcessObject *filter, const TimePointType & start, const TimePointType & end,
+                       double selfWallTime, double processorTime, SizeValueType allocatedBytes);
+
+  void RecordWorkUnit(const ProcessObject *filter, const TimePointType & start, const TimePointType & end);
+
+  void RecordParallelSection(const ProcessObject *filter, SizeValueType numberOfWorkUnits, double workUnitTime,
+                             double wallTime);
+
+  mutable std::mutex                                  m_Mutex;
+  TimePointType                                       m_StartTime;
+  std::map< SizeValueType, SizeValueType >            m_RecordIndices;
+  std::map< std::string, SizeValueType >              m_NumberOfInstancesPerClass;
+  FilterRecordContainer                               m_Records;
+  std::map< std::thread::id, unsigned int >           m_ThreadNumbers;
+  std::vector< TraceEvent >                           m_TraceEvents;
+  SizeValueType                                       m_MaximumNumberOfTraceEvents;
+  SizeValueType                                       m_NumberOfDroppedTraceEvents;
+};
+} // end namespace itk
+
+#endif
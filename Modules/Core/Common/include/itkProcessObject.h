@@ -470,10 +470,34 @@ public:
    */
   virtual void PrepareOutputs();
 
+  /** Estimate the number of bytes of bulk data allocated by the pipeline
+   * ending at this process object, per pixel of the requested region of
+   * its outputs. This is the sum of EstimateOutputMemoryPerPixel() over
+   * this process object and all the process objects upstream of it, each
+   * one counted once. Data objects without a source are not counted,
+   * since their memory does not depend on the requested region.
+   *
+   * The estimate is used to choose the size of the streamed pieces, e.g.
+   * by ImageFileWriter::SetMaximumMemoryBytes(). It ignores the padding
+   * of the requested regions by neighborhood filters, and the memory of
+   * filters that cannot stream. */
+  double EstimateMemoryPerPixel() const;
+
 protected:
   ProcessObject();
   ~ProcessObject() override;
 
+  /** Estimate the number of bytes of bulk data allocated by this process
+   * object alone, per pixel of the requested region of its outputs. The
+   * default returns 0. ImageSource returns the size of the pixels of its
+   * outputs. Filters that allocate internal images should add their size. */
+  virtual double EstimateOutputMemoryPerPixel() const;
+
+  /** Number of bytes of bulk data of the outputs generated by the last
+   * execution of GenerateData(), not shared with the inputs. Recorded by
+   * PipelineProfiler. The default returns 0. */
+  virtual SizeValueType GetOutputBulkDataSize() const;
+
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
   //
@@ -778,6 +802,8 @@ private:
   DataObjectIdentifierType MakeNameFromIndex( DataObjectPointerArraySizeType ) const;
   DataObjectPointerArraySizeType MakeIndexFromName( const DataObjectIdentifierType & ) const;
 
+  double EstimateMemoryPerPixel( std::set< const ProcessObject * > & visited ) const;
+
   /** STL map to store the named inputs and outputs */
   using DataObjectPointerMap = std::map< DataObjectIdentifierType, DataObjectPointer >;
 
@@ -813,8 +839,14 @@ private:
   /** Memory management ivars */
   bool m_ReleaseDataBeforeUpdateFlag;
 
+  /** Identifier of this process object in the records of the
+   * PipelineProfiler. Unlike the address of the process object, it is
+   * never reused by another process object. */
+  SizeValueType m_ProfilerIdentifier;
+
   /** Friends of ProcessObject */
   friend class DataObject;
+  friend class PipelineProfiler;
 
   friend class DataObjectConstIterator;
   friend class InputDataObjectConstIterator;
@@ -0,0 +1,136 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkStreamingCacheImageFilter_h
+#define itkStreamingCacheImageFilter_h
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+/** \class StreamingCacheImageFilter
+ * \brief Keep the last streamed piece to avoid recomputing the overlap with the next one.
+ *
+ * When a pipeline is streamed with StreamingImageFilter, each filter that
+ * needs a neighborhood, e.g. a smoothing or a morphological filter, enlarges
+ * the region it requests from its input by its radius. The upstream part of
+ * the pipeline therefore computes the halo shared by two consecutive pieces
+ * twice.
+ *
+ * This filter passes its input through, and keeps its last output. When the
+ * next requested region overlaps the kept region, it requests from its input
+ * only the part that is not already available, and copies the overlap from
+ * the kept region. Insert it just before the neighborhood filters of a
+ * streamed pipeline:
+ *
+ * \code
+ * reader -> StreamingCacheImageFilter -> MedianImageFilter
+ *        -> StreamingCacheImageFilter -> GradientMagnitudeImageFilter
+ *        -> StreamingImageFilter
+ * \endcode
+ *
+ * The remaining part must be a single region, which is the case when the
+ * pieces are slabs along one dimension, processed in order, as produced by
+ * the default ImageRegionSplitterSlowDimension of StreamingImageFilter.
+ * Otherwise the whole requested region is requested from the input.
+ *
+ * The kept region is a copy owned by the filter, so the output may be
+ * modified in place downstream. Only the rows that the next piece is
+ * expected to share with the current one are kept: their number is the
+ * overlap between the last two requested regions. The first piece of a
+ * sequence is kept entirely, since that overlap is not known yet.
+ *
+ * The kept region is discarded when the upstream pipeline is modified, or
+ * when ReleaseCache() is called.
+ *
+ * \sa StreamingImageFilter
+ *
+ * \ingroup ITKSystemObjects
+ * \ingroup DataProcessing
+ * \ingroup ITKCommon
+ */
+template< typename TImage >
+class ITK_TEMPLATE_EXPORT StreamingCacheImageFilter:public ImageToImageFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(StreamingCacheImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = StreamingCacheImageFilter;
+  using Superclass = ImageToImageFilter< TImage, TImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(StreamingCacheImageFilter, ImageToImageFilter);
+
+  /** Some type alias for the input and output. */
+  using ImageType = TImage;
+  using ImagePointer = typename ImageType::Pointer;
+  using RegionType = typename ImageType::RegionType;
+  using PixelContainerType = typename ImageType::PixelContainer;
+
+  /** Dimension of the image. */
+  static constexpr unsigned int ImageDimension = ImageType::ImageDimension;
+
+  /** Discard the kept region. */
+  void ReleaseCache();
+
+  /** Number of pixels copied from the kept region instead of being
+   * requested from the input, since the construction of the filter or
+   * the last call to ReleaseCache(). */
+  itkGetConstMacro(NumberOfReusedPixels, SizeValueType);
+
+protected:
+  StreamingCacheImageFilter();
+  ~StreamingCacheImageFilter() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Request from the input only the part of the output requested region
+   * that is not kept. */
+  void GenerateInputRequestedRegion() override;
+
+  void GenerateData() override;
+
+  /** Compute the part of \c requested that is outside of \c kept. Return
+   * false if that part is empty or is not a single region. */
+  static bool ComputeMissingRegion(const RegionType & requested, const RegionType & kept, RegionType & missing);
+
+  /** Compute the part of \c requested to keep for the next request, given
+   * the \c previous requested region. Return false if nothing is to be
+   * kept. */
+  static bool ComputeKeptRegion(const RegionType & requested, const RegionType & previous, RegionType & kept);
+
+private:
+  ImagePointer     m_Cache;
+  ModifiedTimeType m_CachePipelineMTime;
+  ModifiedTimeType m_CacheFilterMTime;
+  bool             m_UseCache;
+  RegionType       m_MissingRegion;
+  RegionType       m_PreviousRequestedRegion;
+  SizeValueType    m_NumberOfReusedPixels;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkStreamingCacheImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,224 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkStreamingCacheImageFilter_hxx
+#define itkStreamingCacheImageFilter_hxx
+#include "itkStreamingCacheImageFilter.h"
+#include "itkImageAlgorithm.h"
+
+namespace itk
+{
+template< typename TImage >
+StreamingCacheImageFilter< TImage >
+::StreamingCacheImageFilter() :
+  m_CachePipelineMTime( 0 ),
+  m_CacheFilterMTime( 0 ),
+  m_UseCache( false ),
+  m_NumberOfReusedPixels( 0 )
+{
+}
+
+template< typename TImage >
+void
+StreamingCacheImageFilter< TImage >
+::ReleaseCache()
+{
+  m_Cache = nullptr;
+  m_UseCache = false;
+  m_PreviousRequestedRegion = RegionType();
+  m_NumberOfReusedPixels = 0;
+}
+
+template< typename TImage >
+bool
+StreamingCacheImageFilter< TImage >
+::ComputeMissingRegion(const RegionType & requested, const RegionType & kept, RegionType & missing)
+{
+  RegionType overlap = requested;
+  if ( !overlap.Crop(kept) )
+    {
+    return false;
+    }
+
+  // The overlap must cover the requested region in all the dimensions but one.
+  unsigned int splitDimension = ImageDimension;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    if ( overlap.GetSize(d) != requested.GetSize(d) )
+      {
+      if ( splitDimension != ImageDimension )
+        {
+        return false;
+        }
+      splitDimension = d;
+      }
+    }
+  if ( splitDimension == ImageDimension )
+    {
+    return false;
+    }
+
+  const unsigned int d = splitDimension;
+  missing = requested;
+  missing.SetSize( d, requested.GetSize(d) - overlap.GetSize(d) );
+  if ( overlap.GetIndex(d) == requested.GetIndex(d) )
+    {
+    missing.SetIndex( d, requested.GetIndex(d) + static_cast< IndexValueType >( overlap.GetSize(d) ) );
+    }
+  else if ( overlap.GetUpperIndex()[d] != requested.GetUpperIndex()[d] )
+    {
+    // The overlap is in the middle of the requested region.
+    return false;
+    }
+  return true;
+}
+
+template< typename TImage >
+bool
+StreamingCacheImageFilter< TImage >
+::ComputeKeptRegion(const RegionType & requested, const RegionType & previous, RegionType & kept)
+{
+  // Without a previous request, the overlap with the next one is unknown.
+  if ( previous.GetNumberOfPixels() == 0 )
+    {
+    kept = requested;
+    return true;
+    }
+
+  // The next request is expected to overlap this one as much as this one
+  // overlaps the previous one, on the side of the new rows.
+  RegionType added;
+  if ( !Self::ComputeMissingRegion( requested, previous, added ) )
+    {
+    return false;
+    }
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    if ( added.GetSize(d) != requested.GetSize(d) )
+      {
+      const SizeValueType overlapSize = requested.GetSize(d) - added.GetSize(d);
+      kept = requested;
+      kept.SetSize( d, overlapSize );
+      if ( added.GetIndex(d) != requested.GetIndex(d) )
+        {
+        kept.SetIndex( d, requested.GetUpperIndex()[d] - static_cast< IndexValueType >( overlapSize ) + 1 );
+        }
+      return true;
+      }
+    }
+  return false;
+}
+
+template< typename TImage >
+void
+StreamingCacheImageFilter< TImage >
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * input = const_cast< ImageType * >( this->GetInput() );
+  if ( !input )
+    {
+    return;
+    }
+
+  // A kept region is only valid for the same upstream pipeline. An input
+  // without a source may be modified in place, so it is never cached.
+  if ( input->GetSource() == nullptr || input->GetPipelineMTime() != m_CachePipelineMTime
+       || this->GetMTime() != m_CacheFilterMTime )
+    {
+    m_Cache = nullptr;
+    m_PreviousRequestedRegion = RegionType();
+    }
+
+  m_UseCache = m_Cache.IsNotNull() && Self::ComputeMissingRegion( this->GetOutput()->GetRequestedRegion(),
+                                                                  m_Cache->GetBufferedRegion(), m_MissingRegion );
+  if ( m_UseCache )
+    {
+    input->SetRequestedRegion(m_MissingRegion);
+    }
+}
+
+template< typename TImage >
+void
+StreamingCacheImageFilter< TImage >
+::GenerateData()
+{
+  ImageType *       output = this->GetOutput();
+  const ImageType * input = this->GetInput();
+
+  this->AllocateOutputs();
+
+  const RegionType outputRegion = output->GetRequestedRegion();
+  if ( m_UseCache )
+    {
+    RegionType keptRegion = outputRegion;
+    keptRegion.Crop( m_Cache->GetBufferedRegion() );
+    ImageAlgorithm::Copy( m_Cache.GetPointer(), output, keptRegion, keptRegion );
+    ImageAlgorithm::Copy( input, output, m_MissingRegion, m_MissingRegion );
+    m_NumberOfReusedPixels += keptRegion.GetNumberOfPixels();
+    }
+  else
+    {
+    ImageAlgorithm::Copy( input, output, outputRegion, outputRegion );
+    }
+
+  // Copy the rows shared with the next request. The output buffer is not
+  // shared with the cache, since a downstream filter may run in place.
+  RegionType keptRegion;
+  if ( Self::ComputeKeptRegion( outputRegion, m_PreviousRequestedRegion, keptRegion ) )
+    {
+    if ( m_Cache.IsNull() )
+      {
+      m_Cache = ImageType::New();
+      }
+    m_Cache->CopyInformation( output );
+    m_Cache->SetRegions( keptRegion );
+    m_Cache->Allocate();
+    ImageAlgorithm::Copy( output, m_Cache.GetPointer(), keptRegion, keptRegion );
+    }
+  else
+    {
+    m_Cache = nullptr;
+    }
+  m_PreviousRequestedRegion = outputRegion;
+  m_CachePipelineMTime = input->GetPipelineMTime();
+  m_CacheFilterMTime = this->GetMTime();
+  m_UseCache = false;
+}
+
+template< typename TImage >
+void
+StreamingCacheImageFilter< TImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Kept region: ";
+  if ( m_Cache.IsNotNull() )
+    {
+    os << m_Cache->GetBufferedRegion() << std::endl;
+    }
+  else
+    {
+    os << "(none)" << std::endl;
+    }
+  os << indent << "Number of reused pixels: " << m_NumberOfReusedPixels << std::endl;
+}
+} // end namespace itk
+
+#endif
@@ -36,6 +36,13 @@ namespace itk
  * This filter will produce the entire output as one image, but the upstream
  * filters will do their processing in pieces.
  *
+ * Filters that need a neighborhood enlarge the requested region of each
+ * piece, so the upstream pipeline computes the overlap of consecutive
+ * pieces several times. A StreamingCacheImageFilter inserted in front of
+ * them keeps the overlap between pieces.
+ *
+ * \sa StreamingCacheImageFilter
+ *
  * \ingroup ITKSystemObjects
  * \ingroup DataProcessing
  * \ingroup ITKCommon
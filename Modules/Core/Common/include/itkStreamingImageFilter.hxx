@@ -191,7 +191,10 @@ StreamingImageFilter< TInputImage, TOutputImage >
     // requested region determined by the RegionSplitter (as opposed
     // to what the pipeline might have enlarged it to) is used to
     // copy the regions from the input to output
+    {
+    PipelineProfiler::FilterScope profilerScope(this);
     ImageAlgorithm::Copy( inputPtr, outputPtr, streamRegion, streamRegion );
+    }
 
 
     this->UpdateProgress( static_cast<float>(piece) / static_cast<float>(numDivisions) );
@@ -509,13 +509,15 @@ MultiThreaderBase
 
   if ( firstIndex + 1 < lastIndexPlus1 )
     {
+    PipelineProfiler::ParallelSection profilerSection;
     struct ArrayCallback acParams {
         aFunc,
         firstIndex,
         lastIndexPlus1,
         filter,
         std::this_thread::get_id(),
-        {0} };
+        {0},
+        &profilerSection };
     this->SetSingleMethod(&MultiThreaderBase::ParallelizeArrayHelper, &acParams);
     this->SingleMethodExecute();
     }
@@ -550,6 +552,7 @@ MultiThreaderBase
     afterLast = acParams->lastIndexPlus1;
     }
 
+  PipelineProfiler::WorkUnitScope profilerScope( acParams->profilerSection );
   for ( SizeValueType i = first; i < afterLast; i++ )
     {
     acParams->functor( i );
@@ -586,6 +589,7 @@ MultiThreaderBase
     {
     pixelCount *= size[d];
     }
+  PipelineProfiler::ParallelSection profilerSection;
   struct RegionAndCallback rnc {
       funcP,
       dimension,
@@ -594,7 +598,8 @@ MultiThreaderBase
       filter,
       std::this_thread::get_id(),
       pixelCount,
-      {0} };
+      {0},
+      &profilerSection };
   this->SetSingleMethod(&MultiThreaderBase::ParallelizeImageRegionHelper, &rnc);
   this->SingleMethodExecute();
 
@@ -624,6 +629,7 @@ MultiThreaderBase
 
   if ( threadId < total )
     {
+    PipelineProfiler::WorkUnitScope profilerScope( rnc->profilerSection );
     rnc->functor(&region.GetIndex()[0], &region.GetSize()[0]);
     if (rnc->filter)
       {
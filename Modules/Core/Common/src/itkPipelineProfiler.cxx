@@ -0,0 +1,404 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPipelineProfiler.h"
+#include "itkProcessObject.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+namespace itk
+{
+namespace
+{
+// The profiler is read at each execution of a filter: a plain atomic
+// pointer keeps that cheap, the smart pointer keeps the profiler alive.
+std::atomic< PipelineProfiler * > globalProfiler( nullptr );
+PipelineProfiler::Pointer         globalProfilerHolder;
+std::mutex                        globalProfilerMutex;
+
+// Innermost filter executing in this thread.
+thread_local PipelineProfiler::FilterScope *currentFilterScope = nullptr;
+thread_local const ProcessObject *          currentFilter = nullptr;
+
+void WriteJSONString(std::ostream & os, const std::string & str)
+{
+  os << '"';
+  for ( char c : str )
+    {
+    if ( c == '"' || c == '\\' )
+      {
+      os << '\\' << c;
+      }
+    else if ( static_cast< unsigned char >( c ) < 0x20 )
+      {
+      os << ' ';
+      }
+    else
+      {
+      os << c;
+      }
+    }
+  os << '"';
+}
+}
+
+void
+PipelineProfiler
+::SetGlobalProfiler(Self *profiler)
+{
+  std::lock_guard< std::mutex > lock(globalProfilerMutex);
+  globalProfilerHolder = profiler;
+  globalProfiler = profiler;
+}
+
+PipelineProfiler::Pointer
+PipelineProfiler
+::GetGlobalProfiler()
+{
+  if ( globalProfiler.load() == nullptr )
+    {
+    return nullptr;
+    }
+  std::lock_guard< std::mutex > lock(globalProfilerMutex);
+  return globalProfilerHolder;
+}
+
+PipelineProfiler
+::PipelineProfiler():
+  m_StartTime( ClockType::now() ),
+  m_MaximumNumberOfTraceEvents( 1000000 ),
+  m_NumberOfDroppedTraceEvents( 0 )
+{
+}
+
+void
+PipelineProfiler
+::Reset()
+{
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  m_StartTime = ClockType::now();
+  m_RecordIndices.clear();
+  m_NumberOfInstancesPerClass.clear();
+  m_Records.clear();
+  m_ThreadNumbers.clear();
+  m_TraceEvents.clear();
+  m_NumberOfDroppedTraceEvents = 0;
+}
+
+PipelineProfiler::FilterRecordContainer
+PipelineProfiler
+::GetFilterRecords() const
+{
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  return m_Records;
+}
+
+PipelineProfiler::FilterRecord &
+PipelineProfiler
+::GetFilterRecord(const ProcessObject *filter, SizeValueType & recordIndex)
+{
+  // The records are keyed by the identifier of the filter, since the
+  // address of a deleted filter may be reused by a new one.
+  const auto it = m_RecordIndices.find(filter->m_ProfilerIdentifier);
+  if ( it != m_RecordIndices.end() )
+    {
+    recordIndex = it->second;
+    return m_Records[recordIndex];
+    }
+
+  const std::string className = filter->GetNameOfClass();
+  FilterRecord record;
+  if ( !filter->GetObjectName().empty() )
+    {
+    record.Name = filter->GetObjectName();
+    }
+  else
+    {
+    record.Name = className + " #" + std::to_string( ++m_NumberOfInstancesPerClass[className] );
+    }
+  recordIndex = m_Records.size();
+  m_Records.push_back(record);
+  m_RecordIndices[filter->m_ProfilerIdentifier] = recordIndex;
+  return m_Records.back();
+}
+
+unsigned int
+PipelineProfiler
+::GetThreadNumber(std::thread::id thread)
+{
+  const auto it = m_ThreadNumbers.find(thread);
+  if ( it != m_ThreadNumbers.end() )
+    {
+    return it->second;
+    }
+  const auto number = static_cast< unsigned int >( m_ThreadNumbers.size() );
+  m_ThreadNumbers[thread] = number;
+  return number;
+}
+
+double
+PipelineProfiler
+::GetTimeSinceStart(const TimePointType & time) const
+{
+  return std::chrono::duration< double >( time - m_StartTime ).count();
+}
+
+void
+PipelineProfiler
+::AddTraceEvent(const TraceEvent & event)
+{
+  if ( m_TraceEvents.size() < m_MaximumNumberOfTraceEvents )
+    {
+    m_TraceEvents.push_back(event);
+    }
+  else
+    {
+    ++m_NumberOfDroppedTraceEvents;
+    }
+}
+
+void
+PipelineProfiler
+::RecordExecution(const ProcessObject *filter, const TimePointType & start, const TimePointType & end,
+                  double selfWallTime, double processorTime, SizeValueType allocatedBytes)
+{
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  SizeValueType  recordIndex;
+  FilterRecord & record = this->GetFilterRecord(filter, recordIndex);
+  const double   wallTime = std::chrono::duration< double >( end - start ).count();
+  ++record.NumberOfExecutions;
+  record.WallTime += wallTime;
+  record.SelfWallTime += selfWallTime;
+  record.ProcessorTime += processorTime;
+  record.AllocatedBytes += allocatedBytes;
+
+  this->AddTraceEvent( TraceEvent{ recordIndex, false, this->GetTimeSinceStart(start), wallTime,
+                                   this->GetThreadNumber( std::this_thread::get_id() ), allocatedBytes } );
+}
+
+void
+PipelineProfiler
+::RecordWorkUnit(const ProcessObject *filter, const TimePointType & start, const TimePointType & end)
+{
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  SizeValueType recordIndex;
+  this->GetFilterRecord(filter, recordIndex);
+  this->AddTraceEvent( TraceEvent{ recordIndex, true, this->GetTimeSinceStart(start),
+                                   std::chrono::duration< double >( end - start ).count(),
+                                   this->GetThreadNumber( std::this_thread::get_id() ), 0 } );
+}
+
+void
+PipelineProfiler
+::RecordParallelSection(const ProcessObject *filter, SizeValueType numberOfWorkUnits, double workUnitTime,
+                        double wallTime)
+{
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  SizeValueType  recordIndex;
+  FilterRecord & record = this->GetFilterRecord(filter, recordIndex);
+  record.NumberOfWorkUnits += numberOfWorkUnits;
+  record.WorkUnitTime += workUnitTime;
+  record.WorkUnitCapacity += numberOfWorkUnits * wallTime;
+}
+
+void
+PipelineProfiler
+::Report(std::ostream & os) const
+{
+  FilterRecordContainer records = this->GetFilterRecords();
+  if ( records.empty() )
+    {
+    os << "No filter has been executed" << std::endl;
+    return;
+    }
+  std::stable_sort( records.begin(), records.end(),
+                    [](const FilterRecord & a, const FilterRecord & b) { return a.SelfWallTime > b.SelfWallTime; } );
+
+  std::string::size_type nameWidth = 6;
+  for ( const auto & record : records )
+    {
+    nameWidth = std::max( nameWidth, record.Name.size() );
+    }
+
+  const std::ios::fmtflags flags = os.flags();
+  const std::streamsize    precision = os.precision();
+  os << std::left << std::setw( static_cast< int >( nameWidth ) ) << "Filter" << std::right
+     << std::setw(8) << "Pieces" << std::setw(12) << "Wall (s)" << std::setw(12) << "Self (s)"
+     << std::setw(12) << "CPU (s)" << std::setw(14) << "Bytes" << std::setw(11) << "Work units"
+     << std::setw(13) << "Utilization" << std::endl;
+  os << std::fixed;
+  for ( const auto & record : records )
+    {
+    os << std::left << std::setw( static_cast< int >( nameWidth ) ) << record.Name << std::right
+       << std::setw(8) << record.NumberOfExecutions
+       << std::setprecision(4) << std::setw(12) << record.WallTime << std::setw(12) << record.SelfWallTime
+       << std::setw(12) << record.ProcessorTime << std::setw(14) << record.AllocatedBytes
+       << std::setw(11) << record.NumberOfWorkUnits
+       << std::setprecision(2) << std::setw(13) << record.GetWorkUnitUtilization() << std::endl;
+    }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void
+PipelineProfiler
+::WriteChromeTrace(std::ostream & os) const
+{
+  std::lock_guard< std::mutex > lock(m_Mutex);
+
+  // Times are in microseconds in the Trace Event Format.
+  const std::ios::fmtflags flags = os.flags();
+  const std::streamsize    precision = os.precision();
+  os << std::fixed << std::setprecision(3);
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  for ( const auto & thread : m_ThreadNumbers )
+    {
+    os << ( first ? "\n" : ",\n" );
+    first = false;
+    os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second
+       << ",\"args\":{\"name\":\"Thread " << thread.second << "\"}}";
+    }
+  for ( const auto & event : m_TraceEvents )
+    {
+    os << ( first ? "\n" : ",\n" );
+    first = false;
+    os << "{\"name\":";
+    WriteJSONString( os, m_Records[event.RecordIndex].Name );
+    os << ",\"cat\":\"" << ( event.IsWorkUnit ? "work unit" : "filter" ) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+       << event.Thread << ",\"ts\":" << event.Start * 1e6 << ",\"dur\":" << event.Duration * 1e6;
+    if ( !event.IsWorkUnit )
+      {
+      os << ",\"args\":{\"allocated bytes\":" << event.AllocatedBytes << "}";
+      }
+    os << "}";
+    }
+  os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped events\":" << m_NumberOfDroppedTraceEvents
+     << "}}" << std::endl;
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void
+PipelineProfiler
+::WriteChromeTrace(const std::string & fileName) const
+{
+  std::ofstream file( fileName.c_str() );
+  if ( !file )
+    {
+    itkExceptionMacro(<< "Cannot open " << fileName << " for writing");
+    }
+  this->WriteChromeTrace(file);
+  if ( !file )
+    {
+    itkExceptionMacro(<< "Cannot write " << fileName);
+    }
+}
+
+void
+PipelineProfiler
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  os << indent << "Number of profiled filters: " << m_Records.size() << std::endl;
+  os << indent << "Number of trace events: " << m_TraceEvents.size() << std::endl;
+  os << indent << "Number of dropped trace events: " << m_NumberOfDroppedTraceEvents << std::endl;
+  os << indent << "Maximum number of trace events: " << m_MaximumNumberOfTraceEvents << std::endl;
+}
+
+PipelineProfiler::FilterScope
+::FilterScope(const ProcessObject *filter):
+  m_Profiler( PipelineProfiler::GetGlobalProfiler() ),
+  m_Filter( filter ),
+  m_Parent( nullptr ),
+  m_StartProcessorTime( 0 )
+{
+  if ( m_Profiler )
+    {
+    m_Parent = currentFilterScope;
+    currentFilterScope = this;
+    currentFilter = m_Filter;
+    m_Start = ClockType::now();
+    m_StartProcessorTime = std::clock();
+    }
+}
+
+PipelineProfiler::FilterScope
+::~FilterScope()
+{
+  if ( m_Profiler )
+    {
+    const TimePointType end = ClockType::now();
+    const double processorTime = static_cast< double >( std::clock() - m_StartProcessorTime ) / CLOCKS_PER_SEC;
+    const double wallTime = std::chrono::duration< double >( end - m_Start ).count();
+
+    currentFilterScope = m_Parent;
+    currentFilter = m_Parent ? m_Parent->m_Filter : nullptr;
+    if ( m_Parent )
+      {
+      m_Parent->m_ChildrenWallTime += wallTime;
+      }
+    m_Profiler->RecordExecution( m_Filter, m_Start, end, std::max( wallTime - m_ChildrenWallTime, 0.0 ),
+                                 processorTime, m_AllocatedBytes );
+    }
+}
+
+PipelineProfiler::ParallelSection
+::ParallelSection()
+{
+  if ( currentFilter != nullptr )
+    {
+    m_Profiler = PipelineProfiler::GetGlobalProfiler();
+    if ( m_Profiler )
+      {
+      m_Filter = currentFilter;
+      m_Start = ClockType::now();
+      }
+    }
+}
+
+PipelineProfiler::ParallelSection
+::~ParallelSection()
+{
+  if ( m_Profiler && m_NumberOfWorkUnits > 0 )
+    {
+    const double wallTime = std::chrono::duration< double >( ClockType::now() - m_Start ).count();
+    m_Profiler->RecordParallelSection( m_Filter, m_NumberOfWorkUnits, m_WorkUnitTime, wallTime );
+    }
+}
+
+void
+PipelineProfiler::ParallelSection
+::AddWorkUnit(const TimePointType & start, const TimePointType & end)
+{
+  if ( !m_Profiler )
+    {
+    return;
+    }
+  {
+  std::lock_guard< std::mutex > lock(m_Mutex);
+  ++m_NumberOfWorkUnits;
+  m_WorkUnitTime += std::chrono::duration< double >( end - start ).count();
+  }
+  m_Profiler->RecordWorkUnit( m_Filter, start, end );
+}
+} // end namespace itk
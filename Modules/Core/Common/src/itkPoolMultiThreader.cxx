@@ -37,6 +37,24 @@
 namespace itk
 {
 
+namespace
+{
+// Wait for the work units which are still queued or running, so that
+// nothing they reference goes out of scope when an exception is thrown.
+template< typename TThreadInfo >
+void
+WaitForRemainingWorkUnits(TThreadInfo * threadInfoArray, ThreadIdType numberOfWorkUnits)
+{
+  for ( ThreadIdType i = 0; i < numberOfWorkUnits; ++i )
+    {
+    if ( threadInfoArray[i].Future.valid() )
+      {
+      threadInfoArray[i].Future.wait();
+      }
+    }
+}
+} // end anonymous namespace
+
 PoolMultiThreader::PoolMultiThreader() :
   m_ThreadPool( ThreadPool::GetInstance() )
 {
@@ -174,32 +192,44 @@ PoolMultiThreader
       chunkSize++; // we want slightly bigger chunks to be processed first
       }
 
-    SizeValueType workUnit = 0;
-    for ( SizeValueType i = firstIndex; i < lastIndexPlus1; i += chunkSize )
+    PipelineProfiler::ParallelSection profilerSection;
+    ThreadIdType workUnit = 0;
+    try
       {
-      m_ThreadInfoArray[workUnit++].Future = m_ThreadPool->AddWork(
-        [aFunc]( SizeValueType start, SizeValueType end)
+      for ( SizeValueType i = firstIndex; i < lastIndexPlus1; i += chunkSize )
+        {
+        m_ThreadInfoArray[workUnit].Future = m_ThreadPool->AddWork(
+          [aFunc, &profilerSection]( SizeValueType start, SizeValueType end)
+          {
+            PipelineProfiler::WorkUnitScope profilerScope( &profilerSection );
+            for ( SizeValueType ii = start; ii < end; ii++ )
+            {
+              aFunc( ii );
+            }
+            // make this lambda have the same signature as m_SingleMethod
+            return ITK_THREAD_RETURN_DEFAULT_VALUE;
+          },
+          i,
+          std::min( i + chunkSize, lastIndexPlus1 ) );
+        ++workUnit;
+        }
+      itkAssertOrThrowMacro( workUnit <= m_NumberOfWorkUnits,
+        "Number of work units was somehow miscounted!" );
+      //now wait for all computations to finish
+      for (ThreadIdType i = 0; i < workUnit; i++)
         {
-          for ( SizeValueType ii = start; ii < end; ii++ )
+        m_ThreadInfoArray[i].Future.get();
+        if ( filter )
           {
-            aFunc( ii );
+          filter->UpdateProgress( ( i + 1 ) / float( workUnit ) );
           }
-          // make this lambda have the same signature as m_SingleMethod
-          return ITK_THREAD_RETURN_DEFAULT_VALUE;
-        },
-        i,
-        std::min( i + chunkSize, lastIndexPlus1 ) );
+        }
       }
-    itkAssertOrThrowMacro( workUnit <= m_NumberOfWorkUnits,
-      "Number of work units was somehow miscounted!" );
-    //now wait for all computations to finish
-    for (SizeValueType i = 0; i < workUnit; i++)
+    catch( ... )
       {
-      m_ThreadInfoArray[i].Future.get();
-      if ( filter )
-        {
-        filter->UpdateProgress( ( i + 1 ) / float( workUnit ) );
-        }
+      // the work units record themselves in profilerSection
+      WaitForRemainingWorkUnits( m_ThreadInfoArray, workUnit );
+      throw;
       }
     }
   else if ( firstIndex + 1 == lastIndexPlus1 )
@@ -242,38 +272,47 @@ PoolMultiThreader
       {
       const ImageRegionSplitterBase * splitter = ImageSourceCommon::GetGlobalDefaultSplitter();
       ThreadIdType splitCount = splitter->GetNumberOfSplits( region, m_NumberOfWorkUnits );
+      PipelineProfiler::ParallelSection profilerSection;
       itkAssertOrThrowMacro( splitCount <= m_NumberOfWorkUnits,
         "Split count is greater than number of work units!" );
-      // now wait for all computations to finish
-      for ( ThreadIdType i = 0; i < splitCount; i++ )
+      ThreadIdType workUnit = 0;
+      try
         {
-        ImageIORegion iRegion = region;
-        ThreadIdType total = splitter->GetSplit( i, splitCount, iRegion );
-        if (i < total)
+        for ( ; workUnit < splitCount; workUnit++ )
           {
-          m_ThreadInfoArray[i].Future = m_ThreadPool->AddWork(
-            [funcP, iRegion]()
+          ImageIORegion iRegion = region;
+          ThreadIdType total = splitter->GetSplit( workUnit, splitCount, iRegion );
+          if ( workUnit >= total )
             {
+            itkExceptionMacro( "Could not get work unit " << workUnit
+              << " even though we checked possible number of splits beforehand!" );
+            }
+          m_ThreadInfoArray[workUnit].Future = m_ThreadPool->AddWork(
+            [funcP, iRegion, &profilerSection]()
+            {
+              PipelineProfiler::WorkUnitScope profilerScope( &profilerSection );
               funcP( &iRegion.GetIndex()[0], &iRegion.GetSize()[0] );
               // make this lambda have the same signature as m_SingleMethod
               return ITK_THREAD_RETURN_DEFAULT_VALUE;
             }
             );
           }
-        else
+
+        // now wait for all computations to finish
+        for (ThreadIdType i = 0; i < splitCount; i++)
           {
-          itkExceptionMacro( "Could not get work unit " << i
-            << " even though we checked possible number of splits beforehand!" );
+          m_ThreadInfoArray[i].Future.get();
+          if ( filter )
+            {
+            filter->UpdateProgress( ( i + 1 ) / float( splitCount ) );
+            }
           }
         }
-
-      for (ThreadIdType i = 0; i < splitCount; i++)
+      catch( ... )
         {
-        m_ThreadInfoArray[i].Future.get();
-        if ( filter )
-          {
-          filter->UpdateProgress( ( i + 1 ) / float( splitCount ) );
-          }
+        // the work units record themselves in profilerSection
+        WaitForRemainingWorkUnits( m_ThreadInfoArray, workUnit );
+        throw;
         }
       }
     }
@@ -26,6 +26,8 @@
  *
  *=========================================================================*/
 #include "itkProcessObject.h"
+#include "itkPipelineProfiler.h"
+#include <atomic>
 #include <mutex>
 
 #include <cstdio>
@@ -53,6 +55,8 @@ constexpr char globalIndexNames[ITK_GLOBAL_INDEX_NAMES_NUMBER][ITK_GLOBAL_INDEX_
   "_90", "_91", "_92", "_93", "_94", "_95", "_96", "_97", "_98", "_99"
 };
 
+// Identifier of the next process object, for PipelineProfiler.
+std::atomic< SizeValueType > nextProfilerIdentifier( 0 );
 }
 
 
@@ -81,6 +85,8 @@ ProcessObject
   this->Self::SetMultiThreader(MultiThreaderType::New());
 
   m_ReleaseDataBeforeUpdateFlag = true;
+
+  m_ProfilerIdentifier = nextProfilerIdentifier++;
 }
 
 
@@ -1703,6 +1709,52 @@ ProcessObject
 }
 
 
+double
+ProcessObject
+::EstimateMemoryPerPixel() const
+{
+  std::set< const ProcessObject * > visited;
+  return this->EstimateMemoryPerPixel(visited);
+}
+
+
+double
+ProcessObject
+::EstimateMemoryPerPixel( std::set< const ProcessObject * > & visited ) const
+{
+  if ( !visited.insert(this).second )
+    {
+    return 0.0;
+    }
+
+  double memory = this->EstimateOutputMemoryPerPixel();
+  for ( const auto & input : m_Inputs )
+    {
+    if ( input.second && input.second->GetSource() )
+      {
+      memory += input.second->GetSource()->EstimateMemoryPerPixel(visited);
+      }
+    }
+  return memory;
+}
+
+
+double
+ProcessObject
+::EstimateOutputMemoryPerPixel() const
+{
+  return 0.0;
+}
+
+
+SizeValueType
+ProcessObject
+::GetOutputBulkDataSize() const
+{
+  return 0;
+}
+
+
 void
 ProcessObject
 ::ReleaseInputs()
@@ -1787,7 +1839,12 @@ ProcessObject
 
   try
     {
+    PipelineProfiler::FilterScope profilerScope(this);
     this->GenerateData();
+    if ( profilerScope.IsRecording() )
+      {
+      profilerScope.SetAllocatedBytes( this->GetOutputBulkDataSize() );
+      }
     }
   catch ( ProcessAborted & )
     {
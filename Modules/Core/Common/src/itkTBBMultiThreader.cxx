@@ -98,6 +98,7 @@ TBBMultiThreader
     std::atomic< SizeValueType > progress( 0 );
     std::thread::id callingThread = std::this_thread::get_id();
     tbb::task_scheduler_init tbb_init( m_MaximumNumberOfThreads );
+    PipelineProfiler::ParallelSection profilerSection;
     //we request grain size of 1 and simple_partitioner to ensure there is no chunking
     tbb::parallel_for(
         tbb::blocked_range<SizeValueType>(firstIndex, lastIndexPlus1, 1),
@@ -108,7 +109,10 @@ TBBMultiThreader
         itkAssertInDebugAndIgnoreInReleaseMacro(r.begin() + 1 == r.end());
         MultiThreaderBase::HandleFilterProgress(filter);
 
+        {
+        PipelineProfiler::WorkUnitScope profilerScope( &profilerSection );
         aFunc( r.begin() ); //invoke the function
+        }
 
         if ( filter )
           {
@@ -228,10 +232,14 @@ void TBBMultiThreader
     SizeValueType totalCount = region.GetNumberOfPixels();
     std::thread::id callingThread = std::this_thread::get_id();
     tbb::task_scheduler_init tbb_init( m_MaximumNumberOfThreads );
+    PipelineProfiler::ParallelSection profilerSection;
     tbb::parallel_for(regionSplitter, [&](TBBImageRegionSplitter regionToProcess)
       {
       MultiThreaderBase::HandleFilterProgress(filter);
+      {
+      PipelineProfiler::WorkUnitScope profilerScope( &profilerSection );
       funcP(&regionToProcess.GetIndex()[0], &regionToProcess.GetSize()[0]);
+      }
       if (filter) //filter is provided, update progress
         {
         SizeValueType pixelCount = regionToProcess.GetNumberOfPixels();
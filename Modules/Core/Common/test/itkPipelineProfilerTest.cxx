@@ -0,0 +1,238 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkPipelineProfiler.h"
+#include "itkImageToImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkPoolMultiThreader.h"
+#include "itkTestingMacros.h"
+
+#include <sstream>
+#include <thread>
+
+/*
+ * Profile a streamed pipeline made of a filter with dynamic
+ * multi-threading and a filter with classic multi-threading, and check the
+ * recorded executions, allocated bytes, work units and Chrome trace.
+ * Then check that filters allocated at the address of a deleted filter
+ * get their own records, and that the work units still running when
+ * another one throws are recorded.
+ */
+namespace
+{
+template< typename TImage >
+class PipelineProfilerTestFilter: public itk::ImageToImageFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PipelineProfilerTestFilter);
+
+  using Self = PipelineProfilerTestFilter;
+  using Superclass = itk::ImageToImageFilter< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(PipelineProfilerTestFilter, ImageToImageFilter);
+
+  using Superclass::SetDynamicMultiThreading;
+
+protected:
+  PipelineProfilerTestFilter() = default;
+
+  void DynamicThreadedGenerateData( const typename TImage::RegionType & region ) override
+  {
+    this->Process( region );
+  }
+
+  void ThreadedGenerateData( const typename TImage::RegionType & region, itk::ThreadIdType ) override
+  {
+    this->Process( region );
+  }
+
+private:
+  void Process( const typename TImage::RegionType & region )
+  {
+    itk::ImageRegionConstIterator< TImage > itI( this->GetInput(), region );
+    itk::ImageRegionIterator< TImage > itO( this->GetOutput(), region );
+    for( ; !itI.IsAtEnd(); ++itI, ++itO )
+      {
+      itO.Set( itI.Get() * itI.Get() + 1 );
+      }
+  }
+};
+
+// Throw in the work unit which contains the first index of the image, after
+// the other work units have started.
+template< typename TImage >
+class PipelineProfilerTestThrowingFilter: public itk::ImageToImageFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(PipelineProfilerTestThrowingFilter);
+
+  using Self = PipelineProfilerTestThrowingFilter;
+  using Superclass = itk::ImageToImageFilter< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(PipelineProfilerTestThrowingFilter, ImageToImageFilter);
+
+protected:
+  PipelineProfilerTestThrowingFilter() = default;
+
+  void DynamicThreadedGenerateData( const typename TImage::RegionType & region ) override
+  {
+    if( region.IsInside( this->GetOutput()->GetLargestPossibleRegion().GetIndex() ) )
+      {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+      itkExceptionMacro( "Work unit failure" );
+      }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+  }
+};
+}
+
+int itkPipelineProfilerTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 3;
+  using PixelType = float;
+  using ImageType = itk::Image< PixelType, Dimension >;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill( 24 );
+  image->SetRegions( size );
+  image->Allocate();
+  image->FillBuffer( 2.0f );
+  const itk::SizeValueType numberOfPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  using FilterType = PipelineProfilerTestFilter< ImageType >;
+  FilterType::Pointer dynamicFilter = FilterType::New();
+  dynamicFilter->SetInput( image );
+  dynamicFilter->SetNumberOfWorkUnits( 4 );
+  FilterType::Pointer classicFilter = FilterType::New();
+  classicFilter->SetInput( dynamicFilter->GetOutput() );
+  classicFilter->SetDynamicMultiThreading( false );
+  classicFilter->SetNumberOfWorkUnits( 4 );
+
+  using StreamingFilterType = itk::StreamingImageFilter< ImageType, ImageType >;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( classicFilter->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 3 );
+  streamer->SetObjectName( "Streamer" );
+
+  itk::PipelineProfiler::Pointer profiler = itk::PipelineProfiler::New();
+  EXERCISE_BASIC_OBJECT_METHODS( profiler, PipelineProfiler, Object );
+  TEST_SET_GET_VALUE( 1000000u, profiler->GetMaximumNumberOfTraceEvents() );
+
+  // Nothing is recorded without a global profiler.
+  TEST_EXPECT_TRUE( itk::PipelineProfiler::GetGlobalProfiler().IsNull() );
+  TRY_EXPECT_NO_EXCEPTION( streamer->Update() );
+  TEST_EXPECT_TRUE( profiler->GetFilterRecords().empty() );
+
+  itk::PipelineProfiler::SetGlobalProfiler( profiler );
+  TEST_EXPECT_EQUAL( itk::PipelineProfiler::GetGlobalProfiler(), profiler );
+  dynamicFilter->Modified();
+  TRY_EXPECT_NO_EXCEPTION( streamer->Update() );
+  itk::PipelineProfiler::SetGlobalProfiler( nullptr );
+
+  profiler->Report( std::cout );
+
+  const itk::PipelineProfiler::FilterRecordContainer records = profiler->GetFilterRecords();
+  TEST_EXPECT_EQUAL( records.size(), 3u );
+  TEST_EXPECT_EQUAL( records[0].Name, std::string( "PipelineProfilerTestFilter #1" ) );
+  TEST_EXPECT_EQUAL( records[1].Name, std::string( "PipelineProfilerTestFilter #2" ) );
+  TEST_EXPECT_EQUAL( records[2].Name, std::string( "Streamer" ) );
+  for( unsigned int i = 0; i < 2; ++i )
+    {
+    const itk::PipelineProfiler::FilterRecord & record = records[i];
+    TEST_EXPECT_EQUAL( record.NumberOfExecutions, 3u );
+    TEST_EXPECT_EQUAL( record.AllocatedBytes, numberOfPixels * sizeof( PixelType ) );
+    TEST_EXPECT_TRUE( record.NumberOfWorkUnits >= 3u );
+    TEST_EXPECT_TRUE( record.WallTime > 0.0 );
+    TEST_EXPECT_TRUE( record.SelfWallTime <= record.WallTime );
+    TEST_EXPECT_TRUE( record.WorkUnitTime > 0.0 );
+    TEST_EXPECT_TRUE( record.GetWorkUnitUtilization() > 0.0 );
+    TEST_EXPECT_TRUE( record.GetWorkUnitUtilization() <= 1.0 );
+    }
+  TEST_EXPECT_EQUAL( records[2].NumberOfExecutions, 3u );
+
+  // Events of the filters and of their work units.
+  std::ostringstream trace;
+  profiler->WriteChromeTrace( trace );
+  const std::string traceString = trace.str();
+  TEST_EXPECT_EQUAL( traceString.compare( 0, 15, "{\"traceEvents\":" ), 0 );
+  TEST_EXPECT_TRUE( traceString.find( "\"name\":\"PipelineProfilerTestFilter #2\",\"cat\":\"filter\"" )
+                    != std::string::npos );
+  TEST_EXPECT_TRUE( traceString.find( "\"cat\":\"work unit\"" ) != std::string::npos );
+
+  // The statistics are still accumulated beyond the maximum number of events.
+  profiler->Reset();
+  TEST_EXPECT_TRUE( profiler->GetFilterRecords().empty() );
+  profiler->SetMaximumNumberOfTraceEvents( 2 );
+  itk::PipelineProfiler::SetGlobalProfiler( profiler );
+  dynamicFilter->Modified();
+  TRY_EXPECT_NO_EXCEPTION( streamer->Update() );
+  itk::PipelineProfiler::SetGlobalProfiler( nullptr );
+  TEST_EXPECT_EQUAL( profiler->GetFilterRecords()[1].NumberOfExecutions, 3u );
+  std::ostringstream truncatedTrace;
+  profiler->WriteChromeTrace( truncatedTrace );
+  TEST_EXPECT_TRUE( truncatedTrace.str().find( "\"dropped events\":0" ) == std::string::npos );
+
+  // A filter created after another one is deleted gets its own record, even
+  // when it is allocated at the address of the deleted filter.
+  profiler->Reset();
+  itk::PipelineProfiler::SetGlobalProfiler( profiler );
+  const FilterType * previousAddress = nullptr;
+  unsigned int numberOfReusedAddresses = 0;
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    FilterType::Pointer temporaryFilter = FilterType::New();
+    temporaryFilter->SetInput( image );
+    TRY_EXPECT_NO_EXCEPTION( temporaryFilter->Update() );
+    if( temporaryFilter.GetPointer() == previousAddress )
+      {
+      ++numberOfReusedAddresses;
+      }
+    previousAddress = temporaryFilter.GetPointer();
+    }
+  itk::PipelineProfiler::SetGlobalProfiler( nullptr );
+  std::cout << "Reused filter addresses: " << numberOfReusedAddresses << std::endl;
+  const itk::PipelineProfiler::FilterRecordContainer temporaryRecords = profiler->GetFilterRecords();
+  TEST_EXPECT_EQUAL( temporaryRecords.size(), 3u );
+  for( const auto & record : temporaryRecords )
+    {
+    TEST_EXPECT_EQUAL( record.NumberOfExecutions, 1u );
+    }
+  TEST_EXPECT_EQUAL( temporaryRecords[2].Name, std::string( "PipelineProfilerTestFilter #3" ) );
+
+  // The section of the failed execution waits for all its work units.
+  using ThrowingFilterType = PipelineProfilerTestThrowingFilter< ImageType >;
+  ThrowingFilterType::Pointer throwingFilter = ThrowingFilterType::New();
+  throwingFilter->SetInput( image );
+  throwingFilter->SetMultiThreader( itk::PoolMultiThreader::New() );
+  throwingFilter->SetNumberOfWorkUnits( 4 );
+  profiler->Reset();
+  itk::PipelineProfiler::SetGlobalProfiler( profiler );
+  TRY_EXPECT_EXCEPTION( throwingFilter->Update() );
+  itk::PipelineProfiler::SetGlobalProfiler( nullptr );
+  TEST_EXPECT_EQUAL( profiler->GetFilterRecords().size(), 1u );
+  TEST_EXPECT_EQUAL( profiler->GetFilterRecords()[0].NumberOfWorkUnits, 4u );
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
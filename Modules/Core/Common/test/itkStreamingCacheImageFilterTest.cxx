@@ -0,0 +1,297 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkStreamingCacheImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageAlgorithm.h"
+#include "itkInPlaceImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionSplitterMultidimensional.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Stream a filter that needs a halo along the slow dimension, with and
+ * without a StreamingCacheImageFilter in front of it, and check that the
+ * cache gives the same output while the upstream filter produces each
+ * pixel only once.  Then check that a filter running in place on the output
+ * of the cache does not alter the kept region.
+ */
+namespace
+{
+// Copy the input and count the number of produced pixels.
+template< typename TImage >
+class StreamingCacheTestCountingFilter: public itk::ImageToImageFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(StreamingCacheTestCountingFilter);
+
+  using Self = StreamingCacheTestCountingFilter;
+  using Superclass = itk::ImageToImageFilter< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(StreamingCacheTestCountingFilter, ImageToImageFilter);
+
+  itk::SizeValueType m_NumberOfProducedPixels{ 0 };
+
+protected:
+  StreamingCacheTestCountingFilter() = default;
+
+  void GenerateData() override
+  {
+    this->AllocateOutputs();
+    const typename TImage::RegionType region = this->GetOutput()->GetRequestedRegion();
+    itk::ImageAlgorithm::Copy( this->GetInput(), this->GetOutput(), region, region );
+    m_NumberOfProducedPixels += region.GetNumberOfPixels();
+  }
+};
+
+// Add a constant to the pixels, in place when possible.
+template< typename TImage >
+class StreamingCacheTestInPlaceAddFilter: public itk::InPlaceImageFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(StreamingCacheTestInPlaceAddFilter);
+
+  using Self = StreamingCacheTestInPlaceAddFilter;
+  using Superclass = itk::InPlaceImageFilter< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(StreamingCacheTestInPlaceAddFilter, InPlaceImageFilter);
+
+  bool m_RanInPlace{ false };
+
+protected:
+  StreamingCacheTestInPlaceAddFilter()
+  {
+    this->InPlaceOn();
+  }
+
+  void GenerateData() override
+  {
+    this->AllocateOutputs();
+    m_RanInPlace |= this->GetRunningInPlace();
+    const typename TImage::RegionType region = this->GetOutput()->GetRequestedRegion();
+    itk::ImageRegionConstIterator< TImage > itI( this->GetInput(), region );
+    itk::ImageRegionIteratorWithIndex< TImage > itO( this->GetOutput(), region );
+    for( itI.GoToBegin(), itO.GoToBegin(); !itO.IsAtEnd(); ++itI, ++itO )
+      {
+      itO.Set( itI.Get() + 1000 );
+      }
+  }
+};
+
+// Sum the pixels in a window along the slow dimension, clamped to the image.
+template< typename TImage >
+class StreamingCacheTestWindowSumFilter: public itk::ImageToImageFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(StreamingCacheTestWindowSumFilter);
+
+  using Self = StreamingCacheTestWindowSumFilter;
+  using Superclass = itk::ImageToImageFilter< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+
+  itkNewMacro(Self);
+  itkTypeMacro(StreamingCacheTestWindowSumFilter, ImageToImageFilter);
+
+  static constexpr unsigned int SlowDimension = TImage::ImageDimension - 1;
+  static constexpr itk::IndexValueType Radius = 2;
+
+protected:
+  StreamingCacheTestWindowSumFilter() = default;
+
+  void GenerateInputRequestedRegion() override
+  {
+    Superclass::GenerateInputRequestedRegion();
+    auto * input = const_cast< TImage * >( this->GetInput() );
+    typename TImage::RegionType region = this->GetOutput()->GetRequestedRegion();
+    region.SetIndex( SlowDimension, region.GetIndex( SlowDimension ) - Radius );
+    region.SetSize( SlowDimension, region.GetSize( SlowDimension ) + 2 * Radius );
+    region.Crop( input->GetLargestPossibleRegion() );
+    input->SetRequestedRegion( region );
+  }
+
+  void GenerateData() override
+  {
+    this->AllocateOutputs();
+    const TImage * input = this->GetInput();
+    const typename TImage::RegionType & largestRegion = input->GetLargestPossibleRegion();
+    const itk::IndexValueType first = largestRegion.GetIndex( SlowDimension );
+    const itk::IndexValueType last = largestRegion.GetUpperIndex()[SlowDimension];
+
+    itk::ImageRegionIteratorWithIndex< TImage > it( this->GetOutput(), this->GetOutput()->GetRequestedRegion() );
+    for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      typename TImage::IndexType index = it.GetIndex();
+      const itk::IndexValueType center = index[SlowDimension];
+      typename TImage::PixelType sum = 0;
+      for( itk::IndexValueType k = -Radius; k <= Radius; ++k )
+        {
+        index[SlowDimension] = std::min( std::max( center + k, first ), last );
+        sum += input->GetPixel( index );
+        }
+      it.Set( sum );
+      }
+  }
+};
+}
+
+int itkStreamingCacheImageFilterTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 3;
+  using PixelType = int;
+  using ImageType = itk::Image< PixelType, Dimension >;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 12;
+  size[1] = 9;
+  size[2] = 30;
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( static_cast< PixelType >( index[0] + 13 * index[1] + 127 * index[2] ) );
+    }
+  const itk::SizeValueType numberOfPixels = image->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  using CountingFilterType = StreamingCacheTestCountingFilter< ImageType >;
+  using CacheFilterType = itk::StreamingCacheImageFilter< ImageType >;
+  using WindowSumFilterType = StreamingCacheTestWindowSumFilter< ImageType >;
+  using StreamingFilterType = itk::StreamingImageFilter< ImageType, ImageType >;
+
+  CacheFilterType::Pointer cache = CacheFilterType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( cache, StreamingCacheImageFilter, ImageToImageFilter );
+
+  // Reference: the whole image at once.
+  CountingFilterType::Pointer referenceCounting = CountingFilterType::New();
+  referenceCounting->SetInput( image );
+  WindowSumFilterType::Pointer referenceSum = WindowSumFilterType::New();
+  referenceSum->SetInput( referenceCounting->GetOutput() );
+  TRY_EXPECT_NO_EXCEPTION( referenceSum->Update() );
+  const ImageType * reference = referenceSum->GetOutput();
+
+  auto sameAsReference = [reference]( const ImageType * output ) -> bool
+    {
+    itk::ImageRegionConstIterator< ImageType > itR( reference, reference->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > itO( output, reference->GetLargestPossibleRegion() );
+    for( itR.GoToBegin(), itO.GoToBegin(); !itR.IsAtEnd(); ++itR, ++itO )
+      {
+      if( itR.Get() != itO.Get() )
+        {
+        return false;
+        }
+      }
+    return true;
+    };
+
+  // Streaming without the cache recomputes the halos upstream.
+  CountingFilterType::Pointer counting = CountingFilterType::New();
+  counting->SetInput( image );
+  WindowSumFilterType::Pointer sum = WindowSumFilterType::New();
+  sum->SetInput( counting->GetOutput() );
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput( sum->GetOutput() );
+  streamer->SetNumberOfStreamDivisions( 6 );
+  TRY_EXPECT_NO_EXCEPTION( streamer->Update() );
+  TEST_EXPECT_TRUE( sameAsReference( streamer->GetOutput() ) );
+  std::cout << "Pixels produced upstream without the cache: " << counting->m_NumberOfProducedPixels << std::endl;
+  TEST_EXPECT_TRUE( counting->m_NumberOfProducedPixels > numberOfPixels );
+
+  // With the cache each pixel is produced once.
+  CountingFilterType::Pointer cachedCounting = CountingFilterType::New();
+  cachedCounting->SetInput( image );
+  cache->SetInput( cachedCounting->GetOutput() );
+  WindowSumFilterType::Pointer cachedSum = WindowSumFilterType::New();
+  cachedSum->SetInput( cache->GetOutput() );
+  StreamingFilterType::Pointer cachedStreamer = StreamingFilterType::New();
+  cachedStreamer->SetInput( cachedSum->GetOutput() );
+  cachedStreamer->SetNumberOfStreamDivisions( 6 );
+  TRY_EXPECT_NO_EXCEPTION( cachedStreamer->Update() );
+  TEST_EXPECT_TRUE( sameAsReference( cachedStreamer->GetOutput() ) );
+  std::cout << "Pixels produced upstream with the cache: " << cachedCounting->m_NumberOfProducedPixels << std::endl;
+  TEST_EXPECT_EQUAL( cachedCounting->m_NumberOfProducedPixels, numberOfPixels );
+  TEST_EXPECT_TRUE( cache->GetNumberOfReusedPixels() > 0 );
+
+  // Modifying the upstream pipeline discards the kept region.
+  cachedCounting->Modified();
+  cachedCounting->m_NumberOfProducedPixels = 0;
+  TRY_EXPECT_NO_EXCEPTION( cachedStreamer->Update() );
+  TEST_EXPECT_TRUE( sameAsReference( cachedStreamer->GetOutput() ) );
+  TEST_EXPECT_EQUAL( cachedCounting->m_NumberOfProducedPixels, numberOfPixels );
+
+  // Pieces that do not leave a single missing region fall back to
+  // requesting the whole region.
+  cachedStreamer->SetRegionSplitter( itk::ImageRegionSplitterMultidimensional::New() );
+  cachedStreamer->SetNumberOfStreamDivisions( 8 );
+  cachedCounting->Modified();
+  TRY_EXPECT_NO_EXCEPTION( cachedStreamer->Update() );
+  TEST_EXPECT_TRUE( sameAsReference( cachedStreamer->GetOutput() ) );
+
+  cache->ReleaseCache();
+  TEST_EXPECT_EQUAL( cache->GetNumberOfReusedPixels(), 0u );
+
+  // A filter running in place after the cache overwrites the output of the
+  // cache, but not the kept region.
+  using InPlaceAddFilterType = StreamingCacheTestInPlaceAddFilter< ImageType >;
+  CountingFilterType::Pointer inPlaceReferenceCounting = CountingFilterType::New();
+  inPlaceReferenceCounting->SetInput( image );
+  InPlaceAddFilterType::Pointer inPlaceReferenceAdd = InPlaceAddFilterType::New();
+  inPlaceReferenceAdd->SetInput( inPlaceReferenceCounting->GetOutput() );
+  WindowSumFilterType::Pointer inPlaceReferenceSum = WindowSumFilterType::New();
+  inPlaceReferenceSum->SetInput( inPlaceReferenceAdd->GetOutput() );
+  TRY_EXPECT_NO_EXCEPTION( inPlaceReferenceSum->Update() );
+
+  CountingFilterType::Pointer inPlaceCounting = CountingFilterType::New();
+  inPlaceCounting->SetInput( image );
+  CacheFilterType::Pointer inPlaceCache = CacheFilterType::New();
+  inPlaceCache->SetInput( inPlaceCounting->GetOutput() );
+  InPlaceAddFilterType::Pointer inPlaceAdd = InPlaceAddFilterType::New();
+  inPlaceAdd->SetInput( inPlaceCache->GetOutput() );
+  WindowSumFilterType::Pointer inPlaceSum = WindowSumFilterType::New();
+  inPlaceSum->SetInput( inPlaceAdd->GetOutput() );
+  StreamingFilterType::Pointer inPlaceStreamer = StreamingFilterType::New();
+  inPlaceStreamer->SetInput( inPlaceSum->GetOutput() );
+  inPlaceStreamer->SetNumberOfStreamDivisions( 6 );
+  TRY_EXPECT_NO_EXCEPTION( inPlaceStreamer->Update() );
+
+  TEST_EXPECT_TRUE( inPlaceAdd->m_RanInPlace );
+  TEST_EXPECT_TRUE( inPlaceCache->GetNumberOfReusedPixels() > 0 );
+  TEST_EXPECT_EQUAL( inPlaceCounting->m_NumberOfProducedPixels, numberOfPixels );
+  itk::ImageRegionConstIterator< ImageType > itR( inPlaceReferenceSum->GetOutput(),
+    image->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > itO( inPlaceStreamer->GetOutput(), image->GetLargestPossibleRegion() );
+  for( itR.GoToBegin(), itO.GoToBegin(); !itR.IsAtEnd(); ++itR, ++itO )
+    {
+    if( itR.Get() != itO.Get() )
+      {
+      std::cerr << "The in place filter altered the kept region." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << cache << std::endl;
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
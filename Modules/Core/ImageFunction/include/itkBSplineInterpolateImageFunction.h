@@ -68,6 +68,13 @@ namespace itk
  *               Spline is determined in all dimensions, cannot selectively
  *                  pick dimension for calculating spline.
  *
+ * The evaluation needs working space that depends on the spline order.
+ * The methods without a thread id allocate it on every call. The methods
+ * taking a thread id use arrays preallocated by SetNumberOfWorkUnits(), and
+ * fall back to the allocation when the thread id is out of range. The
+ * WithContext methods use a context created by MakeEvaluationContext(),
+ * which is the preferred way for threaded callers to avoid the allocations.
+ *
  * \sa BSplineDecompositionImageFilter
  *
  * \ingroup ImageFunctions
@@ -133,6 +140,21 @@ public:
   using CovariantVectorType = CovariantVector< OutputType,
                            Self::ImageDimension >;
 
+  /** Evaluation context type alias support */
+  using EvaluationContext = typename Superclass::EvaluationContext;
+  using EvaluationContextPointer = typename Superclass::EvaluationContextPointer;
+
+  /** \class BSplineEvaluationContext
+   * \brief Working space of one thread for the WithContext methods.
+   * \ingroup ITKImageFunction */
+  class BSplineEvaluationContext: public EvaluationContext
+  {
+  public:
+    vnl_matrix< long >   m_EvaluateIndex;
+    vnl_matrix< double > m_Weights;
+    vnl_matrix< double > m_WeightsDerivative;
+  };
+
   /** Evaluate the function at a ContinuousIndex position.
    *
    * Returns the B-Spline interpolated image intensity at a
@@ -285,6 +307,48 @@ public:
     CovariantVectorType & deriv,
     ThreadIdType threadId) const;
 
+  /** Create a context holding the working space of the evaluation. The
+   * context adapts itself if the spline order is changed afterwards. */
+  EvaluationContextPointer MakeEvaluationContext() const override;
+
+  OutputType EvaluateAtContinuousIndexWithContext(const ContinuousIndexType & index,
+                                                  EvaluationContext & context) const override;
+
+  CovariantVectorType EvaluateDerivativeWithContext(const PointType & point,
+                                                    EvaluationContext & context) const
+  {
+    ContinuousIndexType index;
+
+    this->GetInputImage()->TransformPhysicalPointToContinuousIndex(point,
+                                                                   index);
+    return ( this->EvaluateDerivativeAtContinuousIndexWithContext(index, context) );
+  }
+
+  CovariantVectorType EvaluateDerivativeAtContinuousIndexWithContext(
+    const ContinuousIndexType & x,
+    EvaluationContext & context) const;
+
+  void EvaluateValueAndDerivativeWithContext(const PointType & point,
+                                             OutputType & value,
+                                             CovariantVectorType & deriv,
+                                             EvaluationContext & context) const
+  {
+    ContinuousIndexType index;
+
+    this->GetInputImage()->TransformPhysicalPointToContinuousIndex(point,
+                                                                   index);
+    this->EvaluateValueAndDerivativeAtContinuousIndexWithContext(index,
+                                                                 value,
+                                                                 deriv,
+                                                                 context);
+  }
+
+  void EvaluateValueAndDerivativeAtContinuousIndexWithContext(
+    const ContinuousIndexType & x,
+    OutputType & value,
+    CovariantVectorType & deriv,
+    EvaluationContext & context) const;
+
   /** Get/Sets the Spline Order, supports 0th - 5th order splines. The default
    *  is a 3rd order spline. */
   void SetSplineOrder(unsigned int SplineOrder);
@@ -331,6 +395,9 @@ protected:
    *  (hopefully) by looking up pre-allocated working space in arrays that are indexed by thread.
    *  The efficiency gain is likely dependent on the size of the working variables, which are
    *  in-turn dependent on the dimensionality of the image and the order of the spline.
+   *
+   *  The WithContext methods take the working space from a context owned by the caller,
+   *  which avoids both the allocation and the dependency on the number of work units.
    */
   virtual OutputType EvaluateAtContinuousIndexInternal(const ContinuousIndexType & index,
                                                        vnl_matrix< long > & evaluateIndex,
@@ -378,6 +445,10 @@ private:
                             vnl_matrix< double > & weights,
                             unsigned int splineOrder) const;
 
+  /** Return the B-spline context of a context created by MakeEvaluationContext(),
+   *  sized for the current spline order. */
+  BSplineEvaluationContext & GetBSplineEvaluationContext(EvaluationContext & context) const;
+
   /** Precomputation for converting the 1D index of the interpolation
    *  neighborhood to an N-dimensional index. */
   void GeneratePointsToIndex();
@@ -153,6 +153,12 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
 ::EvaluateAtContinuousIndex(const ContinuousIndexType & x,
                             ThreadIdType threadId) const
 {
+  // The arrays are sized by SetNumberOfWorkUnits(), which may not match the
+  // threader of the caller.
+  if ( threadId >= m_NumberOfWorkUnits )
+    {
+    return this->EvaluateAtContinuousIndex(x);
+    }
 // FIXME -- Review this "fix" and ensure it works.
 #if 1
   vnl_matrix< long > *  evaluateIndex = &( m_ThreadedEvaluateIndex[threadId] );
@@ -210,6 +216,10 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
 ::EvaluateDerivativeAtContinuousIndex(const ContinuousIndexType & x,
                                       ThreadIdType threadId) const
 {
+  if ( threadId >= m_NumberOfWorkUnits )
+    {
+    return this->EvaluateDerivativeAtContinuousIndex(x);
+    }
 // FIXME -- Review this "fix" and ensure it works.
 #if 1
   vnl_matrix< long > *  evaluateIndex =   &( m_ThreadedEvaluateIndex[threadId] );
@@ -292,6 +302,11 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
                                               CovariantVectorType & derivativeValue,
                                               ThreadIdType threadId) const
 {
+  if ( threadId >= m_NumberOfWorkUnits )
+    {
+    this->EvaluateValueAndDerivativeAtContinuousIndex(x, value, derivativeValue);
+    return;
+    }
 // FIXME -- Review this "fix" and ensure it works.
 #if 1
   vnl_matrix< long > *  evaluateIndex =   &( m_ThreadedEvaluateIndex[threadId] );
@@ -714,6 +729,92 @@ BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
     }
 }
 
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+typename
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::EvaluationContextPointer
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::MakeEvaluationContext() const
+{
+  auto *context = new BSplineEvaluationContext;
+
+  context->m_EvaluateIndex.set_size(ImageDimension, m_SplineOrder + 1);
+  context->m_Weights.set_size(ImageDimension, m_SplineOrder + 1);
+  context->m_WeightsDerivative.set_size(ImageDimension, m_SplineOrder + 1);
+  return EvaluationContextPointer(context);
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+typename
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::BSplineEvaluationContext &
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::GetBSplineEvaluationContext(EvaluationContext & context) const
+{
+  auto *bsplineContext = dynamic_cast< BSplineEvaluationContext * >( &context );
+  if ( bsplineContext == nullptr )
+    {
+    itkExceptionMacro(<< "The evaluation context was not created by MakeEvaluationContext() of this interpolator.");
+    }
+
+  if ( bsplineContext->m_Weights.cols() != m_SplineOrder + 1 )
+    {
+    bsplineContext->m_EvaluateIndex.set_size(ImageDimension, m_SplineOrder + 1);
+    bsplineContext->m_Weights.set_size(ImageDimension, m_SplineOrder + 1);
+    bsplineContext->m_WeightsDerivative.set_size(ImageDimension, m_SplineOrder + 1);
+    }
+  return *bsplineContext;
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+typename
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::OutputType
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::EvaluateAtContinuousIndexWithContext(const ContinuousIndexType & x,
+                                       EvaluationContext & context) const
+{
+  BSplineEvaluationContext & bsplineContext = this->GetBSplineEvaluationContext(context);
+
+  return this->EvaluateAtContinuousIndexInternal(x,
+                                                 bsplineContext.m_EvaluateIndex,
+                                                 bsplineContext.m_Weights);
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+typename
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::CovariantVectorType
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::EvaluateDerivativeAtContinuousIndexWithContext(const ContinuousIndexType & x,
+                                                 EvaluationContext & context) const
+{
+  BSplineEvaluationContext & bsplineContext = this->GetBSplineEvaluationContext(context);
+
+  return this->EvaluateDerivativeAtContinuousIndexInternal(x,
+                                                           bsplineContext.m_EvaluateIndex,
+                                                           bsplineContext.m_Weights,
+                                                           bsplineContext.m_WeightsDerivative);
+}
+
+template< typename TImageType, typename TCoordRep, typename TCoefficientType >
+void
+BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
+::EvaluateValueAndDerivativeAtContinuousIndexWithContext(const ContinuousIndexType & x,
+                                                         OutputType & value,
+                                                         CovariantVectorType & derivativeValue,
+                                                         EvaluationContext & context) const
+{
+  BSplineEvaluationContext & bsplineContext = this->GetBSplineEvaluationContext(context);
+
+  this->EvaluateValueAndDerivativeAtContinuousIndexInternal(x,
+                                                            value,
+                                                            derivativeValue,
+                                                            bsplineContext.m_EvaluateIndex,
+                                                            bsplineContext.m_Weights,
+                                                            bsplineContext.m_WeightsDerivative);
+}
+
 template< typename TImageType, typename TCoordRep, typename TCoefficientType >
 typename
 BSplineInterpolateImageFunction< TImageType, TCoordRep, TCoefficientType >
@@ -20,6 +20,8 @@
 
 #include "itkImageFunction.h"
 
+#include <memory>
+
 namespace itk
 {
 /** \class InterpolateImageFunction
@@ -34,6 +36,14 @@ namespace itk
  * with scalar pixel types. For images of vector pixel types
  * use VectorInterpolateImageFunctions.
  *
+ * Interpolators that need working space during the evaluation, e.g.
+ * BSplineInterpolateImageFunction, allocate it on every call of
+ * Evaluate(). A multithreaded caller can avoid that cost by creating one
+ * evaluation context per worker with MakeEvaluationContext(), and passing
+ * it to EvaluateWithContext(). A context must not be shared by several
+ * threads at the same time, but it does not depend on the thread id or on
+ * the number of work units, so it can be used with any threader.
+ *
  * \sa VectorInterpolateImageFunction
  * \ingroup ImageFunctions ImageInterpolators
  *
@@ -82,6 +92,27 @@ public:
   /** RealType type alias support */
   using RealType = typename NumericTraits< typename TInputImage::PixelType >::RealType;
 
+  /** \class EvaluationContext
+   * \brief Working space of one thread for the WithContext evaluation methods.
+   *
+   * Interpolators that need working space derive their own context from
+   * this class and override MakeEvaluationContext().
+   * \ingroup ITKImageFunction */
+  class EvaluationContext
+  {
+  public:
+    EvaluationContext() = default;
+    virtual ~EvaluationContext() = default;
+  };
+  using EvaluationContextPointer = std::unique_ptr< EvaluationContext >;
+
+  /** Create a context for EvaluateWithContext() and
+   * EvaluateAtContinuousIndexWithContext(). */
+  virtual EvaluationContextPointer MakeEvaluationContext() const
+  {
+    return EvaluationContextPointer( new EvaluationContext );
+  }
+
   /** Interpolate the image at a point position
    *
    * Returns the interpolated image intensity at a
@@ -124,6 +155,29 @@ public:
     return ( static_cast< RealType >( this->GetInputImage()->GetPixel(index) ) );
   }
 
+  /** Interpolate the image at a point position, using the working space of
+   * a context created by MakeEvaluationContext().
+   *
+   * Returns the same value as Evaluate(). */
+  OutputType EvaluateWithContext(const PointType & point, EvaluationContext & context) const
+  {
+    ContinuousIndexType index;
+
+    this->GetInputImage()->TransformPhysicalPointToContinuousIndex(point, index);
+    return ( this->EvaluateAtContinuousIndexWithContext(index, context) );
+  }
+
+  /** Interpolate the image at a continuous index position, using the working
+   * space of a context created by MakeEvaluationContext().
+   *
+   * Returns the same value as EvaluateAtContinuousIndex(). The default
+   * implementation ignores the context. */
+  virtual OutputType EvaluateAtContinuousIndexWithContext(const ContinuousIndexType & index,
+                                                          EvaluationContext & itkNotUsed(context)) const
+  {
+    return ( this->EvaluateAtContinuousIndex(index) );
+  }
+
 protected:
   InterpolateImageFunction()= default;
   ~InterpolateImageFunction() override = default;
@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTileCachedGradientImageFunction_h
+#define itkTileCachedGradientImageFunction_h
+
+#include "itkImageFunction.h"
+#include "itkCovariantVector.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+/**
+ * \class TileCachedGradientImageFunction
+ * \brief Lazily cache image gradients on the grid, one tile at a time.
+ *
+ * This function wraps a gradient calculator (by default a
+ * CentralDifferenceImageFunction) and stores the gradient it returns at the
+ * physical points of the grid nodes of the input image.  The buffered region
+ * is partitioned into tiles of \c TileSize pixels; a tile is computed the
+ * first time any of its nodes is needed and is then reused by all subsequent
+ * evaluations.  Sparse evaluation therefore only pays for the tiles that are
+ * actually touched, while dense or repeated evaluation never recomputes a
+ * gradient.
+ *
+ * Evaluation at a physical point or continuous index linearly interpolates
+ * the cached node gradients, the same way a precomputed gradient image is
+ * sampled with a LinearInterpolateImageFunction.
+ *
+ * Tiles are computed under a per-tile std::call_once, so a single instance may
+ * be shared by all threads.  The cache is discarded whenever a different input
+ * image is set, the input image has been modified, or ClearCache() is called.
+ *
+ * TOutputType must support addition and multiplication by a scalar, e.g.
+ * CovariantVector or Vector.
+ *
+ * \sa CentralDifferenceImageFunction
+ *
+ * \ingroup ImageFunctions
+ * \ingroup ITKImageFunction
+ */
+template<
+  typename TInputImage,
+  typename TCoordRep = float,
+  typename TOutputType = CovariantVector<double, TInputImage::ImageDimension >
+  >
+class ITK_TEMPLATE_EXPORT TileCachedGradientImageFunction:
+  public ImageFunction< TInputImage,
+                        TOutputType,
+                        TCoordRep >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(TileCachedGradientImageFunction);
+
+  /** Dimension underlying input image. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  /** Standard class type aliases. */
+  using Self = TileCachedGradientImageFunction;
+  using Superclass = ImageFunction< TInputImage,
+                         TOutputType,
+                         TCoordRep >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TileCachedGradientImageFunction, ImageFunction);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** InputImageType type alias support */
+  using InputImageType = TInputImage;
+
+  /** OutputType typdef support. */
+  using OutputType = typename Superclass::OutputType;
+
+  /** Index type alias support */
+  using IndexType = typename Superclass::IndexType;
+
+  /** ContinuousIndex type alias support */
+  using ContinuousIndexType = typename Superclass::ContinuousIndexType;
+
+  /** Point type alias support */
+  using PointType = typename Superclass::PointType;
+
+  /** Size type alias support */
+  using SizeType = typename InputImageType::SizeType;
+
+  /** Type of the function whose results are cached. */
+  using GradientCalculatorType = ImageFunction< TInputImage, TOutputType, TCoordRep >;
+  using GradientCalculatorPointer = typename GradientCalculatorType::Pointer;
+
+  /** Set the input image.  The cache is cleared if the image differs from
+   * the one the cache was built for or has been modified since. */
+  void SetInputImage(const TInputImage *inputData) override;
+
+  /** Set/Get the gradient calculator evaluated at the grid nodes. */
+  virtual void SetGradientCalculator(GradientCalculatorType *calculator);
+  itkGetModifiableObjectMacro(GradientCalculator, GradientCalculatorType );
+
+  /** Set/Get the tile size in pixels.  Changing it clears the cache.
+   * Default is 32 pixels in each dimension. */
+  virtual void SetTileSize(const SizeType & tileSize);
+  itkGetConstReferenceMacro(TileSize, SizeType);
+
+  /** Discard all cached tiles. */
+  void ClearCache();
+
+  /** Get the number of tiles that have been computed so far. */
+  SizeValueType GetNumberOfComputedTiles() const;
+
+  /** Get the total number of tiles covering the buffered region. */
+  SizeValueType GetNumberOfTiles() const
+    {
+    return static_cast< SizeValueType >( this->m_Tiles.size() );
+    }
+
+  /** Evaluate the cached gradient at the specified index.  The index is
+   * clamped to the buffered region. */
+  OutputType EvaluateAtIndex(const IndexType & index) const override;
+
+  /** Evaluate the gradient at a non-integer position by linear
+   * interpolation of the cached node gradients. */
+  OutputType EvaluateAtContinuousIndex(const ContinuousIndexType & cindex) const override;
+
+  /** Evaluate the gradient at a physical point by linear
+   * interpolation of the cached node gradients. */
+  OutputType Evaluate(const PointType & point) const override;
+
+protected:
+  TileCachedGradientImageFunction();
+  ~TileCachedGradientImageFunction() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Storage for the node gradients of one tile. */
+  struct TileType
+  {
+    std::once_flag                  m_Computed;
+    std::atomic< bool >             m_IsComputed{ false };
+    std::unique_ptr< OutputType[] > m_Values;
+  };
+
+  /** Return the cached gradient of an index lying inside the buffered region. */
+  const OutputType & GetCachedValue(const IndexType & index) const;
+
+  /** Fill the gradients of a tile. */
+  void ComputeTile(SizeValueType tileId, TileType & tile) const;
+
+  /** Allocate the (empty) tile table for the current image and tile size. */
+  void AllocateTiles();
+
+  GradientCalculatorPointer                   m_GradientCalculator;
+  SizeType                                    m_TileSize;
+  SizeType                                    m_NumberOfTilesPerDimension;
+  std::vector< std::unique_ptr< TileType > > m_Tiles;
+  ModifiedTimeType                            m_CachedImageMTime;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTileCachedGradientImageFunction.hxx"
+#endif
+
+#endif
@@ -0,0 +1,314 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTileCachedGradientImageFunction_hxx
+#define itkTileCachedGradientImageFunction_hxx
+
+#include "itkTileCachedGradientImageFunction.h"
+#include "itkCentralDifferenceImageFunction.h"
+#include "itkMath.h"
+
+namespace itk
+{
+/**
+ * Constructor
+ */
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::TileCachedGradientImageFunction() :
+  m_CachedImageMTime( 0 )
+{
+  using DefaultCalculatorType = CentralDifferenceImageFunction< TInputImage, TCoordRep, TOutputType >;
+  this->m_GradientCalculator = DefaultCalculatorType::New();
+
+  this->m_TileSize.Fill( 32 );
+  this->m_NumberOfTilesPerDimension.Fill( 0 );
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::SetInputImage(const TInputImage *inputData)
+{
+  if ( inputData != this->m_Image ||
+       ( inputData != nullptr && inputData->GetMTime() != this->m_CachedImageMTime ) )
+    {
+    Superclass::SetInputImage( inputData );
+    this->m_GradientCalculator->SetInputImage( inputData );
+    this->m_CachedImageMTime = ( inputData != nullptr ) ? inputData->GetMTime() : 0;
+    this->AllocateTiles();
+    this->Modified();
+    }
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::SetGradientCalculator(GradientCalculatorType *calculator)
+{
+  if ( calculator != this->m_GradientCalculator )
+    {
+    this->m_GradientCalculator = calculator;
+    if ( this->GetInputImage() != nullptr )
+      {
+      this->m_GradientCalculator->SetInputImage( this->GetInputImage() );
+      }
+    this->AllocateTiles();
+    this->Modified();
+    }
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::SetTileSize(const SizeType & tileSize)
+{
+  if ( tileSize != this->m_TileSize )
+    {
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if ( tileSize[d] == 0 )
+        {
+        itkExceptionMacro( "The tile size must be greater than zero in each dimension." );
+        }
+      }
+    this->m_TileSize = tileSize;
+    this->AllocateTiles();
+    this->Modified();
+    }
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::ClearCache()
+{
+  this->AllocateTiles();
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::AllocateTiles()
+{
+  this->m_Tiles.clear();
+  this->m_NumberOfTilesPerDimension.Fill( 0 );
+
+  const InputImageType *inputImage = this->GetInputImage();
+  if ( inputImage == nullptr )
+    {
+    return;
+    }
+
+  const SizeType & bufferedSize = inputImage->GetBufferedRegion().GetSize();
+  SizeValueType numberOfTiles = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    this->m_NumberOfTilesPerDimension[d] = ( bufferedSize[d] + this->m_TileSize[d] - 1 ) / this->m_TileSize[d];
+    numberOfTiles *= this->m_NumberOfTilesPerDimension[d];
+    }
+
+  this->m_Tiles.resize( numberOfTiles );
+  for ( auto & tile : this->m_Tiles )
+    {
+    tile.reset( new TileType );
+    }
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+SizeValueType
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::GetNumberOfComputedTiles() const
+{
+  SizeValueType numberOfComputedTiles = 0;
+  for ( const auto & tile : this->m_Tiles )
+    {
+    if ( tile->m_IsComputed.load() )
+      {
+      ++numberOfComputedTiles;
+      }
+    }
+  return numberOfComputedTiles;
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::ComputeTile(SizeValueType tileId, TileType & tile) const
+{
+  const IndexType & start = this->m_StartIndex;
+  const IndexType & end = this->m_EndIndex;
+
+  // Recover the tile grid position and the pixel extent of the tile.
+  IndexType tileStart;
+  SizeType tileSize;
+  SizeValueType numberOfNodes = 1;
+  SizeValueType remainder = tileId;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const SizeValueType tileIndex = remainder % this->m_NumberOfTilesPerDimension[d];
+    remainder /= this->m_NumberOfTilesPerDimension[d];
+    tileStart[d] = start[d] + static_cast< IndexValueType >( tileIndex * this->m_TileSize[d] );
+    tileSize[d] = std::min( this->m_TileSize[d],
+      static_cast< SizeValueType >( end[d] - tileStart[d] + 1 ) );
+    numberOfNodes *= tileSize[d];
+    }
+
+  tile.m_Values.reset( new OutputType[numberOfNodes] );
+
+  // The nodes are evaluated at their physical points: calculators such as
+  // CentralDifferenceImageFunction do not compute the same differences in
+  // Evaluate() and EvaluateAtIndex() at the image boundary, and Evaluate() is
+  // what the cache stands in for.
+  const InputImageType *inputImage = this->GetInputImage();
+  PointType point;
+  IndexType index = tileStart;
+  for ( SizeValueType n = 0; n < numberOfNodes; n++ )
+    {
+    inputImage->TransformIndexToPhysicalPoint( index, point );
+    tile.m_Values[n] = this->m_GradientCalculator->Evaluate( point );
+
+    // Advance the index in raster order within the tile.
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      ++index[d];
+      if ( index[d] < tileStart[d] + static_cast< IndexValueType >( tileSize[d] ) )
+        {
+        break;
+        }
+      index[d] = tileStart[d];
+      }
+    }
+
+  tile.m_IsComputed.store( true );
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+const typename TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >::OutputType &
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::GetCachedValue(const IndexType & index) const
+{
+  const IndexType & start = this->m_StartIndex;
+  const IndexType & end = this->m_EndIndex;
+
+  SizeValueType tileId = 0;
+  SizeValueType tileStride = 1;
+  SizeValueType offset = 0;
+  SizeValueType offsetStride = 1;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const auto position = static_cast< SizeValueType >( index[d] - start[d] );
+    const SizeValueType tileIndex = position / this->m_TileSize[d];
+    const SizeValueType tileOrigin = tileIndex * this->m_TileSize[d];
+    const SizeValueType tileExtent = std::min( this->m_TileSize[d],
+      static_cast< SizeValueType >( end[d] - start[d] + 1 ) - tileOrigin );
+
+    tileId += tileIndex * tileStride;
+    tileStride *= this->m_NumberOfTilesPerDimension[d];
+    offset += ( position - tileOrigin ) * offsetStride;
+    offsetStride *= tileExtent;
+    }
+
+  TileType & tile = *this->m_Tiles[tileId];
+  std::call_once( tile.m_Computed, &Self::ComputeTile, this, tileId, std::ref( tile ) );
+  return tile.m_Values[offset];
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+typename TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >::OutputType
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::EvaluateAtIndex(const IndexType & index) const
+{
+  IndexType clampedIndex;
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    clampedIndex[d] = std::max( this->m_StartIndex[d], std::min( this->m_EndIndex[d], index[d] ) );
+    }
+  return this->GetCachedValue( clampedIndex );
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+typename TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >::OutputType
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::EvaluateAtContinuousIndex(const ContinuousIndexType & cindex) const
+{
+  // Multilinear interpolation of the cached node values, clamping the
+  // neighbors to the buffered region as LinearInterpolateImageFunction does.
+  IndexType baseIndex;
+  double distance[ImageDimension];
+  for ( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    baseIndex[d] = Math::Floor< IndexValueType >( cindex[d] );
+    distance[d] = cindex[d] - static_cast< double >( baseIndex[d] );
+    }
+
+  OutputType value;
+  constexpr unsigned int numberOfNeighbors = 1u << ImageDimension;
+  for ( unsigned int counter = 0; counter < numberOfNeighbors; counter++ )
+    {
+    double weight = 1.0;
+    IndexType neighborIndex;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if ( counter & ( 1u << d ) )
+        {
+        neighborIndex[d] = baseIndex[d] + 1;
+        weight *= distance[d];
+        }
+      else
+        {
+        neighborIndex[d] = baseIndex[d];
+        weight *= 1.0 - distance[d];
+        }
+      neighborIndex[d] = std::max( this->m_StartIndex[d], std::min( this->m_EndIndex[d], neighborIndex[d] ) );
+      }
+    if ( counter == 0 )
+      {
+      value = this->GetCachedValue( neighborIndex ) * weight;
+      }
+    else
+      {
+      value += this->GetCachedValue( neighborIndex ) * weight;
+      }
+    }
+  return value;
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+typename TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >::OutputType
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::Evaluate(const PointType & point) const
+{
+  ContinuousIndexType cindex;
+  this->ConvertPointToContinuousIndex( point, cindex );
+  return this->EvaluateAtContinuousIndex( cindex );
+}
+
+template< typename TInputImage, typename TCoordRep, typename TOutputType >
+void
+TileCachedGradientImageFunction< TInputImage, TCoordRep, TOutputType >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "TileSize: " << this->m_TileSize << std::endl;
+  os << indent << "NumberOfTiles: " << this->GetNumberOfTiles() << std::endl;
+  os << indent << "NumberOfComputedTiles: " << this->GetNumberOfComputedTiles() << std::endl;
+  itkPrintSelfObjectMacro( GradientCalculator );
+}
+} // end namespace itk
+
+#endif
@@ -0,0 +1,168 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMultiThreaderBase.h"
+#include "itkTestingMacros.h"
+
+#include <atomic>
+
+/*
+ * Check that the WithContext methods of the B-spline interpolator give the
+ * same results as the methods allocating their working space, including
+ * when one context per work unit is used concurrently, and that the
+ * thread id methods are safe with a thread id beyond the number of work
+ * units of the interpolator.
+ */
+int itkBSplineInterpolateImageFunctionWithContextTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using PixelType = float;
+  using ImageType = itk::Image< PixelType, Dimension >;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 30;
+  image->SetRegions( size );
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 2.0;
+  image->SetSpacing( spacing );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( static_cast< PixelType >( std::sin( 0.3 * index[0] ) * std::cos( 0.2 * index[1] ) + 0.01 * index[0] * index[1] ) );
+    }
+
+  using InterpolatorType = itk::BSplineInterpolateImageFunction< ImageType, double, double >;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputImage( image );
+
+  // Sample points inside the image.
+  constexpr unsigned int NumberOfPoints = 2000;
+  std::vector< InterpolatorType::ContinuousIndexType > indices( NumberOfPoints );
+  for( unsigned int i = 0; i < NumberOfPoints; ++i )
+    {
+    indices[i][0] = 0.5 + 38.0 * ( ( i * 37 ) % NumberOfPoints ) / NumberOfPoints;
+    indices[i][1] = 0.5 + 28.0 * ( ( i * 101 ) % NumberOfPoints ) / NumberOfPoints;
+    }
+
+  bool testPassed = true;
+
+  for( unsigned int splineOrder = 1; splineOrder <= 5; ++splineOrder )
+    {
+    interpolator->SetSplineOrder( splineOrder );
+    interpolator->SetInputImage( image );
+
+    InterpolatorType::EvaluationContextPointer context = interpolator->MakeEvaluationContext();
+    for( unsigned int i = 0; i < NumberOfPoints; ++i )
+      {
+      InterpolatorType::PointType point;
+      image->TransformContinuousIndexToPhysicalPoint( indices[i], point );
+
+      const InterpolatorType::OutputType value = interpolator->Evaluate( point );
+      const InterpolatorType::CovariantVectorType derivative = interpolator->EvaluateDerivative( point );
+
+      InterpolatorType::OutputType valueWithContext;
+      InterpolatorType::CovariantVectorType derivativeWithContext;
+      interpolator->EvaluateValueAndDerivativeWithContext( point, valueWithContext, derivativeWithContext, *context );
+
+      if( itk::Math::NotExactlyEquals( value, interpolator->EvaluateWithContext( point, *context ) )
+          || itk::Math::NotExactlyEquals( value, valueWithContext )
+          || derivative != interpolator->EvaluateDerivativeWithContext( point, *context )
+          || ( derivative - derivativeWithContext ).GetNorm() > 1e-10 )
+        {
+        std::cerr << "Spline order " << splineOrder << ": the evaluation with a context differs at "
+                  << indices[i] << std::endl;
+        testPassed = false;
+        break;
+        }
+      }
+
+    // A thread id that does not match the number of work units of the
+    // interpolator falls back to the allocating evaluation.
+    interpolator->SetNumberOfWorkUnits( 2 );
+    TEST_EXPECT_EQUAL( interpolator->EvaluateAtContinuousIndex( indices[0], 7 ),
+                       interpolator->EvaluateAtContinuousIndex( indices[0] ) );
+    }
+
+  // A context created before a change of the spline order is resized.
+  InterpolatorType::EvaluationContextPointer oldContext = interpolator->MakeEvaluationContext();
+  interpolator->SetSplineOrder( 2 );
+  interpolator->SetInputImage( image );
+  TEST_EXPECT_EQUAL( interpolator->EvaluateAtContinuousIndexWithContext( indices[1], *oldContext ),
+                     interpolator->EvaluateAtContinuousIndex( indices[1] ) );
+
+  // A context of another interpolator is rejected.
+  using LinearInterpolatorType = itk::LinearInterpolateImageFunction< ImageType, double >;
+  LinearInterpolatorType::Pointer linearInterpolator = LinearInterpolatorType::New();
+  linearInterpolator->SetInputImage( image );
+  LinearInterpolatorType::EvaluationContextPointer linearContext = linearInterpolator->MakeEvaluationContext();
+  TEST_EXPECT_EQUAL( linearInterpolator->EvaluateAtContinuousIndexWithContext( indices[2], *linearContext ),
+                     linearInterpolator->EvaluateAtContinuousIndex( indices[2] ) );
+  TRY_EXPECT_EXCEPTION( interpolator->EvaluateAtContinuousIndexWithContext( indices[2], *linearContext ) );
+
+  // One context per work unit, whatever the number of work units chosen by
+  // the threader.
+  interpolator->SetSplineOrder( 3 );
+  interpolator->SetInputImage( image );
+  std::vector< InterpolatorType::OutputType > expected( NumberOfPoints );
+  for( unsigned int i = 0; i < NumberOfPoints; ++i )
+    {
+    expected[i] = interpolator->EvaluateAtContinuousIndex( indices[i] );
+    }
+
+  itk::MultiThreaderBase::Pointer threader = itk::MultiThreaderBase::New();
+  threader->SetNumberOfWorkUnits( 8 );
+  std::atomic< unsigned int > numberOfMismatches( 0 );
+  threader->ParallelizeArray( 0, 8,
+    [&]( itk::SizeValueType chunk )
+      {
+      InterpolatorType::EvaluationContextPointer workerContext = interpolator->MakeEvaluationContext();
+      for( unsigned int repeat = 0; repeat < 5; ++repeat )
+        {
+        for( unsigned int i = static_cast< unsigned int >( chunk ); i < NumberOfPoints; i += 8 )
+          {
+          if( itk::Math::NotExactlyEquals(
+                interpolator->EvaluateAtContinuousIndexWithContext( indices[i], *workerContext ), expected[i] ) )
+            {
+            ++numberOfMismatches;
+            }
+          }
+        }
+      }, nullptr );
+
+  if( numberOfMismatches != 0 )
+    {
+    std::cerr << numberOfMismatches << " concurrent evaluations with a context differ." << std::endl;
+    testPassed = false;
+    }
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
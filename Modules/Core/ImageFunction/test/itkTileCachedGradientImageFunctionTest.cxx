@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkTileCachedGradientImageFunction.h"
+#include "itkCentralDifferenceImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+int itkTileCachedGradientImageFunctionTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using PixelType = float;
+  using ImageType = itk::Image< PixelType, Dimension >;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::IndexType start;
+  start[0] = 3;
+  start[1] = -2;
+  ImageType::SizeType size;
+  size[0] = 50;
+  size[1] = 37;
+  ImageType::RegionType region( start, size );
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, region );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( static_cast< PixelType >( 0.5 * index[0] * index[0] - 3.0 * index[1] + index[0] * index[1] ) );
+    }
+
+  using FunctionType = itk::TileCachedGradientImageFunction< ImageType, double >;
+  FunctionType::Pointer function = FunctionType::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( function, TileCachedGradientImageFunction, ImageFunction );
+
+  FunctionType::SizeType tileSize;
+  tileSize[0] = 16;
+  tileSize[1] = 8;
+  function->SetTileSize( tileSize );
+  TEST_SET_GET_VALUE( tileSize, function->GetTileSize() );
+
+  FunctionType::SizeType invalidTileSize;
+  invalidTileSize.Fill( 0 );
+  TRY_EXPECT_EXCEPTION( function->SetTileSize( invalidTileSize ) );
+
+  function->SetInputImage( image );
+
+  // ceil(50/16) * ceil(37/8) tiles, none computed yet.
+  TEST_EXPECT_EQUAL( function->GetNumberOfTiles(), 4u * 5u );
+  TEST_EXPECT_EQUAL( function->GetNumberOfComputedTiles(), 0u );
+
+  using ReferenceType = itk::CentralDifferenceImageFunction< ImageType, double >;
+  ReferenceType::Pointer reference = ReferenceType::New();
+  reference->SetInputImage( image );
+
+  // A single evaluation only computes the tile it falls in.
+  ImageType::IndexType index;
+  index[0] = 10;
+  index[1] = 1;
+  FunctionType::OutputType value = function->EvaluateAtIndex( index );
+  TEST_EXPECT_EQUAL( function->GetNumberOfComputedTiles(), 1u );
+
+  bool testPassed = true;
+  constexpr double tolerance = 1e-6;
+
+  // Every node, including the boundary ones, must match the wrapped
+  // calculator evaluated at the node point.
+  ImageType::PointType nodePoint;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    value = function->EvaluateAtIndex( it.GetIndex() );
+    image->TransformIndexToPhysicalPoint( it.GetIndex(), nodePoint );
+    const ReferenceType::OutputType expected = reference->Evaluate( nodePoint );
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      if( std::fabs( value[d] - expected[d] ) > tolerance )
+        {
+        std::cerr << "Mismatch at " << it.GetIndex() << ": " << value << " vs " << expected << std::endl;
+        testPassed = false;
+        }
+      }
+    }
+  TEST_EXPECT_EQUAL( function->GetNumberOfComputedTiles(), function->GetNumberOfTiles() );
+
+  // Between nodes, the result is the linear interpolation of the node values.
+  FunctionType::ContinuousIndexType cindex;
+  cindex[0] = 20.25;
+  cindex[1] = 6.5;
+  value = function->EvaluateAtContinuousIndex( cindex );
+  ImageType::IndexType i00, i10, i01, i11;
+  i00[0] = 20; i00[1] = 6;
+  i10[0] = 21; i10[1] = 6;
+  i01[0] = 20; i01[1] = 7;
+  i11[0] = 21; i11[1] = 7;
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    const double expected = 0.75 * 0.5 * reference->EvaluateAtIndex( i00 )[d]
+                          + 0.25 * 0.5 * reference->EvaluateAtIndex( i10 )[d]
+                          + 0.75 * 0.5 * reference->EvaluateAtIndex( i01 )[d]
+                          + 0.25 * 0.5 * reference->EvaluateAtIndex( i11 )[d];
+    if( std::fabs( value[d] - expected ) > tolerance )
+      {
+      std::cerr << "Interpolation mismatch at " << cindex << ": " << value << std::endl;
+      testPassed = false;
+      }
+    }
+
+  // Evaluating at a physical point is the same as at its continuous index.
+  FunctionType::PointType point;
+  image->TransformContinuousIndexToPhysicalPoint( cindex, point );
+  const FunctionType::OutputType pointValue = function->Evaluate( point );
+  for( unsigned int d = 0; d < Dimension; ++d )
+    {
+    if( std::fabs( pointValue[d] - value[d] ) > tolerance )
+      {
+      std::cerr << "Evaluate( point ) differs from EvaluateAtContinuousIndex" << std::endl;
+      testPassed = false;
+      }
+    }
+
+  // Setting the same, unmodified image keeps the cache.
+  function->SetInputImage( image );
+  TEST_EXPECT_EQUAL( function->GetNumberOfComputedTiles(), function->GetNumberOfTiles() );
+
+  // Modifying the image invalidates it.
+  image->Modified();
+  function->SetInputImage( image );
+  TEST_EXPECT_EQUAL( function->GetNumberOfComputedTiles(), 0u );
+
+  function->EvaluateAtIndex( index );
+  function->ClearCache();
+  TEST_EXPECT_EQUAL( function->GetNumberOfComputedTiles(), 0u );
+
+  std::cout << function << std::endl;
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
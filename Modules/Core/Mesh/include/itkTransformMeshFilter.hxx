@@ -21,6 +21,8 @@
 #include "itkTransformMeshFilter.h"
 #include "itkMacro.h"
 
+#include <vector>
+
 namespace itk
 {
 /**
@@ -92,13 +94,30 @@ TransformMeshFilter< TInputMesh, TOutputMesh, TTransform >
   typename InputPointsContainer::ConstIterator inputPoint  = inPoints->Begin();
   typename OutputPointsContainer::Iterator outputPoint = outPoints->Begin();
 
+  // The points containers need not be contiguous: the points are gathered in
+  // blocks that are transformed at once with TransformPoints().
+  using TransformInputPointType = typename TransformType::InputPointType;
+  using TransformOutputPointType = typename TransformType::OutputPointType;
+  constexpr SizeValueType blockSize = 1024;
+  std::vector< TransformInputPointType >  inputBlock( blockSize );
+  std::vector< TransformOutputPointType > outputBlock( blockSize );
+
   while ( inputPoint != inPoints->End() )
     {
-    outputPoint.Value() =
-      m_Transform->TransformPoint( inputPoint.Value() );
-
-    ++inputPoint;
-    ++outputPoint;
+    SizeValueType numberOfBlockPoints = 0;
+    while ( inputPoint != inPoints->End() && numberOfBlockPoints < blockSize )
+      {
+      inputBlock[numberOfBlockPoints++] = inputPoint.Value();
+      ++inputPoint;
+      }
+
+    m_Transform->TransformPoints( inputBlock.data(), outputBlock.data(), numberOfBlockPoints );
+
+    for ( SizeValueType n = 0; n < numberOfBlockPoints; ++n )
+      {
+      outputPoint.Value() = outputBlock[n];
+      ++outputPoint;
+      }
     }
 
   // Create duplicate references to the rest of data on the mesh
@@ -180,6 +180,13 @@ namespace itk
    // ~PipelineMonitorImageFilter() { } default implementation OK
 
    void PrintSelf(std::ostream &os, Indent indent) const override;
+
+   /** The output is grafted from the input. */
+   double EstimateOutputMemoryPerPixel() const override
+   {
+     return 0.0;
+   }
+
  private:
 
    PipelineMonitorImageFilter(const PipelineMonitorImageFilter &) = delete;
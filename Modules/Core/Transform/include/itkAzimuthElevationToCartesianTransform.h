@@ -142,6 +142,11 @@ public:
   /** Transform from azimuth-elevation to cartesian. */
   OutputPointType     TransformPoint(const InputPointType  & point) const override;
 
+  /** Transform an array of points with TransformPoint(), since the matrix
+   * based implementation of the superclass does not apply. */
+  void TransformPoints(const InputPointType *inputPoints, OutputPointType *outputPoints,
+                       SizeValueType numberOfPoints) const override;
+
   /** Back transform from cartesian to azimuth-elevation.  */
   inline InputPointType  BackTransform(const OutputPointType  & point) const
   {
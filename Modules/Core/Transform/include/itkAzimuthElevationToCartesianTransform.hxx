@@ -85,6 +85,18 @@ AzimuthElevationToCartesianTransform<TParametersValueType, NDimensions>::Transfo
   return result;
 }
 
+template<typename TParametersValueType, unsigned int NDimensions>
+void
+AzimuthElevationToCartesianTransform<TParametersValueType, NDimensions>::TransformPoints(const InputPointType *inputPoints,
+                                                                                        OutputPointType *outputPoints,
+                                                                                        SizeValueType numberOfPoints) const
+{
+  for ( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    outputPoints[n] = this->TransformPoint(inputPoints[n]);
+    }
+}
+
 /** Transform a point, from azimuth-elevation to cartesian */
 template<typename TParametersValueType, unsigned int NDimensions>
 typename AzimuthElevationToCartesianTransform<TParametersValueType, NDimensions>
@@ -221,6 +221,11 @@ public:
   /** Transform points by a BSpline deformable transformation. */
   OutputPointType  TransformPoint( const InputPointType & point ) const override;
 
+  /** Transform an array of points, sharing the interpolation weights and
+   * indices buffers between the points. */
+  void TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                        SizeValueType numberOfPoints ) const override;
+
   /** Interpolation weights function type. */
   using WeightsFunctionType = BSplineInterpolationWeightFunction<ScalarType,
     Self::SpaceDimension ,
@@ -279,6 +284,20 @@ public:
 
   void ComputeJacobianWithRespectToParameters( const InputPointType &, JacobianType & ) const override = 0;
 
+  using JacobianSupportIndicesType = typename Superclass::JacobianSupportIndicesType;
+
+  /** Compute the nonzero columns of the Jacobian with respect to the
+   * parameters, i.e. the (SplineOrder + 1)^SpaceDimension weights of the
+   * control points whose support contains the point, for each dimension.
+   * The support is empty outside of the valid region of the grid. */
+  void ComputeSparseJacobianWithRespectToParameters( const InputPointType &, JacobianType &,
+    JacobianSupportIndicesType & ) const override;
+
+  bool HasSparseJacobian() const override
+  {
+    return true;
+  }
+
   void ComputeJacobianWithRespectToPosition( const InputPointType &, JacobianPositionType & ) const override
   {
     itkExceptionMacro( << "ComputeJacobianWithRespectToPosition not yet implemented "
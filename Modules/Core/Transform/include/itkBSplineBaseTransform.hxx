@@ -297,6 +297,67 @@ BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
     }
 }
 
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+void
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::ComputeSparseJacobianWithRespectToParameters( const InputPointType & point, JacobianType & jacobian,
+  JacobianSupportIndicesType & supportIndices ) const
+{
+  ContinuousIndexType index;
+  this->m_CoefficientImages[0]->TransformPhysicalPointToContinuousIndex( point, index );
+
+  // NOTE: if the support region does not lie totally within the grid we assume
+  // zero displacement, hence the point does not depend on any parameter
+  if( !this->InsideValidRegion( index ) )
+    {
+    supportIndices.SetSize( 0 );
+    jacobian.SetSize( SpaceDimension, 0 );
+    return;
+    }
+
+  const unsigned long numberOfWeights = this->m_WeightsFunction->GetNumberOfWeights();
+  WeightsType weights( numberOfWeights );
+  IndexType supportIndex;
+  this->m_WeightsFunction->Evaluate( index, weights, supportIndex );
+
+  supportIndices.SetSize( SpaceDimension * numberOfWeights );
+  jacobian.SetSize( SpaceDimension, SpaceDimension * numberOfWeights );
+  jacobian.Fill( 0.0 );
+
+  // The weights are ordered as the support region is traversed by an image
+  // iterator, and the parameters of each dimension are laid out as the
+  // coefficient image buffer.
+  const IndexType startIndex = this->m_CoefficientImages[0]->GetLargestPossibleRegion().GetIndex();
+  const OffsetValueType * offsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
+  const NumberOfParametersType numberOfParametersPerDimension = this->GetNumberOfParametersPerDimension();
+
+  IndexType currentIndex = supportIndex;
+  for( unsigned long counter = 0; counter < numberOfWeights; counter++ )
+    {
+    OffsetValueType number = 0;
+    for( unsigned int d = 0; d < SpaceDimension; d++ )
+      {
+      number += ( currentIndex[d] - startIndex[d] ) * offsetTable[d];
+      }
+    for( unsigned int d = 0; d < SpaceDimension; d++ )
+      {
+      supportIndices[d * numberOfWeights + counter] = static_cast<NumberOfParametersType>( number ) +
+        d * numberOfParametersPerDimension;
+      jacobian( d, d * numberOfWeights + counter ) = weights[counter];
+      }
+
+    // go to next coefficient in the support region
+    for( unsigned int d = 0; d < SpaceDimension; d++ )
+      {
+      if( ++currentIndex[d] < supportIndex[d] + static_cast<IndexValueType>( SplineOrder + 1 ) )
+        {
+        break;
+        }
+      currentIndex[d] = supportIndex[d];
+      }
+    }
+}
+
 template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
 unsigned int
 BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
@@ -338,5 +399,23 @@ BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
   return outputPoint;
 }
 
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+void
+BSplineBaseTransform<TParametersValueType, NDimensions, VSplineOrder>
+::TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                   SizeValueType numberOfPoints ) const
+{
+  WeightsType             weights( this->m_WeightsFunction->GetNumberOfWeights() );
+  ParameterIndexArrayType indices( this->m_WeightsFunction->GetNumberOfWeights() );
+  bool                    inside;
+
+  for( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    // The input is copied since the arrays may be the same.
+    const InputPointType point = inputPoints[n];
+    this->TransformPoint( point, outputPoints[n], weights, indices, inside );
+    }
+}
+
 } // namespace
 #endif
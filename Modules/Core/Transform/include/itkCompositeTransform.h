@@ -19,6 +19,7 @@
 #define itkCompositeTransform_h
 
 #include "itkMultiTransform.h"
+#include "itkMatrixOffsetTransformBase.h"
 
 #include <deque>
 
@@ -247,6 +248,12 @@ public:
   */
   OutputPointType TransformPoint( const InputPointType & inputPoint ) const override;
 
+  /** Transform an array of points.  The points are processed in blocks that
+   * go through the whole queue while they are in cache, each sub transform
+   * transforming a block at once with its own TransformPoints(). */
+  void TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                        SizeValueType numberOfPoints ) const override;
+
   /**  Method to transform a vector. */
   using Superclass::TransformVector;
   OutputVectorType TransformVector(const InputVectorType &) const override;
@@ -359,6 +366,20 @@ public:
    */
   virtual void FlattenTransformQueue();
 
+  /** Type of the transform that replaces a run of linear transforms. */
+  using LinearTransformType = MatrixOffsetTransformBase<TParametersValueType, NDimensions, NDimensions>;
+
+  /**
+   * Flatten the transform queue, then replace every run of two or more
+   * consecutive linear sub transforms by a single LinearTransformType with
+   * the same matrix and offset as their composition.  Each point is then
+   * mapped through one matrix multiplication per run instead of one per sub
+   * transform.  The collapsed transform is set to be optimized if any of the
+   * transforms it replaces was.  Returns the number of transforms removed
+   * from the queue.
+   */
+  virtual SizeValueType CollapseLinearTransforms();
+
   /**
    * Compute the Jacobian with respect to the parameters for the compositie
    * transform using Jacobian rule. See comments in the implementation.
@@ -377,6 +398,23 @@ public:
                                                                 JacobianType & outJacobian,
                                                                 JacobianType & cacheJacobian ) const override;
 
+  using JacobianSupportIndicesType = typename Superclass::JacobianSupportIndicesType;
+
+  /**
+   * Compute the nonzero columns of the Jacobian with respect to the
+   * parameters. When a single sub transform is optimized and it has a
+   * native sparse Jacobian, its sparse Jacobian is computed at the point
+   * mapped by the transforms applied before it, and left multiplied by the
+   * Jacobians with respect to position of the transforms applied after it.
+   * Otherwise the nonzero columns of the dense Jacobian are extracted.
+   */
+  void ComputeSparseJacobianWithRespectToParameters( const InputPointType & p, JacobianType & jacobian,
+    JacobianSupportIndicesType & supportIndices ) const override;
+
+  /** Whether a single sub transform is optimized and has a native sparse
+   * Jacobian. */
+  bool HasSparseJacobian() const override;
+
 protected:
   CompositeTransform();
   ~CompositeTransform() override = default;
@@ -414,6 +452,10 @@ protected:
   /** Get a list of transforms to optimize. Helper function. */
   TransformQueueType & GetTransformsToOptimizeQueue() const;
 
+  /** The index of the single sub transform that is optimized, or -1 if
+   * none or several are optimized. */
+  signed long GetIndexOfSingleTransformToOptimize() const;
+
   mutable TransformQueueType            m_TransformsToOptimizeQueue;
   mutable TransformsToOptimizeFlagsType m_TransformsToOptimizeFlags;
 
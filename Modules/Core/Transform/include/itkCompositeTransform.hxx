@@ -20,6 +20,8 @@
 
 #include "itkCompositeTransform.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -91,6 +93,43 @@ CompositeTransform<TParametersValueType, NDimensions>
 }
 
 
+template<typename TParametersValueType, unsigned int NDimensions>
+void
+CompositeTransform<TParametersValueType, NDimensions>
+::TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                   SizeValueType numberOfPoints ) const
+{
+  if( this->m_TransformQueue.empty() )
+    {
+    if( inputPoints != outputPoints )
+      {
+      std::copy( inputPoints, inputPoints + numberOfPoints, outputPoints );
+      }
+    return;
+    }
+
+  // Block size such that a block of points stays in the L1/L2 caches.
+  constexpr SizeValueType blockSize = 1024;
+
+  const typename TransformQueueType::const_iterator beginit( this->m_TransformQueue.begin() );
+  for( SizeValueType blockStart = 0; blockStart < numberOfPoints; blockStart += blockSize )
+    {
+    const SizeValueType numberOfBlockPoints = std::min( blockSize, numberOfPoints - blockStart );
+    OutputPointType * blockPoints = outputPoints + blockStart;
+
+    /* Apply in reverse queue order, in place after the first transform. */
+    typename TransformQueueType::const_iterator it( this->m_TransformQueue.end() );
+    --it;
+    (*it)->TransformPoints( inputPoints + blockStart, blockPoints, numberOfBlockPoints );
+    while( it != beginit )
+      {
+      --it;
+      (*it)->TransformPoints( blockPoints, blockPoints, numberOfBlockPoints );
+      }
+    }
+}
+
+
 template<typename TParametersValueType, unsigned int NDimensions>
 typename CompositeTransform<TParametersValueType, NDimensions>
 ::OutputVectorType
@@ -726,6 +765,100 @@ CompositeTransform<TParametersValueType, NDimensions>
 }
 
 
+template<typename TParametersValueType, unsigned int NDimensions>
+signed long
+CompositeTransform<TParametersValueType, NDimensions>
+::GetIndexOfSingleTransformToOptimize() const
+{
+  signed long index = -1;
+  for( SizeValueType tind = 0; tind < this->GetNumberOfTransforms(); ++tind )
+    {
+    if( this->GetNthTransformToOptimize( tind ) )
+      {
+      if( index >= 0 )
+        {
+        return -1;
+        }
+      index = static_cast<signed long>( tind );
+      }
+    }
+  return index;
+}
+
+
+template<typename TParametersValueType, unsigned int NDimensions>
+bool
+CompositeTransform<TParametersValueType, NDimensions>
+::HasSparseJacobian() const
+{
+  const signed long index = this->GetIndexOfSingleTransformToOptimize();
+  return index >= 0 && this->GetNthTransformConstPointer( index )->HasSparseJacobian();
+}
+
+
+template<typename TParametersValueType, unsigned int NDimensions>
+void
+CompositeTransform<TParametersValueType, NDimensions>
+::ComputeSparseJacobianWithRespectToParameters( const InputPointType & p, JacobianType & jacobian,
+  JacobianSupportIndicesType & supportIndices ) const
+{
+  if( !this->HasSparseJacobian() )
+    {
+    Superclass::ComputeSparseJacobianWithRespectToParameters( p, jacobian, supportIndices );
+    return;
+    }
+
+  /* The transforms are applied in reverse queue order. With T = T0(T1(T2(x)))
+   * and only T1 optimized:
+   *   dT/dp1 = ( dT0/dT1 | x1 ) * ( dT1/dp1 | x2 ),
+   * where x2 = T2(x) and x1 = T1(x2). The columns of dT1/dp1 that are zero
+   * remain zero, so the support of T1 is the support of T. */
+  const signed long optimizedIndex = this->GetIndexOfSingleTransformToOptimize();
+
+  OutputPointType transformedPoint( p );
+  for( signed long tind = static_cast<signed long>( this->GetNumberOfTransforms() ) - 1;
+       tind > optimizedIndex; --tind )
+    {
+    transformedPoint = this->GetNthTransformConstPointer( tind )->TransformPoint( transformedPoint );
+    }
+
+  const TransformType * const optimizedTransform = this->GetNthTransformConstPointer( optimizedIndex );
+  optimizedTransform->ComputeSparseJacobianWithRespectToParameters( transformedPoint, jacobian, supportIndices );
+  if( supportIndices.Size() == 0 )
+    {
+    return;
+    }
+  transformedPoint = optimizedTransform->TransformPoint( transformedPoint );
+
+  JacobianPositionType jacobianWithRespectToPosition;
+  for( signed long tind = optimizedIndex - 1; tind >= 0; --tind )
+    {
+    const TransformType * const transform = this->GetNthTransformConstPointer( tind );
+    transform->ComputeJacobianWithRespectToPosition( transformedPoint, jacobianWithRespectToPosition );
+
+    // jacobian = jacobianWithRespectToPosition * jacobian, column by column
+    double temp[NDimensions];
+    for( NumberOfParametersType c = 0; c < jacobian.cols(); ++c )
+      {
+      for( unsigned int r = 0; r < NDimensions; ++r )
+        {
+        temp[r] = 0.0;
+        for( unsigned int k = 0; k < NDimensions; ++k )
+          {
+          temp[r] += jacobianWithRespectToPosition[r][k] * jacobian[k][c];
+          }
+        }
+      for( unsigned int r = 0; r < NDimensions; ++r )
+        {
+        jacobian[r][c] = temp[r];
+        }
+      }
+
+    transformedPoint = transform->TransformPoint( transformedPoint );
+    }
+}
+
+
 template<typename TParametersValueType, unsigned int NDimensions>
 const typename CompositeTransform<TParametersValueType, NDimensions>::ParametersType &
 CompositeTransform<TParametersValueType, NDimensions>
@@ -1103,6 +1236,101 @@ CompositeTransform<TParametersValueType, NDimensions>
 }
 
 
+template<typename TParametersValueType, unsigned int NDimensions>
+SizeValueType
+CompositeTransform<TParametersValueType, NDimensions>
+::CollapseLinearTransforms()
+{
+  this->FlattenTransformQueue();
+
+  TransformQueueType             transformQueue;
+  TransformQueueType             transformsToOptimizeQueue;
+  TransformsToOptimizeFlagsType  transformsToOptimizeFlags;
+
+  const SizeValueType numberOfTransforms = this->GetNumberOfTransforms();
+  SizeValueType m = 0;
+  while( m < numberOfTransforms )
+    {
+    // Find the run of consecutive linear transforms starting at m.
+    SizeValueType end = m;
+    bool optimize = false;
+    while( end < numberOfTransforms && this->m_TransformQueue[end]->IsLinear() )
+      {
+      optimize = optimize || this->m_TransformsToOptimizeFlags[end];
+      ++end;
+      }
+
+    TransformTypePointer transform;
+    if( end - m < 2 )
+      {
+      transform = this->m_TransformQueue[m];
+      optimize = this->m_TransformsToOptimizeFlags[m];
+      ++m;
+      }
+    else
+      {
+      // The run is applied in reverse queue order, like the whole queue.  Its
+      // offset is the image of the origin and the columns of its matrix are
+      // the images of the unit vectors minus the offset.
+      const SizeValueType begin = m;
+      auto transformRun = [this, begin, end]( const InputPointType & point ) -> OutputPointType
+        {
+        OutputPointType outputPoint( point );
+        for( SizeValueType n = end; n > begin; --n )
+          {
+          outputPoint = this->m_TransformQueue[n - 1]->TransformPoint( outputPoint );
+          }
+        return outputPoint;
+        };
+
+      InputPointType point;
+      point.Fill( NumericTraits<ScalarType>::ZeroValue() );
+      const OutputPointType origin = transformRun( point );
+
+      typename LinearTransformType::MatrixType matrix;
+      for( unsigned int j = 0; j < NDimensions; j++ )
+        {
+        point.Fill( NumericTraits<ScalarType>::ZeroValue() );
+        point[j] = NumericTraits<ScalarType>::OneValue();
+        const OutputPointType column = transformRun( point );
+        for( unsigned int i = 0; i < NDimensions; i++ )
+          {
+          matrix[i][j] = column[i] - origin[i];
+          }
+        }
+      typename LinearTransformType::OutputVectorType offset;
+      for( unsigned int i = 0; i < NDimensions; i++ )
+        {
+        offset[i] = origin[i];
+        }
+
+      typename LinearTransformType::Pointer linearTransform = LinearTransformType::New();
+      linearTransform->SetMatrix( matrix );
+      linearTransform->SetOffset( offset );
+      transform = linearTransform.GetPointer();
+      m = end;
+      }
+
+    transformQueue.push_back( transform );
+    transformsToOptimizeFlags.push_back( optimize );
+    if( optimize )
+      {
+      transformsToOptimizeQueue.push_back( transform );
+      }
+    }
+
+  const SizeValueType numberOfRemovedTransforms = numberOfTransforms - transformQueue.size();
+  this->m_TransformQueue = transformQueue;
+  this->m_TransformsToOptimizeQueue = transformsToOptimizeQueue;
+  this->m_TransformsToOptimizeFlags = transformsToOptimizeFlags;
+  if( numberOfRemovedTransforms > 0 )
+    {
+    this->Modified();
+    }
+  return numberOfRemovedTransforms;
+}
+
+
 template<typename TParametersValueType, unsigned int NDimensions>
 void
 CompositeTransform<TParametersValueType, NDimensions>
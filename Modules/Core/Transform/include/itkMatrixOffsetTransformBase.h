@@ -368,6 +368,10 @@ public:
 
   OutputPointType       TransformPoint(const InputPointType & point) const override;
 
+  /** Transform an array of points with a single matrix and offset lookup. */
+  void TransformPoints(const InputPointType *inputPoints, OutputPointType *outputPoints,
+                       SizeValueType numberOfPoints) const override;
+
   using Superclass::TransformVector;
 
   OutputVectorType      TransformVector(const InputVectorType & vector) const override;
@@ -176,6 +176,42 @@ MatrixOffsetTransformBase<TParametersValueType, NInputDimensions, NOutputDimensi
 }
 
 
+template<typename TParametersValueType, unsigned int NInputDimensions,
+          unsigned int NOutputDimensions>
+void
+MatrixOffsetTransformBase<TParametersValueType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType *inputPoints, OutputPointType *outputPoints,
+                  SizeValueType numberOfPoints) const
+{
+  // Local copies let the compiler keep the coefficients in registers across
+  // the loop, which it cannot do for members as the arrays may alias them.
+  TParametersValueType matrix[NOutputDimensions][NInputDimensions];
+  TParametersValueType offset[NOutputDimensions];
+  for ( unsigned int i = 0; i < NOutputDimensions; i++ )
+    {
+    for ( unsigned int j = 0; j < NInputDimensions; j++ )
+      {
+      matrix[i][j] = m_Matrix[i][j];
+      }
+    offset[i] = m_Offset[i];
+    }
+
+  for ( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    const InputPointType point = inputPoints[n];
+    for ( unsigned int i = 0; i < NOutputDimensions; i++ )
+      {
+      TParametersValueType value = offset[i];
+      for ( unsigned int j = 0; j < NInputDimensions; j++ )
+        {
+        value += matrix[i][j] * point[j];
+        }
+      outputPoints[n][i] = value;
+      }
+    }
+}
+
+
 template<typename TParametersValueType, unsigned int NInputDimensions,
           unsigned int NOutputDimensions>
 typename MatrixOffsetTransformBase<TParametersValueType,
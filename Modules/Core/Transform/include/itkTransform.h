@@ -184,12 +184,25 @@ public:
 
   using NumberOfParametersType = typename Superclass::NumberOfParametersType;
 
+  /** Type of the indices of the parameters the transformed point of a given
+   * point depends on, used by the sparse Jacobian. */
+  using JacobianSupportIndicesType = Array<NumberOfParametersType>;
+
   /**  Method to transform a point.
    * \warning This method must be thread-safe. See, e.g., its use
    * in ResampleImageFilter.
    */
   virtual OutputPointType TransformPoint(const InputPointType  &) const = 0;
 
+  /** Method to transform an array of points.  \c inputPoints and
+   * \c outputPoints may be the same array.  The default implementation calls
+   * TransformPoint() for each point; subclasses override it to avoid the per
+   * point overhead when transforming many points, e.g. the vertices of a
+   * mesh or a scanline of an image.
+   * \warning This method must be thread-safe. */
+  virtual void TransformPoints(const InputPointType *inputPoints, OutputPointType *outputPoints,
+                               SizeValueType numberOfPoints) const;
+
   /**  Method to transform a vector. */
   virtual OutputVectorType  TransformVector(const InputVectorType &) const
   {
@@ -507,6 +520,30 @@ public:
     this->ComputeJacobianWithRespectToParameters(p, jacobian);
   }
 
+  /** Compute the nonzero columns of the Jacobian with respect to the
+   * parameters at a given input point.
+   *
+   * On return, \c supportIndices holds the indices of the parameters the
+   * transformed point depends on, and column k of \c jacobian, of size
+   * OutputSpaceDimension x supportIndices.Size(), holds the partial
+   * derivatives with respect to parameter supportIndices[k].  The support
+   * may be empty, e.g. outside of the domain of a B-spline transform.
+   *
+   * The default implementation extracts the nonzero columns of the dense
+   * Jacobian.  Transforms whose parameters have a local support override it
+   * to skip the dense Jacobian, and return true from HasSparseJacobian().
+   * \c jacobian and \c supportIndices are assumed to be thread-local
+   * variables. */
+  virtual void ComputeSparseJacobianWithRespectToParameters( const InputPointType & p, JacobianType & jacobian,
+    JacobianSupportIndicesType & supportIndices ) const;
+
+  /** Whether ComputeSparseJacobianWithRespectToParameters() is implemented
+   * natively, i.e. without computing the dense Jacobian. */
+  virtual bool HasSparseJacobian() const
+  {
+    return false;
+  }
+
 
   /** This provides the ability to get a local jacobian value
    *  in a dense/local transform, e.g. DisplacementFieldTransform. For such
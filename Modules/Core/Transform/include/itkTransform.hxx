@@ -21,6 +21,7 @@
 #include "itkTransform.h"
 #include "itkCrossHelper.h"
 #include "vnl/algo/vnl_svd_fixed.h"
+#include <vector>
 
 namespace itk
 {
@@ -279,6 +280,54 @@ Transform<TParametersValueType, NInputDimensions, NOutputDimensions>
 }
 
 
+template<typename TParametersValueType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+Transform<TParametersValueType, NInputDimensions, NOutputDimensions>
+::TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                   SizeValueType numberOfPoints ) const
+{
+  for( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    outputPoints[n] = this->TransformPoint( inputPoints[n] );
+    }
+}
+
+template<typename TParametersValueType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+Transform<TParametersValueType, NInputDimensions, NOutputDimensions>
+::ComputeSparseJacobianWithRespectToParameters( const InputPointType & p, JacobianType & jacobian,
+  JacobianSupportIndicesType & supportIndices ) const
+{
+  JacobianType denseJacobian;
+  this->ComputeJacobianWithRespectToParameters( p, denseJacobian );
+
+  std::vector<NumberOfParametersType> nonzeroColumns;
+  for( NumberOfParametersType par = 0; par < denseJacobian.cols(); par++ )
+    {
+    for( unsigned int dim = 0; dim < NOutputDimensions; dim++ )
+      {
+      if( Math::NotExactlyEquals( denseJacobian( dim, par ), NumericTraits<ParametersValueType>::ZeroValue() ) )
+        {
+        nonzeroColumns.push_back( par );
+        break;
+        }
+      }
+    }
+
+  const auto numberOfNonzeroColumns = static_cast<NumberOfParametersType>( nonzeroColumns.size() );
+  supportIndices.SetSize( numberOfNonzeroColumns );
+  jacobian.SetSize( NOutputDimensions, numberOfNonzeroColumns );
+  for( NumberOfParametersType k = 0; k < numberOfNonzeroColumns; k++ )
+    {
+    supportIndices[k] = nonzeroColumns[k];
+    for( unsigned int dim = 0; dim < NOutputDimensions; dim++ )
+      {
+      jacobian( dim, k ) = denseJacobian( dim, nonzeroColumns[k] );
+      }
+    }
+}
+
+
 template<typename TParametersValueType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 typename Transform<TParametersValueType, NInputDimensions, NOutputDimensions>::OutputDiffusionTensor3DType
 Transform<TParametersValueType, NInputDimensions, NOutputDimensions>
@@ -0,0 +1,214 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBSplineTransform.h"
+#include "itkBSplineDeformableTransform.h"
+#include "itkAffineTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Check that the sparse Jacobian with respect to the parameters matches the
+ * dense Jacobian, for the B-spline transforms that implement it natively, for
+ * a composite transform optimizing a B-spline transform only, and for a
+ * transform relying on the default implementation.
+ */
+namespace
+{
+template<typename TTransform>
+bool
+CompareSparseAndDenseJacobians( const TTransform *transform, const typename TTransform::InputPointType & point,
+  itk::SizeValueType expectedSupportSize )
+{
+  using JacobianType = typename TTransform::JacobianType;
+  using JacobianSupportIndicesType = typename TTransform::JacobianSupportIndicesType;
+
+  JacobianType denseJacobian;
+  transform->ComputeJacobianWithRespectToParameters( point, denseJacobian );
+
+  JacobianType sparseJacobian;
+  JacobianSupportIndicesType supportIndices;
+  transform->ComputeSparseJacobianWithRespectToParameters( point, sparseJacobian, supportIndices );
+
+  if( supportIndices.Size() != expectedSupportSize || sparseJacobian.cols() != expectedSupportSize ||
+      sparseJacobian.rows() != TTransform::OutputSpaceDimension )
+    {
+    std::cerr << "Unexpected support size " << supportIndices.Size() << " at " << point
+              << ", expected " << expectedSupportSize << std::endl;
+    return false;
+    }
+
+  // Scatter the sparse Jacobian and compare
+  JacobianType scatteredJacobian( denseJacobian.rows(), denseJacobian.cols() );
+  scatteredJacobian.Fill( 0.0 );
+  for( itk::SizeValueType k = 0; k < supportIndices.Size(); k++ )
+    {
+    for( unsigned int d = 0; d < TTransform::OutputSpaceDimension; d++ )
+      {
+      scatteredJacobian( d, supportIndices[k] ) += sparseJacobian( d, k );
+      }
+    }
+  for( unsigned int d = 0; d < denseJacobian.rows(); d++ )
+    {
+    for( unsigned int p = 0; p < denseJacobian.cols(); p++ )
+      {
+      if( std::fabs( scatteredJacobian( d, p ) - denseJacobian( d, p ) ) > 1e-12 )
+        {
+        std::cerr << "Sparse and dense Jacobians differ at (" << d << ", " << p << ") for point "
+                  << point << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+}
+
+int itkBSplineTransformSparseJacobianTest( int, char * [] )
+{
+  constexpr unsigned int Dimension = 3;
+  constexpr unsigned int SplineOrder = 3;
+  using TransformType = itk::BSplineTransform<double, Dimension, SplineOrder>;
+
+  TransformType::Pointer transform = TransformType::New();
+  TEST_EXPECT_TRUE( transform->HasSparseJacobian() );
+
+  TransformType::PhysicalDimensionsType dimensions;
+  dimensions.Fill( 100.0 );
+  TransformType::MeshSizeType meshSize;
+  meshSize[0] = 4;
+  meshSize[1] = 5;
+  meshSize[2] = 6;
+  TransformType::OriginType origin;
+  origin.Fill( -10.0 );
+  TransformType::DirectionType direction;
+  direction.SetIdentity();
+  direction[0][0] = 0.0;
+  direction[0][1] = 1.0;
+  direction[1][0] = 1.0;
+  direction[1][1] = 0.0;
+
+  transform->SetTransformDomainOrigin( origin );
+  transform->SetTransformDomainPhysicalDimensions( dimensions );
+  transform->SetTransformDomainMeshSize( meshSize );
+  transform->SetTransformDomainDirection( direction );
+
+  TransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < parameters.Size(); p++ )
+    {
+    parameters[p] = std::sin( 0.1 * p );
+    }
+  transform->SetParameters( parameters );
+
+  const itk::SizeValueType numberOfWeights = transform->GetNumberOfWeights();
+  TEST_EXPECT_EQUAL( numberOfWeights, 64u );
+
+  bool testPassed = true;
+
+  const double coordinates[][Dimension] = { { 0.0, 0.0, 0.0 }, { 25.0, 50.0, 75.0 },
+    { 89.9, 10.0, 45.5 }, { 12.5, 87.5, 33.3 } };
+  for( const auto & coordinate : coordinates )
+    {
+    TransformType::InputPointType point;
+    for( unsigned int d = 0; d < Dimension; d++ )
+      {
+      point[d] = coordinate[d];
+      }
+    testPassed &= CompareSparseAndDenseJacobians( transform.GetPointer(), point, Dimension * numberOfWeights );
+    }
+
+  // Outside of the transform domain the point does not depend on any parameter
+  TransformType::InputPointType outsidePoint;
+  outsidePoint.Fill( 200.0 );
+  testPassed &= CompareSparseAndDenseJacobians( transform.GetPointer(), outsidePoint, 0 );
+
+  // Deprecated B-spline transform sharing the implementation
+  using DeformableTransformType = itk::BSplineDeformableTransform<double, 2, 2>;
+  DeformableTransformType::Pointer deformableTransform = DeformableTransformType::New();
+  DeformableTransformType::RegionType region;
+  DeformableTransformType::SizeType size;
+  size.Fill( 8 );
+  region.SetSize( size );
+  DeformableTransformType::SpacingType spacing;
+  spacing.Fill( 2.0 );
+  deformableTransform->SetGridRegion( region );
+  deformableTransform->SetGridSpacing( spacing );
+  DeformableTransformType::ParametersType deformableParameters( deformableTransform->GetNumberOfParameters() );
+  deformableParameters.Fill( 0.5 );
+  deformableTransform->SetParameters( deformableParameters );
+
+  DeformableTransformType::InputPointType deformablePoint;
+  deformablePoint[0] = 5.3;
+  deformablePoint[1] = 7.1;
+  testPassed &= CompareSparseAndDenseJacobians( deformableTransform.GetPointer(), deformablePoint,
+    2 * deformableTransform->GetNumberOfWeights() );
+
+  // Composite transform in which only the B-spline transform is optimized,
+  // between two affine transforms
+  using CompositeTransformType = itk::CompositeTransform<double, Dimension>;
+  using AffineTransformType = itk::AffineTransform<double, Dimension>;
+  AffineTransformType::Pointer firstAffineTransform = AffineTransformType::New();
+  AffineTransformType::OutputVectorType translation;
+  translation.Fill( -2.0 );
+  firstAffineTransform->Translate( translation );
+  AffineTransformType::Pointer lastAffineTransform = AffineTransformType::New();
+  AffineTransformType::OutputVectorType scale;
+  scale[0] = 1.1;
+  scale[1] = 0.9;
+  scale[2] = 1.3;
+  lastAffineTransform->Scale( scale );
+  lastAffineTransform->Rotate( 0, 1, 0.2 );
+
+  CompositeTransformType::Pointer compositeTransform = CompositeTransformType::New();
+  compositeTransform->AddTransform( lastAffineTransform );
+  compositeTransform->AddTransform( transform );
+  compositeTransform->AddTransform( firstAffineTransform );
+  TEST_EXPECT_TRUE( !compositeTransform->HasSparseJacobian() );
+  compositeTransform->SetOnlyMostRecentTransformToOptimizeOn();
+  TEST_EXPECT_TRUE( !compositeTransform->HasSparseJacobian() );
+  compositeTransform->SetAllTransformsToOptimizeOff();
+  compositeTransform->SetNthTransformToOptimizeOn( 1 );
+  TEST_EXPECT_TRUE( compositeTransform->HasSparseJacobian() );
+  for( const auto & coordinate : coordinates )
+    {
+    CompositeTransformType::InputPointType point;
+    for( unsigned int d = 0; d < Dimension; d++ )
+      {
+      point[d] = coordinate[d];
+      }
+    testPassed &= CompareSparseAndDenseJacobians( compositeTransform.GetPointer(), point,
+      Dimension * numberOfWeights );
+    }
+
+  // Default implementation
+  AffineTransformType::Pointer affineTransform = AffineTransformType::New();
+  TEST_EXPECT_TRUE( !affineTransform->HasSparseJacobian() );
+  AffineTransformType::InputPointType affinePoint;
+  affinePoint[0] = 1.0;
+  affinePoint[1] = 0.0;
+  affinePoint[2] = 3.0;
+  // the derivatives with respect to the matrix entries of the y column vanish
+  testPassed &= CompareSparseAndDenseJacobians( affineTransform.GetPointer(), affinePoint,
+    affineTransform->GetNumberOfParameters() - Dimension );
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
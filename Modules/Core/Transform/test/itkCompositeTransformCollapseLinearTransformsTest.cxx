@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkCompositeTransform.h"
+#include "itkAffineTransform.h"
+#include "itkBSplineTransform.h"
+#include "itkEuler3DTransform.h"
+#include "itkScaleTransform.h"
+#include "itkTranslationTransform.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Collapse the linear runs of a composite transform holding a nested
+ * composite and a B-spline transform, and check that the collapsed transform
+ * maps points like the original one.
+ */
+int itkCompositeTransformCollapseLinearTransformsTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 3;
+  using ScalarType = double;
+  using CompositeTransformType = itk::CompositeTransform<ScalarType, Dimension>;
+
+  // Linear transforms
+  using AffineTransformType = itk::AffineTransform<ScalarType, Dimension>;
+  AffineTransformType::Pointer affineTransform = AffineTransformType::New();
+  AffineTransformType::MatrixType matrix;
+  matrix[0][0] = 1.1;  matrix[0][1] = 0.1;  matrix[0][2] = -0.05;
+  matrix[1][0] = 0.02; matrix[1][1] = 0.9;  matrix[1][2] = 0.2;
+  matrix[2][0] = -0.1; matrix[2][1] = 0.05; matrix[2][2] = 1.05;
+  affineTransform->SetMatrix( matrix );
+  AffineTransformType::OutputVectorType affineTranslation;
+  affineTranslation[0] = 3.0;
+  affineTranslation[1] = -2.0;
+  affineTranslation[2] = 0.5;
+  affineTransform->SetTranslation( affineTranslation );
+
+  using TranslationTransformType = itk::TranslationTransform<ScalarType, Dimension>;
+  TranslationTransformType::Pointer translationTransform = TranslationTransformType::New();
+  TranslationTransformType::OutputVectorType translation;
+  translation[0] = -1.5;
+  translation[1] = 4.0;
+  translation[2] = 2.5;
+  translationTransform->Translate( translation );
+
+  using EulerTransformType = itk::Euler3DTransform<ScalarType>;
+  EulerTransformType::Pointer eulerTransform = EulerTransformType::New();
+  eulerTransform->SetRotation( 0.1, -0.2, 0.3 );
+  EulerTransformType::InputPointType center;
+  center.Fill( 10.0 );
+  eulerTransform->SetCenter( center );
+
+  using ScaleTransformType = itk::ScaleTransform<ScalarType, Dimension>;
+  ScaleTransformType::Pointer scaleTransform = ScaleTransformType::New();
+  ScaleTransformType::ScaleType scale;
+  scale[0] = 1.2;
+  scale[1] = 0.8;
+  scale[2] = 1.0;
+  scaleTransform->SetScale( scale );
+
+  // Nonlinear transform
+  using BSplineTransformType = itk::BSplineTransform<ScalarType, Dimension, 3>;
+  BSplineTransformType::Pointer bsplineTransform = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType physicalDimensions;
+  physicalDimensions.Fill( 40.0 );
+  bsplineTransform->SetTransformDomainPhysicalDimensions( physicalDimensions );
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill( 4 );
+  bsplineTransform->SetTransformDomainMeshSize( meshSize );
+  BSplineTransformType::ParametersType parameters( bsplineTransform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.Size(); ++i )
+    {
+    parameters[i] = 0.5 * std::sin( 0.37 * i );
+    }
+  bsplineTransform->SetParameters( parameters );
+
+  // The queue is: [ nested( affine, translation ), euler, bspline, scale, affine ]
+  CompositeTransformType::Pointer nestedTransform = CompositeTransformType::New();
+  nestedTransform->AddTransform( affineTransform );
+  nestedTransform->AddTransform( translationTransform );
+
+  CompositeTransformType::Pointer compositeTransform = CompositeTransformType::New();
+  compositeTransform->AddTransform( nestedTransform );
+  compositeTransform->AddTransform( eulerTransform );
+  compositeTransform->AddTransform( bsplineTransform );
+  compositeTransform->AddTransform( scaleTransform );
+  compositeTransform->AddTransform( affineTransform );
+  compositeTransform->SetAllTransformsToOptimizeOff();
+  compositeTransform->SetNthTransformToOptimizeOn( 1 );
+  compositeTransform->SetNthTransformToOptimizeOn( 2 );
+
+  // Keep an uncollapsed copy as the reference.
+  CompositeTransformType::Pointer referenceTransform = compositeTransform->Clone();
+
+  TEST_EXPECT_EQUAL( compositeTransform->CollapseLinearTransforms(), 3u );
+  TEST_EXPECT_EQUAL( compositeTransform->GetNumberOfTransforms(), 3u );
+  TEST_EXPECT_TRUE( compositeTransform->GetNthTransformConstPointer( 0 )->IsLinear() );
+  TEST_EXPECT_TRUE( compositeTransform->GetNthTransformConstPointer( 1 ) == bsplineTransform.GetPointer() );
+  TEST_EXPECT_TRUE( compositeTransform->GetNthTransformConstPointer( 2 )->IsLinear() );
+
+  // The first run holds the Euler transform, which is optimized.
+  TEST_EXPECT_TRUE( compositeTransform->GetNthTransformToOptimize( 0 ) );
+  TEST_EXPECT_TRUE( compositeTransform->GetNthTransformToOptimize( 1 ) );
+  TEST_EXPECT_TRUE( !compositeTransform->GetNthTransformToOptimize( 2 ) );
+
+  // Nothing is left to collapse.
+  TEST_EXPECT_EQUAL( compositeTransform->CollapseLinearTransforms(), 0u );
+
+  bool testPassed = true;
+  CompositeTransformType::InputPointType point;
+  for( unsigned int i = 0; i < 100; ++i )
+    {
+    point[0] = 40.0 * std::fabs( std::sin( 1.3 * i ) );
+    point[1] = 40.0 * std::fabs( std::cos( 0.7 * i ) );
+    point[2] = 40.0 * std::fabs( std::sin( 0.3 * i + 1.0 ) );
+    const CompositeTransformType::OutputPointType expected = referenceTransform->TransformPoint( point );
+    const CompositeTransformType::OutputPointType collapsed = compositeTransform->TransformPoint( point );
+    if( expected.EuclideanDistanceTo( collapsed ) > 1e-9 )
+      {
+      std::cerr << "Collapsed transform maps " << point << " to " << collapsed
+                << " instead of " << expected << std::endl;
+      testPassed = false;
+      }
+    }
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAffineTransform.h"
+#include "itkBSplineTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkTranslationTransform.h"
+#include "itkTestingMacros.h"
+
+#include <vector>
+
+/*
+ * Check that TransformPoints() gives the same points as TransformPoint(),
+ * into a separate array and in place, for the default implementation and
+ * the matrix, B-spline and composite overrides.
+ */
+namespace
+{
+template<typename TTransform>
+bool
+CompareTransformPoints( const TTransform *transform, const char *name )
+{
+  using PointType = typename TTransform::InputPointType;
+
+  // More points than one block of the composite transform.
+  constexpr itk::SizeValueType numberOfPoints = 2500;
+  std::vector<PointType> points( numberOfPoints );
+  for( itk::SizeValueType n = 0; n < numberOfPoints; ++n )
+    {
+    for( unsigned int d = 0; d < TTransform::InputSpaceDimension; ++d )
+      {
+      points[n][d] = 50.0 * std::fabs( std::sin( 0.37 * n + 1.1 * d ) ) - 5.0;
+      }
+    }
+
+  std::vector<PointType> transformedPoints( numberOfPoints );
+  transform->TransformPoints( points.data(), transformedPoints.data(), numberOfPoints );
+  std::vector<PointType> inPlacePoints( points );
+  transform->TransformPoints( inPlacePoints.data(), inPlacePoints.data(), numberOfPoints );
+
+  for( itk::SizeValueType n = 0; n < numberOfPoints; ++n )
+    {
+    const PointType expected = transform->TransformPoint( points[n] );
+    if( expected.EuclideanDistanceTo( transformedPoints[n] ) > 1e-10 ||
+        expected.EuclideanDistanceTo( inPlacePoints[n] ) > 1e-10 )
+      {
+      std::cerr << name << ": TransformPoints() maps " << points[n] << " to " << transformedPoints[n]
+                << " (in place " << inPlacePoints[n] << ") instead of " << expected << std::endl;
+      return false;
+      }
+    }
+  std::cout << name << ": OK" << std::endl;
+  return true;
+}
+}
+
+int itkTransformTransformPointsTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 3;
+  using ScalarType = double;
+
+  // Default implementation
+  using TranslationTransformType = itk::TranslationTransform<ScalarType, Dimension>;
+  TranslationTransformType::Pointer translationTransform = TranslationTransformType::New();
+  TranslationTransformType::OutputVectorType translation;
+  translation[0] = 1.0;
+  translation[1] = -2.0;
+  translation[2] = 3.5;
+  translationTransform->Translate( translation );
+
+  using AffineTransformType = itk::AffineTransform<ScalarType, Dimension>;
+  AffineTransformType::Pointer affineTransform = AffineTransformType::New();
+  AffineTransformType::OutputVectorType axis;
+  axis[0] = 1.0;
+  axis[1] = 2.0;
+  axis[2] = -1.0;
+  affineTransform->Rotate3D( axis, 0.3 );
+  affineTransform->Scale( 1.1 );
+  affineTransform->Translate( translation );
+
+  using BSplineTransformType = itk::BSplineTransform<ScalarType, Dimension, 3>;
+  BSplineTransformType::Pointer bsplineTransform = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType physicalDimensions;
+  physicalDimensions.Fill( 40.0 );
+  bsplineTransform->SetTransformDomainPhysicalDimensions( physicalDimensions );
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill( 4 );
+  bsplineTransform->SetTransformDomainMeshSize( meshSize );
+  BSplineTransformType::ParametersType parameters( bsplineTransform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.Size(); ++i )
+    {
+    parameters[i] = std::cos( 0.21 * i );
+    }
+  bsplineTransform->SetParameters( parameters );
+
+  using CompositeTransformType = itk::CompositeTransform<ScalarType, Dimension>;
+  CompositeTransformType::Pointer compositeTransform = CompositeTransformType::New();
+  compositeTransform->AddTransform( affineTransform );
+  compositeTransform->AddTransform( bsplineTransform );
+  compositeTransform->AddTransform( translationTransform );
+
+  CompositeTransformType::Pointer emptyCompositeTransform = CompositeTransformType::New();
+
+  bool testPassed = true;
+  testPassed &= CompareTransformPoints( translationTransform.GetPointer(), "TranslationTransform" );
+  testPassed &= CompareTransformPoints( affineTransform.GetPointer(), "AffineTransform" );
+  testPassed &= CompareTransformPoints( bsplineTransform.GetPointer(), "BSplineTransform" );
+  testPassed &= CompareTransformPoints( compositeTransform.GetPointer(), "CompositeTransform" );
+
+  // An empty composite transform copies the points.
+  CompositeTransformType::InputPointType points[2];
+  CompositeTransformType::OutputPointType copiedPoints[2];
+  points[0].Fill( 1.0 );
+  points[1].Fill( -3.0 );
+  emptyCompositeTransform->TransformPoints( points, copiedPoints, 2 );
+  TEST_EXPECT_TRUE( copiedPoints[0] == points[0] && copiedPoints[1] == points[1] );
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -211,6 +211,11 @@ public:
    * be returned with zero displacemnt. */
   OutputPointType TransformPoint( const InputPointType& thisPoint ) const override;
 
+  /**  Method to transform an array of points.  Each point is mapped to a
+   * continuous index of the field only once. */
+  void TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                        SizeValueType numberOfPoints ) const override;
+
   /**  Method to transform a vector. */
   using Superclass::TransformVector;
   OutputVectorType TransformVector(const InputVectorType &) const override
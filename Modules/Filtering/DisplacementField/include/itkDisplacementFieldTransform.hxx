@@ -98,6 +98,44 @@ DisplacementFieldTransform<TParametersValueType, NDimensions>
   return outputPoint;
 }
 
+template<typename TParametersValueType, unsigned int NDimensions>
+void
+DisplacementFieldTransform<TParametersValueType, NDimensions>
+::TransformPoints( const InputPointType *inputPoints, OutputPointType *outputPoints,
+                   SizeValueType numberOfPoints ) const
+{
+  if( !this->m_DisplacementField )
+    {
+    itkExceptionMacro( "No displacement field is specified." );
+    }
+  if( !this->m_Interpolator )
+    {
+    itkExceptionMacro( "No interpolator is specified." );
+    }
+
+  const DisplacementFieldType * displacementField = this->m_DisplacementField.GetPointer();
+  const InterpolatorType * interpolator = this->m_Interpolator.GetPointer();
+
+  typename InterpolatorType::ContinuousIndexType cidx;
+  typename InterpolatorType::PointType point;
+  for( SizeValueType n = 0; n < numberOfPoints; n++ )
+    {
+    point.CastFrom( inputPoints[n] );
+    outputPoints[n].CastFrom( point );
+
+    // Same test as IsInsideBuffer( point ), without converting the point twice.
+    displacementField->TransformPhysicalPointToContinuousIndex( point, cidx );
+    if( interpolator->IsInsideBuffer( cidx ) )
+      {
+      const typename InterpolatorType::OutputType displacement = interpolator->EvaluateAtContinuousIndex( cidx );
+      for( unsigned int ii = 0; ii < NDimensions; ++ii )
+        {
+        outputPoints[n][ii] += displacement[ii];
+        }
+      }
+    }
+}
+
 template<typename TParametersValueType, unsigned int NDimensions>
 bool DisplacementFieldTransform<TParametersValueType, NDimensions>
 ::GetInverse( Self *inverse ) const
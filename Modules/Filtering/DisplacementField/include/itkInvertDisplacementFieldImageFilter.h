@@ -19,9 +19,11 @@
 #define itkInvertDisplacementFieldImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include "itkContinuousIndex.h"
 #include "itkVectorInterpolateImageFunction.h"
 #include "itkVectorLinearInterpolateImageFunction.h"
 #include <mutex>
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +33,21 @@ namespace itk
  *
  * \brief Iteratively estimate the inverse field of a displacement field.
  *
+ * The inverse is estimated with a fixed point iteration: at each iteration
+ * the field is composed with the current inverse estimate, and the estimate
+ * is corrected by a fraction of the composition error.  The composition and
+ * the error norms are computed in a single pass over the field buffers.
+ *
+ * The iteration may start from an initial estimate, e.g. the inverse found at
+ * the previous iteration of a registration, which may be defined on a
+ * different grid than the field.  With more than one level, the inverse is
+ * first estimated on the field subsampled by 2^(NumberOfLevels-1), ..., 2,
+ * each result being upsampled as the estimate of the next finer level, so
+ * that the full resolution iterations start close to the solution.
+ *
+ * The error norms of each iteration are recorded and can be retrieved after
+ * the update, together with the number of iterations performed.
+ *
  * \author Nick Tustison
  * \author Brian Avants
  *
@@ -77,6 +94,8 @@ public:
   /** Other type alias */
   using RealType = typename VectorType::ComponentType;
   using RealImageType = Image<RealType, ImageDimension>;
+  using ErrorNormHistoryType = std::vector<RealType>;
+  using ContinuousIndexType = ContinuousIndex<double, ImageDimension>;
   using InterpolatorType = VectorInterpolateImageFunction<InputFieldType, RealType>;
   using DefaultInterpolatorType =
       VectorLinearInterpolateImageFunction <InputFieldType, RealType>;
@@ -107,11 +126,17 @@ public:
     return this->GetInput( 0 );
     }
 
-  /** Set/get the initial estimate for the inverse field (optional). */
+  /** Set/get the initial estimate for the inverse field (optional).  If it
+   * is not defined on the same grid as the displacement field, it is
+   * linearly resampled. */
   itkSetInputMacro( InverseFieldInitialEstimate, InverseDisplacementFieldType );
   itkGetInputMacro( InverseFieldInitialEstimate, InverseDisplacementFieldType );
 
-  /* Set the interpolator. */
+  /** Set the interpolator used to compose the field with the inverse
+   * estimate.  The default linear interpolation is evaluated directly on the
+   * field buffer; any other interpolator, e.g. a B-spline one, is evaluated
+   * through the interpolator.  Note that earlier versions of this filter
+   * ignored the interpolator set here. */
   virtual void SetInterpolator( InterpolatorType* interpolator );
 
   /* Set/Get the number of iterations */
@@ -136,6 +161,25 @@ public:
   itkSetMacro( EnforceBoundaryCondition, bool );
   itkGetMacro( EnforceBoundaryCondition, bool );
 
+  /** Set/Get the number of multigrid levels.  Each level runs at most
+   * \c MaximumNumberOfIterations iterations.  Default is 1, i.e. only the
+   * full resolution field is iterated on. */
+  itkSetClampMacro( NumberOfLevels, unsigned int, 1, NumericTraits<unsigned int>::max() );
+  itkGetConstMacro( NumberOfLevels, unsigned int );
+
+  /** Get the number of iterations performed during the last update, summed
+   * over all levels. */
+  itkGetConstMacro( NumberOfIterationsPerformed, unsigned int );
+
+  /** Get the mean and max error norms, in voxels, measured at each iteration
+   * of the last update, coarsest level first. */
+  itkGetConstReferenceMacro( MeanErrorNormHistory, ErrorNormHistoryType );
+  itkGetConstReferenceMacro( MaxErrorNormHistory, ErrorNormHistoryType );
+
+  /** Get whether the tolerances were met at the finest level during the
+   * last update. */
+  itkGetConstMacro( Converged, bool );
+
 protected:
 
   /** Constructor */
@@ -147,6 +191,18 @@ protected:
   /** Standard print self function **/
   void PrintSelf( std::ostream& os, Indent indent ) const override;
 
+  /** The initial estimate is requested entirely, since it may be defined
+   * on a different grid than the output. */
+  void GenerateInputRequestedRegion() override;
+
+  /** The initial estimate does not need to occupy the same physical space
+   * as the displacement field, since it is resampled.  The other inputs are
+   * verified as in ImageToImageFilter.
+   *
+   * \sa ProcessObject::VerifyInputInformation
+   */
+  void VerifyInputInformation() ITKv5_CONST override;
+
   /** preprocessing function */
   void GenerateData() override;
 
@@ -154,6 +210,20 @@ protected:
   void DynamicThreadedGenerateData( const RegionType & ) override;
 
 private:
+  /** Run the fixed point iteration of one level. */
+  void EstimateInverse( const DisplacementFieldType *field, InverseDisplacementFieldType *inverseField,
+    bool isFinestLevel, float startProgress, float endProgress );
+
+  /** Linearly resample a field onto the grid of another one, clamping to the
+   * source buffer outside of it. */
+  template<typename TSourceField, typename TTargetField>
+  void ResampleField( const TSourceField *source, TTargetField *target );
+
+  /** Linearly interpolate a field at a continuous index, clamping the
+   * neighbors to the buffered region. */
+  template<typename TField>
+  static void InterpolateField( const TField *field, const ContinuousIndexType & cindex, VectorType & value );
+
   /** The interpolator. */
   typename InterpolatorType::Pointer m_Interpolator;
 
@@ -173,6 +243,18 @@ private:
   SpacingType m_DisplacementFieldSpacing;
   bool        m_DoThreadedEstimateInverse{false};
   bool        m_EnforceBoundaryCondition{true};
+
+  unsigned int         m_NumberOfLevels{1};
+  unsigned int         m_NumberOfIterationsPerformed{0};
+  ErrorNormHistoryType m_MeanErrorNormHistory;
+  ErrorNormHistoryType m_MaxErrorNormHistory;
+  bool                 m_Converged{false};
+
+  // fields of the level being iterated on
+  bool                           m_UseInterpolator{false};
+  bool                           m_EnforceBoundaryConditionOnLevel{true};
+  const DisplacementFieldType *  m_CurrentField{nullptr};
+  InverseDisplacementFieldType * m_CurrentInverseField{nullptr};
   std::mutex  m_Mutex;
 
 };
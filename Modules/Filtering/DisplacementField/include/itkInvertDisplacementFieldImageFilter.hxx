@@ -20,9 +20,9 @@
 
 #include "itkInvertDisplacementFieldImageFilter.h"
 
-#include "itkComposeDisplacementFieldsImageFilter.h"
-#include "itkImageDuplicator.h"
+#include "itkImageAlgorithm.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
 #include <mutex>
 #include "itkProgressTransformer.h"
 
@@ -66,6 +66,62 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     }
 }
 
+template<typename TInputImage, typename TOutputImage>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * initialEstimate = const_cast<InverseDisplacementFieldType *>( this->GetInverseFieldInitialEstimate() );
+  if( initialEstimate )
+    {
+    initialEstimate->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<typename TInputImage, typename TOutputImage>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::VerifyInputInformation() ITKv5_CONST
+{
+  using ImageBaseType = const ImageBase<ImageDimension>;
+
+  const auto * field = dynamic_cast<ImageBaseType *>( this->ProcessObject::GetPrimaryInput() );
+  if( field == nullptr )
+    {
+    return;
+    }
+
+  // The tolerances are those of ImageToImageFilter::VerifyInputInformation().
+  const SpacePrecisionType coordinateTolerance = std::abs( this->GetCoordinateTolerance() * field->GetSpacing()[0] );
+  const SpacePrecisionType directionTolerance = this->GetDirectionTolerance();
+
+  for( InputDataObjectConstIterator it( this ); !it.IsAtEnd(); ++it )
+    {
+    // the initial estimate is resampled on the grid of the field
+    if( it.GetName() == "InverseFieldInitialEstimate" )
+      {
+      continue;
+      }
+    const auto * input = dynamic_cast<ImageBaseType *>( it.GetInput() );
+    if( input == nullptr || input == field )
+      {
+      continue;
+      }
+    if( !field->GetOrigin().GetVnlVector().is_equal( input->GetOrigin().GetVnlVector(), coordinateTolerance ) ||
+        !field->GetSpacing().GetVnlVector().is_equal( input->GetSpacing().GetVnlVector(), coordinateTolerance ) ||
+        !field->GetDirection().GetVnlMatrix().as_ref().is_equal( input->GetDirection().GetVnlMatrix(),
+          directionTolerance ) )
+      {
+      itkExceptionMacro( "Inputs do not occupy the same physical space! Displacement field origin: "
+        << field->GetOrigin() << ", spacing: " << field->GetSpacing() << ", direction: " << field->GetDirection()
+        << "; input " << it.GetName() << " origin: " << input->GetOrigin() << ", spacing: " << input->GetSpacing()
+        << ", direction: " << input->GetDirection() );
+      }
+    }
+}
+
 template<typename TInputImage, typename TOutputImage>
 void
 InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
@@ -78,40 +134,147 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
 
   typename DisplacementFieldType::ConstPointer displacementField = this->GetInput();
 
-  typename InverseDisplacementFieldType::Pointer inverseDisplacementField;
+  typename InverseDisplacementFieldType::Pointer inverseDisplacementField = this->GetOutput();
 
-  if( this->GetInverseFieldInitialEstimate() )
+  const InverseDisplacementFieldType * initialEstimate = this->GetInverseFieldInitialEstimate();
+  if( initialEstimate )
     {
-    using DuplicatorType = ImageDuplicator<InverseDisplacementFieldType>;
-    typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-    duplicator->SetInputImage( this->GetInverseFieldInitialEstimate() );
-    duplicator->Update();
-
-    inverseDisplacementField = duplicator->GetOutput();
-
-    this->SetNthOutput( 0, inverseDisplacementField );
+    const RegionType & region = inverseDisplacementField->GetBufferedRegion();
+    if( initialEstimate->GetBufferedRegion() == region &&
+        initialEstimate->GetOrigin() == inverseDisplacementField->GetOrigin() &&
+        initialEstimate->GetSpacing() == inverseDisplacementField->GetSpacing() &&
+        initialEstimate->GetDirection() == inverseDisplacementField->GetDirection() )
+      {
+      ImageAlgorithm::Copy( initialEstimate, inverseDisplacementField.GetPointer(), region, region );
+      }
+    else
+      {
+      this->ResampleField( initialEstimate, inverseDisplacementField.GetPointer() );
+      }
     }
   else
     {
-    inverseDisplacementField = this->GetOutput();
     inverseDisplacementField->FillBuffer( zeroVector );
     }
 
+  // The error norms are measured in voxels of the full resolution field on
+  // all levels, so that the tolerances have the same meaning on each level.
   for( unsigned int d = 0; d < ImageDimension; d++ )
     {
     this->m_DisplacementFieldSpacing[d] = displacementField->GetSpacing()[d];
     }
 
-  this->m_ScaledNormImage->CopyInformation( displacementField );
-  this->m_ScaledNormImage->SetRegions( displacementField->GetRequestedRegion() );
-  this->m_ScaledNormImage->Allocate(true); // initialize buffer to zero
+  this->m_NumberOfIterationsPerformed = 0;
+  this->m_MeanErrorNormHistory.clear();
+  this->m_MaxErrorNormHistory.clear();
+  this->m_Converged = false;
+
+  const float levelProgress = 1.0f / static_cast<float>( this->m_NumberOfLevels );
+
+  if( this->m_NumberOfLevels > 1 )
+    {
+    // Coarse-to-fine: each coarse level starts from the resampled estimate of
+    // the previous one, the coarsest from the resampled initial estimate.
+    typename InverseDisplacementFieldType::Pointer previousInverseField = inverseDisplacementField;
+    const SizeType size = displacementField->GetBufferedRegion().GetSize();
+    PointType firstNode;
+    displacementField->TransformIndexToPhysicalPoint( displacementField->GetBufferedRegion().GetIndex(), firstNode );
+
+    for( unsigned int level = this->m_NumberOfLevels - 1; level > 0; level-- )
+      {
+      // The nodes of the coarse grids coincide with nodes of the field so
+      // that the coarse fields are exact samples of the field.
+      SpacingType coarseSpacing;
+      SizeType coarseSize;
+      for( unsigned int d = 0; d < ImageDimension; d++ )
+        {
+        // keep at least a few voxels along each dimension
+        SizeValueType factor = static_cast<SizeValueType>( 1 ) << std::min( level, 16u );
+        while( factor > 1 && size[d] / factor < 4 )
+          {
+          factor >>= 1;
+          }
+        coarseSpacing[d] = displacementField->GetSpacing()[d] * static_cast<double>( factor );
+        coarseSize[d] = ( size[d] - 1 ) / factor + 1;
+        }
+
+      typename DisplacementFieldType::Pointer coarseField = DisplacementFieldType::New();
+      coarseField->CopyInformation( displacementField );
+      coarseField->SetOrigin( firstNode );
+      coarseField->SetSpacing( coarseSpacing );
+      coarseField->SetRegions( coarseSize );
+      coarseField->Allocate();
+      this->ResampleField( displacementField.GetPointer(), coarseField.GetPointer() );
+
+      typename InverseDisplacementFieldType::Pointer coarseInverseField = InverseDisplacementFieldType::New();
+      coarseInverseField->CopyInformation( coarseField );
+      coarseInverseField->SetRegions( coarseField->GetBufferedRegion() );
+      coarseInverseField->Allocate();
+      this->ResampleField( previousInverseField.GetPointer(), coarseInverseField.GetPointer() );
+
+      const unsigned int levelIndex = this->m_NumberOfLevels - 1 - level;
+      this->EstimateInverse( coarseField, coarseInverseField, false,
+        levelIndex * levelProgress, ( levelIndex + 1 ) * levelProgress );
+
+      previousInverseField = coarseInverseField;
+      }
+
+    this->ResampleField( previousInverseField.GetPointer(), inverseDisplacementField.GetPointer() );
+    }
+
+  this->EstimateInverse( displacementField, inverseDisplacementField, true,
+    1.0f - levelProgress, 1.0f );
 
-  SizeValueType numberOfPixelsInRegion = ( displacementField->GetRequestedRegion() ).GetNumberOfPixels();
+  this->m_CurrentField = nullptr;
+  this->m_CurrentInverseField = nullptr;
+
+  this->UpdateProgress(1.0f);
+}
+
+template<typename TInputImage, typename TOutputImage>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::EstimateInverse( const DisplacementFieldType *field, InverseDisplacementFieldType *inverseField,
+  bool isFinestLevel, float startProgress, float endProgress )
+{
+  this->m_CurrentField = field;
+  this->m_CurrentInverseField = inverseField;
+
+  // The boundary of a subsampled field lies inside the boundary of the
+  // field, so the boundary condition is only enforced at full resolution.
+  this->m_EnforceBoundaryConditionOnLevel = ( isFinestLevel && this->m_EnforceBoundaryCondition );
+
+  const RegionType region = inverseField->GetBufferedRegion();
+
+  // The work buffers are only reallocated when the grid changes.
+  this->m_ComposedField->CopyInformation( field );
+  if( this->m_ComposedField->GetBufferedRegion() != region )
+    {
+    this->m_ComposedField->SetRegions( region );
+    this->m_ComposedField->Allocate();
+    }
+  this->m_ScaledNormImage->CopyInformation( field );
+  if( this->m_ScaledNormImage->GetBufferedRegion() != region )
+    {
+    this->m_ScaledNormImage->SetRegions( region );
+    this->m_ScaledNormImage->Allocate();
+    }
+
+  // The default linear interpolator is evaluated inline; any other
+  // interpolator is used through its own interface.
+  this->m_UseInterpolator = ( dynamic_cast<DefaultInterpolatorType *>( this->m_Interpolator.GetPointer() ) == nullptr );
+  if( this->m_UseInterpolator )
+    {
+    this->m_Interpolator->SetInputImage( field );
+    }
+
+  SizeValueType numberOfPixelsInRegion = region.GetNumberOfPixels();
   this->m_MaxErrorNorm = NumericTraits<RealType>::max();
   this->m_MeanErrorNorm = NumericTraits<RealType>::max();
   unsigned int iteration = 0;
 
-  float oldProgress = 0.0f;
+  const float progressRange = endProgress - startProgress;
+  float oldProgress = startProgress;
 
   while( iteration++ < this->m_MaximumNumberOfIterations &&
     this->m_MaxErrorNorm > this->m_MaxErrorToleranceThreshold &&
@@ -120,31 +283,28 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     itkDebugMacro( "Iteration " << iteration << ": mean error norm = " << this->m_MeanErrorNorm
       << ", max error norm = " << this->m_MaxErrorNorm );
 
-    using ComposerType = ComposeDisplacementFieldsImageFilter<DisplacementFieldType>;
-    typename ComposerType::Pointer composer = ComposerType::New();
-    composer->SetDisplacementField( displacementField );
-    composer->SetWarpingField( inverseDisplacementField );
-
-    this->m_ComposedField = composer->GetOutput();
-    this->m_ComposedField->Update();
-    this->m_ComposedField->DisconnectPipeline();
-
-    // Multithread processing to multiply each element of the composed field by 1 / spacing
+    // Multithread processing to compose the field with the current inverse
+    // estimate and to compute the norms of the composition error, scaled by
+    // 1 / spacing
     this->m_MeanErrorNorm = NumericTraits<RealType>::ZeroValue();
     this->m_MaxErrorNorm = NumericTraits<RealType>::ZeroValue();
 
-    float newProgress = float(2 * iteration - 1) / (2 * m_MaximumNumberOfIterations);
+    float newProgress = startProgress + progressRange * float(2 * iteration - 1) / (2 * m_MaximumNumberOfIterations);
     ProgressTransformer pt( oldProgress, newProgress, this );
     this->m_DoThreadedEstimateInverse = false;
     this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
     this->GetMultiThreader()->template ParallelizeImageRegion<TOutputImage::ImageDimension>(
-        this->GetOutput()->GetRequestedRegion(),
+        region,
         [this](const OutputImageRegionType & outputRegionForThread)
           { this->DynamicThreadedGenerateData(outputRegionForThread); },
         pt.GetProcessObject() );
 
     this->m_MeanErrorNorm /= static_cast<RealType>( numberOfPixelsInRegion );
 
+    this->m_MeanErrorNormHistory.push_back( this->m_MeanErrorNorm );
+    this->m_MaxErrorNormHistory.push_back( this->m_MaxErrorNorm );
+    ++this->m_NumberOfIterationsPerformed;
+
     this->m_Epsilon = 0.5;
     if( iteration == 1 )
       {
@@ -152,19 +312,28 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
       }
 
     oldProgress=newProgress;
-    newProgress = float(2 * iteration) / (2 * m_MaximumNumberOfIterations);
+    newProgress = startProgress + progressRange * float(2 * iteration) / (2 * m_MaximumNumberOfIterations);
     ProgressTransformer pt2( oldProgress, newProgress, this );
     // Multithread processing to estimate inverse field
     this->m_DoThreadedEstimateInverse = true;
     this->GetMultiThreader()->template ParallelizeImageRegion<TOutputImage::ImageDimension>(
-        this->GetOutput()->GetRequestedRegion(),
+        region,
         [this](const OutputImageRegionType & outputRegionForThread)
           { this->DynamicThreadedGenerateData(outputRegionForThread); },
         pt2.GetProcessObject() );
     oldProgress=newProgress;
     }
 
-  this->UpdateProgress(1.0f);
+  if( this->m_UseInterpolator )
+    {
+    this->m_Interpolator->SetInputImage( this->GetInput() );
+    }
+
+  if( isFinestLevel )
+    {
+    this->m_Converged = ( this->m_MaxErrorNorm <= this->m_MaxErrorToleranceThreshold ||
+      this->m_MeanErrorNorm <= this->m_MeanErrorToleranceThreshold );
+    }
 }
 
 template<typename TInputImage, typename TOutputImage>
@@ -172,18 +341,17 @@ void
 InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
 ::DynamicThreadedGenerateData( const RegionType & region )
 {
-  const typename DisplacementFieldType::RegionType fullRegion = this->m_ComposedField->GetRequestedRegion();
+  const typename DisplacementFieldType::RegionType fullRegion = this->m_CurrentInverseField->GetBufferedRegion();
   const typename DisplacementFieldType::SizeType size = fullRegion.GetSize();
   const typename DisplacementFieldType::IndexType startIndex = fullRegion.GetIndex();
   const typename DisplacementFieldType::PixelType zeroVector( 0.0 );
 
   ImageRegionIterator<DisplacementFieldType> ItE( this->m_ComposedField, region );
   ImageRegionIterator<RealImageType> ItS( this->m_ScaledNormImage, region );
+  ImageRegionIteratorWithIndex<InverseDisplacementFieldType> ItI( this->m_CurrentInverseField, region );
 
   if( this->m_DoThreadedEstimateInverse )
     {
-    ImageRegionIterator<DisplacementFieldType> ItI( this->GetOutput(), region );
-
     for( ItI.GoToBegin(), ItE.GoToBegin(), ItS.GoToBegin(); !ItI.IsAtEnd(); ++ItI, ++ItE, ++ItS )
       {
       VectorType update = ItE.Get();
@@ -196,7 +364,7 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
       update = ItI.Get() + update * this->m_Epsilon;
       ItI.Set( update );
       typename DisplacementFieldType::IndexType index = ItI.GetIndex();
-      if( this->m_EnforceBoundaryCondition )
+      if( this->m_EnforceBoundaryConditionOnLevel )
         {
         for( unsigned int d = 0; d < ImageDimension; d++ )
           {
@@ -211,6 +379,20 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     }
   else
     {
+    // Compose the field with the inverse estimate as in
+    // ComposeDisplacementFieldsImageFilter.  Both fields share the same grid,
+    // so the warped point is found directly in continuous index space.
+    DirectionType physicalPointToIndex = this->m_CurrentField->GetInverseDirection();
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+      for( unsigned int j = 0; j < ImageDimension; ++j )
+        {
+        physicalPointToIndex[i][j] /= this->m_CurrentField->GetSpacing()[i];
+        }
+      }
+    const typename DisplacementFieldType::IndexType & bufferStart = this->m_CurrentField->GetBufferedRegion().GetIndex();
+    const typename DisplacementFieldType::SizeType & bufferSize = this->m_CurrentField->GetBufferedRegion().GetSize();
+
     VectorType inverseSpacing;
     RealType localMean = NumericTraits<RealType>::ZeroValue();
     RealType localMax  = NumericTraits<RealType>::ZeroValue();
@@ -218,9 +400,50 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
       {
       inverseSpacing[d]=1.0/this->m_DisplacementFieldSpacing[d];
       }
-    for( ItE.GoToBegin(), ItS.GoToBegin(); !ItE.IsAtEnd(); ++ItE, ++ItS )
+    for( ItI.GoToBegin(), ItE.GoToBegin(), ItS.GoToBegin(); !ItI.IsAtEnd(); ++ItI, ++ItE, ++ItS )
       {
-      const VectorType & displacement = ItE.Get();
+      const VectorType warpVector = ItI.Get();
+      const IndexType & index = ItI.GetIndex();
+
+      ContinuousIndexType cindex;
+      bool isInsideBuffer = true;
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+        double value = static_cast<double>( index[i] );
+        for( unsigned int j = 0; j < ImageDimension; ++j )
+          {
+          value += physicalPointToIndex[i][j] * warpVector[j];
+          }
+        cindex[i] = value;
+        isInsideBuffer = isInsideBuffer && value >= bufferStart[i] - 0.5 &&
+          value < bufferStart[i] + static_cast<double>( bufferSize[i] ) - 0.5;
+        }
+
+      VectorType displacement = warpVector;
+      if( isInsideBuffer )
+        {
+        VectorType fieldVector;
+        if( this->m_UseInterpolator )
+          {
+          typename InterpolatorType::ContinuousIndexType interpolatorIndex;
+          for( unsigned int d = 0; d < ImageDimension; ++d )
+            {
+            interpolatorIndex[d] = cindex[d];
+            }
+          const typename InterpolatorType::OutputType interpolated =
+            this->m_Interpolator->EvaluateAtContinuousIndex( interpolatorIndex );
+          for( unsigned int d = 0; d < ImageDimension; ++d )
+            {
+            fieldVector[d] = interpolated[d];
+            }
+          }
+        else
+          {
+          Self::InterpolateField( this->m_CurrentField, cindex, fieldVector );
+          }
+        displacement += fieldVector;
+        }
+
       RealType scaledNorm = 0.0;
       for( unsigned int d = 0; d < ImageDimension; ++d )
         {
@@ -248,6 +471,99 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
     }
 }
 
+template<typename TInputImage, typename TOutputImage>
+template<typename TSourceField, typename TTargetField>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::ResampleField( const TSourceField *source, TTargetField *target )
+{
+  const typename TSourceField::RegionType & sourceRegion = source->GetBufferedRegion();
+
+  this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+    target->GetBufferedRegion(),
+    [source, target, &sourceRegion]( const RegionType & region )
+      {
+      PointType point;
+      ContinuousIndexType cindex;
+      VectorType value;
+      ImageRegionIteratorWithIndex<TTargetField> It( target, region );
+      for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+        {
+        target->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+        source->TransformPhysicalPointToContinuousIndex( point, cindex );
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          const double first = static_cast<double>( sourceRegion.GetIndex()[d] );
+          const double last = first + static_cast<double>( sourceRegion.GetSize()[d] ) - 1.0;
+          cindex[d] = std::min( std::max( cindex[d], first ), last );
+          }
+        Self::InterpolateField( source, cindex, value );
+
+        typename TTargetField::PixelType pixel;
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          pixel[d] = static_cast<typename TTargetField::PixelType::ValueType>( value[d] );
+          }
+        It.Set( pixel );
+        }
+      }, nullptr );
+}
+
+template<typename TInputImage, typename TOutputImage>
+template<typename TField>
+void
+InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::InterpolateField( const TField *field, const ContinuousIndexType & cindex, VectorType & value )
+{
+  constexpr unsigned int NumberOfNeighbors = 1u << ImageDimension;
+
+  const typename TField::RegionType & region = field->GetBufferedRegion();
+  const OffsetValueType * offsetTable = field->GetOffsetTable();
+  const typename TField::PixelType * buffer = field->GetBufferPointer();
+
+  OffsetValueType lowerOffset[ImageDimension];
+  OffsetValueType upperOffset[ImageDimension];
+  double distance[ImageDimension];
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    const IndexValueType first = region.GetIndex()[d];
+    const IndexValueType last = first + static_cast<IndexValueType>( region.GetSize()[d] ) - 1;
+    const IndexValueType baseIndex = Math::Floor<IndexValueType>( cindex[d] );
+    distance[d] = cindex[d] - static_cast<double>( baseIndex );
+    lowerOffset[d] = ( std::min( std::max( baseIndex, first ), last ) - first ) * offsetTable[d];
+    upperOffset[d] = ( std::min( std::max( baseIndex + 1, first ), last ) - first ) * offsetTable[d];
+    }
+
+  value.Fill( 0.0 );
+  for( unsigned int counter = 0; counter < NumberOfNeighbors; counter++ )
+    {
+    double weight = 1.0;
+    OffsetValueType offset = 0;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if( counter & ( 1u << d ) )
+        {
+        offset += upperOffset[d];
+        weight *= distance[d];
+        }
+      else
+        {
+        offset += lowerOffset[d];
+        weight *= 1.0 - distance[d];
+        }
+      }
+    if( weight != 0.0 )
+      {
+      const typename TField::PixelType & neighbor = buffer[offset];
+      for( unsigned int k = 0; k < ImageDimension; k++ )
+        {
+        value[k] += static_cast<RealType>( weight * neighbor[k] );
+        }
+      }
+    }
+}
+
 template<typename TInputImage, typename TOutputImage>
 void
 InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
@@ -260,6 +576,9 @@ InvertDisplacementFieldImageFilter<TInputImage, TOutputImage>
   os << "Maximum number of iterations: " << this->m_MaximumNumberOfIterations << std::endl;
   os << "Max error tolerance threshold: " << this->m_MaxErrorToleranceThreshold << std::endl;
   os << "Mean error tolerance threshold: " << this->m_MeanErrorToleranceThreshold << std::endl;
+  os << "Number of levels: " << this->m_NumberOfLevels << std::endl;
+  os << "Number of iterations performed: " << this->m_NumberOfIterationsPerformed << std::endl;
+  os << "Converged: " << this->m_Converged << std::endl;
 }
 
 }  //end namespace itk
@@ -148,6 +148,22 @@ public:
   itkBooleanMacro(UseReferenceImage);
   itkGetConstMacro(UseReferenceImage, bool);
 
+  /** Turn on/off the estimation of the accuracy of the output field.  When
+   * on, the displacement obtained by linear interpolation of the output field
+   * at the center of every grid cell is compared to the displacement of the
+   * transform itself, e.g. to check that a CompositeTransform rasterized into
+   * a DisplacementFieldTransform is sampled finely enough.  This costs about
+   * one more transform evaluation per pixel.  Default is off. */
+  itkSetMacro(EstimateAccuracy, bool);
+  itkBooleanMacro(EstimateAccuracy);
+  itkGetConstMacro(EstimateAccuracy, bool);
+
+  /** Largest and mean norm, in physical units, of the difference between the
+   * interpolated and the exact displacements at the cell centers.  Only
+   * computed when EstimateAccuracy is on. */
+  itkGetConstMacro(MaximumDisplacementError, double);
+  itkGetConstMacro(MeanDisplacementError, double);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   // Begin concept checking
   static constexpr unsigned int PixelDimension = PixelType::Dimension;
@@ -166,6 +182,9 @@ protected:
   /** TransformToDisplacementFieldFilter is implemented as a multithreaded filter. */
   void DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
 
+  /** Estimate the accuracy of the output field if requested. */
+  void AfterThreadedGenerateData() override;
+
 
   /** Default implementation for resampling that works for any
    * transformation type.
@@ -188,6 +207,10 @@ private:
   DirectionType        m_OutputDirection; // output image direction cosines
   bool                 m_UseReferenceImage{ false };
 
+  bool                 m_EstimateAccuracy{ false };
+  double               m_MaximumDisplacementError{ 0.0 };
+  double               m_MeanDisplacementError{ 0.0 };
+
 };
 } // end namespace itk
 
@@ -22,9 +22,12 @@
 
 #include "itkIdentityTransform.h"
 #include "itkProgressReporter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkImageScanlineIterator.h"
 
+#include <mutex>
+
 namespace itk
 {
 
@@ -70,6 +73,9 @@ TransformToDisplacementFieldFilter< TOutputImage, TParametersValueType>
     {
     os << "Off" << std::endl;
     }
+  os << indent << "EstimateAccuracy: " << this->m_EstimateAccuracy << std::endl;
+  os << indent << "MaximumDisplacementError: " << this->m_MaximumDisplacementError << std::endl;
+  os << indent << "MeanDisplacementError: " << this->m_MeanDisplacementError << std::endl;
 }
 
 
@@ -283,6 +289,100 @@ TransformToDisplacementFieldFilter< TOutputImage, TParametersValueType>
     }
 }
 
+
+template< typename TOutputImage, typename TParametersValueType>
+void
+TransformToDisplacementFieldFilter< TOutputImage, TParametersValueType>
+::AfterThreadedGenerateData()
+{
+  this->m_MaximumDisplacementError = 0.0;
+  this->m_MeanDisplacementError = 0.0;
+  if ( !this->m_EstimateAccuracy )
+    {
+    return;
+    }
+
+  const OutputImageType * output = this->GetOutput();
+  const TransformType * transform = this->GetInput()->Get();
+
+  // One sample at the center of each cell of the generated region.
+  OutputImageRegionType cellRegion = output->GetRequestedRegion();
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    if ( cellRegion.GetSize(d) < 2 )
+      {
+      return;
+      }
+    cellRegion.SetSize( d, cellRegion.GetSize(d) - 1 );
+    }
+
+  std::mutex    mutex;
+  double        maximumError = 0.0;
+  double        sumOfErrors = 0.0;
+  SizeValueType numberOfSamples = 0;
+
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>( cellRegion,
+    [&]( const OutputImageRegionType & region )
+      {
+      constexpr unsigned int numberOfCorners = 1u << ImageDimension;
+
+      double        localMaximumError = 0.0;
+      double        localSumOfErrors = 0.0;
+      SizeValueType localNumberOfSamples = 0;
+
+      ContinuousIndex< SpacePrecisionType, ImageDimension > cellCenter;
+      PointType point;
+
+      ImageRegionConstIteratorWithIndex< OutputImageType > it( output, region );
+      for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+        {
+        // At the cell center, linear interpolation is the mean of the corners.
+        const IndexType & index = it.GetIndex();
+        double interpolated[ImageDimension] = {};
+        for ( unsigned int corner = 0; corner < numberOfCorners; ++corner )
+          {
+          IndexType cornerIndex = index;
+          for ( unsigned int d = 0; d < ImageDimension; ++d )
+            {
+            cornerIndex[d] += ( corner >> d ) & 1;
+            }
+          const PixelType & displacement = output->GetPixel( cornerIndex );
+          for ( unsigned int d = 0; d < ImageDimension; ++d )
+            {
+            interpolated[d] += displacement[d];
+            }
+          }
+
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          cellCenter[d] = index[d] + 0.5;
+          }
+        output->TransformContinuousIndexToPhysicalPoint( cellCenter, point );
+        const PointType transformedPoint = transform->TransformPoint( point );
+
+        double squaredError = 0.0;
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          const double difference = ( transformedPoint[d] - point[d] ) - interpolated[d] / numberOfCorners;
+          squaredError += difference * difference;
+          }
+        const double error = std::sqrt( squaredError );
+        localMaximumError = std::max( localMaximumError, error );
+        localSumOfErrors += error;
+        ++localNumberOfSamples;
+        }
+
+      std::lock_guard< std::mutex > lock( mutex );
+      maximumError = std::max( maximumError, localMaximumError );
+      sumOfErrors += localSumOfErrors;
+      numberOfSamples += localNumberOfSamples;
+      },
+    nullptr );
+
+  this->m_MaximumDisplacementError = maximumError;
+  this->m_MeanDisplacementError = sumOfErrors / static_cast< double >( numberOfSamples );
+}
+
 } // end namespace itk
 
 #endif
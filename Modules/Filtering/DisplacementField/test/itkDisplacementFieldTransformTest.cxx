@@ -436,6 +436,24 @@ int itkDisplacementFieldTransformTest( int argc, char* argv[] )
     return EXIT_FAILURE;
     }
 
+  // Transform several points at once, one of them outside of the field
+  DisplacementTransformType::InputPointType batchPoints[4];
+  DisplacementTransformType::OutputPointType batchOutput[4];
+  batchPoints[0] = testPoint;
+  batchPoints[1].Fill( 1.25 );
+  batchPoints[2].Fill( 3.5 );
+  batchPoints[3].Fill( -100.0 );
+  displacementTransform->TransformPoints( batchPoints, batchOutput, 4 );
+  for( unsigned int i = 0; i < 4; ++i )
+    {
+    if( !samePoint( batchOutput[i], displacementTransform->TransformPoint( batchPoints[i] ) ) )
+      {
+      std::cout << "Error transforming point: TransformPoints(...)" << std::endl;
+      std::cout << "Test failed!" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
   DisplacementTransformType::InputVectorType  testVector;
   DisplacementTransformType::OutputVectorType deformVector, deformVectorTruth;
   testVector[0] = 0.5;
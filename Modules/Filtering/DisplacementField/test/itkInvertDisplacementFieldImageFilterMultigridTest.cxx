@@ -0,0 +1,209 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkInvertDisplacementFieldImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVectorNearestNeighborInterpolateImageFunction.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Invert a smooth field with one and with three levels, then again starting
+ * from an estimate defined on a coarser grid, and check the composition error
+ * of the results and the reported iteration statistics.  Finally check that
+ * an interpolator set by the user is used.
+ */
+namespace
+{
+template<typename TField>
+typename TField::Pointer
+MakeMultigridTestField( typename TField::SizeValueType sizeValue, double spacingValue )
+{
+  typename TField::Pointer field = TField::New();
+  typename TField::SizeType size;
+  size.Fill( sizeValue );
+  typename TField::SpacingType spacing;
+  spacing.Fill( spacingValue );
+  field->SetRegions( size );
+  field->SetSpacing( spacing );
+  field->Allocate();
+  return field;
+}
+
+template<typename TFilter>
+bool
+CheckMultigridTestInverse( const TFilter *inverter, const char *label )
+{
+  std::cout << label << ": " << inverter->GetNumberOfIterationsPerformed() << " iterations, mean error norm = "
+            << inverter->GetMeanErrorNorm() << ", max error norm = " << inverter->GetMaxErrorNorm() << std::endl;
+
+  bool passed = true;
+  if( inverter->GetNumberOfIterationsPerformed() == 0 )
+    {
+    std::cerr << label << ": no iterations were performed." << std::endl;
+    passed = false;
+    }
+  if( inverter->GetMeanErrorNormHistory().size() != inverter->GetNumberOfIterationsPerformed() ||
+      inverter->GetMaxErrorNormHistory().size() != inverter->GetNumberOfIterationsPerformed() )
+    {
+    std::cerr << label << ": the error norm histories do not match the number of iterations." << std::endl;
+    passed = false;
+    }
+  if( !inverter->GetConverged() )
+    {
+    std::cerr << label << ": failed to converge." << std::endl;
+    passed = false;
+    }
+  return passed;
+}
+}
+
+int itkInvertDisplacementFieldImageFilterMultigridTest( int, char * [] )
+{
+  constexpr unsigned int ImageDimension = 2;
+
+  using VectorType = itk::Vector<float, ImageDimension>;
+  using DisplacementFieldType = itk::Image<VectorType, ImageDimension>;
+
+  // A smooth displacement vanishing on the boundary
+  DisplacementFieldType::Pointer field = MakeMultigridTestField<DisplacementFieldType>( 64, 0.5 );
+  const double pi = itk::Math::pi;
+  itk::ImageRegionIteratorWithIndex<DisplacementFieldType> ItF( field, field->GetLargestPossibleRegion() );
+  for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+    {
+    const double x = ItF.GetIndex()[0] / 63.0;
+    const double y = ItF.GetIndex()[1] / 63.0;
+    VectorType displacement;
+    displacement[0] = 2.0 * std::sin( pi * x ) * std::sin( pi * y );
+    displacement[1] = -1.5 * std::sin( pi * x ) * std::sin( 2.0 * pi * y );
+    ItF.Set( displacement );
+    }
+
+  using InverterType = itk::InvertDisplacementFieldImageFilter<DisplacementFieldType>;
+
+  InverterType::Pointer singleLevelInverter = InverterType::New();
+  TEST_SET_GET_VALUE( 1u, singleLevelInverter->GetNumberOfLevels() );
+  singleLevelInverter->SetInput( field );
+  singleLevelInverter->SetMaximumNumberOfIterations( 50 );
+  singleLevelInverter->SetMeanErrorToleranceThreshold( 0.001 );
+  singleLevelInverter->SetMaxErrorToleranceThreshold( 0.1 );
+  TRY_EXPECT_NO_EXCEPTION( singleLevelInverter->Update() );
+
+  InverterType::Pointer multigridInverter = InverterType::New();
+  multigridInverter->SetNumberOfLevels( 3 );
+  TEST_SET_GET_VALUE( 3u, multigridInverter->GetNumberOfLevels() );
+  multigridInverter->SetInput( field );
+  multigridInverter->SetMaximumNumberOfIterations( 50 );
+  multigridInverter->SetMeanErrorToleranceThreshold( 0.001 );
+  multigridInverter->SetMaxErrorToleranceThreshold( 0.1 );
+  TRY_EXPECT_NO_EXCEPTION( multigridInverter->Update() );
+
+  bool testPassed = true;
+  testPassed &= CheckMultigridTestInverse( singleLevelInverter.GetPointer(), "Single level" );
+  testPassed &= CheckMultigridTestInverse( multigridInverter.GetPointer(), "Three levels" );
+
+  // Both estimates agree inside the field
+  const DisplacementFieldType * singleLevelInverse = singleLevelInverter->GetOutput();
+  const DisplacementFieldType * multigridInverse = multigridInverter->GetOutput();
+  double maxDifference = 0.0;
+  for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+    {
+    const DisplacementFieldType::IndexType & index = ItF.GetIndex();
+    if( index[0] < 8 || index[0] > 55 || index[1] < 8 || index[1] > 55 )
+      {
+      continue;
+      }
+    const double difference = ( singleLevelInverse->GetPixel( index ) - multigridInverse->GetPixel( index ) ).GetNorm();
+    maxDifference = std::max( maxDifference, difference );
+    }
+  std::cout << "Max difference between the single level and multigrid inverses: " << maxDifference << std::endl;
+  if( maxDifference > 0.1 )
+    {
+    std::cerr << "The multigrid inverse differs from the single level inverse." << std::endl;
+    testPassed = false;
+    }
+
+  // Warm start from an estimate on a coarser grid covering the same domain
+  DisplacementFieldType::Pointer estimate = MakeMultigridTestField<DisplacementFieldType>( 32, 1.0 );
+  estimate->SetOrigin( field->GetOrigin() );
+  itk::ImageRegionIteratorWithIndex<DisplacementFieldType> ItE( estimate, estimate->GetLargestPossibleRegion() );
+  for( ItE.GoToBegin(); !ItE.IsAtEnd(); ++ItE )
+    {
+    DisplacementFieldType::IndexType index;
+    index[0] = 2 * ItE.GetIndex()[0];
+    index[1] = 2 * ItE.GetIndex()[1];
+    ItE.Set( singleLevelInverse->GetPixel( index ) );
+    }
+
+  InverterType::Pointer warmStartInverter = InverterType::New();
+  warmStartInverter->SetInput( field );
+  warmStartInverter->SetInverseFieldInitialEstimate( estimate );
+  warmStartInverter->SetMaximumNumberOfIterations( 50 );
+  warmStartInverter->SetMeanErrorToleranceThreshold( 0.001 );
+  warmStartInverter->SetMaxErrorToleranceThreshold( 0.1 );
+  TRY_EXPECT_NO_EXCEPTION( warmStartInverter->Update() );
+
+  testPassed &= CheckMultigridTestInverse( warmStartInverter.GetPointer(), "Warm start" );
+  if( warmStartInverter->GetOutput()->GetLargestPossibleRegion() != field->GetLargestPossibleRegion() )
+    {
+    std::cerr << "The inverse is not defined on the grid of the field." << std::endl;
+    testPassed = false;
+    }
+  if( warmStartInverter->GetNumberOfIterationsPerformed() > singleLevelInverter->GetNumberOfIterationsPerformed() )
+    {
+    std::cerr << "The warm start needed more iterations than the cold start." << std::endl;
+    testPassed = false;
+    }
+
+  // A user supplied interpolator is used instead of the built-in linear
+  // interpolation.
+  using NearestNeighborInterpolatorType =
+    itk::VectorNearestNeighborInterpolateImageFunction<DisplacementFieldType, InverterType::RealType>;
+  NearestNeighborInterpolatorType::Pointer nearestNeighborInterpolator = NearestNeighborInterpolatorType::New();
+
+  InverterType::Pointer interpolatorInverter = InverterType::New();
+  interpolatorInverter->SetInput( field );
+  interpolatorInverter->SetInterpolator( nearestNeighborInterpolator );
+  TEST_SET_GET_VALUE( nearestNeighborInterpolator.GetPointer(), interpolatorInverter->GetInterpolator() );
+  interpolatorInverter->SetMaximumNumberOfIterations( 50 );
+  interpolatorInverter->SetMeanErrorToleranceThreshold( 0.001 );
+  interpolatorInverter->SetMaxErrorToleranceThreshold( 0.1 );
+  TRY_EXPECT_NO_EXCEPTION( interpolatorInverter->Update() );
+
+  double maxInterpolatorDifference = 0.0;
+  for( ItF.GoToBegin(); !ItF.IsAtEnd(); ++ItF )
+    {
+    const double difference = ( singleLevelInverse->GetPixel( ItF.GetIndex() ) -
+      interpolatorInverter->GetOutput()->GetPixel( ItF.GetIndex() ) ).GetNorm();
+    maxInterpolatorDifference = std::max( maxInterpolatorDifference, difference );
+    }
+  std::cout << "Max difference between the linear and nearest neighbor inverses: " << maxInterpolatorDifference
+            << std::endl;
+  if( maxInterpolatorDifference < 1e-3 )
+    {
+    std::cerr << "The interpolator set by the user was not used." << std::endl;
+    testPassed = false;
+    }
+
+  multigridInverter->Print( std::cout, 3 );
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
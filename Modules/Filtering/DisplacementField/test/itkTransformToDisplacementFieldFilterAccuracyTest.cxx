@@ -0,0 +1,138 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkTransformToDisplacementFieldFilter.h"
+#include "itkAffineTransform.h"
+#include "itkCompositeTransform.h"
+#include "itkDisplacementFieldTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTranslationTransform.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Flatten a composite transform made of linear transforms around a smooth
+ * displacement field transform: collapse the linear runs, rasterize the
+ * result into a displacement field at two resolutions and check the
+ * accuracy report of each.
+ */
+int itkTransformToDisplacementFieldFilterAccuracyTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using ScalarType = double;
+  using VectorType = itk::Vector<ScalarType, Dimension>;
+  using DisplacementFieldType = itk::Image<VectorType, Dimension>;
+  using CompositeTransformType = itk::CompositeTransform<ScalarType, Dimension>;
+  using DisplacementFieldTransformType = itk::DisplacementFieldTransform<ScalarType, Dimension>;
+  using FilterType = itk::TransformToDisplacementFieldFilter<DisplacementFieldType, ScalarType>;
+
+  // A smooth warp sampled every voxel over [-20, 80]^2, which covers the
+  // rasterized domain mapped through the linear transforms.
+  DisplacementFieldType::Pointer warpField = DisplacementFieldType::New();
+  DisplacementFieldType::SizeType warpSize;
+  warpSize.Fill( 101 );
+  warpField->SetRegions( warpSize );
+  DisplacementFieldType::PointType warpOrigin;
+  warpOrigin.Fill( -20.0 );
+  warpField->SetOrigin( warpOrigin );
+  warpField->Allocate();
+  itk::ImageRegionIteratorWithIndex<DisplacementFieldType> It( warpField, warpField->GetLargestPossibleRegion() );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    VectorType displacement;
+    displacement[0] = 2.0 * std::sin( 0.1 * It.GetIndex()[1] );
+    displacement[1] = 1.5 * std::cos( 0.08 * It.GetIndex()[0] );
+    It.Set( displacement );
+    }
+  DisplacementFieldTransformType::Pointer warpTransform = DisplacementFieldTransformType::New();
+  warpTransform->SetDisplacementField( warpField );
+
+  using AffineTransformType = itk::AffineTransform<ScalarType, Dimension>;
+  AffineTransformType::Pointer affineTransform = AffineTransformType::New();
+  affineTransform->Rotate2D( 0.05 );
+  affineTransform->Scale( 0.95 );
+  using TranslationTransformType = itk::TranslationTransform<ScalarType, Dimension>;
+  TranslationTransformType::Pointer translationTransform = TranslationTransformType::New();
+  TranslationTransformType::OutputVectorType translation;
+  translation[0] = 1.5;
+  translation[1] = -0.5;
+  translationTransform->Translate( translation );
+
+  CompositeTransformType::Pointer compositeTransform = CompositeTransformType::New();
+  compositeTransform->AddTransform( affineTransform );
+  compositeTransform->AddTransform( translationTransform );
+  compositeTransform->AddTransform( warpTransform );
+  compositeTransform->AddTransform( translationTransform );
+  compositeTransform->AddTransform( affineTransform );
+  TEST_EXPECT_EQUAL( compositeTransform->CollapseLinearTransforms(), 2u );
+
+  FilterType::Pointer filter = FilterType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( filter, TransformToDisplacementFieldFilter, ImageSource );
+  TEST_SET_GET_BOOLEAN( filter, EstimateAccuracy, true );
+  filter->SetTransform( compositeTransform );
+
+  // Rasterize over [0, 60]^2 with spacings 1 and 4.
+  double maximumErrors[2];
+  const double spacings[2] = { 1.0, 4.0 };
+  for( unsigned int level = 0; level < 2; ++level )
+    {
+    FilterType::SpacingType spacing;
+    spacing.Fill( spacings[level] );
+    FilterType::SizeType size;
+    size.Fill( static_cast<itk::SizeValueType>( 60.0 / spacings[level] ) + 1 );
+    filter->SetOutputSpacing( spacing );
+    filter->SetSize( size );
+    TRY_EXPECT_NO_EXCEPTION( filter->UpdateLargestPossibleRegion() );
+
+    maximumErrors[level] = filter->GetMaximumDisplacementError();
+    std::cout << "Spacing " << spacings[level] << ": maximum error " << filter->GetMaximumDisplacementError()
+              << ", mean error " << filter->GetMeanDisplacementError() << std::endl;
+    TEST_EXPECT_TRUE( filter->GetMeanDisplacementError() <= filter->GetMaximumDisplacementError() );
+
+    // The flattened transform agrees with the composite at the cell centers
+    // within the reported error.
+    DisplacementFieldTransformType::Pointer flattenedTransform = DisplacementFieldTransformType::New();
+    flattenedTransform->SetDisplacementField( filter->GetOutput() );
+    DisplacementFieldType::PointType point;
+    for( unsigned int i = 0; i < 50; ++i )
+      {
+      point[0] = spacings[level] * ( std::floor( 0.5 * i ) + 0.5 );
+      point[1] = spacings[level] * ( std::floor( 60.0 / spacings[level] * std::fabs( std::sin( 1.7 * i ) ) ) + 0.5 );
+      if( point[0] > 60.0 || point[1] > 60.0 )
+        {
+        continue;
+        }
+      const double error = compositeTransform->TransformPoint( point ).EuclideanDistanceTo(
+        flattenedTransform->TransformPoint( point ) );
+      if( error > filter->GetMaximumDisplacementError() + 1e-9 )
+        {
+        std::cerr << "Error " << error << " at " << point << " exceeds the reported maximum." << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // A finer grid is more accurate.
+  TEST_EXPECT_TRUE( maximumErrors[0] < maximumErrors[1] );
+
+  // A linear transform is represented exactly.
+  filter->SetTransform( affineTransform );
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  TEST_EXPECT_TRUE( filter->GetMaximumDisplacementError() < 1e-9 );
+
+  return EXIT_SUCCESS;
+}
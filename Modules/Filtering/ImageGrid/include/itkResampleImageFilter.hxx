@@ -29,6 +29,7 @@
 #include "itkImageAlgorithm.h"
 
 #include <type_traits>  // For is_same.
+#include <vector>
 
 namespace itk
 {
@@ -347,7 +348,7 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
 
 
   // Create an iterator that will walk the output region for this thread.
-  using OutputIterator = ImageRegionIteratorWithIndex< TOutputImage >;
+  using OutputIterator = ImageScanlineIterator< TOutputImage >;
   OutputIterator outIt(outputPtr, outputRegionForThread);
 
   // Define a few indices that will be used to translate from an input pixel
@@ -359,39 +360,54 @@ ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType, TTra
 
   using OutputType = typename InterpolatorType::OutputType;
 
+  // The points of a scanline are transformed at once.
+  using TransformPointType = typename TransformType::InputPointType;
+  std::vector< TransformPointType > scanlinePoints( outputRegionForThread.GetSize(0) );
+
   // Walk the output region
   outIt.GoToBegin();
 
   while ( !outIt.IsAtEnd() )
     {
-    // Determine the index of the current output pixel
-    outputPtr->TransformIndexToPhysicalPoint(outIt.GetIndex(), outputPoint);
-
-    // Compute corresponding input pixel position
-    inputPoint = transformPtr->TransformPoint(outputPoint);
-    const bool isInsideInput = inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
-
-    OutputType value;
-    // Evaluate input at right position and copy to the output
-    if( m_Interpolator->IsInsideBuffer(inputIndex) && ( !isSpecialCoordinatesImage || isInsideInput ) )
+    // Determine the coordinates of the output pixels of the scanline
+    IndexType index = outIt.GetIndex();
+    for ( SizeValueType i = 0; i < scanlinePoints.size(); ++i, ++index[0] )
       {
-      value = m_Interpolator->EvaluateAtContinuousIndex(inputIndex);
-      outIt.Set( Self::CastPixelWithBoundsChecking(value) );
+      outputPtr->TransformIndexToPhysicalPoint(index, outputPoint);
+      scanlinePoints[i] = outputPoint;
       }
-    else
+
+    // Compute corresponding input pixel positions
+    transformPtr->TransformPoints(scanlinePoints.data(), scanlinePoints.data(), scanlinePoints.size());
+
+    for ( SizeValueType i = 0; !outIt.IsAtEndOfLine(); ++i )
       {
-      if( m_Extrapolator.IsNull() )
+      inputPoint = scanlinePoints[i];
+      const bool isInsideInput = inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
+
+      OutputType value;
+      // Evaluate input at right position and copy to the output
+      if( m_Interpolator->IsInsideBuffer(inputIndex) && ( !isSpecialCoordinatesImage || isInsideInput ) )
         {
-        outIt.Set( m_DefaultPixelValue ); // default background value
+        value = m_Interpolator->EvaluateAtContinuousIndex(inputIndex);
+        outIt.Set( Self::CastPixelWithBoundsChecking(value) );
         }
       else
         {
-        value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndex );
-        outIt.Set( Self::CastPixelWithBoundsChecking(value) );
+        if( m_Extrapolator.IsNull() )
+          {
+          outIt.Set( m_DefaultPixelValue ); // default background value
+          }
+        else
+          {
+          value = m_Extrapolator->EvaluateAtContinuousIndex( inputIndex );
+          outIt.Set( Self::CastPixelWithBoundsChecking(value) );
+          }
         }
-      }
 
-    ++outIt;
+      ++outIt;
+      }
+    outIt.NextLine();
     }
 }
 
@@ -20,6 +20,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkConstShapedNeighborhoodIterator.h"
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <functional>
@@ -133,7 +134,9 @@ protected:
 
   using LineMapType = std::vector< LineEncodingType >;
 
-  using UnionFindType = std::vector< InternalLabelType >;
+  // The union-find is shared by the work units, and its entries are
+  // updated without lock.
+  using UnionFindType = std::vector< std::atomic< InternalLabelType > >;
   using ConsecutiveVectorType = std::vector< OutputPixelType >;
 
   SizeValueType IndexToLinearIndex( const IndexType& index ) const
@@ -156,46 +159,80 @@ protected:
   {
     m_UnionFind = UnionFindType( numberOfLabels + 1 );
 
-    typename LineMapType::iterator MapBegin, MapEnd, LineIt;
-    MapBegin = m_LineMap.begin();
-    MapEnd = m_LineMap.end();
-    LineIt = MapBegin;
+    // the runs are labeled in the order of the lines, so the first label
+    // of each line is known before the work units label their lines
+    std::vector< InternalLabelType > firstLabels( m_LineMap.size() );
     InternalLabelType label = 1;
-    for ( LineIt = MapBegin; LineIt != MapEnd; ++LineIt )
+    for ( SizeValueType lineId = 0; lineId < m_LineMap.size(); ++lineId )
       {
-      LineEncodingIterator cIt;
-      for ( cIt = LineIt->begin(); cIt != LineIt->end(); ++cIt )
-        {
-        cIt->label = label;
-        m_UnionFind[label] = label;
-        label++;
-        }
+      firstLabels[lineId] = label;
+      label += m_LineMap[lineId].size();
       }
+
+    m_EnclosingFilter->GetMultiThreader()->ParallelizeArray(
+      0,
+      m_WorkUnitResults.size(),
+      [this, &firstLabels]( SizeValueType index )
+      {
+        const WorkUnitData & wud = this->m_WorkUnitResults[index];
+        for ( SizeValueType lineId = wud.firstLine; lineId <= wud.lastLine; ++lineId )
+          {
+          InternalLabelType runLabel = firstLabels[lineId];
+          for ( LineEncodingIterator cIt = m_LineMap[lineId].begin(); cIt != m_LineMap[lineId].end(); ++cIt )
+            {
+            cIt->label = runLabel;
+            m_UnionFind[runLabel].store( runLabel, std::memory_order_relaxed );
+            runLabel++;
+            }
+          }
+      },
+      nullptr );
   }
 
   InternalLabelType LookupSet(const InternalLabelType label)
   {
+    // The parent of a label is always a smaller label of the same set, so
+    // it is safe to shorten the path to the root while other threads link
+    // the roots: each label on the path is made to point to its
+    // grandparent.
     InternalLabelType l = label;
-    while (l != m_UnionFind[l])
+    InternalLabelType parent = m_UnionFind[l].load( std::memory_order_relaxed );
+    while ( l != parent )
       {
-      l = m_UnionFind[l]; //transitively sets equivalence
+      const InternalLabelType grandParent = m_UnionFind[parent].load( std::memory_order_relaxed );
+      if ( grandParent != parent )
+        {
+        m_UnionFind[l].store( grandParent, std::memory_order_relaxed );
+        }
+      l = parent;
+      parent = grandParent;
       }
     return l;
   }
 
   void LinkLabels(const InternalLabelType label1, const InternalLabelType label2)
   {
-    std::lock_guard<std::mutex> mutexHolder(m_Mutex);
-    InternalLabelType E1 = this->LookupSet(label1);
-    InternalLabelType E2 = this->LookupSet(label2);
-
-    if ( E1 < E2 )
+    // Lock-free union: the largest root is linked to the smallest one only
+    // if it is still a root, otherwise the roots are looked up again.
+    InternalLabelType E1 = label1;
+    InternalLabelType E2 = label2;
+    while ( true )
       {
-      m_UnionFind[E2] = E1;
-      }
-    else
-      {
-      m_UnionFind[E1] = E2;
+      E1 = this->LookupSet(E1);
+      E2 = this->LookupSet(E2);
+      if ( E1 == E2 )
+        {
+        return;
+        }
+      if ( E1 < E2 )
+        {
+        std::swap( E1, E2 );
+        }
+      InternalLabelType expected = E1;
+      if ( m_UnionFind[E1].compare_exchange_weak( expected, E2, std::memory_order_relaxed ) )
+        {
+        return;
+        }
       }
   }
 
@@ -211,7 +248,7 @@ protected:
 
     for ( size_t i = 1; i < N; i++ )
       {
-      const auto label = static_cast< size_t >( m_UnionFind[i] );
+      const auto label = static_cast< size_t >( m_UnionFind[i].load( std::memory_order_relaxed ) );
       if ( label == i )
         {
         if ( consecutiveLabel == backgroundValue )
@@ -230,14 +267,19 @@ protected:
   {
     // This checks whether the line encodings are really neighbors. The first
     // dimension gets ignored because the encodings are along that axis.
+    // The line offsets wrap around the image, so the lines are face
+    // connected only if they differ along a single dimension.
+    OffsetValueType numberOfDifferences = 0;
     for ( unsigned i = 1; i < OutputImageDimension; i++ )
       {
-      if ( Math::abs(A[i] - B[i]) > 1 )
+      const OffsetValueType difference = Math::abs(A[i] - B[i]);
+      if ( difference > 1 )
         {
         return false;
         }
+      numberOfDifferences += difference;
       }
-    return true;
+    return m_FullyConnected || numberOfDifferences <= 1;
   }
 
   using CompareLinesCallback = std::function<void(
@@ -450,19 +492,15 @@ protected:
     return WorkUnitData{ firstLine, lastLine };
   }
 
-  /* Process the map and make appropriate entries in an equivalence table */
-  void ComputeEquivalence(const SizeValueType workUnitResultsIndex, bool strictlyLess)
+  /* Process the map and make appropriate entries in an equivalence table.
+   * The lines of the work unit are compared to their previous lines, which
+   * may belong to another work unit: the union-find merges the labels
+   * across the work units concurrently. */
+  void ComputeEquivalence(const SizeValueType workUnitResultsIndex)
   {
     const OffsetValueType linecount = m_LineMap.size();
     WorkUnitData wud = m_WorkUnitResults[workUnitResultsIndex];
-    SizeValueType lastLine = wud.lastLine;
-    if (!strictlyLess)
-      {
-      lastLine++;
-      //make sure we are not wrapping around
-      itkAssertInDebugAndIgnoreInReleaseMacro( lastLine >= wud.lastLine );
-      }
-    for ( SizeValueType thisIdx = wud.firstLine; thisIdx < lastLine; ++thisIdx )
+    for ( SizeValueType thisIdx = wud.firstLine; thisIdx <= wud.lastLine; ++thisIdx )
       {
       if ( !m_LineMap[thisIdx].empty() )
         {
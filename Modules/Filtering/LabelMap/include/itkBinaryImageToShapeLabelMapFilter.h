@@ -160,6 +160,15 @@ public:
   itkGetConstReferenceMacro(ComputeOrientedBoundingBox, bool);
   itkBooleanMacro(ComputeOrientedBoundingBox);
 
+  /**
+   * Set/Get whether the principal moments, principal axes, elongation,
+   * flatness and equivalent ellipsoid diameter should be computed or not.
+   * Default value is true.
+   */
+  itkSetMacro(ComputePrincipalMoments, bool);
+  itkGetConstReferenceMacro(ComputePrincipalMoments, bool);
+  itkBooleanMacro(ComputePrincipalMoments);
+
 protected:
   BinaryImageToShapeLabelMapFilter();
   ~BinaryImageToShapeLabelMapFilter() override = default;
@@ -183,6 +192,7 @@ private:
   bool                 m_ComputeFeretDiameter;
   bool                 m_ComputePerimeter;
   bool                 m_ComputeOrientedBoundingBox;
+  bool                 m_ComputePrincipalMoments;
 }; // end of class
 } // end namespace itk
 
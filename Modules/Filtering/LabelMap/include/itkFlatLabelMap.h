@@ -0,0 +1,444 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFlatLabelMap_h
+#define itkFlatLabelMap_h
+
+#include "itkImageBase.h"
+#include "itkLabelObjectLine.h"
+#include "itkWeakPointer.h"
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/** \class FlatLabelMap
+ * \brief Compact, read-mostly storage of the label objects of a label image.
+ *
+ * FlatLabelMap stores the same information as a LabelMap of LabelObject,
+ * the run-length lines of each label object, without one allocation per
+ * object and per chunk of lines:
+ * - the labels are stored in one sorted array;
+ * - the lines of all the objects are stored in one contiguous array,
+ *   grouped by label, and sorted by index in each object;
+ * - the attributes of the objects, the number of pixels and the bounding
+ *   box, are stored in one array per attribute;
+ * - a label is found in constant time with a dense table indexed by the
+ *   label when the labels are not too sparse, and by binary search
+ *   otherwise.
+ *
+ * The map is built by adding lines with SetLine(), in any order, and by
+ * calling Optimize() to pack them. The label objects cannot be modified
+ * afterwards, except by adding lines and calling Optimize() again.
+ *
+ * The ConstIterator has the same interface as LabelMap::ConstIterator,
+ * so code iterating on the label objects of a LabelMap can iterate on a
+ * FlatLabelMap. The label objects are returned as ConstLabelObject
+ * views, which provide the const interface of LabelObject over the
+ * arrays of the map. They are invalidated by SetLine() and Optimize().
+ *
+ * CopyFromLabelMap() and CopyToLabelMap() convert from and to a LabelMap,
+ * to use the filters working on a LabelMap.
+ *
+ * \sa LabelMap, LabelImageToFlatLabelMapFilter
+ * \ingroup ImageObjects
+ * \ingroup LabeledImageObject
+ * \ingroup ITKLabelMap
+ */
+template< typename TLabel, unsigned int VImageDimension >
+class ITK_TEMPLATE_EXPORT FlatLabelMap:public ImageBase< VImageDimension >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(FlatLabelMap);
+
+  /** Standard class type aliases */
+  using Self = FlatLabelMap;
+  using Superclass = ImageBase< VImageDimension >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+  using ConstWeakPointer = WeakPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(FlatLabelMap, ImageBase);
+
+  static constexpr unsigned int ImageDimension = VImageDimension;
+
+  using SizeValueType = typename Superclass::SizeValueType;
+  using IndexType = typename Superclass::IndexType;
+  using OffsetType = typename Superclass::OffsetType;
+  using SizeType = typename Superclass::SizeType;
+  using RegionType = typename Superclass::RegionType;
+
+  using LabelType = TLabel;
+  using PixelType = LabelType;
+  using LineType = LabelObjectLine< VImageDimension >;
+  using LengthType = typename LineType::LengthType;
+
+  using LabelVectorType = std::vector< LabelType >;
+  using LineContainerType = std::vector< LineType >;
+  using SizeValueVectorType = std::vector< SizeValueType >;
+  using IndexVectorType = std::vector< IndexType >;
+
+  /** \class ConstLabelObject
+   * \brief A read-only view on one label object of a FlatLabelMap.
+   *
+   * Provides the const interface of LabelObject. A view is invalidated
+   * when the map is modified.
+   *
+   * \ingroup ITKLabelMap
+   */
+  class ConstLabelObject
+  {
+  public:
+    ConstLabelObject() = default;
+
+    ConstLabelObject(const Self *map, SizeValueType position):
+      m_Map(map),
+      m_Position(position)
+    {}
+
+    const LabelType & GetLabel() const
+    {
+      return m_Map->m_Labels[m_Position];
+    }
+
+    /** Position of the object in the map, from 0 to
+     * GetNumberOfLabelObjects() - 1, in increasing label order. */
+    SizeValueType GetPosition() const
+    {
+      return m_Position;
+    }
+
+    SizeValueType GetNumberOfLines() const
+    {
+      return m_Map->m_LineOffsets[m_Position + 1] - m_Map->m_LineOffsets[m_Position];
+    }
+
+    const LineType & GetLine(SizeValueType i) const
+    {
+      return m_Map->m_Lines[m_Map->m_LineOffsets[m_Position] + i];
+    }
+
+    /** Pointers to the first and past the last lines of the object. */
+    const LineType * LinesBegin() const
+    {
+      return m_Map->m_Lines.data() + m_Map->m_LineOffsets[m_Position];
+    }
+
+    const LineType * LinesEnd() const
+    {
+      return m_Map->m_Lines.data() + m_Map->m_LineOffsets[m_Position + 1];
+    }
+
+    /** Number of pixels of the object. Constant time. */
+    SizeValueType Size() const
+    {
+      return m_Map->m_NumberOfPixels[m_Position];
+    }
+
+    bool Empty() const
+    {
+      return this->Size() == 0;
+    }
+
+    /** Smallest region containing the object. Constant time. */
+    RegionType GetBoundingBox() const
+    {
+      RegionType region;
+      region.SetIndex( m_Map->m_BoundingBoxMinimum[m_Position] );
+      for ( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+        region.SetSize( d, m_Map->m_BoundingBoxMaximum[m_Position][d] - m_Map->m_BoundingBoxMinimum[m_Position][d] + 1 );
+        }
+      return region;
+    }
+
+    /** Return true if the object contains the given index. The lines are
+     * sorted, so the complexity is O(log(L)). */
+    bool HasIndex(const IndexType & idx) const;
+
+    /** Get the index of the ith pixel of the object, from 0 to Size() - 1. */
+    IndexType GetIndex(SizeValueType i) const;
+
+    /** \class ConstLineIterator
+     * \brief A forward iterator over the lines of a label object.
+     * \ingroup ITKLabelMap
+     */
+    class ConstLineIterator
+    {
+    public:
+      ConstLineIterator() = default;
+
+      ConstLineIterator(const ConstLabelObject *lo):
+        m_Begin( lo->LinesBegin() ),
+        m_End( lo->LinesEnd() ),
+        m_Iterator( m_Begin )
+      {}
+
+      const LineType & GetLine() const
+      {
+        return *m_Iterator;
+      }
+
+      ConstLineIterator operator++(int)
+      {
+        ConstLineIterator tmp = *this;
+        ++( *this );
+        return tmp;
+      }
+
+      ConstLineIterator & operator++()
+      {
+        ++m_Iterator;
+        return *this;
+      }
+
+      bool operator==(const ConstLineIterator & iter) const
+      {
+        return m_Iterator == iter.m_Iterator && m_Begin == iter.m_Begin && m_End == iter.m_End;
+      }
+
+      bool operator!=(const ConstLineIterator & iter) const
+      {
+        return !( *this == iter );
+      }
+
+      void GoToBegin()
+      {
+        m_Iterator = m_Begin;
+      }
+
+      bool IsAtEnd() const
+      {
+        return m_Iterator == m_End;
+      }
+
+    private:
+      const LineType *m_Begin{ nullptr };
+      const LineType *m_End{ nullptr };
+      const LineType *m_Iterator{ nullptr };
+    };
+
+  private:
+    const Self *  m_Map{ nullptr };
+    SizeValueType m_Position{ 0 };
+  };
+
+  using LabelObjectType = ConstLabelObject;
+
+  /** Restore the map to its initial state, without any object. */
+  void Initialize() override;
+
+  /** Same as Initialize(): a FlatLabelMap has no buffer to allocate. */
+  void Allocate(bool initialize = false) override;
+
+  virtual void Graft(const Self *imgData);
+
+  /** Add a line to the object with the given label. The label can be
+   * new or not, and the lines can be added in any order. The line is
+   * only visible after the next call to Optimize(). */
+  void SetLine(const IndexType & idx, const LengthType & length, const LabelType & label);
+
+  /** Add several lines with the given labels, in the same way as SetLine(). */
+  void AppendLines(const std::vector< std::pair< LabelType, LineType > > & lines);
+
+  /** Pack the lines added since the last call: group them by label, sort
+   * them by index in each object, merge the touching lines, and compute
+   * the attributes of the objects. */
+  void Optimize();
+
+  /** Return true if lines were added since the last call to Optimize(). */
+  bool HasPendingLines() const
+  {
+    return !m_PendingLines.empty();
+  }
+
+  SizeValueType GetNumberOfLabelObjects() const
+  {
+    return m_Labels.size();
+  }
+
+  /** Return true if the map contains an object with the given label. */
+  bool HasLabel(const LabelType & label) const;
+
+  /** Get the object with the given label. Throws an exception if there is
+   * no such object, or if the label is the background label. */
+  ConstLabelObject GetLabelObject(const LabelType & label) const;
+
+  /** Get the object at the given position, in increasing label order. */
+  ConstLabelObject GetNthLabelObject(const SizeValueType & pos) const;
+
+  /** Position of the object with the given label, or
+   * GetNumberOfLabelObjects() if there is no such object. Constant time when
+   * the labels are dense enough. */
+  SizeValueType GetLabelPosition(const LabelType & label) const;
+
+  /** Return the label of the object containing the given index, or the
+   * background value. O(log(L)) per object. */
+  const LabelType & GetPixel(const IndexType & idx) const;
+
+  /** The labels of the objects, sorted. */
+  const LabelVectorType & GetLabels() const
+  {
+    return m_Labels;
+  }
+
+  /** The lines of all the objects, grouped by label. */
+  const LineContainerType & GetLines() const
+  {
+    return m_Lines;
+  }
+
+  /** The number of pixels of each object, in the order of GetLabels(). */
+  const SizeValueVectorType & GetNumberOfPixelsArray() const
+  {
+    return m_NumberOfPixels;
+  }
+
+  /** The first and last index of the bounding box of each object, in the
+   * order of GetLabels(). */
+  const IndexVectorType & GetBoundingBoxMinimumArray() const
+  {
+    return m_BoundingBoxMinimum;
+  }
+
+  const IndexVectorType & GetBoundingBoxMaximumArray() const
+  {
+    return m_BoundingBoxMaximum;
+  }
+
+  /** Return true if the labels are found with the dense table. */
+  bool GetUseDenseLabelTable() const
+  {
+    return !m_LabelTable.empty();
+  }
+
+  /** Set/Get the value used as "background" in the map. */
+  itkGetConstMacro(BackgroundValue, LabelType);
+  itkSetMacro(BackgroundValue, LabelType);
+
+  /** Replace the content of this map by the lines of a LabelMap. The
+   * attributes of the label objects other than the lines are not copied. */
+  template< typename TLabelMap >
+  void CopyFromLabelMap(const TLabelMap *labelMap);
+
+  /** Add the objects of this map to a LabelMap, and copy the meta data. */
+  template< typename TLabelMap >
+  void CopyToLabelMap(TLabelMap *labelMap) const;
+
+  /** \class ConstIterator
+   * \brief A forward iterator over the label objects of a FlatLabelMap,
+   * with the same interface as LabelMap::ConstIterator.
+   * \ingroup ITKLabelMap
+   */
+  class ConstIterator
+  {
+  public:
+    ConstIterator() = default;
+
+    ConstIterator(const Self *lm):
+      m_Map( lm ),
+      m_Object( lm, 0 ),
+      m_NumberOfLabelObjects( lm->GetNumberOfLabelObjects() )
+    {}
+
+    const ConstLabelObject * GetLabelObject() const
+    {
+      return &m_Object;
+    }
+
+    const LabelType & GetLabel() const
+    {
+      return m_Object.GetLabel();
+    }
+
+    ConstIterator operator++(int)
+    {
+      ConstIterator tmp = *this;
+      ++( *this );
+      return tmp;
+    }
+
+    ConstIterator & operator++()
+    {
+      m_Object = ConstLabelObject( m_Map, m_Object.GetPosition() + 1 );
+      return *this;
+    }
+
+    bool operator==(const ConstIterator & iter) const
+    {
+      return m_Map == iter.m_Map && m_Object.GetPosition() == iter.m_Object.GetPosition();
+    }
+
+    bool operator!=(const ConstIterator & iter) const
+    {
+      return !( *this == iter );
+    }
+
+    void GoToBegin()
+    {
+      m_Object = ConstLabelObject( m_Map, 0 );
+    }
+
+    bool IsAtEnd() const
+    {
+      return m_Object.GetPosition() >= m_NumberOfLabelObjects;
+    }
+
+  private:
+    const Self *     m_Map{ nullptr };
+    ConstLabelObject m_Object;
+    SizeValueType    m_NumberOfLabelObjects{ 0 };
+  };
+
+protected:
+  FlatLabelMap();
+  ~FlatLabelMap() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+  void Graft(const DataObject *data) override;
+  using Superclass::Graft;
+
+private:
+  /** Build the dense table if the labels are dense enough. */
+  void UpdateLabelTable();
+
+  LabelType m_BackgroundValue;
+
+  LabelVectorType     m_Labels;
+  SizeValueVectorType m_LineOffsets;
+  LineContainerType   m_Lines;
+  SizeValueVectorType m_NumberOfPixels;
+  IndexVectorType     m_BoundingBoxMinimum;
+  IndexVectorType     m_BoundingBoxMaximum;
+
+  /** Position of each label from m_Labels.front() to m_Labels.back(), or
+   * GetNumberOfLabelObjects() for the missing labels. Empty when the
+   * labels are too sparse. */
+  SizeValueVectorType m_LabelTable;
+
+  std::vector< std::pair< LabelType, LineType > > m_PendingLines;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFlatLabelMap.hxx"
+#endif
+
+#endif
@@ -0,0 +1,544 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkFlatLabelMap_hxx
+#define itkFlatLabelMap_hxx
+
+#include "itkFlatLabelMap.h"
+#include "itkLabelObjectLineComparator.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template< typename TLabel, unsigned int VImageDimension >
+bool
+FlatLabelMap< TLabel, VImageDimension >::ConstLabelObject
+::HasIndex(const IndexType & idx) const
+{
+  // the lines are sorted, so look for the last line starting before idx
+  LineType key( idx, NumericTraits< LengthType >::max() );
+  typename Functor::LabelObjectLineComparator< LineType > comparator;
+  const LineType *it = std::upper_bound( this->LinesBegin(), this->LinesEnd(), key, comparator );
+  if ( it == this->LinesBegin() )
+    {
+    return false;
+    }
+  --it;
+  return it->HasIndex( idx );
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+typename FlatLabelMap< TLabel, VImageDimension >::IndexType
+FlatLabelMap< TLabel, VImageDimension >::ConstLabelObject
+::GetIndex(SizeValueType offset) const
+{
+  SizeValueType o = offset;
+
+  for ( const LineType *it = this->LinesBegin(); it != this->LinesEnd(); ++it )
+    {
+    const SizeValueType size = it->GetLength();
+
+    if ( o >= size )
+      {
+      o -= size;
+      }
+    else
+      {
+      IndexType idx = it->GetIndex();
+      idx[0] += o;
+      return idx;
+      }
+    }
+  itkGenericExceptionMacro(<< "Invalid offset: " << offset);
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+FlatLabelMap< TLabel, VImageDimension >
+::FlatLabelMap()
+{
+  m_BackgroundValue = NumericTraits< LabelType >::ZeroValue();
+  this->Initialize();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "BackgroundValue: "
+     << static_cast< typename NumericTraits< LabelType >::PrintType >( m_BackgroundValue ) << std::endl;
+  os << indent << "NumberOfLabelObjects: " << m_Labels.size() << std::endl;
+  os << indent << "NumberOfLines: " << m_Lines.size() << std::endl;
+  os << indent << "NumberOfPendingLines: " << m_PendingLines.size() << std::endl;
+  os << indent << "UseDenseLabelTable: " << this->GetUseDenseLabelTable() << std::endl;
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::Initialize()
+{
+  m_Labels.clear();
+  m_LineOffsets.assign( 1, 0 );
+  m_Lines.clear();
+  m_NumberOfPixels.clear();
+  m_BoundingBoxMinimum.clear();
+  m_BoundingBoxMaximum.clear();
+  m_LabelTable.clear();
+  m_PendingLines.clear();
+  this->Modified();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::Allocate(bool)
+{
+  this->Initialize();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::Graft(const Self *imgData)
+{
+  if( imgData == nullptr )
+    {
+    return; // nothing to do
+    }
+  // call the superclass' implementation
+  Superclass::Graft(imgData);
+
+  // Now copy anything remaining that is needed
+  if( imgData != this )
+    {
+    m_Labels = imgData->m_Labels;
+    m_LineOffsets = imgData->m_LineOffsets;
+    m_Lines = imgData->m_Lines;
+    m_NumberOfPixels = imgData->m_NumberOfPixels;
+    m_BoundingBoxMinimum = imgData->m_BoundingBoxMinimum;
+    m_BoundingBoxMaximum = imgData->m_BoundingBoxMaximum;
+    m_LabelTable = imgData->m_LabelTable;
+    m_PendingLines = imgData->m_PendingLines;
+    }
+  m_BackgroundValue = imgData->m_BackgroundValue;
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::Graft(const DataObject *data)
+{
+  if( data == nullptr )
+    {
+    return; // nothing to do
+    }
+
+  // Attempt to cast data to a FlatLabelMap
+  const auto * imgData = dynamic_cast< const Self * >( data );
+
+  if ( imgData == nullptr )
+    {
+    // pointer could not be cast back down
+    itkExceptionMacro( << "itk::FlatLabelMap::Graft() cannot cast "
+                       << typeid( data ).name() << " to "
+                       << typeid( const Self * ).name() );
+    }
+  this->Graft(imgData);
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::SetLine(const IndexType & idx, const LengthType & length, const LabelType & label)
+{
+  if ( label == m_BackgroundValue || length == 0 )
+    {
+    // just do nothing
+    return;
+    }
+  m_PendingLines.emplace_back( label, LineType( idx, length ) );
+  this->Modified();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::AppendLines(const std::vector< std::pair< LabelType, LineType > > & lines)
+{
+  m_PendingLines.reserve( m_PendingLines.size() + lines.size() );
+  for ( const auto & labelAndLine : lines )
+    {
+    if ( labelAndLine.first != m_BackgroundValue && labelAndLine.second.GetLength() != 0 )
+      {
+      m_PendingLines.push_back( labelAndLine );
+      }
+    }
+  this->Modified();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::Optimize()
+{
+  if ( m_PendingLines.empty() )
+    {
+    return;
+    }
+
+  // the lines already packed are packed again with the new ones
+  std::vector< std::pair< LabelType, LineType > > lines;
+  lines.reserve( m_Lines.size() + m_PendingLines.size() );
+  for ( SizeValueType pos = 0; pos < m_Labels.size(); ++pos )
+    {
+    for ( SizeValueType l = m_LineOffsets[pos]; l < m_LineOffsets[pos + 1]; ++l )
+      {
+      lines.emplace_back( m_Labels[pos], m_Lines[l] );
+      }
+    }
+  lines.insert( lines.end(), m_PendingLines.begin(), m_PendingLines.end() );
+  m_PendingLines.clear();
+  m_PendingLines.shrink_to_fit();
+
+  // group the lines by label. A stable sort keeps the order of the lines of
+  // each object, which are often already sorted by index when they come from
+  // a scan of an image. The labels are sorted with a counting sort when their
+  // range is small enough.
+  LabelType minimum = lines.front().first;
+  LabelType maximum = lines.front().first;
+  for ( const auto & labelAndLine : lines )
+    {
+    minimum = std::min( minimum, labelAndLine.first );
+    maximum = std::max( maximum, labelAndLine.first );
+    }
+  const double range = static_cast< double >( maximum ) - static_cast< double >( minimum ) + 1.0;
+  const bool   countingSort = NumericTraits< LabelType >::is_integer
+                              && range <= 4.0 * static_cast< double >( lines.size() ) + 1024.0;
+
+  std::vector< std::pair< LabelType, LineType > > sortedLines;
+  if ( countingSort )
+    {
+    const auto rangeSize = static_cast< SizeValueType >( range );
+    SizeValueVectorType offsets( rangeSize + 1, 0 );
+    for ( const auto & labelAndLine : lines )
+      {
+      ++offsets[static_cast< SizeValueType >( labelAndLine.first - minimum ) + 1];
+      }
+    for ( SizeValueType i = 1; i <= rangeSize; ++i )
+      {
+      offsets[i] += offsets[i - 1];
+      }
+    sortedLines.resize( lines.size(), lines.front() );
+    for ( const auto & labelAndLine : lines )
+      {
+      sortedLines[offsets[static_cast< SizeValueType >( labelAndLine.first - minimum )]++] = labelAndLine;
+      }
+    }
+  else
+    {
+    sortedLines.swap( lines );
+    std::stable_sort( sortedLines.begin(), sortedLines.end(),
+                      []( const std::pair< LabelType, LineType > & a, const std::pair< LabelType, LineType > & b )
+                        {
+                        return a.first < b.first;
+                        } );
+    }
+  lines.clear();
+  lines.shrink_to_fit();
+
+  m_Labels.clear();
+  m_LineOffsets.assign( 1, 0 );
+  m_Lines.clear();
+  m_Lines.reserve( sortedLines.size() );
+  m_NumberOfPixels.clear();
+  m_BoundingBoxMinimum.clear();
+  m_BoundingBoxMaximum.clear();
+
+  typename Functor::LabelObjectLineComparator< LineType > comparator;
+  LineContainerType objectLines;
+  auto it = sortedLines.begin();
+  while ( it != sortedLines.end() )
+    {
+    const LabelType label = it->first;
+    objectLines.clear();
+    bool sorted = true;
+    for ( ; it != sortedLines.end() && it->first == label; ++it )
+      {
+      if ( sorted && !objectLines.empty() && comparator( it->second, objectLines.back() ) )
+        {
+        sorted = false;
+        }
+      objectLines.push_back( it->second );
+      }
+    if ( !sorted )
+      {
+      std::sort( objectLines.begin(), objectLines.end(), comparator );
+      }
+
+    // merge the touching or overlapping lines, and compute the attributes
+    SizeValueType numberOfPixels = 0;
+    IndexType     bboxMin;
+    IndexType     bboxMax;
+    bboxMin.Fill( NumericTraits< IndexValueType >::max() );
+    bboxMax.Fill( NumericTraits< IndexValueType >::NonpositiveMin() );
+
+    IndexType  currentIdx = objectLines.front().GetIndex();
+    LengthType currentLength = objectLines.front().GetLength();
+    for ( SizeValueType l = 1; l <= objectLines.size(); ++l )
+      {
+      bool extend = false;
+      if ( l < objectLines.size() )
+        {
+        const IndexType &  idx = objectLines[l].GetIndex();
+        const LengthType & length = objectLines[l].GetLength();
+        bool sameIdx = true;
+        for ( unsigned int d = 1; d < ImageDimension; ++d )
+          {
+          if ( currentIdx[d] != idx[d] )
+            {
+            sameIdx = false;
+            }
+          }
+        if ( sameIdx && currentIdx[0] + static_cast< OffsetValueType >( currentLength ) >= idx[0] )
+          {
+          const LengthType newLength = idx[0] + static_cast< OffsetValueType >( length ) - currentIdx[0];
+          currentLength = std::max( newLength, currentLength );
+          extend = true;
+          }
+        }
+      if ( !extend )
+        {
+        m_Lines.push_back( LineType( currentIdx, currentLength ) );
+        numberOfPixels += currentLength;
+        for ( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+          bboxMin[d] = std::min( bboxMin[d], currentIdx[d] );
+          bboxMax[d] = std::max( bboxMax[d], currentIdx[d] );
+          }
+        bboxMax[0] = std::max( bboxMax[0], currentIdx[0] + static_cast< OffsetValueType >( currentLength ) - 1 );
+        if ( l < objectLines.size() )
+          {
+          currentIdx = objectLines[l].GetIndex();
+          currentLength = objectLines[l].GetLength();
+          }
+        }
+      }
+
+    m_Labels.push_back( label );
+    m_LineOffsets.push_back( m_Lines.size() );
+    m_NumberOfPixels.push_back( numberOfPixels );
+    m_BoundingBoxMinimum.push_back( bboxMin );
+    m_BoundingBoxMaximum.push_back( bboxMax );
+    }
+  m_Lines.shrink_to_fit();
+
+  this->UpdateLabelTable();
+  this->Modified();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::UpdateLabelTable()
+{
+  m_LabelTable.clear();
+  if ( m_Labels.empty() || !NumericTraits< LabelType >::is_integer )
+    {
+    return;
+    }
+  const double range = static_cast< double >( m_Labels.back() ) - static_cast< double >( m_Labels.front() ) + 1.0;
+  if ( range > 4.0 * static_cast< double >( m_Labels.size() ) + 1024.0 )
+    {
+    // too sparse: use a binary search
+    return;
+    }
+  m_LabelTable.assign( static_cast< SizeValueType >( range ), m_Labels.size() );
+  for ( SizeValueType pos = 0; pos < m_Labels.size(); ++pos )
+    {
+    m_LabelTable[static_cast< SizeValueType >( m_Labels[pos] - m_Labels.front() )] = pos;
+    }
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+typename FlatLabelMap< TLabel, VImageDimension >::SizeValueType
+FlatLabelMap< TLabel, VImageDimension >
+::GetLabelPosition(const LabelType & label) const
+{
+  const SizeValueType numberOfLabelObjects = m_Labels.size();
+  if ( numberOfLabelObjects == 0 || label < m_Labels.front() || m_Labels.back() < label )
+    {
+    return numberOfLabelObjects;
+    }
+  if ( !m_LabelTable.empty() )
+    {
+    return m_LabelTable[static_cast< SizeValueType >( label - m_Labels.front() )];
+    }
+  auto it = std::lower_bound( m_Labels.begin(), m_Labels.end(), label );
+  if ( it == m_Labels.end() || *it != label )
+    {
+    return numberOfLabelObjects;
+    }
+  return static_cast< SizeValueType >( it - m_Labels.begin() );
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+bool
+FlatLabelMap< TLabel, VImageDimension >
+::HasLabel(const LabelType & label) const
+{
+  return this->GetLabelPosition( label ) < m_Labels.size();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+typename FlatLabelMap< TLabel, VImageDimension >::ConstLabelObject
+FlatLabelMap< TLabel, VImageDimension >
+::GetLabelObject(const LabelType & label) const
+{
+  if ( m_BackgroundValue == label )
+    {
+    itkExceptionMacro(<< "Label "
+                      << static_cast< typename NumericTraits< LabelType >::PrintType >( label )
+                      << " is the background label.");
+    }
+  const SizeValueType pos = this->GetLabelPosition( label );
+  if ( pos >= m_Labels.size() )
+    {
+    itkExceptionMacro(<< "No label object with label "
+                      << static_cast< typename NumericTraits< LabelType >::PrintType >( label )
+                      << ".");
+    }
+  return ConstLabelObject( this, pos );
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+typename FlatLabelMap< TLabel, VImageDimension >::ConstLabelObject
+FlatLabelMap< TLabel, VImageDimension >
+::GetNthLabelObject(const SizeValueType & pos) const
+{
+  if ( pos >= m_Labels.size() )
+    {
+    itkExceptionMacro(<< "Can't access to label object at position "
+                      << pos
+                      << ". The label map has only "
+                      << m_Labels.size()
+                      << " label objects registered.");
+    }
+  return ConstLabelObject( this, pos );
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+const typename FlatLabelMap< TLabel, VImageDimension >::LabelType &
+FlatLabelMap< TLabel, VImageDimension >
+::GetPixel(const IndexType & idx) const
+{
+  for ( SizeValueType pos = 0; pos < m_Labels.size(); ++pos )
+    {
+    bool inside = true;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      if ( idx[d] < m_BoundingBoxMinimum[pos][d] || idx[d] > m_BoundingBoxMaximum[pos][d] )
+        {
+        inside = false;
+        break;
+        }
+      }
+    if ( inside && ConstLabelObject( this, pos ).HasIndex( idx ) )
+      {
+      return m_Labels[pos];
+      }
+    }
+  return m_BackgroundValue;
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+template< typename TLabelMap >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::CopyFromLabelMap(const TLabelMap *labelMap)
+{
+  itkAssertOrThrowMacro( ( labelMap != nullptr ), "Null Pointer" );
+
+  this->Initialize();
+  this->CopyInformation( labelMap );
+  this->SetBufferedRegion( labelMap->GetBufferedRegion() );
+  this->SetRequestedRegion( labelMap->GetRequestedRegion() );
+  m_BackgroundValue = static_cast< LabelType >( labelMap->GetBackgroundValue() );
+
+  for ( typename TLabelMap::ConstIterator it( labelMap ); !it.IsAtEnd(); ++it )
+    {
+    const typename TLabelMap::LabelObjectType * labelObject = it.GetLabelObject();
+    const auto label = static_cast< LabelType >( it.GetLabel() );
+    for ( SizeValueType i = 0; i < labelObject->GetNumberOfLines(); ++i )
+      {
+      const typename TLabelMap::LabelObjectType::LineType & line = labelObject->GetLine( i );
+      this->SetLine( line.GetIndex(), line.GetLength(), label );
+      }
+    }
+  this->Optimize();
+}
+
+
+template< typename TLabel, unsigned int VImageDimension >
+template< typename TLabelMap >
+void
+FlatLabelMap< TLabel, VImageDimension >
+::CopyToLabelMap(TLabelMap *labelMap) const
+{
+  itkAssertOrThrowMacro( ( labelMap != nullptr ), "Null Pointer" );
+
+  labelMap->CopyInformation( this );
+  labelMap->SetBufferedRegion( this->GetBufferedRegion() );
+  labelMap->SetRequestedRegion( this->GetRequestedRegion() );
+  labelMap->SetBackgroundValue( static_cast< typename TLabelMap::LabelType >( m_BackgroundValue ) );
+
+  for ( SizeValueType pos = 0; pos < m_Labels.size(); ++pos )
+    {
+    typename TLabelMap::LabelObjectType::Pointer labelObject = TLabelMap::LabelObjectType::New();
+    labelObject->SetLabel( static_cast< typename TLabelMap::LabelType >( m_Labels[pos] ) );
+    for ( SizeValueType l = m_LineOffsets[pos]; l < m_LineOffsets[pos + 1]; ++l )
+      {
+      labelObject->AddLine( m_Lines[l].GetIndex(), m_Lines[l].GetLength() );
+      }
+    labelMap->AddLabelObject( labelObject );
+    }
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,129 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkLabelImageToFlatLabelMapFilter_h
+#define itkLabelImageToFlatLabelMapFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkFlatLabelMap.h"
+
+namespace itk
+{
+/** \class LabelImageToFlatLabelMapFilter
+ * \brief Convert a labeled image to a FlatLabelMap.
+ *
+ * LabelImageToFlatLabelMapFilter produces the same label objects as
+ * LabelImageToLabelMapFilter, in a FlatLabelMap. Each work unit collects
+ * the runs of its region in a plain array, and the arrays are packed in
+ * the output in a single pass, without creating one object per label and
+ * per work unit.
+ *
+ * \sa LabelImageToLabelMapFilter, FlatLabelMap
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ * \ingroup ITKLabelMap
+ */
+template< typename TInputImage, typename TOutputImage =
+            FlatLabelMap< typename TInputImage::PixelType, TInputImage::ImageDimension > >
+class ITK_TEMPLATE_EXPORT LabelImageToFlatLabelMapFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(LabelImageToFlatLabelMapFilter);
+
+  /** Standard class type aliases. */
+  using Self = LabelImageToFlatLabelMapFilter;
+  using Superclass = ImageToImageFilter< TInputImage, TOutputImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Some convenient type alias. */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using InputImagePointer = typename InputImageType::Pointer;
+  using InputImageConstPointer = typename InputImageType::ConstPointer;
+  using InputImageRegionType = typename InputImageType::RegionType;
+  using InputImagePixelType = typename InputImageType::PixelType;
+  using IndexType = typename InputImageType::IndexType;
+
+  using OutputImagePointer = typename OutputImageType::Pointer;
+  using OutputImageConstPointer = typename OutputImageType::ConstPointer;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+  using OutputImagePixelType = typename OutputImageType::PixelType;
+  using LineType = typename OutputImageType::LineType;
+  using LengthType = typename OutputImageType::LengthType;
+
+  /** ImageDimension constants */
+  static constexpr unsigned int InputImageDimension = TInputImage::ImageDimension;
+  static constexpr unsigned int OutputImageDimension = TOutputImage::ImageDimension;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(LabelImageToFlatLabelMapFilter,
+               ImageToImageFilter);
+
+  /**
+   * Set/Get the value used as "background" in the output image.
+   * Defaults to NumericTraits<PixelType>::NonpositiveMin().
+   */
+  itkSetMacro(BackgroundValue, OutputImagePixelType);
+  itkGetConstMacro(BackgroundValue, OutputImagePixelType);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  itkConceptMacro( SameDimensionCheck,
+                   ( Concept::SameDimension< InputImageDimension, OutputImageDimension > ) );
+#endif
+
+protected:
+  LabelImageToFlatLabelMapFilter();
+  ~LabelImageToFlatLabelMapFilter() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** LabelImageToFlatLabelMapFilter needs the entire input be
+   * available. Thus, it needs to provide an implementation of
+   * GenerateInputRequestedRegion(). */
+  void GenerateInputRequestedRegion() override;
+
+  /** LabelImageToFlatLabelMapFilter will produce the entire output. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) override;
+
+  void BeforeThreadedGenerateData() override;
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+  void DynamicThreadedGenerateData( const OutputImageRegionType & ) override
+  {
+    itkExceptionMacro("This class requires threadId so it must use classic multi-threading model");
+  }
+
+  void AfterThreadedGenerateData() override;
+
+private:
+  using LabelLineVectorType = std::vector< std::pair< OutputImagePixelType, LineType > >;
+
+  OutputImagePixelType m_BackgroundValue;
+
+  std::vector< LabelLineVectorType > m_TemporaryLines;
+}; // end of class
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLabelImageToFlatLabelMapFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkLabelImageToFlatLabelMapFilter_hxx
+#define itkLabelImageToFlatLabelMapFilter_hxx
+
+#include "itkLabelImageToFlatLabelMapFilter.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include <algorithm>
+
+namespace itk
+{
+template< typename TInputImage, typename TOutputImage >
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::LabelImageToFlatLabelMapFilter()
+{
+  m_BackgroundValue = NumericTraits< OutputImagePixelType >::NonpositiveMin();
+  this->DynamicMultiThreadingOff();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  // We need all the input.
+  InputImagePointer input = const_cast< InputImageType * >( this->GetInput() );
+  if ( !input )
+    {
+    return;
+    }
+  input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  this->GetOutput()->SetRequestedRegion( this->GetOutput()->GetLargestPossibleRegion() );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+  // one array of runs per thread
+  m_TemporaryLines.clear();
+  m_TemporaryLines.resize( this->GetNumberOfWorkUnits() );
+  this->GetOutput()->SetBackgroundValue( m_BackgroundValue );
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType & regionForThread, ThreadIdType threadId)
+{
+  // report the progress once per line
+  const SizeValueType numberOfLines =
+    regionForThread.GetNumberOfPixels() / std::max< SizeValueType >( regionForThread.GetSize(0), 1 );
+  ProgressReporter progress( this, threadId, numberOfLines );
+
+  LabelLineVectorType & lines = m_TemporaryLines[threadId];
+
+  using InputLineIteratorType = ImageLinearConstIteratorWithIndex< InputImageType >;
+  InputLineIteratorType it(this->GetInput(), regionForThread);
+  it.SetDirection(0);
+
+  for ( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+    {
+    it.GoToBeginOfLine();
+
+    while ( !it.IsAtEndOfLine() )
+      {
+      const InputImagePixelType & value = it.Get();
+
+      if ( value != static_cast< InputImagePixelType >( m_BackgroundValue ) )
+        {
+        // We've hit the start of a run
+        IndexType idx = it.GetIndex();
+        LengthType      length = 1;
+        ++it;
+        while ( !it.IsAtEndOfLine() && it.Get() == value )
+          {
+          ++length;
+          ++it;
+          }
+        lines.emplace_back( static_cast< OutputImagePixelType >( value ), LineType( idx, length ) );
+        }
+      else
+        {
+        // go the the next pixel
+        ++it;
+        }
+      }
+    progress.CompletedPixel();
+    }
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+  OutputImageType *output = this->GetOutput();
+
+  // the regions of the threads are in increasing index order, so the lines
+  // of each object are already sorted when the arrays are appended in order
+  for ( ThreadIdType i = 0; i < m_TemporaryLines.size(); i++ )
+    {
+    output->AppendLines( m_TemporaryLines[i] );
+    LabelLineVectorType().swap( m_TemporaryLines[i] );
+    }
+  output->Optimize();
+
+  // release the data in the temp arrays
+  m_TemporaryLines.clear();
+}
+
+template< typename TInputImage, typename TOutputImage >
+void
+LabelImageToFlatLabelMapFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "BackgroundValue: "
+     << static_cast< typename NumericTraits< OutputImagePixelType >::PrintType >( m_BackgroundValue ) << std::endl;
+}
+} // end namespace itk
+#endif
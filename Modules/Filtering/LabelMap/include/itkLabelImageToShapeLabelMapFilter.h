@@ -134,6 +134,15 @@ public:
   itkGetConstReferenceMacro(ComputeOrientedBoundingBox, bool);
   itkBooleanMacro(ComputeOrientedBoundingBox);
 
+  /**
+   * Set/Get whether the principal moments, principal axes, elongation,
+   * flatness and equivalent ellipsoid diameter should be computed or not.
+   * Default value is true.
+   */
+  itkSetMacro(ComputePrincipalMoments, bool);
+  itkGetConstReferenceMacro(ComputePrincipalMoments, bool);
+  itkBooleanMacro(ComputePrincipalMoments);
+
 
 protected:
   LabelImageToShapeLabelMapFilter();
@@ -156,6 +165,7 @@ private:
   bool                 m_ComputeFeretDiameter;
   bool                 m_ComputePerimeter;
   bool                 m_ComputeOrientedBoundingBox;
+  bool                 m_ComputePrincipalMoments;
 }; // end of class
 } // end namespace itk
 
@@ -29,7 +29,9 @@
 #define itkLabelMapFilter_h
 
 #include "itkImageToImageFilter.h"
+#include <atomic>
 #include <mutex>
+#include <vector>
 
 namespace itk
 {
@@ -42,6 +44,13 @@ namespace itk
  * With that class, the developer doesn't need to take care of iterating over all the objects in
  * the image, or to manage by hand the threads.
  *
+ * The objects are split in chunks of about the same number of lines before
+ * the threads are started, and the threads take the chunks in order with an
+ * atomic counter, so many small objects are processed without contention.
+ * The objects of the input label map must not be added or removed during
+ * the threaded processing, except for the object being processed, which
+ * can be removed while holding m_LabelObjectContainerLock.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * This implementation was taken from the Insight Journal paper:
@@ -129,9 +138,11 @@ protected:
   std::mutex m_LabelObjectContainerLock;
 
 private:
-  typename InputImageType::Iterator m_LabelObjectIterator;
-  float                             m_InverseNumberOfLabelObjects{ 1.0f };
-  SizeValueType                     m_NumberOfLabelObjectsProcessed{ 1 };
+  std::vector< LabelObjectType * > m_LabelObjects;
+  std::vector< SizeValueType >     m_ChunkOffsets;
+  std::atomic< SizeValueType >     m_NextChunk{ 0 };
+  float                            m_InverseNumberOfLabelObjects{ 1.0f };
+  std::atomic< SizeValueType >     m_NumberOfLabelObjectsProcessed{ 1 };
 };
 } // end namespace itk
 
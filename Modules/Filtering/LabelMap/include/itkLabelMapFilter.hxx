@@ -28,7 +28,7 @@
 #ifndef itkLabelMapFilter_hxx
 #define itkLabelMapFilter_hxx
 #include "itkLabelMapFilter.h"
-#include <mutex>
+#include <algorithm>
 
 namespace itk
 {
@@ -70,18 +70,51 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::BeforeThreadedGenerateData()
 {
-  m_LabelObjectIterator =  typename InputImageType::Iterator(this->GetLabelMap());
+  InputImageType *labelMap = this->GetLabelMap();
+  const SizeValueType numberOfLabelObjects = labelMap->GetNumberOfLabelObjects();
 
-  if(Math::ExactlyEquals(this->GetLabelMap()->GetNumberOfLabelObjects(), 0.0))
+  if( numberOfLabelObjects == 0 )
     {
     m_InverseNumberOfLabelObjects = NumericTraits<float>::max();
     }
   else
     {
-    m_InverseNumberOfLabelObjects = 1.0f/this->GetLabelMap()->GetNumberOfLabelObjects();
+    m_InverseNumberOfLabelObjects = 1.0f / numberOfLabelObjects;
     }
-  //TODO: set number of work units to be equal to GetNumberOfLabelObjects()
   m_NumberOfLabelObjectsProcessed = 0;
+
+  // Split the objects in chunks of about the same cost, estimated with the
+  // number of lines of the objects. There are several chunks per work unit,
+  // so a thread which gets the large objects doesn't delay the others.
+  m_LabelObjects.clear();
+  m_LabelObjects.reserve( numberOfLabelObjects );
+  SizeValueType totalCost = 0;
+  for( typename InputImageType::Iterator it( labelMap ); !it.IsAtEnd(); ++it )
+    {
+    m_LabelObjects.push_back( it.GetLabelObject() );
+    totalCost += it.GetLabelObject()->GetNumberOfLines() + 1;
+    }
+
+  constexpr SizeValueType NumberOfChunksPerWorkUnit = 16;
+  const SizeValueType numberOfChunks = std::max< SizeValueType >( 1,
+    std::min< SizeValueType >( numberOfLabelObjects, this->GetNumberOfWorkUnits() * NumberOfChunksPerWorkUnit ) );
+  const SizeValueType chunkCost = ( totalCost + numberOfChunks - 1 ) / numberOfChunks;
+
+  m_ChunkOffsets.clear();
+  m_ChunkOffsets.reserve( numberOfChunks + 1 );
+  m_ChunkOffsets.push_back( 0 );
+  SizeValueType cost = 0;
+  for( SizeValueType i = 0; i < numberOfLabelObjects; ++i )
+    {
+    cost += m_LabelObjects[i]->GetNumberOfLines() + 1;
+    if( cost >= chunkCost && i + 1 < numberOfLabelObjects )
+      {
+      m_ChunkOffsets.push_back( i + 1 );
+      cost = 0;
+      }
+    }
+  m_ChunkOffsets.push_back( numberOfLabelObjects );
+  m_NextChunk = 0;
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -89,6 +122,8 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::AfterThreadedGenerateData()
 {
+  m_LabelObjects.clear();
+  m_ChunkOffsets.clear();
   this->UpdateProgress(1.0);
 }
 
@@ -97,45 +132,32 @@ void
 LabelMapFilter< TInputImage, TOutputImage >
 ::DynamicThreadedGenerateData( const OutputImageRegionType & )
 {
+  const SizeValueType numberOfChunks = m_ChunkOffsets.size() - 1;
   while ( true )
     {
-    LabelObjectType *labelObject;
-    // begin mutex lock
-    {
-    std::lock_guard< std::mutex > lock( m_LabelObjectContainerLock );
-
-    if ( m_LabelObjectIterator.IsAtEnd() )
+    // get the next chunk of objects, without lock
+    const SizeValueType chunk = m_NextChunk++;
+    if ( chunk >= numberOfChunks )
       {
-      // mutex lock holder deleted
       return;
       }
 
-    // get the label object
-    labelObject = m_LabelObjectIterator.GetLabelObject();
-
-    // increment the iterator now, so it will not be invalidated if the object
-    // is destroyed
-    ++m_LabelObjectIterator;
-    ++m_NumberOfLabelObjectsProcessed;
-
-    // unlock the mutex, so the other threads can get an object
-    }
-    // end mutex lock
-
-
-    // and run the user defined method for that object
-    this->ThreadedProcessLabelObject(labelObject);
-
-    // all threads needs to check the abort flag
-    if ( this->GetAbortGenerateData() )
+    for ( SizeValueType i = m_ChunkOffsets[chunk]; i < m_ChunkOffsets[chunk + 1]; ++i )
       {
-      std::string    msg;
-      ProcessAborted e(__FILE__, __LINE__);
-      msg += "Object " + std::string(this->GetNameOfClass() ) + ": AbortGenerateDataOn";
-      e.SetDescription(msg);
-      throw e;
+      // run the user defined method for that object
+      this->ThreadedProcessLabelObject( m_LabelObjects[i] );
+
+      // all threads needs to check the abort flag
+      if ( this->GetAbortGenerateData() )
+        {
+        std::string    msg;
+        ProcessAborted e(__FILE__, __LINE__);
+        msg += "Object " + std::string(this->GetNameOfClass() ) + ": AbortGenerateDataOn";
+        e.SetDescription(msg);
+        throw e;
+        }
       }
-
+    m_NumberOfLabelObjectsProcessed += m_ChunkOffsets[chunk + 1] - m_ChunkOffsets[chunk];
     }
 }
 
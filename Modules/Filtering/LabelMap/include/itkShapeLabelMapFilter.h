@@ -20,6 +20,7 @@
 
 #include "itkInPlaceLabelMapFilter.h"
 #include "itkLexicographicCompare.h"
+#include <vector>
 
 namespace itk
 {
@@ -29,15 +30,19 @@ namespace itk
  * ShapeLabelMapFilter can be used to set the attributes values of the
  * ShapeLabelObject in a LabelMap.
  *
- * ShapeLabelMapFilter takes an optional parameter, used only to
- * optimize the computation time and the memory usage when the
- * perimeter or the feret diameter is used: the exact copy of the
- * input LabelMap is stored in an Image.
- * It can be set with SetLabelImage(). It is cleared at the end of the
- * computation, so must be reset before running Update() again. It is
- * not part of the pipeline management design, to let the subclasses
- * of ShapeLabelMapFilter use the pipeline design to specify truly
- * required inputs.
+ * The attributes are grouped by cost, and only the requested groups are
+ * computed: the principal moments and the attributes derived from them,
+ * the perimeter, the Feret diameter and the oriented bounding box. The
+ * size, bounding box, centroid and border attributes are always computed.
+ *
+ * The perimeter is computed from the run-length lines of the objects,
+ * without temporary image. The Feret diameter is computed over the vertices
+ * of the convex hull of the object, found on the first and last pixels of
+ * the lines of each slice.
+ *
+ * SetLabelImage() was used to avoid the computation of a label image for
+ * the Feret diameter. The label image is not needed anymore, and the
+ * method is kept for backward compatibility.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -102,9 +107,19 @@ public:
 // End concept checking
 #endif
 
+  /**
+   * Set/Get whether the principal moments, principal axes, elongation,
+   * flatness and equivalent ellipsoid diameter should be computed or not.
+   * They are always computed when the oriented bounding box is computed.
+   * Default value is true.
+   */
+  itkSetMacro(ComputePrincipalMoments, bool);
+  itkGetConstReferenceMacro(ComputePrincipalMoments, bool);
+  itkBooleanMacro(ComputePrincipalMoments);
+
   /**
    * Set/Get whether the maximum Feret diameter should be computed or not.
-   * Default value is false because of the high computation time required.
+   * Default value is false.
    */
   itkSetMacro(ComputeFeretDiameter, bool);
   itkGetConstReferenceMacro(ComputeFeretDiameter, bool);
@@ -127,7 +142,7 @@ public:
   itkGetConstReferenceMacro(ComputeOrientedBoundingBox, bool);
   itkBooleanMacro(ComputeOrientedBoundingBox);
 
-  /** Set the label image */
+  /** Set the label image. Not used anymore. */
   void SetLabelImage(const TLabelImage *input)
   {
     m_LabelImage = input;
@@ -149,10 +164,22 @@ private:
   bool                   m_ComputeFeretDiameter;
   bool                   m_ComputePerimeter;
   bool                   m_ComputeOrientedBoundingBox;
+  bool                   m_ComputePrincipalMoments;
   LabelImageConstPointer m_LabelImage;
 
-  void ComputeFeretDiameter(LabelObjectType *labelObject);
-  void ComputePerimeter(LabelObjectType *labelObject);
+  using LineType = typename LabelObjectType::LineType;
+  using LineContainerType = std::vector< LineType >;
+  using RowOffsetContainerType = std::vector< SizeValueType >;
+
+  /** The lines of the object, sorted, and the offsets of the rows: the
+   * lines of row r are the lines from rowOffsets[r] to rowOffsets[r + 1]. */
+  void GetSortedLines(const LabelObjectType *labelObject, LineContainerType & lines,
+                      RowOffsetContainerType & rowOffsets) const;
+
+  void ComputeFeretDiameter(LabelObjectType *labelObject, const LineContainerType & lines,
+                            const RowOffsetContainerType & rowOffsets);
+  void ComputePerimeter(LabelObjectType *labelObject, const LineContainerType & lines,
+                        const RowOffsetContainerType & rowOffsets);
   void ComputeOrientedBoundingBox(LabelObjectType *labelObject);
 
   using Offset2Type = itk::Offset<2>;
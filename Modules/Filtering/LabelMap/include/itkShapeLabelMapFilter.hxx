@@ -20,17 +20,14 @@
 
 #include "itkShapeLabelMapFilter.h"
 #include "itkProgressReporter.h"
-#include "itkConstNeighborhoodIterator.h"
-#include "itkConstShapedNeighborhoodIterator.h"
 #include "itkLabelMapToLabelImageFilter.h"
-#include "itkConstantBoundaryCondition.h"
 #include "itkGeometryUtilities.h"
-#include "itkConnectedComponentAlgorithm.h"
+#include "itkLabelObjectLineComparator.h"
 #include "vnl/algo/vnl_real_eigensystem.h"
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 #include "itkMath.h"
 #include "itkLexicographicCompare.h"
-#include <deque>
+#include <algorithm>
 #include <map>
 
 namespace itk
@@ -42,6 +39,7 @@ ShapeLabelMapFilter< TImage, TLabelImage >
   m_ComputeFeretDiameter = false;
   m_ComputePerimeter = true;
   m_ComputeOrientedBoundingBox = false;
+  m_ComputePrincipalMoments = true;
 }
 
 template< typename TImage, typename TLabelImage >
@@ -50,22 +48,6 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 ::BeforeThreadedGenerateData()
 {
   Superclass::BeforeThreadedGenerateData();
-
-  // Generate the label image, if needed
-  if ( m_ComputeFeretDiameter )
-    {
-    if ( !m_LabelImage )
-      {
-      // generate an image of the labelized image
-      using LCI2IType = LabelMapToLabelImageFilter< TImage, LabelImageType >;
-      typename LCI2IType::Pointer lci2i = LCI2IType::New();
-      lci2i->SetInput( this->GetOutput() );
-      // Respect the number of threads of the filter
-      lci2i->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
-      lci2i->Update();
-      m_LabelImage = lci2i->GetOutput();
-      }
-    }
 }
 
 template< typename TImage, typename TLabelImage >
@@ -112,6 +94,9 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 
   using LengthType = typename LabelObjectType::LengthType;
 
+  // The oriented bounding box is computed in the basis of the principal axes
+  const bool computeMoments = m_ComputePrincipalMoments || m_ComputeOrientedBoundingBox;
+
   // Iterate over all the lines
   typename LabelObjectType::ConstLineIterator lit( labelObject );
   while( ! lit.IsAtEnd() )
@@ -213,6 +198,12 @@ ShapeLabelMapFilter< TImage, TLabelImage >
         }
       }
 
+    if ( !computeMoments )
+      {
+      ++lit;
+      continue;
+      }
+
     // moments computation
     //
     //  This computation has changed from what is documented in the
@@ -306,170 +297,272 @@ ShapeLabelMapFilter< TImage, TLabelImage >
     {
     centroid[i] /= nbOfPixels;
     boundingBoxSize[i] = maxs[i] - mins[i] + 1;
-    for ( unsigned int j = 0; j < ImageDimension; j++ )
-      {
-      centralMoments[i][j] /= nbOfPixels;
-      }
     }
   typename LabelObjectType::RegionType boundingBox(mins, boundingBoxSize);
   typename LabelObjectType::CentroidType physicalCentroid;
   output->TransformContinuousIndexToPhysicalPoint(centroid, physicalCentroid);
 
-  // Center the second order moments
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
+  double physicalSize = nbOfPixels * sizePerPixel;
+  double equivalentRadius = GeometryUtilities::HyperSphereRadiusFromVolume(ImageDimension, physicalSize);
+  double equivalentPerimeter = GeometryUtilities::HyperSpherePerimeter(ImageDimension, equivalentRadius);
+
+  // Set the values in the object
+  labelObject->SetNumberOfPixels(nbOfPixels);
+  labelObject->SetPhysicalSize(physicalSize);
+  labelObject->SetBoundingBox(boundingBox);
+  labelObject->SetCentroid(physicalCentroid);
+  labelObject->SetNumberOfPixelsOnBorder(nbOfPixelsOnBorder);
+  labelObject->SetPerimeterOnBorder(perimeterOnBorder);
+  labelObject->SetEquivalentSphericalRadius(equivalentRadius);
+  labelObject->SetEquivalentSphericalPerimeter(equivalentPerimeter);
+
+  if ( computeMoments )
     {
-    for ( unsigned int j = 0; j < ImageDimension; j++ )
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
       {
-      centralMoments[i][j] -= physicalCentroid[i] * physicalCentroid[j];
+      for ( unsigned int j = 0; j < ImageDimension; j++ )
+        {
+        centralMoments[i][j] /= nbOfPixels;
+        }
       }
-    }
 
-  // Compute principal moments and axes
-  VectorType                          principalMoments;
-  vnl_symmetric_eigensystem< double > eigen( centralMoments.GetVnlMatrix() );
-  vnl_diag_matrix< double >           pm = eigen.D;
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
-    {
-    principalMoments[i] = pm(i);
-    }
-  MatrixType principalAxes = eigen.V.transpose();
+    // Center the second order moments
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      for ( unsigned int j = 0; j < ImageDimension; j++ )
+        {
+        centralMoments[i][j] -= physicalCentroid[i] * physicalCentroid[j];
+        }
+      }
 
-  // Add a final reflection if needed for a proper rotation,
-  // by multiplying the last row by the determinant
-  vnl_real_eigensystem                     eigenrot( principalAxes.GetVnlMatrix() );
-  vnl_diag_matrix< std::complex< double > > eigenval = eigenrot.D;
-  std::complex< double >                    det(1.0, 0.0);
+    // Compute principal moments and axes
+    VectorType                          principalMoments;
+    vnl_symmetric_eigensystem< double > eigen( centralMoments.GetVnlMatrix() );
+    vnl_diag_matrix< double >           pm = eigen.D;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      principalMoments[i] = pm(i);
+      }
+    MatrixType principalAxes = eigen.V.transpose();
 
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
-    {
-    det *= eigenval(i);
-    }
+    // Add a final reflection if needed for a proper rotation,
+    // by multiplying the last row by the determinant
+    vnl_real_eigensystem                     eigenrot( principalAxes.GetVnlMatrix() );
+    vnl_diag_matrix< std::complex< double > > eigenval = eigenrot.D;
+    std::complex< double >                    det(1.0, 0.0);
 
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
-    {
-    principalAxes[ImageDimension - 1][i] *= std::real(det);
-    }
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      det *= eigenval(i);
+      }
 
-  double elongation = 0;
-  double flatness = 0;
-  if ( ImageDimension < 2 )
-    {
-    elongation = 1;
-    flatness = 1;
-    }
-  else
-    {
-    if ( Math::NotAlmostEquals( principalMoments[0], itk::NumericTraits< typename VectorType::ValueType >::ZeroValue() ) )
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      principalAxes[ImageDimension - 1][i] *= std::real(det);
+      }
+
+    double elongation = 0;
+    double flatness = 0;
+    if ( ImageDimension < 2 )
+      {
+      elongation = 1;
+      flatness = 1;
+      }
+    else
       {
-      const double flatnessRatio = principalMoments[1] / principalMoments[0];
-      flatness = 0.0;
-      if ( flatnessRatio > 0.0 )
+      if ( Math::NotAlmostEquals( principalMoments[0], itk::NumericTraits< typename VectorType::ValueType >::ZeroValue() ) )
+        {
+        const double flatnessRatio = principalMoments[1] / principalMoments[0];
+        flatness = 0.0;
+        if ( flatnessRatio > 0.0 )
+          {
+          flatness = std::sqrt( flatnessRatio);
+          }
+        }
+      if ( Math::NotAlmostEquals( principalMoments[ImageDimension - 2], itk::NumericTraits< typename VectorType::ValueType >::ZeroValue() ) )
         {
-        flatness = std::sqrt( flatnessRatio);
+        const double elongationRatio = principalMoments[ImageDimension - 1] / principalMoments[ImageDimension - 2];
+        elongation = 0.0;
+        if ( elongationRatio > 0.0 )
+          {
+          elongation = std::sqrt( elongationRatio );
+          }
         }
       }
-    if ( Math::NotAlmostEquals( principalMoments[ImageDimension - 2], itk::NumericTraits< typename VectorType::ValueType >::ZeroValue() ) )
+
+    // Compute equivalent ellipsoid radius
+    VectorType ellipsoidDiameter;
+    double     edet = 1.0;
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
       {
-      const double elongationRatio = principalMoments[ImageDimension - 1] / principalMoments[ImageDimension - 2];
-      elongation = 0.0;
-      if ( elongationRatio > 0.0 )
+      edet *= principalMoments[i];
+      }
+    edet = std::pow(edet, 1.0 / ImageDimension);
+    for ( unsigned int i = 0; i < ImageDimension; i++ )
+      {
+      ellipsoidDiameter[i] = 0.0;
+      if ( edet != 0.0 &&  principalMoments[i] / edet > 0.0 )
         {
-        elongation = std::sqrt( elongationRatio );
+        ellipsoidDiameter[i] = 2.0 *equivalentRadius *std::sqrt(principalMoments[i] / edet);
         }
       }
-    }
 
-  double physicalSize = nbOfPixels * sizePerPixel;
-  double equivalentRadius = GeometryUtilities::HyperSphereRadiusFromVolume(ImageDimension, physicalSize);
-  double equivalentPerimeter = GeometryUtilities::HyperSpherePerimeter(ImageDimension, equivalentRadius);
-
-  // Compute equivalent ellipsoid radius
-  VectorType ellipsoidDiameter;
-  double     edet = 1.0;
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
-    {
-    edet *= principalMoments[i];
+    labelObject->SetPrincipalMoments(principalMoments);
+    labelObject->SetPrincipalAxes(principalAxes);
+    labelObject->SetElongation(elongation);
+    labelObject->SetEquivalentEllipsoidDiameter(ellipsoidDiameter);
+    labelObject->SetFlatness(flatness);
     }
-  edet = std::pow(edet, 1.0 / ImageDimension);
-  for ( unsigned int i = 0; i < ImageDimension; i++ )
+
+  if ( m_ComputeFeretDiameter || m_ComputePerimeter )
     {
-    ellipsoidDiameter[i] = 0.0;
-    if ( edet != 0.0 &&  principalMoments[i] / edet > 0.0 )
+    LineContainerType      lines;
+    RowOffsetContainerType rowOffsets;
+    this->GetSortedLines(labelObject, lines, rowOffsets);
+
+    if ( m_ComputeFeretDiameter )
       {
-      ellipsoidDiameter[i] = 2.0 *equivalentRadius *std::sqrt(principalMoments[i] / edet);
+      this->ComputeFeretDiameter(labelObject, lines, rowOffsets);
       }
-    }
 
-  // Set the values in the object
-  labelObject->SetNumberOfPixels(nbOfPixels);
-  labelObject->SetPhysicalSize(physicalSize);
-  labelObject->SetBoundingBox(boundingBox);
-  labelObject->SetCentroid(physicalCentroid);
-  labelObject->SetNumberOfPixelsOnBorder(nbOfPixelsOnBorder);
-  labelObject->SetPerimeterOnBorder(perimeterOnBorder);
-  labelObject->SetPrincipalMoments(principalMoments);
-  labelObject->SetPrincipalAxes(principalAxes);
-  labelObject->SetElongation(elongation);
-  labelObject->SetEquivalentSphericalRadius(equivalentRadius);
-  labelObject->SetEquivalentSphericalPerimeter(equivalentPerimeter);
-  labelObject->SetEquivalentEllipsoidDiameter(ellipsoidDiameter);
-  labelObject->SetFlatness(flatness);
+    if ( m_ComputePerimeter )
+      {
+      this->ComputePerimeter(labelObject, lines, rowOffsets);
+      }
+    }
 
-  if ( m_ComputeFeretDiameter )
+   if ( m_ComputeOrientedBoundingBox )
     {
-    this->ComputeFeretDiameter(labelObject);
+    this->ComputeOrientedBoundingBox(labelObject);
     }
+}
 
-  if ( m_ComputePerimeter )
+template< typename TImage, typename TLabelImage >
+void
+ShapeLabelMapFilter< TImage, TLabelImage >
+::GetSortedLines(const LabelObjectType *labelObject, LineContainerType & lines,
+                 RowOffsetContainerType & rowOffsets) const
+{
+  const SizeValueType numberOfLines = labelObject->GetNumberOfLines();
+  lines.clear();
+  lines.reserve( numberOfLines );
+
+  // the lines are usually already sorted
+  typename Functor::LabelObjectLineComparator< LineType > comparator;
+  bool sorted = true;
+  for ( SizeValueType l = 0; l < numberOfLines; ++l )
+    {
+    const LineType & line = labelObject->GetLine( l );
+    if ( sorted && l > 0 && comparator( line, lines.back() ) )
+      {
+      sorted = false;
+      }
+    lines.push_back( line );
+    }
+  if ( !sorted )
     {
-    this->ComputePerimeter(labelObject);
+    std::sort( lines.begin(), lines.end(), comparator );
     }
 
-   if ( m_ComputeOrientedBoundingBox )
+  // the rows are the lines with the same index on all the axes but 0
+  rowOffsets.clear();
+  for ( SizeValueType l = 0; l < numberOfLines; ++l )
     {
-    this->ComputeOrientedBoundingBox(labelObject);
+    bool newRow = ( l == 0 );
+    for ( unsigned int i = 1; i < ImageDimension && !newRow; i++ )
+      {
+      newRow = lines[l].GetIndex()[i] != lines[l - 1].GetIndex()[i];
+      }
+    if ( newRow )
+      {
+      rowOffsets.push_back( l );
+      }
     }
+  rowOffsets.push_back( numberOfLines );
 }
 
 template< typename TImage, typename TLabelImage >
 void
 ShapeLabelMapFilter< TImage, TLabelImage >
-::ComputeFeretDiameter(LabelObjectType *labelObject)
+::ComputeFeretDiameter(LabelObjectType *labelObject, const LineContainerType & lines,
+                       const RowOffsetContainerType & rowOffsets)
 {
-  const LabelPixelType & label = labelObject->GetLabel();
-
-  using IndexListType = typename std::deque< IndexType >;
+  // The Feret diameter is the largest distance between two vertices of the
+  // convex hull of the object. The pixels inside a row are between the first
+  // and the last pixel of the row, and the vertices of the convex hull are
+  // vertices of the 2D convex hull of their slice on the axes 0 and 1, so
+  // only the vertices of the convex hulls of the slices are kept.
+  using IndexListType = std::vector< IndexType >;
   IndexListType idxList;
+  IndexListType slicePoints;
+  IndexListType hull;
 
-  using NeighborIteratorType = typename itk::ConstNeighborhoodIterator< LabelImageType >;
-  SizeType neighborHoodRadius;
-  neighborHoodRadius.Fill(1);
-  NeighborIteratorType                        it( neighborHoodRadius, m_LabelImage, m_LabelImage->GetBufferedRegion() );
-  ConstantBoundaryCondition< LabelImageType > lcbc;
-  // Use label + 1 to have a label different of the current label on the border
-  lcbc.SetConstant(label + 1);
-  it.OverrideBoundaryCondition(&lcbc);
-  it.GoToBegin();
-
-  using NeighborIndexType = typename NeighborIteratorType::NeighborIndexType;
-
-  // Iterate over all the indexes
-  typename LabelObjectType::ConstIndexIterator iit( labelObject );
-  while( ! iit.IsAtEnd() )
+  // Cross product of (b - a) and (c - a) on the axes 0 and 1
+  auto cross = []( const IndexType & a, const IndexType & b, const IndexType & c ) -> OffsetValueType
     {
-    // Move the iterator to the new location
-    it += iit.GetIndex() - it.GetIndex();
-
-    // Push the pixel in the list if it is on the border of the object
-    for ( NeighborIndexType i = 0; i < it.Size(); i++ )
+    const OffsetValueType d0 = ( b[0] - a[0] ) * ( c[1] - a[1] );
+    const OffsetValueType d1 = ( b[1] - a[1] ) * ( c[0] - a[0] );
+    return d0 - d1;
+    };
+
+  const SizeValueType numberOfRows = rowOffsets.size() - 1;
+  SizeValueType row = 0;
+  while ( row < numberOfRows )
+    {
+    // collect the first and last pixel of the rows of the slice. They are
+    // sorted on the axis 1, then on the axis 0.
+    slicePoints.clear();
+    const IndexType & sliceIdx = lines[rowOffsets[row]].GetIndex();
+    for ( ; row < numberOfRows; ++row )
       {
-      if ( it.GetPixel(i) != label )
+      const LineType & first = lines[rowOffsets[row]];
+      const LineType & last = lines[rowOffsets[row + 1] - 1];
+      bool sameSlice = true;
+      for ( unsigned int i = 2; i < ImageDimension; i++ )
+        {
+        if ( first.GetIndex()[i] != sliceIdx[i] )
+          {
+          sameSlice = false;
+          break;
+          }
+        }
+      if ( !sameSlice )
         {
-        idxList.push_back( iit.GetIndex() );
         break;
         }
+      slicePoints.push_back( first.GetIndex() );
+      IndexType lastIdx = last.GetIndex();
+      lastIdx[0] += last.GetLength() - 1;
+      slicePoints.push_back( lastIdx );
+      }
+
+    if ( ImageDimension < 2 || slicePoints.size() <= 3 )
+      {
+      idxList.insert( idxList.end(), slicePoints.begin(), slicePoints.end() );
+      continue;
+      }
+
+    // monotone chain convex hull
+    hull.clear();
+    for ( const IndexType & p : slicePoints )
+      {
+      while ( hull.size() >= 2 && cross( hull[hull.size() - 2], hull.back(), p ) <= 0 )
+        {
+        hull.pop_back();
+        }
+      hull.push_back( p );
       }
-    ++iit;
+    const size_t lowerSize = hull.size() + 1;
+    for ( auto it = slicePoints.rbegin() + 1; it != slicePoints.rend(); ++it )
+      {
+      while ( hull.size() >= lowerSize && cross( hull[hull.size() - 2], hull.back(), *it ) <= 0 )
+        {
+        hull.pop_back();
+        }
+      hull.push_back( *it );
+      }
+    // the last point is the first one
+    idxList.insert( idxList.end(), hull.begin(), hull.end() - 1 );
     }
 
   ImageType *output = this->GetOutput();
@@ -489,8 +582,8 @@ ShapeLabelMapFilter< TImage, TLabelImage >
       double length = 0;
       for ( unsigned int i = 0; i < ImageDimension; i++ )
         {
-        const OffsetValueType indexDifference = ( iIt1->operator[](i) - iIt2->operator[](i) );
-        length += std::pow(indexDifference * spacing[i], 2);
+        const double indexDifference = ( iIt1->operator[](i) - iIt2->operator[](i) ) * spacing[i];
+        length += indexDifference * indexDifference;
         }
       if ( feretDiameter < length )
         {
@@ -508,147 +601,132 @@ ShapeLabelMapFilter< TImage, TLabelImage >
 template< typename TImage, typename TLabelImage >
 void
 ShapeLabelMapFilter< TImage, TLabelImage >
-::ComputePerimeter(LabelObjectType *labelObject)
+::ComputePerimeter(LabelObjectType *labelObject, const LineContainerType & lines,
+                   const RowOffsetContainerType & rowOffsets)
 {
-  // store the lines in a N-1D image of vectors
-  using VectorLineType = std::deque< typename LabelObjectType::LineType >;
-  using LineImageType = itk::Image< VectorLineType, ImageDimension - 1 >;
-  typename LineImageType::Pointer lineImage = LineImageType::New();
-  typename LineImageType::IndexType lIdx;
-  typename LineImageType::SizeType lSize;
-  RegionType boundingBox = labelObject->GetBoundingBox();
-  for( unsigned int i=0; i<ImageDimension-1; i++ )
+  // The intercepts are counted between each row and its neighbor rows on
+  // the axes other than 0, with full connectivity. The rows are sorted, so
+  // the neighbor rows at a given offset are found by moving forward a cursor
+  // per offset.
+  const SizeValueType numberOfRows = rowOffsets.size() - 1;
+
+  // the offsets of the neighbor rows, on all the axes but 0
+  std::vector< OffsetType > neighborOffsets;
+  OffsetType                offset;
+  offset.Fill( -1 );
+  offset[0] = 0;
+  while ( true )
     {
-    lIdx[i] = boundingBox.GetIndex()[i+1];
-    lSize[i] = boundingBox.GetSize()[i+1];
+    bool isCenter = true;
+    for ( unsigned int i = 1; i < ImageDimension; i++ )
+      {
+      isCenter = isCenter && offset[i] == 0;
+      }
+    if ( !isCenter )
+      {
+      neighborOffsets.push_back( offset );
+      }
+    unsigned int i = 1;
+    while ( i < ImageDimension && offset[i] == 1 )
+      {
+      offset[i] = -1;
+      i++;
+      }
+    if ( i == ImageDimension )
+      {
+      break;
+      }
+    offset[i]++;
     }
-  typename LineImageType::RegionType lRegion;
-  lRegion.SetIndex( lIdx );
-  lRegion.SetSize( lSize );
-  // enlarge the region a bit to avoid boundary problems
-  typename LineImageType::RegionType elRegion(lRegion);
-  lSize.Fill(1);
-  elRegion.PadByRadius(lSize);
-  // std::cout << boundingBox << "  " << lRegion << "  " << elRegion << std::endl;
-  // now initialize the image
-  lineImage->SetRegions( elRegion );
-  lineImage->Allocate();
-  lineImage->FillBuffer( VectorLineType() );
-
-  // std::cout << "lineContainer.size(): " << lineContainer.size() << std::endl;
-
-  // Iterate over all the lines and fill the image of lines
-  typename LabelObjectType::ConstLineIterator lit( labelObject );
-  while( ! lit.IsAtEnd() )
+  const size_t numberOfNeighbors = neighborOffsets.size();
+
+  // the neighbor rows which are the closest to the current row, and the
+  // intercepts counted in the direction of each neighbor
+  std::vector< SizeValueType > cursors( numberOfNeighbors, 0 );
+  std::vector< SizeValueType > neighborIntercepts( numberOfNeighbors, 0 );
+  std::vector< SizeValueType > diagonalIntercepts( numberOfNeighbors, 0 );
+  SizeValueType                axisIntercepts = 0;
+
+  // compare the rows on the axes ImageDimension-1 to 1
+  auto compareRows = []( const IndexType & a, const IndexType & b ) -> int
     {
-    const IndexType & idx = lit.GetLine().GetIndex();
-    for( unsigned int i=0; i<ImageDimension-1; i++ )
+    for ( int i = ImageDimension - 1; i >= 1; i-- )
       {
-      lIdx[i] = idx[i+1];
+      if ( a[i] != b[i] )
+        {
+        return a[i] < b[i] ? -1 : 1;
+        }
       }
-    lineImage->GetPixel( lIdx ).push_back( lit.GetLine() );
-    ++lit;
-    }
+    return 0;
+    };
 
-  // a data structure to store the number of intercepts on each direction
-  using MapInterceptType = typename std::map<OffsetType, SizeValueType, Functor::LexicographicCompare>;
-  MapInterceptType intercepts;
-  // int nbOfDirections = (int)std::pow( 2.0, (int)ImageDimension ) - 1;
-  // intecepts.resize(nbOfDirections + 1);  // code begins at position 1
-
-  // now iterate over the vectors of lines
-  using LineImageIteratorType = ConstShapedNeighborhoodIterator< LineImageType >;
-  LineImageIteratorType lIt( lSize, lineImage, lRegion ); // the original, non padded region
-  setConnectivity( &lIt, true );
-  for( lIt.GoToBegin(); !lIt.IsAtEnd(); ++lIt )
+  const IndexValueType lZero = 0;
+  for ( SizeValueType row = 0; row < numberOfRows; ++row )
     {
-    const VectorLineType & ls = lIt.GetCenterPixel();
+    const LineType *lsBegin = lines.data() + rowOffsets[row];
+    const LineType *lsEnd = lines.data() + rowOffsets[row + 1];
 
     // there are two intercepts on the 0 axis for each line
-    OffsetType no;
-    no.Fill(0);
-    no[0] = 1;
-    // std::cout << no << "-> " << 2 * ls.size() << std::endl;
-    intercepts[no] += 2 * static_cast<SizeValueType>( ls.size() );
-
-    // and look at the neighbors
-    typename LineImageIteratorType::ConstIterator ci;
-    for (ci = lIt.Begin(); ci != lIt.End(); ci++)
-      {
-          // std::cout << "-------------" << std::endl;
-      // the vector of lines in the neighbor
-      const VectorLineType & ns = ci.Get();
-      // prepare the offset to be stored in the intercepts map
-      typename LineImageType::OffsetType lno = ci.GetNeighborhoodOffset();
-      no[0] = 0;
-      for( unsigned int i=0; i<ImageDimension-1; i++ )
-        {
-        no[i+1] = itk::Math::abs(lno[i]);
-        }
-      OffsetType dno = no; // offset for the diagonal
-      dno[0] = 1;
+    axisIntercepts += 2 * static_cast< SizeValueType >( lsEnd - lsBegin );
 
-      // now process the two lines to search the pixels on the contour of the object
-      if( ls.empty() )
+    for ( size_t n = 0; n < numberOfNeighbors; ++n )
+      {
+      // search the neighbor row
+      const IndexType neighborIdx = lsBegin->GetIndex() + neighborOffsets[n];
+      SizeValueType & cursor = cursors[n];
+      while ( cursor < numberOfRows && compareRows( lines[rowOffsets[cursor]].GetIndex(), neighborIdx ) < 0 )
         {
-        // std::cout << "ls.empty()" << std::endl;
-        // nothing to do
+        ++cursor;
         }
-      if( ns.empty() )
+      const bool hasNeighbor = cursor < numberOfRows
+                               && compareRows( lines[rowOffsets[cursor]].GetIndex(), neighborIdx ) == 0;
+
+      if ( !hasNeighbor )
         {
         // no line in the neighbors - all the lines in ls are on the contour
-        for( auto li = ls.begin(); li != ls.end(); ++li )
+        for ( const LineType *li = lsBegin; li != lsEnd; ++li )
           {
-          // std::cout << "ns.empty()" << std::endl;
-          const typename LabelObjectType::LineType & l = *li;
           // add as much intercepts as the line size
-          intercepts[no] += l.GetLength();
+          neighborIntercepts[n] += li->GetLength();
           // and 2 times as much diagonal intercepts as the line size
-          intercepts[dno] += l.GetLength() * 2;
+          diagonalIntercepts[n] += li->GetLength() * 2;
           }
         }
       else
         {
-        // std::cout << "else" << std::endl;
         // TODO - fix the code when the line starts at  NumericTraits<IndexValueType>::NonpositiveMin()
         // or end at  NumericTraits<IndexValueType>::max()
-        auto li = ls.begin();
-        auto ni = ns.begin();
+        const LineType *li = lsBegin;
+        const LineType *ni = lines.data() + rowOffsets[cursor];
+        const LineType *nsEnd = lines.data() + rowOffsets[cursor + 1];
 
-        IndexValueType lZero = 0;
         IndexValueType lMin = 0;
         IndexValueType lMax = 0;
 
         IndexValueType nMin = NumericTraits<IndexValueType>::NonpositiveMin() + 1;
         IndexValueType nMax = ni->GetIndex()[0] - 1;
 
-        while( li!=ls.end() )
+        while( li != lsEnd )
           {
           // update the current line min and max. Neighbor line data is already up to date.
           lMin = li->GetIndex()[0];
           lMax = lMin + li->GetLength() - 1;
 
           // add as much intercepts as intersections of the 2 lines
-          intercepts[no] += std::max( lZero, std::min(lMax, nMax) - std::max(lMin, nMin) + 1 );
-          // std::cout << "============" << std::endl;
-          // std::cout << "  lMin:" << lMin << " lMax:" << lMax << " nMin:" << nMin << " nMax:" << nMax;
-          // std::cout << " count: " << std::max( 0l, std::min(lMax, nMax) - std::max(lMin, nMin) + 1 ) << std::endl;
-          // std::cout << "  " << no << ": " << intercepts[no] << std::endl;
-          // std::cout << std::max( lZero, std::min(lMax, nMax+1) - std::max(lMin, nMin+1) + 1 ) << std::endl;
-          // std::cout << std::max( lZero, std::min(lMax, nMax-1) - std::max(lMin, nMin-1) + 1 ) << std::endl;
+          neighborIntercepts[n] += std::max( lZero, std::min(lMax, nMax) - std::max(lMin, nMin) + 1 );
           // left diagonal intercepts
-          intercepts[dno] += std::max( lZero, std::min(lMax, nMax+1) - std::max(lMin, nMin+1) + 1 );
+          diagonalIntercepts[n] += std::max( lZero, std::min(lMax, nMax+1) - std::max(lMin, nMin+1) + 1 );
           // right diagonal intercepts
-          intercepts[dno] += std::max( lZero, std::min(lMax, nMax-1) - std::max(lMin, nMin-1) + 1 );
+          diagonalIntercepts[n] += std::max( lZero, std::min(lMax, nMax-1) - std::max(lMin, nMin-1) + 1 );
 
           // go to the next line or the next neighbor depending on where we are
-          if(nMax <= lMax )
+          if( nMax <= lMax )
             {
             // go to next neighbor
             nMin = ni->GetIndex()[0] + ni->GetLength();
             ni++;
 
-            if( ni != ns.end() )
+            if( ni != nsEnd )
               {
               nMax = ni->GetIndex()[0] - 1;
               }
@@ -663,11 +741,30 @@ ShapeLabelMapFilter< TImage, TLabelImage >
             li++;
             }
           }
-
         }
       }
     }
 
+  // a data structure to store the number of intercepts on each direction
+  using MapInterceptType = typename std::map<OffsetType, SizeValueType, Functor::LexicographicCompare>;
+  MapInterceptType intercepts;
+  OffsetType no;
+  no.Fill(0);
+  no[0] = 1;
+  intercepts[no] += axisIntercepts;
+  for ( size_t n = 0; n < numberOfNeighbors; ++n )
+    {
+    no[0] = 0;
+    for( unsigned int i=1; i<ImageDimension; i++ )
+      {
+      no[i] = itk::Math::abs(neighborOffsets[n][i]);
+      }
+    intercepts[no] += neighborIntercepts[n];
+    // offset for the diagonal
+    no[0] = 1;
+    intercepts[no] += diagonalIntercepts[n];
+    }
+
   // compute the perimeter based on the intercept counts
   double perimeter = PerimeterFromInterceptCount( intercepts, this->GetOutput()->GetSpacing() );
   labelObject->SetPerimeter( perimeter );
@@ -938,6 +1035,7 @@ ShapeLabelMapFilter< TImage, TLabelImage >
   os << indent << "ComputeFeretDiameter: " << m_ComputeFeretDiameter << std::endl;
   os << indent << "ComputePerimeter: " << m_ComputePerimeter << std::endl;
   os << indent << "ComputeOrientedBoundingBox: " << m_ComputeOrientedBoundingBox << std::endl;
+  os << indent << "ComputePrincipalMoments: " << m_ComputePrincipalMoments << std::endl;
 }
 
 } // end namespace itk
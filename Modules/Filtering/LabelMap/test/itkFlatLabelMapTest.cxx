@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFlatLabelMap.h"
+#include "itkLabelImageToFlatLabelMapFilter.h"
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Convert a label image to a FlatLabelMap and to a LabelMap, and check that
+ * both contain the same objects. Also check the lookup of sparse labels,
+ * the lines added out of order, and the conversions between both maps.
+ */
+int itkFlatLabelMapTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 3;
+  using PixelType = unsigned short;
+  using ImageType = itk::Image< PixelType, Dimension >;
+  using FlatLabelMapType = itk::FlatLabelMap< PixelType, Dimension >;
+  using LabelObjectType = itk::LabelObject< PixelType, Dimension >;
+  using LabelMapType = itk::LabelMap< LabelObjectType >;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 23;
+  size[2] = 11;
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( static_cast< PixelType >( ( index[0] / 5 + 3 * ( index[1] / 4 ) + index[2] * index[2] ) % 29 ) );
+    }
+
+  using FlatFilterType = itk::LabelImageToFlatLabelMapFilter< ImageType >;
+  FlatFilterType::Pointer flatFilter = FlatFilterType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( flatFilter, LabelImageToFlatLabelMapFilter, ImageToImageFilter );
+  itk::SimpleFilterWatcher watcher( flatFilter, "LabelImageToFlatLabelMapFilter" );
+  flatFilter->SetInput( image );
+  flatFilter->SetBackgroundValue( 0 );
+  TEST_SET_GET_VALUE( 0, flatFilter->GetBackgroundValue() );
+  flatFilter->SetNumberOfWorkUnits( 4 );
+  TRY_EXPECT_NO_EXCEPTION( flatFilter->Update() );
+  FlatLabelMapType::Pointer flat = flatFilter->GetOutput();
+  EXERCISE_BASIC_OBJECT_METHODS( flat, FlatLabelMap, ImageBase );
+
+  using FilterType = itk::LabelImageToLabelMapFilter< ImageType, LabelMapType >;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( image );
+  filter->SetBackgroundValue( 0 );
+  TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+  LabelMapType::Pointer labelMap = filter->GetOutput();
+  labelMap->Optimize();
+
+  TEST_EXPECT_EQUAL( flat->GetNumberOfLabelObjects(), labelMap->GetNumberOfLabelObjects() );
+  TEST_EXPECT_EQUAL( flat->GetLargestPossibleRegion(), image->GetLargestPossibleRegion() );
+  TEST_EXPECT_TRUE( flat->GetUseDenseLabelTable() );
+  TEST_EXPECT_TRUE( !flat->HasPendingLines() );
+
+  // Same objects, in the same order, with the same lines and attributes.
+  itk::SizeValueType numberOfPixels = 0;
+  LabelMapType::ConstIterator lit( labelMap );
+  FlatLabelMapType::ConstIterator fit( flat );
+  for( ; !fit.IsAtEnd(); ++fit, ++lit )
+    {
+    TEST_EXPECT_TRUE( !lit.IsAtEnd() );
+    const LabelObjectType * labelObject = lit.GetLabelObject();
+    const FlatLabelMapType::LabelObjectType * flatObject = fit.GetLabelObject();
+    TEST_EXPECT_EQUAL( fit.GetLabel(), lit.GetLabel() );
+    TEST_EXPECT_EQUAL( flatObject->GetLabel(), lit.GetLabel() );
+    TEST_EXPECT_EQUAL( flatObject->Size(), labelObject->Size() );
+    TEST_EXPECT_EQUAL( flatObject->GetNumberOfLines(), labelObject->GetNumberOfLines() );
+    for( itk::SizeValueType i = 0; i < flatObject->GetNumberOfLines(); ++i )
+      {
+      TEST_EXPECT_EQUAL( flatObject->GetLine( i ).GetIndex(), labelObject->GetLine( i ).GetIndex() );
+      TEST_EXPECT_EQUAL( flatObject->GetLine( i ).GetLength(), labelObject->GetLine( i ).GetLength() );
+      }
+    TEST_EXPECT_EQUAL( flatObject->GetIndex( flatObject->Size() / 2 ), labelObject->GetIndex( labelObject->Size() / 2 ) );
+
+    // the bounding box contains all the lines and touches them on each side
+    const FlatLabelMapType::RegionType bbox = flatObject->GetBoundingBox();
+    itk::SizeValueType numberOfLinePixels = 0;
+    FlatLabelMapType::IndexType extremum = bbox.GetIndex();
+    for( FlatLabelMapType::LabelObjectType::ConstLineIterator lineIt( flatObject ); !lineIt.IsAtEnd(); ++lineIt )
+      {
+      const FlatLabelMapType::LineType & line = lineIt.GetLine();
+      FlatLabelMapType::IndexType last = line.GetIndex();
+      last[0] += line.GetLength() - 1;
+      TEST_EXPECT_TRUE( bbox.IsInside( line.GetIndex() ) && bbox.IsInside( last ) );
+      TEST_EXPECT_TRUE( flatObject->HasIndex( line.GetIndex() ) && flatObject->HasIndex( last ) );
+      TEST_EXPECT_EQUAL( image->GetPixel( last ), fit.GetLabel() );
+      numberOfLinePixels += line.GetLength();
+      for( unsigned int d = 0; d < Dimension; ++d )
+        {
+        extremum[d] = std::max( extremum[d], last[d] );
+        }
+      }
+    TEST_EXPECT_EQUAL( numberOfLinePixels, flatObject->Size() );
+    TEST_EXPECT_EQUAL( extremum, bbox.GetUpperIndex() );
+    numberOfPixels += flatObject->Size();
+
+    TEST_EXPECT_EQUAL( flat->GetLabelObject( fit.GetLabel() ).GetPosition(), flatObject->GetPosition() );
+    TEST_EXPECT_EQUAL( flat->GetNthLabelObject( flatObject->GetPosition() ).GetLabel(), fit.GetLabel() );
+    }
+  TEST_EXPECT_TRUE( lit.IsAtEnd() );
+  FlatLabelMapType::ConstIterator begin( flat );
+  TEST_EXPECT_TRUE( begin != fit );
+  begin.GoToBegin();
+  TEST_EXPECT_EQUAL( begin.GetLabel(), flat->GetLabels().front() );
+
+  // Every pixel of the image is found in the map.
+  itk::SizeValueType numberOfForegroundPixels = 0;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    if( it.Get() != 0 )
+      {
+      ++numberOfForegroundPixels;
+      if( !( it.GetIndex()[0] % 7 ) )
+        {
+        TEST_EXPECT_EQUAL( flat->GetPixel( it.GetIndex() ), it.Get() );
+        TEST_EXPECT_TRUE( flat->GetLabelObject( it.Get() ).HasIndex( it.GetIndex() ) );
+        }
+      }
+    }
+  TEST_EXPECT_EQUAL( numberOfPixels, numberOfForegroundPixels );
+
+  TRY_EXPECT_EXCEPTION( flat->GetLabelObject( 0 ) );
+  TRY_EXPECT_EXCEPTION( flat->GetLabelObject( 1000 ) );
+  TRY_EXPECT_EXCEPTION( flat->GetNthLabelObject( flat->GetNumberOfLabelObjects() ) );
+  TEST_EXPECT_TRUE( !flat->HasLabel( 0 ) );
+  TEST_EXPECT_TRUE( !flat->HasLabel( 1000 ) );
+
+  // Conversions from and to a LabelMap.
+  LabelMapType::Pointer copy = LabelMapType::New();
+  flat->CopyToLabelMap( copy.GetPointer() );
+  TEST_EXPECT_EQUAL( copy->GetNumberOfLabelObjects(), labelMap->GetNumberOfLabelObjects() );
+  TEST_EXPECT_EQUAL( copy->GetLargestPossibleRegion(), labelMap->GetLargestPossibleRegion() );
+  FlatLabelMapType::Pointer flatCopy = FlatLabelMapType::New();
+  flatCopy->CopyFromLabelMap( labelMap.GetPointer() );
+  TEST_EXPECT_EQUAL( flatCopy->GetLines().size(), flat->GetLines().size() );
+  TEST_EXPECT_TRUE( flatCopy->GetLabels() == flat->GetLabels() );
+  TEST_EXPECT_TRUE( flatCopy->GetNumberOfPixelsArray() == flat->GetNumberOfPixelsArray() );
+  TEST_EXPECT_TRUE( flatCopy->GetBoundingBoxMinimumArray() == flat->GetBoundingBoxMinimumArray() );
+  TEST_EXPECT_TRUE( flatCopy->GetBoundingBoxMaximumArray() == flat->GetBoundingBoxMaximumArray() );
+
+  // Sparse labels, and lines added in any order, overlapping or touching.
+  using SparseMapType = itk::FlatLabelMap< long, 2 >;
+  SparseMapType::Pointer sparse = SparseMapType::New();
+  sparse->SetBackgroundValue( -1 );
+  TEST_SET_GET_VALUE( -1, sparse->GetBackgroundValue() );
+  SparseMapType::IndexType idx;
+  idx[0] = 10;
+  idx[1] = 3;
+  sparse->SetLine( idx, 5, 1000000 );
+  idx[0] = 2;
+  sparse->SetLine( idx, 4, 1000000 );
+  idx[0] = 6;
+  sparse->SetLine( idx, 4, 1000000 );
+  idx[1] = -2;
+  sparse->SetLine( idx, 3, -50 );
+  sparse->SetLine( idx, 3, -1 );
+  TEST_EXPECT_TRUE( sparse->HasPendingLines() );
+  TEST_EXPECT_EQUAL( sparse->GetNumberOfLabelObjects(), 0u );
+  sparse->Optimize();
+  TEST_EXPECT_TRUE( !sparse->GetUseDenseLabelTable() );
+  TEST_EXPECT_EQUAL( sparse->GetNumberOfLabelObjects(), 2u );
+  TEST_EXPECT_EQUAL( sparse->GetLabels()[0], -50 );
+  SparseMapType::LabelObjectType object = sparse->GetLabelObject( 1000000 );
+  TEST_EXPECT_EQUAL( object.GetNumberOfLines(), 1u );
+  TEST_EXPECT_EQUAL( object.Size(), 13u );
+  TEST_EXPECT_EQUAL( object.GetLine( 0 ).GetIndex()[0], 2 );
+  TEST_EXPECT_EQUAL( object.GetBoundingBox().GetSize()[0], 13u );
+  TEST_EXPECT_EQUAL( sparse->GetPixel( idx ), -50 );
+  idx[1] = 0;
+  TEST_EXPECT_EQUAL( sparse->GetPixel( idx ), -1 );
+  TEST_EXPECT_TRUE( !sparse->HasLabel( 999999 ) );
+
+  // More lines can be added to an optimized map.
+  idx[0] = 0;
+  sparse->SetLine( idx, 1, 7 );
+  sparse->Optimize();
+  TEST_EXPECT_EQUAL( sparse->GetNumberOfLabelObjects(), 3u );
+  TEST_EXPECT_EQUAL( sparse->GetLabelObject( 1000000 ).Size(), 13u );
+  TEST_EXPECT_EQUAL( sparse->GetNthLabelObject( 1 ).GetLabel(), 7 );
+
+  sparse->Initialize();
+  TEST_EXPECT_EQUAL( sparse->GetNumberOfLabelObjects(), 0u );
+  TEST_EXPECT_TRUE( SparseMapType::ConstIterator( sparse ).IsAtEnd() );
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
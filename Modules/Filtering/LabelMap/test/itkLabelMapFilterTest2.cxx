@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLabelMap.h"
+#include "itkLabelObject.h"
+#include "itkLabelMapFilter.h"
+#include "itkTestingMacros.h"
+
+#include <atomic>
+
+/*
+ * Check that LabelMapFilter processes every label object exactly once, for
+ * many objects of very different sizes and any number of work units, and
+ * that the object being processed can be removed from the map.
+ */
+namespace
+{
+template< typename TImage >
+class LabelMapFilterTest2Filter: public itk::LabelMapFilter< TImage, TImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(LabelMapFilterTest2Filter);
+
+  using Self = LabelMapFilterTest2Filter;
+  using Superclass = itk::LabelMapFilter< TImage, TImage >;
+  using Pointer = itk::SmartPointer< Self >;
+  using LabelObjectType = typename Superclass::LabelObjectType;
+
+  itkNewMacro(Self);
+  itkTypeMacro(LabelMapFilterTest2Filter, LabelMapFilter);
+
+  std::vector< std::atomic< int > > m_Counts;
+
+protected:
+  LabelMapFilterTest2Filter() = default;
+
+  void ThreadedProcessLabelObject( LabelObjectType *labelObject ) override
+  {
+    ++m_Counts[labelObject->GetLabel()];
+    // remove the objects with a label multiple of 5
+    if( labelObject->GetLabel() % 5 == 0 )
+      {
+      std::lock_guard< std::mutex > lock( this->m_LabelObjectContainerLock );
+      const_cast< TImage * >( this->GetInput() )->RemoveLabelObject( labelObject );
+      }
+  }
+};
+}
+
+int itkLabelMapFilterTest2( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using LabelObjectType = itk::LabelObject< unsigned long, Dimension >;
+  using LabelMapType = itk::LabelMap< LabelObjectType >;
+  using FilterType = LabelMapFilterTest2Filter< LabelMapType >;
+
+  constexpr unsigned long NumberOfLabelObjects = 5000;
+
+  for( itk::ThreadIdType numberOfWorkUnits = 1; numberOfWorkUnits <= 9; numberOfWorkUnits += 4 )
+    {
+    LabelMapType::Pointer map = LabelMapType::New();
+    LabelMapType::SizeType size;
+    size[0] = 100;
+    size[1] = 1000;
+    map->SetRegions( size );
+    map->Allocate();
+
+    // a few large objects and many small ones
+    LabelMapType::IndexType idx;
+    for( unsigned long label = 1; label <= NumberOfLabelObjects; ++label )
+      {
+      const unsigned long numberOfLines = label % 1000 == 1 ? 500 : 1 + label % 3;
+      for( unsigned long l = 0; l < numberOfLines; ++l )
+        {
+        idx[0] = l % 100;
+        idx[1] = label % 1000;
+        map->SetLine( idx, 1, label );
+        }
+      }
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( map );
+    filter->SetNumberOfWorkUnits( numberOfWorkUnits );
+    std::vector< std::atomic< int > > counts( NumberOfLabelObjects + 1 );
+    filter->m_Counts.swap( counts );
+    for( auto & count : filter->m_Counts )
+      {
+      count = 0;
+      }
+    TRY_EXPECT_NO_EXCEPTION( filter->Update() );
+
+    for( unsigned long label = 1; label <= NumberOfLabelObjects; ++label )
+      {
+      if( filter->m_Counts[label] != 1 )
+        {
+        std::cerr << "Label " << label << " processed " << filter->m_Counts[label] << " times with "
+                  << numberOfWorkUnits << " work units." << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    TEST_EXPECT_EQUAL( map->GetNumberOfLabelObjects(), NumberOfLabelObjects - NumberOfLabelObjects / 5 );
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -451,3 +451,115 @@ TEST_F(ShapeLabelMapFixture,2D_T2x4)
     labelObject->Print(std::cout);
     }
 }
+
+
+TEST_F(ShapeLabelMapFixture,2D_FeretDiameterConcave)
+{
+  using namespace itk::GTest::TypedefsAndConstructors::Dimension2;
+
+  using Utils = FixtureUtilities<2>;
+
+  Utils::ImageType::Pointer image( Utils::CreateImage() );
+
+  // a U shape, with rows made of several lines
+  for (unsigned int j = 3; j < 20; ++j)
+    {
+    image->SetPixel(MakeIndex(4,j), 1);
+    image->SetPixel(MakeIndex(5,j), 1);
+    image->SetPixel(MakeIndex(15,j), 1);
+    }
+  for (unsigned int i = 4; i < 16; ++i)
+    {
+    image->SetPixel(MakeIndex(i,20), 1);
+    }
+  Utils::ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 2.0;
+  image->SetSpacing(spacing);
+
+  Utils::LabelObjectType::ConstPointer labelObject = Utils::ComputeLabelObject(image);
+
+  // from (4,3) to (15,20) or (15,3) to (4,20)
+  EXPECT_NEAR(std::sqrt(5.5*5.5 + 34.0*34.0), labelObject->GetFeretDiameter(), 1e-10);
+  EXPECT_EQ(63u, labelObject->GetNumberOfPixels());
+
+  if (::testing::Test::HasFailure())
+    {
+    labelObject->Print(std::cout);
+    }
+}
+
+
+TEST_F(ShapeLabelMapFixture,3D_FeretDiameterSlices)
+{
+  using namespace itk::GTest::TypedefsAndConstructors::Dimension3;
+
+  using Utils = FixtureUtilities<3>;
+
+  Utils::ImageType::Pointer image( Utils::CreateImage() );
+
+  // two crosses in distant slices, connected by a line along the axis 2
+  for (unsigned int k = 2; k < 23; k += 20)
+    {
+    for (unsigned int i = 5; i < 16; ++i)
+      {
+      image->SetPixel(MakeIndex(i,10,k), 1);
+      image->SetPixel(MakeIndex(10,i,k), 1);
+      }
+    }
+  for (unsigned int k = 2; k < 23; ++k)
+    {
+    image->SetPixel(MakeIndex(10,10,k), 1);
+    }
+
+  Utils::LabelObjectType::ConstPointer labelObject = Utils::ComputeLabelObject(image);
+
+  // from (5,10,2) to (15,10,22)
+  EXPECT_NEAR(std::sqrt(10.0*10.0 + 20.0*20.0), labelObject->GetFeretDiameter(), 1e-10);
+
+  if (::testing::Test::HasFailure())
+    {
+    labelObject->Print(std::cout);
+    }
+}
+
+
+TEST_F(ShapeLabelMapFixture,2D_ComputePrincipalMomentsOff)
+{
+  using namespace itk::GTest::TypedefsAndConstructors::Dimension2;
+
+  using Utils = FixtureUtilities<2>;
+
+  Utils::ImageType::Pointer image( Utils::CreateImage() );
+
+  for (unsigned int i = 4; i < 6; ++i)
+    {
+    for (unsigned int j = 3; j < 7; ++j)
+      {
+      image->SetPixel(MakeIndex(i,j), 1);
+      }
+    }
+
+  using L2SType = itk::LabelImageToShapeLabelMapFilter<Utils::ImageType>;
+  L2SType::Pointer l2s = L2SType::New();
+  l2s->SetInput( image );
+  EXPECT_TRUE( l2s->GetComputePrincipalMoments() );
+  l2s->ComputePrincipalMomentsOff();
+  l2s->ComputePerimeterOff();
+  l2s->Update();
+
+  const Utils::LabelObjectType * labelObject = l2s->GetOutput()->GetLabelObject(1);
+
+  EXPECT_EQ(8u, labelObject->GetNumberOfPixels());
+  EXPECT_VECTOR_NEAR(MakePoint(4.5, 4.5), labelObject->GetCentroid(), 1e-10);
+  EXPECT_EQ(MakeVector(0.0,0.0), labelObject->GetPrincipalMoments());
+  EXPECT_EQ(0.0, labelObject->GetElongation());
+  EXPECT_EQ(0.0, labelObject->GetPerimeter());
+
+  // the oriented bounding box requires the principal axes
+  l2s->ComputeOrientedBoundingBoxOn();
+  l2s->Update();
+  labelObject = l2s->GetOutput()->GetLabelObject(1);
+  EXPECT_VECTOR_NEAR(MakeVector(2.0,4.0), labelObject->GetOrientedBoundingBoxSize(),1e-10);
+  EXPECT_NEAR(std::sqrt(5.0), labelObject->GetElongation(), 1e-10);
+}
@@ -129,6 +129,7 @@ public:
   {
     m_Decomposable = false;
     m_RadiusIsParametric = false;
+    m_DecompositionError = 0.0;
   }
 
   /** Various constructors */
@@ -184,6 +185,40 @@ public:
 
   bool CheckParallel(LType NewVec) const;
 
+  /**
+   * Decompose the structuring element in lines, so that the anchor and
+   * van Herk/Gil-Werman algorithms can be used with it, and return whether
+   * the decomposition has been found.
+   *
+   * The structuring element must be symmetric and contain its center. It
+   * is decomposed as the dilation of lines along the axes and the
+   * diagonals: this is exact for boxes, octagons and the other symmetric
+   * convex polytopes whose edges are along these directions, and
+   * approximate for balls or ellipsoids. maximumError is the maximal
+   * fraction of the pixels of the structuring element which may be lost
+   * by the decomposition; when a decomposition is found, the buffer is
+   * replaced by the shape actually used by the decomposition, which is
+   * included in the original one. Otherwise the structuring element is
+   * not modified.
+   *
+   * For example, a 3D ball of radius 15 is decomposed in 13 lines with an
+   * error of 10%:
+   *
+   * \code
+   * StructuringElementType ball = StructuringElementType::Ball( radius );
+   * ball.Decompose( 0.1 );
+   * dilateFilter->SetKernel( ball ); // uses the anchor algorithm
+   * \endcode
+   */
+  bool Decompose(double maximumError = 0.0);
+
+  /** The fraction of the pixels of the structuring element lost by
+   * Decompose(). */
+  double GetDecompositionError() const
+  {
+    return m_DecompositionError;
+  }
+
   /**
    * Fill the buffer of the structuring element based on the lines
    * associated to the structuring element
@@ -236,6 +271,8 @@ private:
 
   bool m_RadiusIsParametric;
 
+  double m_DecompositionError;
+
   /** Check for correct odd size image.
    *  Return image size. Called in constructor FromImage.*/
   static RadiusType CheckImageSize(const ImageType * image);
@@ -917,6 +917,191 @@ FlatStructuringElement< VDimension >::CheckParallel(LType NewVec) const
   return ( false );
 }
 
+template< unsigned int VDimension >
+bool
+FlatStructuringElement< VDimension >
+::Decompose(double maximumError)
+{
+  if ( m_Decomposable )
+    {
+    return true;
+    }
+
+  // the structuring element must be symmetric and contain its center
+  const unsigned int numberOfElements = this->Size();
+  SizeValueType area = 0;
+  for ( unsigned int i = 0; i < numberOfElements; i++ )
+    {
+    if ( ( *this )[i] != ( *this )[numberOfElements - 1 - i] )
+      {
+      return false;
+      }
+    area += ( *this )[i];
+    }
+  if ( !( *this )[numberOfElements / 2] )
+    {
+    return false;
+    }
+
+  // copy the structuring element in a box padded by one pixel, so that
+  // the neighbors of all its pixels along the lines are in the box, and
+  // the pixels of the padding are never in the dilation
+  OffsetValueType strides[VDimension];
+  OffsetValueType numberOfPixels = 1;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    strides[d] = numberOfPixels;
+    numberOfPixels *= 2 * this->GetRadius(d) + 3;
+    }
+  std::vector< unsigned char > shape( numberOfPixels, 0 );
+  OffsetValueType center = 0;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    center += ( this->GetRadius(d) + 1 ) * strides[d];
+    }
+  for ( unsigned int i = 0; i < numberOfElements; i++ )
+    {
+    const OffsetType offset = this->GetOffset(i);
+    OffsetValueType position = center;
+    for ( unsigned int d = 0; d < VDimension; d++ )
+      {
+      position += offset[d] * strides[d];
+      }
+    shape[position] = ( *this )[i];
+    }
+
+  // the directions of the lines: the axes and the diagonals, with their
+  // first non zero component positive, and their number of non zero
+  // components
+  std::vector< OffsetType > directions;
+  std::vector< OffsetValueType > directionOffsets;
+  std::vector< unsigned int > directionClasses;
+  SizeValueType numberOfDirections = 1;
+  for ( unsigned int d = 0; d < VDimension; d++ )
+    {
+    numberOfDirections *= 3;
+    }
+  for ( unsigned int directionClass = 1; directionClass <= VDimension; directionClass++ )
+    {
+    OffsetType direction;
+    direction.Fill(-1);
+    for ( SizeValueType i = 0; i < numberOfDirections; i++ )
+      {
+      unsigned int first = VDimension;
+      unsigned int numberOfNonZeros = 0;
+      OffsetValueType directionOffset = 0;
+      for ( unsigned int d = 0; d < VDimension; d++ )
+        {
+        if ( direction[d] != 0 )
+          {
+          first = std::min( first, d );
+          numberOfNonZeros++;
+          }
+        directionOffset += direction[d] * strides[d];
+        }
+      if ( numberOfNonZeros == directionClass && direction[first] > 0 )
+        {
+        directions.push_back(direction);
+        directionOffsets.push_back( std::abs(directionOffset) );
+        directionClasses.push_back(directionClass);
+        }
+      for ( unsigned int d = 0; d < VDimension && ++direction[d] > 1; d++ )
+        {
+        direction[d] = -1;
+        }
+      }
+    }
+
+  // Grow the dilation of the center by the lines: in turn, extend each
+  // line by one pixel on both sides while the dilation stays included in
+  // the structuring element. This is done with the lines along the axes
+  // and each combination of the classes of diagonals, and the largest
+  // dilation is kept: the axes alone are exact for the boxes, all the
+  // directions give the best approximations of the balls.
+  std::vector< unsigned char > dilated( numberOfPixels );
+  std::vector< unsigned char > candidate( numberOfPixels );
+  std::vector< SizeValueType > lengths( directions.size() );
+  std::vector< SizeValueType > bestLengths( directions.size(), 0 );
+  SizeValueType bestArea = 1;
+  for ( unsigned int classes = 0; classes < ( 1u << ( VDimension - 1 ) ); classes++ )
+    {
+    std::fill( dilated.begin(), dilated.end(), 0 );
+    dilated[center] = 1;
+    SizeValueType dilatedArea = 1;
+    std::fill( lengths.begin(), lengths.end(), 0 );
+    bool extended = true;
+    while ( extended )
+      {
+      extended = false;
+      for ( unsigned int l = 0; l < directions.size(); l++ )
+        {
+        if ( directionClasses[l] > 1 && !( classes & ( 1u << ( directionClasses[l] - 2 ) ) ) )
+          {
+          continue;
+          }
+        const OffsetValueType step = directionOffsets[l];
+        SizeValueType candidateArea = 0;
+        bool included = true;
+        for ( OffsetValueType p = 0; p < numberOfPixels && included; p++ )
+          {
+          candidate[p] = dilated[p] || ( p >= step && dilated[p - step] )
+                         || ( p + step < numberOfPixels && dilated[p + step] );
+          candidateArea += candidate[p];
+          included = !candidate[p] || shape[p];
+          }
+        if ( included )
+          {
+          dilated.swap(candidate);
+          dilatedArea = candidateArea;
+          lengths[l]++;
+          extended = true;
+          }
+        }
+      }
+    if ( dilatedArea > bestArea )
+      {
+      bestArea = dilatedArea;
+      bestLengths = lengths;
+      }
+    }
+  if ( area - bestArea > maximumError * area )
+    {
+    return false;
+    }
+
+  // build the lines, and the buffer from the lines
+  Self decomposition = *this;
+  decomposition.m_Lines.clear();
+  for ( unsigned int l = 0; l < directions.size(); l++ )
+    {
+    if ( bestLengths[l] > 0 )
+      {
+      LType line;
+      for ( unsigned int d = 0; d < VDimension; d++ )
+        {
+        line[d] = static_cast< float >( directions[l][d] * static_cast< OffsetValueType >( 2 * bestLengths[l] + 1 ) );
+        }
+      decomposition.AddLine(line);
+      }
+    }
+  decomposition.SetDecomposable(true);
+  decomposition.ComputeBufferFromLines();
+
+  // check the shape of the lines
+  SizeValueType difference = 0;
+  for ( unsigned int i = 0; i < numberOfElements; i++ )
+    {
+    difference += ( *this )[i] != decomposition[i];
+    }
+  if ( difference > maximumError * area )
+    {
+    return false;
+    }
+  decomposition.m_DecompositionError = static_cast< double >( difference ) / area;
+  *this = decomposition;
+  return true;
+}
+
 template< unsigned int VDimension >
 void FlatStructuringElement< VDimension >
 ::PrintSelf(std::ostream & os, Indent indent) const
@@ -929,6 +1114,7 @@ void FlatStructuringElement< VDimension >
       {
       os << indent << m_Lines[i] << std::endl;
       }
+    os << indent << "DecompositionError: " << m_DecompositionError << std::endl;
     }
 }
 
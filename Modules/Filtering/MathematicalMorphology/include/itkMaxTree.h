@@ -0,0 +1,286 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMaxTree_h
+#define itkMaxTree_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImage.h"
+#include "itkMultiThreaderBase.h"
+#include <functional>
+#include <vector>
+
+namespace itk
+{
+/** \class MaxTree
+ * \brief Component tree of a grayscale image.
+ *
+ * The max-tree represents the connected components of all the upper level
+ * sets of an image, \f$\{x, f(x) \geq t\}\f$ for all the values \f$t\f$,
+ * ordered by inclusion. Each node of the tree is a component; its level is
+ * the value of the pixels of the component which are not in a child
+ * component. With TCompare set to std::less, the tree represents the lower
+ * level sets: it is a min-tree.
+ *
+ * The tree is stored on the pixels, as in the union-find algorithm of
+ * Berger et al. Each node is represented by one of its pixels, its
+ * canonical pixel. The parent of a canonical pixel is the canonical pixel
+ * of the parent node, the parent of another pixel is the canonical pixel
+ * of its node, and the canonical pixel of the root is its own parent. The
+ * pixels are designated by their offset in the buffer of the image.
+ *
+ * Compute() builds the tree in parallel: the image is split in slabs
+ * along its last dimension, the pixels of each slab are sorted and a tree
+ * is built for each slab, then the trees of neighbor slabs are merged
+ * along their common boundary, as described in
+ * "Concurrent Computation of Attribute Filters on Shared Memory Parallel
+ * Machines", Wilkinson M.H.F., Gao H., Hesselink W.H., Jonker J.E.,
+ * Meijster A., IEEE Transactions on Pattern Analysis and Machine
+ * Intelligence, 30(10), 2008.
+ *
+ * The area (number of pixels), volume (sum of the values of the pixels
+ * above the level of the parent node) and height (difference between the
+ * extremal value in the component and the level of the parent node) of
+ * the nodes are computed with the tree. Once built, the tree can be
+ * filtered for as many attributes and thresholds as needed with
+ * AttributeFilter(), without building it again:
+ *
+ * \code
+ * using MaxTreeType = itk::MaxTree< ImageType >;
+ * MaxTreeType::Pointer maxTree = MaxTreeType::New();
+ * maxTree->SetImage( image );
+ * maxTree->Compute();
+ * for ( double area : { 10.0, 100.0, 1000.0 } )
+ *   {
+ *   maxTree->AttributeFilter( MaxTreeType::AREA, area, output );
+ *   ...
+ *   }
+ * \endcode
+ *
+ * The tree uses about 40 bytes per pixel.
+ *
+ * \sa MaxTreeAttributeOpeningImageFilter
+ * \ingroup MathematicalMorphologyImageFilters
+ * \ingroup ITKMathematicalMorphology
+ */
+template< typename TImage, typename TCompare = std::greater< typename TImage::PixelType > >
+class ITK_TEMPLATE_EXPORT MaxTree:public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(MaxTree);
+
+  /** Standard class type aliases. */
+  using Self = MaxTree;
+  using Superclass = Object;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MaxTree, Object);
+
+  /** Some convenient type alias. */
+  using ImageType = TImage;
+  using ImageConstPointer = typename ImageType::ConstPointer;
+  using PixelType = typename ImageType::PixelType;
+  using IndexType = typename ImageType::IndexType;
+  using SizeType = typename ImageType::SizeType;
+  using OffsetType = typename ImageType::OffsetType;
+  using RegionType = typename ImageType::RegionType;
+
+  static constexpr unsigned int ImageDimension = ImageType::ImageDimension;
+
+  /** The pixels, as offsets in the buffer of the image. */
+  using PixelOffsetContainerType = std::vector< OffsetValueType >;
+
+  /** The attributes of the nodes. */
+  using AttributeType = unsigned int;
+  static constexpr AttributeType AREA = 0;
+  static constexpr AttributeType VOLUME = 1;
+  static constexpr AttributeType HEIGHT = 2;
+
+  using AttributeValuesType = std::vector< double >;
+
+  /** Set/Get the image. Its whole buffered region is used. */
+  itkSetConstObjectMacro(Image, ImageType);
+  itkGetConstObjectMacro(Image, ImageType);
+
+  /**
+   * Set/Get whether the connected components are defined strictly by
+   * face connectivity or by face+edge+vertex connectivity.  Default is
+   * FullyConnectedOff.  For objects that are 1 pixel wide, use
+   * FullyConnectedOn.
+   */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstReferenceMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** Set/Get the number of work units used to build the tree. Defaults
+   * to the global default number of work units. */
+  itkSetClampMacro(NumberOfWorkUnits, ThreadIdType, 1, ITK_MAX_THREADS);
+  itkGetConstMacro(NumberOfWorkUnits, ThreadIdType);
+
+  /** Build the tree and compute the attributes of its nodes. */
+  void Compute();
+
+  /** Release the memory used by the tree. */
+  void Clear();
+
+  /** The pixels sorted by level, from the level of the root to the level
+   * of the leaves: a parent node is always before its children. The
+   * pixels of a same level are in no particular order. */
+  const PixelOffsetContainerType & GetSortedPixels() const
+  {
+    return m_SortedPixels;
+  }
+
+  /** The parent of each pixel, as described in the class documentation. */
+  const PixelOffsetContainerType & GetParents() const
+  {
+    return m_Parents;
+  }
+
+  /** The canonical pixel of the root node. */
+  itkGetConstMacro(Root, OffsetValueType);
+
+  /** The parent of the pixel at the given offset. */
+  OffsetValueType GetParent(OffsetValueType offset) const
+  {
+    return m_Parents[offset];
+  }
+
+  /** Whether the pixel is the canonical pixel of a node. */
+  bool IsCanonical(OffsetValueType offset) const
+  {
+    const OffsetValueType parent = m_Parents[offset];
+    return parent == offset || !this->SameLevel(parent, offset);
+  }
+
+  /** The canonical pixel of the node of the pixel. */
+  OffsetValueType GetNode(OffsetValueType offset) const
+  {
+    return this->IsCanonical(offset) ? offset : m_Parents[offset];
+  }
+
+  /** The number of nodes in the tree. */
+  itkGetConstMacro(NumberOfNodes, SizeValueType);
+
+  /** The value of the attribute for all the pixels. Only the values of the
+   * canonical pixels are meaningful. */
+  const AttributeValuesType & GetAttributeValues(AttributeType attribute) const;
+
+  /** The value of the attribute of the node whose canonical pixel is at
+   * the given offset. */
+  double GetAttributeValue(AttributeType attribute, OffsetValueType offset) const
+  {
+    return this->GetAttributeValues(attribute)[offset];
+  }
+
+  /** Remove the nodes whose attribute is lower than the threshold, and
+   * write the filtered image in output, which must have the same buffered
+   * size as the image. For the area attribute on a max-tree, this is an
+   * area opening. The root is always kept. */
+  template< typename TOutputImage >
+  void AttributeFilter(AttributeType attribute, double threshold, TOutputImage *output) const;
+
+  /** Convert a pixel offset to an index, and back. */
+  IndexType ComputeIndex(OffsetValueType offset) const
+  {
+    return m_Image->ComputeIndex(offset);
+  }
+
+  OffsetValueType ComputeOffset(const IndexType & index) const
+  {
+    return m_Image->ComputeOffset(index);
+  }
+
+protected:
+  MaxTree();
+  ~MaxTree() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** A slab of the image along its last dimension. */
+  struct Slab
+  {
+    OffsetValueType m_Begin;
+    OffsetValueType m_End;
+  };
+
+  /** Whether the pixel a is before the pixel b in the sorted pixels. */
+  bool Precedes(OffsetValueType a, OffsetValueType b) const
+  {
+    return m_Compare(m_Buffer[b], m_Buffer[a]);
+  }
+
+  /** Whether the pixels a and b have the same level, i.e. neither precedes
+   * the other. Equivalent to operator== for the integral types, and
+   * consistent with the sorting of the pixels for the other types. */
+  bool SameLevel(OffsetValueType a, OffsetValueType b) const
+  {
+    return !m_Compare(m_Buffer[a], m_Buffer[b]) && !m_Compare(m_Buffer[b], m_Buffer[a]);
+  }
+
+  /** The first pixel of the branch of x with the same level as x,
+   * compressing the path. Stops at the roots of the trees. */
+  OffsetValueType LevelRoot(OffsetValueType x);
+
+  /** Sort the pixels of a slab. */
+  void SortSlab(const Slab & slab);
+
+  /** Build the tree of a slab with the union-find algorithm. */
+  void BuildSlabTree(const Slab & slab, PixelOffsetContainerType & zpar);
+
+  /** Merge the trees on both sides of the first slice of a slab. */
+  void MergeSlabTrees(const Slab & slab);
+
+  /** Merge the branches of the neighbor pixels x and y. */
+  void MergeBranches(OffsetValueType x, OffsetValueType y);
+
+  /** Whether the n-th neighbor of the pixel at position is in the region
+   * of the image from slice begin to slice end. */
+  bool IsNeighborInside(const OffsetType & position, unsigned int n, OffsetValueType begin, OffsetValueType end) const;
+
+  ImageConstPointer m_Image;
+  bool              m_FullyConnected{ false };
+  ThreadIdType      m_NumberOfWorkUnits;
+  TCompare          m_Compare;
+
+  const PixelType *                m_Buffer{ nullptr };
+  SizeType                         m_Size;
+  SizeValueType                    m_SliceSize{ 0 };
+  std::vector< OffsetType >        m_NeighborOffsets;
+  std::vector< OffsetValueType >   m_NeighborBufferOffsets;
+
+  PixelOffsetContainerType         m_SortedPixels;
+  PixelOffsetContainerType         m_Parents;
+  OffsetValueType                  m_Root{ -1 };
+  SizeValueType                    m_NumberOfNodes{ 0 };
+  AttributeValuesType              m_Area;
+  AttributeValuesType              m_Volume;
+  AttributeValuesType              m_Height;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMaxTree.hxx"
+#endif
+
+#endif
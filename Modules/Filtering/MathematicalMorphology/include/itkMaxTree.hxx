@@ -0,0 +1,515 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMaxTree_hxx
+#define itkMaxTree_hxx
+
+#include "itkMaxTree.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+template< typename TImage, typename TCompare >
+MaxTree< TImage, TCompare >
+::MaxTree()
+{
+  m_NumberOfWorkUnits = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  m_Size.Fill(0);
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::Compute()
+{
+  if ( m_Image.IsNull() )
+    {
+    itkExceptionMacro(<< "Image not set.");
+    }
+
+  this->Clear();
+
+  m_Buffer = m_Image->GetBufferPointer();
+  m_Size = m_Image->GetBufferedRegion().GetSize();
+  const SizeValueType numberOfPixels = m_Image->GetBufferedRegion().GetNumberOfPixels();
+  if ( numberOfPixels == 0 )
+    {
+    return;
+    }
+
+  constexpr unsigned int lastDimension = ImageDimension - 1;
+  m_SliceSize = numberOfPixels / m_Size[lastDimension];
+
+  // the neighbors and their offsets in the buffer
+  unsigned int neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+    neighborhoodSize *= 3;
+    }
+  for ( unsigned int i = 0; i < neighborhoodSize; ++i )
+    {
+    OffsetType offset;
+    OffsetValueType bufferOffset = 0;
+    OffsetValueType stride = 1;
+    unsigned int numberOfNonZeros = 0;
+    for ( unsigned int d = 0, j = i; d < ImageDimension; ++d, j /= 3 )
+      {
+      offset[d] = static_cast< OffsetValueType >( j % 3 ) - 1;
+      bufferOffset += offset[d] * stride;
+      stride *= static_cast< OffsetValueType >( m_Size[d] );
+      numberOfNonZeros += offset[d] != 0;
+      }
+    if ( numberOfNonZeros == 0 || ( !m_FullyConnected && numberOfNonZeros > 1 ) )
+      {
+      continue;
+      }
+    m_NeighborOffsets.push_back(offset);
+    m_NeighborBufferOffsets.push_back(bufferOffset);
+    }
+
+  // one slab per work unit, along the last dimension
+  SizeValueType numberOfSlabs = 1;
+  if ( ImageDimension > 1 )
+    {
+    numberOfSlabs = std::min( static_cast< SizeValueType >( m_NumberOfWorkUnits ), m_Size[lastDimension] );
+    }
+  std::vector< Slab > slabs( numberOfSlabs );
+  for ( SizeValueType i = 0; i < numberOfSlabs; ++i )
+    {
+    slabs[i].m_Begin = static_cast< OffsetValueType >( i * m_Size[lastDimension] / numberOfSlabs * m_SliceSize );
+    slabs[i].m_End = static_cast< OffsetValueType >( ( i + 1 ) * m_Size[lastDimension] / numberOfSlabs * m_SliceSize );
+    }
+
+  m_SortedPixels.resize( numberOfPixels );
+  m_Parents.resize( numberOfPixels );
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits( m_NumberOfWorkUnits );
+
+  // sort the pixels and build a tree in each slab
+  {
+  PixelOffsetContainerType zpar( numberOfPixels );
+  multiThreader->ParallelizeArray(
+    0, numberOfSlabs,
+    [this, &slabs, &zpar]( SizeValueType i )
+    {
+      this->SortSlab( slabs[i] );
+      this->BuildSlabTree( slabs[i], zpar );
+    },
+    nullptr );
+  }
+
+  // merge the trees and the sorted pixels of the neighbor groups of slabs:
+  // the pairs of slabs, then the pairs of pairs, ...
+  for ( SizeValueType step = 1; step < numberOfSlabs; step *= 2 )
+    {
+    const SizeValueType numberOfPairs = ( numberOfSlabs + step - 1 ) / ( 2 * step );
+    multiThreader->ParallelizeArray(
+      0, numberOfPairs,
+      [this, &slabs, step, numberOfSlabs]( SizeValueType pair )
+      {
+        const SizeValueType first = pair * 2 * step;
+        const SizeValueType middle = first + step;
+        const SizeValueType last = std::min( middle + step, numberOfSlabs ) - 1;
+        this->MergeSlabTrees( slabs[middle] );
+        std::inplace_merge( m_SortedPixels.begin() + slabs[first].m_Begin,
+                            m_SortedPixels.begin() + slabs[middle].m_Begin,
+                            m_SortedPixels.begin() + slabs[last].m_End,
+                            [this]( OffsetValueType a, OffsetValueType b ) { return this->Precedes( a, b ); } );
+      },
+      nullptr );
+    }
+
+  // the root of the merged tree is the only pixel without parent
+  for ( const auto p : m_SortedPixels )
+    {
+    if ( m_Parents[p] < 0 )
+      {
+      m_Root = p;
+      m_Parents[p] = p;
+      break;
+      }
+    }
+
+  // make the parents canonical: the parent of a pixel is the level root of
+  // its level, the parent of a level root is the level root of the lower
+  // level
+  for ( OffsetValueType p = 0; p < static_cast< OffsetValueType >( numberOfPixels ); ++p )
+    {
+    const OffsetValueType q = m_Parents[p];
+    if ( q == p )
+      {
+      continue;
+      }
+    if ( this->SameLevel(q, p) )
+      {
+      m_Parents[p] = this->LevelRoot(p);
+      }
+    else
+      {
+      m_Parents[p] = this->LevelRoot(q);
+      }
+    }
+
+  // attributes: first the pixels of each node, then the child nodes, from
+  // the leaves to the root
+  m_Area.assign( numberOfPixels, 1.0 );
+  m_Volume.resize( numberOfPixels );
+  m_Height.resize( numberOfPixels );
+  for ( OffsetValueType p = 0; p < static_cast< OffsetValueType >( numberOfPixels ); ++p )
+    {
+    m_Volume[p] = static_cast< double >( m_Buffer[p] );
+    m_Height[p] = static_cast< double >( m_Buffer[p] );
+    }
+  for ( OffsetValueType p = 0; p < static_cast< OffsetValueType >( numberOfPixels ); ++p )
+    {
+    if ( !this->IsCanonical(p) )
+      {
+      const OffsetValueType node = m_Parents[p];
+      m_Area[node] += 1.0;
+      m_Volume[node] += m_Volume[p];
+      }
+    }
+  for ( auto it = m_SortedPixels.rbegin(); it != m_SortedPixels.rend(); ++it )
+    {
+    const OffsetValueType p = *it;
+    const OffsetValueType parent = m_Parents[p];
+    if ( parent != p && !this->SameLevel(parent, p) )
+      {
+      m_Area[parent] += m_Area[p];
+      m_Volume[parent] += m_Volume[p];
+      if ( std::abs( m_Height[p] - static_cast< double >( m_Buffer[parent] ) )
+           > std::abs( m_Height[parent] - static_cast< double >( m_Buffer[parent] ) ) )
+        {
+        m_Height[parent] = m_Height[p];
+        }
+      }
+    }
+  // volume and height relatively to the level of the parent
+  m_NumberOfNodes = 0;
+  for ( OffsetValueType p = 0; p < static_cast< OffsetValueType >( numberOfPixels ); ++p )
+    {
+    if ( this->IsCanonical(p) )
+      {
+      const auto parentLevel = static_cast< double >( m_Buffer[m_Parents[p]] );
+      m_Volume[p] = std::abs( m_Volume[p] - m_Area[p] * parentLevel );
+      m_Height[p] = std::abs( m_Height[p] - parentLevel );
+      ++m_NumberOfNodes;
+      }
+    }
+
+  m_NeighborOffsets.clear();
+  m_NeighborBufferOffsets.clear();
+  this->Modified();
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::Clear()
+{
+  PixelOffsetContainerType().swap( m_SortedPixels );
+  PixelOffsetContainerType().swap( m_Parents );
+  AttributeValuesType().swap( m_Area );
+  AttributeValuesType().swap( m_Volume );
+  AttributeValuesType().swap( m_Height );
+  m_NeighborOffsets.clear();
+  m_NeighborBufferOffsets.clear();
+  m_Root = -1;
+  m_NumberOfNodes = 0;
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::SortSlab(const Slab & slab)
+{
+  auto begin = m_SortedPixels.begin() + slab.m_Begin;
+  auto end = m_SortedPixels.begin() + slab.m_End;
+
+  if ( NumericTraits< PixelType >::is_integer && sizeof( PixelType ) <= 2 )
+    {
+    // counting sort
+    PixelType minimum = m_Buffer[slab.m_Begin];
+    PixelType maximum = minimum;
+    for ( OffsetValueType p = slab.m_Begin; p < slab.m_End; ++p )
+      {
+      minimum = std::min( minimum, m_Buffer[p] );
+      maximum = std::max( maximum, m_Buffer[p] );
+      }
+    const auto numberOfLevels = static_cast< SizeValueType >( maximum - minimum ) + 1;
+    std::vector< SizeValueType > positions( numberOfLevels, 0 );
+    for ( OffsetValueType p = slab.m_Begin; p < slab.m_End; ++p )
+      {
+      ++positions[static_cast< SizeValueType >( m_Buffer[p] - minimum )];
+      }
+    // the levels are in increasing order for a max-tree, decreasing for a
+    // min-tree
+    const bool increasing = m_Compare( PixelType( 1 ), PixelType( 0 ) );
+    SizeValueType position = 0;
+    for ( SizeValueType i = 0; i < numberOfLevels; ++i )
+      {
+      const SizeValueType level = increasing ? i : numberOfLevels - 1 - i;
+      const SizeValueType count = positions[level];
+      positions[level] = position;
+      position += count;
+      }
+    for ( OffsetValueType p = slab.m_Begin; p < slab.m_End; ++p )
+      {
+      begin[positions[static_cast< SizeValueType >( m_Buffer[p] - minimum )]++] = p;
+      }
+    }
+  else
+    {
+    OffsetValueType p = slab.m_Begin;
+    for ( auto it = begin; it != end; ++it, ++p )
+      {
+      *it = p;
+      }
+    std::stable_sort( begin, end, [this]( OffsetValueType a, OffsetValueType b ) { return this->Precedes( a, b ); } );
+    }
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::BuildSlabTree(const Slab & slab, PixelOffsetContainerType & zpar)
+{
+  const auto sliceSize = static_cast< OffsetValueType >( m_SliceSize );
+  const OffsetValueType beginSlice = slab.m_Begin / sliceSize;
+  const OffsetValueType endSlice = slab.m_End / sliceSize;
+  const auto numberOfNeighbors = static_cast< unsigned int >( m_NeighborBufferOffsets.size() );
+
+  for ( OffsetValueType p = slab.m_Begin; p < slab.m_End; ++p )
+    {
+    zpar[p] = -1;
+    }
+
+  // union-find from the leaves to the root
+  for ( OffsetValueType i = slab.m_End - 1; i >= slab.m_Begin; --i )
+    {
+    const OffsetValueType p = m_SortedPixels[i];
+    m_Parents[p] = p;
+    zpar[p] = p;
+    const OffsetType position = m_Image->ComputeIndex(p) - m_Image->GetBufferedRegion().GetIndex();
+    for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
+      {
+      if ( !this->IsNeighborInside(position, n, beginSlice, endSlice) )
+        {
+        continue;
+        }
+      const OffsetValueType q = p + m_NeighborBufferOffsets[n];
+      if ( zpar[q] < 0 )
+        {
+        // not processed yet
+        continue;
+        }
+      // find the root, with path halving
+      OffsetValueType r = q;
+      while ( zpar[r] != r )
+        {
+        zpar[r] = zpar[zpar[r]];
+        r = zpar[r];
+        }
+      if ( r != p )
+        {
+        m_Parents[r] = p;
+        zpar[r] = p;
+        }
+      }
+    }
+
+  // the root of the slab has no parent until the slabs are merged
+  m_Parents[m_SortedPixels[slab.m_Begin]] = -1;
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::MergeSlabTrees(const Slab & slab)
+{
+  constexpr unsigned int lastDimension = ImageDimension - 1;
+  const auto sliceSize = static_cast< OffsetValueType >( m_SliceSize );
+  const OffsetValueType slice = slab.m_Begin / sliceSize;
+  const auto numberOfNeighbors = static_cast< unsigned int >( m_NeighborBufferOffsets.size() );
+
+  // merge each pixel of the first slice of the slab with its neighbors in
+  // the previous slice
+  for ( OffsetValueType p = slab.m_Begin; p < slab.m_Begin + sliceSize; ++p )
+    {
+    const OffsetType position = m_Image->ComputeIndex(p) - m_Image->GetBufferedRegion().GetIndex();
+    for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
+      {
+      if ( m_NeighborOffsets[n][lastDimension] == -1 && this->IsNeighborInside(position, n, slice - 1, slice + 1) )
+        {
+        this->MergeBranches( p, p + m_NeighborBufferOffsets[n] );
+        }
+      }
+    }
+}
+
+template< typename TImage, typename TCompare >
+OffsetValueType
+MaxTree< TImage, TCompare >
+::LevelRoot(OffsetValueType x)
+{
+  if ( x < 0 )
+    {
+    return x;
+    }
+  OffsetValueType r = x;
+  while ( m_Parents[r] >= 0 && m_Parents[r] != r && this->SameLevel(m_Parents[r], r) )
+    {
+    r = m_Parents[r];
+    }
+  // compress the path
+  while ( x != r )
+    {
+    const OffsetValueType next = m_Parents[x];
+    m_Parents[x] = r;
+    x = next;
+    }
+  return r;
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::MergeBranches(OffsetValueType x, OffsetValueType y)
+{
+  x = this->LevelRoot(x);
+  y = this->LevelRoot(y);
+  if ( this->Precedes(x, y) )
+    {
+    std::swap( x, y );
+    }
+  // x is at a level higher or equal to the one of y. Go down the branch of
+  // x until the level of y, and insert y there; continue with the rest of
+  // the branch of x below y.
+  while ( x != y && y >= 0 )
+    {
+    const OffsetValueType z = this->LevelRoot( m_Parents[x] );
+    if ( z >= 0 && !this->Precedes(z, y) )
+      {
+      x = z;
+      }
+    else
+      {
+      m_Parents[x] = y;
+      x = y;
+      y = z;
+      }
+    }
+}
+
+template< typename TImage, typename TCompare >
+bool
+MaxTree< TImage, TCompare >
+::IsNeighborInside(const OffsetType & position, unsigned int n, OffsetValueType begin, OffsetValueType end) const
+{
+  constexpr unsigned int lastDimension = ImageDimension - 1;
+  for ( unsigned int d = 0; d < lastDimension; ++d )
+    {
+    const OffsetValueType p = position[d] + m_NeighborOffsets[n][d];
+    if ( p < 0 || p >= static_cast< OffsetValueType >( m_Size[d] ) )
+      {
+      return false;
+      }
+    }
+  const OffsetValueType p = position[lastDimension] + m_NeighborOffsets[n][lastDimension];
+  return p >= begin && p < end;
+}
+
+template< typename TImage, typename TCompare >
+const typename MaxTree< TImage, TCompare >::AttributeValuesType &
+MaxTree< TImage, TCompare >
+::GetAttributeValues(AttributeType attribute) const
+{
+  switch ( attribute )
+    {
+    case AREA:
+      return m_Area;
+    case VOLUME:
+      return m_Volume;
+    case HEIGHT:
+      return m_Height;
+    default:
+      itkExceptionMacro(<< "Unknown attribute: " << attribute);
+    }
+}
+
+template< typename TImage, typename TCompare >
+template< typename TOutputImage >
+void
+MaxTree< TImage, TCompare >
+::AttributeFilter(AttributeType attribute, double threshold, TOutputImage *output) const
+{
+  using OutputPixelType = typename TOutputImage::PixelType;
+
+  if ( output == nullptr || output->GetBufferedRegion().GetSize() != m_Size )
+    {
+    itkExceptionMacro(<< "The output must have the same size as the image.");
+    }
+  if ( m_Parents.empty() )
+    {
+    return;
+    }
+  const AttributeValuesType & values = this->GetAttributeValues(attribute);
+  OutputPixelType * outputBuffer = output->GetBufferPointer();
+
+  // the nodes from the root to the leaves: a removed node takes the value
+  // of its parent
+  for ( const auto p : m_SortedPixels )
+    {
+    const OffsetValueType parent = m_Parents[p];
+    if ( parent == p )
+      {
+      outputBuffer[p] = static_cast< OutputPixelType >( m_Buffer[p] );
+      }
+    else if ( !this->SameLevel(parent, p) )
+      {
+      outputBuffer[p] = values[p] >= threshold ? static_cast< OutputPixelType >( m_Buffer[p] ) : outputBuffer[parent];
+      }
+    }
+  // then the other pixels of the nodes
+  for ( const auto p : m_SortedPixels )
+    {
+    if ( !this->IsCanonical(p) )
+      {
+      outputBuffer[p] = outputBuffer[m_Parents[p]];
+      }
+    }
+}
+
+template< typename TImage, typename TCompare >
+void
+MaxTree< TImage, TCompare >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  itkPrintSelfObjectMacro( Image );
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  os << indent << "NumberOfWorkUnits: " << m_NumberOfWorkUnits << std::endl;
+  os << indent << "Root: " << m_Root << std::endl;
+  os << indent << "NumberOfNodes: " << m_NumberOfNodes << std::endl;
+}
+} // end namespace itk
+
+#endif
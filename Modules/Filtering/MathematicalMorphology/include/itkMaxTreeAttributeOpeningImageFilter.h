@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMaxTreeAttributeOpeningImageFilter_h
+#define itkMaxTreeAttributeOpeningImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkMaxTree.h"
+
+namespace itk
+{
+/** \class MaxTreeAttributeOpeningImageFilter
+ * \brief Remove the components of the level sets of a grayscale image with a small attribute.
+ *
+ * This filter removes the nodes of the max-tree of the input image whose
+ * attribute is lower than Lambda: the area (number of pixels), the volume
+ * (sum of the values above the level of the parent node) or the height
+ * (contrast with the level of the parent node). The pixels of a removed
+ * node take the level of their first kept ancestor. With the area
+ * attribute, this is an area opening; with the height attribute, the
+ * components with a contrast lower than Lambda are flattened. With
+ * TCompare set to std::less, the min-tree is filtered: area closing, etc.
+ *
+ * Contrary to BinaryShapeOpeningImageFilter or ShapeOpeningLabelMapFilter,
+ * the input is a grayscale image and no LabelMap is built.
+ *
+ * The max-tree is built in parallel, see MaxTree, and is kept by the
+ * filter: when only Attribute or Lambda have changed since the last
+ * update, the tree is reused and only the filtering is done. Call
+ * ReleaseMaxTree() to free its memory. The tree can also be used
+ * directly to query many thresholds, see GetMaxTree().
+ *
+ * \sa MaxTree, BinaryShapeOpeningImageFilter, ShapeOpeningLabelMapFilter
+ * \ingroup MathematicalMorphologyImageFilters
+ * \ingroup ITKMathematicalMorphology
+ */
+template< typename TInputImage, typename TOutputImage = TInputImage,
+          typename TCompare = std::greater< typename TInputImage::PixelType > >
+class ITK_TEMPLATE_EXPORT MaxTreeAttributeOpeningImageFilter:
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(MaxTreeAttributeOpeningImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = MaxTreeAttributeOpeningImageFilter;
+  using Superclass = ImageToImageFilter< TInputImage, TOutputImage >;
+  using Pointer = SmartPointer< Self >;
+  using ConstPointer = SmartPointer< const Self >;
+
+  /** Some convenient type alias. */
+  using InputImageType = TInputImage;
+  using InputImagePointer = typename InputImageType::Pointer;
+  using InputImageConstPointer = typename InputImageType::ConstPointer;
+  using InputImagePixelType = typename InputImageType::PixelType;
+  using OutputImageType = TOutputImage;
+  using OutputImagePixelType = typename OutputImageType::PixelType;
+
+  using MaxTreeType = MaxTree< TInputImage, TCompare >;
+  using MaxTreePointer = typename MaxTreeType::Pointer;
+  using AttributeType = typename MaxTreeType::AttributeType;
+
+  /** ImageDimension constants */
+  static constexpr unsigned int InputImageDimension = TInputImage::ImageDimension;
+  static constexpr unsigned int OutputImageDimension = TOutputImage::ImageDimension;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MaxTreeAttributeOpeningImageFilter, ImageToImageFilter);
+
+  /** Set/Get the attribute of the nodes: MaxTreeType::AREA,
+   * MaxTreeType::VOLUME or MaxTreeType::HEIGHT. Default is AREA. */
+  itkSetMacro(Attribute, AttributeType);
+  itkGetConstMacro(Attribute, AttributeType);
+
+  /** Set/Get the minimum value of the attribute of the kept nodes.
+   * Default is 0: the output is the input. */
+  itkSetMacro(Lambda, double);
+  itkGetConstMacro(Lambda, double);
+
+  /**
+   * Set/Get whether the connected components are defined strictly by
+   * face connectivity or by face+edge+vertex connectivity.  Default is
+   * FullyConnectedOff.  For objects that are 1 pixel wide, use
+   * FullyConnectedOn.
+   */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstReferenceMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** The max-tree of the input built by the last update, or nullptr. */
+  const MaxTreeType * GetMaxTree() const
+  {
+    return m_MaxTree.GetPointer();
+  }
+
+  /** Free the memory of the max-tree. It is built again on the next
+   * update. */
+  void ReleaseMaxTree()
+  {
+    m_MaxTree = nullptr;
+  }
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  // Begin concept checking
+  itkConceptMacro( InputEqualityComparableCheck,
+                   ( Concept::EqualityComparable< InputImagePixelType > ) );
+  itkConceptMacro( InputConvertibleToOutputCheck,
+                   ( Concept::Convertible< InputImagePixelType, OutputImagePixelType > ) );
+  // End concept checking
+#endif
+
+protected:
+  MaxTreeAttributeOpeningImageFilter() = default;
+  ~MaxTreeAttributeOpeningImageFilter() override = default;
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** MaxTreeAttributeOpeningImageFilter needs the entire input be
+   * available. Thus, it needs to provide an implementation of
+   * GenerateInputRequestedRegion(). */
+  void GenerateInputRequestedRegion() override;
+
+  /** MaxTreeAttributeOpeningImageFilter will produce the entire output. */
+  void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) override;
+
+  /** Build the max-tree if needed, and filter it. The tree is built with
+   * multiple threads. */
+  void GenerateData() override;
+
+private:
+  AttributeType  m_Attribute{ MaxTreeType::AREA };
+  double         m_Lambda{ 0.0 };
+  bool           m_FullyConnected{ false };
+  MaxTreePointer m_MaxTree;
+}; // end of class
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMaxTreeAttributeOpeningImageFilter.hxx"
+#endif
+
+#endif
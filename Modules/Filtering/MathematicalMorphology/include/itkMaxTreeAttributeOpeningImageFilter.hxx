@@ -0,0 +1,94 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMaxTreeAttributeOpeningImageFilter_hxx
+#define itkMaxTreeAttributeOpeningImageFilter_hxx
+
+#include "itkMaxTreeAttributeOpeningImageFilter.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+MaxTreeAttributeOpeningImageFilter< TInputImage, TOutputImage, TCompare >
+::GenerateInputRequestedRegion()
+{
+  // Call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  // We need all the input.
+  InputImagePointer input = const_cast< InputImageType * >( this->GetInput() );
+  if ( input )
+    {
+    input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+MaxTreeAttributeOpeningImageFilter< TInputImage, TOutputImage, TCompare >
+::EnlargeOutputRequestedRegion(DataObject *)
+{
+  this->GetOutput()
+  ->SetRequestedRegion( this->GetOutput()->GetLargestPossibleRegion() );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+MaxTreeAttributeOpeningImageFilter< TInputImage, TOutputImage, TCompare >
+::GenerateData()
+{
+  ProgressReporter progress(this, 0, 2);
+
+  this->AllocateOutputs();
+
+  const InputImageType *input = this->GetInput();
+
+  // the tree is still valid if the input has not been modified since it
+  // has been built
+  if ( m_MaxTree.IsNull()
+       || m_MaxTree->GetImage() != input
+       || m_MaxTree->GetFullyConnected() != m_FullyConnected
+       || input->GetMTime() > m_MaxTree->GetMTime() )
+    {
+    m_MaxTree = MaxTreeType::New();
+    m_MaxTree->SetImage( input );
+    m_MaxTree->SetFullyConnected( m_FullyConnected );
+    m_MaxTree->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+    m_MaxTree->Compute();
+    }
+  progress.CompletedPixel();
+
+  m_MaxTree->AttributeFilter( m_Attribute, m_Lambda, this->GetOutput() );
+  progress.CompletedPixel();
+}
+
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+MaxTreeAttributeOpeningImageFilter< TInputImage, TOutputImage, TCompare >
+::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Attribute: " << m_Attribute << std::endl;
+  os << indent << "Lambda: " << m_Lambda << std::endl;
+  os << indent << "FullyConnected: " << m_FullyConnected << std::endl;
+  itkPrintSelfObjectMacro( MaxTree );
+}
+} // end namespace itk
+#endif
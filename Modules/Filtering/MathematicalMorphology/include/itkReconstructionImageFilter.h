@@ -22,14 +22,9 @@
 #include "itkShapedNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
-#include <queue>
-
-//#define BASIC
-#define COPY
-
-#ifdef COPY
 #include "itkNeighborhoodAlgorithm.h"
-#endif
+#include <queue>
+#include <vector>
 
 namespace itk
 {
@@ -43,6 +38,13 @@ namespace itk
  * applications and efficient algorithms" -- IEEE Transactions on
  * Image processing, Vol 2, No 2, pp 176-201, April 1993
  *
+ * The image is split in slabs along its last dimension, one per work unit.
+ * The three steps run in parallel on the slabs, then the values are
+ * propagated across the boundaries of the slabs and the FIFO step is run
+ * again on the slabs whose boundary changed, until no value changes. The
+ * reconstruction is unique, so the output does not depend on the number
+ * of work units.
+ *
  * \author Richard Beare. Department of Medicine, Monash University,
  * Melbourne, Australia.
  *
@@ -126,14 +128,18 @@ public:
   itkGetConstReferenceMacro(FullyConnected, bool);
   itkBooleanMacro(FullyConnected);
 
+#if !defined( ITK_LEGACY_REMOVE )
   /**
    * Perform a padding of the image internally to increase the performance
-   * of the filter. UseInternalCopy can be set to false to reduce the memory
-   * usage.
+   * of the filter.
+   * \deprecated The filter works directly in the output buffer and checks
+   * the boundaries only for the pixels on the border of the slabs, so this
+   * option has no effect.
    */
   itkSetMacro(UseInternalCopy, bool);
   itkGetConstReferenceMacro(UseInternalCopy, bool);
   itkBooleanMacro(UseInternalCopy);
+#endif
 
 protected:
   ReconstructionImageFilter();
@@ -157,20 +163,71 @@ protected:
 
 private:
   bool m_FullyConnected;
-  bool m_UseInternalCopy;
-
-  using FaceCalculatorType = typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator< OutputImageType >;
-
-  using FaceListType = typename FaceCalculatorType::FaceListType;
-  using FaceListTypeIt = typename FaceCalculatorType::FaceListType::iterator;
-
-  using InputIteratorType = ImageRegionConstIterator< InputImageType >;
-  using OutputIteratorType = ImageRegionIterator< OutputImageType >;
+#if !defined( ITK_LEGACY_REMOVE )
+  bool m_UseInternalCopy{ true };
+#endif
 
-  using OutIndexType = typename OutputImageType::IndexType;
-  using InIndexType = typename InputImageType::IndexType;
-  using CNInputIterator = ConstShapedNeighborhoodIterator< InputImageType >;
-  using NOutputIterator = ShapedNeighborhoodIterator< OutputImageType >;
+  using OutputImageSizeType = typename OutputImageType::SizeType;
+  using OutputImageOffsetType = typename OutputImageType::OffsetType;
+  using FifoType = std::queue< OffsetValueType >;
+
+  /** A slab of the image along its last dimension, with the FIFO of the
+   * pixels to propagate in the slab. */
+  struct Slab
+  {
+    IndexValueType m_Begin;
+    IndexValueType m_End;
+    FifoType       m_Fifo;
+    bool           m_ValidMarker;
+  };
+
+  /** Raster and anti-raster propagation in the slab, followed by the FIFO
+   * propagation. The neighbors outside the slab are ignored. */
+  void ReconstructSlab(Slab & slab);
+
+  /** Propagate the values of the neighbor slabs to the pixels on the
+   * boundaries of the slab, and queue the modified pixels. */
+  void PropagateFromNeighborSlabs(Slab & slab);
+
+  /** Propagate the values from the pixels in the FIFO of the slab. */
+  void PropagateFifo(Slab & slab);
+
+  /** Position of the pixel at the given offset in the buffers. */
+  OutputImageIndexType ComputePosition(OffsetValueType offset) const
+  {
+    OutputImageIndexType position;
+    for ( unsigned int d = 0; d < OutputImageDimension; ++d )
+      {
+      position[d] = offset % static_cast< OffsetValueType >( m_Size[d] );
+      offset /= static_cast< OffsetValueType >( m_Size[d] );
+      }
+    return position;
+  }
+
+  /** Whether the n-th neighbor of the pixel at position is in the slab. */
+  bool IsNeighborInside(const OutputImageIndexType & position, unsigned int n, const Slab & slab) const
+  {
+    constexpr unsigned int lastDimension = OutputImageDimension - 1;
+    for ( unsigned int d = 0; d < lastDimension; ++d )
+      {
+      const OffsetValueType p = position[d] + m_NeighborOffsets[n][d];
+      if ( p < 0 || p >= static_cast< OffsetValueType >( m_Size[d] ) )
+        {
+        return false;
+        }
+      }
+    const OffsetValueType p = position[lastDimension] + m_NeighborOffsets[n][lastDimension];
+    return p >= slab.m_Begin && p < slab.m_End;
+  }
+
+  // state of the execution, released at the end of GenerateData()
+  OutputImageSizeType                   m_Size;
+  std::vector< OutputImageOffsetType >  m_NeighborOffsets;
+  std::vector< OffsetValueType >        m_NeighborBufferOffsets;
+  std::vector< unsigned int >           m_PreviousNeighbors;
+  std::vector< unsigned int >           m_LaterNeighbors;
+  std::vector< unsigned char >          m_OnSlabBorder;
+  std::vector< Slab >                   m_Slabs;
 }; // end of class
 } // end namespace itk
 
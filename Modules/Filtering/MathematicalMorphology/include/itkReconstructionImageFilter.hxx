@@ -23,8 +23,8 @@
 #include "itkConstantBoundaryCondition.h"
 #include "itkConnectedComponentAlgorithm.h"
 
-#include "itkConstantPadImageFilter.h"
-#include "itkCropImageFilter.h"
+#include "itkProgressTransformer.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -33,7 +33,6 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
 ::ReconstructionImageFilter()
 {
   m_FullyConnected = false;
-  m_UseInternalCopy = true;
 }
 
 template< typename TInputImage, typename TOutputImage, typename TCompare >
@@ -99,7 +98,6 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >::GetMaskImage()
   return this->GetInput(1);
 }
 
-// a version that takes a padded copy of mask and marker
 template< typename TInputImage, typename TOutputImage, typename TCompare >
 void
 ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
@@ -107,17 +105,6 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
 {
   // Allocate the output
   this->AllocateOutputs();
-  // there are 2 passes that use all pixels and a 3rd that uses some
-  // subset of the pixels. We'll just pretend that the third pass
-  // takes the same as each of the others. Is it OK to update more
-  // often than pixels?
-  ProgressReporter progress(this, 0, this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() * 3);
-
-  TCompare compare;
-
-  MarkerImageConstPointer markerImage = this->GetMarkerImage();
-  MaskImageConstPointer   maskImage = this->GetMaskImage();
-  OutputImagePointer      output = this->GetOutput();
 
   // mask and marker must have the same size
   if ( this->GetMarkerImage()->GetRequestedRegion().GetSize() != this->GetMaskImage()->GetRequestedRegion().GetSize() )
@@ -125,120 +112,85 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
     itkExceptionMacro(<< "Marker and mask must have the same size.");
     }
 
-  // create padded versions of the marker image and the mask image
-  using PadType = typename itk::ConstantPadImageFilter< InputImageType, InputImageType >;
-
-  MarkerImageConstPointer markerImageP;
-  MaskImageConstPointer   maskImageP;
-
-  ISizeType padSize;
-
-  if ( m_UseInternalCopy )
+  // the three images are buffered on regions of the same size, so a pixel
+  // has the same offset in the three buffers
+  OutputImageType * output = this->GetOutput();
+  m_Size = output->GetRequestedRegion().GetSize();
+  const SizeValueType numberOfPixels = output->GetRequestedRegion().GetNumberOfPixels();
+
+  // the neighbors, split in the ones before and after the center pixel in
+  // the raster order
+  m_NeighborOffsets.clear();
+  m_NeighborBufferOffsets.clear();
+  m_PreviousNeighbors.clear();
+  m_LaterNeighbors.clear();
+  unsigned int neighborhoodSize = 1;
+  for ( unsigned int d = 0; d < OutputImageDimension; ++d )
     {
-    typename PadType::Pointer MaskPad = PadType::New();
-    typename PadType::Pointer MarkerPad = PadType::New();
-    padSize.Fill(1);
-
-    MaskPad->SetConstant(m_MarkerValue);
-    MarkerPad->SetConstant(m_MarkerValue);
-    MaskPad->SetPadLowerBound(padSize);
-    MaskPad->SetPadUpperBound(padSize);
-    MarkerPad->SetPadLowerBound(padSize);
-    MarkerPad->SetPadUpperBound(padSize);
-
-    MaskPad->SetInput(maskImage);
-    MarkerPad->SetInput(markerImage);
-    MaskPad->Update();
-    MarkerPad->Update();
-
-    markerImageP = MarkerPad->GetOutput();
-    maskImageP = MaskPad->GetOutput();
+    neighborhoodSize *= 3;
     }
-  else
+  for ( unsigned int i = 0; i < neighborhoodSize; ++i )
     {
-    maskImageP = this->GetMaskImage();
-    InputIteratorType inIt( markerImage,
-                            output->GetRequestedRegion() );
-    OutputIteratorType outIt( output,
-                              output->GetRequestedRegion() );
-    // copy marker to output - isn't there a better way?
-    while ( !outIt.IsAtEnd() )
+    OutputImageOffsetType offset;
+    OffsetValueType bufferOffset = 0;
+    OffsetValueType stride = 1;
+    unsigned int numberOfNonZeros = 0;
+    for ( unsigned int d = 0, j = i; d < OutputImageDimension; ++d, j /= 3 )
+      {
+      offset[d] = static_cast< OffsetValueType >( j % 3 ) - 1;
+      bufferOffset += offset[d] * stride;
+      stride *= static_cast< OffsetValueType >( m_Size[d] );
+      numberOfNonZeros += offset[d] != 0;
+      }
+    if ( numberOfNonZeros == 0 || ( !m_FullyConnected && numberOfNonZeros > 1 ) )
       {
-      MarkerImagePixelType currentValue = inIt.Get();
-      outIt.Set( static_cast< OutputImagePixelType >( currentValue ) );
-      ++inIt;
-      ++outIt;
+      continue;
       }
-    markerImageP = output;
+    if ( bufferOffset < 0 )
+      {
+      m_PreviousNeighbors.push_back( static_cast< unsigned int >( m_NeighborOffsets.size() ) );
+      }
+    else
+      {
+      m_LaterNeighbors.push_back( static_cast< unsigned int >( m_NeighborOffsets.size() ) );
+      }
+    m_NeighborOffsets.push_back(offset);
+    m_NeighborBufferOffsets.push_back(bufferOffset);
     }
 
-  // declare our queue type
-  using FifoType = typename std::queue< OutputImageIndexType >;
-  FifoType IndexFifo;
-
-  NOutputIterator   outNIt;
-  InputIteratorType mskIt;
-  CNInputIterator   mskNIt;
-  ISizeType         kernelRadius;
-  kernelRadius.Fill(1);
-  if ( m_UseInternalCopy )
+  // one slab per work unit, along the last dimension
+  constexpr unsigned int lastDimension = OutputImageDimension - 1;
+  const auto lastSize = static_cast< IndexValueType >( m_Size[lastDimension] );
+  IndexValueType numberOfSlabs = 1;
+  if ( OutputImageDimension > 1 )
     {
-    FaceCalculatorType faceCalculator;
-
-    FaceListType   faceList;
-    FaceListTypeIt fit;
-
-    faceList = faceCalculator(maskImageP, maskImageP->GetLargestPossibleRegion(),
-                              kernelRadius);
-    // we will only be processing the body region
-    fit = faceList.begin();
-    // must be a better way of doing this
-    NOutputIterator tt(kernelRadius,
-                       markerImageP,
-                       *fit);
-    outNIt = tt;
-
-    InputIteratorType ttt(maskImageP,
-                          *fit);
-    mskIt = ttt;
-    CNInputIterator tttt(kernelRadius,
-                         maskImageP,
-                         *fit);
-    mskNIt = tttt;
+    numberOfSlabs = std::max( IndexValueType( 1 ),
+      std::min( static_cast< IndexValueType >( this->GetNumberOfWorkUnits() ), lastSize / 2 ) );
     }
-  else
+  m_Slabs.resize( numberOfSlabs );
+  for ( IndexValueType i = 0; i < numberOfSlabs; ++i )
     {
-    NOutputIterator tt( kernelRadius,
-                        markerImageP,
-                        output->GetRequestedRegion() );
-    outNIt = tt;
-
-    InputIteratorType ttt( maskImageP,
-                           output->GetRequestedRegion() );
-    mskIt = ttt;
-    CNInputIterator tttt( kernelRadius,
-                          maskImageP,
-                          output->GetRequestedRegion() );
-    mskNIt = tttt;
+    m_Slabs[i].m_Begin = i * lastSize / numberOfSlabs;
+    m_Slabs[i].m_End = ( i + 1 ) * lastSize / numberOfSlabs;
+    m_Slabs[i].m_ValidMarker = true;
     }
+  m_OnSlabBorder.resize( numberOfPixels );
 
-  setConnectivityPrevious(&outNIt, m_FullyConnected);
+  MultiThreaderBase* multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
 
-  ConstantBoundaryCondition< OutputImageType > oBC;
-  oBC.SetConstant(m_MarkerValue);
-  outNIt.OverrideBoundaryCondition(&oBC);
+  // the 3 steps of the algorithm on each slab
+  ProgressTransformer slabProgress( 0.0f, 0.9f, this );
+  multiThreader->ParallelizeArray(
+    0, m_Slabs.size(), [this]( SizeValueType i ) { this->ReconstructSlab( m_Slabs[i] ); },
+    slabProgress.GetProcessObject() );
 
-  mskIt.GoToBegin();
-  // scan in forward raster order
-  for ( outNIt.GoToBegin(), mskIt.GoToBegin(); !outNIt.IsAtEnd(); ++outNIt, ++mskIt )
+  for ( const auto & slab : m_Slabs )
     {
-    InputImagePixelType V = outNIt.GetCenterPixel();
-    auto iV = static_cast< OutputImagePixelType >( mskIt.Get() );
-
     // be sure that the pixels in the images follow the preconditions
-    if ( compare(V, iV) )
+    if ( !slab.m_ValidMarker )
       {
-      if ( compare(0, 1) )
+      if ( TCompare()(0, 1) )
         {
         itkExceptionMacro(<< "Marker pixels must be <= mask pixels.");
         }
@@ -247,144 +199,313 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
         itkExceptionMacro(<< "Marker pixels must be >= mask pixels.");
         }
       }
+    }
 
-    // visit the previous neighbours
-    typename NOutputIterator::ConstIterator sIt;
-    for ( sIt = outNIt.Begin(); !sIt.IsAtEnd(); ++sIt )
+  // propagate across the boundaries of the slabs until no value changes.
+  // The even slabs, then the odd slabs, read the boundaries of their
+  // neighbors, which are not modified at the same time. The number of
+  // rounds is not known in advance, so each round reports half of the
+  // remaining progress.
+  const SizeValueType numberOfSlabPairs = m_Slabs.size() / 2;
+  float propagationProgress = 0.9f;
+  while ( m_Slabs.size() > 1 )
+    {
+    multiThreader->ParallelizeArray(
+      0, m_Slabs.size() - numberOfSlabPairs,
+      [this]( SizeValueType i ) { this->PropagateFromNeighborSlabs( m_Slabs[2 * i] ); },
+      nullptr );
+    multiThreader->ParallelizeArray(
+      0, numberOfSlabPairs,
+      [this]( SizeValueType i ) { this->PropagateFromNeighborSlabs( m_Slabs[2 * i + 1] ); },
+      nullptr );
+
+    bool modified = false;
+    for ( const auto & slab : m_Slabs )
       {
-      InputImagePixelType VN = sIt.Get();
-      if ( compare(VN, V) )
-        {
-        outNIt.SetCenterPixel(VN);
-        V = VN;
-        }
+      modified = modified || !slab.m_Fifo.empty();
       }
-
-    // this step clamps to the mask
-    if ( compare(V, iV) )
+    if ( !modified )
       {
-      outNIt.SetCenterPixel(iV);
+      break;
       }
 
-    progress.CompletedPixel();
+    multiThreader->ParallelizeArray(
+      0, m_Slabs.size(), [this]( SizeValueType i ) { this->PropagateFifo( m_Slabs[i] ); },
+      nullptr );
+    propagationProgress += 0.5f * ( 1.0f - propagationProgress );
+    this->UpdateProgress( propagationProgress );
     }
+  this->UpdateProgress( 1.0f );
 
-  // now for the reverse raster order pass
-  // reset the neighborhood
-  setConnectivityLater(&outNIt, m_FullyConnected);
-  outNIt.OverrideBoundaryCondition(&oBC);
-  outNIt.GoToEnd();
-  //mskIt.GoToEnd();
+  // clear and make sure memory is freed
+  std::vector< Slab >().swap( m_Slabs );
+  std::vector< unsigned char >().swap( m_OnSlabBorder );
+}
 
-  ConstantBoundaryCondition< InputImageType > iBC;
-  iBC.SetConstant(m_MarkerValue);
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::ReconstructSlab(Slab & slab)
+{
+  TCompare compare;
 
-  setConnectivityLater(&mskNIt, m_FullyConnected);
-  mskNIt.OverrideBoundaryCondition(&iBC);
+  const MarkerImagePixelType * marker = this->GetMarkerImage()->GetBufferPointer();
+  const MaskImagePixelType * mask = this->GetMaskImage()->GetBufferPointer();
+  OutputImagePixelType * output = this->GetOutput()->GetBufferPointer();
 
-  typename NOutputIterator::IndexListType oIndexList, mIndexList;
-  typename NOutputIterator::IndexListType::const_iterator oLIt, mLIt;
+  constexpr unsigned int lastDimension = OutputImageDimension - 1;
+  const SizeValueType lineLength = m_Size[0];
+  SizeValueType sliceSize = 1;
+  for ( unsigned int d = 0; d < lastDimension; ++d )
+    {
+    sliceSize *= m_Size[d];
+    }
+  const auto begin = static_cast< OffsetValueType >( slab.m_Begin * sliceSize );
+  const auto end = static_cast< OffsetValueType >( slab.m_End * sliceSize );
+
+  // copy the marker to the output and scan in forward raster order
+  for ( OffsetValueType lineOffset = begin; lineOffset < end; lineOffset += lineLength )
+    {
+    // a line is on the border of the slab when one of its coordinates, out
+    // of the first dimension, is on the border
+    bool lineOnBorder = false;
+    OffsetValueType l = lineOffset / lineLength;
+    for ( unsigned int d = 1; d < OutputImageDimension; ++d )
+      {
+      const OffsetValueType coordinate = l % static_cast< OffsetValueType >( m_Size[d] );
+      l /= static_cast< OffsetValueType >( m_Size[d] );
+      if ( d == lastDimension )
+        {
+        lineOnBorder = lineOnBorder || coordinate == slab.m_Begin || coordinate == slab.m_End - 1;
+        }
+      else
+        {
+        lineOnBorder = lineOnBorder || coordinate == 0 || coordinate == static_cast< OffsetValueType >( m_Size[d] ) - 1;
+        }
+      }
+
+    for ( SizeValueType x = 0; x < lineLength; ++x )
+      {
+      const OffsetValueType offset = lineOffset + x;
+      const bool onBorder = lineOnBorder || x == 0 || x == lineLength - 1;
+      m_OnSlabBorder[offset] = onBorder;
+
+      auto V = static_cast< OutputImagePixelType >( marker[offset] );
+      const auto iV = static_cast< OutputImagePixelType >( mask[offset] );
+
+      // be sure that the pixels in the images follow the preconditions
+      if ( compare(V, iV) )
+        {
+        slab.m_ValidMarker = false;
+        return;
+        }
 
-  oIndexList = outNIt.GetActiveIndexList();
-  mIndexList = mskNIt.GetActiveIndexList();
+      // visit the previous neighbours
+      OutputImageIndexType position;
+      if ( onBorder )
+        {
+        position = this->ComputePosition(offset);
+        }
+      for ( auto n : m_PreviousNeighbors )
+        {
+        if ( onBorder && !this->IsNeighborInside(position, n, slab) )
+          {
+          continue;
+          }
+        const OutputImagePixelType VN = output[offset + m_NeighborBufferOffsets[n]];
+        if ( compare(VN, V) )
+          {
+          V = VN;
+          }
+        }
 
-  mskNIt.GoToEnd();
-  while ( !outNIt.IsAtBegin() )
+      // this step clamps to the mask
+      if ( compare(V, iV) )
+        {
+        V = iV;
+        }
+      output[offset] = V;
+      }
+    }
+
+  // now for the reverse raster order pass
+  for ( OffsetValueType offset = end - 1; offset >= begin; --offset )
     {
-    --outNIt;
-    --mskNIt;
-    InputImagePixelType V = outNIt.GetCenterPixel();
-    typename NOutputIterator::ConstIterator sIt;
-    for ( sIt = outNIt.Begin(); !sIt.IsAtEnd(); ++sIt )
+    const bool onBorder = m_OnSlabBorder[offset];
+    OutputImageIndexType position;
+    if ( onBorder )
       {
-      InputImagePixelType VN = sIt.Get();
+      position = this->ComputePosition(offset);
+      }
+
+    OutputImagePixelType V = output[offset];
+    for ( auto n : m_LaterNeighbors )
+      {
+      if ( onBorder && !this->IsNeighborInside(position, n, slab) )
+        {
+        continue;
+        }
+      const OutputImagePixelType VN = output[offset + m_NeighborBufferOffsets[n]];
       if ( compare(VN, V) )
         {
-        outNIt.SetCenterPixel(VN);
         V = VN;
         }
       }
-    InputImagePixelType iV = mskNIt.GetCenterPixel();
+    const auto iV = static_cast< OutputImagePixelType >( mask[offset] );
     if ( compare(V, iV) )
       {
-      outNIt.SetCenterPixel(iV);
       V = iV;
       }
+    output[offset] = V;
 
     // now put indexes in the fifo
-    //typename CNInputIterator::ConstIterator mIt;
-    for ( oLIt = oIndexList.begin(), mLIt = mIndexList.begin(); oLIt != oIndexList.end(); ++oLIt, ++mLIt )
+    for ( auto n : m_LaterNeighbors )
       {
-      InputImagePixelType VN = outNIt.GetPixel(*oLIt);
-      InputImagePixelType iN = mskNIt.GetPixel(*mLIt);
+      if ( onBorder && !this->IsNeighborInside(position, n, slab) )
+        {
+        continue;
+        }
+      const OffsetValueType neighbor = offset + m_NeighborBufferOffsets[n];
+      const OutputImagePixelType VN = output[neighbor];
+      const auto iN = static_cast< OutputImagePixelType >( mask[neighbor] );
       if ( compare(V, VN) && compare(iN, VN) )
         {
-        IndexFifo.push( outNIt.GetIndex() );
+        slab.m_Fifo.push(offset);
         break;
         }
       }
-    progress.CompletedPixel();
     }
 
-  // Now we want to check the full neighborhood
-  setConnectivity(&outNIt, m_FullyConnected);
-  setConnectivity(&mskNIt, m_FullyConnected);
-  mskNIt.OverrideBoundaryCondition(&iBC);
-  outNIt.OverrideBoundaryCondition(&oBC);
-  oIndexList = outNIt.GetActiveIndexList();
-  mIndexList = mskNIt.GetActiveIndexList();
   // now process the fifo - this fill the parts that weren't dealt
   // with by the raster and anti-raster passes
-  //typename NOutputIterator::Iterator sIt;
-  typename CNInputIterator::ConstIterator mIt;
+  this->PropagateFifo(slab);
+}
 
-  while ( !IndexFifo.empty() )
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::PropagateFromNeighborSlabs(Slab & slab)
+{
+  TCompare compare;
+
+  const MaskImagePixelType * mask = this->GetMaskImage()->GetBufferPointer();
+  OutputImagePixelType * output = this->GetOutput()->GetBufferPointer();
+
+  constexpr unsigned int lastDimension = OutputImageDimension - 1;
+  SizeValueType sliceSize = 1;
+  for ( unsigned int d = 0; d < lastDimension; ++d )
     {
-    InputImageIndexType I = IndexFifo.front();
-    IndexFifo.pop();
-    // reposition the iterators
-    outNIt += I - outNIt.GetIndex();
-    mskNIt += I - mskNIt.GetIndex();
-    InputImagePixelType V = outNIt.GetCenterPixel();
-    for ( oLIt = oIndexList.begin(), mLIt = mIndexList.begin();
-          oLIt != oIndexList.end();
-          ++oLIt, ++mLIt )
+    sliceSize *= m_Size[d];
+    }
+
+  // the first slice of the slab reads the previous slab, its last slice
+  // reads the next slab
+  for ( int direction = -1; direction <= 1; direction += 2 )
+    {
+    IndexValueType slice;
+    if ( direction < 0 )
+      {
+      if ( slab.m_Begin == 0 )
+        {
+        continue;
+        }
+      slice = slab.m_Begin;
+      }
+    else
       {
-      InputImagePixelType VN = outNIt.GetPixel(*oLIt);
-      InputImagePixelType iN = mskNIt.GetPixel(*mLIt);
+      if ( slab.m_End == static_cast< IndexValueType >( m_Size[lastDimension] ) )
+        {
+        continue;
+        }
+      slice = slab.m_End - 1;
+      }
+
+    const auto begin = static_cast< OffsetValueType >( slice * sliceSize );
+    const auto end = static_cast< OffsetValueType >( begin + sliceSize );
+    for ( OffsetValueType offset = begin; offset < end; ++offset )
+      {
+      const OutputImageIndexType position = this->ComputePosition(offset);
+      const auto iV = static_cast< OutputImagePixelType >( mask[offset] );
+      OutputImagePixelType V = output[offset];
+      for ( unsigned int n = 0; n < m_NeighborOffsets.size(); ++n )
+        {
+        if ( m_NeighborOffsets[n][lastDimension] != direction )
+          {
+          continue;
+          }
+        bool inside = true;
+        for ( unsigned int d = 0; d < lastDimension; ++d )
+          {
+          const OffsetValueType p = position[d] + m_NeighborOffsets[n][d];
+          inside = inside && p >= 0 && p < static_cast< OffsetValueType >( m_Size[d] );
+          }
+        if ( !inside )
+          {
+          continue;
+          }
+        const OutputImagePixelType VN = output[offset + m_NeighborBufferOffsets[n]];
+        if ( compare(VN, V) && Math::NotAlmostEquals( iV, V ) )
+          {
+          V = compare(iV, VN) ? VN : iV;
+          }
+        }
+      if ( Math::NotExactlyEquals( V, output[offset] ) )
+        {
+        output[offset] = V;
+        slab.m_Fifo.push(offset);
+        }
+      }
+    }
+}
+
+template< typename TInputImage, typename TOutputImage, typename TCompare >
+void
+ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
+::PropagateFifo(Slab & slab)
+{
+  TCompare compare;
+
+  const MaskImagePixelType * mask = this->GetMaskImage()->GetBufferPointer();
+  OutputImagePixelType * output = this->GetOutput()->GetBufferPointer();
+  const auto numberOfNeighbors = static_cast< unsigned int >( m_NeighborBufferOffsets.size() );
+
+  while ( !slab.m_Fifo.empty() )
+    {
+    const OffsetValueType offset = slab.m_Fifo.front();
+    slab.m_Fifo.pop();
+    const bool onBorder = m_OnSlabBorder[offset];
+    OutputImageIndexType position;
+    if ( onBorder )
+      {
+      position = this->ComputePosition(offset);
+      }
+
+    const OutputImagePixelType V = output[offset];
+    for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
+      {
+      if ( onBorder && !this->IsNeighborInside(position, n, slab) )
+        {
+        continue;
+        }
+      const OffsetValueType neighbor = offset + m_NeighborBufferOffsets[n];
+      const OutputImagePixelType VN = output[neighbor];
+      const auto iN = static_cast< OutputImagePixelType >( mask[neighbor] );
       // candidate for dilation via flooding
       if ( compare(V, VN) && Math::NotAlmostEquals( iN, VN ) )
         {
         if ( compare(iN, V) )
           {
           // not clamped by the mask, propagate the center value
-          outNIt.SetPixel(*oLIt, V);
+          output[neighbor] = V;
           }
         else
           {
           // apply the clamping
-          outNIt.SetPixel(*oLIt, iN);
+          output[neighbor] = iN;
           }
-        IndexFifo.push( outNIt.GetIndex(*oLIt) );
+        slab.m_Fifo.push(neighbor);
         }
       }
-    progress.CompletedPixel();
-    }
-
-  if ( m_UseInternalCopy )
-    {
-    using CropType = typename itk::CropImageFilter< InputImageType, OutputImageType >;
-    typename CropType::Pointer crop = CropType::New();
-
-    crop->SetInput(markerImageP);
-    crop->SetUpperBoundaryCropSize(padSize);
-    crop->SetLowerBoundaryCropSize(padSize);
-    crop->GraftOutput( this->GetOutput() );
-    /** execute the minipipeline */
-    crop->Update();
-
-    /** graft the minipipeline output back into this filter's output */
-    this->GraftOutput( crop->GetOutput() );
     }
 }
 
@@ -397,7 +518,9 @@ ReconstructionImageFilter< TInputImage, TOutputImage, TCompare >
 
   os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
   os << indent << "MarkerValue: " << m_MarkerValue << std::endl;
+#if !defined( ITK_LEGACY_REMOVE )
   os << indent << "UseInternalCopy: " << m_UseInternalCopy << std::endl;
+#endif
 }
 }
 #endif
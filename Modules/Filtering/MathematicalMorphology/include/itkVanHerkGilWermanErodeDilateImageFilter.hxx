@@ -98,12 +98,30 @@ VanHerkGilWermanErodeDilateImageFilter< TImage, TKernel, TFunction1 >
       ++SELength;
       }
 
-    InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
+    // the lines along an axis are processed together
+    unsigned int axis = 0;
+    unsigned int numberOfNonZeros = 0;
+    for ( unsigned int d = 0; d < TImage::ImageDimension; d++ )
+      {
+      if ( Math::NotExactlyEquals(ThisLine[d], 0.0f) )
+        {
+        axis = d;
+        numberOfNonZeros++;
+        }
+      }
+    if ( TImage::ImageDimension > 1 && numberOfNonZeros == 1 )
+      {
+      DoAxisLines< TImage, TFunction1 >(input.GetPointer(), output.GetPointer(), m_Boundary, axis, SELength, IReg);
+      }
+    else
+      {
+      InputImageRegionType BigFace = MakeEnlargedFace< InputImageType, KernelLType >(input, IReg, ThisLine);
 
-    DoFace< TImage, BresType, TFunction1, KernelLType >(input, output, m_Boundary, ThisLine,
-                                                        TheseOffsets, SELength,
-                                                        buffer, forward,
-                                                        reverse, IReg, BigFace);
+      DoFace< TImage, BresType, TFunction1, KernelLType >(input, output, m_Boundary, ThisLine,
+                                                          TheseOffsets, SELength,
+                                                          buffer, forward,
+                                                          reverse, IReg, BigFace);
+      }
 
     // after the first pass the input will be taken from the output
     input = internalbuffer;
@@ -53,6 +53,17 @@ void DoFace(typename TImage::ConstPointer input,
             std::vector<typename TImage::PixelType> & rExtBuffer,
             const typename TImage::RegionType AllImage,
             const typename TImage::RegionType face);
+
+/** Process all the lines of the region along an axis with the van
+ * Herk/Gil-Werman algorithm. The lines are copied in chunks of neighbor
+ * lines, and processed together in the inner loops. */
+template< typename TImage, typename TFunction >
+void DoAxisLines(const TImage *input,
+                 TImage *output,
+                 typename TImage::PixelType border,
+                 const unsigned int axis,
+                 const unsigned int KernLen,
+                 const typename TImage::RegionType AllImage);
 } // namespace itk
 
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -22,6 +22,8 @@
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkNeighborhoodAlgorithm.h"
+#include <algorithm>
+#include <memory>
 
 namespace itk
 {
@@ -209,6 +211,129 @@ void DoFace(typename TImage::ConstPointer input,
     }
 }
 
+template< typename TImage, typename TFunction >
+void DoAxisLines(const TImage *input,
+                 TImage *output,
+                 typename TImage::PixelType border,
+                 const unsigned int axis,
+                 const unsigned int KernLen,
+                 const typename TImage::RegionType AllImage)
+{
+  using PixelType = typename TImage::PixelType;
+  using IndexType = typename TImage::IndexType;
+  using RegionType = typename TImage::RegionType;
+
+  // The neighbor lines are along the first dimension, or the second one
+  // for the lines along the first dimension. They are copied in a buffer
+  // where the pixels of the lines at the same position are contiguous, so
+  // that the inner loops on the lines can be vectorized.
+  constexpr SizeValueType maximumNumberOfLanes = 256;
+  const unsigned int laneAxis = ( axis == 0 ) ? 1 : 0;
+  const SizeValueType numberOfLanes = AllImage.GetSize(laneAxis);
+  const SizeValueType lineLength = AllImage.GetSize(axis);
+
+  // The lines are padded with the border on both sides, so that the
+  // extremum over the kernel is defined everywhere:
+  // out[i] = TF(rExt[i], fExt[i + KernLen - 1]).
+  const SizeValueType halfLength = KernLen / 2;
+  const SizeValueType paddedLength = lineLength + 2 * halfLength;
+  const SizeValueType chunkSize = std::min( numberOfLanes, maximumNumberOfLanes );
+  const std::unique_ptr< PixelType[] > pixbuffer(new PixelType[paddedLength * chunkSize]);
+  const std::unique_ptr< PixelType[] > fExtBuffer(new PixelType[paddedLength * chunkSize]);
+  const std::unique_ptr< PixelType[] > rExtBuffer(new PixelType[paddedLength * chunkSize]);
+
+  const OffsetValueType inputStride = input->GetOffsetTable()[axis];
+  const OffsetValueType inputLaneStride = input->GetOffsetTable()[laneAxis];
+  const OffsetValueType outputStride = output->GetOffsetTable()[axis];
+  const OffsetValueType outputLaneStride = output->GetOffsetTable()[laneAxis];
+
+  // iterate over the first pixels of the chunks of lines, as in DoFace()
+  RegionType planes = AllImage;
+  planes.SetSize(axis, 1);
+  planes.SetSize(laneAxis, 1);
+  typename TImage::Pointer dumbImg = TImage::New();
+  dumbImg->SetRegions(planes);
+
+  TFunction m_TF;
+  for ( SizeValueType it = 0; it < planes.GetNumberOfPixels(); it++ )
+    {
+    const IndexType planeIndex = dumbImg->ComputeIndex(it);
+    for ( SizeValueType laneStart = 0; laneStart < numberOfLanes; laneStart += chunkSize )
+      {
+      const SizeValueType lanes = std::min( chunkSize, numberOfLanes - laneStart );
+      IndexType index = planeIndex;
+      index[laneAxis] += laneStart;
+      const PixelType *inputLine = input->GetBufferPointer() + input->ComputeOffset(index);
+      PixelType       *outputLine = output->GetBufferPointer() + output->ComputeOffset(index);
+
+      // copy the lines
+      for ( SizeValueType j = 0; j < halfLength; j++ )
+        {
+        std::fill_n( &pixbuffer[j * lanes], lanes, border );
+        std::fill_n( &pixbuffer[( paddedLength - 1 - j ) * lanes], lanes, border );
+        }
+      for ( SizeValueType j = 0; j < lineLength; j++ )
+        {
+        const PixelType *in = inputLine + j * inputStride;
+        PixelType       *buf = &pixbuffer[( j + halfLength ) * lanes];
+        for ( SizeValueType l = 0; l < lanes; l++ )
+          {
+          buf[l] = in[l * inputLaneStride];
+          }
+        }
+
+      // extrema from the start and from the end of the blocks of KernLen
+      // pixels
+      for ( SizeValueType j = 0; j < paddedLength; j++ )
+        {
+        const PixelType *buf = &pixbuffer[j * lanes];
+        PixelType       *fExt = &fExtBuffer[j * lanes];
+        if ( j % KernLen == 0 )
+          {
+          std::copy( buf, buf + lanes, fExt );
+          }
+        else
+          {
+          const PixelType *previous = fExt - lanes;
+          for ( SizeValueType l = 0; l < lanes; l++ )
+            {
+            fExt[l] = m_TF(buf[l], previous[l]);
+            }
+          }
+        }
+      for ( SizeValueType j = paddedLength; j-- > 0; )
+        {
+        const PixelType *buf = &pixbuffer[j * lanes];
+        PixelType       *rExt = &rExtBuffer[j * lanes];
+        if ( j % KernLen == KernLen - 1 || j == paddedLength - 1 )
+          {
+          std::copy( buf, buf + lanes, rExt );
+          }
+        else
+          {
+          const PixelType *next = rExt + lanes;
+          for ( SizeValueType l = 0; l < lanes; l++ )
+            {
+            rExt[l] = m_TF(buf[l], next[l]);
+            }
+          }
+        }
+
+      // now compute result
+      for ( SizeValueType j = 0; j < lineLength; j++ )
+        {
+        const PixelType *rExt = &rExtBuffer[j * lanes];
+        const PixelType *fExt = &fExtBuffer[( j + KernLen - 1 ) * lanes];
+        PixelType       *out = outputLine + j * outputStride;
+        for ( SizeValueType l = 0; l < lanes; l++ )
+          {
+          out[l * outputLaneStride] = m_TF(rExt[l], fExt[l]);
+          }
+        }
+      }
+    }
+}
+
 } // namespace itk
 
 #endif
@@ -0,0 +1,218 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkFlatStructuringElement.h"
+#include "itkGrayscaleDilateImageFilter.h"
+#include "itkGrayscaleErodeImageFilter.h"
+#include "itkVanHerkGilWermanDilateImageFilter.h"
+#include "itkVanHerkGilWermanErodeImageFilter.h"
+#include "itkRandomImageSource.h"
+#include "itkTestingComparisonImageFilter.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Decompose structuring elements in lines, and compare the van Herk/Gil-Werman
+ * dilation and erosion by the decomposed structuring elements to the basic
+ * algorithm.
+ */
+namespace
+{
+template< typename TStructuringElement >
+int
+CheckDecomposition( TStructuringElement se, double maximumError, bool exact )
+{
+  const TStructuringElement original = se;
+  TEST_EXPECT_TRUE( se.Decompose( maximumError ) );
+  TEST_EXPECT_TRUE( se.GetDecomposable() );
+  TEST_EXPECT_TRUE( !se.GetLines().empty() );
+  TEST_EXPECT_TRUE( se.GetDecompositionError() <= maximumError );
+  if( exact )
+    {
+    TEST_EXPECT_EQUAL( se.GetDecompositionError(), 0.0 );
+    }
+  // the decomposition is included in the original structuring element
+  for( unsigned int i = 0; i < se.Size(); ++i )
+    {
+    TEST_EXPECT_TRUE( !se[i] || original[i] );
+    }
+  std::cout << "Radius " << original.GetRadius() << ": " << se.GetLines().size() << " lines, error "
+            << se.GetDecompositionError() << std::endl;
+  return EXIT_SUCCESS;
+}
+
+template< typename TImage, typename TStructuringElement >
+int
+CompareToBasic( const TImage * image, const TStructuringElement & se, unsigned int numberOfWorkUnits,
+                bool interiorOnly )
+{
+  using BasicDilateType = itk::GrayscaleDilateImageFilter< TImage, TImage, TStructuringElement >;
+  using BasicErodeType = itk::GrayscaleErodeImageFilter< TImage, TImage, TStructuringElement >;
+  using DilateType = itk::VanHerkGilWermanDilateImageFilter< TImage, TStructuringElement >;
+  using ErodeType = itk::VanHerkGilWermanErodeImageFilter< TImage, TStructuringElement >;
+  using ComparisonType = itk::Testing::ComparisonImageFilter< TImage, TImage >;
+
+  std::cout << "Radius " << se.GetRadius() << ", work units: " << numberOfWorkUnits << std::endl;
+
+  typename BasicDilateType::Pointer basicDilate = BasicDilateType::New();
+  basicDilate->SetInput( image );
+  basicDilate->SetKernel( se );
+  basicDilate->SetAlgorithm( BasicDilateType::BASIC );
+  TRY_EXPECT_NO_EXCEPTION( basicDilate->Update() );
+
+  typename BasicErodeType::Pointer basicErode = BasicErodeType::New();
+  basicErode->SetInput( image );
+  basicErode->SetKernel( se );
+  basicErode->SetAlgorithm( BasicErodeType::BASIC );
+  TRY_EXPECT_NO_EXCEPTION( basicErode->Update() );
+
+  typename DilateType::Pointer dilate = DilateType::New();
+  dilate->SetInput( image );
+  dilate->SetKernel( se );
+  dilate->SetNumberOfWorkUnits( numberOfWorkUnits );
+  TRY_EXPECT_NO_EXCEPTION( dilate->Update() );
+
+  typename ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput( image );
+  erode->SetKernel( se );
+  erode->SetNumberOfWorkUnits( numberOfWorkUnits );
+  TRY_EXPECT_NO_EXCEPTION( erode->Update() );
+
+  // With lines which are not along the axes, the successive dilations are
+  // clipped to the image, and differ from the basic algorithm close to its
+  // border.
+  typename TImage::RegionType region = image->GetLargestPossibleRegion();
+  if( interiorOnly )
+    {
+    region.ShrinkByRadius( se.GetRadius() );
+    }
+
+  typename ComparisonType::Pointer dilateComparison = ComparisonType::New();
+  dilateComparison->SetValidInput( basicDilate->GetOutput() );
+  dilateComparison->SetTestInput( dilate->GetOutput() );
+  dilateComparison->GetOutput()->SetRequestedRegion( region );
+  TRY_EXPECT_NO_EXCEPTION( dilateComparison->Update() );
+  TEST_EXPECT_EQUAL( dilateComparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+  typename ComparisonType::Pointer erodeComparison = ComparisonType::New();
+  erodeComparison->SetValidInput( basicErode->GetOutput() );
+  erodeComparison->SetTestInput( erode->GetOutput() );
+  erodeComparison->GetOutput()->SetRequestedRegion( region );
+  TRY_EXPECT_NO_EXCEPTION( erodeComparison->Update() );
+  TEST_EXPECT_EQUAL( erodeComparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+  return EXIT_SUCCESS;
+}
+}
+
+int itkFlatStructuringElementDecomposeTest( int, char *[] )
+{
+  using SE2Type = itk::FlatStructuringElement< 2 >;
+  using SE3Type = itk::FlatStructuringElement< 3 >;
+  using Image2Type = itk::Image< unsigned char, 2 >;
+  using Image3Type = itk::Image< short, 3 >;
+
+  // Boxes are decomposed exactly in lines along the axes.
+  SE2Type::RadiusType radius2;
+  radius2[0] = 4;
+  radius2[1] = 2;
+  SE2Type box2 = SE2Type::Box( radius2 );
+  box2.SetDecomposable( false );
+  if( CheckDecomposition( box2, 0.0, true ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Balls are approximated by lines along the axes and the diagonals.
+  SE2Type::RadiusType ballRadius2;
+  ballRadius2.Fill( 10 );
+  SE3Type::RadiusType ballRadius3;
+  ballRadius3.Fill( 15 );
+  if( CheckDecomposition( SE2Type::Ball( ballRadius2 ), 0.15, false ) == EXIT_FAILURE
+      || CheckDecomposition( SE3Type::Ball( ballRadius3 ), 0.15, false ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A too small error is refused, and the structuring element is unchanged.
+  SE2Type ball2 = SE2Type::Ball( ballRadius2 );
+  TEST_EXPECT_TRUE( !ball2.Decompose( 0.01 ) );
+  TEST_EXPECT_TRUE( !ball2.GetDecomposable() );
+  TEST_EXPECT_EQUAL( ball2.GetDecompositionError(), 0.0 );
+
+  // An asymmetric structuring element can't be decomposed in lines.
+  SE2Type::RadiusType smallRadius;
+  smallRadius.Fill( 1 );
+  SE2Type asymmetric = SE2Type::Box( smallRadius );
+  asymmetric.SetDecomposable( false );
+  asymmetric[0] = false;
+  TEST_EXPECT_TRUE( !asymmetric.Decompose( 1.0 ) );
+
+  // Dilation and erosion by the lines along the axes and the diagonals.
+  using Random2Type = itk::RandomImageSource< Image2Type >;
+  Random2Type::Pointer random2 = Random2Type::New();
+  Image2Type::SizeType size2;
+  size2[0] = 67;
+  size2[1] = 43;
+  random2->SetSize( size2 );
+  random2->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( random2->Update() );
+  SE2Type::RadiusType smallBallRadius2;
+  smallBallRadius2.Fill( 5 );
+  SE2Type ball2Decomposed = SE2Type::Ball( smallBallRadius2 );
+  if( CheckDecomposition( ball2Decomposed, 0.15, false ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+  ball2Decomposed.Decompose( 0.15 );
+
+  using Random3Type = itk::RandomImageSource< Image3Type >;
+  Random3Type::Pointer random3 = Random3Type::New();
+  Image3Type::SizeType size3;
+  size3[0] = 23;
+  size3[1] = 17;
+  size3[2] = 19;
+  random3->SetSize( size3 );
+  random3->SetMin( 0 );
+  random3->SetMax( 255 );
+  random3->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( random3->Update() );
+  SE3Type::RadiusType radius3;
+  radius3[0] = 3;
+  radius3[1] = 2;
+  radius3[2] = 4;
+  SE3Type box3 = SE3Type::Box( radius3 );
+  SE3Type ball3Decomposed = SE3Type::Ball( radius3 );
+  if( CheckDecomposition( ball3Decomposed, 0.4, false ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+  ball3Decomposed.Decompose( 0.4 );
+
+  for( unsigned int numberOfWorkUnits = 1; numberOfWorkUnits <= 4; numberOfWorkUnits += 3 )
+    {
+    if( CompareToBasic( random2->GetOutput(), SE2Type::Box( radius2 ), numberOfWorkUnits, false ) == EXIT_FAILURE
+        || CompareToBasic( random2->GetOutput(), ball2Decomposed, numberOfWorkUnits, true ) == EXIT_FAILURE
+        || CompareToBasic( random3->GetOutput(), box3, numberOfWorkUnits, false ) == EXIT_FAILURE
+        || CompareToBasic( random3->GetOutput(), ball3Decomposed, numberOfWorkUnits, true ) == EXIT_FAILURE )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,315 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMaxTreeAttributeOpeningImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRandomImageSource.h"
+#include "itkTestingComparisonImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include <queue>
+#include <set>
+
+/*
+ * Compare the area openings of a max-tree, built with several numbers of
+ * work units, with area openings computed by threshold decomposition, and
+ * check the attributes of the nodes of a small image.
+ */
+namespace
+{
+template< typename TImage >
+typename TImage::Pointer
+ReferenceAreaOpening( const TImage * input, double lambda, bool fullyConnected )
+{
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+  using IndexType = typename ImageType::IndexType;
+  constexpr unsigned int Dimension = ImageType::ImageDimension;
+  const typename ImageType::RegionType region = input->GetLargestPossibleRegion();
+
+  std::set< PixelType > levels;
+  itk::ImageRegionConstIterator< ImageType > it( input, region );
+  for( ; !it.IsAtEnd(); ++it )
+    {
+    levels.insert( it.Get() );
+    }
+
+  typename ImageType::Pointer output = ImageType::New();
+  output->SetRegions( region );
+  output->Allocate();
+  output->FillBuffer( *levels.begin() );
+
+  std::vector< typename ImageType::OffsetType > offsets;
+  typename ImageType::OffsetType offset;
+  offset.Fill( -1 );
+  while( offset[Dimension - 1] <= 1 )
+    {
+    unsigned int numberOfNonZeros = 0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      numberOfNonZeros += offset[d] != 0;
+      }
+    if( numberOfNonZeros == 1 || ( fullyConnected && numberOfNonZeros > 1 ) )
+      {
+      offsets.push_back( offset );
+      }
+    for( unsigned int d = 0; d < Dimension; ++d )
+      {
+      if( ++offset[d] <= 1 || d == Dimension - 1 )
+        {
+        break;
+        }
+      offset[d] = -1;
+      }
+    }
+
+  // the pixels of the components of area at least lambda of each upper
+  // level set are at least at that level in the output
+  for( const auto level : levels )
+    {
+    using FlagImageType = itk::Image< unsigned char, Dimension >;
+    typename FlagImageType::Pointer visited = FlagImageType::New();
+    visited->SetRegions( region );
+    visited->Allocate();
+    visited->FillBuffer( 0 );
+    itk::ImageRegionConstIteratorWithIndex< ImageType > sIt( input, region );
+    for( ; !sIt.IsAtEnd(); ++sIt )
+      {
+      if( sIt.Get() < level || visited->GetPixel( sIt.GetIndex() ) )
+        {
+        continue;
+        }
+      std::vector< IndexType > component;
+      std::queue< IndexType > fifo;
+      fifo.push( sIt.GetIndex() );
+      visited->SetPixel( sIt.GetIndex(), 1 );
+      while( !fifo.empty() )
+        {
+        const IndexType index = fifo.front();
+        fifo.pop();
+        component.push_back( index );
+        for( const auto & o : offsets )
+          {
+          const IndexType neighbor = index + o;
+          if( region.IsInside( neighbor ) && !visited->GetPixel( neighbor ) && input->GetPixel( neighbor ) >= level )
+            {
+            visited->SetPixel( neighbor, 1 );
+            fifo.push( neighbor );
+            }
+          }
+        }
+      if( component.size() >= lambda )
+        {
+        for( const auto & index : component )
+          {
+          output->SetPixel( index, std::max( output->GetPixel( index ), level ) );
+          }
+        }
+      }
+    }
+  return output;
+}
+
+template< typename TImage >
+int
+CheckAreaOpenings( const TImage * input )
+{
+  using MaxTreeType = itk::MaxTree< TImage >;
+  using ComparisonType = itk::Testing::ComparisonImageFilter< TImage, TImage >;
+
+  typename TImage::Pointer output = TImage::New();
+  output->SetRegions( input->GetLargestPossibleRegion() );
+  output->Allocate();
+
+  for( bool fullyConnected : { false, true } )
+    {
+    for( itk::ThreadIdType numberOfWorkUnits : { 1, 3, 8 } )
+      {
+      typename MaxTreeType::Pointer maxTree = MaxTreeType::New();
+      maxTree->SetImage( input );
+      maxTree->SetFullyConnected( fullyConnected );
+      maxTree->SetNumberOfWorkUnits( numberOfWorkUnits );
+      maxTree->Compute();
+
+      // the sorted pixels and the tree are consistent
+      const typename MaxTreeType::PixelOffsetContainerType & sorted = maxTree->GetSortedPixels();
+      const typename TImage::PixelType *buffer = input->GetBufferPointer();
+      for( size_t i = 1; i < sorted.size(); ++i )
+        {
+        TEST_EXPECT_TRUE( buffer[sorted[i - 1]] <= buffer[sorted[i]] );
+        }
+      TEST_EXPECT_EQUAL( maxTree->GetParent( maxTree->GetRoot() ), maxTree->GetRoot() );
+
+      // one tree for all the thresholds
+      for( double lambda : { 0.0, 2.0, 5.0, 17.0, 100.0 } )
+        {
+        maxTree->AttributeFilter( MaxTreeType::AREA, lambda, output.GetPointer() );
+        std::cout << "FullyConnected: " << fullyConnected << ", work units: " << numberOfWorkUnits
+                  << ", lambda: " << lambda << std::endl;
+        typename ComparisonType::Pointer comparison = ComparisonType::New();
+        comparison->SetValidInput( ReferenceAreaOpening( input, lambda, fullyConnected ) );
+        comparison->SetTestInput( output );
+        TRY_EXPECT_NO_EXCEPTION( comparison->Update() );
+        TEST_EXPECT_EQUAL( comparison->GetNumberOfPixelsWithDifferences(), 0u );
+        }
+      }
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkMaxTreeTest( int, char *[] )
+{
+  using PixelType = unsigned char;
+  using ImageType2D = itk::Image< PixelType, 2 >;
+  using ImageType3D = itk::Image< short, 3 >;
+  using MaxTreeType = itk::MaxTree< ImageType2D >;
+  using ComparisonType = itk::Testing::ComparisonImageFilter< ImageType2D, ImageType2D >;
+
+  // attributes of the nodes of a small image
+  //   1 1 1 1 1 1
+  //   1 5 5 1 3 1
+  //   1 5 4 1 3 1
+  //   1 1 1 1 1 1
+  const PixelType values[] = { 1, 1, 1, 1, 1, 1,
+                               1, 5, 5, 1, 3, 1,
+                               1, 5, 4, 1, 3, 1,
+                               1, 1, 1, 1, 1, 1 };
+  ImageType2D::Pointer image = ImageType2D::New();
+  ImageType2D::SizeType size = { { 6, 4 } };
+  image->SetRegions( size );
+  image->Allocate();
+  std::copy( values, values + 24, image->GetBufferPointer() );
+
+  MaxTreeType::Pointer maxTree = MaxTreeType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( maxTree, MaxTree, Object );
+  TRY_EXPECT_EXCEPTION( maxTree->Compute() );
+  maxTree->SetImage( image );
+  maxTree->SetNumberOfWorkUnits( 2 );
+  TRY_EXPECT_NO_EXCEPTION( maxTree->Compute() );
+
+  TEST_EXPECT_EQUAL( maxTree->GetNumberOfNodes(), 4u );
+  const itk::OffsetValueType root = maxTree->GetRoot();
+  TEST_EXPECT_EQUAL( image->GetBufferPointer()[root], 1 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::AREA, root ), 24.0 );
+  const itk::OffsetValueType node4 = maxTree->GetNode( 14 );
+  const itk::OffsetValueType node5 = maxTree->GetNode( 7 );
+  const itk::OffsetValueType node3 = maxTree->GetNode( 10 );
+  TEST_EXPECT_EQUAL( maxTree->GetNode( 8 ), node5 );
+  TEST_EXPECT_EQUAL( maxTree->GetNode( 13 ), node5 );
+  TEST_EXPECT_EQUAL( maxTree->GetNode( 16 ), node3 );
+  TEST_EXPECT_EQUAL( maxTree->GetParent( node5 ), node4 );
+  TEST_EXPECT_EQUAL( maxTree->GetParent( node4 ), root );
+  TEST_EXPECT_EQUAL( maxTree->GetParent( node3 ), root );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::AREA, node4 ), 4.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::AREA, node5 ), 3.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::AREA, node3 ), 2.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::VOLUME, node4 ), 15.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::VOLUME, node5 ), 3.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::VOLUME, node3 ), 4.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::HEIGHT, node4 ), 4.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::HEIGHT, node5 ), 1.0 );
+  TEST_EXPECT_EQUAL( maxTree->GetAttributeValue( MaxTreeType::HEIGHT, node3 ), 2.0 );
+  TRY_EXPECT_EXCEPTION( maxTree->GetAttributeValues( 3 ) );
+
+  // height filtering: the 3 plateau and the 5 peak are removed, the 4
+  // dome is kept
+  ImageType2D::Pointer output = ImageType2D::New();
+  output->SetRegions( size );
+  output->Allocate();
+  maxTree->AttributeFilter( MaxTreeType::HEIGHT, 3.0, output.GetPointer() );
+  TEST_EXPECT_EQUAL( output->GetBufferPointer()[10], 1 );
+  TEST_EXPECT_EQUAL( output->GetBufferPointer()[7], 4 );
+  TEST_EXPECT_EQUAL( output->GetBufferPointer()[14], 4 );
+
+  // area openings of random images
+  using RandomSourceType2D = itk::RandomImageSource< ImageType2D >;
+  RandomSourceType2D::Pointer source2D = RandomSourceType2D::New();
+  ImageType2D::SizeType size2D = { { 37, 29 } };
+  source2D->SetSize( size2D );
+  source2D->SetMin( 0 );
+  source2D->SetMax( 15 );
+  source2D->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( source2D->Update() );
+  ImageType2D::Pointer image2D = source2D->GetOutput();
+  if( CheckAreaOpenings( image2D.GetPointer() ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  using RandomSourceType3D = itk::RandomImageSource< ImageType3D >;
+  RandomSourceType3D::Pointer source3D = RandomSourceType3D::New();
+  ImageType3D::SizeType size3D = { { 9, 8, 11 } };
+  source3D->SetSize( size3D );
+  source3D->SetMin( -300 );
+  source3D->SetMax( 300 );
+  source3D->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( source3D->Update() );
+  if( CheckAreaOpenings( source3D->GetOutput() ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+
+  // the filter reuses the tree when only the threshold changes
+  using FilterType = itk::MaxTreeAttributeOpeningImageFilter< ImageType2D >;
+  FilterType::Pointer filter = FilterType::New();
+  EXERCISE_BASIC_OBJECT_METHODS( filter, MaxTreeAttributeOpeningImageFilter, ImageToImageFilter );
+  filter->SetInput( image2D );
+  filter->SetLambda( 5.0 );
+  ComparisonType::Pointer comparison = ComparisonType::New();
+  comparison->SetTestInput( filter->GetOutput() );
+  comparison->SetValidInput( ReferenceAreaOpening( image2D.GetPointer(), 5.0, false ) );
+  TRY_EXPECT_NO_EXCEPTION( comparison->Update() );
+  TEST_EXPECT_EQUAL( comparison->GetNumberOfPixelsWithDifferences(), 0u );
+  const FilterType::MaxTreeType *filterMaxTree = filter->GetMaxTree();
+  filter->SetLambda( 17.0 );
+  comparison->SetValidInput( ReferenceAreaOpening( image2D.GetPointer(), 17.0, false ) );
+  TRY_EXPECT_NO_EXCEPTION( comparison->Update() );
+  TEST_EXPECT_EQUAL( filter->GetMaxTree(), filterMaxTree );
+  TEST_EXPECT_EQUAL( comparison->GetNumberOfPixelsWithDifferences(), 0u );
+  filter->FullyConnectedOn();
+  comparison->SetValidInput( ReferenceAreaOpening( image2D.GetPointer(), 17.0, true ) );
+  TRY_EXPECT_NO_EXCEPTION( comparison->Update() );
+  TEST_EXPECT_EQUAL( comparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+  // area closing with a min-tree
+  using MinTreeFilterType = itk::MaxTreeAttributeOpeningImageFilter< ImageType2D, ImageType2D, std::less< PixelType > >;
+  MinTreeFilterType::Pointer closing = MinTreeFilterType::New();
+  closing->SetInput( image2D );
+  closing->SetLambda( 9.0 );
+  TRY_EXPECT_NO_EXCEPTION( closing->Update() );
+  ImageType2D::Pointer inverted = ImageType2D::New();
+  inverted->SetRegions( size2D );
+  inverted->Allocate();
+  itk::ImageRegionConstIterator< ImageType2D > iIt( image2D, image2D->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< ImageType2D > vIt( inverted, inverted->GetLargestPossibleRegion() );
+  for( ; !iIt.IsAtEnd(); ++iIt, ++vIt )
+    {
+    vIt.Set( 255 - iIt.Get() );
+    }
+  ImageType2D::Pointer reference = ReferenceAreaOpening( inverted.GetPointer(), 9.0, false );
+  itk::ImageRegionConstIterator< ImageType2D > cIt( closing->GetOutput(), size2D );
+  itk::ImageRegionConstIterator< ImageType2D > rIt( reference, size2D );
+  for( ; !cIt.IsAtEnd(); ++cIt, ++rIt )
+    {
+    TEST_EXPECT_EQUAL( cIt.Get(), 255 - rIt.Get() );
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkReconstructionByDilationImageFilter.h"
+#include "itkReconstructionByErosionImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRandomImageSource.h"
+#include "itkTestingComparisonImageFilter.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Compare the reconstructions by dilation and by erosion, computed with
+ * several numbers of work units, with a reconstruction computed by
+ * iterating the elementary geodesic dilation (or erosion) until stability.
+ */
+namespace
+{
+template< typename TImage, typename TCompare >
+typename TImage::Pointer
+ReferenceReconstruction( const TImage * marker, const TImage * mask, bool fullyConnected )
+{
+  using ImageType = TImage;
+  constexpr unsigned int Dimension = ImageType::ImageDimension;
+  TCompare compare;
+
+  typename ImageType::Pointer output = ImageType::New();
+  output->SetRegions( marker->GetLargestPossibleRegion() );
+  output->Allocate();
+  itk::ImageRegionConstIterator< ImageType > mIt( marker, marker->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< ImageType > oIt( output, output->GetLargestPossibleRegion() );
+  for( ; !mIt.IsAtEnd(); ++mIt, ++oIt )
+    {
+    oIt.Set( mIt.Get() );
+    }
+
+  const typename ImageType::RegionType region = output->GetLargestPossibleRegion();
+  bool modified = true;
+  while( modified )
+    {
+    modified = false;
+    itk::ImageRegionIteratorWithIndex< ImageType > it( output, region );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      typename ImageType::PixelType value = it.Get();
+      typename ImageType::OffsetType offset;
+      offset.Fill( -1 );
+      while( offset[Dimension - 1] <= 1 )
+        {
+        unsigned int numberOfNonZeros = 0;
+        for( unsigned int d = 0; d < Dimension; ++d )
+          {
+          numberOfNonZeros += offset[d] != 0;
+          }
+        const typename ImageType::IndexType neighbor = it.GetIndex() + offset;
+        if( region.IsInside( neighbor ) && ( fullyConnected || numberOfNonZeros == 1 )
+            && compare( output->GetPixel( neighbor ), value ) )
+          {
+          value = output->GetPixel( neighbor );
+          }
+        for( unsigned int d = 0; d < Dimension; ++d )
+          {
+          if( ++offset[d] <= 1 || d == Dimension - 1 )
+            {
+            break;
+            }
+          offset[d] = -1;
+          }
+        }
+      if( compare( value, mask->GetPixel( it.GetIndex() ) ) )
+        {
+        value = mask->GetPixel( it.GetIndex() );
+        }
+      if( value != it.Get() )
+        {
+        it.Set( value );
+        modified = true;
+        }
+      }
+    }
+  return output;
+}
+
+template< typename TImage >
+int
+TestReconstruction( const TImage * image, const TImage * lowMarker, const TImage * highMarker )
+{
+  using DilationType = itk::ReconstructionByDilationImageFilter< TImage, TImage >;
+  using ErosionType = itk::ReconstructionByErosionImageFilter< TImage, TImage >;
+  using ComparisonType = itk::Testing::ComparisonImageFilter< TImage, TImage >;
+  using PixelType = typename TImage::PixelType;
+
+  for( bool fullyConnected : { false, true } )
+    {
+    typename TImage::Pointer dilationReference =
+      ReferenceReconstruction< TImage, std::greater< PixelType > >( lowMarker, image, fullyConnected );
+    typename TImage::Pointer erosionReference =
+      ReferenceReconstruction< TImage, std::less< PixelType > >( highMarker, image, fullyConnected );
+
+    for( unsigned int numberOfWorkUnits = 1; numberOfWorkUnits <= 7; numberOfWorkUnits += 3 )
+      {
+      std::cout << "FullyConnected: " << fullyConnected << ", work units: " << numberOfWorkUnits << std::endl;
+
+      typename DilationType::Pointer dilation = DilationType::New();
+      dilation->SetMarkerImage( lowMarker );
+      dilation->SetMaskImage( image );
+      dilation->SetFullyConnected( fullyConnected );
+      dilation->SetNumberOfWorkUnits( numberOfWorkUnits );
+      typename ComparisonType::Pointer dilationComparison = ComparisonType::New();
+      dilationComparison->SetValidInput( dilationReference );
+      dilationComparison->SetTestInput( dilation->GetOutput() );
+      TRY_EXPECT_NO_EXCEPTION( dilationComparison->Update() );
+      TEST_EXPECT_EQUAL( dilationComparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+      typename ErosionType::Pointer erosion = ErosionType::New();
+      erosion->SetMarkerImage( highMarker );
+      erosion->SetMaskImage( image );
+      erosion->SetFullyConnected( fullyConnected );
+      erosion->SetNumberOfWorkUnits( numberOfWorkUnits );
+      typename ComparisonType::Pointer erosionComparison = ComparisonType::New();
+      erosionComparison->SetValidInput( erosionReference );
+      erosionComparison->SetTestInput( erosion->GetOutput() );
+      TRY_EXPECT_NO_EXCEPTION( erosionComparison->Update() );
+      TEST_EXPECT_EQUAL( erosionComparison->GetNumberOfPixelsWithDifferences(), 0u );
+      }
+    }
+  return EXIT_SUCCESS;
+}
+}
+
+int itkReconstructionImageFilterTest( int, char *[] )
+{
+  // a serpentine path, going up and down through all the slabs
+  {
+  using ImageType = itk::Image< unsigned char, 2 >;
+  ImageType::SizeType size;
+  size[0] = 15;
+  size[1] = 24;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  ImageType::Pointer lowMarker = ImageType::New();
+  lowMarker->SetRegions( size );
+  lowMarker->Allocate();
+  lowMarker->FillBuffer( 0 );
+  ImageType::Pointer highMarker = ImageType::New();
+  highMarker->SetRegions( size );
+  highMarker->Allocate();
+  highMarker->FillBuffer( 255 );
+  for( itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+       !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const bool onPath = index[0] % 2 == 0
+      || ( index[0] % 4 == 1 && index[1] == static_cast< itk::IndexValueType >( size[1] ) - 1 )
+      || ( index[0] % 4 == 3 && index[1] == 0 );
+    it.Set( onPath ? 200 - index[0] : 10 );
+    }
+  ImageType::IndexType start = { { 0, 0 } };
+  lowMarker->SetPixel( start, 200 );
+  highMarker->SetPixel( start, 200 );
+
+  std::cout << "Serpentine path" << std::endl;
+  if( TestReconstruction< ImageType >( image, lowMarker, highMarker ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+  }
+
+  // a random image, with markers equal to the image on a sparse set of
+  // pixels
+  {
+  using ImageType = itk::Image< short, 3 >;
+  ImageType::SizeType size;
+  size[0] = 13;
+  size[1] = 11;
+  size[2] = 17;
+  using RandomSourceType = itk::RandomImageSource< ImageType >;
+  RandomSourceType::Pointer source = RandomSourceType::New();
+  source->SetSize( size );
+  source->SetMin( -50 );
+  source->SetMax( 50 );
+  source->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( source->Update() );
+  ImageType::Pointer image = source->GetOutput();
+  ImageType::Pointer lowMarker = ImageType::New();
+  lowMarker->SetRegions( size );
+  lowMarker->Allocate();
+  ImageType::Pointer highMarker = ImageType::New();
+  highMarker->SetRegions( size );
+  highMarker->Allocate();
+  const short * buffer = image->GetBufferPointer();
+  for( itk::SizeValueType i = 0; i < image->GetLargestPossibleRegion().GetNumberOfPixels(); ++i )
+    {
+    lowMarker->GetBufferPointer()[i] = i % 47 == 0 ? buffer[i] : -50;
+    highMarker->GetBufferPointer()[i] = i % 53 == 11 ? buffer[i] : 50;
+    }
+
+  std::cout << "Random image" << std::endl;
+  if( TestReconstruction< ImageType >( image, lowMarker, highMarker ) == EXIT_FAILURE )
+    {
+    return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
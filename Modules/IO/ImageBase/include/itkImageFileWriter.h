@@ -160,6 +160,15 @@ public:
   itkSetMacro(NumberOfStreamDivisions, unsigned int);
   itkGetConstReferenceMacro(NumberOfStreamDivisions, unsigned int);
 
+  /** Set/Get the maximum amount of memory, in bytes, that the upstream
+   * pipeline may use to produce one piece. When it is not zero, the number
+   * of pieces is increased above NumberOfStreamDivisions as needed, using
+   * the estimate of ProcessObject::EstimateMemoryPerPixel(), and Write()
+   * throws an exception if the ImageIO cannot split the image in pieces
+   * small enough. The default is zero: no limit. */
+  itkSetMacro(MaximumMemoryBytes, SizeValueType);
+  itkGetConstMacro(MaximumMemoryBytes, SizeValueType);
+
   /** Aliased to the Write() method to be consistent with the rest of the
    * pipeline. */
   void Update() override
@@ -211,6 +220,8 @@ private:
 
   ImageIORegion m_PasteIORegion;
   unsigned int  m_NumberOfStreamDivisions;
+  unsigned int  m_ActualNumberOfStreamDivisions; // with the memory limit
+  SizeValueType m_MaximumMemoryBytes;
   bool          m_UserSpecifiedIORegion;    // track whether the region
                                             // is user specified
   bool m_FactorySpecifiedImageIO;           //track whether the factory
@@ -32,6 +32,8 @@
 #include "itkDiffusionTensor3D.h"
 #include "itkMatrix.h"
 #include "itkImageAlgorithm.h"
+#include <algorithm>
+#include <cmath>
 #include <complex>
 
 namespace itk
@@ -48,6 +50,8 @@ ImageFileWriter< TInputImage >
   m_UserSpecifiedIORegion = false;
   m_UserSpecifiedImageIO = false;
   m_NumberOfStreamDivisions = 1;
+  m_ActualNumberOfStreamDivisions = 1;
+  m_MaximumMemoryBytes = 0;
 }
 
 //---------------------------------------------------------
@@ -251,11 +255,6 @@ ImageFileWriter< TInputImage >
   // Notify start event observers
   this->InvokeEvent( StartEvent() );
 
-  if ( m_NumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
-    {
-    m_ImageIO->SetUseStreamedWriting(true);
-    }
-
   ImageIORegion largestIORegion(TInputImage::ImageDimension);
   ImageIORegionAdaptor< TInputImage::ImageDimension >::
   Convert( largestRegion, largestIORegion, largestRegion.GetIndex() );
@@ -281,15 +280,60 @@ ImageFileWriter< TInputImage >
       << "Largest possible region: " << largestRegion);
     }
 
+  // Increase the number of divisions to fit the upstream pipeline in the
+  // memory limit
+  m_ActualNumberOfStreamDivisions = m_NumberOfStreamDivisions;
+  double bytesPerPixel = 0.0;
+  if ( m_MaximumMemoryBytes > 0 && nonConstInput->GetSource() )
+    {
+    bytesPerPixel = nonConstInput->GetSource()->EstimateMemoryPerPixel();
+    const double requiredDivisions =
+      std::ceil( static_cast< double >( pasteIORegion.GetNumberOfPixels() ) * bytesPerPixel
+                 / static_cast< double >( m_MaximumMemoryBytes ) );
+    if ( requiredDivisions > m_ActualNumberOfStreamDivisions )
+      {
+      m_ActualNumberOfStreamDivisions =
+        static_cast< unsigned int >( std::min( requiredDivisions,
+                                               static_cast< double >( pasteIORegion.GetNumberOfPixels() ) ) );
+      }
+    itkDebugMacro("Estimated memory per pixel: " << bytesPerPixel << " bytes, "
+                  << m_ActualNumberOfStreamDivisions << " stream divisions");
+    }
+
+  if ( m_ActualNumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
+    {
+    m_ImageIO->SetUseStreamedWriting(true);
+    }
+
   // Determin the actual number of divisions of the input. This is determined
   // by what the ImageIO can do
   unsigned int numDivisions;
 
   // this may fail and throw an exception if the configuration is not supported
-  numDivisions = m_ImageIO->GetActualNumberOfSplitsForWriting(m_NumberOfStreamDivisions,
+  numDivisions = m_ImageIO->GetActualNumberOfSplitsForWriting(m_ActualNumberOfStreamDivisions,
                                                               pasteIORegion,
                                                               largestIORegion);
 
+  // Refuse to run the pipeline if a piece does not fit in the memory limit
+  if ( bytesPerPixel > 0.0 )
+    {
+    SizeValueType largestPieceSize = 0;
+    for ( unsigned int i = 0; i < numDivisions; ++i )
+      {
+      const ImageIORegion streamIORegion =
+        m_ImageIO->GetSplitRegionForWriting(i, numDivisions, pasteIORegion, largestIORegion);
+      largestPieceSize = std::max( largestPieceSize, static_cast< SizeValueType >( streamIORegion.GetNumberOfPixels() ) );
+      }
+    if ( static_cast< double >( largestPieceSize ) * bytesPerPixel > static_cast< double >( m_MaximumMemoryBytes ) )
+      {
+      itkExceptionMacro(
+        << "Cannot write " << m_FileName << " within the maximum memory of " << m_MaximumMemoryBytes << " bytes: "
+        << m_ImageIO->GetNameOfClass() << " splits the image in " << numDivisions
+        << " pieces, and the largest one needs an estimated " << static_cast< double >( largestPieceSize ) * bytesPerPixel
+        << " bytes");
+      }
+    }
+
   /**
    * Loop over the number of pieces, execute the upstream pipeline on each
    * piece, and copy the results into the output image.
@@ -351,7 +395,10 @@ ImageFileWriter< TInputImage >
     m_ImageIO->SetIORegion(streamIORegion);
 
     // write the data
+    {
+    PipelineProfiler::FilterScope profilerScope(this);
     this->GenerateData();
+    }
 
     this->UpdateProgress( static_cast<float>( piece + 1 ) / static_cast<float>( numDivisions ) );
     }
@@ -388,7 +435,7 @@ ImageFileWriter< TInputImage >
   // before this test, bad stuff would happened when they don't match
   if ( bufferedRegion != ioRegion )
     {
-    if ( m_NumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
+    if ( m_ActualNumberOfStreamDivisions > 1 || m_UserSpecifiedIORegion )
       {
       itkDebugMacro("Requested stream region does not match generated output");
       itkDebugMacro("input filter may not support streaming well");
@@ -443,6 +490,7 @@ ImageFileWriter< TInputImage >
 
   os << indent << "IO Region: " << m_PasteIORegion << "\n";
   os << indent << "Number of Stream Divisions: " << m_NumberOfStreamDivisions << "\n";
+  os << indent << "Maximum Memory Bytes: " << m_MaximumMemoryBytes << "\n";
 
   if ( m_UseCompression )
     {
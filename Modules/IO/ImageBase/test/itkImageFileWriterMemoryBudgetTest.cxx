@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageFileWriter.h"
+#include "itkImageFileReader.h"
+#include "itkAbsImageFilter.h"
+#include "itkPipelineMonitorImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Write the output of a small pipeline with a memory limit, and check the
+ * estimate of the memory per pixel, the number of pieces chosen by the
+ * writer, and that a limit that cannot be met is refused.
+ */
+int itkImageFileWriterMemoryBudgetTest( int argc, char* argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Missing parameters." << std::endl;
+    std::cerr << "Usage: " << argv[0] << " outputImageFile" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  constexpr unsigned int Dimension = 3;
+  using PixelType = float;
+  using ImageType = itk::Image< PixelType, Dimension >;
+
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 32;
+  size[1] = 32;
+  size[2] = 40;
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+    {
+    const ImageType::IndexType & index = it.GetIndex();
+    it.Set( static_cast< PixelType >( index[0] - 2 * index[1] + 3 * index[2] ) );
+    }
+
+  // The first filter cannot run in place on an image without a source, the
+  // second one does not run in place, and the third one and the monitor
+  // run in place.
+  using AbsFilterType = itk::AbsImageFilter< ImageType, ImageType >;
+  AbsFilterType::Pointer abs1 = AbsFilterType::New();
+  abs1->SetInput( image );
+  AbsFilterType::Pointer abs2 = AbsFilterType::New();
+  abs2->SetInput( abs1->GetOutput() );
+  AbsFilterType::Pointer abs3 = AbsFilterType::New();
+  abs3->SetInput( abs2->GetOutput() );
+  abs1->InPlaceOn();
+  abs3->InPlaceOn();
+
+  using MonitorFilterType = itk::PipelineMonitorImageFilter< ImageType >;
+  MonitorFilterType::Pointer monitor = MonitorFilterType::New();
+  monitor->SetInput( abs3->GetOutput() );
+
+  TEST_EXPECT_EQUAL( abs1->EstimateMemoryPerPixel(), 4.0 );
+  TEST_EXPECT_EQUAL( abs3->EstimateMemoryPerPixel(), 8.0 );
+  TEST_EXPECT_EQUAL( monitor->EstimateMemoryPerPixel(), 8.0 );
+
+  using WriterType = itk::ImageFileWriter< ImageType >;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput( monitor->GetOutput() );
+  writer->SetFileName( argv[1] );
+  TEST_SET_GET_VALUE( 0u, writer->GetMaximumMemoryBytes() );
+
+  // 32 x 32 x 40 pixels of 8 bytes need 4 pieces of at most 100000 bytes.
+  writer->SetMaximumMemoryBytes( 100000 );
+  TEST_SET_GET_VALUE( 100000u, writer->GetMaximumMemoryBytes() );
+  TRY_EXPECT_NO_EXCEPTION( writer->Update() );
+  TEST_EXPECT_EQUAL( monitor->GetNumberOfUpdates(), 4u );
+  TEST_EXPECT_TRUE( monitor->VerifyAllInputCanStream( 4 ) );
+
+  // The number of stream divisions is still used when it is larger.
+  writer->SetNumberOfStreamDivisions( 5 );
+  monitor->ClearPipelineSavedInformation();
+  abs1->Modified();
+  TRY_EXPECT_NO_EXCEPTION( writer->Update() );
+  TEST_EXPECT_EQUAL( monitor->GetNumberOfUpdates(), 5u );
+
+  using ReaderType = itk::ImageFileReader< ImageType >;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  TRY_EXPECT_NO_EXCEPTION( reader->Update() );
+  itk::ImageRegionConstIterator< ImageType > itR( reader->GetOutput(), image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(), itR.GoToBegin(); !it.IsAtEnd(); ++it, ++itR )
+    {
+    if( itk::Math::NotExactlyEquals( itR.Get(), std::abs( it.Get() ) ) )
+      {
+      std::cerr << "Wrong pixel value at " << it.GetIndex() << ": " << itR.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A slice of the image does not fit in 1000 bytes.
+  writer->SetMaximumMemoryBytes( 1000 );
+  abs1->Modified();
+  TRY_EXPECT_EXCEPTION( writer->Update() );
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
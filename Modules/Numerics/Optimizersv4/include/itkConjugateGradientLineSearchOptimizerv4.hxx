@@ -100,7 +100,7 @@ ConjugateGradientLineSearchOptimizerv4Template<TInternalComputationValueType>
     throw err;
     }
 
-  this->InvokeEvent( IterationEvent() );
+  this->InvokeIterationEvent();
 }
 
 }//namespace itk
@@ -142,7 +142,7 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
     m_StopConditionDescription << this->GetNameOfClass() << ": Running. ";
     m_StopConditionDescription << "@ index " << this->GetCurrentIndex() << " value is " << m_CurrentValue;
 
-    this->InvokeEvent( IterationEvent() );
+    this->InvokeIterationEvent();
     this->AdvanceOneStep();
     this->m_CurrentIteration++;
     }
@@ -156,6 +156,7 @@ ExhaustiveOptimizerv4<TInternalComputationValueType>
   itkDebugMacro("StopWalking");
 
   m_Stop = true;
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
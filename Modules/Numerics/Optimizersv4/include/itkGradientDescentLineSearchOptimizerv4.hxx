@@ -93,7 +93,7 @@ GradientDescentLineSearchOptimizerv4Template<TInternalComputationValueType>
     throw err;
     }
 
-  this->InvokeEvent( IterationEvent() );
+  this->InvokeIterationEvent();
   }
 
 
@@ -109,6 +109,7 @@ GradientDescentOptimizerBasev4Template<TInternalComputationValueType>
   itkDebugMacro( "StopOptimization called with a description - "
     << this->GetStopConditionDescription() );
   this->m_Stop = true;
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
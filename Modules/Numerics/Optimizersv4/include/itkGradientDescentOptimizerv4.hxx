@@ -189,7 +189,7 @@ GradientDescentOptimizerv4Template<TInternalComputationValueType>
     throw err;
     }
 
-  this->InvokeEvent( IterationEvent() );
+  this->InvokeIterationEvent();
 }
 
 template<typename TInternalComputationValueType>
@@ -68,6 +68,13 @@ namespace itk
  * (default 1e-5) and the maximum number of function evaluations is set
  * through SetMaximumIterations() (default 0 = no maximum).
  *
+ * The vector operations of the two-loop recursion, of the history update and
+ * of the line search are split in fixed-size chunks that are distributed
+ * over the work units of the optimizer (see SetNumberOfWorkUnits()) when the
+ * number of parameters is large, e.g. for BSpline transforms with fine
+ * grids. The reductions are summed in a fixed order, so the results do not
+ * depend on the number of work units.
+ *
  *
  * References:
  *
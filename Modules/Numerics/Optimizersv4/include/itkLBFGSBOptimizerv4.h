@@ -46,6 +46,11 @@ class ITK_FORWARD_EXPORT LBFGSBOptimizerHelperv4;
  *
  * See also the documentation in Numerics/lbfgsb.c
  *
+ * The vector operations on the parameters are split in chunks when the
+ * number of parameters is large, and the chunks are processed with
+ * NumberOfWorkUnits work units. The result does not depend on the number
+ * of work units.
+ *
  * References:
  *
  * [1] R. H. Byrd, P. Lu and J. Nocedal.
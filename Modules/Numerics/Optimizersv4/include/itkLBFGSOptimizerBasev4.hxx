@@ -56,7 +56,7 @@ LBFGSOptimizerBaseHelperv4<TInternalVnlOptimizerType>
 {
   Superclass::report_iter();
 
-  m_ItkObj->InvokeEvent( IterationEvent() );
+  m_ItkObj->InvokeIterationEvent();
   m_ItkObj->m_CurrentIteration = this->num_iterations_;
 
   // Return true to terminate the optimization loop.
@@ -100,6 +100,7 @@ MultiGradientOptimizerv4Template<TInternalComputationValueType>
 
     // FIXME
     // this->m_Metric->SetParameters( this->m_OptimizersList[ this->m_BestParametersIndex ] );
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
   }
 
@@ -221,7 +222,7 @@ MultiGradientOptimizerv4Template<TInternalComputationValueType>
         // Pass exception to caller
       throw err;
       }
-    this->InvokeEvent( IterationEvent() );
+    this->InvokeIterationEvent();
     /* Update and check iteration count */
     this->m_CurrentIteration++;
     if ( this->m_CurrentIteration >= this->m_NumberOfIterations )
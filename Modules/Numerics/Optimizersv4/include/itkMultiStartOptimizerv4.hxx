@@ -124,6 +124,7 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
 
   this->m_Metric->SetParameters( this->m_ParametersList[ this->m_BestParametersIndex ] );
 
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
@@ -208,7 +209,7 @@ MultiStartOptimizerv4Template<TInternalComputationValueType>
       break;
       }
 
-    this->InvokeEvent( IterationEvent() );
+    this->InvokeIterationEvent();
 
     /* Update and check iteration count */
     this->m_CurrentIteration++;
@@ -24,6 +24,13 @@
 #include "itkOptimizerParameterScalesEstimator.h"
 #include "itkObjectToObjectMetricBase.h"
 #include "itkIntTypes.h"
+#include "itkCommand.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace itk
 {
@@ -73,6 +80,20 @@ namespace itk
  * Threading of some optimizer operations may be handled within
  * derived classes, for example in GradientDescentOptimizer.
  *
+ * Observers of IterationEvent are executed synchronously, and the next
+ * iteration only starts once they return. Observers that do not need to
+ * interact with the optimizer, e.g. for logging or for writing snapshots of
+ * the position, can instead be added with AddAsynchronousIterationObserver().
+ * After each iteration, the optimizer copies the iteration number, the metric
+ * value and optionally the position into a ring buffer of
+ * AsynchronousIterationBufferSize entries, and returns to the optimization.
+ * A background thread executes the asynchronous observers for each buffered
+ * state, in order. The observers read the state with
+ * GetAsynchronousIterationState() rather than from the optimizer accessors,
+ * and must not modify the optimizer. The optimizer only waits for them when
+ * the buffer is full, and before it ends the optimization, so that all the
+ * states have been observed when StartOptimization() returns.
+ *
  * \note Derived classes must override StartOptimization, and then call
  * this base class version to perform common initializations.
  *
@@ -230,6 +251,46 @@ public:
   /** Stop condition return string type */
   virtual const StopConditionReturnStringType GetStopConditionDescription() const = 0;
 
+  /** State of the optimization at the end of an iteration, as passed to the
+   * asynchronous iteration observers. */
+  struct IterationStateType
+    {
+    SizeValueType  m_Iteration;
+    MeasureType    m_MetricValue;
+    ParametersType m_Position;
+    };
+
+  /** Add a command executed from a background thread with an IterationEvent
+   * after each iteration. Returns a tag for RemoveAsynchronousIterationObserver(). */
+  unsigned long AddAsynchronousIterationObserver( Command *command );
+
+  /** Remove the asynchronous iteration observer with the given tag. */
+  void RemoveAsynchronousIterationObserver( unsigned long tag );
+
+  /** Return true if any asynchronous iteration observer was added. */
+  bool HasAsynchronousIterationObserver() const;
+
+  /** Iteration state being observed. Only valid within the Execute() method
+   * of an asynchronous iteration observer. */
+  const IterationStateType & GetAsynchronousIterationState() const;
+
+  /** Number of iteration states buffered for the asynchronous observers.
+   * A change takes effect at the next StartOptimization(). Default is 16. */
+  itkSetClampMacro( AsynchronousIterationBufferSize, SizeValueType, 1, NumericTraits<SizeValueType>::max() );
+  itkGetConstMacro( AsynchronousIterationBufferSize, SizeValueType );
+
+  /** Copy the current position into the iteration states. Turn it off when
+   * the asynchronous observers do not need the position and the transform
+   * has many parameters. Default is true. */
+  itkSetMacro( CopyPositionToAsynchronousIterationState, bool );
+  itkGetConstMacro( CopyPositionToAsynchronousIterationState, bool );
+  itkBooleanMacro( CopyPositionToAsynchronousIterationState );
+
+  /** Wait until the asynchronous observers have observed all the buffered
+   * iteration states. An exception thrown by an asynchronous observer is
+   * rethrown here, or at the next iteration. */
+  void WaitForAsynchronousIterationObservers();
+
 protected:
 
   /** Default constructor */
@@ -268,7 +329,45 @@ protected:
    */
   bool                          m_DoEstimateScales;
 
+  /** Invoke IterationEvent, then buffer the current state for the
+   * asynchronous iteration observers. Derived classes call this method rather
+   * than InvokeEvent( IterationEvent() ) at the end of each iteration. */
+  void InvokeIterationEvent();
+
+  /** Same as above, invoking the given iteration event, e.g. a
+   * FunctionEvaluationIterationEvent, for the synchronous observers. The
+   * asynchronous observers always receive an IterationEvent. */
+  void InvokeIterationEvent( const EventObject & event );
+
   void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Execute the asynchronous observers for the buffered states until
+   * the background thread is stopped. */
+  void ObserveIterationStates();
+
+  /** Stop and join the background thread. */
+  void StopAsynchronousIterationThread();
+
+  using AsynchronousObserverType = std::pair<unsigned long, Command::Pointer>;
+
+  std::vector<AsynchronousObserverType> m_AsynchronousIterationObservers;
+  unsigned long                         m_AsynchronousIterationObserverTag{ 0 };
+  SizeValueType                         m_AsynchronousIterationBufferSize{ 16 };
+  bool                                  m_CopyPositionToAsynchronousIterationState{ true };
+
+  /** Ring buffer of the iteration states, and its queued range. */
+  std::vector<IterationStateType>       m_IterationStates;
+  SizeValueType                         m_FirstQueuedIterationState{ 0 };
+  SizeValueType                         m_NumberOfQueuedIterationStates{ 0 };
+  const IterationStateType *            m_ObservedIterationState{ nullptr };
+
+  std::thread                           m_AsynchronousIterationThread;
+  mutable std::mutex                    m_AsynchronousIterationMutex;
+  std::condition_variable               m_IterationStateQueued;
+  std::condition_variable               m_IterationStateObserved;
+  bool                                  m_StopAsynchronousIterationThread{ false };
+  std::exception_ptr                    m_AsynchronousIterationException;
 };
 
 /** This helps to meet backward compatibility */
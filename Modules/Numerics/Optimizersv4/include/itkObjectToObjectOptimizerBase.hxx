@@ -44,7 +44,10 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
 //-------------------------------------------------------------------
 template<typename TInternalComputationValueType>
 ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
-::~ObjectToObjectOptimizerBaseTemplate() = default;
+::~ObjectToObjectOptimizerBaseTemplate()
+{
+  this->StopAsynchronousIterationThread();
+}
 
 //-------------------------------------------------------------------
 template<typename TInternalComputationValueType>
@@ -85,6 +88,11 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
     << static_cast< typename NumericTraits< MeasureType >::PrintType >( this->m_CurrentMetricValue )
     << std::endl;
   os << indent << "DoEstimateScales: " << this->m_DoEstimateScales << std::endl;
+  os << indent << "Number of asynchronous iteration observers: "
+    << this->m_AsynchronousIterationObservers.size() << std::endl;
+  os << indent << "AsynchronousIterationBufferSize: " << this->m_AsynchronousIterationBufferSize << std::endl;
+  os << indent << "CopyPositionToAsynchronousIterationState: "
+    << this->m_CopyPositionToAsynchronousIterationState << std::endl;
 }
 
 //-------------------------------------------------------------------
@@ -195,6 +203,20 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
     // Set weights to identity. But leave the array empty.
     this->m_WeightsAreIdentity = true;
     }
+
+  /* Apply a change of the asynchronous iteration buffer size, once the states
+   * of a previous optimization have been observed. */
+  std::unique_lock<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  if( this->m_AsynchronousIterationThread.joinable() &&
+      this->m_IterationStates.size() != this->m_AsynchronousIterationBufferSize )
+    {
+    this->m_IterationStateObserved.wait( lock, [this]
+      {
+      return this->m_NumberOfQueuedIterationStates == 0;
+      } );
+    this->m_IterationStates.resize( this->m_AsynchronousIterationBufferSize );
+    this->m_FirstQueuedIterationState = 0;
+    }
 }
 
 //-------------------------------------------------------------------
@@ -226,6 +248,221 @@ ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
 {
   return m_Scales.Size() > 0;
 }
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+unsigned long
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::AddAsynchronousIterationObserver( Command *command )
+{
+  if( command == nullptr )
+    {
+    itkExceptionMacro("The asynchronous iteration observer is null.");
+    }
+  std::lock_guard<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  this->m_AsynchronousIterationObservers.emplace_back( this->m_AsynchronousIterationObserverTag, command );
+  return this->m_AsynchronousIterationObserverTag++;
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::RemoveAsynchronousIterationObserver( unsigned long tag )
+{
+  std::lock_guard<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  for( auto it = this->m_AsynchronousIterationObservers.begin(); it != this->m_AsynchronousIterationObservers.end(); ++it )
+    {
+    if( it->first == tag )
+      {
+      this->m_AsynchronousIterationObservers.erase( it );
+      return;
+      }
+    }
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+bool
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::HasAsynchronousIterationObserver() const
+{
+  std::lock_guard<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  return !this->m_AsynchronousIterationObservers.empty();
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+const typename ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>::IterationStateType &
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::GetAsynchronousIterationState() const
+{
+  if( this->m_ObservedIterationState == nullptr
+      || std::this_thread::get_id() != this->m_AsynchronousIterationThread.get_id() )
+    {
+    itkExceptionMacro("The iteration state is only available to the asynchronous iteration observers.");
+    }
+  return *this->m_ObservedIterationState;
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::InvokeIterationEvent()
+{
+  this->InvokeIterationEvent( IterationEvent() );
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::InvokeIterationEvent( const EventObject & event )
+{
+  this->InvokeEvent( event );
+
+  std::unique_lock<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  if( this->m_AsynchronousIterationException )
+    {
+    std::exception_ptr exception = this->m_AsynchronousIterationException;
+    this->m_AsynchronousIterationException = nullptr;
+    std::rethrow_exception( exception );
+    }
+  if( this->m_AsynchronousIterationObservers.empty() )
+    {
+    return;
+    }
+
+  if( !this->m_AsynchronousIterationThread.joinable() )
+    {
+    this->m_IterationStates.resize( this->m_AsynchronousIterationBufferSize );
+    this->m_FirstQueuedIterationState = 0;
+    this->m_NumberOfQueuedIterationStates = 0;
+    this->m_StopAsynchronousIterationThread = false;
+    this->m_AsynchronousIterationThread = std::thread( &Self::ObserveIterationStates, this );
+    }
+
+  // Only wait for the observers when the buffer is full.
+  this->m_IterationStateObserved.wait( lock, [this]
+    {
+    return this->m_NumberOfQueuedIterationStates < this->m_IterationStates.size();
+    } );
+  IterationStateType & state = this->m_IterationStates[( this->m_FirstQueuedIterationState
+    + this->m_NumberOfQueuedIterationStates ) % this->m_IterationStates.size()];
+  lock.unlock();
+
+  // The free entry is not accessed by the background thread: fill it without
+  // holding the lock. Assigning a position of the same size reuses the memory
+  // of the entry.
+  state.m_Iteration = this->m_CurrentIteration;
+  state.m_MetricValue = this->m_CurrentMetricValue;
+  if( this->m_CopyPositionToAsynchronousIterationState && this->m_Metric.IsNotNull() )
+    {
+    state.m_Position = this->m_Metric->GetParameters();
+    }
+  else
+    {
+    state.m_Position.SetSize( 0 );
+    }
+
+  lock.lock();
+  ++this->m_NumberOfQueuedIterationStates;
+  lock.unlock();
+  this->m_IterationStateQueued.notify_one();
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::ObserveIterationStates()
+{
+  std::unique_lock<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  while( true )
+    {
+    this->m_IterationStateQueued.wait( lock, [this]
+      {
+      return this->m_NumberOfQueuedIterationStates > 0 || this->m_StopAsynchronousIterationThread;
+      } );
+    if( this->m_NumberOfQueuedIterationStates == 0 )
+      {
+      break;
+      }
+
+    // Copy the observers so that they can be added or removed while they are
+    // executed.
+    const std::vector<AsynchronousObserverType> observers = this->m_AsynchronousIterationObservers;
+    this->m_ObservedIterationState = &this->m_IterationStates[this->m_FirstQueuedIterationState];
+    lock.unlock();
+
+    std::exception_ptr exception;
+    try
+      {
+      for( const auto & observer : observers )
+        {
+        observer.second->Execute( this, IterationEvent() );
+        }
+      }
+    catch( ... )
+      {
+      exception = std::current_exception();
+      }
+
+    lock.lock();
+    if( exception && !this->m_AsynchronousIterationException )
+      {
+      this->m_AsynchronousIterationException = exception;
+      }
+    this->m_ObservedIterationState = nullptr;
+    this->m_FirstQueuedIterationState = ( this->m_FirstQueuedIterationState + 1 ) % this->m_IterationStates.size();
+    --this->m_NumberOfQueuedIterationStates;
+    this->m_IterationStateObserved.notify_all();
+    }
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::WaitForAsynchronousIterationObservers()
+{
+  // An observer stopping the optimization must not wait for itself.
+  if( std::this_thread::get_id() == this->m_AsynchronousIterationThread.get_id() )
+    {
+    return;
+    }
+
+  std::unique_lock<std::mutex> lock( this->m_AsynchronousIterationMutex );
+  this->m_IterationStateObserved.wait( lock, [this]
+    {
+    return this->m_NumberOfQueuedIterationStates == 0;
+    } );
+  if( this->m_AsynchronousIterationException )
+    {
+    std::exception_ptr exception = this->m_AsynchronousIterationException;
+    this->m_AsynchronousIterationException = nullptr;
+    std::rethrow_exception( exception );
+    }
+}
+
+//-------------------------------------------------------------------
+template<typename TInternalComputationValueType>
+void
+ObjectToObjectOptimizerBaseTemplate<TInternalComputationValueType>
+::StopAsynchronousIterationThread()
+{
+  if( !this->m_AsynchronousIterationThread.joinable() )
+    {
+    return;
+    }
+    {
+    std::lock_guard<std::mutex> lock( this->m_AsynchronousIterationMutex );
+    this->m_StopAsynchronousIterationThread = true;
+    }
+  this->m_IterationStateQueued.notify_one();
+  this->m_AsynchronousIterationThread.join();
+}
 }//namespace itk
 
 #endif
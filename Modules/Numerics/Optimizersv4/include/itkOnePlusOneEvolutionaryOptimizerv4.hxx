@@ -247,6 +247,7 @@ OnePlusOneEvolutionaryOptimizerv4<TInternalComputationValueType>
       m_StopConditionDescription << "Fnorm (" << m_FrobeniusNorm
                                  << ") is less than Epsilon (" << m_Epsilon
                                  << " at iteration #" << this->m_CurrentIteration;
+      this->WaitForAsynchronousIterationObservers();
       this->InvokeEvent( EndEvent() );
       return;
       }
@@ -273,7 +274,7 @@ OnePlusOneEvolutionaryOptimizerv4<TInternalComputationValueType>
         }
       }
 
-    this->InvokeEvent( IterationEvent() );
+    this->InvokeIterationEvent();
     itkDebugMacro( << "Current position: " << this->GetCurrentPosition() );
     }
   m_StopConditionDescription.str("");
@@ -281,6 +282,7 @@ OnePlusOneEvolutionaryOptimizerv4<TInternalComputationValueType>
   m_StopConditionDescription << "Maximum number of iterations ("
                              << m_MaximumIteration
                              << ") exceeded. ";
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
@@ -479,6 +479,7 @@ PowellOptimizerv4<TInternalComputationValueType>
                                  << fp
                                  << ") are within Value Tolerance ("
                                  << m_ValueTolerance << ")";
+      this->WaitForAsynchronousIterationObservers();
       this->InvokeEvent( EndEvent() );
       return;
       }
@@ -526,12 +527,13 @@ PowellOptimizerv4<TInternalComputationValueType>
         }
       }
 
-    this->InvokeEvent( IterationEvent() );
+    this->InvokeIterationEvent();
     }
 
   m_StopConditionDescription << "Maximum number of iterations exceeded. "
                              << "Number of iterations is "
                              << m_MaximumIteration;
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
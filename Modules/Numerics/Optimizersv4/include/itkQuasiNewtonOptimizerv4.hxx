@@ -188,7 +188,7 @@ QuasiNewtonOptimizerv4Template<TInternalComputationValueType>
     throw err;
     }
 
-  this->InvokeEvent( IterationEvent() );
+  this->InvokeIterationEvent();
 }
 
 template<typename TInternalComputationValueType>
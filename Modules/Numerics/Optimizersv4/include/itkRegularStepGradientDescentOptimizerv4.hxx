@@ -181,7 +181,7 @@ RegularStepGradientDescentOptimizerv4<TInternalComputationValueType>
     throw err;
     }
 
-  this->InvokeEvent( IterationEvent() );
+  this->InvokeIterationEvent();
 }
 
 template<typename TInternalComputationValueType>
@@ -266,6 +266,7 @@ AmoebaOptimizerv4
                                      << " Number of iterations is "
                                      << this->m_NumberOfIterations;
     }
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
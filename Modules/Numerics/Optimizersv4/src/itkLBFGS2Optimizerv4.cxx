@@ -18,6 +18,7 @@
 #include "itkLBFGS2Optimizerv4.h"
 #include "itkMacro.h"
 #include "itkMath.h"
+#include "itkMultiThreaderBase.h"
 
 #include "lbfgs.h"
 
@@ -27,7 +28,22 @@ namespace itk
 class LBFGS2Optimizerv4::PrivateImplementationHolder
 {
 public:
-  lbfgs_parameter_t m_Parameters;
+  lbfgs_parameter_t          m_Parameters;
+  MultiThreaderBase::Pointer m_MultiThreader;
+
+  /** Vector operation callback from libLBFGS: process the chunks on the
+   * work units of the optimizer. */
+  static void Parallelize( void *instance, lbfgs_kernel_t kernel, void *arg, int numberOfChunks )
+  {
+    auto * optimizer = reinterpret_cast< LBFGS2Optimizerv4* >(instance);
+    MultiThreaderBase * multiThreader = optimizer->m_Pimpl->m_MultiThreader;
+    multiThreader->SetNumberOfWorkUnits( optimizer->GetNumberOfWorkUnits() );
+    multiThreader->ParallelizeArray( 0, numberOfChunks,
+      [kernel, arg]( SizeValueType chunk )
+        {
+        kernel( arg, static_cast<int>( chunk ) );
+        }, nullptr );
+  }
 };
 
 LBFGS2Optimizerv4
@@ -36,6 +52,8 @@ LBFGS2Optimizerv4
 {
   //Initialize to default paramaters
   lbfgs_parameter_init( &m_Pimpl->m_Parameters );
+  m_Pimpl->m_Parameters.parallelize = PrivateImplementationHolder::Parallelize;
+  m_Pimpl->m_MultiThreader = MultiThreaderBase::New();
   m_StatusCode = 100;
 }
 
@@ -133,6 +151,7 @@ LBFGS2Optimizerv4
   lbfgs_free(x);
 
   this->m_Metric->SetParameters( optimizedParameters );
+  this->WaitForAsynchronousIterationObservers();
 }
 
 
@@ -211,7 +230,7 @@ LBFGS2Optimizerv4::UpdateProgress( const LBFGS2Optimizerv4::PrecisionType *x,
   m_CurrentStepSize = step;
   m_CurrentNumberOfEvaluations = ls;
 
-  this->InvokeEvent( IterationEvent() );
+  this->InvokeIterationEvent();
   return 0;
 }
 
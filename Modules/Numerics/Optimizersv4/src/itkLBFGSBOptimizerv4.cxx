@@ -16,6 +16,8 @@
  *
  *=========================================================================*/
 #include "itkLBFGSBOptimizerv4.h"
+#include "itkMultiThreaderBase.h"
+#include "vnl/algo/vnl_netlib.h"
 
 namespace itk
 {
@@ -57,6 +59,25 @@ LBFGSBOptimizerHelperv4
   m_ItkObj->m_InfinityNormOfProjectedGradient = this->get_inf_norm_projected_gradient();
   return ret;
 }
+
+namespace
+{
+/** Process the chunks of a vector operation of setulb with the multi-threader
+ * passed as instance. */
+void
+LBFGSBParallelizeVectorOperation(void * instance, v3p_netlib_lbfgsb_kernel_t kernel, void * arg,
+                                 v3p_netlib_integer numberOfChunks)
+{
+  auto * multiThreader = static_cast< MultiThreaderBase * >( instance );
+  multiThreader->ParallelizeArray( 0, static_cast< SizeValueType >( numberOfChunks ),
+    [kernel, arg](SizeValueType chunk)
+    {
+      kernel( arg, static_cast< v3p_netlib_integer >( chunk ) );
+    },
+    nullptr );
+}
+} // end anonymous namespace
+
 //-------------------------------------------------------------------------
 
 LBFGSBOptimizerv4
@@ -260,9 +281,29 @@ LBFGSBOptimizerv4
 
   this->InvokeEvent( StartEvent() );
 
+  // The vector operations of setulb on large numbers of parameters are split
+  // in chunks, which are processed with the work units of this optimizer.
+  // The results do not depend on the number of work units.
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+
+  v3p_netlib_lbfgsb_parallelize_t previousParallelize;
+  void * previousInstance;
+  v3p_netlib_lbfgsb_get_parallelize( &previousParallelize, &previousInstance );
+  v3p_netlib_lbfgsb_set_parallelize( LBFGSBParallelizeVectorOperation, multiThreader.GetPointer() );
+
   // vnl optimizers return the solution by reference
   // in the variable provided as initial position
-  m_VnlOptimizer->minimize(parameters);
+  try
+    {
+    m_VnlOptimizer->minimize(parameters);
+    }
+  catch ( ... )
+    {
+    v3p_netlib_lbfgsb_set_parallelize( previousParallelize, previousInstance );
+    throw;
+    }
+  v3p_netlib_lbfgsb_set_parallelize( previousParallelize, previousInstance );
 
   if ( parameters.GetSize() != this->GetInitialPosition().Size() )
     {
@@ -273,6 +314,7 @@ LBFGSBOptimizerv4
 
   this->m_Metric->SetParameters( parameters );
 
+  this->WaitForAsynchronousIterationObservers();
   this->InvokeEvent( EndEvent() );
 }
 
@@ -201,5 +201,6 @@ LBFGSOptimizerv4
     }
 
   this->m_Metric->SetParameters( parameters );
+  this->WaitForAsynchronousIterationObservers();
 }
 } // end namespace itk
@@ -116,7 +116,7 @@ SingleValuedNonLinearVnlOptimizerv4
   this->m_CurrentMetricValue = adaptor->GetCachedValue();
   this->m_CachedDerivative = adaptor->GetCachedDerivative();
   this->m_CachedCurrentPosition = adaptor->GetCachedCurrentParameters();
-  this->InvokeEvent(event);
+  this->InvokeIterationEvent(event);
 }
 
 void
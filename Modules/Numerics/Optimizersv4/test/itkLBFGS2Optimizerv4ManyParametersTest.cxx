@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLBFGS2Optimizerv4.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Minimize a quadratic with many parameters, large enough for the vector
+ * operations of the optimizer to be split in several chunks, with one and
+ * with several work units, and check that both runs give the same result.
+ *
+ *   f(x) = 1/2 sum_i a_i ( x_i - c_i )^2 + 1/2 sum_i ( x_{i+1} - x_i )^2
+ */
+namespace
+{
+class LBFGS2ManyParametersTestMetric : public itk::ObjectToObjectMetricBase
+{
+public:
+  using Self = LBFGS2ManyParametersTestMetric;
+  using Superclass = itk::ObjectToObjectMetricBase;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+  itkNewMacro( Self );
+  itkTypeMacro( LBFGS2ManyParametersTestMetric, ObjectToObjectMetricBase );
+
+  static constexpr unsigned int NumberOfParameters = 100000;
+
+  LBFGS2ManyParametersTestMetric()
+  {
+    m_Parameters.SetSize( NumberOfParameters );
+    m_Parameters.Fill( 0.0 );
+  }
+
+  void Initialize() throw ( itk::ExceptionObject ) override {}
+
+  MeasureType GetValue() const override
+  {
+    MeasureType value;
+    DerivativeType derivative;
+    GetValueAndDerivative( value, derivative );
+    return value;
+  }
+
+  void GetDerivative( DerivativeType & derivative ) const override
+  {
+    MeasureType value;
+    GetValueAndDerivative( value, derivative );
+  }
+
+  void GetValueAndDerivative( MeasureType & value, DerivativeType & derivative ) const override
+  {
+    derivative.SetSize( NumberOfParameters );
+    value = 0.0;
+    for( unsigned int i = 0; i < NumberOfParameters; ++i )
+      {
+      const double a = 1.0 + ( i % 7 );
+      const double c = std::sin( 0.001 * i );
+      const double r = m_Parameters[i] - c;
+      value += 0.5 * a * r * r;
+      double gradient = a * r;
+      if( i + 1 < NumberOfParameters )
+        {
+        const double dx = m_Parameters[i + 1] - m_Parameters[i];
+        value += 0.5 * dx * dx;
+        gradient -= dx;
+        }
+      if( i > 0 )
+        {
+        gradient += m_Parameters[i] - m_Parameters[i - 1];
+        }
+      // v4 metrics return the negated gradient.
+      derivative[i] = -gradient;
+      }
+  }
+
+  NumberOfParametersType GetNumberOfLocalParameters() const override { return NumberOfParameters; }
+  NumberOfParametersType GetNumberOfParameters() const override { return NumberOfParameters; }
+  bool HasLocalSupport() const override { return false; }
+  void SetParameters( ParametersType & parameters ) override { m_Parameters = parameters; }
+  const ParametersType & GetParameters() const override { return m_Parameters; }
+  void UpdateTransformParameters( const DerivativeType &, ParametersValueType ) override {}
+
+private:
+  ParametersType m_Parameters;
+};
+
+itk::LBFGS2Optimizerv4::ParametersType
+RunLBFGS2ManyParameters( itk::ThreadIdType numberOfWorkUnits, itk::SizeValueType & numberOfIterations,
+  double & value )
+{
+  LBFGS2ManyParametersTestMetric::Pointer metric = LBFGS2ManyParametersTestMetric::New();
+
+  itk::LBFGS2Optimizerv4::Pointer optimizer = itk::LBFGS2Optimizerv4::New();
+  optimizer->SetMetric( metric );
+  optimizer->SetNumberOfWorkUnits( numberOfWorkUnits );
+  optimizer->SetMaximumIterations( 200 );
+  optimizer->SetSolutionAccuracy( 1e-6 );
+  optimizer->StartOptimization();
+
+  std::cout << numberOfWorkUnits << " work units: " << optimizer->GetStopConditionDescription()
+            << " after " << optimizer->GetCurrentIteration() << " iterations, value "
+            << optimizer->GetValue() << std::endl;
+  numberOfIterations = optimizer->GetCurrentIteration();
+  value = optimizer->GetValue();
+  return metric->GetParameters();
+}
+}
+
+int itkLBFGS2Optimizerv4ManyParametersTest( int, char *[] )
+{
+  itk::SizeValueType sequentialIterations;
+  itk::SizeValueType parallelIterations;
+  double sequentialValue;
+  double parallelValue;
+  itk::LBFGS2Optimizerv4::ParametersType sequentialPosition;
+  itk::LBFGS2Optimizerv4::ParametersType parallelPosition;
+  TRY_EXPECT_NO_EXCEPTION( sequentialPosition = RunLBFGS2ManyParameters( 1, sequentialIterations, sequentialValue ) );
+  TRY_EXPECT_NO_EXCEPTION( parallelPosition = RunLBFGS2ManyParameters( 4, parallelIterations, parallelValue ) );
+
+  // The reductions are summed in the same order whatever the number of work units.
+  TEST_EXPECT_EQUAL( sequentialIterations, parallelIterations );
+  TEST_EXPECT_EQUAL( sequentialValue, parallelValue );
+  TEST_EXPECT_TRUE( sequentialPosition == parallelPosition );
+
+  // The minimum is close to the targets, smoothed by the coupling term.
+  double maximumDifference = 0.0;
+  for( unsigned int i = 0; i < sequentialPosition.GetSize(); ++i )
+    {
+    maximumDifference = std::max( maximumDifference, std::fabs( sequentialPosition[i] - std::sin( 0.001 * i ) ) );
+    }
+  std::cout << "Maximum difference to the targets: " << maximumDifference << std::endl;
+  TEST_EXPECT_TRUE( maximumDifference < 1e-2 );
+
+  return EXIT_SUCCESS;
+}
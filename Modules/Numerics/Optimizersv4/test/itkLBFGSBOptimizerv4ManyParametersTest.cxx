@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkLBFGSBOptimizerv4.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Minimize an unbounded quadratic with many parameters, large enough for the
+ * vector operations of the optimizer to be split in several chunks, with one
+ * and with several work units, and check that both runs give the same result.
+ *
+ *   f(x) = 1/2 sum_i a_i ( x_i - c_i )^2 + 1/2 sum_i ( x_{i+1} - x_i )^2
+ */
+namespace
+{
+class LBFGSBManyParametersTestMetric : public itk::ObjectToObjectMetricBase
+{
+public:
+  using Self = LBFGSBManyParametersTestMetric;
+  using Superclass = itk::ObjectToObjectMetricBase;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+  itkNewMacro( Self );
+  itkTypeMacro( LBFGSBManyParametersTestMetric, ObjectToObjectMetricBase );
+
+  static constexpr unsigned int NumberOfParameters = 100000;
+
+  LBFGSBManyParametersTestMetric()
+  {
+    m_Parameters.SetSize( NumberOfParameters );
+    m_Parameters.Fill( 0.0 );
+  }
+
+  void Initialize() throw ( itk::ExceptionObject ) override {}
+
+  MeasureType GetValue() const override
+  {
+    MeasureType value;
+    DerivativeType derivative;
+    GetValueAndDerivative( value, derivative );
+    return value;
+  }
+
+  void GetDerivative( DerivativeType & derivative ) const override
+  {
+    MeasureType value;
+    GetValueAndDerivative( value, derivative );
+  }
+
+  void GetValueAndDerivative( MeasureType & value, DerivativeType & derivative ) const override
+  {
+    derivative.SetSize( NumberOfParameters );
+    value = 0.0;
+    for( unsigned int i = 0; i < NumberOfParameters; ++i )
+      {
+      const double a = 1.0 + ( i % 7 );
+      const double c = std::sin( 0.001 * i );
+      const double r = m_Parameters[i] - c;
+      value += 0.5 * a * r * r;
+      double gradient = a * r;
+      if( i + 1 < NumberOfParameters )
+        {
+        const double dx = m_Parameters[i + 1] - m_Parameters[i];
+        value += 0.5 * dx * dx;
+        gradient -= dx;
+        }
+      if( i > 0 )
+        {
+        gradient += m_Parameters[i] - m_Parameters[i - 1];
+        }
+      // v4 metrics return the negated gradient.
+      derivative[i] = -gradient;
+      }
+  }
+
+  NumberOfParametersType GetNumberOfLocalParameters() const override { return NumberOfParameters; }
+  NumberOfParametersType GetNumberOfParameters() const override { return NumberOfParameters; }
+  bool HasLocalSupport() const override { return false; }
+  void SetParameters( ParametersType & parameters ) override { m_Parameters = parameters; }
+  const ParametersType & GetParameters() const override { return m_Parameters; }
+  void UpdateTransformParameters( const DerivativeType &, ParametersValueType ) override {}
+
+private:
+  ParametersType m_Parameters;
+};
+
+itk::LBFGSBOptimizerv4::ParametersType
+RunLBFGSBManyParameters( itk::ThreadIdType numberOfWorkUnits, itk::SizeValueType & numberOfIterations,
+  double & value )
+{
+  LBFGSBManyParametersTestMetric::Pointer metric = LBFGSBManyParametersTestMetric::New();
+
+  itk::LBFGSBOptimizerv4::Pointer optimizer = itk::LBFGSBOptimizerv4::New();
+  optimizer->SetMetric( metric );
+  optimizer->SetNumberOfWorkUnits( numberOfWorkUnits );
+  optimizer->SetInitialPosition( metric->GetParameters() );
+  optimizer->SetNumberOfIterations( 200 );
+  optimizer->SetMaximumNumberOfFunctionEvaluations( 400 );
+  optimizer->SetCostFunctionConvergenceFactor( 1e7 );
+  optimizer->SetGradientConvergenceTolerance( 1e-5 );
+
+  // Unbounded parameters.
+  itk::LBFGSBOptimizerv4::BoundSelectionType boundSelection( LBFGSBManyParametersTestMetric::NumberOfParameters );
+  boundSelection.Fill( itk::LBFGSBOptimizerv4::UNBOUNDED );
+  optimizer->SetBoundSelection( boundSelection );
+  optimizer->StartOptimization();
+
+  std::cout << numberOfWorkUnits << " work units: " << optimizer->GetStopConditionDescription()
+            << " after " << optimizer->GetCurrentIteration() << " iterations, value "
+            << optimizer->GetValue() << std::endl;
+  numberOfIterations = optimizer->GetCurrentIteration();
+  value = optimizer->GetValue();
+  return metric->GetParameters();
+}
+}
+
+int itkLBFGSBOptimizerv4ManyParametersTest( int, char *[] )
+{
+  itk::SizeValueType sequentialIterations;
+  itk::SizeValueType parallelIterations;
+  double sequentialValue;
+  double parallelValue;
+  itk::LBFGSBOptimizerv4::ParametersType sequentialPosition;
+  itk::LBFGSBOptimizerv4::ParametersType parallelPosition;
+  TRY_EXPECT_NO_EXCEPTION( sequentialPosition = RunLBFGSBManyParameters( 1, sequentialIterations, sequentialValue ) );
+  TRY_EXPECT_NO_EXCEPTION( parallelPosition = RunLBFGSBManyParameters( 4, parallelIterations, parallelValue ) );
+
+  // The reductions are summed in the same order whatever the number of work units.
+  TEST_EXPECT_EQUAL( sequentialIterations, parallelIterations );
+  TEST_EXPECT_EQUAL( sequentialValue, parallelValue );
+  TEST_EXPECT_TRUE( sequentialPosition == parallelPosition );
+
+  // The minimum is close to the targets, smoothed by the coupling term.
+  double maximumDifference = 0.0;
+  for( unsigned int i = 0; i < sequentialPosition.GetSize(); ++i )
+    {
+    maximumDifference = std::max( maximumDifference, std::fabs( sequentialPosition[i] - std::sin( 0.001 * i ) ) );
+    }
+  std::cout << "Maximum difference to the targets: " << maximumDifference << std::endl;
+  TEST_EXPECT_TRUE( maximumDifference < 1e-2 );
+
+  return EXIT_SUCCESS;
+}
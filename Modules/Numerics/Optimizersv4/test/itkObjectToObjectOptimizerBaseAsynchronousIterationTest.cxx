@@ -0,0 +1,250 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkAmoebaOptimizerv4.h"
+#include "itkGradientDescentOptimizerv4.h"
+#include "itkTestingMacros.h"
+
+#include <chrono>
+
+/*
+ * Run a gradient descent with a synchronous and a slow asynchronous
+ * iteration observer, and check that the asynchronous observer sees the
+ * same iteration states as the synchronous one.  Then check the same with a
+ * vnl based optimizer, whose iterations are reported by the cost function
+ * adaptor.
+ */
+namespace
+{
+/** 1/2 x^T A x - b^T x, as in itkGradientDescentOptimizerv4Test. */
+class AsynchronousIterationTestMetric
+  : public itk::ObjectToObjectMetricBase
+{
+public:
+  using Self = AsynchronousIterationTestMetric;
+  using Superclass = itk::ObjectToObjectMetricBase;
+  using Pointer = itk::SmartPointer<Self>;
+  using ConstPointer = itk::SmartPointer<const Self>;
+  itkNewMacro( Self );
+  itkTypeMacro( AsynchronousIterationTestMetric, ObjectToObjectMetricBase );
+
+  AsynchronousIterationTestMetric()
+  {
+    m_Parameters.SetSize( 2 );
+    m_Parameters.Fill( 0 );
+  }
+
+  void Initialize() throw ( itk::ExceptionObject ) override {}
+
+  void GetDerivative( DerivativeType & derivative ) const override
+  {
+    MeasureType value;
+    GetValueAndDerivative( value, derivative );
+  }
+
+  void GetValueAndDerivative( MeasureType & value, DerivativeType & derivative ) const override
+  {
+    derivative.SetSize( 2 );
+    const double x = m_Parameters[0];
+    const double y = m_Parameters[1];
+    value = 0.5 * ( 3 * x * x + 4 * x * y + 6 * y * y ) - 2 * x + 8 * y;
+    derivative[0] = -( 3 * x + 2 * y - 2 );
+    derivative[1] = -( 2 * x + 6 * y + 8 );
+  }
+
+  MeasureType GetValue() const override
+  {
+    MeasureType value;
+    DerivativeType derivative;
+    GetValueAndDerivative( value, derivative );
+    return value;
+  }
+
+  void UpdateTransformParameters( const DerivativeType & update, ParametersValueType ) override
+  {
+    m_Parameters += update;
+  }
+
+  unsigned int GetNumberOfParameters() const override { return 2; }
+  unsigned int GetNumberOfLocalParameters() const override { return 2; }
+  bool HasLocalSupport() const override { return false; }
+
+  void SetParameters( ParametersType & parameters ) override { m_Parameters = parameters; }
+  const ParametersType & GetParameters() const override { return m_Parameters; }
+
+private:
+  ParametersType m_Parameters;
+};
+
+using OptimizerType = itk::GradientDescentOptimizerv4;
+
+/** Record the iteration states, either from the optimizer accessors or from
+ * the asynchronous iteration state. */
+class IterationRecorderCommand : public itk::Command
+{
+public:
+  using Self = IterationRecorderCommand;
+  using Pointer = itk::SmartPointer<Self>;
+  itkNewMacro( Self );
+
+  void Execute( itk::Object *caller, const itk::EventObject & event ) override
+  {
+    Execute( (const itk::Object *)caller, event );
+  }
+
+  void Execute( const itk::Object *caller, const itk::EventObject & event ) override
+  {
+    if( !itk::IterationEvent().CheckEvent( &event ) )
+      {
+      return;
+      }
+    const auto * optimizer = dynamic_cast<const itk::ObjectToObjectOptimizerBase *>( caller );
+    if( m_Asynchronous )
+      {
+      const OptimizerType::IterationStateType & state = optimizer->GetAsynchronousIterationState();
+      m_States.push_back( state );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+      if( m_ThrowAtIteration >= 0 && state.m_Iteration == static_cast<itk::SizeValueType>( m_ThrowAtIteration ) )
+        {
+        itkGenericExceptionMacro( "Asynchronous observer failure" );
+        }
+      }
+    else
+      {
+      m_States.push_back( { optimizer->GetCurrentIteration(), optimizer->GetCurrentMetricValue(),
+        optimizer->GetCurrentPosition() } );
+      }
+  }
+
+  bool m_Asynchronous{ false };
+  int  m_ThrowAtIteration{ -1 };
+  std::vector<OptimizerType::IterationStateType> m_States;
+};
+}
+
+int itkObjectToObjectOptimizerBaseAsynchronousIterationTest( int, char *[] )
+{
+  AsynchronousIterationTestMetric::Pointer metric = AsynchronousIterationTestMetric::New();
+
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetMetric( metric );
+  optimizer->SetLearningRate( 0.1 );
+  optimizer->SetNumberOfIterations( 40 );
+  optimizer->SetDoEstimateLearningRateOnce( false );
+  optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+
+  TEST_SET_GET_VALUE( 16u, optimizer->GetAsynchronousIterationBufferSize() );
+  optimizer->SetAsynchronousIterationBufferSize( 4 );
+  TEST_SET_GET_VALUE( 4u, optimizer->GetAsynchronousIterationBufferSize() );
+  TEST_SET_GET_BOOLEAN( optimizer, CopyPositionToAsynchronousIterationState, true );
+
+  IterationRecorderCommand::Pointer synchronousRecorder = IterationRecorderCommand::New();
+  optimizer->AddObserver( itk::IterationEvent(), synchronousRecorder );
+
+  IterationRecorderCommand::Pointer asynchronousRecorder = IterationRecorderCommand::New();
+  asynchronousRecorder->m_Asynchronous = true;
+  TEST_EXPECT_TRUE( !optimizer->HasAsynchronousIterationObserver() );
+  const unsigned long tag = optimizer->AddAsynchronousIterationObserver( asynchronousRecorder );
+  TEST_EXPECT_TRUE( optimizer->HasAsynchronousIterationObserver() );
+
+  // The state is not available outside of the asynchronous observers.
+  TRY_EXPECT_EXCEPTION( optimizer->GetAsynchronousIterationState() );
+
+  TRY_EXPECT_NO_EXCEPTION( optimizer->StartOptimization() );
+
+  // All the states have been observed when the optimization returns.
+  TEST_EXPECT_EQUAL( synchronousRecorder->m_States.size(), asynchronousRecorder->m_States.size() );
+  TEST_EXPECT_EQUAL( asynchronousRecorder->m_States.size(), 40u );
+  for( size_t i = 0; i < synchronousRecorder->m_States.size(); ++i )
+    {
+    const OptimizerType::IterationStateType & expected = synchronousRecorder->m_States[i];
+    const OptimizerType::IterationStateType & observed = asynchronousRecorder->m_States[i];
+    if( expected.m_Iteration != observed.m_Iteration || expected.m_MetricValue != observed.m_MetricValue
+        || expected.m_Position != observed.m_Position )
+      {
+      std::cerr << "Iteration state " << i << " differs: " << observed.m_Iteration << " "
+                << observed.m_MetricValue << " " << observed.m_Position << " instead of "
+                << expected.m_Iteration << " " << expected.m_MetricValue << " " << expected.m_Position << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Without the position, and with a smaller buffer, which is used from the
+  // next optimization on.
+  optimizer->CopyPositionToAsynchronousIterationStateOff();
+  optimizer->SetAsynchronousIterationBufferSize( 2 );
+  asynchronousRecorder->m_States.clear();
+  OptimizerType::ParametersType start( 2 );
+  start.Fill( 0 );
+  metric->SetParameters( start );
+  TRY_EXPECT_NO_EXCEPTION( optimizer->StartOptimization() );
+  TEST_EXPECT_EQUAL( asynchronousRecorder->m_States.size(), 40u );
+  for( size_t i = 0; i < asynchronousRecorder->m_States.size(); ++i )
+    {
+    TEST_EXPECT_EQUAL( asynchronousRecorder->m_States[i].m_Iteration, synchronousRecorder->m_States[i].m_Iteration );
+    }
+  TEST_EXPECT_EQUAL( asynchronousRecorder->m_States.back().m_Position.GetSize(), 0u );
+
+  // An exception thrown by an asynchronous observer reaches the caller.
+  asynchronousRecorder->m_ThrowAtIteration = 5;
+  metric->SetParameters( start );
+  TRY_EXPECT_EXCEPTION( optimizer->StartOptimization() );
+
+  // Without asynchronous observers, nothing is buffered.
+  optimizer->RemoveAsynchronousIterationObserver( tag );
+  TEST_EXPECT_TRUE( !optimizer->HasAsynchronousIterationObserver() );
+  asynchronousRecorder->m_States.clear();
+  metric->SetParameters( start );
+  TRY_EXPECT_NO_EXCEPTION( optimizer->StartOptimization() );
+  TEST_EXPECT_EQUAL( asynchronousRecorder->m_States.size(), 0u );
+
+  // The iterations reported through the vnl cost function adaptor are also
+  // dispatched to the asynchronous observers.
+  using AmoebaOptimizerType = itk::AmoebaOptimizerv4;
+  AmoebaOptimizerType::Pointer amoebaOptimizer = AmoebaOptimizerType::New();
+  amoebaOptimizer->SetMetric( metric );
+  amoebaOptimizer->SetNumberOfIterations( 30 );
+
+  IterationRecorderCommand::Pointer amoebaSynchronousRecorder = IterationRecorderCommand::New();
+  amoebaOptimizer->AddObserver( itk::IterationEvent(), amoebaSynchronousRecorder );
+  IterationRecorderCommand::Pointer amoebaAsynchronousRecorder = IterationRecorderCommand::New();
+  amoebaAsynchronousRecorder->m_Asynchronous = true;
+  amoebaOptimizer->AddAsynchronousIterationObserver( amoebaAsynchronousRecorder );
+
+  metric->SetParameters( start );
+  TRY_EXPECT_NO_EXCEPTION( amoebaOptimizer->StartOptimization() );
+
+  TEST_EXPECT_TRUE( !amoebaSynchronousRecorder->m_States.empty() );
+  TEST_EXPECT_EQUAL( amoebaSynchronousRecorder->m_States.size(), amoebaAsynchronousRecorder->m_States.size() );
+  for( size_t i = 0; i < amoebaSynchronousRecorder->m_States.size(); ++i )
+    {
+    const OptimizerType::IterationStateType & expected = amoebaSynchronousRecorder->m_States[i];
+    const OptimizerType::IterationStateType & observed = amoebaAsynchronousRecorder->m_States[i];
+    if( expected.m_MetricValue != observed.m_MetricValue || expected.m_Position != observed.m_Position )
+      {
+      std::cerr << "Amoeba iteration state " << i << " differs: " << observed.m_MetricValue << " "
+                << observed.m_Position << " instead of " << expected.m_MetricValue << " " << expected.m_Position
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << optimizer << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -69,6 +69,7 @@ public:
 
   using InternalComputationValueType = typename Superclass::InternalComputationValueType;
   using NumberOfParametersType = typename Superclass::NumberOfParametersType;
+  using JacobianSupportIndicesType = typename Superclass::JacobianSupportIndicesType;
 
 protected:
   CorrelationImageToImageMetricv4GetValueAndDerivativeThreader();
@@ -28,7 +28,9 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader< TDomainPartitioner
 ::CorrelationImageToImageMetricv4GetValueAndDerivativeThreader() :
   m_CorrelationMetricValueDerivativePerThreadVariables( nullptr ),
   m_CorrelationAssociate( nullptr )
-{}
+{
+  this->m_SparseJacobianIsSupported = true;
+}
 
 
 template<typename TDomainPartitioner, typename TImageToImageMetric, typename TCorrelationMetric>
@@ -181,7 +183,8 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
    * then we otherwise get when exceptions are caught in MultiThreaderBase. */
   try
     {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue );
+    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].FixedInterpolatorContext.get() );
     if( pointIsValid &&
         this->m_CorrelationAssociate->GetComputeDerivative() &&
         this->m_CorrelationAssociate->GetGradientSourceIncludesFixed() )
@@ -204,7 +207,8 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
 
   try
     {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
+    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingInterpolatorContext.get() );
     if( pointIsValid &&
         this->m_CorrelationAssociate->GetComputeDerivative() &&
         this->m_CorrelationAssociate->GetGradientSourceIncludesMoving() )
@@ -290,17 +294,13 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
   if( this->m_CorrelationAssociate->GetComputeDerivative() )
     {
     /* Use a pre-allocated jacobian object for efficiency */
+    const NumberOfParametersType numberOfJacobianColumns = this->ComputeMovingTransformJacobian( virtualPoint, threadId );
     using JacobianReferenceType = typename TImageToImageMetric::JacobianType &;
     JacobianReferenceType jacobian = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobian;
-    JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
-
-    /** For dense transforms, this returns identity */
-    this->m_CorrelationAssociate->GetMovingTransform()->
-      ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                              jacobian,
-                                                              jacobianPositional);
+    const JacobianSupportIndicesType & supportIndices =
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianSupportIndices;
 
-    for (unsigned int par = 0; par < this->m_CorrelationAssociate->GetNumberOfLocalParameters(); par++)
+    for (NumberOfParametersType par = 0; par < numberOfJacobianColumns; par++)
       {
       InternalComputationValueType sum = NumericTraits< InternalComputationValueType >::ZeroValue();
       for (SizeValueType dim = 0; dim < ImageToImageMetricv4Type::MovingImageDimension; dim++)
@@ -308,8 +308,11 @@ CorrelationImageToImageMetricv4GetValueAndDerivativeThreader<TDomainPartitioner,
         sum += movingImageGradient[dim] * jacobian(dim, par);
         }
 
-      cumsum.fdm[par] += f1 * sum;
-      cumsum.mdm[par] += m1 * sum;
+      /* With the sparse Jacobian, column par holds the derivatives with
+       * respect to parameter supportIndices[par]. */
+      const NumberOfParametersType parameter = this->m_UseSparseJacobian ? supportIndices[par] : par;
+      cumsum.fdm[parameter] += f1 * sum;
+      cumsum.mdm[parameter] += m1 * sum;
       }
     }
 
@@ -117,7 +117,8 @@ TImageToImageMetric, TCorrelationMetric>
    * then we otherwise get when exceptions are caught in MultiThreaderBase. */
   try
     {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue );
+    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].FixedInterpolatorContext.get() );
     }
   catch( ExceptionObject & exc )
     {
@@ -134,7 +135,8 @@ TImageToImageMetric, TCorrelationMetric>
 
   try
     {
-    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
+    pointIsValid = this->m_CorrelationAssociate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingInterpolatorContext.get() );
     }
   catch( ExceptionObject & exc )
     {
@@ -20,6 +20,7 @@
 
 #include "itkCovariantVector.h"
 #include "itkImageFunction.h"
+#include "itkTileCachedGradientImageFunction.h"
 #include "itkObjectToObjectMetric.h"
 #include "itkInterpolateImageFunction.h"
 #include "itkSpatialObject.h"
@@ -100,13 +101,11 @@ namespace itk
  * SetFixedSampledPointSet is called or SetVirtualSampledPointSet
  * along with SetUseVirtualSampledPointSet.
  * \note If the point set is sparse, the option SetUse[Fixed|Moving]ImageGradientFilter
- * typically should be disabled to avoid excessive computation. However,
- * the gradient values of the fixed image are not cached
- * when using a point set (there are plans for this in the future), so
- * depending on the number of iterations (when used during optimization)
- * and the level of sparsity, it may be more efficient to
- * use a gradient image filter for it because it will only be
- * calculated once.
+ * typically should be disabled to avoid excessive computation.  In that case,
+ * \c Use[Fixed|Moving]ImageGradientCache can be enabled so that the gradient
+ * calculator results are cached per tile of the image (see
+ * TileCachedGradientImageFunction): only the tiles touched by the sample
+ * points are computed, and only once per call to \c Initialize.
  *
  * Vector Images
  *
@@ -286,6 +285,8 @@ public:
                                     CoordinateRepresentationType >;
   using FixedInterpolatorPointer = typename FixedInterpolatorType::Pointer;
   using MovingInterpolatorPointer = typename MovingInterpolatorType::Pointer;
+  using FixedInterpolatorEvaluationContextType = typename FixedInterpolatorType::EvaluationContext;
+  using MovingInterpolatorEvaluationContextType = typename MovingInterpolatorType::EvaluationContext;
 
   /** Image derivatives types */
   using FixedImageGradientType = typename MetricTraits::FixedImageGradientType;
@@ -342,6 +343,12 @@ public:
   using DefaultFixedImageGradientCalculator = typename MetricTraits::DefaultFixedImageGradientCalculator;
   using DefaultMovingImageGradientCalculator = typename MetricTraits::DefaultMovingImageGradientCalculator;
 
+  /** Tile-cached image gradient calculator types, wrapping the gradient calculators */
+  using FixedImageGradientCacheType = TileCachedGradientImageFunction< FixedImageType,
+    CoordinateRepresentationType, typename FixedImageGradientCalculatorType::OutputType >;
+  using MovingImageGradientCacheType = TileCachedGradientImageFunction< MovingImageType,
+    CoordinateRepresentationType, typename MovingImageGradientCalculatorType::OutputType >;
+
   /**  Type of the measure. */
   using MeasureType = typename Superclass::MeasureType;
 
@@ -464,6 +471,24 @@ public:
   itkGetConstReferenceMacro(UseMovingImageGradientFilter, bool);
   itkBooleanMacro(UseMovingImageGradientFilter);
 
+  /** Set/Get caching of the gradient calculator results, for the fixed image.
+   * Only used when the gradient filter is not used.  The gradients are
+   * computed at the grid nodes of the tiles touched by the evaluated points,
+   * shared by all threads and kept until the next call to \c Initialize with
+   * a different or modified image.  Default is false. */
+  itkSetMacro(UseFixedImageGradientCache, bool);
+  itkGetConstReferenceMacro(UseFixedImageGradientCache, bool);
+  itkBooleanMacro(UseFixedImageGradientCache);
+
+  /** Set/Get caching of the gradient calculator results, for the moving image. */
+  itkSetMacro(UseMovingImageGradientCache, bool);
+  itkGetConstReferenceMacro(UseMovingImageGradientCache, bool);
+  itkBooleanMacro(UseMovingImageGradientCache);
+
+  /** Get the tile-cached gradient calculators. */
+  itkGetModifiableObjectMacro(FixedImageGradientCache, FixedImageGradientCacheType);
+  itkGetModifiableObjectMacro(MovingImageGradientCache, MovingImageGradientCacheType);
+
   /** Get number of work units to used in the the most recent
    * evaluation.  Only valid after GetValueAndDerivative() or
    * GetValue() has been called. */
@@ -626,17 +651,22 @@ protected:
    * one is set, and that is within the fixed image buffer, in which
    * case the return value will be true.
    * Parameters \c mappedFixedPoint and \c mappedFixedPixelValue are  returned.
+   * When the calling thread owns an evaluation context of the fixed
+   * interpolator, it is passed in \c interpolatorContext and used for the
+   * interpolation.
    */
   bool TransformAndEvaluateFixedPoint(
                          const VirtualPointType & virtualPoint,
                          FixedImagePointType & mappedFixedPoint,
-                         FixedImagePixelType & mappedFixedPixelValue ) const;
+                         FixedImagePixelType & mappedFixedPixelValue,
+                         FixedInterpolatorEvaluationContextType * interpolatorContext = nullptr ) const;
 
   /** Transform and evaluate a point from VirtualImage domain to MovingImage domain. */
   bool TransformAndEvaluateMovingPoint(
                          const VirtualPointType & virtualPoint,
                          MovingImagePointType & mappedMovingPoint,
-                         MovingImagePixelType & mappedMovingPixelValue ) const;
+                         MovingImagePixelType & mappedMovingPixelValue,
+                         MovingInterpolatorEvaluationContextType * interpolatorContext = nullptr ) const;
 
   /** Compute image derivatives for a Fixed point. */
   virtual void ComputeFixedImageGradientAtPoint( const FixedImagePointType & mappedPoint, FixedImageGradientType & gradient ) const;
@@ -710,6 +740,12 @@ protected:
   FixedImageGradientCalculatorPointer   m_FixedImageGradientCalculator;
   MovingImageGradientCalculatorPointer  m_MovingImageGradientCalculator;
 
+  /** Flags and caches for the gradient calculator results */
+  bool                                                    m_UseFixedImageGradientCache;
+  bool                                                    m_UseMovingImageGradientCache;
+  typename FixedImageGradientCacheType::Pointer           m_FixedImageGradientCache;
+  typename MovingImageGradientCacheType::Pointer          m_MovingImageGradientCache;
+
   /** Derivative results holder. User a raw pointer so we can point it
    * to a user-provided object. This is used in internal methods so
    * the user-provided variable does not have to be passed around. It also enables
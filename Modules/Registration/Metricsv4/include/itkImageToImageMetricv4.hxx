@@ -60,6 +60,12 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   this->m_DefaultMovingImageGradientCalculator->UseImageDirectionOn();
   this->m_MovingImageGradientCalculator = this->m_DefaultMovingImageGradientCalculator;
 
+  /* Gradient caches are only used on request */
+  this->m_UseFixedImageGradientCache = false;
+  this->m_UseMovingImageGradientCache = false;
+  this->m_FixedImageGradientCache = FixedImageGradientCacheType::New();
+  this->m_MovingImageGradientCache = MovingImageGradientCacheType::New();
+
   /* Setup default options assuming dense-sampling */
   this->m_UseFixedImageGradientFilter  = true;
   this->m_UseMovingImageGradientFilter = true;
@@ -156,12 +162,22 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
     itkDebugMacro("Initialize FixedImageGradientCalculator");
     this->m_FixedImageGradientImage = nullptr;
     this->m_FixedImageGradientCalculator->SetInputImage(this->m_FixedImage);
+    if( this->m_UseFixedImageGradientCache )
+      {
+      this->m_FixedImageGradientCache->SetGradientCalculator(this->m_FixedImageGradientCalculator);
+      this->m_FixedImageGradientCache->SetInputImage(this->m_FixedImage);
+      }
     }
   if( ! this->m_UseMovingImageGradientFilter )
     {
     itkDebugMacro("Initialize MovingImageGradientCalculator");
     this->m_MovingImageGradientImage = nullptr;
     this->m_MovingImageGradientCalculator->SetInputImage(this->m_MovingImage);
+    if( this->m_UseMovingImageGradientCache )
+      {
+      this->m_MovingImageGradientCache->SetGradientCalculator(this->m_MovingImageGradientCalculator);
+      this->m_MovingImageGradientCache->SetInputImage(this->m_MovingImage);
+      }
     }
 
   /* Initialize default gradient image filters. */
@@ -281,7 +297,8 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
 ::TransformAndEvaluateFixedPoint(
                          const VirtualPointType & virtualPoint,
                          FixedImagePointType & mappedFixedPoint,
-                         FixedImagePixelType & mappedFixedPixelValue ) const
+                         FixedImagePixelType & mappedFixedPixelValue,
+                         FixedInterpolatorEvaluationContextType * interpolatorContext ) const
 {
   bool pointIsValid = true;
   mappedFixedPixelValue = NumericTraits<FixedImagePixelType>::ZeroValue();
@@ -307,7 +324,14 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   // Evaluate
   if( pointIsValid )
     {
-    mappedFixedPixelValue = this->m_FixedInterpolator->Evaluate(mappedFixedPoint);
+    if( interpolatorContext )
+      {
+      mappedFixedPixelValue = this->m_FixedInterpolator->EvaluateWithContext( mappedFixedPoint, *interpolatorContext );
+      }
+    else
+      {
+      mappedFixedPixelValue = this->m_FixedInterpolator->Evaluate(mappedFixedPoint);
+      }
     }
 
   return pointIsValid;
@@ -319,7 +343,8 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
 ::TransformAndEvaluateMovingPoint(
                          const VirtualPointType & virtualPoint,
                          MovingImagePointType & mappedMovingPoint,
-                         MovingImagePixelType & mappedMovingPixelValue ) const
+                         MovingImagePixelType & mappedMovingPixelValue,
+                         MovingInterpolatorEvaluationContextType * interpolatorContext ) const
 {
   bool pointIsValid = true;
   mappedMovingPixelValue = NumericTraits<MovingImagePixelType>::ZeroValue();
@@ -356,7 +381,14 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   // Evaluate
   if( pointIsValid )
     {
-    mappedMovingPixelValue = this->m_MovingInterpolator->Evaluate( mappedMovingPoint );
+    if( interpolatorContext )
+      {
+      mappedMovingPixelValue = this->m_MovingInterpolator->EvaluateWithContext( mappedMovingPoint, *interpolatorContext );
+      }
+    else
+      {
+      mappedMovingPixelValue = this->m_MovingInterpolator->Evaluate( mappedMovingPoint );
+      }
     }
 
   return pointIsValid;
@@ -376,6 +408,10 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
       }
     gradient = m_FixedImageGradientInterpolator->Evaluate( mappedPoint );
     }
+  else if ( this->m_UseFixedImageGradientCache )
+    {
+    gradient = this->m_FixedImageGradientCache->Evaluate( mappedPoint );
+    }
   else
     {
     // if not using the gradient image
@@ -397,6 +433,10 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
       }
     gradient = m_MovingImageGradientInterpolator->Evaluate( mappedPoint );
     }
+  else if ( this->m_UseMovingImageGradientCache )
+    {
+    gradient = this->m_MovingImageGradientCache->Evaluate( mappedPoint );
+    }
   else
     {
     // if not using the gradient image
@@ -590,6 +630,8 @@ ImageToImageMetricv4<TFixedImage, TMovingImage, TVirtualImage, TInternalComputat
   os << indent << "ImageToImageMetricv4: " << std::endl
      << indent << "GetUseFixedImageGradientFilter: " << this->GetUseFixedImageGradientFilter() << std::endl
      << indent << "GetUseMovingImageGradientFilter: " << this->GetUseMovingImageGradientFilter() << std::endl
+     << indent << "GetUseFixedImageGradientCache: " << this->GetUseFixedImageGradientCache() << std::endl
+     << indent << "GetUseMovingImageGradientCache: " << this->GetUseMovingImageGradientCache() << std::endl
      << indent << "UseFloatingPointCorrection: " << this->GetUseFloatingPointCorrection() << std::endl
      << indent << "FloatingPointCorrectionResolution: " << this->GetFloatingPointCorrectionResolution() << std::endl;
 
@@ -86,6 +86,13 @@ public:
   using InternalComputationValueType = typename ImageToImageMetricv4Type::InternalComputationValueType;
   using NumberOfParametersType = typename ImageToImageMetricv4Type::NumberOfParametersType;
 
+  using JacobianSupportIndicesType = typename MovingTransformType::JacobianSupportIndicesType;
+
+  using FixedInterpolatorEvaluationContextPointer =
+    typename ImageToImageMetricv4Type::FixedInterpolatorType::EvaluationContextPointer;
+  using MovingInterpolatorEvaluationContextPointer =
+    typename ImageToImageMetricv4Type::MovingInterpolatorType::EvaluationContextPointer;
+
   using CompensatedDerivativeValueType = CompensatedSummation<DerivativeValueType>;
   using CompensatedDerivativeType = std::vector<CompensatedDerivativeValueType>;
 
@@ -159,11 +166,37 @@ protected:
 
 
   /** Store derivative result from a single point calculation.
+   * With the sparse Jacobian, only the first
+   * MovingTransformJacobianSupportIndices.Size() entries of the local
+   * derivatives are stored, at the corresponding parameters.
    * \warning If this method is overridden or otherwise not used
    * in a derived class, be sure to *accumulate* results. */
   virtual void StorePointDerivativeResult( const VirtualIndexType & virtualIndex,
                                            const ThreadIdType threadId );
 
+  /** Compute the Jacobian of the moving transform with respect to its
+   * parameters at \c virtualPoint into the per-thread
+   * MovingTransformJacobian, and return its number of columns.
+   *
+   * When the sparse Jacobian is used, only the columns of the parameters the
+   * point depends on are computed; their indices are stored in the
+   * per-thread MovingTransformJacobianSupportIndices and the local
+   * derivatives are resized to hold one entry per column.  Otherwise the
+   * dense Jacobian with GetNumberOfLocalParameters() columns is computed.
+   * Derived classes that compute their local derivatives from the returned
+   * columns set m_SparseJacobianIsSupported in their constructor. */
+  NumberOfParametersType ComputeMovingTransformJacobian( const VirtualPointType & virtualPoint,
+                                                         const ThreadIdType threadId ) const;
+
+  /** Whether the derived class supports the sparse Jacobian, i.e. uses
+   * ComputeMovingTransformJacobian() and StorePointDerivativeResult(). */
+  bool m_SparseJacobianIsSupported;
+
+  /** Whether the sparse Jacobian is used for the current evaluation: it is
+   * supported by the derived class and natively implemented by the global
+   * moving transform, e.g. a BSplineTransform. */
+  mutable bool m_UseSparseJacobian;
+
   struct GetValueAndDerivativePerThreadStruct
     {
     /** Intermediary threaded metric value storage. */
@@ -180,6 +213,11 @@ protected:
      * classes for efficiency. */
     JacobianType                 MovingTransformJacobian;
     JacobianType                 MovingTransformJacobianPositional;
+    /** Parameter indices of the columns of the sparse Jacobian. */
+    JacobianSupportIndicesType   MovingTransformJacobianSupportIndices;
+    /** Working space of the interpolators, owned by the thread. */
+    FixedInterpolatorEvaluationContextPointer  FixedInterpolatorContext;
+    MovingInterpolatorEvaluationContextPointer MovingInterpolatorContext;
     };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, GetValueAndDerivativePerThreadStruct,
                                             PaddedGetValueAndDerivativePerThreadStruct);
@@ -27,6 +27,8 @@ namespace itk
 template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
 ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
 ::ImageToImageMetricv4GetValueAndDerivativeThreaderBase():
+  m_SparseJacobianIsSupported( false ),
+  m_UseSparseJacobian( false ),
   m_GetValueAndDerivativePerThreadVariables( nullptr ),
   m_CachedNumberOfParameters( 0 ),
   m_CachedNumberOfLocalParameters( 0 )
@@ -51,21 +53,44 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
   // Cache some values
   this->m_CachedNumberOfParameters      = this->m_Associate->GetNumberOfParameters();
   this->m_CachedNumberOfLocalParameters = this->m_Associate->GetNumberOfLocalParameters();
+  this->m_UseSparseJacobian = this->m_SparseJacobianIsSupported &&
+    this->m_Associate->GetComputeDerivative() &&
+    this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField &&
+    this->m_Associate->m_MovingTransform->HasSparseJacobian();
 
   /* Per-thread results */
   const ThreadIdType numThreadsUsed = this->GetNumberOfWorkUnitsUsed();
   delete[] m_GetValueAndDerivativePerThreadVariables;
   this->m_GetValueAndDerivativePerThreadVariables = new AlignedGetValueAndDerivativePerThreadStruct[ numThreadsUsed ];
 
+  for (ThreadIdType i = 0; i < numThreadsUsed; ++i)
+    {
+    this->m_GetValueAndDerivativePerThreadVariables[i].FixedInterpolatorContext =
+      this->m_Associate->GetFixedInterpolator()->MakeEvaluationContext();
+    this->m_GetValueAndDerivativePerThreadVariables[i].MovingInterpolatorContext =
+      this->m_Associate->GetMovingInterpolator()->MakeEvaluationContext();
+    }
+
   if( this->m_Associate->GetComputeDerivative() )
     {
     for (ThreadIdType i = 0; i < numThreadsUsed; ++i)
       {
       /* Allocate intermediary per-thread storage used to get results from
        * derived classes */
-      this->m_GetValueAndDerivativePerThreadVariables[i].LocalDerivatives.SetSize( this->m_CachedNumberOfLocalParameters );
-      this->m_GetValueAndDerivativePerThreadVariables[i].MovingTransformJacobian.SetSize(
-        this->m_Associate->VirtualImageDimension, this->m_CachedNumberOfLocalParameters );
+      if( this->m_UseSparseJacobian )
+        {
+        /* The sparse Jacobian and local derivatives are sized on demand. */
+        this->m_GetValueAndDerivativePerThreadVariables[i].LocalDerivatives.SetSize( 0 );
+        this->m_GetValueAndDerivativePerThreadVariables[i].MovingTransformJacobian.SetSize(
+          this->m_Associate->VirtualImageDimension, 0 );
+        this->m_GetValueAndDerivativePerThreadVariables[i].MovingTransformJacobianSupportIndices.SetSize( 0 );
+        }
+      else
+        {
+        this->m_GetValueAndDerivativePerThreadVariables[i].LocalDerivatives.SetSize( this->m_CachedNumberOfLocalParameters );
+        this->m_GetValueAndDerivativePerThreadVariables[i].MovingTransformJacobian.SetSize(
+          this->m_Associate->VirtualImageDimension, this->m_CachedNumberOfLocalParameters );
+        }
       // Not pre-allocated since it may not be used
       //this->m_GetValueAndDerivativePerThreadVariables[i].MovingTransformJacobianPositional
       if ( this->m_Associate->m_MovingTransform->GetTransformCategory() == MovingTransformType::DisplacementField )
@@ -194,7 +219,8 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
    * then we otherwise get when exceptions are caught in MultiThreaderBase. */
   try
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue);
+    pointIsValid = this->m_Associate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, mappedFixedPixelValue,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].FixedInterpolatorContext.get() );
     if( pointIsValid &&
         this->m_Associate->GetComputeDerivative() &&
         this->m_Associate->GetGradientSourceIncludesFixed() )
@@ -217,7 +243,8 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
 
   try
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue );
+    pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, mappedMovingPixelValue,
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingInterpolatorContext.get() );
     if( pointIsValid &&
         this->m_Associate->GetComputeDerivative() &&
         this->m_Associate->GetGradientSourceIncludesMoving() )
@@ -280,11 +307,15 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
 {
   if ( this->m_Associate->m_MovingTransform->GetTransformCategory() != MovingTransformType::DisplacementField )
     {
-    /* Global support */
+    /* Global support. With the sparse Jacobian, only the parameters the
+     * point depends on are updated. */
+    const NumberOfParametersType numberOfLocalDerivatives = this->m_UseSparseJacobian ?
+      this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianSupportIndices.Size() :
+      this->m_CachedNumberOfParameters;
     if ( this->m_Associate->GetUseFloatingPointCorrection() )
       {
       DerivativeValueType correctionResolution = this->m_Associate->GetFloatingPointCorrectionResolution();
-      for (NumberOfParametersType p = 0; p < this->m_CachedNumberOfParameters; p++ )
+      for (NumberOfParametersType p = 0; p < numberOfLocalDerivatives; p++ )
         {
         auto test = static_cast< intmax_t >(
           this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p] * correctionResolution
@@ -292,9 +323,21 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
         this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p] = static_cast<DerivativeValueType>( test / correctionResolution );
         }
       }
-    for (NumberOfParametersType p = 0; p < this->m_CachedNumberOfParameters; p++ )
+    if ( this->m_UseSparseJacobian )
       {
-      this->m_GetValueAndDerivativePerThreadVariables[threadId].CompensatedDerivatives[p] += this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p];
+      const JacobianSupportIndicesType & supportIndices =
+        this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianSupportIndices;
+      for (NumberOfParametersType k = 0; k < numberOfLocalDerivatives; k++ )
+        {
+        this->m_GetValueAndDerivativePerThreadVariables[threadId].CompensatedDerivatives[supportIndices[k]] += this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[k];
+        }
+      }
+    else
+      {
+      for (NumberOfParametersType p = 0; p < numberOfLocalDerivatives; p++ )
+        {
+        this->m_GetValueAndDerivativePerThreadVariables[threadId].CompensatedDerivatives[p] += this->m_GetValueAndDerivativePerThreadVariables[threadId].LocalDerivatives[p];
+        }
       }
     }
   else
@@ -323,6 +366,32 @@ ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImag
     }
 }
 
+template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
+typename ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >::NumberOfParametersType
+ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
+::ComputeMovingTransformJacobian( const VirtualPointType & virtualPoint, const ThreadIdType threadId ) const
+{
+  AlignedGetValueAndDerivativePerThreadStruct & perThreadVariables = this->m_GetValueAndDerivativePerThreadVariables[threadId];
+
+  if( this->m_UseSparseJacobian )
+    {
+    this->m_Associate->m_MovingTransform->ComputeSparseJacobianWithRespectToParameters( virtualPoint,
+      perThreadVariables.MovingTransformJacobian, perThreadVariables.MovingTransformJacobianSupportIndices );
+
+    const NumberOfParametersType numberOfColumns = perThreadVariables.MovingTransformJacobianSupportIndices.Size();
+    if( perThreadVariables.LocalDerivatives.Size() < numberOfColumns )
+      {
+      perThreadVariables.LocalDerivatives.SetSize( numberOfColumns );
+      }
+    return numberOfColumns;
+    }
+
+  /** For dense transforms, this returns identity */
+  this->m_Associate->m_MovingTransform->ComputeJacobianWithRespectToParametersCachedTemporaries( virtualPoint,
+    perThreadVariables.MovingTransformJacobian, perThreadVariables.MovingTransformJacobianPositional );
+  return this->m_CachedNumberOfLocalParameters;
+}
+
 template< typename TDomainPartitioner, typename TImageToImageMetricv4 >
 bool
 ImageToImageMetricv4GetValueAndDerivativeThreaderBase< TDomainPartitioner, TImageToImageMetricv4 >
@@ -63,6 +63,11 @@ public:
 
   using InternalComputationValueType = typename JointHistogramMetricType::InternalComputationValueType;
 
+  using FixedInterpolatorEvaluationContextPointer =
+    typename JointHistogramMetricType::FixedInterpolatorType::EvaluationContextPointer;
+  using MovingInterpolatorEvaluationContextPointer =
+    typename JointHistogramMetricType::MovingInterpolatorType::EvaluationContextPointer;
+
 protected:
   JointHistogramMutualInformationComputeJointPDFThreaderBase();
   ~JointHistogramMutualInformationComputeJointPDFThreaderBase() override;
@@ -82,8 +87,11 @@ protected:
   //TODO: This needs updating
   struct JointHistogramMIPerThreadStruct
     {
-    typename JointHistogramType::Pointer JointHistogram;
-    SizeValueType                        JointHistogramCount;
+    typename JointHistogramType::Pointer       JointHistogram;
+    SizeValueType                              JointHistogramCount;
+    /** Working space of the interpolators, owned by the thread. */
+    FixedInterpolatorEvaluationContextPointer  FixedInterpolatorContext;
+    MovingInterpolatorEvaluationContextPointer MovingInterpolatorContext;
     };
   itkPadStruct( ITK_CACHE_LINE_ALIGNMENT, JointHistogramMIPerThreadStruct,
                                             PaddedJointHistogramMIPerThreadStruct);
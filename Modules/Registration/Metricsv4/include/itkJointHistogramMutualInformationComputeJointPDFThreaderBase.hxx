@@ -58,6 +58,10 @@ JointHistogramMutualInformationComputeJointPDFThreaderBase< TDomainPartitioner,
     this->m_JointHistogramMIPerThreadVariables[i].JointHistogram->Allocate();
     this->m_JointHistogramMIPerThreadVariables[i].JointHistogram->FillBuffer( NumericTraits< SizeValueType >::ZeroValue() );
     this->m_JointHistogramMIPerThreadVariables[i].JointHistogramCount = NumericTraits< SizeValueType >::ZeroValue();
+    this->m_JointHistogramMIPerThreadVariables[i].FixedInterpolatorContext =
+      this->m_Associate->GetFixedInterpolator()->MakeEvaluationContext();
+    this->m_JointHistogramMIPerThreadVariables[i].MovingInterpolatorContext =
+      this->m_Associate->GetMovingInterpolator()->MakeEvaluationContext();
     }
 }
 
@@ -76,10 +80,12 @@ JointHistogramMutualInformationComputeJointPDFThreaderBase< TDomainPartitioner,
 
   try
     {
-    pointIsValid = this->m_Associate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, fixedImageValue );
+    pointIsValid = this->m_Associate->TransformAndEvaluateFixedPoint( virtualPoint, mappedFixedPoint, fixedImageValue,
+      this->m_JointHistogramMIPerThreadVariables[threadId].FixedInterpolatorContext.get() );
     if( pointIsValid )
       {
-      pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, movingImageValue );
+      pointIsValid = this->m_Associate->TransformAndEvaluateMovingPoint( virtualPoint, mappedMovingPoint, movingImageValue,
+        this->m_JointHistogramMIPerThreadVariables[threadId].MovingInterpolatorContext.get() );
       }
     }
   catch( ExceptionObject & exc )
@@ -28,7 +28,9 @@ JointHistogramMutualInformationGetValueAndDerivativeThreader< TDomainPartitioner
 ::JointHistogramMutualInformationGetValueAndDerivativeThreader() :
   m_JointHistogramMIPerThreadVariables( nullptr ),
   m_JointAssociate( nullptr )
-{}
+{
+  this->m_SparseJacobianIsSupported = true;
+}
 
 
 template< typename TDomainPartitioner, typename TImageToImageMetric, typename TJointHistogramMetric >
@@ -153,17 +155,11 @@ JointHistogramMutualInformationGetValueAndDerivativeThreader< TDomainPartitioner
     }
 
   /* Use a pre-allocated jacobian object for efficiency */
+  const NumberOfParametersType numberOfJacobianColumns = this->ComputeMovingTransformJacobian( virtualPoint, threadId );
   using JacobianReferenceType = JacobianType &;
   JacobianReferenceType jacobian = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobian;
-  JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
-
-  /** For dense transforms, this returns identity */
-  this->m_JointAssociate->GetMovingTransform()->
-    ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                            jacobian,
-                                                            jacobianPositional);
 
-  for ( NumberOfParametersType par = 0; par < this->GetCachedNumberOfLocalParameters(); par++ )
+  for ( NumberOfParametersType par = 0; par < numberOfJacobianColumns; par++ )
     {
     InternalComputationValueType sum = NumericTraits< InternalComputationValueType >::ZeroValue();
     for ( SizeValueType dim = 0; dim < TImageToImageMetric::MovingImageDimension; dim++ )
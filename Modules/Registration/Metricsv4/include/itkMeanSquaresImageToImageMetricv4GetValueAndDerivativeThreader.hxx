@@ -55,18 +55,14 @@ MeanSquaresImageToImageMetricv4GetValueAndDerivativeThreader< TDomainPartitioner
     return true;
     }
 
-  /* Use a pre-allocated jacobian object for efficiency */
+  /* Use a pre-allocated jacobian object for efficiency. With a sparse
+   * Jacobian, only the columns of the parameters affected by the point are
+   * computed. */
+  const NumberOfParametersType numberOfJacobianColumns = this->ComputeMovingTransformJacobian( virtualPoint, threadId );
   using JacobianReferenceType = typename TImageToImageMetric::JacobianType &;
   JacobianReferenceType jacobian = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobian;
-  JacobianReferenceType jacobianPositional = this->m_GetValueAndDerivativePerThreadVariables[threadId].MovingTransformJacobianPositional;
 
-  /** For dense transforms, this returns identity */
-  this->m_Associate->GetMovingTransform()->
-    ComputeJacobianWithRespectToParametersCachedTemporaries(virtualPoint,
-                                                            jacobian,
-                                                            jacobianPositional);
-
-  for ( unsigned int par = 0; par < this->GetCachedNumberOfLocalParameters(); par++ )
+  for ( NumberOfParametersType par = 0; par < numberOfJacobianColumns; par++ )
     {
     localDerivativeReturn[par] = NumericTraits<DerivativeValueType>::ZeroValue();
     for ( unsigned int nc = 0; nc < nComponents; nc++ )
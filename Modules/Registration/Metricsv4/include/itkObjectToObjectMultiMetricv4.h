@@ -87,6 +87,15 @@ namespace itk
   * with a DisplacementFieldTransform, both Image and PointSet metrics will automatically
   * create a matching virtual domain during initialization if one has not been assigned by the user.
   *
+  * \note By default the component metrics are evaluated one after the other, each one
+  * distributing its samples over the threads and waiting for all of them before the next
+  * metric starts. With UseConcurrentMetricEvaluation on, the component metrics are evaluated
+  * concurrently, each from its own thread, so the work units of all the metrics are interleaved
+  * on the shared thread pool and a metric finishing its reduction does not leave the other
+  * threads idle. The component values and derivatives are combined in queue order afterwards,
+  * so the results are the same as with the sequential evaluation. This requires the component
+  * metrics to be independent objects, and costs one derivative array per metric.
+  *
   * \ingroup ITKMetricsv4
   */
 template<unsigned int TFixedDimension, unsigned int TMovingDimension, typename TVirtualImage = Image<double, TFixedDimension>, class TInternalComputationValueType = double >
@@ -190,6 +199,12 @@ public:
   /** Get the metrics queue */
   const MetricQueueType & GetMetricQueue() const;
 
+  /** Evaluate the component metrics concurrently rather than one after the
+   * other. Default is off. */
+  itkSetMacro(UseConcurrentMetricEvaluation, bool);
+  itkGetConstMacro(UseConcurrentMetricEvaluation, bool);
+  itkBooleanMacro(UseConcurrentMetricEvaluation);
+
   bool SupportsArbitraryVirtualDomainSamples() const override;
 
   using MetricCategoryType = typename Superclass::MetricCategoryType;
@@ -207,9 +222,15 @@ protected:
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
 private:
+  /** Evaluate all the component metrics concurrently, storing their values
+   * in m_MetricValueArray and, unless metricDerivatives is nullptr, their
+   * derivatives in metricDerivatives. */
+  void EvaluateMetricsConcurrently( DerivativeType * metricDerivatives ) const;
+
   MetricQueueType               m_MetricQueue;
   WeightsArrayType              m_MetricWeights;
   mutable MetricValueArrayType  m_MetricValueArray;
+  bool                          m_UseConcurrentMetricEvaluation{ false };
 };
 
 } //end namespace itk
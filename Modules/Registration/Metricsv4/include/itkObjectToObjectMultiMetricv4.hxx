@@ -20,6 +20,10 @@
 
 #include "itkObjectToObjectMultiMetricv4.h"
 #include "itkCompositeTransform.h"
+#include "itkPlatformMultiThreader.h"
+
+#include <exception>
+#include <vector>
 
 namespace itk
 {
@@ -227,9 +231,16 @@ typename ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtual
 ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>
 ::GetValue() const
 {
-  for (SizeValueType j = 0; j < this->GetNumberOfMetrics(); j++)
+  if( this->m_UseConcurrentMetricEvaluation )
+    {
+    this->EvaluateMetricsConcurrently( nullptr );
+    }
+  else
     {
-    this->m_MetricValueArray[j] = this->m_MetricQueue[j]->GetValue();
+    for (SizeValueType j = 0; j < this->GetNumberOfMetrics(); j++)
+      {
+      this->m_MetricValueArray[j] = this->m_MetricQueue[j]->GetValue();
+      }
     }
 
   MeasureType firstValue = this->m_MetricValueArray[0];
@@ -260,12 +271,28 @@ ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TI
   DerivativeType  metricDerivative;
   MeasureType     metricValue = NumericTraits<MeasureType>::ZeroValue();
 
+  // With concurrent evaluation, all the derivatives are computed first and
+  // combined below in the same order as the sequential evaluation.
+  std::vector<DerivativeType> metricDerivatives;
+  if( this->m_UseConcurrentMetricEvaluation )
+    {
+    metricDerivatives.resize( this->GetNumberOfMetrics() );
+    this->EvaluateMetricsConcurrently( metricDerivatives.data() );
+    }
+
   // Loop over metrics
   DerivativeValueType totalMagnitude = NumericTraits<DerivativeValueType>::ZeroValue();
   for (SizeValueType j = 0; j < this->GetNumberOfMetrics(); j++)
     {
-    this->m_MetricQueue[j]->GetValueAndDerivative( metricValue, metricDerivative);
-    this->m_MetricValueArray[j] = metricValue;
+    if( this->m_UseConcurrentMetricEvaluation )
+      {
+      metricDerivative.swap( metricDerivatives[j] );
+      }
+    else
+      {
+      this->m_MetricQueue[j]->GetValueAndDerivative( metricValue, metricDerivative);
+      this->m_MetricValueArray[j] = metricValue;
+      }
 
     DerivativeValueType magnitude = metricDerivative.magnitude();
     DerivativeValueType weightOverMagnitude = NumericTraits<DerivativeValueType>::ZeroValue();
@@ -296,6 +323,60 @@ ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TI
   this->m_Value = firstValue;
 }
 
+template<unsigned int TFixedDimension, unsigned int TMovingDimension, typename TVirtualImage, typename TInternalComputationValueType>
+void
+ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>
+::EvaluateMetricsConcurrently( DerivativeType * metricDerivatives ) const
+{
+  const SizeValueType numberOfMetrics = this->GetNumberOfMetrics();
+
+  // Some transforms, e.g. CompositeTransform, lazily update internal state
+  // when queried for their parameters. Query them all before the metrics
+  // share them between threads.
+  for (SizeValueType j = 0; j < numberOfMetrics; j++)
+    {
+    this->m_MetricQueue[j]->GetNumberOfParameters();
+    this->m_MetricQueue[j]->GetNumberOfLocalParameters();
+    }
+
+  // Each metric is evaluated from a dedicated thread rather than from the
+  // pool: the metrics parallelize their own samples on the pool, and the
+  // pool threads must not block waiting for nested work.
+  std::vector<std::exception_ptr> exceptions( numberOfMetrics );
+  PlatformMultiThreader::Pointer threader = PlatformMultiThreader::New();
+  threader->SetMaximumNumberOfThreads( static_cast<ThreadIdType>( numberOfMetrics ) );
+  threader->SetNumberOfWorkUnits( static_cast<ThreadIdType>( numberOfMetrics ) );
+  threader->ParallelizeArray( 0, numberOfMetrics,
+    [this, metricDerivatives, &exceptions]( SizeValueType j )
+      {
+      try
+        {
+        if( metricDerivatives != nullptr )
+          {
+          MeasureType metricValue = NumericTraits<MeasureType>::ZeroValue();
+          this->m_MetricQueue[j]->GetValueAndDerivative( metricValue, metricDerivatives[j] );
+          this->m_MetricValueArray[j] = metricValue;
+          }
+        else
+          {
+          this->m_MetricValueArray[j] = this->m_MetricQueue[j]->GetValue();
+          }
+        }
+      catch( ... )
+        {
+        exceptions[j] = std::current_exception();
+        }
+      }, nullptr );
+
+  for( const auto & exception : exceptions )
+    {
+    if( exception )
+      {
+      std::rethrow_exception( exception );
+      }
+    }
+}
+
 template<unsigned int TFixedDimension, unsigned int TMovingDimension, typename TVirtualImage, typename TInternalComputationValueType>
 typename ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>::MetricValueArrayType
 ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TInternalComputationValueType>
@@ -349,6 +430,7 @@ ObjectToObjectMultiMetricv4<TFixedDimension, TMovingDimension, TVirtualImage, TI
 ::PrintSelf(std::ostream & os, Indent indent) const
 {
   os << indent << "Weights of metric derivatives: " << this->m_MetricWeights << std::endl;
+  os << indent << "UseConcurrentMetricEvaluation: " << this->m_UseConcurrentMetricEvaluation << std::endl;
   os << indent << "The multivariate contains the following metrics: " << std::endl << std::endl;
   for (SizeValueType i = 0; i < this->GetNumberOfMetrics(); i++)
     {
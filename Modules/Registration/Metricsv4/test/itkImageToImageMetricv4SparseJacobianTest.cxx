@@ -0,0 +1,194 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkBSplineTransform.h"
+#include "itkCorrelationImageToImageMetricv4.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkJointHistogramMutualInformationImageToImageMetricv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Evaluate image metrics with a moving B-spline transform, once through the
+ * sparse Jacobian and once through the dense Jacobian, and check that the
+ * values and derivatives agree.
+ */
+namespace itk
+{
+/** B-spline transform that hides its sparse Jacobian, so that the metrics
+ * fall back to the dense Jacobian. */
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+class DenseJacobianBSplineTransform :
+  public BSplineTransform<TParametersValueType, NDimensions, VSplineOrder>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(DenseJacobianBSplineTransform);
+
+  using Self = DenseJacobianBSplineTransform;
+  using Superclass = BSplineTransform<TParametersValueType, NDimensions, VSplineOrder>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkNewMacro( Self );
+  itkTypeMacro( DenseJacobianBSplineTransform, BSplineTransform );
+
+  bool HasSparseJacobian() const override
+  {
+    return false;
+  }
+
+protected:
+  DenseJacobianBSplineTransform() = default;
+  ~DenseJacobianBSplineTransform() override = default;
+};
+}
+
+namespace
+{
+template<typename TImage>
+typename TImage::Pointer
+MakeSparseJacobianTestImage( double centerX, double centerY )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size.Fill( 32 );
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> It( image, image->GetLargestPossibleRegion() );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const double dx = It.GetIndex()[0] - centerX;
+    const double dy = It.GetIndex()[1] - centerY;
+    It.Set( 100.0 * std::exp( -( dx * dx + dy * dy ) / ( 2.0 * 5.0 * 5.0 ) ) );
+    }
+  return image;
+}
+
+template<typename TTransform, typename TImage>
+typename TTransform::Pointer
+MakeSparseJacobianTestTransform( const TImage *image )
+{
+  typename TTransform::Pointer transform = TTransform::New();
+
+  typename TTransform::PhysicalDimensionsType dimensions;
+  for( unsigned int d = 0; d < TImage::ImageDimension; d++ )
+    {
+    dimensions[d] = image->GetSpacing()[d] * ( image->GetLargestPossibleRegion().GetSize()[d] - 1 );
+    }
+  typename TTransform::MeshSizeType meshSize;
+  meshSize.Fill( 6 );
+
+  transform->SetTransformDomainOrigin( image->GetOrigin() );
+  transform->SetTransformDomainPhysicalDimensions( dimensions );
+  transform->SetTransformDomainMeshSize( meshSize );
+  transform->SetTransformDomainDirection( image->GetDirection() );
+
+  typename TTransform::ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int p = 0; p < parameters.Size(); p++ )
+    {
+    parameters[p] = 0.5 * std::sin( 0.3 * p );
+    }
+  transform->SetParameters( parameters );
+  return transform;
+}
+
+template<typename TMetric, typename TImage>
+bool
+CompareSparseAndDenseMetricDerivatives( const char *label, const TImage *fixedImage, const TImage *movingImage )
+{
+  constexpr unsigned int Dimension = TImage::ImageDimension;
+  using SparseTransformType = itk::BSplineTransform<double, Dimension, 3>;
+  using DenseTransformType = itk::DenseJacobianBSplineTransform<double, Dimension, 3>;
+
+  typename SparseTransformType::Pointer sparseTransform = MakeSparseJacobianTestTransform<SparseTransformType>( fixedImage );
+  typename DenseTransformType::Pointer denseTransform = MakeSparseJacobianTestTransform<DenseTransformType>( fixedImage );
+
+  typename TMetric::MeasureType values[2];
+  typename TMetric::DerivativeType derivatives[2];
+  for( unsigned int i = 0; i < 2; i++ )
+    {
+    typename TMetric::Pointer metric = TMetric::New();
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    if( i == 0 )
+      {
+      metric->SetMovingTransform( sparseTransform );
+      }
+    else
+      {
+      metric->SetMovingTransform( denseTransform );
+      }
+    metric->Initialize();
+    metric->GetValueAndDerivative( values[i], derivatives[i] );
+    }
+
+  double maxDerivative = 0.0;
+  double maxDifference = 0.0;
+  for( unsigned int p = 0; p < derivatives[0].Size(); p++ )
+    {
+    maxDerivative = std::max( maxDerivative, std::fabs( derivatives[1][p] ) );
+    maxDifference = std::max( maxDifference, std::fabs( derivatives[0][p] - derivatives[1][p] ) );
+    }
+  std::cout << label << ": value = " << values[0] << ", max derivative = " << maxDerivative
+            << ", max difference = " << maxDifference << std::endl;
+
+  if( std::fabs( values[0] - values[1] ) > 1e-10 * std::max( 1.0, std::fabs( values[1] ) ) )
+    {
+    std::cerr << label << ": the values differ (" << values[0] << " vs " << values[1] << ")." << std::endl;
+    return false;
+    }
+  if( maxDerivative == 0.0 )
+    {
+    std::cerr << label << ": the derivative vanishes." << std::endl;
+    return false;
+    }
+  if( maxDifference > 1e-10 * maxDerivative )
+    {
+    std::cerr << label << ": the sparse and dense derivatives differ." << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int itkImageToImageMetricv4SparseJacobianTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using ImageType = itk::Image<double, Dimension>;
+
+  ImageType::Pointer fixedImage = MakeSparseJacobianTestImage<ImageType>( 15.0, 16.0 );
+  ImageType::Pointer movingImage = MakeSparseJacobianTestImage<ImageType>( 17.0, 14.5 );
+
+  bool testPassed = true;
+  testPassed &= CompareSparseAndDenseMetricDerivatives<
+    itk::MeanSquaresImageToImageMetricv4<ImageType, ImageType> >( "MeanSquares", fixedImage.GetPointer(),
+      movingImage.GetPointer() );
+  testPassed &= CompareSparseAndDenseMetricDerivatives<
+    itk::CorrelationImageToImageMetricv4<ImageType, ImageType> >( "Correlation", fixedImage.GetPointer(),
+      movingImage.GetPointer() );
+  testPassed &= CompareSparseAndDenseMetricDerivatives<
+    itk::JointHistogramMutualInformationImageToImageMetricv4<ImageType, ImageType> >( "JointHistogramMI",
+      fixedImage.GetPointer(), movingImage.GetPointer() );
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
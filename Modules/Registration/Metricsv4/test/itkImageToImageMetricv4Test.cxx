@@ -546,6 +546,29 @@ int itkImageToImageMetricv4Test(int, char ** const)
       } // loop through permutations
     } // loop thru # of threads
 
+  // Test the tile-cached gradient calculators. At the grid nodes the cached
+  // gradients match the gradient calculators exactly.
+  metric->SetUseFixedImageGradientFilter( false );
+  metric->SetUseMovingImageGradientFilter( false );
+  TEST_SET_GET_BOOLEAN( metric, UseFixedImageGradientCache, true );
+  TEST_SET_GET_BOOLEAN( metric, UseMovingImageGradientCache, true );
+  ImageToImageMetricv4TestComputeIdentityTruthValues( metric, fixedImage, movingImage, truthValue, truthDerivative );
+  std::cout << "* Testing with gradient caches..." << std::endl;
+  if( ImageToImageMetricv4TestRunSingleTest( metric, truthValue, truthDerivative, imageSize * imageSize, false )
+                                                    != EXIT_SUCCESS )
+    {
+    std::cerr << "Failed with gradient caches." << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( metric->GetFixedImageGradientCache()->GetNumberOfComputedTiles() == 0 ||
+      metric->GetMovingImageGradientCache()->GetNumberOfComputedTiles() == 0 )
+    {
+    std::cerr << "Gradient caches were not used." << std::endl;
+    return EXIT_FAILURE;
+    }
+  metric->SetUseFixedImageGradientCache( false );
+  metric->SetUseMovingImageGradientCache( false );
+
 
   // Test that non-overlapping images will generate a warning
   // and return max value for metric value.
@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkObjectToObjectMultiMetricv4.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkCorrelationImageToImageMetricv4.h"
+#include "itkJointHistogramMutualInformationImageToImageMetricv4.h"
+#include "itkAffineTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Evaluate a multi-metric made of three image metrics sharing one transform,
+ * sequentially and concurrently, and check that both evaluations give the
+ * same values and derivatives.
+ */
+namespace
+{
+template<typename TImage>
+typename TImage::Pointer
+MakeConcurrentMultiMetricTestImage( double centerX, double centerY )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size.Fill( 32 );
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> It( image, image->GetLargestPossibleRegion() );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const double dx = It.GetIndex()[0] - centerX;
+    const double dy = It.GetIndex()[1] - centerY;
+    It.Set( 100.0 * std::exp( -( dx * dx + 2.0 * dy * dy ) / ( 2.0 * 5.0 * 5.0 ) ) );
+    }
+  return image;
+}
+}
+
+int itkObjectToObjectMultiMetricv4ConcurrentTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using ImageType = itk::Image<double, Dimension>;
+  using MultiMetricType = itk::ObjectToObjectMultiMetricv4<Dimension, Dimension, ImageType>;
+
+  ImageType::Pointer fixedImage = MakeConcurrentMultiMetricTestImage<ImageType>( 16.0, 16.0 );
+  ImageType::Pointer movingImage = MakeConcurrentMultiMetricTestImage<ImageType>( 17.0, 15.0 );
+
+  using TransformType = itk::AffineTransform<double, Dimension>;
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::ParametersType parameters = transform->GetParameters();
+  parameters[0] = 1.05;
+  parameters[4] = 0.5;
+  transform->SetParameters( parameters );
+
+  using MeanSquaresMetricType = itk::MeanSquaresImageToImageMetricv4<ImageType, ImageType>;
+  using CorrelationMetricType = itk::CorrelationImageToImageMetricv4<ImageType, ImageType>;
+  using MutualInformationMetricType = itk::JointHistogramMutualInformationImageToImageMetricv4<ImageType, ImageType>;
+
+  MultiMetricType::Pointer multiMetric = MultiMetricType::New();
+  TEST_SET_GET_BOOLEAN( multiMetric, UseConcurrentMetricEvaluation, false );
+
+  MeanSquaresMetricType::Pointer meanSquaresMetric = MeanSquaresMetricType::New();
+  CorrelationMetricType::Pointer correlationMetric = CorrelationMetricType::New();
+  MutualInformationMetricType::Pointer mutualInformationMetric = MutualInformationMetricType::New();
+  using ImageMetricType = itk::ImageToImageMetricv4<ImageType, ImageType>;
+  ImageMetricType * const metrics[] =
+    { meanSquaresMetric.GetPointer(), correlationMetric.GetPointer(), mutualInformationMetric.GetPointer() };
+  for( auto metric : metrics )
+    {
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetMovingTransform( transform );
+    multiMetric->AddMetric( metric );
+    }
+
+  MultiMetricType::WeightsArrayType weights( multiMetric->GetNumberOfMetrics() );
+  weights[0] = 0.5;
+  weights[1] = 1.0;
+  weights[2] = 2.0;
+  multiMetric->SetMetricWeights( weights );
+  TRY_EXPECT_NO_EXCEPTION( multiMetric->Initialize() );
+
+  MultiMetricType::MeasureType sequentialValue;
+  MultiMetricType::DerivativeType sequentialDerivative;
+  multiMetric->UseConcurrentMetricEvaluationOff();
+  TRY_EXPECT_NO_EXCEPTION( multiMetric->GetValueAndDerivative( sequentialValue, sequentialDerivative ) );
+  const MultiMetricType::MetricValueArrayType sequentialValueArray = multiMetric->GetValueArray();
+  const MultiMetricType::MeasureType sequentialGetValue = multiMetric->GetValue();
+
+  MultiMetricType::MeasureType concurrentValue;
+  MultiMetricType::DerivativeType concurrentDerivative;
+  multiMetric->UseConcurrentMetricEvaluationOn();
+  TRY_EXPECT_NO_EXCEPTION( multiMetric->GetValueAndDerivative( concurrentValue, concurrentDerivative ) );
+  const MultiMetricType::MetricValueArrayType concurrentValueArray = multiMetric->GetValueArray();
+  const MultiMetricType::MeasureType concurrentGetValue = multiMetric->GetValue();
+
+  std::cout << "Sequential values: " << sequentialValueArray << std::endl;
+  std::cout << "Concurrent values: " << concurrentValueArray << std::endl;
+  std::cout << "Sequential derivative: " << sequentialDerivative << std::endl;
+  std::cout << "Concurrent derivative: " << concurrentDerivative << std::endl;
+
+  bool testPassed = true;
+  for( unsigned int j = 0; j < multiMetric->GetNumberOfMetrics(); j++ )
+    {
+    if( !itk::Math::FloatAlmostEqual( sequentialValueArray[j], concurrentValueArray[j], 8, 1e-15 ) )
+      {
+      std::cerr << "The value of metric " << j << " differs between the evaluations." << std::endl;
+      testPassed = false;
+      }
+    }
+  if( !itk::Math::FloatAlmostEqual( sequentialValue, concurrentValue, 8, 1e-15 ) ||
+      !itk::Math::FloatAlmostEqual( sequentialGetValue, concurrentGetValue, 8, 1e-15 ) )
+    {
+    std::cerr << "The multi-metric value differs between the evaluations." << std::endl;
+    testPassed = false;
+    }
+  if( sequentialDerivative.GetSize() != concurrentDerivative.GetSize() )
+    {
+    std::cerr << "The derivatives have different sizes." << std::endl;
+    return EXIT_FAILURE;
+    }
+  for( unsigned int p = 0; p < sequentialDerivative.GetSize(); p++ )
+    {
+    if( !itk::Math::FloatAlmostEqual( sequentialDerivative[p], concurrentDerivative[p], 8, 1e-15 ) )
+      {
+      std::cerr << "The derivative differs between the evaluations at parameter " << p << "." << std::endl;
+      testPassed = false;
+      }
+    }
+
+  std::cout << multiMetric << std::endl;
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 #include "itkObjectToObjectOptimizerBase.h"
 #include "itkImageToImageMetricv4.h"
 #include "itkPointSetToPointSetMetricv4.h"
+#include "itkRegistrationImagePyramidCache.h"
 #include "itkShrinkImageFilter.h"
 #include "itkIdentityTransform.h"
 #include "itkTransformParametersAdaptorBase.h"
@@ -175,6 +176,10 @@ public:
   using ShrinkFactorsArrayType = Array<SizeValueType>;
 
   using SmoothingSigmasArrayType = Array<RealType>;
+
+  /** Type of the cache sharing the smoothed images between stages. */
+  using ImagePyramidCacheType = RegistrationImagePyramidCache<FixedImageType, MovingImageType>;
+  using ImagePyramidCachePointer = typename ImagePyramidCacheType::Pointer;
   using MetricSamplingPercentageArrayType = Array<RealType>;
 
   /** Transform adaptor type alias */
@@ -189,8 +194,20 @@ public:
   /** Weights type for the optimizer. */
   using OptimizerWeightsType = typename OptimizerType::ScalesType;
 
-  /** enum type for metric sampling strategy */
-  enum MetricSamplingStrategyType { NONE, REGULAR, RANDOM };
+  /** enum type for metric sampling strategy
+   *
+   *   \li NONE: every voxel of the virtual domain is used (dense sampling).
+   *   \li REGULAR: every k-th voxel of the virtual domain is used.
+   *   \li RANDOM: voxels are drawn uniformly at random.
+   *   \li GRADIENT_MAGNITUDE: voxels are drawn with probability proportional
+   *       to the fixed image gradient magnitude (systematic weighted sampling).
+   *   \li STRATIFIED: the fixed image intensity range is divided into
+   *       \c MetricSamplingNumberOfStrata bins and each bin receives an equal
+   *       share of the samples.
+   *   \li LOW_DISCREPANCY: samples are placed at the points of a randomly
+   *       shifted Halton sequence over the virtual domain.
+   */
+  enum MetricSamplingStrategyType { NONE, REGULAR, RANDOM, GRADIENT_MAGNITUDE, STRATIFIED, LOW_DISCREPANCY };
 
   using MetricSamplePointSetType = typename ImageMetricType::FixedSampledPointSetType;
 
@@ -286,6 +303,22 @@ public:
   virtual void SetMetricSamplingPercentagePerLevel( const MetricSamplingPercentageArrayType  &samplingPercentages );
   itkGetConstMacro( MetricSamplingPercentagePerLevel, MetricSamplingPercentageArrayType );
 
+  /**
+   * Set/Get the number of optimizer iterations after which the metric sample
+   * points are redrawn.  A value of 0 (default) keeps the same sample points
+   * for the whole level.  Only used when the metric sampling strategy is not
+   * \c NONE.
+   */
+  itkSetMacro( MetricSamplingUpdateInterval, SizeValueType );
+  itkGetConstMacro( MetricSamplingUpdateInterval, SizeValueType );
+
+  /**
+   * Set/Get the number of intensity strata used by the \c STRATIFIED metric
+   * sampling strategy.  Default = 32.
+   */
+  itkSetClampMacro( MetricSamplingNumberOfStrata, SizeValueType, 1, NumericTraits<SizeValueType>::max() );
+  itkGetConstMacro( MetricSamplingNumberOfStrata, SizeValueType );
+
   /** Set/Get the initial fixed transform. */
   itkSetGetDecoratedObjectInputMacro( FixedInitialTransform, InitialTransformType );
 
@@ -381,6 +414,16 @@ public:
   itkGetConstMacro( SmoothingSigmasAreSpecifiedInPhysicalUnits, bool );
   itkBooleanMacro( SmoothingSigmasAreSpecifiedInPhysicalUnits );
 
+  /**
+   * Set/Get the cache of smoothed fixed and moving images.  When set, the
+   * smoothed images of each level are computed concurrently at the beginning
+   * of the level and looked up in the cache, so that stages sharing the same
+   * cache, images and sigmas only smooth each image once.
+   * Default is nullptr, i.e. the images are smoothed at each level.
+   */
+  itkSetObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+  itkGetModifiableObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+
   /** Make a DataObject of the correct type to be used as the specified output. */
   using DataObjectPointerArraySizeType = ProcessObject::DataObjectPointerArraySizeType;
   using Superclass::MakeOutput;
@@ -460,6 +503,9 @@ protected:
   /** Get metric samples. */
   virtual void SetMetricSamplePoints();
 
+  /** Redraw the metric samples every \c MetricSamplingUpdateInterval iterations. */
+  virtual void UpdateMetricSamplePoints();
+
   SizeValueType                                                   m_CurrentLevel;
   SizeValueType                                                   m_NumberOfLevels;
   SizeValueType                                                   m_CurrentIteration;
@@ -484,11 +530,14 @@ protected:
   MetricPointer                                                   m_Metric;
   MetricSamplingStrategyType                                      m_MetricSamplingStrategy;
   MetricSamplingPercentageArrayType                               m_MetricSamplingPercentagePerLevel;
+  SizeValueType                                                   m_MetricSamplingUpdateInterval;
+  SizeValueType                                                   m_MetricSamplingNumberOfStrata;
   SizeValueType                                                   m_NumberOfMetrics;
   int                                                             m_FirstImageMetricIndex;
   std::vector<ShrinkFactorsPerDimensionContainerType>             m_ShrinkFactorsPerLevel;
   SmoothingSigmasArrayType                                        m_SmoothingSigmasPerLevel;
   bool                                                            m_SmoothingSigmasAreSpecifiedInPhysicalUnits;
+  ImagePyramidCachePointer                                        m_ImagePyramidCache;
 
   bool                                                            m_ReseedIterator;
   int                                                             m_RandomSeed;
@@ -509,6 +558,41 @@ private:
 
   bool                                                            m_InitializeCenterOfLinearOutputTransform;
 
+  using SamplePointType = typename MetricSamplePointSetType::PointType;
+
+  // helper functions to evaluate the fixed image at a virtual domain sample
+  // for the intensity-driven sampling strategies
+  bool GetFixedImageIndexAtVirtualPoint( const FixedImageType *, const SamplePointType &,
+    typename FixedImageType::IndexType & ) const;
+  RealType ComputeFixedImageGradientMagnitude( const FixedImageType *,
+    const typename FixedImageType::IndexType & ) const;
+
+  // virtual domain voxels drawn by the intensity-driven sampling strategies,
+  // as offsets in the virtual domain region.  They are computed once per
+  // level, so that redrawing the samples does not rescan the fixed image.
+  struct MetricSamplingCandidatesType
+    {
+    std::vector<SizeValueType> Offsets;
+    // GRADIENT_MAGNITUDE: running sum of the weights of the offsets, empty
+    // for uniform weights
+    std::vector<RealType>      CumulativeWeights;
+    // STRATIFIED: the offsets are grouped by stratum, ending at these positions
+    std::vector<SizeValueType> StrataEnds;
+    };
+
+  void ComputeMetricSamplingCandidates( const typename ImageMetricType::VirtualImageType *, const FixedImageType *,
+    MetricSamplingCandidatesType & ) const;
+
+  std::vector<MetricSamplingCandidatesType>                       m_MetricSamplingCandidates;
+
+  // radical inverse of n in the given base (Halton sequence component)
+  static RealType RadicalInverse( SizeValueType n, unsigned int base );
+
+  // smoothing sigmas of a level, in physical units, for the given image
+  template<typename TImage>
+  typename ImagePyramidCacheType::SigmaArrayType GetSmoothingSigmasInPhysicalUnits( const TImage *,
+    SizeValueType level ) const;
+
   // helper function to create the right kind of concrete transform
   template<typename TTransform>
   static void MakeOutputTransform(SmartPointer<TTransform> &ptr)
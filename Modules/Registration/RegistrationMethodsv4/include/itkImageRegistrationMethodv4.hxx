@@ -21,6 +21,7 @@
 #include "itkImageRegistrationMethodv4.h"
 
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkCommand.h"
 #include "itkGradientDescentOptimizerv4.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
@@ -28,8 +29,11 @@
 #include "itkIterationReporter.h"
 #include "itkMattesMutualInformationImageToImageMetricv4.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMinimumMaximumImageCalculator.h"
 #include "itkRegistrationParameterScalesFromPhysicalShift.h"
 
+#include <numeric>
+
 namespace itk
 {
 /**
@@ -120,6 +124,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   this->m_SmoothingSigmasPerLevel[2] = 0;
 
   this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits = true;
+  this->m_ImagePyramidCache = nullptr;
 
   this->m_ReseedIterator = false;
   this->m_RandomSeed = Statistics::MersenneTwisterRandomVariateGenerator::GetNextSeed();
@@ -128,6 +133,8 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   this->m_MetricSamplingStrategy = NONE;
   this->m_MetricSamplingPercentagePerLevel.SetSize( this->m_NumberOfLevels );
   this->m_MetricSamplingPercentagePerLevel.Fill( 1.0 );
+  this->m_MetricSamplingUpdateInterval = 0;
+  this->m_MetricSamplingNumberOfStrata = 32;
 }
 
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
@@ -585,6 +592,27 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   this->m_MovingPointSets.clear();
   this->m_MovingPointSets.resize( this->m_NumberOfMetrics );
 
+  // With a pyramid cache, the smoothed images of the current level are
+  // requested together so that they are computed concurrently (or found in
+  // the cache if a previous stage already computed them).  The images of the
+  // next levels are only computed when these levels start.
+  if( this->m_ImagePyramidCache.IsNotNull() && this->m_SmoothingSigmasPerLevel[level] > 0 )
+    {
+    for( SizeValueType n = 0; n < this->m_NumberOfMetrics; n++ )
+      {
+      if( this->m_Metric->GetMetricCategory() == MetricType::IMAGE_METRIC ||
+          ( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC &&
+            multiMetric->GetMetricQueue()[n]->GetMetricCategory() == MetricType::IMAGE_METRIC ) )
+        {
+        this->m_ImagePyramidCache->RequestSmoothedFixedImage( this->GetFixedImage( n ),
+          this->GetSmoothingSigmasInPhysicalUnits( this->GetFixedImage( n ), level ) );
+        this->m_ImagePyramidCache->RequestSmoothedMovingImage( this->GetMovingImage( n ),
+          this->GetSmoothingSigmasInPhysicalUnits( this->GetMovingImage( n ), level ) );
+        }
+      }
+    this->m_ImagePyramidCache->ComputeRequestedImages();
+    }
+
   for( SizeValueType n = 0; n < this->m_NumberOfMetrics; n++ )
     {
     this->m_FixedSmoothImages[n] = nullptr;
@@ -596,7 +624,14 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
         ( this->m_Metric->GetMetricCategory() == MetricType::MULTI_METRIC &&
           multiMetric->GetMetricQueue()[n]->GetMetricCategory() == MetricType::IMAGE_METRIC ) )
       {
-      if ( this->m_SmoothingSigmasPerLevel[level] > 0 )
+      if ( this->m_SmoothingSigmasPerLevel[level] > 0 && this->m_ImagePyramidCache.IsNotNull() )
+        {
+        this->m_FixedSmoothImages[n] = this->m_ImagePyramidCache->GetSmoothedFixedImage( this->GetFixedImage( n ),
+          this->GetSmoothingSigmasInPhysicalUnits( this->GetFixedImage( n ), level ) );
+        this->m_MovingSmoothImages[n] = this->m_ImagePyramidCache->GetSmoothedMovingImage( this->GetMovingImage( n ),
+          this->GetSmoothingSigmasInPhysicalUnits( this->GetMovingImage( n ), level ) );
+        }
+      else if ( this->m_SmoothingSigmasPerLevel[level] > 0 )
         {
         using FixedImageSmoothingFilterType = SmoothingRecursiveGaussianImageFilter<FixedImageType, FixedImageType>;
         typename FixedImageSmoothingFilterType::Pointer fixedImageSmoothingFilter = FixedImageSmoothingFilterType::New();
@@ -697,6 +732,7 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
   if( this->m_MetricSamplingStrategy != NONE )
     {
+    this->m_MetricSamplingCandidates.clear();
     this->SetMetricSamplePoints();
     }
 
@@ -805,7 +841,24 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
 
     this->m_Metric->Initialize();
 
+    unsigned long samplingObserverTag = 0;
+    const bool resampleDuringOptimization = ( this->m_MetricSamplingStrategy != NONE &&
+      this->m_MetricSamplingUpdateInterval > 0 );
+    if( resampleDuringOptimization )
+      {
+      using SamplingCommandType = SimpleMemberCommand<Self>;
+      typename SamplingCommandType::Pointer samplingCommand = SamplingCommandType::New();
+      samplingCommand->SetCallbackFunction( this, &Self::UpdateMetricSamplePoints );
+      samplingObserverTag = this->m_Optimizer->AddObserver( IterationEvent(), samplingCommand );
+      }
+
     this->m_Optimizer->StartOptimization();
+
+    if( resampleDuringOptimization )
+      {
+      this->m_Optimizer->RemoveObserver( samplingObserverTag );
+      }
+    std::vector<MetricSamplingCandidatesType>().swap( this->m_MetricSamplingCandidates );
     }
 }
 
@@ -934,13 +987,36 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
   const VirtualDomainRegionType & virtualDomainRegion = virtualImage->GetRequestedRegion();
   const typename VirtualDomainImageType::SpacingType oneThirdVirtualSpacing = virtualImage->GetSpacing() / 3.0;
 
+  const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
+  const auto requestedSampleCount = std::max( static_cast<unsigned long>( 1 ), static_cast<unsigned long>(
+    std::ceil( static_cast<RealType>( totalVirtualDomainVoxels )
+      * this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] ) ) );
+
+  // The candidates of the intensity-driven strategies are computed on the
+  // first draw of a level and reused by the redraws.
+  const bool computeCandidates = this->m_MetricSamplingCandidates.empty();
+  if( computeCandidates )
+    {
+    this->m_MetricSamplingCandidates.resize( numberOfLocalMetrics );
+    }
+
+  const auto virtualIndexAtOffset = [&virtualDomainRegion]( SizeValueType offset )
+    {
+    typename VirtualDomainImageType::IndexType virtualIndex;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      virtualIndex[d] = virtualDomainRegion.GetIndex()[d] +
+        static_cast<IndexValueType>( offset % virtualDomainRegion.GetSize()[d] );
+      offset /= virtualDomainRegion.GetSize()[d];
+      }
+    return virtualIndex;
+    };
+
   for( SizeValueType n = 0; n < numberOfLocalMetrics; n++ )
     {
     typename MetricSamplePointSetType::Pointer samplePointSet = MetricSamplePointSetType::New();
     samplePointSet->Initialize();
 
-    using SamplePointType = typename MetricSamplePointSetType::PointType;
-
     using RandomizerType = Statistics::MersenneTwisterRandomVariateGenerator;
     typename RandomizerType::Pointer randomizer = RandomizerType::New();
     if (m_ReseedIterator)
@@ -989,7 +1065,6 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
         }
       case RANDOM:
         {
-        const unsigned long totalVirtualDomainVoxels = virtualDomainRegion.GetNumberOfPixels();
         const auto sampleCount = static_cast<unsigned long>(
          static_cast<float>( totalVirtualDomainVoxels )
                * this->m_MetricSamplingPercentagePerLevel[this->m_CurrentLevel] );
@@ -1022,6 +1097,152 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
           }
         break;
         }
+      case GRADIENT_MAGNITUDE:
+        {
+        // Systematic sampling over the cumulative gradient magnitude: a single
+        // random offset followed by equally spaced thresholds, so that each voxel
+        // is selected with probability proportional to its weight while the
+        // samples remain spread over the whole domain.
+        MetricSamplingCandidatesType & candidates = this->m_MetricSamplingCandidates[n];
+        if( computeCandidates )
+          {
+          const FixedImageType * fixedImage = this->m_FixedSmoothImages[n];
+          if( !fixedImage )
+            {
+            itkExceptionMacro( "The gradient magnitude sampling strategy requires a fixed image." );
+            }
+          this->ComputeMetricSamplingCandidates( virtualImage, fixedImage, candidates );
+          }
+
+        // A constant image has no preferred location; sample uniformly.
+        const bool useUniformWeights = candidates.CumulativeWeights.empty();
+        const SizeValueType numberOfCandidates = useUniformWeights ?
+          totalVirtualDomainVoxels : candidates.Offsets.size();
+        const RealType totalWeight = useUniformWeights ?
+          static_cast<RealType>( totalVirtualDomainVoxels ) : candidates.CumulativeWeights.back();
+
+        const RealType step = totalWeight / static_cast<RealType>( requestedSampleCount );
+        RealType threshold = randomizer->GetUniformVariate( 0.0, 1.0 ) * step;
+        for( SizeValueType c = 0; c < numberOfCandidates; c++ )
+          {
+          const RealType cumulativeWeight = useUniformWeights ?
+            static_cast<RealType>( c + 1 ) : candidates.CumulativeWeights[c];
+          if( cumulativeWeight <= threshold )
+            {
+            continue;
+            }
+          while( threshold < cumulativeWeight )
+            {
+            threshold += step;
+            }
+
+          SamplePointType point;
+          virtualImage->TransformIndexToPhysicalPoint(
+            virtualIndexAtOffset( useUniformWeights ? c : candidates.Offsets[c] ), point );
+
+          // randomly perturb the point within a voxel (approximately)
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
+            }
+          if( !fixedMaskImage || fixedMaskImage->IsInsideInWorldSpace( point ) )
+            {
+            samplePointSet->SetPoint( index, point );
+            ++index;
+            }
+          }
+        break;
+        }
+      case STRATIFIED:
+        {
+        // Every stratum contributes the same number of samples, drawn without
+        // replacement.  Strata with fewer voxels than their share contribute
+        // all of their voxels.
+        MetricSamplingCandidatesType & candidates = this->m_MetricSamplingCandidates[n];
+        if( computeCandidates )
+          {
+          const FixedImageType * fixedImage = this->m_FixedSmoothImages[n];
+          if( !fixedImage )
+            {
+            itkExceptionMacro( "The stratified sampling strategy requires a fixed image." );
+            }
+          this->ComputeMetricSamplingCandidates( virtualImage, fixedImage, candidates );
+          }
+
+        const SizeValueType numberOfStrata = candidates.StrataEnds.size();
+        const auto samplesPerStratum = static_cast<SizeValueType>(
+          std::ceil( static_cast<RealType>( requestedSampleCount ) / static_cast<RealType>( numberOfStrata ) ) );
+
+        SizeValueType stratumBegin = 0;
+        for( SizeValueType s = 0; s < numberOfStrata; s++ )
+          {
+          const SizeValueType stratumSize = candidates.StrataEnds[s] - stratumBegin;
+          const SizeValueType numberOfDraws = std::min( samplesPerStratum, stratumSize );
+          for( SizeValueType k = 0; k < numberOfDraws; k++ )
+            {
+            // partial Fisher-Yates shuffle, the stratum keeps the same voxels
+            const SizeValueType selected = stratumBegin + k +
+              static_cast<SizeValueType>( randomizer->GetIntegerVariate( stratumSize - k - 1 ) );
+            std::swap( candidates.Offsets[stratumBegin + k], candidates.Offsets[selected] );
+
+            SamplePointType point;
+            virtualImage->TransformIndexToPhysicalPoint( virtualIndexAtOffset( candidates.Offsets[stratumBegin + k] ),
+              point );
+
+            // randomly perturb the point within a voxel (approximately)
+            for( unsigned int d = 0; d < ImageDimension; d++ )
+              {
+              point[d] += randomizer->GetNormalVariate() * oneThirdVirtualSpacing[d];
+              }
+            if( !fixedMaskImage || fixedMaskImage->IsInsideInWorldSpace( point ) )
+              {
+              samplePointSet->SetPoint( index, point );
+              ++index;
+              }
+            }
+          stratumBegin = candidates.StrataEnds[s];
+          }
+        break;
+        }
+      case LOW_DISCREPANCY:
+        {
+        // Halton sequence with a random (Cranley-Patterson) shift per dimension
+        // so that reseeding produces a different, equally well spread, point set.
+        static constexpr unsigned int primes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53 };
+        static_assert( ImageDimension <= sizeof( primes ) / sizeof( primes[0] ),
+          "Low discrepancy sampling is not supported for this image dimension." );
+
+        RealType shift[ImageDimension];
+        for( unsigned int d = 0; d < ImageDimension; d++ )
+          {
+          shift[d] = randomizer->GetUniformVariate( 0.0, 1.0 );
+          }
+
+        const typename VirtualDomainRegionType::IndexType & regionIndex = virtualDomainRegion.GetIndex();
+        const typename VirtualDomainRegionType::SizeType & regionSize = virtualDomainRegion.GetSize();
+
+        for( unsigned long s = 0; s < requestedSampleCount; s++ )
+          {
+          ContinuousIndex<RealType, ImageDimension> cindex;
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            RealType u = Self::RadicalInverse( s + 1, primes[d] ) + shift[d];
+            if( u >= 1.0 )
+              {
+              u -= 1.0;
+              }
+            cindex[d] = static_cast<RealType>( regionIndex[d] ) - 0.5 + u * static_cast<RealType>( regionSize[d] );
+            }
+          SamplePointType point;
+          virtualImage->TransformContinuousIndexToPhysicalPoint( cindex, point );
+          if( !fixedMaskImage || fixedMaskImage->IsInsideInWorldSpace( point ) )
+            {
+            samplePointSet->SetPoint( index, point );
+            ++index;
+            }
+          }
+        break;
+        }
       default:
         {
         itkExceptionMacro( "Invalid sampling strategy requested." );
@@ -1043,6 +1264,200 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     }
 }
 
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::UpdateMetricSamplePoints()
+{
+  if( this->m_MetricSamplingUpdateInterval > 0 &&
+      ( this->m_Optimizer->GetCurrentIteration() + 1 ) % this->m_MetricSamplingUpdateInterval == 0 )
+    {
+    this->SetMetricSamplePoints();
+    }
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+void
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::ComputeMetricSamplingCandidates( const typename ImageMetricType::VirtualImageType * virtualImage,
+  const FixedImageType * fixedImage, MetricSamplingCandidatesType & candidates ) const
+{
+  using VirtualDomainImageType = typename ImageMetricType::VirtualImageType;
+
+  candidates.Offsets.clear();
+  candidates.CumulativeWeights.clear();
+  candidates.StrataEnds.clear();
+
+  ImageRegionConstIteratorWithIndex<VirtualDomainImageType> It( virtualImage, virtualImage->GetRequestedRegion() );
+
+  if( this->m_MetricSamplingStrategy == GRADIENT_MAGNITUDE )
+    {
+    // only the voxels with a positive weight can be drawn
+    RealType totalWeight = NumericTraits<RealType>::ZeroValue();
+    SizeValueType offset = 0;
+    for( It.GoToBegin(); !It.IsAtEnd(); ++It, ++offset )
+      {
+      SamplePointType point;
+      virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+      typename FixedImageType::IndexType fixedIndex;
+      if( this->GetFixedImageIndexAtVirtualPoint( fixedImage, point, fixedIndex ) )
+        {
+        const RealType weight = this->ComputeFixedImageGradientMagnitude( fixedImage, fixedIndex );
+        if( weight > NumericTraits<RealType>::ZeroValue() )
+          {
+          totalWeight += weight;
+          candidates.Offsets.push_back( offset );
+          candidates.CumulativeWeights.push_back( totalWeight );
+          }
+        }
+      }
+    // no weights stand for uniform weights over the whole domain
+    if( totalWeight <= NumericTraits<RealType>::epsilon() )
+      {
+      std::vector<SizeValueType>().swap( candidates.Offsets );
+      std::vector<RealType>().swap( candidates.CumulativeWeights );
+      }
+    }
+  else if( this->m_MetricSamplingStrategy == STRATIFIED )
+    {
+    using CalculatorType = MinimumMaximumImageCalculator<FixedImageType>;
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage( fixedImage );
+    calculator->SetRegion( fixedImage->GetBufferedRegion() );
+    calculator->Compute();
+    const auto minimumIntensity = static_cast<RealType>( calculator->GetMinimum() );
+    const auto maximumIntensity = static_cast<RealType>( calculator->GetMaximum() );
+
+    const SizeValueType numberOfStrata = this->m_MetricSamplingNumberOfStrata;
+    const RealType strataWidth = ( maximumIntensity - minimumIntensity ) / static_cast<RealType>( numberOfStrata );
+
+    std::vector<SizeValueType> offsets;
+    std::vector<SizeValueType> strata;
+    std::vector<SizeValueType> numberOfVoxelsPerStratum( numberOfStrata, 0 );
+    SizeValueType offset = 0;
+    for( It.GoToBegin(); !It.IsAtEnd(); ++It, ++offset )
+      {
+      SamplePointType point;
+      virtualImage->TransformIndexToPhysicalPoint( It.GetIndex(), point );
+      typename FixedImageType::IndexType fixedIndex;
+      if( !this->GetFixedImageIndexAtVirtualPoint( fixedImage, point, fixedIndex ) )
+        {
+        continue;
+        }
+
+      SizeValueType stratum = 0;
+      if( strataWidth > NumericTraits<RealType>::ZeroValue() )
+        {
+        const RealType intensity = static_cast<RealType>( fixedImage->GetPixel( fixedIndex ) );
+        stratum = std::min( numberOfStrata - 1, static_cast<SizeValueType>(
+          ( intensity - minimumIntensity ) / strataWidth ) );
+        }
+      offsets.push_back( offset );
+      strata.push_back( stratum );
+      ++numberOfVoxelsPerStratum[stratum];
+      }
+
+    // group the offsets by stratum
+    candidates.StrataEnds.resize( numberOfStrata );
+    std::partial_sum( numberOfVoxelsPerStratum.begin(), numberOfVoxelsPerStratum.end(), candidates.StrataEnds.begin() );
+    std::vector<SizeValueType> positions( numberOfStrata );
+    for( SizeValueType s = 0; s < numberOfStrata; s++ )
+      {
+      positions[s] = candidates.StrataEnds[s] - numberOfVoxelsPerStratum[s];
+      }
+    candidates.Offsets.resize( offsets.size() );
+    for( SizeValueType c = 0; c < offsets.size(); c++ )
+      {
+      candidates.Offsets[positions[strata[c]]++] = offsets[c];
+      }
+    }
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+bool
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::GetFixedImageIndexAtVirtualPoint( const FixedImageType * fixedImage, const SamplePointType & virtualPoint,
+  typename FixedImageType::IndexType & fixedIndex ) const
+{
+  const InitialTransformType * fixedInitialTransform = this->GetFixedInitialTransform();
+  if( fixedInitialTransform )
+    {
+    return fixedImage->TransformPhysicalPointToIndex( fixedInitialTransform->TransformPoint( virtualPoint ), fixedIndex );
+    }
+  return fixedImage->TransformPhysicalPointToIndex( virtualPoint, fixedIndex );
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+typename ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>::RealType
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::ComputeFixedImageGradientMagnitude( const FixedImageType * fixedImage,
+  const typename FixedImageType::IndexType & fixedIndex ) const
+{
+  // Central differences, one-sided at the border of the buffered region.
+  const typename FixedImageType::RegionType & region = fixedImage->GetBufferedRegion();
+  const typename FixedImageType::SpacingType & spacing = fixedImage->GetSpacing();
+
+  RealType squaredMagnitude = NumericTraits<RealType>::ZeroValue();
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    typename FixedImageType::IndexType lower = fixedIndex;
+    typename FixedImageType::IndexType upper = fixedIndex;
+    if( lower[d] > region.GetIndex()[d] )
+      {
+      --lower[d];
+      }
+    if( upper[d] < region.GetIndex()[d] + static_cast<IndexValueType>( region.GetSize()[d] ) - 1 )
+      {
+      ++upper[d];
+      }
+    if( upper[d] == lower[d] )
+      {
+      continue;
+      }
+    const RealType derivative = ( static_cast<RealType>( fixedImage->GetPixel( upper ) )
+      - static_cast<RealType>( fixedImage->GetPixel( lower ) ) ) /
+      ( static_cast<RealType>( upper[d] - lower[d] ) * spacing[d] );
+    squaredMagnitude += derivative * derivative;
+    }
+  return std::sqrt( squaredMagnitude );
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+typename ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>::RealType
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::RadicalInverse( SizeValueType n, unsigned int base )
+{
+  const RealType inverseBase = 1.0 / static_cast<RealType>( base );
+  RealType fraction = inverseBase;
+  RealType result = NumericTraits<RealType>::ZeroValue();
+  while( n > 0 )
+    {
+    result += static_cast<RealType>( n % base ) * fraction;
+    n /= base;
+    fraction *= inverseBase;
+    }
+  return result;
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
+template<typename TImage>
+typename ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>::ImagePyramidCacheType::SigmaArrayType
+ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
+::GetSmoothingSigmasInPhysicalUnits( const TImage *image, SizeValueType level ) const
+{
+  typename ImagePyramidCacheType::SigmaArrayType sigmas;
+  sigmas.Fill( this->m_SmoothingSigmasPerLevel[level] );
+  if( !this->m_SmoothingSigmasAreSpecifiedInPhysicalUnits )
+    {
+    const typename TImage::SpacingType & spacing = image->GetSpacing();
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      sigmas[d] *= spacing[d];
+      }
+    }
+  return sigmas;
+}
+
 template<typename TFixedImage, typename TMovingImage, typename TTransform, typename TVirtualImage, typename TPointSet>
 void
 ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage, TPointSet>
@@ -1152,6 +1567,8 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     os << indent2 << "Smoothing sigmas are specified in voxel units." << std::endl;
     }
 
+  itkPrintSelfObjectMacro( ImagePyramidCache );
+
   if( this->m_OptimizerWeights.Size() > 0 )
     {
     os << indent << "Optimizers weights: " << this->m_OptimizerWeights << std::endl;
@@ -1166,6 +1583,9 @@ ImageRegistrationMethodv4<TFixedImage, TMovingImage, TTransform, TVirtualImage,
     }
   os << std::endl;
 
+  os << indent << "Metric sampling update interval: " << this->m_MetricSamplingUpdateInterval << std::endl;
+  os << indent << "Metric sampling number of strata: " << this->m_MetricSamplingNumberOfStrata << std::endl;
+
   os << indent << "ReseedIterator: " << m_ReseedIterator << std::endl;
   os << indent << "RandomSeed: " << m_RandomSeed << std::endl;
   os << indent << "CurrentRandomSeed: " << m_CurrentRandomSeed << std::endl;
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRegistrationImagePyramidCache_h
+#define itkRegistrationImagePyramidCache_h
+
+#include "itkObject.h"
+#include "itkFixedArray.h"
+#include "itkMultiThreaderBase.h"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/** \class RegistrationImagePyramidCache
+ * \brief Share the smoothed multi-resolution images between registration stages.
+ *
+ * Each level of an ImageRegistrationMethodv4 (and of its SyN, BSplineSyN and
+ * velocity field subclasses) smooths the fixed and moving images with the
+ * Gaussian sigmas of the level.  Multi-stage pipelines, e.g. rigid followed by
+ * affine followed by SyN, typically use the same images and sigmas in every
+ * stage and therefore smooth the same images several times.
+ *
+ * Setting one instance of this class on all the stages with
+ * ImageRegistrationMethodv4::SetImagePyramidCache() makes every stage reuse the
+ * smoothed images computed by the previous ones.  Images are cached by
+ * (image, modification time, smoothing sigmas in physical units).
+ *
+ * Images can either be computed on demand with GetSmoothedFixedImage() and
+ * GetSmoothedMovingImage(), or queued with RequestSmoothedFixedImage() and
+ * RequestSmoothedMovingImage() and then computed concurrently by
+ * ComputeRequestedImages().  The registration methods request the images of
+ * each level at the beginning of the level, so the images of the finer
+ * levels are not allocated while the coarser levels are optimized.
+ *
+ * The cache keeps a reference to the source images of the cached results.
+ * Call Clear() to release the memory once the pipeline is done.
+ *
+ * \ingroup ITKRegistrationMethodsv4
+ */
+template<typename TFixedImage, typename TMovingImage = TFixedImage>
+class ITK_TEMPLATE_EXPORT RegistrationImagePyramidCache
+: public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(RegistrationImagePyramidCache);
+
+  /** Standard class type aliases. */
+  using Self = RegistrationImagePyramidCache;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( RegistrationImagePyramidCache, Object );
+
+  /** Image dimension */
+  static constexpr unsigned int ImageDimension = TFixedImage::ImageDimension;
+
+  using FixedImageType = TFixedImage;
+  using FixedImageConstPointer = typename FixedImageType::ConstPointer;
+  using MovingImageType = TMovingImage;
+  using MovingImageConstPointer = typename MovingImageType::ConstPointer;
+
+  /** Gaussian smoothing sigmas, in physical units. */
+  using SigmaArrayType = FixedArray<double, ImageDimension>;
+
+  /** Return the fixed image smoothed with the given sigmas, computing it
+   * if it is not cached yet. */
+  const FixedImageType * GetSmoothedFixedImage( const FixedImageType *image, const SigmaArrayType & sigmas );
+
+  /** Return the moving image smoothed with the given sigmas, computing it
+   * if it is not cached yet. */
+  const MovingImageType * GetSmoothedMovingImage( const MovingImageType *image, const SigmaArrayType & sigmas );
+
+  /** Queue the computation of a smoothed fixed image, unless it is already
+   * cached or queued. */
+  void RequestSmoothedFixedImage( const FixedImageType *image, const SigmaArrayType & sigmas );
+
+  /** Queue the computation of a smoothed moving image, unless it is already
+   * cached or queued. */
+  void RequestSmoothedMovingImage( const MovingImageType *image, const SigmaArrayType & sigmas );
+
+  /** Compute all the queued images concurrently.  The available work units
+   * are split between the queued images. */
+  void ComputeRequestedImages();
+
+  /** Release all the cached images. */
+  void Clear();
+
+  /** Number of cached images. */
+  SizeValueType GetNumberOfCachedImages() const;
+
+  /** Number of lookups that found their image in the cache, and number of
+   * images that had to be computed. */
+  itkGetConstMacro( NumberOfHits, SizeValueType );
+  itkGetConstMacro( NumberOfMisses, SizeValueType );
+
+protected:
+  RegistrationImagePyramidCache();
+  ~RegistrationImagePyramidCache() override = default;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+  /** Cached smoothed images of one image type, keyed by source image and sigmas. */
+  template<typename TImage>
+  struct ImageStore
+    {
+    using KeyType = std::pair<const TImage *, std::vector<double> >;
+    struct EntryType
+      {
+      typename TImage::ConstPointer m_Source;
+      ModifiedTimeType              m_SourceMTime;
+      typename TImage::ConstPointer m_Output;
+      bool                          m_IsRequested;
+      };
+    std::map<KeyType, EntryType> m_Entries;
+    };
+
+  template<typename TImage>
+  const TImage * GetSmoothedImage( ImageStore<TImage> & store, const TImage *image, const SigmaArrayType & sigmas );
+
+  template<typename TImage>
+  void RequestSmoothedImage( ImageStore<TImage> & store, const TImage *image, const SigmaArrayType & sigmas );
+
+  template<typename TImage>
+  static typename TImage::ConstPointer SmoothImage( const TImage *image, const SigmaArrayType & sigmas,
+    ThreadIdType numberOfWorkUnits );
+
+  ImageStore<FixedImageType>              m_FixedImages;
+  ImageStore<MovingImageType>             m_MovingImages;
+  std::vector<std::function<void( ThreadIdType )> > m_RequestedComputations;
+  mutable std::mutex                      m_Mutex;
+
+  SizeValueType                           m_NumberOfHits;
+  SizeValueType                           m_NumberOfMisses;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRegistrationImagePyramidCache.hxx"
+#endif
+
+#endif
@@ -0,0 +1,265 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRegistrationImagePyramidCache_hxx
+#define itkRegistrationImagePyramidCache_hxx
+
+#include "itkRegistrationImagePyramidCache.h"
+#include "itkPlatformMultiThreader.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+
+namespace itk
+{
+
+template<typename TFixedImage, typename TMovingImage>
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::RegistrationImagePyramidCache() :
+  m_NumberOfHits( 0 ),
+  m_NumberOfMisses( 0 )
+{
+}
+
+template<typename TFixedImage, typename TMovingImage>
+const typename RegistrationImagePyramidCache<TFixedImage, TMovingImage>::FixedImageType *
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::GetSmoothedFixedImage( const FixedImageType *image, const SigmaArrayType & sigmas )
+{
+  return this->GetSmoothedImage( this->m_FixedImages, image, sigmas );
+}
+
+template<typename TFixedImage, typename TMovingImage>
+const typename RegistrationImagePyramidCache<TFixedImage, TMovingImage>::MovingImageType *
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::GetSmoothedMovingImage( const MovingImageType *image, const SigmaArrayType & sigmas )
+{
+  return this->GetSmoothedImage( this->m_MovingImages, image, sigmas );
+}
+
+template<typename TFixedImage, typename TMovingImage>
+void
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::RequestSmoothedFixedImage( const FixedImageType *image, const SigmaArrayType & sigmas )
+{
+  this->RequestSmoothedImage( this->m_FixedImages, image, sigmas );
+}
+
+template<typename TFixedImage, typename TMovingImage>
+void
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::RequestSmoothedMovingImage( const MovingImageType *image, const SigmaArrayType & sigmas )
+{
+  this->RequestSmoothedImage( this->m_MovingImages, image, sigmas );
+}
+
+template<typename TFixedImage, typename TMovingImage>
+template<typename TImage>
+const TImage *
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::GetSmoothedImage( ImageStore<TImage> & store, const TImage *image, const SigmaArrayType & sigmas )
+{
+  if( image == nullptr )
+    {
+    itkExceptionMacro( "The image to smooth is not set." );
+    }
+
+  const typename ImageStore<TImage>::KeyType key( image, std::vector<double>( sigmas.Begin(), sigmas.End() ) );
+  bool isRequested = false;
+    {
+    std::lock_guard<std::mutex> lock( this->m_Mutex );
+    auto it = store.m_Entries.find( key );
+    if( it != store.m_Entries.end() && it->second.m_SourceMTime == image->GetMTime() )
+      {
+      if( it->second.m_Output.IsNotNull() )
+        {
+        ++this->m_NumberOfHits;
+        return it->second.m_Output.GetPointer();
+        }
+      isRequested = it->second.m_IsRequested;
+      }
+    }
+
+  if( isRequested )
+    {
+    // The image is queued: compute it along with the other queued images.
+    this->ComputeRequestedImages();
+    return this->GetSmoothedImage( store, image, sigmas );
+    }
+
+  typename TImage::ConstPointer output = Self::SmoothImage( image, sigmas,
+    MultiThreaderBase::GetGlobalDefaultNumberOfThreads() );
+
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  typename ImageStore<TImage>::EntryType & entry = store.m_Entries[key];
+  entry.m_Source = image;
+  entry.m_SourceMTime = image->GetMTime();
+  entry.m_Output = output;
+  entry.m_IsRequested = false;
+  ++this->m_NumberOfMisses;
+  return output.GetPointer();
+}
+
+template<typename TFixedImage, typename TMovingImage>
+template<typename TImage>
+void
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::RequestSmoothedImage( ImageStore<TImage> & store, const TImage *image, const SigmaArrayType & sigmas )
+{
+  if( image == nullptr )
+    {
+    itkExceptionMacro( "The image to smooth is not set." );
+    }
+
+  const typename ImageStore<TImage>::KeyType key( image, std::vector<double>( sigmas.Begin(), sigmas.End() ) );
+  const ModifiedTimeType sourceMTime = image->GetMTime();
+
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  typename ImageStore<TImage>::EntryType & entry = store.m_Entries[key];
+  if( entry.m_Source.GetPointer() == image && entry.m_SourceMTime == sourceMTime &&
+      ( entry.m_Output.IsNotNull() || entry.m_IsRequested ) )
+    {
+    return;
+    }
+  entry.m_Source = image;
+  entry.m_SourceMTime = sourceMTime;
+  entry.m_Output = nullptr;
+  entry.m_IsRequested = true;
+
+  typename TImage::ConstPointer source = image;
+  this->m_RequestedComputations.push_back(
+    [this, &store, key, source, sourceMTime, sigmas]( ThreadIdType numberOfWorkUnits )
+      {
+      typename TImage::ConstPointer output = Self::SmoothImage( source.GetPointer(), sigmas, numberOfWorkUnits );
+
+      std::lock_guard<std::mutex> computeLock( this->m_Mutex );
+      typename ImageStore<TImage>::EntryType & computedEntry = store.m_Entries[key];
+      computedEntry.m_Source = source;
+      computedEntry.m_SourceMTime = sourceMTime;
+      computedEntry.m_Output = output;
+      computedEntry.m_IsRequested = false;
+      ++this->m_NumberOfMisses;
+      } );
+}
+
+template<typename TFixedImage, typename TMovingImage>
+void
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::ComputeRequestedImages()
+{
+  std::vector<std::function<void( ThreadIdType )> > computations;
+    {
+    std::lock_guard<std::mutex> lock( this->m_Mutex );
+    computations.swap( this->m_RequestedComputations );
+    }
+  if( computations.empty() )
+    {
+    return;
+    }
+
+  // Each image is smoothed by a multithreaded filter: split the work units
+  // between the images rather than oversubscribing the machine.
+  const auto numberOfComputations = static_cast<ThreadIdType>( computations.size() );
+  const ThreadIdType numberOfWorkUnits = std::max( MultiThreaderBase::GetGlobalDefaultNumberOfThreads() /
+    numberOfComputations, static_cast<ThreadIdType>( 1 ) );
+
+  if( numberOfComputations == 1 )
+    {
+    computations[0]( numberOfWorkUnits );
+    return;
+    }
+
+  // The filters themselves use the default (possibly pooled) threader, so the
+  // images are dispatched on dedicated threads to avoid nesting in the pool.
+  PlatformMultiThreader::Pointer threader = PlatformMultiThreader::New();
+  threader->SetMaximumNumberOfThreads( numberOfComputations );
+  threader->SetNumberOfWorkUnits( numberOfComputations );
+  threader->ParallelizeArray( 0, computations.size(),
+    [&computations, numberOfWorkUnits]( SizeValueType i )
+      {
+      computations[i]( numberOfWorkUnits );
+      }, nullptr );
+}
+
+template<typename TFixedImage, typename TMovingImage>
+template<typename TImage>
+typename TImage::ConstPointer
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::SmoothImage( const TImage *image, const SigmaArrayType & sigmas, ThreadIdType numberOfWorkUnits )
+{
+  using SmoothingFilterType = SmoothingRecursiveGaussianImageFilter<TImage, TImage>;
+  typename SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+  typename SmoothingFilterType::SigmaArrayType sigmaArray;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    sigmaArray[d] = sigmas[d];
+    }
+  smoothingFilter->SetSigmaArray( sigmaArray );
+  smoothingFilter->SetInput( image );
+  smoothingFilter->SetNumberOfWorkUnits( numberOfWorkUnits );
+  smoothingFilter->Update();
+
+  typename TImage::Pointer output = smoothingFilter->GetOutput();
+  output->DisconnectPipeline();
+  return output.GetPointer();
+}
+
+template<typename TFixedImage, typename TMovingImage>
+void
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::Clear()
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  this->m_FixedImages.m_Entries.clear();
+  this->m_MovingImages.m_Entries.clear();
+  this->m_RequestedComputations.clear();
+  this->m_NumberOfHits = 0;
+  this->m_NumberOfMisses = 0;
+  this->Modified();
+}
+
+template<typename TFixedImage, typename TMovingImage>
+SizeValueType
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::GetNumberOfCachedImages() const
+{
+  std::lock_guard<std::mutex> lock( this->m_Mutex );
+  SizeValueType numberOfCachedImages = 0;
+  for( const auto & entry : this->m_FixedImages.m_Entries )
+    {
+    numberOfCachedImages += entry.second.m_Output.IsNotNull() ? 1 : 0;
+    }
+  for( const auto & entry : this->m_MovingImages.m_Entries )
+    {
+    numberOfCachedImages += entry.second.m_Output.IsNotNull() ? 1 : 0;
+    }
+  return numberOfCachedImages;
+}
+
+template<typename TFixedImage, typename TMovingImage>
+void
+RegistrationImagePyramidCache<TFixedImage, TMovingImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Number of cached images: " << this->GetNumberOfCachedImages() << std::endl;
+  os << indent << "Number of hits: " << this->m_NumberOfHits << std::endl;
+  os << indent << "Number of misses: " << this->m_NumberOfMisses << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -185,6 +185,17 @@ public:
   itkSetMacro( GaussianSmoothingVarianceForTheTotalField, RealType );
   itkGetConstReferenceMacro( GaussianSmoothingVarianceForTheTotalField, RealType );
 
+  /**
+   * Use the fused update of the displacement fields.  The metric gradient
+   * fields are smoothed, scaled and composed with the total fields in place,
+   * and the smoothing uses a separable line convolution, instead of a chain of
+   * filters that each allocate a new field at every iteration.  The results
+   * are the same up to floating point rounding.  Default false.
+   */
+  itkSetMacro( UseFusedFieldUpdate, bool );
+  itkGetConstMacro( UseFusedFieldUpdate, bool );
+  itkBooleanMacro( UseFusedFieldUpdate );
+
   /** Get modifiable FixedToMiddle and MovingToMidle transforms to save the current state of the registration. */
   itkGetModifiableObjectMacro( FixedToMiddleTransform, OutputTransformType );
   itkGetModifiableObjectMacro( MovingToMiddleTransform, OutputTransformType );
@@ -222,6 +233,11 @@ protected:
   virtual DisplacementFieldPointer GaussianSmoothDisplacementField( const DisplacementFieldType *, const RealType );
   virtual DisplacementFieldPointer InvertDisplacementField( const DisplacementFieldType *, const DisplacementFieldType * = nullptr );
 
+  /** In-place counterparts of the field operations, used by the fused update. */
+  virtual void ScaleUpdateFieldInPlace( DisplacementFieldType * );
+  virtual void GaussianSmoothDisplacementFieldInPlace( DisplacementFieldType *, const RealType );
+  virtual void ComposeDisplacementFieldsInPlace( const DisplacementFieldType *, DisplacementFieldType * );
+
   RealType                                                        m_LearningRate{ 0.25 };
 
   OutputTransformPointer                                          m_MovingToMiddleTransform{ nullptr };
@@ -233,10 +249,14 @@ protected:
   NumberOfIterationsArrayType                                     m_NumberOfIterationsPerLevel;
   bool                                                            m_DownsampleImagesForMetricDerivatives{ true };
   bool                                                            m_AverageMidPointGradients{ false };
+  bool                                                            m_UseFusedFieldUpdate{ false };
 
 private:
   RealType                                                        m_GaussianSmoothingVarianceForTheUpdateField{ 3.0 };
   RealType                                                        m_GaussianSmoothingVarianceForTheTotalField{ 0.5 };
+
+  // copy of the unsmoothed field, reused across iterations by the in-place smoothing
+  DisplacementFieldPointer                                        m_UnsmoothedFieldBuffer{ nullptr };
 };
 } // end namespace itk
 
@@ -27,6 +27,7 @@
 #include "itkInvertDisplacementFieldImageFilter.h"
 #include "itkIterationReporter.h"
 #include "itkMultiplyImageFilter.h"
+#include "itkVectorLinearInterpolateImageFunction.h"
 #include "itkVectorNeighborhoodOperatorImageFilter.h"
 #include "itkWindowConvergenceMonitoringFunction.h"
 
@@ -171,15 +172,38 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
     MeasureType fixedMetricValue = 0.0;
     MeasureType movingMetricValue = 0.0;
 
-    DisplacementFieldPointer fixedToMiddleSmoothUpdateField = this->ComputeUpdateField(
-      this->m_FixedSmoothImages, this->m_FixedPointSets, fixedComposite,
-      this->m_MovingSmoothImages, this->m_MovingPointSets, movingComposite,
-      this->m_FixedImageMasks, this->m_MovingImageMasks, movingMetricValue );
-
-    DisplacementFieldPointer movingToMiddleSmoothUpdateField = this->ComputeUpdateField(
-      this->m_MovingSmoothImages, this->m_MovingPointSets, movingComposite,
-      this->m_FixedSmoothImages, this->m_FixedPointSets, fixedComposite,
-      this->m_MovingImageMasks, this->m_FixedImageMasks, fixedMetricValue );
+    DisplacementFieldPointer fixedToMiddleSmoothUpdateField;
+    DisplacementFieldPointer movingToMiddleSmoothUpdateField;
+    if( this->m_UseFusedFieldUpdate )
+      {
+      fixedToMiddleSmoothUpdateField = this->ComputeMetricGradientField(
+        this->m_FixedSmoothImages, this->m_FixedPointSets, fixedComposite,
+        this->m_MovingSmoothImages, this->m_MovingPointSets, movingComposite,
+        this->m_FixedImageMasks, this->m_MovingImageMasks, movingMetricValue );
+      this->GaussianSmoothDisplacementFieldInPlace( fixedToMiddleSmoothUpdateField,
+        this->m_GaussianSmoothingVarianceForTheUpdateField );
+      this->ScaleUpdateFieldInPlace( fixedToMiddleSmoothUpdateField );
+
+      movingToMiddleSmoothUpdateField = this->ComputeMetricGradientField(
+        this->m_MovingSmoothImages, this->m_MovingPointSets, movingComposite,
+        this->m_FixedSmoothImages, this->m_FixedPointSets, fixedComposite,
+        this->m_MovingImageMasks, this->m_FixedImageMasks, fixedMetricValue );
+      this->GaussianSmoothDisplacementFieldInPlace( movingToMiddleSmoothUpdateField,
+        this->m_GaussianSmoothingVarianceForTheUpdateField );
+      this->ScaleUpdateFieldInPlace( movingToMiddleSmoothUpdateField );
+      }
+    else
+      {
+      fixedToMiddleSmoothUpdateField = this->ComputeUpdateField(
+        this->m_FixedSmoothImages, this->m_FixedPointSets, fixedComposite,
+        this->m_MovingSmoothImages, this->m_MovingPointSets, movingComposite,
+        this->m_FixedImageMasks, this->m_MovingImageMasks, movingMetricValue );
+
+      movingToMiddleSmoothUpdateField = this->ComputeUpdateField(
+        this->m_MovingSmoothImages, this->m_MovingPointSets, movingComposite,
+        this->m_FixedSmoothImages, this->m_FixedPointSets, fixedComposite,
+        this->m_MovingImageMasks, this->m_FixedImageMasks, fixedMetricValue );
+      }
 
     if ( this->m_AverageMidPointGradients )
       {
@@ -193,23 +217,44 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
 
     // Add the update field to both displacement fields (from fixed/moving to middle image) and then smooth
 
-    using ComposerType = ComposeDisplacementFieldsImageFilter<DisplacementFieldType>;
+    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp;
+    DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp;
+    if( this->m_UseFusedFieldUpdate )
+      {
+      // The current total fields are replaced below by the inversion
+      // results, so they are updated in place.
+      fixedToMiddleSmoothTotalFieldTmp = this->m_FixedToMiddleTransform->GetModifiableDisplacementField();
+      fixedToMiddleSmoothTotalFieldTmp->DisconnectPipeline();
+      this->ComposeDisplacementFieldsInPlace( fixedToMiddleSmoothUpdateField, fixedToMiddleSmoothTotalFieldTmp );
+      this->GaussianSmoothDisplacementFieldInPlace( fixedToMiddleSmoothTotalFieldTmp,
+        this->m_GaussianSmoothingVarianceForTheTotalField );
+
+      movingToMiddleSmoothTotalFieldTmp = this->m_MovingToMiddleTransform->GetModifiableDisplacementField();
+      movingToMiddleSmoothTotalFieldTmp->DisconnectPipeline();
+      this->ComposeDisplacementFieldsInPlace( movingToMiddleSmoothUpdateField, movingToMiddleSmoothTotalFieldTmp );
+      this->GaussianSmoothDisplacementFieldInPlace( movingToMiddleSmoothTotalFieldTmp,
+        this->m_GaussianSmoothingVarianceForTheTotalField );
+      }
+    else
+      {
+      using ComposerType = ComposeDisplacementFieldsImageFilter<DisplacementFieldType>;
 
-    typename ComposerType::Pointer fixedComposer = ComposerType::New();
-    fixedComposer->SetDisplacementField( fixedToMiddleSmoothUpdateField );
-    fixedComposer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
-    fixedComposer->Update();
+      typename ComposerType::Pointer fixedComposer = ComposerType::New();
+      fixedComposer->SetDisplacementField( fixedToMiddleSmoothUpdateField );
+      fixedComposer->SetWarpingField( this->m_FixedToMiddleTransform->GetDisplacementField() );
+      fixedComposer->Update();
 
-    DisplacementFieldPointer fixedToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
-      fixedComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
+      fixedToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
+        fixedComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
 
-    typename ComposerType::Pointer movingComposer = ComposerType::New();
-    movingComposer->SetDisplacementField( movingToMiddleSmoothUpdateField );
-    movingComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
-    movingComposer->Update();
+      typename ComposerType::Pointer movingComposer = ComposerType::New();
+      movingComposer->SetDisplacementField( movingToMiddleSmoothUpdateField );
+      movingComposer->SetWarpingField( this->m_MovingToMiddleTransform->GetDisplacementField() );
+      movingComposer->Update();
 
-    DisplacementFieldPointer movingToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
-      movingComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
+      movingToMiddleSmoothTotalFieldTmp = this->GaussianSmoothDisplacementField(
+        movingComposer->GetOutput(), this->m_GaussianSmoothingVarianceForTheTotalField );
+      }
 
     // Iteratively estimate the inverse fields.
 
@@ -715,6 +760,209 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   return smoothField;
 }
 
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ScaleUpdateFieldInPlace( DisplacementFieldType * updateField )
+{
+  const typename DisplacementFieldType::SpacingType spacing = updateField->GetSpacing();
+  const SizeValueType numberOfPixels = updateField->GetBufferedRegion().GetNumberOfPixels();
+  DisplacementVectorType * buffer = updateField->GetBufferPointer();
+
+  RealType maxSquaredNorm = NumericTraits<RealType>::ZeroValue();
+  for( SizeValueType i = 0; i < numberOfPixels; i++ )
+    {
+    RealType localSquaredNorm = NumericTraits<RealType>::ZeroValue();
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      localSquaredNorm += itk::Math::sqr( buffer[i][d] / spacing[d] );
+      }
+    maxSquaredNorm = std::max( maxSquaredNorm, localSquaredNorm );
+    }
+
+  RealType scale = this->m_LearningRate;
+  if( maxSquaredNorm > NumericTraits<RealType>::ZeroValue() )
+    {
+    scale /= std::sqrt( maxSquaredNorm );
+    }
+
+  for( SizeValueType i = 0; i < numberOfPixels; i++ )
+    {
+    buffer[i] *= scale;
+    }
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::GaussianSmoothDisplacementFieldInPlace( DisplacementFieldType * field, const RealType variance )
+{
+  if( variance <= 0.0 )
+    {
+    return;
+    }
+
+  using RegionType = typename DisplacementFieldType::RegionType;
+  const RegionType region = field->GetBufferedRegion();
+  const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+  DisplacementVectorType * buffer = field->GetBufferPointer();
+
+  //make sure boundary does not move
+  RealType weight1 = 1.0;
+  if( variance < 0.5 )
+    {
+    weight1 = 1.0 - 1.0 * ( variance / 0.5 );
+    }
+  RealType weight2 = 1.0 - weight1;
+
+  // The unsmoothed field is only needed for the boundary blending.
+  if( weight2 > 0.0 )
+    {
+    if( this->m_UnsmoothedFieldBuffer.IsNull() || this->m_UnsmoothedFieldBuffer->GetBufferedRegion() != region )
+      {
+      this->m_UnsmoothedFieldBuffer = DisplacementFieldType::New();
+      this->m_UnsmoothedFieldBuffer->CopyInformation( field );
+      this->m_UnsmoothedFieldBuffer->SetRegions( region );
+      this->m_UnsmoothedFieldBuffer->Allocate();
+      }
+    std::copy( buffer, buffer + numberOfPixels, this->m_UnsmoothedFieldBuffer->GetBufferPointer() );
+    }
+
+  // Separable smoothing with the same kernels and zero flux Neumann boundary
+  // condition as GaussianSmoothDisplacementField().  Each line is copied into
+  // a padded, contiguous buffer and convolved component-wise.
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+    using GaussianSmoothingOperatorType = GaussianOperator<RealType, ImageDimension>;
+    GaussianSmoothingOperatorType gaussianSmoothingOperator;
+    gaussianSmoothingOperator.SetDirection( d );
+    gaussianSmoothingOperator.SetVariance( variance );
+    gaussianSmoothingOperator.SetMaximumError( 0.001 );
+    gaussianSmoothingOperator.SetMaximumKernelWidth( region.GetSize()[d] );
+    gaussianSmoothingOperator.CreateDirectional();
+
+    const auto radius = static_cast<SizeValueType>( gaussianSmoothingOperator.GetRadius( d ) );
+    std::vector<RealType> kernel( 2 * radius + 1 );
+    for( SizeValueType k = 0; k < kernel.size(); k++ )
+      {
+      kernel[k] = gaussianSmoothingOperator[k];
+      }
+
+    const SizeValueType lineLength = region.GetSize()[d];
+    const OffsetValueType stride = field->GetOffsetTable()[d];
+
+    this->GetMultiThreader()->template ParallelizeImageRegionRestrictDirection<ImageDimension>( d, region,
+      [&]( const RegionType & chunk )
+        {
+        RegionType lineStarts = chunk;
+        lineStarts.SetSize( d, 1 );
+
+        std::vector<RealType> line( ( lineLength + 2 * radius ) * ImageDimension );
+        ImageRegionConstIteratorWithIndex<DisplacementFieldType> ItL( field, lineStarts );
+        for( ItL.GoToBegin(); !ItL.IsAtEnd(); ++ItL )
+          {
+          DisplacementVectorType * pixel = buffer + field->ComputeOffset( ItL.GetIndex() );
+
+          for( SizeValueType i = 0; i < lineLength + 2 * radius; i++ )
+            {
+            const SizeValueType j = static_cast<SizeValueType>( std::min( std::max(
+              static_cast<OffsetValueType>( i ) - static_cast<OffsetValueType>( radius ),
+              static_cast<OffsetValueType>( 0 ) ), static_cast<OffsetValueType>( lineLength - 1 ) ) );
+            const DisplacementVectorType & value = pixel[j * stride];
+            for( unsigned int c = 0; c < ImageDimension; c++ )
+              {
+              line[i * ImageDimension + c] = value[c];
+              }
+            }
+
+          for( SizeValueType i = 0; i < lineLength; i++ )
+            {
+            RealType sum[ImageDimension] = {};
+            const RealType * neighborhood = &line[i * ImageDimension];
+            for( SizeValueType k = 0; k < kernel.size(); k++ )
+              {
+              for( unsigned int c = 0; c < ImageDimension; c++ )
+                {
+                sum[c] += kernel[k] * neighborhood[k * ImageDimension + c];
+                }
+              }
+            DisplacementVectorType & value = pixel[i * stride];
+            for( unsigned int c = 0; c < ImageDimension; c++ )
+              {
+              value[c] = sum[c];
+              }
+            }
+          }
+        }, nullptr );
+    }
+
+  const DisplacementVectorType zeroVector( 0.0 );
+
+  const typename DisplacementFieldType::SizeType size = region.GetSize();
+  const typename DisplacementFieldType::IndexType startIndex = region.GetIndex();
+
+  ImageRegionIteratorWithIndex<DisplacementFieldType> ItS( field, region );
+  for( ItS.GoToBegin(); !ItS.IsAtEnd(); ++ItS )
+    {
+    typename DisplacementFieldType::IndexType index = ItS.GetIndex();
+    bool isOnBoundary = false;
+    for ( unsigned int d = 0; d < ImageDimension; d++ )
+      {
+      if( index[d] == startIndex[d] || index[d] == static_cast<IndexValueType>( size[d] ) - startIndex[d] - 1 )
+        {
+        isOnBoundary = true;
+        break;
+        }
+      }
+    if( isOnBoundary )
+      {
+      ItS.Set( zeroVector );
+      }
+    else if( weight2 > 0.0 )
+      {
+      ItS.Set( ItS.Get() * weight1 +
+        this->m_UnsmoothedFieldBuffer->GetBufferPointer()[field->ComputeOffset( index )] * weight2 );
+      }
+    }
+}
+
+template<typename TFixedImage, typename TMovingImage, typename TOutputTransform, typename TVirtualImage, typename TPointSet>
+void
+SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtualImage, TPointSet>
+::ComposeDisplacementFieldsInPlace( const DisplacementFieldType * updateField, DisplacementFieldType * totalField )
+{
+  // Same as ComposeDisplacementFieldsImageFilter with the total field as the
+  // warping field: each output value only depends on the total field value at
+  // the same index, so the result can overwrite it.
+  using InterpolatorType = VectorLinearInterpolateImageFunction<DisplacementFieldType, RealType>;
+  typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputImage( updateField );
+
+  using RegionType = typename DisplacementFieldType::RegionType;
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>( totalField->GetBufferedRegion(),
+    [&]( const RegionType & chunk )
+      {
+      typename DisplacementFieldType::PointType point;
+      ImageRegionIteratorWithIndex<DisplacementFieldType> ItT( totalField, chunk );
+      for( ItT.GoToBegin(); !ItT.IsAtEnd(); ++ItT )
+        {
+        totalField->TransformIndexToPhysicalPoint( ItT.GetIndex(), point );
+        const DisplacementVectorType warpVector = ItT.Get();
+        point += warpVector;
+        if( interpolator->IsInsideBuffer( point ) )
+          {
+          const typename InterpolatorType::OutputType displacement = interpolator->Evaluate( point );
+          DisplacementVectorType composed;
+          for( unsigned int d = 0; d < ImageDimension; d++ )
+            {
+            composed[d] = warpVector[d] + displacement[d];
+            }
+          ItT.Set( composed );
+          }
+        }
+      }, nullptr );
+}
+
 /*
  * Start the registration
  */
@@ -774,6 +1022,7 @@ SyNImageRegistrationMethod<TFixedImage, TMovingImage, TOutputTransform, TVirtual
   os << indent << "Convergence window size: " << this->m_ConvergenceWindowSize << std::endl;
   os << indent << "Gaussian smoothing variance for the update field: " << this->m_GaussianSmoothingVarianceForTheUpdateField << std::endl;
   os << indent << "Gaussian smoothing variance for the total field: " << this->m_GaussianSmoothingVarianceForTheTotalField << std::endl;
+  os << indent << "Use fused field update: " << this->m_UseFusedFieldUpdate << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkBSplineTransform.h"
+#include "itkAffineTransform.h"
+#include "itkTestingMacros.h"
+
+#include <atomic>
+
+/*
+ * Register two images with a B-spline transform through
+ * ImageRegistrationMethodv4, after a moving initial affine transform, and
+ * check that the metric uses the sparse Jacobian of the B-spline transform
+ * through the composite transform of the registration. The result matches
+ * the registration with the dense Jacobian.
+ */
+namespace itk
+{
+/** B-spline transform counting the evaluations of its dense and sparse
+ * Jacobians, and optionally hiding its sparse Jacobian. */
+template<typename TParametersValueType, unsigned int NDimensions, unsigned int VSplineOrder>
+class JacobianCountingBSplineTransform :
+  public BSplineTransform<TParametersValueType, NDimensions, VSplineOrder>
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(JacobianCountingBSplineTransform);
+
+  using Self = JacobianCountingBSplineTransform;
+  using Superclass = BSplineTransform<TParametersValueType, NDimensions, VSplineOrder>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  itkNewMacro( Self );
+  itkTypeMacro( JacobianCountingBSplineTransform, BSplineTransform );
+
+  using InputPointType = typename Superclass::InputPointType;
+  using JacobianType = typename Superclass::JacobianType;
+  using JacobianSupportIndicesType = typename Superclass::JacobianSupportIndicesType;
+
+  void ComputeJacobianWithRespectToParameters( const InputPointType & point, JacobianType & jacobian ) const override
+  {
+    ++m_NumberOfDenseJacobians;
+    Superclass::ComputeJacobianWithRespectToParameters( point, jacobian );
+  }
+
+  void ComputeSparseJacobianWithRespectToParameters( const InputPointType & point, JacobianType & jacobian,
+    JacobianSupportIndicesType & supportIndices ) const override
+  {
+    ++m_NumberOfSparseJacobians;
+    Superclass::ComputeSparseJacobianWithRespectToParameters( point, jacobian, supportIndices );
+  }
+
+  bool HasSparseJacobian() const override
+  {
+    return m_UseSparseJacobian;
+  }
+
+  bool m_UseSparseJacobian{ true };
+
+  mutable std::atomic<SizeValueType> m_NumberOfDenseJacobians{ 0 };
+  mutable std::atomic<SizeValueType> m_NumberOfSparseJacobians{ 0 };
+
+protected:
+  JacobianCountingBSplineTransform() = default;
+  ~JacobianCountingBSplineTransform() override = default;
+};
+}
+
+namespace
+{
+template<typename TImage>
+typename TImage::Pointer
+MakeSparseJacobianRegistrationTestImage( double centerX, double centerY )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size.Fill( 40 );
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> It( image, image->GetLargestPossibleRegion() );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const double dx = It.GetIndex()[0] - centerX;
+    const double dy = It.GetIndex()[1] - centerY;
+    It.Set( 100.0 * std::exp( -( dx * dx + dy * dy ) / ( 2.0 * 5.0 * 5.0 ) ) );
+    }
+  return image;
+}
+}
+
+int itkBSplineImageRegistrationSparseJacobianTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using ImageType = itk::Image<double, Dimension>;
+  using TransformType = itk::JacobianCountingBSplineTransform<double, Dimension, 3>;
+  using AffineTransformType = itk::AffineTransform<double, Dimension>;
+  using RegistrationType = itk::ImageRegistrationMethodv4<ImageType, ImageType, TransformType>;
+  using MetricType = itk::MeanSquaresImageToImageMetricv4<ImageType, ImageType>;
+  using OptimizerType = itk::GradientDescentOptimizerv4;
+
+  ImageType::Pointer fixedImage = MakeSparseJacobianRegistrationTestImage<ImageType>( 19.0, 20.0 );
+  ImageType::Pointer movingImage = MakeSparseJacobianRegistrationTestImage<ImageType>( 21.0, 18.5 );
+
+  // A moving initial transform which is not a translation, so that the
+  // sparse Jacobian is left multiplied by its Jacobian with respect to the
+  // position.
+  AffineTransformType::Pointer initialTransform = AffineTransformType::New();
+  AffineTransformType::OutputVectorType scale;
+  scale[0] = 1.05;
+  scale[1] = 0.95;
+  initialTransform->Scale( scale );
+  initialTransform->Rotate2D( 0.05 );
+
+  TransformType::ParametersType sparseParameters;
+  TransformType::ParametersType denseParameters;
+  for( bool useSparseJacobian : { true, false } )
+    {
+    TransformType::Pointer transform = TransformType::New();
+    transform->m_UseSparseJacobian = useSparseJacobian;
+    TransformType::PhysicalDimensionsType dimensions;
+    dimensions.Fill( 39.0 );
+    TransformType::MeshSizeType meshSize;
+    meshSize.Fill( 4 );
+    transform->SetTransformDomainOrigin( fixedImage->GetOrigin() );
+    transform->SetTransformDomainPhysicalDimensions( dimensions );
+    transform->SetTransformDomainMeshSize( meshSize );
+    transform->SetTransformDomainDirection( fixedImage->GetDirection() );
+    transform->SetIdentity();
+
+    RegistrationType::Pointer registration = RegistrationType::New();
+    registration->SetFixedImage( fixedImage );
+    registration->SetMovingImage( movingImage );
+    registration->SetMetric( MetricType::New() );
+    registration->SetMovingInitialTransform( initialTransform );
+    registration->SetInitialTransform( transform );
+    registration->InPlaceOn();
+
+    RegistrationType::ShrinkFactorsArrayType shrinkFactors( 1 );
+    shrinkFactors[0] = 1;
+    RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+    smoothingSigmas[0] = 0.0;
+    registration->SetNumberOfLevels( 1 );
+    registration->SetShrinkFactorsPerLevel( shrinkFactors );
+    registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+
+    OptimizerType::Pointer optimizer = OptimizerType::New();
+    optimizer->SetNumberOfIterations( 10 );
+    optimizer->SetLearningRate( 0.01 );
+    optimizer->SetDoEstimateLearningRateOnce( false );
+    optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+    registration->SetOptimizer( optimizer );
+
+    TRY_EXPECT_NO_EXCEPTION( registration->Update() );
+
+    std::cout << "Sparse Jacobian: " << useSparseJacobian << ", dense evaluations: "
+              << transform->m_NumberOfDenseJacobians << ", sparse evaluations: "
+              << transform->m_NumberOfSparseJacobians << std::endl;
+    if( useSparseJacobian )
+      {
+      TEST_EXPECT_EQUAL( transform->m_NumberOfDenseJacobians.load(), 0u );
+      TEST_EXPECT_TRUE( transform->m_NumberOfSparseJacobians.load() > 0 );
+      sparseParameters = transform->GetParameters();
+      }
+    else
+      {
+      TEST_EXPECT_TRUE( transform->m_NumberOfDenseJacobians.load() > 0 );
+      TEST_EXPECT_EQUAL( transform->m_NumberOfSparseJacobians.load(), 0u );
+      denseParameters = transform->GetParameters();
+      }
+    }
+
+  // The registration moved the control points, and the sparse Jacobian gives
+  // the same result as the dense Jacobian.
+  TEST_EXPECT_TRUE( sparseParameters.two_norm() > 1e-3 );
+  for( unsigned int p = 0; p < sparseParameters.Size(); p++ )
+    {
+    if( std::fabs( sparseParameters[p] - denseParameters[p] ) > 1e-6 )
+      {
+      std::cerr << "Parameter " << p << " is " << sparseParameters[p] << " with the sparse Jacobian, "
+                << denseParameters[p] << " with the dense Jacobian" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
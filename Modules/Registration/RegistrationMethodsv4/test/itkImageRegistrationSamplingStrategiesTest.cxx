@@ -0,0 +1,203 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkRegistrationParameterScalesFromPhysicalShift.h"
+#include "itkTranslationTransform.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Register two shifted Gaussian blobs with a translation transform using each
+ * of the metric sampling strategies and a small sampling percentage.  The
+ * sample points are also redrawn periodically during the optimization, and
+ * the redrawn sample set is checked to differ from the first one.
+ */
+namespace
+{
+template<typename TImage>
+typename TImage::Pointer
+MakeBlobImage( double centerX, double centerY )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::RegionType region;
+  typename TImage::SizeType size;
+  size.Fill( 64 );
+  region.SetSize( size );
+  image->SetRegions( region );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> It( image, region );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const double dx = It.GetIndex()[0] - centerX;
+    const double dy = It.GetIndex()[1] - centerY;
+    It.Set( 100.0 * std::exp( -( dx * dx + dy * dy ) / ( 2.0 * 8.0 * 8.0 ) ) );
+    }
+  return image;
+}
+
+// Record the sample points of the metric at the first iteration and at a
+// later iteration, after the samples have been redrawn.
+template<typename TMetric>
+class SamplePointsObserver: public itk::Command
+{
+public:
+  using Self = SamplePointsObserver;
+  using Superclass = itk::Command;
+  using Pointer = itk::SmartPointer<Self>;
+  itkNewMacro( Self );
+
+  using PointsType = std::vector<typename TMetric::VirtualPointSetType::PointType>;
+
+  void Execute( itk::Object *caller, const itk::EventObject & event ) override
+    {
+    Execute( (const itk::Object *) caller, event );
+    }
+
+  void Execute( const itk::Object * object, const itk::EventObject & event ) override
+    {
+    const auto * optimizer = dynamic_cast<const itk::ObjectToObjectOptimizerBase *>( object );
+    if( !itk::IterationEvent().CheckEvent( &event ) || !optimizer )
+      {
+      return;
+      }
+    if( optimizer->GetCurrentIteration() == 0 )
+      {
+      this->CopyPoints( m_FirstPoints );
+      }
+    else if( optimizer->GetCurrentIteration() == 15 )
+      {
+      this->CopyPoints( m_RedrawnPoints );
+      }
+    }
+
+  void CopyPoints( PointsType & points ) const
+    {
+    points.clear();
+    const typename TMetric::VirtualPointSetType * pointSet = m_Metric->GetVirtualSampledPointSet();
+    for( itk::SizeValueType i = 0; i < pointSet->GetNumberOfPoints(); i++ )
+      {
+      points.push_back( pointSet->GetPoint( i ) );
+      }
+    }
+
+  const TMetric * m_Metric{ nullptr };
+  PointsType      m_FirstPoints;
+  PointsType      m_RedrawnPoints;
+
+protected:
+  SamplePointsObserver() = default;
+};
+}
+
+int itkImageRegistrationSamplingStrategiesTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using PixelType = double;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  ImageType::Pointer fixedImage = MakeBlobImage<ImageType>( 32.0, 32.0 );
+  ImageType::Pointer movingImage = MakeBlobImage<ImageType>( 34.0, 29.0 );
+
+  using TransformType = itk::TranslationTransform<double, Dimension>;
+  using RegistrationType = itk::ImageRegistrationMethodv4<ImageType, ImageType, TransformType>;
+  using MetricType = itk::MeanSquaresImageToImageMetricv4<ImageType, ImageType>;
+
+  const RegistrationType::MetricSamplingStrategyType strategies[] = {
+    RegistrationType::GRADIENT_MAGNITUDE,
+    RegistrationType::STRATIFIED,
+    RegistrationType::LOW_DISCREPANCY };
+
+  bool testPassed = true;
+  for( auto strategy : strategies )
+    {
+    RegistrationType::Pointer registration = RegistrationType::New();
+
+    MetricType::Pointer metric = MetricType::New();
+
+    using OptimizerType = itk::GradientDescentOptimizerv4;
+    OptimizerType::Pointer optimizer = OptimizerType::New();
+    optimizer->SetLearningRate( 0.5 );
+    optimizer->SetNumberOfIterations( 200 );
+    optimizer->SetDoEstimateLearningRateOnce( true );
+    optimizer->SetDoEstimateLearningRateAtEachIteration( false );
+
+    using ScalesEstimatorType = itk::RegistrationParameterScalesFromPhysicalShift<MetricType>;
+    ScalesEstimatorType::Pointer scalesEstimator = ScalesEstimatorType::New();
+    scalesEstimator->SetMetric( metric );
+    scalesEstimator->SetTransformForward( true );
+    optimizer->SetScalesEstimator( scalesEstimator );
+
+    registration->SetFixedImage( fixedImage );
+    registration->SetMovingImage( movingImage );
+    registration->SetMetric( metric );
+    registration->SetOptimizer( optimizer );
+    registration->SetNumberOfLevels( 1 );
+    RegistrationType::SmoothingSigmasArrayType smoothingSigmas( 1 );
+    smoothingSigmas.Fill( 0.0 );
+    registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+
+    registration->SetMetricSamplingStrategy( strategy );
+    TEST_SET_GET_VALUE( strategy, registration->GetMetricSamplingStrategy() );
+    registration->SetMetricSamplingPercentage( 0.05 );
+    registration->SetMetricSamplingUpdateInterval( 10 );
+    TEST_SET_GET_VALUE( 10, registration->GetMetricSamplingUpdateInterval() );
+    registration->SetMetricSamplingNumberOfStrata( 8 );
+    TEST_SET_GET_VALUE( 8, registration->GetMetricSamplingNumberOfStrata() );
+    registration->MetricSamplingReinitializeSeed( 121212 );
+
+    using ObserverType = SamplePointsObserver<MetricType>;
+    ObserverType::Pointer observer = ObserverType::New();
+    observer->m_Metric = metric;
+    optimizer->AddObserver( itk::IterationEvent(), observer );
+
+    TRY_EXPECT_NO_EXCEPTION( registration->Update() );
+
+    const itk::SizeValueType numberOfSamples = metric->GetNumberOfDomainPoints();
+    std::cout << "Strategy " << strategy << ": " << numberOfSamples << " samples, translation = "
+              << registration->GetTransform()->GetParameters() << std::endl;
+
+    if( numberOfSamples == 0 || numberOfSamples > 64 * 64 / 10 )
+      {
+      std::cerr << "Unexpected number of samples for strategy " << strategy << std::endl;
+      testPassed = false;
+      }
+
+    if( observer->m_FirstPoints.empty() || observer->m_RedrawnPoints.empty() ||
+        observer->m_FirstPoints == observer->m_RedrawnPoints )
+      {
+      std::cerr << "The samples were not redrawn for strategy " << strategy << std::endl;
+      testPassed = false;
+      }
+
+    const TransformType::ParametersType parameters = registration->GetTransform()->GetParameters();
+    if( std::fabs( parameters[0] - 2.0 ) > 0.25 || std::fabs( parameters[1] + 3.0 ) > 0.25 )
+      {
+      std::cerr << "Registration did not recover the translation for strategy " << strategy << std::endl;
+      testPassed = false;
+      }
+    }
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
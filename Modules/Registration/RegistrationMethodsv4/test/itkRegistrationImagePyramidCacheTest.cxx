@@ -0,0 +1,216 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkImageRegistrationMethodv4.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkRegistrationImagePyramidCache.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkTranslationTransform.h"
+#include "itkAffineTransform.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Exercise the pyramid cache directly, then run a translation stage followed
+ * by an affine stage that share the same cache and check that each level
+ * smooths its images when it starts and that the second stage does not
+ * smooth any image.
+ */
+namespace
+{
+template<typename TImage>
+typename TImage::Pointer
+MakePyramidCacheTestImage( double centerX, double centerY )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size.Fill( 48 );
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> It( image, image->GetLargestPossibleRegion() );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const double dx = It.GetIndex()[0] - centerX;
+    const double dy = It.GetIndex()[1] - centerY;
+    It.Set( 100.0 * std::exp( -( dx * dx + dy * dy ) / ( 2.0 * 6.0 * 6.0 ) ) );
+    }
+  return image;
+}
+
+// Record the number of cached images at the beginning of each level.
+template<typename TCache>
+class PyramidCacheLevelObserver: public itk::Command
+{
+public:
+  using Self = PyramidCacheLevelObserver;
+  using Superclass = itk::Command;
+  using Pointer = itk::SmartPointer<Self>;
+  itkNewMacro( Self );
+
+  void Execute( itk::Object *caller, const itk::EventObject & event ) override
+    {
+    Execute( (const itk::Object *) caller, event );
+    }
+
+  void Execute( const itk::Object *, const itk::EventObject & event ) override
+    {
+    if( itk::MultiResolutionIterationEvent().CheckEvent( &event ) )
+      {
+      m_NumberOfCachedImages.push_back( m_Cache->GetNumberOfCachedImages() );
+      }
+    }
+
+  const TCache *                  m_Cache{ nullptr };
+  std::vector<itk::SizeValueType> m_NumberOfCachedImages;
+
+protected:
+  PyramidCacheLevelObserver() = default;
+};
+}
+
+int itkRegistrationImagePyramidCacheTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using PixelType = float;
+  using ImageType = itk::Image<PixelType, Dimension>;
+
+  ImageType::Pointer fixedImage = MakePyramidCacheTestImage<ImageType>( 24.0, 24.0 );
+  ImageType::Pointer movingImage = MakePyramidCacheTestImage<ImageType>( 25.5, 22.0 );
+
+  using CacheType = itk::RegistrationImagePyramidCache<ImageType>;
+  CacheType::Pointer cache = CacheType::New();
+
+  EXERCISE_BASIC_OBJECT_METHODS( cache, RegistrationImagePyramidCache, Object );
+
+  // The cached images match a direct smoothing.
+  CacheType::SigmaArrayType sigmas;
+  sigmas.Fill( 2.0 );
+  const ImageType * smoothed = cache->GetSmoothedFixedImage( fixedImage, sigmas );
+  TEST_EXPECT_EQUAL( cache->GetNumberOfMisses(), 1u );
+
+  using SmoothingFilterType = itk::SmoothingRecursiveGaussianImageFilter<ImageType, ImageType>;
+  SmoothingFilterType::Pointer smoothingFilter = SmoothingFilterType::New();
+  smoothingFilter->SetSigmaArray( sigmas );
+  smoothingFilter->SetInput( fixedImage );
+  smoothingFilter->Update();
+  itk::ImageRegionConstIterator<ImageType> ItC( smoothed, smoothed->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator<ImageType> ItD( smoothingFilter->GetOutput(), smoothed->GetLargestPossibleRegion() );
+  for( ItC.GoToBegin(), ItD.GoToBegin(); !ItC.IsAtEnd(); ++ItC, ++ItD )
+    {
+    if( std::fabs( ItC.Get() - ItD.Get() ) > 1e-4 )
+      {
+      std::cerr << "Cached image differs from the smoothing filter output." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A second lookup returns the same image.
+  TEST_EXPECT_TRUE( cache->GetSmoothedFixedImage( fixedImage, sigmas ) == smoothed );
+  TEST_EXPECT_EQUAL( cache->GetNumberOfHits(), 1u );
+
+  // Requested images are computed together.
+  CacheType::SigmaArrayType otherSigmas;
+  otherSigmas.Fill( 1.0 );
+  cache->RequestSmoothedFixedImage( fixedImage, sigmas );
+  cache->RequestSmoothedFixedImage( fixedImage, otherSigmas );
+  cache->RequestSmoothedMovingImage( movingImage, sigmas );
+  cache->RequestSmoothedMovingImage( movingImage, otherSigmas );
+  cache->ComputeRequestedImages();
+  TEST_EXPECT_EQUAL( cache->GetNumberOfCachedImages(), 4u );
+  TEST_EXPECT_EQUAL( cache->GetNumberOfMisses(), 4u );
+
+  // Modifying an image invalidates its entries.
+  fixedImage->Modified();
+  TEST_EXPECT_TRUE( cache->GetSmoothedFixedImage( fixedImage, sigmas ) != smoothed );
+  TEST_EXPECT_EQUAL( cache->GetNumberOfMisses(), 5u );
+
+  cache->Clear();
+  TEST_EXPECT_EQUAL( cache->GetNumberOfCachedImages(), 0u );
+
+  // Two stages sharing the cache.
+  using TranslationTransformType = itk::TranslationTransform<double, Dimension>;
+  using TranslationRegistrationType = itk::ImageRegistrationMethodv4<ImageType, ImageType, TranslationTransformType>;
+  using AffineTransformType = itk::AffineTransform<double, Dimension>;
+  using AffineRegistrationType = itk::ImageRegistrationMethodv4<ImageType, ImageType, AffineTransformType>;
+  using MetricType = itk::MeanSquaresImageToImageMetricv4<ImageType, ImageType>;
+
+  TranslationRegistrationType::ShrinkFactorsArrayType shrinkFactors( 3 );
+  shrinkFactors[0] = 4;
+  shrinkFactors[1] = 2;
+  shrinkFactors[2] = 1;
+  TranslationRegistrationType::SmoothingSigmasArrayType smoothingSigmas( 3 );
+  smoothingSigmas[0] = 2.0;
+  smoothingSigmas[1] = 1.0;
+  smoothingSigmas[2] = 0.0;
+
+  TranslationRegistrationType::Pointer translationRegistration = TranslationRegistrationType::New();
+  translationRegistration->SetFixedImage( fixedImage );
+  translationRegistration->SetMovingImage( movingImage );
+  translationRegistration->SetMetric( MetricType::New() );
+  translationRegistration->SetNumberOfLevels( 3 );
+  translationRegistration->SetShrinkFactorsPerLevel( shrinkFactors );
+  translationRegistration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  translationRegistration->SetImagePyramidCache( cache );
+  TEST_SET_GET_VALUE( cache.GetPointer(), translationRegistration->GetImagePyramidCache() );
+
+  using LevelObserverType = PyramidCacheLevelObserver<CacheType>;
+  LevelObserverType::Pointer levelObserver = LevelObserverType::New();
+  levelObserver->m_Cache = cache;
+  translationRegistration->AddObserver( itk::MultiResolutionIterationEvent(), levelObserver );
+
+  using OptimizerType = itk::GradientDescentOptimizerv4;
+  OptimizerType::Pointer translationOptimizer = OptimizerType::New();
+  translationOptimizer->SetNumberOfIterations( 20 );
+  translationRegistration->SetOptimizer( translationOptimizer );
+
+  TRY_EXPECT_NO_EXCEPTION( translationRegistration->Update() );
+
+  // Two smoothed levels for each of the fixed and moving images.
+  TEST_EXPECT_EQUAL( cache->GetNumberOfMisses(), 4u );
+
+  // The images of a level are only smoothed when the level starts.
+  TEST_EXPECT_EQUAL( levelObserver->m_NumberOfCachedImages.size(), 3u );
+  TEST_EXPECT_EQUAL( levelObserver->m_NumberOfCachedImages[0], 0u );
+  TEST_EXPECT_EQUAL( levelObserver->m_NumberOfCachedImages[1], 2u );
+  TEST_EXPECT_EQUAL( levelObserver->m_NumberOfCachedImages[2], 4u );
+  const itk::SizeValueType hitsAfterFirstStage = cache->GetNumberOfHits();
+
+  AffineRegistrationType::Pointer affineRegistration = AffineRegistrationType::New();
+  affineRegistration->SetFixedImage( fixedImage );
+  affineRegistration->SetMovingImage( movingImage );
+  affineRegistration->SetMetric( MetricType::New() );
+  affineRegistration->SetNumberOfLevels( 3 );
+  affineRegistration->SetShrinkFactorsPerLevel( shrinkFactors );
+  affineRegistration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  affineRegistration->SetMovingInitialTransform( translationRegistration->GetModifiableTransform() );
+  affineRegistration->SetImagePyramidCache( cache );
+
+  OptimizerType::Pointer affineOptimizer = OptimizerType::New();
+  affineOptimizer->SetNumberOfIterations( 5 );
+  affineRegistration->SetOptimizer( affineOptimizer );
+
+  TRY_EXPECT_NO_EXCEPTION( affineRegistration->Update() );
+
+  TEST_EXPECT_EQUAL( cache->GetNumberOfMisses(), 4u );
+  TEST_EXPECT_EQUAL( cache->GetNumberOfHits(), hitsAfterFirstStage + 4u );
+
+  std::cout << cache << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSyNImageRegistrationMethod.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMeanSquaresImageToImageMetricv4.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Register a disk to a larger disk with SyN, once with the filter-based
+ * update of the fields and once with the fused in-place update, and check
+ * that both give the same displacement fields.
+ */
+namespace
+{
+template<typename TImage>
+typename TImage::Pointer
+MakeFusedUpdateTestImage( double radius )
+{
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::SizeType size;
+  size.Fill( 40 );
+  image->SetRegions( size );
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<TImage> It( image, image->GetLargestPossibleRegion() );
+  for( It.GoToBegin(); !It.IsAtEnd(); ++It )
+    {
+    const double dx = It.GetIndex()[0] - 20.0;
+    const double dy = It.GetIndex()[1] - 20.0;
+    const double distance = std::sqrt( dx * dx + dy * dy );
+    It.Set( 100.0 / ( 1.0 + std::exp( distance - radius ) ) );
+    }
+  return image;
+}
+
+template<typename TRegistration, typename TImage>
+typename TRegistration::OutputTransformType::Pointer
+RunFusedUpdateTestRegistration( const TImage *fixedImage, const TImage *movingImage,
+  bool useFusedFieldUpdate, typename TRegistration::RealType varianceForTotalField )
+{
+  using DisplacementFieldType = typename TRegistration::DisplacementFieldType;
+  using OutputTransformType = typename TRegistration::OutputTransformType;
+
+  const typename DisplacementFieldType::PixelType zeroVector( 0.0 );
+
+  typename DisplacementFieldType::Pointer displacementField = DisplacementFieldType::New();
+  displacementField->CopyInformation( fixedImage );
+  displacementField->SetRegions( fixedImage->GetBufferedRegion() );
+  displacementField->Allocate();
+  displacementField->FillBuffer( zeroVector );
+
+  typename DisplacementFieldType::Pointer inverseDisplacementField = DisplacementFieldType::New();
+  inverseDisplacementField->CopyInformation( fixedImage );
+  inverseDisplacementField->SetRegions( fixedImage->GetBufferedRegion() );
+  inverseDisplacementField->Allocate();
+  inverseDisplacementField->FillBuffer( zeroVector );
+
+  typename OutputTransformType::Pointer outputTransform = OutputTransformType::New();
+  outputTransform->SetDisplacementField( displacementField );
+  outputTransform->SetInverseDisplacementField( inverseDisplacementField );
+
+  using MetricType = itk::MeanSquaresImageToImageMetricv4<TImage, TImage>;
+  typename MetricType::Pointer metric = MetricType::New();
+
+  typename TRegistration::Pointer registration = TRegistration::New();
+  registration->SetFixedImage( fixedImage );
+  registration->SetMovingImage( movingImage );
+  registration->SetInitialTransform( outputTransform );
+  registration->InPlaceOn();
+  registration->SetMetric( metric );
+  registration->SetNumberOfLevels( 1 );
+
+  typename TRegistration::ShrinkFactorsArrayType shrinkFactors( 1 );
+  shrinkFactors.Fill( 1 );
+  registration->SetShrinkFactorsPerLevel( shrinkFactors );
+  typename TRegistration::SmoothingSigmasArrayType smoothingSigmas( 1 );
+  smoothingSigmas.Fill( 0.0 );
+  registration->SetSmoothingSigmasPerLevel( smoothingSigmas );
+  typename TRegistration::NumberOfIterationsArrayType numberOfIterations( 1 );
+  numberOfIterations.Fill( 10 );
+  registration->SetNumberOfIterationsPerLevel( numberOfIterations );
+
+  registration->SetLearningRate( 0.5 );
+  registration->SetGaussianSmoothingVarianceForTheUpdateField( 3.0 );
+  registration->SetGaussianSmoothingVarianceForTheTotalField( varianceForTotalField );
+  registration->SetUseFusedFieldUpdate( useFusedFieldUpdate );
+  registration->Update();
+
+  return outputTransform;
+}
+}
+
+int itkSyNImageRegistrationFusedUpdateTest( int, char *[] )
+{
+  constexpr unsigned int Dimension = 2;
+  using ImageType = itk::Image<double, Dimension>;
+  using RegistrationType = itk::SyNImageRegistrationMethod<ImageType, ImageType>;
+
+  ImageType::Pointer fixedImage = MakeFusedUpdateTestImage<ImageType>( 8.0 );
+  ImageType::Pointer movingImage = MakeFusedUpdateTestImage<ImageType>( 10.0 );
+
+  RegistrationType::Pointer registration = RegistrationType::New();
+  TEST_SET_GET_BOOLEAN( registration, UseFusedFieldUpdate, true );
+
+  bool testPassed = true;
+
+  // A total field variance below 0.5 also exercises the boundary blending.
+  const RegistrationType::RealType variancesForTotalField[] = { 0.25, 1.0 };
+  for( auto varianceForTotalField : variancesForTotalField )
+    {
+    RegistrationType::OutputTransformType::Pointer referenceTransform;
+    RegistrationType::OutputTransformType::Pointer fusedTransform;
+    TRY_EXPECT_NO_EXCEPTION( referenceTransform = RunFusedUpdateTestRegistration<RegistrationType>(
+      fixedImage.GetPointer(), movingImage.GetPointer(), false, varianceForTotalField ) );
+    TRY_EXPECT_NO_EXCEPTION( fusedTransform = RunFusedUpdateTestRegistration<RegistrationType>(
+      fixedImage.GetPointer(), movingImage.GetPointer(), true, varianceForTotalField ) );
+
+    using DisplacementFieldType = RegistrationType::DisplacementFieldType;
+    const DisplacementFieldType * referenceField = referenceTransform->GetDisplacementField();
+    const DisplacementFieldType * fusedField = fusedTransform->GetDisplacementField();
+
+    double maxDisplacement = 0.0;
+    double maxDifference = 0.0;
+    itk::ImageRegionConstIterator<DisplacementFieldType> ItR( referenceField, referenceField->GetBufferedRegion() );
+    itk::ImageRegionConstIterator<DisplacementFieldType> ItF( fusedField, fusedField->GetBufferedRegion() );
+    for( ItR.GoToBegin(), ItF.GoToBegin(); !ItR.IsAtEnd(); ++ItR, ++ItF )
+      {
+      maxDisplacement = std::max( maxDisplacement, ItR.Get().GetNorm() );
+      maxDifference = std::max( maxDifference, ( ItR.Get() - ItF.Get() ).GetNorm() );
+      }
+    std::cout << "Total field variance " << varianceForTotalField << ": max displacement = "
+              << maxDisplacement << ", max difference = " << maxDifference << std::endl;
+
+    if( maxDisplacement < 0.1 )
+      {
+      std::cerr << "The registration did not deform the fields." << std::endl;
+      testPassed = false;
+      }
+    if( maxDifference > 1e-3 )
+      {
+      std::cerr << "The fused update differs from the filter-based update." << std::endl;
+      testPassed = false;
+      }
+    }
+
+  if( !testPassed )
+    {
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
@@ -28,22 +28,21 @@ namespace itk
  * objects in an artibitrary image.
  *
  * ConnectedComponentFunctorImageFilter labels the objects in an arbitrary
- * image. Each distinct object is assigned a unique label. The filter makes
- * three passes through the image.  The first pass initializes the
- * output.  The second pass labels each foreground pixel such that all
- * the pixels associated with an object either have the same label or
- * have had their labels entered into a equivalency table.  The third
- * pass through the image flattens the equivalency table such that all
- * pixels for an object have the same label.
+ * image. Each distinct object is assigned a unique label. As in
+ * ConnectedComponentImageFilter, the lines of the image are encoded in
+ * runs of connected pixels by several threads, then the labels of the
+ * neighbor runs are merged in a union-find shared by the threads, and
+ * finally the output is written by several threads.
  *
  * The functor specifies the criteria to join neighboring pixels.  For
  * example a simple intensity threshold difference might be used for
  * scalar imagery.
  *
- * The final object labels are in no particular order (and some object
- * labels may not be used on the final objects).  You can reorder the
- * labels such that object labels are consecutive and sorted based on
- * object size by passing the output of this filter to a
+ * The pixels outside of the mask, if any, are set to the background
+ * value, which is zero by default. The final object labels are
+ * consecutive, and objects that are reached earlier by a raster order
+ * scan have a lower label.  You can reorder the labels such that they are
+ * sorted based on object size by passing the output of this filter to a
  * RelabelComponentImageFilter.
  *
  * \sa ImageToImageFilter
@@ -150,7 +149,10 @@ public:
 #endif
 
 protected:
-  ConnectedComponentFunctorImageFilter() = default;
+  ConnectedComponentFunctorImageFilter()
+  {
+    this->SetBackgroundValue( NumericTraits< OutputPixelType >::ZeroValue() );
+  }
   ~ConnectedComponentFunctorImageFilter() override = default;
   ConnectedComponentFunctorImageFilter(const Self &) {}
 
@@ -160,6 +162,25 @@ protected:
    * Standard pipeline method.
    */
   void GenerateData() override;
+
+  /** Encode the lines of the region in runs of pixels joined by the
+   * functor. */
+  void DynamicThreadedGenerateData( const RegionType & ) override;
+
+  /** Merge the labels of the runs of the lines of a work unit with the
+   * runs of the previous lines which have a pair of neighbor pixels joined
+   * by the functor. */
+  void ComputeFunctorEquivalence( SizeValueType workUnitResultsIndex );
+
+  using InternalLabelType         = typename Superclass::InternalLabelType;
+  using LineEncodingType          = typename Superclass::LineEncodingType;
+  using LineEncodingConstIterator = typename Superclass::LineEncodingConstIterator;
+  using RunLength                 = typename Superclass::RunLength;
+  using WorkUnitData              = typename Superclass::WorkUnitData;
+  using OffsetVectorType          = typename Superclass::OffsetVectorType;
+  using LineMapType               = typename Superclass::LineMapType;
+  using UnionFindType             = typename Superclass::UnionFindType;
+  using ConsecutiveVectorType     = typename Superclass::ConsecutiveVectorType;
 };
 } // end namespace itk
 
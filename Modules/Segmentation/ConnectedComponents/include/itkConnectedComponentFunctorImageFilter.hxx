@@ -19,11 +19,8 @@
 #define itkConnectedComponentFunctorImageFilter_hxx
 
 #include "itkConnectedComponentFunctorImageFilter.h"
-#include "itkImageRegionIterator.h"
-#include "itkProgressReporter.h"
-#include "itkEquivalencyTable.h"
-#include "itkConstShapedNeighborhoodIterator.h"
-#include "itkConstantBoundaryCondition.h"
+#include "itkImageScanlineIterator.h"
+#include "itkProgressTransformer.h"
 
 namespace itk
 {
@@ -32,208 +29,210 @@ void
 ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
 ::GenerateData()
 {
-  // create an equivalency table
-  EquivalencyTable::Pointer eqTable = EquivalencyTable::New();
-
-  InputPixelType        value, neighborValue;
-  OutputPixelType       label, originalLabel, neighborLabel;
-  OutputPixelType       maxLabel = NumericTraits< OutputPixelType >::ZeroValue();
-  const OutputPixelType maxPossibleLabel = NumericTraits< OutputPixelType >::max();
-
-  typename TOutputImage::Pointer output = this->GetOutput();
-  typename TInputImage::ConstPointer input = this->GetInput();
-
-  // Allocate the output and initialize to unlabeled
   this->AllocateOutputs();
-  output->FillBuffer(maxPossibleLabel);
+  this->SetupLineOffsets( false );
+
+  const RegionType & requestedRegion = this->GetOutput()->GetRequestedRegion();
 
-  // Set up the boundary condition to be zero padded (used on output image)
-  ConstantBoundaryCondition< TOutputImage > BC;
-  BC.SetConstant(NumericTraits< OutputPixelType >::ZeroValue());
+  // set up the vars used in the threads
+  const SizeValueType linecount = requestedRegion.GetNumberOfPixels() / requestedRegion.GetSize()[0];
+  this->m_LineMap.resize( linecount );
+  this->m_NumberOfLabels.store( 0 );
 
-  // Neighborhood iterators.  Let's use a shaped neighborhood so we can
-  // restrict the access to face connected neighbors. These iterators
-  // will be applied to both the input and the output image
-  using InputNeighborhoodIteratorType = ConstShapedNeighborhoodIterator< TInputImage >;
-  using OutputNeighborhoodIteratorType = ConstShapedNeighborhoodIterator< TOutputImage >;
+  ProgressTransformer progress1( 0.0f, 0.5f, this );
 
-  SizeType kernelRadius;
-  kernelRadius.Fill(1);
+  MultiThreaderBase* multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+  multiThreader->template ParallelizeImageRegionRestrictDirection< TOutputImage::ImageDimension >(
+    0,
+    requestedRegion,
+    [this]( const RegionType& lambdaRegion )
+    {
+      this->DynamicThreadedGenerateData( lambdaRegion );
+    },
+    progress1.GetProcessObject() );
 
-  InputNeighborhoodIteratorType  init( kernelRadius, input, output->GetRequestedRegion() );
-  OutputNeighborhoodIteratorType onit( kernelRadius, output, output->GetRequestedRegion() );
-  onit.OverrideBoundaryCondition(&BC); // assign the boundary condition
+  this->InitUnion( this->m_NumberOfLabels.load() );
 
-  // only activate the indices that are "previous" to the current
-  // pixel and face connected (exclude the center pixel from the
-  // neighborhood)
-  //
-  unsigned int d;
-  typename OutputNeighborhoodIteratorType::OffsetType offset;
+  ProgressTransformer progress2( 0.5f, 0.75f, this );
+  multiThreader->ParallelizeArray(
+    0, this->m_WorkUnitResults.size(), [this]( SizeValueType index ) { this->ComputeFunctorEquivalence( index ); }, progress2.GetProcessObject());
 
-  if ( !this->m_FullyConnected )
+  const SizeValueType numberOfObjects = this->CreateConsecutive( this->GetBackgroundValue() );
+  // check for overflow exception here
+  if ( numberOfObjects > static_cast< SizeValueType >( NumericTraits< OutputPixelType >::max() ) )
     {
-    // only activate the "previous" neighbors that are face connected
-    // to the current pixel. do not include the center pixel
-    offset.Fill(0);
-    for ( d = 0; d < InputImageType::ImageDimension; ++d )
-      {
-      offset[d] = -1;
-      init.ActivateOffset(offset);
-      onit.ActivateOffset(offset);
-      offset[d] = 0;
-      }
+    itkExceptionMacro( << "Number of objects (" << numberOfObjects << ") greater than maximum of output pixel type ("
+      << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( NumericTraits< OutputPixelType >::max() ) << ").");
     }
-  else
+  this->m_ObjectCount = numberOfObjects;
+
+  ProgressTransformer progress3( 0.75f, 1.0f, this );
+  multiThreader->template ParallelizeImageRegionRestrictDirection< TOutputImage::ImageDimension >(
+    0,
+    requestedRegion,
+    [this]( const RegionType& lambdaRegion )
     {
-    // activate all "previous" neighbors that are face+edge+vertex
-    // connected to the current pixel. do not include the center pixel
-    unsigned int centerIndex = onit.GetCenterNeighborhoodIndex();
-    for ( d = 0; d < centerIndex; d++ )
-      {
-      offset = onit.GetOffset(d);
-      init.ActivateOffset(offset);
-      onit.ActivateOffset(offset);
-      }
-    }
+      this->ThreadedWriteOutput( lambdaRegion );
+    },
+    progress3.GetProcessObject() );
+
+  // clear and make sure memory is freed
+  std::deque< WorkUnitData >().swap( this->m_WorkUnitResults );
+  OffsetVectorType().swap( this->m_LineOffsets );
+  LineMapType().swap( this->m_LineMap );
+  ConsecutiveVectorType().swap( this->m_Consecutive );
+  UnionFindType().swap( this->m_UnionFind );
+}
 
-  // along with a neighborhood iterator on the output, use a standard
-  // iterator on the input and output
-  ImageRegionConstIterator< InputImageType > it;
-  ImageRegionIterator< OutputImageType >     oit;
-  it = ImageRegionConstIterator< InputImageType >( input, output->GetRequestedRegion() );
-  oit = ImageRegionIterator< OutputImageType >( output, output->GetRequestedRegion() );
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::DynamicThreadedGenerateData(const RegionType & outputRegionForThread)
+{
+  const InputImageType * input = this->GetInput();
+  const MaskImageType * mask = this->GetMaskImage();
 
-  // Setup a progress reporter.  We have 2 stages to the algorithm so
-  // pretend we have 2 times the number of pixels
-  ProgressReporter progress( this, 0, 2 * output->GetRequestedRegion().GetNumberOfPixels() );
+  using InputLineIteratorType = ImageScanlineConstIterator< InputImageType >;
+  InputLineIteratorType inLineIt( input, outputRegionForThread );
 
-  // if the mask is set mark pixels not under the mask as background
-  typename TMaskImage::ConstPointer mask = this->GetMaskImage();
+  // the pixels outside of the mask are not part of any run
+  using MaskLineIteratorType = ImageScanlineConstIterator< MaskImageType >;
+  MaskLineIteratorType maskLineIt;
   if ( mask )
     {
-    ImageRegionConstIterator< MaskImageType > mit;
-    mit = ImageRegionConstIterator< MaskImageType >( mask, output->GetRequestedRegion() );
-
-    mit.GoToBegin();
-    oit.GoToBegin();
-    while ( !mit.IsAtEnd() )
-      {
-      if ( mit.Get() == NumericTraits< MaskPixelType >::ZeroValue() )
-        {
-        // mark pixel as unlabeled
-        oit.Set(NumericTraits< OutputPixelType >::ZeroValue());
-        }
-
-      ++mit;
-      ++oit;
-      }
+    maskLineIt = MaskLineIteratorType( mask, outputRegionForThread );
+    maskLineIt.GoToBegin();
     }
 
-  // iterate over the image, labeling the objects and defining
-  // equivalence classes.  Use the neighborhood iterator to access the
-  // "previous" neighbor pixels and an output iterator to access the
-  // current pixel
-  init.GoToBegin();
-  onit.GoToBegin();
-  it.GoToBegin();
-  oit.GoToBegin();
-  while ( !oit.IsAtEnd() )
-    {
-    // Get the current pixel label
-    label = oit.Get();
-    value = it.Get();
-    originalLabel = label;
+  WorkUnitData workUnitData = this->CreateWorkUnitData( outputRegionForThread );
+  SizeValueType lineId = workUnitData.firstLine;
 
-    // If the pixel is not background
-    if ( label != NumericTraits< OutputPixelType >::ZeroValue() )
+  SizeValueType nbOfLabels = 0;
+  for ( inLineIt.GoToBegin();
+        !inLineIt.IsAtEnd();
+        inLineIt.NextLine() )
+    {
+    LineEncodingType thisLine;
+    bool inRun = false;
+    InputPixelType previousValue{};
+    while ( !inLineIt.IsAtEndOfLine() )
       {
-      // loop over the "previous" neighbors to find labels.  this loop
-      // may establish one or more new equivalence classes
-      typename InputNeighborhoodIteratorType::ConstIterator isIt;
-      typename OutputNeighborhoodIteratorType::ConstIterator osIt;
-      for ( isIt = init.Begin(), osIt = onit.Begin(); !osIt.IsAtEnd(); ++isIt, ++osIt )
+      if ( mask && maskLineIt.Get() == NumericTraits< MaskPixelType >::ZeroValue() )
         {
-        // get the label of the pixel previous to this one along a
-        // particular dimension (neighbors activated in neighborhood iterator)
-        neighborLabel = osIt.Get();
-
-        // if the previous pixel has a label, verify equivalence or
-        // establish a new equivalence
-        if ( neighborLabel != NumericTraits< OutputPixelType >::ZeroValue() )
-          {
-          // see if current pixel is connected to its neighbor
-          neighborValue = isIt.Get();
-          if ( m_Functor(value, neighborValue) )
-            {
-            // if current pixel is unlabeled, then copy the label from neighbor
-            if ( label == maxPossibleLabel )
-              {
-              // copy the label from the previous pixel
-              label = neighborLabel;
-              }
-            // else if current pixel has a label that is not already
-            // equivalent to the label of the previous pixel, then setup
-            // a new equivalence.
-            else if ( ( label != neighborLabel )
-                      && ( eqTable->RecursiveLookup(label)
-                           != eqTable->RecursiveLookup(neighborLabel) ) )
-              {
-              eqTable->Add(label, neighborLabel);
-              }
-            }
-          }
+        inRun = false;
         }
-
-      // if none of the "previous" neighbors were set, then make a new label
-      if ( originalLabel == label )
+      else
         {
-        // create a new entry label
-        if ( maxLabel == maxPossibleLabel )
+        const InputPixelType value = inLineIt.Get();
+        // the run goes on while the pixel is joined to the previous one
+        if ( inRun && m_Functor(value, previousValue) )
           {
-          itkWarningMacro(
-            << "ConnectedComponentFunctorImageFilter::GenerateData: Number of labels " << (long)maxLabel
-            << " exceeds number of available labels " << (long)maxPossibleLabel << " for the output type.");
+          ++thisLine.back().length;
           }
         else
           {
-          ++maxLabel;
+          thisLine.push_back( RunLength( 1, inLineIt.GetIndex() ) );
+          nbOfLabels++;
+          inRun = true;
           }
-
-        // assign the new label
-        label = maxLabel;
+        previousValue = value;
         }
-
-      // Finally, set the output pixel to whatever label we have
-      if ( label != originalLabel )
+      ++inLineIt;
+      if ( mask )
         {
-        oit.Set(label);
+        ++maskLineIt;
         }
       }
-
-    // move the iterators
-    ++init;
-    ++onit;
-    ++it;
-    ++oit;
-    progress.CompletedPixel();
+    if ( mask )
+      {
+      maskLineIt.NextLine();
+      }
+    this->m_LineMap[lineId] = std::move( thisLine );
+    lineId++;
     }
 
-  // Flatten the equavalency table
-  eqTable->Flatten();
+  this->m_NumberOfLabels.fetch_add( nbOfLabels, std::memory_order_relaxed );
+  std::lock_guard< std::mutex > mutexHolder( this->m_Mutex );
+  this->m_WorkUnitResults.push_back( workUnitData );
+}
+
+template< typename TInputImage, typename TOutputImage, typename TFunctor, typename TMaskImage >
+void
+ConnectedComponentFunctorImageFilter< TInputImage, TOutputImage, TFunctor, TMaskImage >
+::ComputeFunctorEquivalence(const SizeValueType workUnitResultsIndex)
+{
+  const InputImageType * input = this->GetInput();
 
-  // remap the labels
-  oit.GoToBegin();
-  while ( !oit.IsAtEnd() )
+  // the neighbor pixels are on the same column, or also on the previous
+  // and next columns if fully connected
+  const OffsetValueType columnOffset = this->m_FullyConnected ? 1 : 0;
+
+  const OffsetValueType linecount = this->m_LineMap.size();
+  const WorkUnitData wud = this->m_WorkUnitResults[workUnitResultsIndex];
+  for ( SizeValueType thisIdx = wud.firstLine; thisIdx <= wud.lastLine; ++thisIdx )
     {
-    label = oit.Get();
-    // if pixel has a label, write out the final equivalence
-    if ( label != NumericTraits< OutputPixelType >::ZeroValue() )
+    if ( this->m_LineMap[thisIdx].empty() )
       {
-      oit.Set( eqTable->Lookup(label) );
+      continue;
+      }
+    for ( OffsetValueType lineOffset : this->m_LineOffsets )
+      {
+      const OffsetValueType neighIdx = thisIdx + lineOffset;
+      // check if the neighbor is in the map, and is really a neighbor
+      if ( neighIdx < 0 || neighIdx >= linecount || this->m_LineMap[neighIdx].empty()
+           || !this->CheckNeighbors( this->m_LineMap[thisIdx][0].where, this->m_LineMap[neighIdx][0].where ) )
+        {
+        continue;
+        }
+      // the runs are contiguous along the lines, so the neighbor runs
+      // touching a run are found by sweeping both lines together
+      const LineEncodingType & currentLine = this->m_LineMap[thisIdx];
+      const LineEncodingType & neighborLine = this->m_LineMap[neighIdx];
+      LineEncodingConstIterator mIt = neighborLine.begin();
+      for ( LineEncodingConstIterator cIt = currentLine.begin(); cIt != currentLine.end(); ++cIt )
+        {
+        const OffsetValueType cStart = cIt->where[0];
+        const OffsetValueType cLast = cStart + static_cast< OffsetValueType >( cIt->length ) - 1;
+        while ( mIt != neighborLine.end()
+                && mIt->where[0] + static_cast< OffsetValueType >( mIt->length ) - 1 + columnOffset < cStart )
+          {
+          ++mIt;
+          }
+        for ( LineEncodingConstIterator nIt = mIt;
+              nIt != neighborLine.end() && nIt->where[0] - columnOffset <= cLast;
+              ++nIt )
+          {
+          // the runs touch, but they are connected only if a pixel of the
+          // current run is joined to one of its neighbors in the other run
+          const OffsetValueType nStart = nIt->where[0];
+          const OffsetValueType nLast = nStart + static_cast< OffsetValueType >( nIt->length ) - 1;
+          IndexType currentIndex = cIt->where;
+          IndexType neighborIndex = nIt->where;
+          bool joined = false;
+          const OffsetValueType oLast = std::min( cLast, nLast + columnOffset );
+          for ( OffsetValueType x = std::max( cStart, nStart - columnOffset ); x <= oLast && !joined; ++x )
+            {
+            currentIndex[0] = x;
+            const InputPixelType value = input->GetPixel( currentIndex );
+            const OffsetValueType last = std::min( x + columnOffset, nLast );
+            for ( OffsetValueType nx = std::max( x - columnOffset, nStart ); nx <= last; ++nx )
+              {
+              neighborIndex[0] = nx;
+              if ( m_Functor( value, input->GetPixel( neighborIndex ) ) )
+                {
+                joined = true;
+                break;
+                }
+              }
+            }
+          if ( joined )
+            {
+            this->LinkLabels( nIt->label, cIt->label );
+            }
+          }
+        }
       }
-    ++oit;
-    progress.CompletedPixel();
     }
 }
 } // end namespace itk
@@ -45,7 +45,6 @@ namespace itk
  *
  * \sa ImageToImageFilter
  *
- * \ingroup SingleThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
@@ -200,9 +199,10 @@ protected:
   using ConsecutiveVectorType     = typename ScanlineFunctions::ConsecutiveVectorType;
   using WorkUnitData              = typename ScanlineFunctions::WorkUnitData;
 
+  LabelType m_ObjectCount;
+
 private:
   OutputPixelType m_BackgroundValue;
-  LabelType       m_ObjectCount;
 
   typename TInputImage::ConstPointer m_Input;
 };
@@ -114,13 +114,10 @@ ConnectedComponentImageFilter< TInputImage, TOutputImage, TMaskImage >
   // saves complicating the ones that come later
   this->InitUnion( nbOfLabels );
 
-  ProgressTransformer progress2( 0.55f, 0.6f, this );
+  // merge the labels of the neighbor runs, within and across the work units
+  ProgressTransformer progress2( 0.55f, 0.75f, this );
   multiThreader->ParallelizeArray(
-    0, this->m_WorkUnitResults.size(), [this]( SizeValueType index ) { this->ComputeEquivalence( index, true ); }, progress2.GetProcessObject());
-
-  ProgressTransformer progress3( 0.6f, 0.75f, this );
-  multiThreader->ParallelizeArray(
-    0, this->m_WorkUnitResults.size(), [this]( SizeValueType index ) { this->ComputeEquivalence( index, false ); }, progress3.GetProcessObject());
+    0, this->m_WorkUnitResults.size(), [this]( SizeValueType index ) { this->ComputeEquivalence( index ); }, progress2.GetProcessObject());
 
   // AfterThreadedGenerateData
   SizeValueType numberOfObjects = this->CreateConsecutive( m_BackgroundValue );
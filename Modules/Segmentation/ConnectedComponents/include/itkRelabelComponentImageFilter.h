@@ -67,9 +67,12 @@ namespace itk
  * controlled via methods in the superclass,
  * InPlaceImageFilter::InPlaceOn() and InPlaceImageFilter::InPlaceOff().
  *
+ * The sizes of the objects are counted by several threads in a histogram
+ * of the labels, or in maps when the largest label is not small compared
+ * to the number of pixels, and the output is relabeled by several threads.
+ *
  * \sa ConnectedComponentImageFilter, BinaryThresholdImageFilter, ThresholdImageFilter
  *
- * \ingroup SingleThreaded
  * \ingroup ITKConnectedComponents
  *
  * \wiki
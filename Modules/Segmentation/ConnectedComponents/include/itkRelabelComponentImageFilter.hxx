@@ -21,8 +21,11 @@
 #include "itkRelabelComponentImageFilter.h"
 #include "itkImageRegionIterator.h"
 #include "itkNumericTraits.h"
-#include "itkProgressReporter.h"
+#include "itkProgressTransformer.h"
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <mutex>
 
 namespace itk
 {
@@ -47,91 +50,126 @@ void
 RelabelComponentImageFilter< TInputImage, TOutputImage >
 ::GenerateData()
 {
-  SizeValueType i;
-
-  // Use a map to keep track of the size of each object.  Object
-  // number -> ObjectType (which has Object number and the two sizes)
-  using MapType = std::map< LabelType, RelabelComponentObjectType >;
-  MapType sizeMap;
-  typename MapType::iterator mapIt;
-  using MapValueType = typename MapType::value_type;
-
   // Get the input and the output
   typename TInputImage::ConstPointer input = this->GetInput();
   typename TOutputImage::Pointer output = this->GetOutput();
 
-  // Setup a progress reporter.  We have 2 stages to the algorithm so
-  // use the total number of pixels accessed. We walk the entire input
-  // in the first pass, then walk just the output requested region in
-  // the second pass.
-  ProgressReporter progress( this, 0,
-                             input->GetRequestedRegion().GetNumberOfPixels()
-                             + output->GetRequestedRegion().GetNumberOfPixels() );
+  const RegionType inputRegion = input->GetRequestedRegion();
+
+  MultiThreaderBase* multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
 
   // Calculate the size of pixel
   float physicalPixelSize = 1.0;
-  for ( i = 0; i < TInputImage::ImageDimension; ++i )
+  for ( unsigned int i = 0; i < TInputImage::ImageDimension; ++i )
     {
     physicalPixelSize *= input->GetSpacing()[i];
     }
 
-  RelabelComponentObjectType initialSize;
-  initialSize.m_SizeInPixels = 1;
-  initialSize.m_SizeInPhysicalUnits = physicalPixelSize;
-
-  // First pass: walk the entire input image and determine what
-  // labels are used and the number of pixels used in each label.
-  //
-
-  // walk the input
-  ImageRegionConstIterator< InputImageType > it( input, input->GetRequestedRegion() );
-  it.GoToBegin();
-
-  while ( !it.IsAtEnd() )
+  // First pass: walk the entire input image and determine the largest
+  // label, to choose between a histogram and a map to count the pixels of
+  // the labels.
+  LabelType  maximumLabel = NumericTraits< LabelType >::ZeroValue();
+  std::mutex mutex;
+  ProgressTransformer progress1( 0.0f, 0.2f, this );
+  multiThreader->template ParallelizeImageRegion< ImageDimension >(
+    inputRegion,
+    [&]( const RegionType & region )
     {
-    // Get the input pixel value
-    const auto inputValue = static_cast< LabelType >( it.Get() );
-
-    // if the input pixel is not the background
-    if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
-      {
-      // Does this label already exist
-      mapIt = sizeMap.find(inputValue);
-      if ( mapIt == sizeMap.end() )
+      LabelType workUnitMaximum = NumericTraits< LabelType >::ZeroValue();
+      for ( ImageRegionConstIterator< InputImageType > it( input, region ); !it.IsAtEnd(); ++it )
         {
-        // label is not currently in the map
-        initialSize.m_ObjectNumber = inputValue;
-        sizeMap.insert( MapValueType(inputValue, initialSize) );
+        workUnitMaximum = std::max( workUnitMaximum, static_cast< LabelType >( it.Get() ) );
         }
-      else
+      std::lock_guard< std::mutex > lock( mutex );
+      maximumLabel = std::max( maximumLabel, workUnitMaximum );
+    },
+    progress1.GetProcessObject() );
+
+  // Second pass: count the pixels of the labels. When the largest label is
+  // smaller than a 16th of the number of pixels, so that the histogram and
+  // the relabel table take at most about a byte per pixel, the work units
+  // accumulate the runs of pixels with the same label in a shared
+  // histogram; otherwise, each work unit counts them in its own map.
+  const bool useHistogram = maximumLabel < inputRegion.GetNumberOfPixels() / 16;
+  using HistogramType = std::vector< std::atomic< ObjectSizeType > >;
+  HistogramType histogram( useHistogram ? static_cast< SizeValueType >( maximumLabel ) + 1 : 0 );
+  using MapType = std::map< LabelType, ObjectSizeType >;
+  MapType sizeMap;
+
+  ProgressTransformer progress2( 0.2f, 0.6f, this );
+  multiThreader->template ParallelizeImageRegion< ImageDimension >(
+    inputRegion,
+    [&]( const RegionType & region )
+    {
+      MapType workUnitSizeMap;
+      LabelType runLabel = NumericTraits< LabelType >::ZeroValue();
+      ObjectSizeType runLength = 0;
+      auto addRun = [&]()
         {
-        // label is already in the map, update the values
-        ( *mapIt ).second.m_SizeInPixels++;
-        ( *mapIt ).second.m_SizeInPhysicalUnits += physicalPixelSize;
+          if ( runLabel != NumericTraits< LabelType >::ZeroValue() )
+            {
+            if ( useHistogram )
+              {
+              histogram[runLabel].fetch_add( runLength, std::memory_order_relaxed );
+              }
+            else
+              {
+              workUnitSizeMap[runLabel] += runLength;
+              }
+            }
+        };
+      for ( ImageRegionConstIterator< InputImageType > it( input, region ); !it.IsAtEnd(); ++it )
+        {
+        const auto inputValue = static_cast< LabelType >( it.Get() );
+        if ( inputValue == runLabel )
+          {
+          ++runLength;
+          }
+        else
+          {
+          addRun();
+          runLabel = inputValue;
+          runLength = 1;
+          }
         }
-      }
+      addRun();
 
-    // increment the iterators
-    ++it;
-    progress.CompletedPixel();
-    }
+      if ( !useHistogram )
+        {
+        std::lock_guard< std::mutex > lock( mutex );
+        for ( const auto & labelSize : workUnitSizeMap )
+          {
+          sizeMap[labelSize.first] += labelSize.second;
+          }
+        }
+    },
+    progress2.GetProcessObject() );
 
   // Now we need to reorder the labels. Use the m_ObjectSortingOrder
-  // to determine how to sort the objects. Define a map for converting
-  // input labels to output labels.
-  //
+  // to determine how to sort the objects. Copy the labels in the
+  // increasing order to a vector so we can sort it.
   using VectorType = std::vector< RelabelComponentObjectType >;
   VectorType sizeVector;
-  typename VectorType::iterator vit;
-
-  using RelabelMapType = std::map< LabelType, LabelType >;
-  using RelabelMapValueType = typename RelabelMapType::value_type;
-  RelabelMapType relabelMap;
-
-  // copy the original object map to a vector so we can sort it
-  for ( mapIt = sizeMap.begin(); mapIt != sizeMap.end(); ++mapIt )
+  if ( useHistogram )
+    {
+    for ( SizeValueType label = 1; label < histogram.size(); ++label )
+      {
+      const ObjectSizeType size = histogram[label].load( std::memory_order_relaxed );
+      if ( size > 0 )
+        {
+        sizeVector.push_back( RelabelComponentObjectType{ static_cast< LabelType >( label ), size,
+                                                          static_cast< float >( size ) * physicalPixelSize } );
+        }
+      }
+    }
+  else
     {
-    sizeVector.push_back( ( *mapIt ).second );
+    for ( const auto & labelSize : sizeMap )
+      {
+      sizeVector.push_back( RelabelComponentObjectType{ labelSize.first, labelSize.second,
+                                                        static_cast< float >( labelSize.second ) * physicalPixelSize } );
+      }
     }
 
   // Sort the objects by size by default, unless m_SortByObjectSize
@@ -145,6 +183,10 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 
   // create a lookup table to map the input label to the output label.
   // cache the object sizes for later access by the user
+  using RelabelMapType = std::map< LabelType, LabelType >;
+  RelabelMapType relabelMap;
+  std::vector< LabelType > relabelTable( histogram.size(), NumericTraits< LabelType >::ZeroValue() );
+
   m_NumberOfObjects = static_cast<LabelType>( sizeVector.size() );
   m_OriginalNumberOfObjects = static_cast<LabelType>( sizeVector.size() );
   m_SizeOfObjectsInPixels.clear();
@@ -152,26 +194,33 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
   m_SizeOfObjectsInPhysicalUnits.clear();
   m_SizeOfObjectsInPhysicalUnits.resize(m_NumberOfObjects);
   int NumberOfObjectsRemoved = 0;
-  for ( i = 0, vit = sizeVector.begin(); vit != sizeVector.end(); ++vit, ++i )
+  SizeValueType i = 0;
+  for ( typename VectorType::const_iterator vit = sizeVector.begin(); vit != sizeVector.end(); ++vit, ++i )
     {
-    // if we find an object smaller than the minimum size, we
-    // terminate the loop.
+    // map small objects to the background, otherwise map the input label
+    // to the output label (Note we use i+1 in the map since index 0 is
+    // the background)
+    LabelType outputLabel = NumericTraits< LabelType >::ZeroValue();
     if ( m_MinimumObjectSize > 0 && ( *vit ).m_SizeInPixels < m_MinimumObjectSize )
       {
-      // map small objects to the background
       NumberOfObjectsRemoved++;
-      relabelMap.insert( RelabelMapValueType( ( *vit ).m_ObjectNumber, 0 ) );
       }
     else
       {
-      // map for input labels to output labels (Note we use i+1 in the
-      // map since index 0 is the background)
-      relabelMap.insert( RelabelMapValueType( ( *vit ).m_ObjectNumber, i + 1 ) );
+      outputLabel = static_cast< LabelType >( i + 1 );
 
       // cache object sizes for later access by the user
       m_SizeOfObjectsInPixels[i] = ( *vit ).m_SizeInPixels;
       m_SizeOfObjectsInPhysicalUnits[i] = ( *vit ).m_SizeInPhysicalUnits;
       }
+    if ( useHistogram )
+      {
+      relabelTable[( *vit ).m_ObjectNumber] = outputLabel;
+      }
+    else
+      {
+      relabelMap.insert( typename RelabelMapType::value_type( ( *vit ).m_ObjectNumber, outputLabel ) );
+      }
     }
 
   // update number of objects and resize cache vectors if we have removed small
@@ -183,7 +232,7 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
     m_SizeOfObjectsInPhysicalUnits.resize(m_NumberOfObjects);
     }
 
-  // Second pass: walk just the output requested region and relabel
+  // Third pass: walk just the output requested region and relabel
   // the necessary pixels.
   //
 
@@ -192,35 +241,40 @@ RelabelComponentImageFilter< TInputImage, TOutputImage >
 
   // Remap the labels.  Note we only walk the region of the output
   // that was requested.  This may be a subset of the input image.
-  OutputPixelType                        outputValue;
-  ImageRegionIterator< OutputImageType > oit;
-  oit = ImageRegionIterator< OutputImageType >( output,
-                                                output->GetRequestedRegion() );
-  it = ImageRegionConstIterator< InputImageType >( input,
-                                                   output->GetRequestedRegion() );
-
-  it.GoToBegin();
-  oit.GoToBegin();
-  while ( !oit.IsAtEnd() )
+  ProgressTransformer progress3( 0.6f, 1.0f, this );
+  multiThreader->template ParallelizeImageRegion< ImageDimension >(
+    output->GetRequestedRegion(),
+    [&]( const RegionType & region )
     {
-    const auto inputValue = static_cast< LabelType >( it.Get() );
-
-    if ( inputValue != NumericTraits< LabelType >::ZeroValue() )
-      {
-      // lookup the mapped label
-      outputValue = static_cast< OutputPixelType >( relabelMap[inputValue] );
-      oit.Set(outputValue);
-      }
-    else
-      {
-      oit.Set(inputValue);
-      }
-
-    // increment the iterators
-    ++it;
-    ++oit;
-    progress.CompletedPixel();
-    }
+      ImageRegionConstIterator< InputImageType > it( input, region );
+      ImageRegionIterator< OutputImageType >     oit( output, region );
+      // the output label of the previous pixel is reused for the runs of
+      // pixels with the same label
+      LabelType       previousValue = NumericTraits< LabelType >::ZeroValue();
+      OutputPixelType outputValue = NumericTraits< OutputPixelType >::ZeroValue();
+      for ( ; !oit.IsAtEnd(); ++it, ++oit )
+        {
+        const auto inputValue = static_cast< LabelType >( it.Get() );
+        if ( inputValue != previousValue )
+          {
+          previousValue = inputValue;
+          if ( inputValue == NumericTraits< LabelType >::ZeroValue() )
+            {
+            outputValue = static_cast< OutputPixelType >( it.Get() );
+            }
+          else if ( useHistogram )
+            {
+            outputValue = static_cast< OutputPixelType >( relabelTable[inputValue] );
+            }
+          else
+            {
+            outputValue = static_cast< OutputPixelType >( relabelMap.find( inputValue )->second );
+            }
+          }
+        oit.Set(outputValue);
+        }
+    },
+    progress3.GetProcessObject() );
 }
 
 template< typename TInputImage, typename TOutputImage >
@@ -0,0 +1,236 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkConnectedComponentImageFilter.h"
+#include "itkScalarConnectedComponentImageFilter.h"
+#include "itkRelabelComponentImageFilter.h"
+#include "itkRandomImageSource.h"
+#include "itkTestingComparisonImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include <algorithm>
+#include <queue>
+
+/*
+ * Label random 3D images of several sizes with several work units, with and without mask,
+ * and compare the labels to a flood fill in raster order. The images have
+ * lines of one or two pixels, so that the lines of the image wrap around
+ * close to each other. Also relabel the objects, with dense and with sparse
+ * labels.
+ */
+namespace
+{
+using ImageType = itk::Image< short, 3 >;
+using LabelImageType = itk::Image< unsigned int, 3 >;
+using MaskImageType = itk::Image< unsigned char, 3 >;
+
+// Label the pixels joined to their face (or face, edge and vertex)
+// neighbors, in the order of their first pixel.
+template< typename TJoin >
+LabelImageType::Pointer
+FloodFill( const ImageType * image, const MaskImageType * mask, bool fullyConnected, TJoin join )
+{
+  const ImageType::RegionType region = image->GetLargestPossibleRegion();
+  const itk::SizeValueType numberOfPixels = region.GetNumberOfPixels();
+  LabelImageType::Pointer labelImage = LabelImageType::New();
+  labelImage->SetRegions( region );
+  labelImage->Allocate();
+  labelImage->FillBuffer( 0 );
+  LabelImageType::PixelType * labels = labelImage->GetBufferPointer();
+  unsigned int numberOfLabels = 0;
+  for( itk::SizeValueType seed = 0; seed < numberOfPixels; ++seed )
+    {
+    if( labels[seed] != 0 || !join( seed, seed ) || ( mask && mask->GetBufferPointer()[seed] == 0 ) )
+      {
+      continue;
+      }
+    labels[seed] = ++numberOfLabels;
+    std::queue< itk::SizeValueType > queue;
+    queue.push( seed );
+    while( !queue.empty() )
+      {
+      const ImageType::IndexType index = image->ComputeIndex( queue.front() );
+      const itk::SizeValueType current = queue.front();
+      queue.pop();
+      ImageType::OffsetType offset;
+      for( offset[2] = -1; offset[2] <= 1; ++offset[2] )
+        {
+        for( offset[1] = -1; offset[1] <= 1; ++offset[1] )
+          {
+          for( offset[0] = -1; offset[0] <= 1; ++offset[0] )
+            {
+            const int distance = std::abs( offset[0] ) + std::abs( offset[1] ) + std::abs( offset[2] );
+            if( distance == 0 || ( !fullyConnected && distance > 1 ) || !region.IsInside( index + offset ) )
+              {
+              continue;
+              }
+            const itk::SizeValueType neighbor = image->ComputeOffset( index + offset );
+            if( labels[neighbor] == 0 && ( !mask || mask->GetBufferPointer()[neighbor] != 0 )
+                && join( current, neighbor ) )
+              {
+              labels[neighbor] = numberOfLabels;
+              queue.push( neighbor );
+              }
+            }
+          }
+        }
+      }
+    }
+  return labelImage;
+}
+}
+
+int itkConnectedComponentImageFilterWorkUnitsTest( int, char *[] )
+{
+  using ComparisonType = itk::Testing::ComparisonImageFilter< LabelImageType, LabelImageType >;
+
+  for( unsigned int trial = 0; trial < 16; ++trial )
+    {
+    ImageType::SizeType size;
+    size[0] = 7 + ( 13 * trial ) % 40;
+    size[1] = 1 + ( trial % 2 ) + ( trial < 8 ? 0 : ( 7 * trial ) % 20 );
+    size[2] = 1 + ( 11 * trial + 3 ) % 15;
+    const bool fullyConnected = ( trial / 2 ) % 2;
+    const bool useMask = ( trial / 4 ) % 2;
+    const unsigned int numberOfWorkUnits = 1 + trial % 5;
+    std::cout << "Size: " << size << ", FullyConnected: " << fullyConnected << ", mask: " << useMask
+              << ", work units: " << numberOfWorkUnits << std::endl;
+
+    using RandomSourceType = itk::RandomImageSource< ImageType >;
+    RandomSourceType::Pointer source = RandomSourceType::New();
+    source->SetSize( size );
+    source->SetMin( 0 );
+    source->SetMax( 4 );
+    source->SetNumberOfWorkUnits( 1 );
+    TRY_EXPECT_NO_EXCEPTION( source->Update() );
+    ImageType::Pointer image = source->GetOutput();
+    const short * buffer = image->GetBufferPointer();
+
+    // about three quarters of the pixels, unrelated to the image values
+    MaskImageType::Pointer mask = MaskImageType::New();
+    mask->SetRegions( size );
+    mask->Allocate();
+    for( itk::SizeValueType i = 0; i < mask->GetLargestPossibleRegion().GetNumberOfPixels(); ++i )
+      {
+      mask->GetBufferPointer()[i] = ( 37 * i ) % 11 < 8;
+      }
+
+    // binary objects
+    using FilterType = itk::ConnectedComponentImageFilter< ImageType, LabelImageType, MaskImageType >;
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput( image );
+    if( useMask )
+      {
+      filter->SetMaskImage( mask );
+      }
+    filter->SetFullyConnected( fullyConnected );
+    filter->SetBackgroundValue( 0 );
+    filter->SetNumberOfWorkUnits( numberOfWorkUnits );
+    LabelImageType::Pointer binaryLabels = FloodFill( image, useMask ? mask.GetPointer() : nullptr, fullyConnected,
+      [buffer]( itk::SizeValueType a, itk::SizeValueType b ) { return buffer[a] != 0 && buffer[b] != 0; } );
+    ComparisonType::Pointer binaryComparison = ComparisonType::New();
+    binaryComparison->SetValidInput( binaryLabels );
+    binaryComparison->SetTestInput( filter->GetOutput() );
+    TRY_EXPECT_NO_EXCEPTION( binaryComparison->Update() );
+    TEST_EXPECT_EQUAL( binaryComparison->GetNumberOfPixelsWithDifferences(), 0u );
+    const LabelImageType::PixelType * binaryBuffer = binaryLabels->GetBufferPointer();
+    const itk::SizeValueType numberOfPixels = binaryLabels->GetLargestPossibleRegion().GetNumberOfPixels();
+    TEST_EXPECT_EQUAL( filter->GetObjectCount(), *std::max_element( binaryBuffer, binaryBuffer + numberOfPixels ) );
+
+    // objects of similar pixels
+    using ScalarFilterType = itk::ScalarConnectedComponentImageFilter< ImageType, LabelImageType, MaskImageType >;
+    ScalarFilterType::Pointer scalarFilter = ScalarFilterType::New();
+    scalarFilter->SetInput( image );
+    if( useMask )
+      {
+      scalarFilter->SetMaskImage( mask );
+      }
+    scalarFilter->SetFullyConnected( fullyConnected );
+    scalarFilter->SetDistanceThreshold( 1 );
+    scalarFilter->SetNumberOfWorkUnits( numberOfWorkUnits );
+    LabelImageType::Pointer scalarLabels = FloodFill( image, useMask ? mask.GetPointer() : nullptr, fullyConnected,
+      [buffer]( itk::SizeValueType a, itk::SizeValueType b ) { return std::abs( buffer[a] - buffer[b] ) <= 1; } );
+    ComparisonType::Pointer scalarComparison = ComparisonType::New();
+    scalarComparison->SetValidInput( scalarLabels );
+    scalarComparison->SetTestInput( scalarFilter->GetOutput() );
+    TRY_EXPECT_NO_EXCEPTION( scalarComparison->Update() );
+    TEST_EXPECT_EQUAL( scalarComparison->GetNumberOfPixelsWithDifferences(), 0u );
+    const LabelImageType::PixelType * scalarBuffer = scalarLabels->GetBufferPointer();
+    TEST_EXPECT_EQUAL( scalarFilter->GetObjectCount(), *std::max_element( scalarBuffer, scalarBuffer + numberOfPixels ) );
+
+    // the objects sorted by size, with the labels in increasing order for
+    // the objects of the same size
+    using RelabelFilterType = itk::RelabelComponentImageFilter< LabelImageType, LabelImageType >;
+    RelabelFilterType::Pointer relabel = RelabelFilterType::New();
+    relabel->SetInput( scalarFilter->GetOutput() );
+    relabel->SetNumberOfWorkUnits( numberOfWorkUnits );
+    TRY_EXPECT_NO_EXCEPTION( relabel->Update() );
+    std::vector< itk::SizeValueType > sizes( scalarFilter->GetObjectCount() + 1, 0 );
+    for( itk::SizeValueType i = 0; i < numberOfPixels; ++i )
+      {
+      ++sizes[scalarBuffer[i]];
+      }
+    std::vector< unsigned int > order;
+    for( unsigned int label = 1; label < sizes.size(); ++label )
+      {
+      order.push_back( label );
+      }
+    std::stable_sort( order.begin(), order.end(),
+                      [&sizes]( unsigned int a, unsigned int b ) { return sizes[a] > sizes[b]; } );
+    std::vector< unsigned int > relabelTable( sizes.size(), 0 );
+    for( unsigned int i = 0; i < order.size(); ++i )
+      {
+      relabelTable[order[i]] = i + 1;
+      TEST_EXPECT_EQUAL( relabel->GetSizeOfObjectInPixels( i + 1 ), sizes[order[i]] );
+      }
+    LabelImageType::Pointer relabeledLabels = LabelImageType::New();
+    relabeledLabels->SetRegions( size );
+    relabeledLabels->Allocate();
+    for( itk::SizeValueType i = 0; i < numberOfPixels; ++i )
+      {
+      relabeledLabels->GetBufferPointer()[i] = relabelTable[scalarBuffer[i]];
+      }
+    ComparisonType::Pointer relabelComparison = ComparisonType::New();
+    relabelComparison->SetValidInput( relabeledLabels );
+    relabelComparison->SetTestInput( relabel->GetOutput() );
+    TRY_EXPECT_NO_EXCEPTION( relabelComparison->Update() );
+    TEST_EXPECT_EQUAL( relabelComparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+    // the same objects with labels larger than the number of pixels, which
+    // are counted in a map instead of a histogram
+    LabelImageType::Pointer sparseLabels = LabelImageType::New();
+    sparseLabels->SetRegions( size );
+    sparseLabels->Allocate();
+    const auto labelScale = static_cast< unsigned int >( numberOfPixels );
+    for( itk::SizeValueType i = 0; i < numberOfPixels; ++i )
+      {
+      sparseLabels->GetBufferPointer()[i] = scalarBuffer[i] * labelScale;
+      }
+    RelabelFilterType::Pointer sparseRelabel = RelabelFilterType::New();
+    sparseRelabel->SetInput( sparseLabels );
+    sparseRelabel->SetNumberOfWorkUnits( numberOfWorkUnits );
+    ComparisonType::Pointer sparseComparison = ComparisonType::New();
+    sparseComparison->SetValidInput( relabeledLabels );
+    sparseComparison->SetTestInput( sparseRelabel->GetOutput() );
+    TRY_EXPECT_NO_EXCEPTION( sparseComparison->Update() );
+    TEST_EXPECT_EQUAL( sparseComparison->GetNumberOfPixelsWithDifferences(), 0u );
+    TEST_EXPECT_EQUAL( sparseRelabel->GetNumberOfObjects(), relabel->GetNumberOfObjects() );
+    }
+
+  return EXIT_SUCCESS;
+}
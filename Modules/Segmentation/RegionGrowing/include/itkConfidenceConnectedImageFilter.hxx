@@ -25,8 +25,8 @@
 #include "itkMeanImageFunction.h"
 #include "itkSumOfSquaresImageFunction.h"
 #include "itkBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
+#include "itkParallelFloodFill.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -139,21 +139,16 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
 ::GenerateData()
 {
   using FunctionType = BinaryThresholdImageFunction< InputImageType, double >;
-  using SecondFunctionType = BinaryThresholdImageFunction< OutputImageType, double >;
-
-  using IteratorType = FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType >;
-  using SecondIteratorType = FloodFilledImageFunctionConditionalConstIterator< InputImageType, SecondFunctionType >;
+  using FloodFillType = ParallelFloodFill< OutputImageType::ImageDimension >;
 
   unsigned int loop;
 
   typename Superclass::InputImageConstPointer inputImage  = this->GetInput();
   typename Superclass::OutputImagePointer outputImage = this->GetOutput();
 
-  // Zero the output
   OutputImageRegionType region = outputImage->GetRequestedRegion();
   outputImage->SetBufferedRegion(region);
   outputImage->Allocate();
-  outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
 
   // Compute the statistics of the seed point
   using MeanImageFunctionType = MeanImageFunction< InputImageType,
@@ -204,8 +199,9 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
 
     if ( num == 0 )
       {
-      this->UpdateProgress(1.0);
       // no seeds result in zero image
+      outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
+      this->UpdateProgress(1.0);
       return;
       }
 
@@ -236,8 +232,9 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
 
     if ( num == 0 )
       {
-      this->UpdateProgress(1.0);
       // no seeds result in zero image
+      outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
+      this->UpdateProgress(1.0);
       return;
       }
     m_Mean      = sum / double(num);
@@ -300,50 +297,64 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
     << "\nLower intensity = " << lower << ", Upper intensity = " << upper << "\nmean = " << m_Mean
     << " , std::sqrt(variance) = " << std::sqrt(m_Variance) );
 
-  // Segment the image, the iterator walks the output image (so Set()
-  // writes into the output image), starting at the seed point.  As
-  // the iterator walks, if the corresponding pixel in the input image
-  // (accessed via the "function" assigned to the iterator) is within
+  // Segment the image, the flood fill starts at the seed points.  If
+  // the pixel in the input image (accessed via the "function") is within
   // the [lower, upper] bounds prescribed, the pixel is added to the
-  // output segmentation and its neighbors become candidates for the
-  // iterator to walk.
-  IteratorType it = IteratorType (outputImage, function, m_Seeds);
-  it.GoToBegin();
-  while ( !it.IsAtEnd() )
+  // segmentation and its neighbors become candidates for the flood fill.
+  // The segmentation is kept in the flood fill and written in the output
+  // image after the last iteration.
+  FloodFillType floodFill(region);
+  floodFill.SetKeepIncludedIndices(true);
+  auto condition = [&function](const IndexType & index)
     {
-    it.Set(m_ReplaceValue);
-    ++it;
-    }
-
-  ProgressReporter progress(this, 0, region.GetNumberOfPixels() * m_NumberOfIterations);
+    return function->EvaluateAtIndex(index);
+    };
+  const float progressWeight = 1.0f / static_cast< float >( m_NumberOfIterations + 1 );
+  floodFill.Fill(m_Seeds, condition, this, 0.0f, progressWeight);
+
+  // The statistics are accumulated over chunks of the included pixels in
+  // parallel, and the chunks are added in order so that the result does
+  // not depend on the number of threads.
+  constexpr SizeValueType chunkSize = 16384;
+  std::vector< InputRealType > chunkSums;
+  std::vector< InputRealType > chunkSumsOfSquares;
 
   for ( loop = 0; loop < m_NumberOfIterations; ++loop )
     {
     // Now that we have an initial segmentation, let's recalculate the
-    // statistics.  Since we have already labelled the output, we visit
-    // pixels in the input image that have been set in the output image.
-    // Essentially, we flip the iterator around, so we walk the input
-    // image (so Get() will get pixel values from the input) and constrain
-    // iterator such it only visits pixels that were set in the output.
-    typename SecondFunctionType::Pointer secondFunction = SecondFunctionType::New();
-    secondFunction->SetInputImage (outputImage);
-    secondFunction->ThresholdBetween(m_ReplaceValue, m_ReplaceValue);
+    // statistics.  We visit the pixels in the input image that have been
+    // included by the flood fill.
+    const typename FloodFillType::SeedContainerType & includedIndices = floodFill.GetIncludedIndices();
+    const SizeValueType numberOfSamples = includedIndices.size();
+    const SizeValueType numberOfChunks = ( numberOfSamples + chunkSize - 1 ) / chunkSize;
+    chunkSums.assign(numberOfChunks, NumericTraits< InputRealType >::ZeroValue());
+    chunkSumsOfSquares.assign(numberOfChunks, NumericTraits< InputRealType >::ZeroValue());
+    this->GetMultiThreader()->ParallelizeArray(
+      0,
+      numberOfChunks,
+      [&](SizeValueType chunk)
+        {
+        InputRealType sum = NumericTraits< InputRealType >::ZeroValue();
+        InputRealType sumOfSquares = NumericTraits< InputRealType >::ZeroValue();
+        const SizeValueType end = std::min( ( chunk + 1 ) * chunkSize, numberOfSamples );
+        for ( SizeValueType i = chunk * chunkSize; i < end; ++i )
+          {
+          const auto value = static_cast< InputRealType >( inputImage->GetPixel( includedIndices[i] ) );
+          sum += value;
+          sumOfSquares += value * value;
+          }
+        chunkSums[chunk] = sum;
+        chunkSumsOfSquares[chunk] = sumOfSquares;
+        },
+      nullptr);
 
     typename NumericTraits< typename InputImageType::PixelType >::RealType sum, sumOfSquares;
     sum = NumericTraits< InputRealType >::ZeroValue();
     sumOfSquares = NumericTraits< InputRealType >::ZeroValue();
-    typename TOutputImage::SizeValueType numberOfSamples = 0;
-
-    SecondIteratorType sit =
-      SecondIteratorType (inputImage, secondFunction, m_Seeds);
-    sit.GoToBegin();
-    while ( !sit.IsAtEnd() )
+    for ( SizeValueType chunk = 0; chunk < numberOfChunks; ++chunk )
       {
-      const auto value = static_cast< InputRealType >( sit.Get() );
-      sum += value;
-      sumOfSquares += value * value;
-      ++numberOfSamples;
-      ++sit;
+      sum += chunkSums[chunk];
+      sumOfSquares += chunkSumsOfSquares[chunk];
       }
     m_Mean      = sum / double(numberOfSamples);
     m_Variance  = ( sumOfSquares - ( sum * sum / double(numberOfSamples) ) ) / ( double(numberOfSamples) - 1.0 );
@@ -396,38 +407,13 @@ ConfidenceConnectedImageFilter< TInputImage, TOutputImage >
                    << " , std::sqrt(variance) = " << std::sqrt(m_Variance) );
     itkDebugMacro(<< "\nsum = " << sum << ", sumOfSquares = " << sumOfSquares << "\nnum = " << numberOfSamples);
 
-    // Rerun the segmentation, the iterator walks the output image,
-    // starting at the seed point.  As the iterator walks, if the
-    // corresponding pixel in the input image (accessed via the
-    // "function" assigned to the iterator) is within the [lower,
-    // upper] bounds prescribed, the pixel is added to the output
-    // segmentation and its neighbors become candidates for the
-    // iterator to walk.
-    outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
-    IteratorType thirdIt = IteratorType (outputImage, function, m_Seeds);
-    thirdIt.GoToBegin();
-    try
-      {
-      while ( !thirdIt.IsAtEnd() )
-        {
-        thirdIt.Set(m_ReplaceValue);
-        ++thirdIt;
-        progress.CompletedPixel();  // potential exception thrown here
-        }
-      }
-    catch ( ProcessAborted & )
-      {
-      break; // interrupt the iterations loop
-      }
+    // Rerun the segmentation from the seed points with the refined
+    // estimates of the mean and variance.
+    floodFill.Fill( m_Seeds, condition, this, static_cast< float >( loop + 1 ) * progressWeight, progressWeight );
     }  // end iteration loop
 
-  if ( this->GetAbortGenerateData() )
-    {
-    ProcessAborted e(__FILE__, __LINE__);
-    e.SetLocation(ITK_LOCATION);
-    e.SetDescription("Process aborted.");
-    throw ProcessAborted(__FILE__, __LINE__);
-    }
+  floodFill.WriteMask( outputImage.GetPointer(), m_ReplaceValue, NumericTraits< OutputImagePixelType >::ZeroValue(), this );
+  this->UpdateProgress(1.0f);
 }
 } // end namespace itk
 
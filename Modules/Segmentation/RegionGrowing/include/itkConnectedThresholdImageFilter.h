@@ -30,6 +30,10 @@ namespace itk
  * connected to an initial Seed AND lie within a Lower and Upper
  * threshold range.
  *
+ * The region is grown with several threads by ParallelFloodFill.
+ *
+ * \sa ParallelFloodFill
+ *
  * \ingroup RegionGrowingSegmentation
  * \ingroup ITKRegionGrowing
  */
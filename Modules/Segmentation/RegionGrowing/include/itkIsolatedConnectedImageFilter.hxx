@@ -20,12 +20,11 @@
 
 #include "itkIsolatedConnectedImageFilter.h"
 #include "itkBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
+#include "itkParallelFloodFill.h"
 #include "itkIterationReporter.h"
 #include "itkMath.h"
 #include "itkNumericTraits.h"
-#include "itkMath.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -210,21 +209,30 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
     itkExceptionMacro("Seeds2 container is empty");
     }
 
-  // Zero the output
   OutputImageRegionType region = outputImage->GetRequestedRegion();
   outputImage->SetBufferedRegion(region);
   outputImage->Allocate();
-  outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
 
   using FunctionType = BinaryThresholdImageFunction< InputImageType >;
-  using IteratorType = FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType >;
+  using FloodFillType = ParallelFloodFill< OutputImageType::ImageDimension >;
 
   typename FunctionType::Pointer function = FunctionType::New();
   function->SetInputImage (inputImage);
 
+  auto condition = [&function](const IndexType & index)
+    {
+    return function->EvaluateAtIndex(index);
+    };
+  // The binary search only needs to know whether any of the second seeds
+  // is included, so the flood fill stops at the first one.
+  auto isSeed2 = [this](const IndexType & index)
+    {
+    return std::find(this->m_Seeds2.begin(), this->m_Seeds2.end(), index) != this->m_Seeds2.end();
+    };
+
   float             progressWeight = 0.0f;
   float             cumulatedProgress = 0.0f;
-  IteratorType      it = IteratorType (outputImage, function, m_Seeds1);
+  FloodFillType     floodFill(region);
   IterationReporter iterate(this, 0, 1);
 
   // If the upper threshold has not been set, find it.
@@ -245,36 +253,12 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
 
     while ( lower + m_IsolatedValueTolerance < guess )
       {
-      ProgressReporter progress(this, 0, region.GetNumberOfPixels(), 100, cumulatedProgress, progressWeight);
-      cumulatedProgress += progressWeight;
-      outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
       function->ThresholdBetween ( m_Lower, static_cast< InputImagePixelType >( guess ) );
-      it.GoToBegin();
-      while ( !it.IsAtEnd() )
-        {
-        it.Set(m_ReplaceValue);
-        if ( it.GetIndex() == *m_Seeds2.begin() )
-          {
-          break;
-          }
-        ++it;
-        progress.CompletedPixel(); // potential exception thrown here
-        }
-      // If any of second seeds are included, decrease the upper bound.
-      // Find the sum of the intensities in m_Seeds2.  If the second
-      // seeds are not included, the sum should be zero.  Otherwise,
-      // it will be other than zero.
-      InputRealType seedIntensitySum = NumericTraits< InputRealType >::ZeroValue();
-      typename SeedsContainerType::const_iterator si = m_Seeds2.begin();
-      typename SeedsContainerType::const_iterator li = m_Seeds2.end();
-      while ( si != li )
-        {
-        const auto value = static_cast< InputRealType >( outputImage->GetPixel(*si) );
-        seedIntensitySum += value;
-        si++;
-        }
+      floodFill.FillUntil(m_Seeds1, condition, isSeed2, this, cumulatedProgress, progressWeight);
+      cumulatedProgress += progressWeight;
 
-      if ( Math::NotExactlyEquals(seedIntensitySum, NumericTraits< InputRealType >::ZeroValue()) )
+      // If any of second seeds are included, decrease the upper bound.
+      if ( floodFill.GetStopped() )
         {
         upper = guess;
         }
@@ -310,36 +294,12 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
 
     while ( guess < upper - m_IsolatedValueTolerance )
       {
-      ProgressReporter progress(this, 0, region.GetNumberOfPixels(), 100, cumulatedProgress, progressWeight);
-      cumulatedProgress += progressWeight;
-      outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
       function->ThresholdBetween (static_cast< InputImagePixelType >( guess ), m_Upper);
-      it.GoToBegin();
-      while ( !it.IsAtEnd() )
-        {
-        it.Set(m_ReplaceValue);
-        if ( it.GetIndex() == *m_Seeds2.begin() )
-          {
-          break;
-          }
-        ++it;
-        progress.CompletedPixel(); // potential exception thrown here
-        }
-      // If any of second seeds are included, increase the lower bound.
-      // Find the sum of the intensities in m_Seeds2.  If the second
-      // seeds are not included, the sum should be zero.  Otherwise,
-      // it will be other than zero.
-      InputRealType seedIntensitySum = NumericTraits< InputRealType >::ZeroValue();
-      typename SeedsContainerType::const_iterator si = m_Seeds2.begin();
-      typename SeedsContainerType::const_iterator li = m_Seeds2.end();
-      while ( si != li )
-        {
-        const auto value = static_cast< InputRealType >( outputImage->GetPixel(*si) );
-        seedIntensitySum += value;
-        si++;
-        }
+      floodFill.FillUntil(m_Seeds1, condition, isSeed2, this, cumulatedProgress, progressWeight);
+      cumulatedProgress += progressWeight;
 
-      if ( Math::NotExactlyEquals(seedIntensitySum, NumericTraits< InputRealType >::ZeroValue()) )
+      // If any of second seeds are included, increase the lower bound.
+      if ( floodFill.GetStopped() )
         {
         lower = guess;
         }
@@ -360,9 +320,6 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
     }
 
   // now rerun the algorithm with the thresholds that separate the seeds.
-  ProgressReporter progress(this, 0, region.GetNumberOfPixels(), 100, cumulatedProgress, progressWeight);
-
-  outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
   if ( m_FindUpperThreshold )
     {
     function->ThresholdBetween (m_Lower, m_IsolatedValue);
@@ -371,13 +328,8 @@ IsolatedConnectedImageFilter< TInputImage, TOutputImage >
     {
     function->ThresholdBetween (m_IsolatedValue, m_Upper);
     }
-  it.GoToBegin();
-  while ( !it.IsAtEnd() )
-    {
-    it.Set(m_ReplaceValue);
-    ++it;
-    progress.CompletedPixel(); // potential exception thrown here
-    }
+  floodFill.Fill(m_Seeds1, condition, this, cumulatedProgress, progressWeight);
+  floodFill.WriteMask( outputImage.GetPointer(), m_ReplaceValue, NumericTraits< OutputImagePixelType >::ZeroValue(), this );
 
   // If any of the second seeds are included or some of the first
   // seeds are not included, the algorithm could not find any threshold
@@ -20,8 +20,7 @@
 
 #include "itkNeighborhoodConnectedImageFilter.h"
 #include "itkNeighborhoodBinaryThresholdImageFunction.h"
-#include "itkFloodFilledImageFunctionConditionalIterator.h"
-#include "itkProgressReporter.h"
+#include "itkParallelFloodFill.h"
 
 namespace itk
 {
@@ -120,28 +119,25 @@ NeighborhoodConnectedImageFilter< TInputImage, TOutputImage >
   typename Superclass::InputImageConstPointer inputImage  = this->GetInput();
   typename Superclass::OutputImagePointer outputImage = this->GetOutput();
 
-  // Zero the output
-  outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
+  const OutputImageRegionType region = outputImage->GetRequestedRegion();
+  outputImage->SetBufferedRegion(region);
   outputImage->Allocate();
-  outputImage->FillBuffer (NumericTraits< OutputImagePixelType >::ZeroValue());
 
   using FunctionType = NeighborhoodBinaryThresholdImageFunction< InputImageType >;
-  using IteratorType = FloodFilledImageFunctionConditionalIterator< OutputImageType, FunctionType >;
 
   typename FunctionType::Pointer function = FunctionType::New();
   function->SetInputImage (inputImage);
   function->ThresholdBetween (m_Lower, m_Upper);
   function->SetRadius (m_Radius);
-  IteratorType it = IteratorType (outputImage, function, m_Seeds);
 
-  ProgressReporter progress( this, 0,
-                             outputImage->GetRequestedRegion().GetNumberOfPixels() );
-  while ( !it.IsAtEnd() )
-    {
-    it.Set(m_ReplaceValue);
-    ++it;
-    progress.CompletedPixel();
-    }
+  ParallelFloodFill< OutputImageDimension > floodFill(region);
+  floodFill.Fill( m_Seeds,
+                  [&function](const IndexType & index)
+                    {
+                    return function->EvaluateAtIndex(index);
+                    },
+                  this );
+  floodFill.WriteMask( outputImage.GetPointer(), m_ReplaceValue, NumericTraits< OutputImagePixelType >::ZeroValue(), this );
 }
 } // end namespace itk
 
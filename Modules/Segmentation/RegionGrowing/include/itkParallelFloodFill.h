@@ -0,0 +1,238 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParallelFloodFill_h
+#define itkParallelFloodFill_h
+
+#include "itkImageRegion.h"
+#include "itkIntTypes.h"
+#include "itkProcessObject.h"
+#include <atomic>
+#include <vector>
+
+namespace itk
+{
+/** \class ParallelFloodFill
+ * \brief Flood fill a region from seeds with several threads.
+ *
+ * The region is grown from the seeds by a breadth-first search, one
+ * level of the search at a time: the current frontier is split among the
+ * work units, each work unit collects the newly included neighbors in its
+ * own part of the next frontier, and the parts are concatenated before
+ * the next level. Small frontiers are processed by the calling thread,
+ * so that thin structures like vessels do not pay for the threading of
+ * each level.
+ *
+ * A pixel is claimed by one work unit with an atomic operation on a
+ * bit-packed visited mask, so that the condition is evaluated only once
+ * per pixel. A second bit-packed mask records the included pixels, so
+ * that the fill needs two bits per pixel of the region instead of a
+ * full-size image.
+ *
+ * The included pixels are the same as with
+ * FloodFilledImageFunctionConditionalIterator (face connectivity) or
+ * ShapedFloodFilledImageFunctionConditionalIterator (full connectivity):
+ * a seed is included if it is inside the region and satisfies the
+ * condition, and a neighbor of an included pixel is included if it is
+ * inside the region and satisfies the condition. The condition is a
+ * callable taking the index of a pixel and returning a bool; it is called
+ * concurrently from several threads, which is safe for the
+ * EvaluateAtIndex() method of the image functions.
+ *
+ * \code
+ * ParallelFloodFill< ImageDimension > floodFill( region );
+ * floodFill.SetFullyConnected( true );
+ * floodFill.Fill( seeds, [function]( const IndexType & index )
+ *   { return function->EvaluateAtIndex( index ); }, this );
+ * floodFill.WriteMask( outputImage, replaceValue, zeroValue, this );
+ * \endcode
+ *
+ * \sa FloodFilledImageFunctionConditionalIterator
+ * \sa ConnectedThresholdImageFilter
+ *
+ * \ingroup ITKRegionGrowing
+ */
+template< unsigned int VDimension >
+class ITK_TEMPLATE_EXPORT ParallelFloodFill
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(ParallelFloodFill);
+
+  /** Standard class type aliases. */
+  using Self = ParallelFloodFill;
+
+  static constexpr unsigned int ImageDimension = VDimension;
+
+  using RegionType = ImageRegion< VDimension >;
+  using IndexType = typename RegionType::IndexType;
+  using OffsetType = typename RegionType::OffsetType;
+  using SeedContainerType = std::vector< IndexType >;
+
+  /** Prepare a flood fill restricted to a region. */
+  explicit ParallelFloodFill(const RegionType & region);
+
+  ~ParallelFloodFill() = default;
+
+  /** Whether the 3^N-1 neighbors of a pixel are visited, rather than
+   * only its 2N face neighbors. Default is false. */
+  void SetFullyConnected(bool fullyConnected);
+  bool GetFullyConnected() const
+  {
+    return m_FullyConnected;
+  }
+
+  /** Get the region of the flood fill. */
+  const RegionType & GetRegion() const
+  {
+    return m_Region;
+  }
+
+  /** Set the number of pixels of the frontier below which a level of the
+   * search is processed by the calling thread. Default is 4096. */
+  void SetMinimumFrontierSizeToSplit(SizeValueType size)
+  {
+    m_MinimumFrontierSizeToSplit = size;
+  }
+  SizeValueType GetMinimumFrontierSizeToSplit() const
+  {
+    return m_MinimumFrontierSizeToSplit;
+  }
+
+  /** Grow the region from the seeds, discarding the result of the previous
+   * fill, and return the number of included pixels. The multi-threader
+   * and the number of work units of the filter are used, and its progress
+   * is updated between initialProgress and initialProgress +
+   * progressWeight as the number of included pixels grows. ProcessAborted
+   * is thrown when the filter is aborted. The fill is single-threaded when
+   * filter is nullptr. */
+  template< typename TCondition >
+  SizeValueType Fill(const SeedContainerType & seeds, const TCondition & condition,
+                     ProcessObject *filter = nullptr,
+                     float initialProgress = 0.0f, float progressWeight = 1.0f);
+
+  /** Same as Fill(), but stop as soon as an included pixel satisfies
+   * stopCondition, a callable taking the index of a pixel and returning a
+   * bool. The included pixels are then a part of the region which Fill()
+   * would grow, and GetStopped() returns true. Like the condition,
+   * stopCondition is called concurrently from several threads. */
+  template< typename TCondition, typename TStopCondition >
+  SizeValueType FillUntil(const SeedContainerType & seeds, const TCondition & condition,
+                          const TStopCondition & stopCondition, ProcessObject *filter = nullptr,
+                          float initialProgress = 0.0f, float progressWeight = 1.0f);
+
+  /** Whether the last fill was stopped by the stop condition. */
+  bool GetStopped() const
+  {
+    return m_Stopped;
+  }
+
+  /** Whether the indices of the included pixels are kept by the fills.
+   * They are then sorted by level of the search, and in raster order in
+   * each level, so that their order does not depend on the number of work
+   * units. Default is false. */
+  void SetKeepIncludedIndices(bool keep)
+  {
+    m_KeepIncludedIndices = keep;
+  }
+  bool GetKeepIncludedIndices() const
+  {
+    return m_KeepIncludedIndices;
+  }
+
+  /** Get the indices of the pixels included by the last fill, when
+   * KeepIncludedIndices is enabled. */
+  const SeedContainerType & GetIncludedIndices() const
+  {
+    return m_IncludedIndices;
+  }
+
+  /** Whether a pixel was included by the last fill. */
+  bool IsIncluded(const IndexType & index) const
+  {
+    return m_Region.IsInside(index) && this->TestBit(m_Included, this->ComputeOffset(index));
+  }
+
+  /** Get the number of pixels included by the last fill. */
+  SizeValueType GetNumberOfIncludedPixels() const
+  {
+    return m_NumberOfIncludedPixels;
+  }
+
+  /** Write insideValue in the pixels included by the last fill and
+   * outsideValue in the other pixels of the region of the image, with the
+   * multi-threader of the filter when it is not nullptr. The buffered
+   * region of the image must contain the region of the flood fill. */
+  template< typename TImage >
+  void WriteMask(TImage *image, const typename TImage::PixelType & insideValue,
+                 const typename TImage::PixelType & outsideValue, ProcessObject *filter = nullptr) const;
+
+private:
+  using WordType = uint64_t;
+  using MaskType = std::vector< std::atomic< WordType > >;
+
+  static constexpr unsigned int BitsPerWord = 64;
+
+  SizeValueType ComputeOffset(const IndexType & index) const
+  {
+    SizeValueType offset = 0;
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      offset += static_cast< SizeValueType >( index[d] - m_Region.GetIndex(d) ) * m_Strides[d];
+      }
+    return offset;
+  }
+
+  static bool TestBit(const MaskType & mask, SizeValueType offset)
+  {
+    const WordType bit = WordType(1) << ( offset % BitsPerWord );
+    return ( mask[offset / BitsPerWord].load(std::memory_order_relaxed) & bit ) != 0;
+  }
+
+  /** Set a bit and return whether it was already set. */
+  static bool TestAndSetBit(MaskType & mask, SizeValueType offset)
+  {
+    const WordType bit = WordType(1) << ( offset % BitsPerWord );
+    return ( mask[offset / BitsPerWord].fetch_or(bit, std::memory_order_relaxed) & bit ) != 0;
+  }
+
+  /** Visit the neighbors of the pixels in [first, last) and append the
+   * newly included ones to next. */
+  template< typename TCondition, typename TStopCondition >
+  void ProcessFrontier(const IndexType *first, const IndexType *last,
+                       const TCondition & condition, const TStopCondition & stopCondition,
+                       SeedContainerType & next);
+
+  RegionType                     m_Region;
+  SizeValueType                  m_Strides[VDimension];
+  bool                           m_FullyConnected{ false };
+  std::vector< OffsetType >      m_NeighborOffsets;
+  std::vector< OffsetValueType > m_NeighborLinearOffsets;
+  SizeValueType                  m_MinimumFrontierSizeToSplit{ 4096 };
+  MaskType                       m_Visited;
+  MaskType                       m_Included;
+  SizeValueType                  m_NumberOfIncludedPixels{ 0 };
+  std::atomic< bool >            m_Stopped{ false };
+  bool                           m_KeepIncludedIndices{ false };
+  SeedContainerType              m_IncludedIndices;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkParallelFloodFill.hxx"
+#endif
+
+#endif
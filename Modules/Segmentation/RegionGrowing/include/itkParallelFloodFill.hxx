@@ -0,0 +1,319 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParallelFloodFill_hxx
+#define itkParallelFloodFill_hxx
+
+#include "itkParallelFloodFill.h"
+#include "itkImageScanlineIterator.h"
+#include "itkMultiThreaderBase.h"
+#include <algorithm>
+
+namespace itk
+{
+template< unsigned int VDimension >
+ParallelFloodFill< VDimension >
+::ParallelFloodFill(const RegionType & region):
+  m_Region( region )
+{
+  SizeValueType stride = 1;
+  for ( unsigned int d = 0; d < VDimension; ++d )
+    {
+    m_Strides[d] = stride;
+    stride *= m_Region.GetSize(d);
+    }
+  this->SetFullyConnected(false);
+}
+
+template< unsigned int VDimension >
+void
+ParallelFloodFill< VDimension >
+::SetFullyConnected(bool fullyConnected)
+{
+  m_FullyConnected = fullyConnected;
+  m_NeighborOffsets.clear();
+
+  OffsetType offset;
+  if ( m_FullyConnected )
+    {
+    SizeValueType numberOfNeighbors = 1;
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      numberOfNeighbors *= 3;
+      }
+    for ( SizeValueType n = 0; n < numberOfNeighbors; ++n )
+      {
+      SizeValueType remainder = n;
+      bool          isCenter = true;
+      for ( unsigned int d = 0; d < VDimension; ++d )
+        {
+        offset[d] = static_cast< OffsetValueType >( remainder % 3 ) - 1;
+        isCenter = isCenter && offset[d] == 0;
+        remainder /= 3;
+        }
+      if ( !isCenter )
+        {
+        m_NeighborOffsets.push_back(offset);
+        }
+      }
+    }
+  else
+    {
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      offset.Fill(0);
+      offset[d] = -1;
+      m_NeighborOffsets.push_back(offset);
+      offset[d] = 1;
+      m_NeighborOffsets.push_back(offset);
+      }
+    }
+
+  m_NeighborLinearOffsets.clear();
+  for ( const OffsetType & neighborOffset : m_NeighborOffsets )
+    {
+    OffsetValueType linearOffset = 0;
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      linearOffset += neighborOffset[d] * static_cast< OffsetValueType >( m_Strides[d] );
+      }
+    m_NeighborLinearOffsets.push_back(linearOffset);
+    }
+}
+
+template< unsigned int VDimension >
+template< typename TCondition >
+SizeValueType
+ParallelFloodFill< VDimension >
+::Fill(const SeedContainerType & seeds, const TCondition & condition, ProcessObject *filter,
+       float initialProgress, float progressWeight)
+{
+  return this->FillUntil(seeds, condition, [](const IndexType &) { return false; },
+                         filter, initialProgress, progressWeight);
+}
+
+template< unsigned int VDimension >
+template< typename TCondition, typename TStopCondition >
+SizeValueType
+ParallelFloodFill< VDimension >
+::FillUntil(const SeedContainerType & seeds, const TCondition & condition,
+            const TStopCondition & stopCondition, ProcessObject *filter,
+            float initialProgress, float progressWeight)
+{
+  const SizeValueType numberOfPixels = m_Region.GetNumberOfPixels();
+  const SizeValueType numberOfWords = ( numberOfPixels + BitsPerWord - 1 ) / BitsPerWord;
+  m_Visited = MaskType(numberOfWords);
+  m_Included = MaskType(numberOfWords);
+  m_NumberOfIncludedPixels = 0;
+  m_Stopped = false;
+  m_IncludedIndices.clear();
+
+  MultiThreaderBase *multiThreader = nullptr;
+  ThreadIdType       numberOfWorkUnits = 1;
+  if ( filter != nullptr )
+    {
+    multiThreader = filter->GetMultiThreader();
+    numberOfWorkUnits = filter->GetNumberOfWorkUnits();
+    multiThreader->SetNumberOfWorkUnits(numberOfWorkUnits);
+    }
+
+  SeedContainerType frontier;
+  for ( const IndexType & seed : seeds )
+    {
+    if ( m_Region.IsInside(seed) )
+      {
+      const SizeValueType offset = this->ComputeOffset(seed);
+      if ( !TestAndSetBit(m_Visited, offset) && condition(seed) )
+        {
+        TestAndSetBit(m_Included, offset);
+        frontier.push_back(seed);
+        if ( stopCondition(seed) )
+          {
+          m_Stopped = true;
+          }
+        }
+      }
+    }
+
+  SeedContainerType                next;
+  std::vector< SeedContainerType > nextParts;
+  SizeValueType                    reportedPercentage = 0;
+  while ( !frontier.empty() )
+    {
+    m_NumberOfIncludedPixels += frontier.size();
+    if ( m_KeepIncludedIndices )
+      {
+      m_IncludedIndices.insert(m_IncludedIndices.end(), frontier.begin(), frontier.end());
+      }
+    if ( m_Stopped )
+      {
+      break;
+      }
+    if ( filter != nullptr )
+      {
+      // The progress is updated at most 100 times.
+      const SizeValueType percentage = 100 * m_NumberOfIncludedPixels / numberOfPixels;
+      if ( percentage > reportedPercentage )
+        {
+        reportedPercentage = percentage;
+        filter->UpdateProgress( initialProgress + progressWeight * static_cast< float >( percentage ) / 100.0f );
+        }
+      if ( filter->GetAbortGenerateData() )
+        {
+        ProcessAborted e(__FILE__, __LINE__);
+        e.SetDescription("Process aborted.");
+        e.SetLocation(ITK_LOCATION);
+        throw e;
+        }
+      }
+
+    next.clear();
+    const SizeValueType frontierSize = frontier.size();
+    if ( numberOfWorkUnits < 2 || frontierSize < m_MinimumFrontierSizeToSplit )
+      {
+      this->ProcessFrontier(frontier.data(), frontier.data() + frontierSize, condition, stopCondition, next);
+      }
+    else
+      {
+      // Each work unit collects its part of the next frontier, the parts
+      // are then concatenated.
+      nextParts.resize(numberOfWorkUnits);
+      multiThreader->ParallelizeArray(
+        0,
+        numberOfWorkUnits,
+        [&](SizeValueType part)
+          {
+          const IndexType *first = frontier.data() + frontierSize * part / numberOfWorkUnits;
+          const IndexType *last = frontier.data() + frontierSize * ( part + 1 ) / numberOfWorkUnits;
+          nextParts[part].clear();
+          this->ProcessFrontier(first, last, condition, stopCondition, nextParts[part]);
+          },
+        nullptr);
+
+      SizeValueType nextSize = 0;
+      for ( const SeedContainerType & part : nextParts )
+        {
+        nextSize += part.size();
+        }
+      next.reserve(nextSize);
+      for ( const SeedContainerType & part : nextParts )
+        {
+        next.insert(next.end(), part.begin(), part.end());
+        }
+      }
+    // The order of the pixels of a level depends on the work units which
+    // included them.
+    if ( m_KeepIncludedIndices )
+      {
+      std::sort(next.begin(), next.end(), [this](const IndexType & a, const IndexType & b)
+        {
+        return this->ComputeOffset(a) < this->ComputeOffset(b);
+        });
+      }
+    frontier.swap(next);
+    }
+
+  if ( filter != nullptr )
+    {
+    filter->UpdateProgress(initialProgress + progressWeight);
+    }
+  return m_NumberOfIncludedPixels;
+}
+
+template< unsigned int VDimension >
+template< typename TCondition, typename TStopCondition >
+void
+ParallelFloodFill< VDimension >
+::ProcessFrontier(const IndexType *first, const IndexType *last,
+                  const TCondition & condition, const TStopCondition & stopCondition,
+                  SeedContainerType & next)
+{
+  for ( const IndexType *it = first; it != last && !m_Stopped.load(std::memory_order_relaxed); ++it )
+    {
+    // The neighbors of a pixel away from the boundary of the region are
+    // inside the region, and their offsets are computed from the offset
+    // of the pixel.
+    bool isInterior = true;
+    for ( unsigned int d = 0; d < VDimension; ++d )
+      {
+      isInterior = isInterior && ( *it )[d] > m_Region.GetIndex(d)
+                   && ( *it )[d] < m_Region.GetIndex(d) + static_cast< OffsetValueType >( m_Region.GetSize(d) ) - 1;
+      }
+    const SizeValueType pixelOffset = this->ComputeOffset(*it);
+
+    for ( SizeValueType n = 0; n < m_NeighborOffsets.size(); ++n )
+      {
+      const IndexType neighbor = *it + m_NeighborOffsets[n];
+      if ( !isInterior && !m_Region.IsInside(neighbor) )
+        {
+        continue;
+        }
+      // The plain load avoids the cost of the atomic operation for the
+      // pixels visited at a previous level.
+      const SizeValueType offset = pixelOffset + m_NeighborLinearOffsets[n];
+      if ( TestBit(m_Visited, offset) || TestAndSetBit(m_Visited, offset) )
+        {
+        continue;
+        }
+      if ( condition(neighbor) )
+        {
+        TestAndSetBit(m_Included, offset);
+        next.push_back(neighbor);
+        if ( stopCondition(neighbor) )
+          {
+          m_Stopped.store(true, std::memory_order_relaxed);
+          }
+        }
+      }
+    }
+}
+
+template< unsigned int VDimension >
+template< typename TImage >
+void
+ParallelFloodFill< VDimension >
+::WriteMask(TImage *image, const typename TImage::PixelType & insideValue,
+            const typename TImage::PixelType & outsideValue, ProcessObject *filter) const
+{
+  auto writeRegion = [&](const RegionType & region)
+    {
+    ImageScanlineIterator< TImage > it(image, region);
+    while ( !it.IsAtEnd() )
+      {
+      SizeValueType offset = this->ComputeOffset( it.GetIndex() );
+      while ( !it.IsAtEndOfLine() )
+        {
+        it.Set( TestBit(m_Included, offset) ? insideValue : outsideValue );
+        ++it;
+        ++offset;
+        }
+      it.NextLine();
+      }
+    };
+
+  if ( filter != nullptr )
+    {
+    filter->GetMultiThreader()->template ParallelizeImageRegion< VDimension >( m_Region, writeRegion, nullptr );
+    }
+  else
+    {
+    writeRegion(m_Region);
+    }
+}
+} // end namespace itk
+
+#endif
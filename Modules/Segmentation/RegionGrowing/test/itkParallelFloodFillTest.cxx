@@ -0,0 +1,275 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkParallelFloodFill.h"
+#include "itkConnectedThresholdImageFilter.h"
+#include "itkConfidenceConnectedImageFilter.h"
+#include "itkNeighborhoodConnectedImageFilter.h"
+#include "itkBinaryThresholdImageFunction.h"
+#include "itkFloodFilledImageFunctionConditionalIterator.h"
+#include "itkShapedFloodFilledImageFunctionConditionalIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkRandomImageSource.h"
+#include "itkTestingComparisonImageFilter.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Compare the regions grown by ParallelFloodFill, with several work units
+ * and with frontiers split at every level, to the regions grown by the
+ * flood filled iterators, for face and full connectivity. Also check the
+ * kept indices of the included pixels and the fills stopped early.
+ */
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using PixelType = unsigned char;
+using ImageType = itk::Image< PixelType, Dimension >;
+using FloodFillType = itk::ParallelFloodFill< Dimension >;
+using FunctionType = itk::BinaryThresholdImageFunction< ImageType, double >;
+using ComparisonType = itk::Testing::ComparisonImageFilter< ImageType, ImageType >;
+
+constexpr PixelType InsideValue = 7;
+
+ImageType::Pointer
+CreateReference(const ImageType *input, FunctionType *function, const FloodFillType::SeedContainerType & seeds,
+                bool fullyConnected)
+{
+  ImageType::Pointer reference = ImageType::New();
+  reference->CopyInformation( input );
+  reference->SetRegions( input->GetLargestPossibleRegion() );
+  reference->Allocate();
+  reference->FillBuffer( 0 );
+
+  std::vector< ImageType::IndexType > iteratorSeeds( seeds );
+  if ( fullyConnected )
+    {
+    using IteratorType = itk::ShapedFloodFilledImageFunctionConditionalIterator< ImageType, FunctionType >;
+    IteratorType it( reference, function, iteratorSeeds );
+    it.FullyConnectedOn();
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( InsideValue );
+      }
+    }
+  else
+    {
+    using IteratorType = itk::FloodFilledImageFunctionConditionalIterator< ImageType, FunctionType >;
+    IteratorType it( reference, function, iteratorSeeds );
+    for ( it.GoToBegin(); !it.IsAtEnd(); ++it )
+      {
+      it.Set( InsideValue );
+      }
+    }
+  return reference;
+}
+
+}
+
+int itkParallelFloodFillTest( int, char *[] )
+{
+  // A random image whose pixels below the threshold form large connected
+  // regions with a complex boundary.
+  ImageType::RegionType region;
+  region.SetIndex( 0, -3 );
+  region.SetSize( 0, 37 );
+  region.SetSize( 1, 29 );
+  region.SetSize( 2, 23 );
+  using RandomSourceType = itk::RandomImageSource< ImageType >;
+  RandomSourceType::Pointer source = RandomSourceType::New();
+  source->SetSize( region.GetSize() );
+  source->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( source->Update() );
+  ImageType::Pointer image = source->GetOutput();
+  image->DisconnectPipeline();
+  // The region does not start at the origin of the index space.
+  image->SetRegions( region );
+
+  FunctionType::Pointer function = FunctionType::New();
+  function->SetInputImage( image );
+
+  // The last two seeds are outside the region or outside the threshold,
+  // they are ignored.
+  FloodFillType::SeedContainerType seeds;
+  ImageType::IndexType seed = {{ 5, 14, 11 }};
+  image->SetPixel( seed, 0 );
+  seeds.push_back( seed );
+  seed[0] = 30;
+  seed[2] = 2;
+  image->SetPixel( seed, 0 );
+  seeds.push_back( seed );
+  seed[0] = 40;
+  seeds.push_back( seed );
+  seed[0] = 10;
+  image->SetPixel( seed, 255 );
+  seeds.push_back( seed );
+
+  // A filter provides the multi-threader and the number of work units.
+  using FilterType = itk::ConnectedThresholdImageFilter< ImageType, ImageType >;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetNumberOfWorkUnits( 4 );
+
+  const PixelType thresholds[] = { 60, 90, 140 };
+  for ( bool fullyConnected : { false, true } )
+    {
+    for ( PixelType threshold : thresholds )
+      {
+      std::cout << "Threshold " << static_cast< int >( threshold ) << ", fully connected " << fullyConnected
+                << std::endl;
+      function->ThresholdBetween( 0, threshold );
+      ImageType::Pointer reference = CreateReference( image, function, seeds, fullyConnected );
+
+      auto condition = [&function](const ImageType::IndexType & index)
+        {
+        return function->EvaluateAtIndex( index );
+        };
+
+      FloodFillType floodFill( region );
+      TEST_EXPECT_TRUE( !floodFill.GetFullyConnected() );
+      floodFill.SetFullyConnected( fullyConnected );
+      TEST_SET_GET_VALUE( fullyConnected, floodFill.GetFullyConnected() );
+      floodFill.SetMinimumFrontierSizeToSplit( 1 );
+      const itk::SizeValueType numberOfIncludedPixels = floodFill.Fill( seeds, condition, filter );
+      TEST_SET_GET_VALUE( numberOfIncludedPixels, floodFill.GetNumberOfIncludedPixels() );
+
+      itk::SizeValueType numberOfReferencePixels = 0;
+      for ( itk::ImageRegionConstIteratorWithIndex< ImageType > it( reference, region ); !it.IsAtEnd(); ++it )
+        {
+        numberOfReferencePixels += it.Get() != 0;
+        TEST_EXPECT_EQUAL( floodFill.IsIncluded( it.GetIndex() ), it.Get() != 0 );
+        }
+      TEST_EXPECT_EQUAL( numberOfIncludedPixels, numberOfReferencePixels );
+      TEST_EXPECT_TRUE( !floodFill.IsIncluded( seeds[2] ) );
+
+      ImageType::Pointer mask = ImageType::New();
+      mask->SetRegions( region );
+      mask->Allocate();
+      floodFill.WriteMask( mask.GetPointer(), InsideValue, 0, filter );
+      ComparisonType::Pointer maskComparison = ComparisonType::New();
+      maskComparison->SetValidInput( reference );
+      maskComparison->SetTestInput( mask );
+      TRY_EXPECT_NO_EXCEPTION( maskComparison->Update() );
+      TEST_EXPECT_EQUAL( maskComparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+      // A single-threaded fill of the same region.
+      FloodFillType serialFloodFill( region );
+      serialFloodFill.SetFullyConnected( fullyConnected );
+      TEST_EXPECT_EQUAL( serialFloodFill.Fill( seeds, condition ), numberOfReferencePixels );
+
+      // The indices of the included pixels are kept in the same order
+      // whatever the threads.
+      floodFill.SetKeepIncludedIndices( true );
+      TEST_SET_GET_VALUE( true, floodFill.GetKeepIncludedIndices() );
+      serialFloodFill.SetKeepIncludedIndices( true );
+      floodFill.Fill( seeds, condition, filter );
+      serialFloodFill.Fill( seeds, condition );
+      TEST_EXPECT_EQUAL( floodFill.GetIncludedIndices().size(), numberOfReferencePixels );
+      TEST_EXPECT_TRUE( floodFill.GetIncludedIndices() == serialFloodFill.GetIncludedIndices() );
+
+      // The fill stops at the last pixel of the region, and goes on when
+      // the stop condition is never met.
+      const ImageType::IndexType lastIndex = floodFill.GetIncludedIndices().back();
+      auto isLastIndex = [&lastIndex](const ImageType::IndexType & index)
+        {
+        return index == lastIndex;
+        };
+      TEST_EXPECT_TRUE( !floodFill.GetStopped() );
+      floodFill.FillUntil( seeds, condition, isLastIndex, filter );
+      TEST_EXPECT_TRUE( floodFill.GetStopped() );
+      TEST_EXPECT_TRUE( floodFill.IsIncluded( lastIndex ) );
+      TEST_EXPECT_TRUE( floodFill.GetNumberOfIncludedPixels() <= numberOfReferencePixels );
+      TEST_EXPECT_EQUAL( floodFill.GetIncludedIndices().size(), floodFill.GetNumberOfIncludedPixels() );
+      for ( const ImageType::IndexType & index : floodFill.GetIncludedIndices() )
+        {
+        TEST_EXPECT_TRUE( reference->GetPixel( index ) != 0 );
+        }
+      auto isExcludedSeed = [&seeds](const ImageType::IndexType & index)
+        {
+        return index == seeds[3];
+        };
+      floodFill.FillUntil( seeds, condition, isExcludedSeed, filter );
+      TEST_EXPECT_TRUE( !floodFill.GetStopped() );
+      TEST_EXPECT_EQUAL( floodFill.GetNumberOfIncludedPixels(), numberOfReferencePixels );
+
+      // The filter grows the same region.
+      filter->SetInput( image );
+      filter->ClearSeeds();
+      for ( const ImageType::IndexType & index : seeds )
+        {
+        filter->AddSeed( index );
+        }
+      filter->SetLower( 0 );
+      filter->SetUpper( threshold );
+      filter->SetReplaceValue( InsideValue );
+      filter->SetConnectivity( fullyConnected ? FilterType::FullConnectivity : FilterType::FaceConnectivity );
+      ComparisonType::Pointer filterComparison = ComparisonType::New();
+      filterComparison->SetValidInput( reference );
+      filterComparison->SetTestInput( filter->GetOutput() );
+      TRY_EXPECT_NO_EXCEPTION( filterComparison->Update() );
+      TEST_EXPECT_EQUAL( filterComparison->GetNumberOfPixelsWithDifferences(), 0u );
+      }
+    }
+
+  // The neighborhood connected filter grows the same region with one and
+  // several work units.
+  using NeighborhoodFilterType = itk::NeighborhoodConnectedImageFilter< ImageType, ImageType >;
+  NeighborhoodFilterType::Pointer neighborhoodFilter = NeighborhoodFilterType::New();
+  neighborhoodFilter->SetInput( image );
+  neighborhoodFilter->SetLower( 0 );
+  neighborhoodFilter->SetUpper( 200 );
+  for ( const ImageType::IndexType & index : seeds )
+    {
+    neighborhoodFilter->AddSeed( index );
+    }
+  neighborhoodFilter->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( neighborhoodFilter->Update() );
+  ImageType::Pointer neighborhoodReference = neighborhoodFilter->GetOutput();
+  neighborhoodReference->DisconnectPipeline();
+  neighborhoodFilter->SetNumberOfWorkUnits( 4 );
+  ComparisonType::Pointer neighborhoodComparison = ComparisonType::New();
+  neighborhoodComparison->SetValidInput( neighborhoodReference );
+  neighborhoodComparison->SetTestInput( neighborhoodFilter->GetOutput() );
+  TRY_EXPECT_NO_EXCEPTION( neighborhoodComparison->Update() );
+  TEST_EXPECT_EQUAL( neighborhoodComparison->GetNumberOfPixelsWithDifferences(), 0u );
+
+  // The statistics of the confidence connected filter do not depend on the
+  // number of work units.
+  using ConfidenceFilterType = itk::ConfidenceConnectedImageFilter< ImageType, ImageType >;
+  ConfidenceFilterType::Pointer confidenceFilter = ConfidenceFilterType::New();
+  confidenceFilter->SetInput( image );
+  confidenceFilter->SetSeed( seeds[0] );
+  confidenceFilter->SetMultiplier( 1.5 );
+  confidenceFilter->SetInitialNeighborhoodRadius( 2 );
+  confidenceFilter->SetNumberOfIterations( 3 );
+  confidenceFilter->SetReplaceValue( 1 );
+  confidenceFilter->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( confidenceFilter->Update() );
+  ImageType::Pointer confidenceReference = confidenceFilter->GetOutput();
+  confidenceReference->DisconnectPipeline();
+  const double mean = confidenceFilter->GetMean();
+  const double variance = confidenceFilter->GetVariance();
+  confidenceFilter->SetNumberOfWorkUnits( 4 );
+  ComparisonType::Pointer confidenceComparison = ComparisonType::New();
+  confidenceComparison->SetValidInput( confidenceReference );
+  confidenceComparison->SetTestInput( confidenceFilter->GetOutput() );
+  TRY_EXPECT_NO_EXCEPTION( confidenceComparison->Update() );
+  TEST_EXPECT_EQUAL( confidenceComparison->GetNumberOfPixelsWithDifferences(), 0u );
+  TEST_EXPECT_EQUAL( confidenceFilter->GetMean(), mean );
+  TEST_EXPECT_EQUAL( confidenceFilter->GetVariance(), variance );
+
+  return EXIT_SUCCESS;
+}
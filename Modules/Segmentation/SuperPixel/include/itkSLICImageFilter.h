@@ -19,7 +19,6 @@
 #define itkSLICImageFilter_h
 
 #include "itkImageToImageFilter.h"
-#include <mutex>
 
 namespace itk
 {
@@ -49,6 +48,21 @@ namespace itk
  * superpixel cluster. Every pixel in the output is labeled, and the
  * starting label id is zero.
  *
+ * The image is processed in tiles made of blocks of the super grid. Each
+ * tile is assigned to the nearest clusters with a distance buffer of the
+ * size of the tile, and accumulates its pixels per cluster; the
+ * accumulations of the tiles are then added in parallel over blocks of
+ * clusters, in tile order, to update the cluster centers. No image of
+ * distances is allocated. The disconnected components are also found in
+ * parallel, so the output does not depend on the number of work units.
+ *
+ * With UseStreaming enabled, the filter only processes the requested
+ * region of the output, padded by two super grid cells, so that very
+ * large images, like histology slides, can be segmented in streamed
+ * pieces. The clusters are still initialized on the super grid of the
+ * whole image and labeled with the index of their super grid cell, so
+ * the labels are consistent between the pieces.
+ *
  * This code was contributed in the Insight Journal paper:
  * "Scalable Simple Linear Iterative Clustering (SSLIC) Using a
  * Generic and Parallel Approach" by Lowekamp B. C., Chen D. T., Yaniv
@@ -149,6 +163,19 @@ public:
   itkGetMacro(EnforceConnectivity, bool);
   itkBooleanMacro(EnforceConnectivity);
 
+  /** \brief Process the requested region of the output only.
+   *
+   * By default the whole image is segmented whatever the requested
+   * region. When enabled, the requested region padded by two super grid
+   * cells is segmented, and the output can be streamed. The super pixels
+   * across the boundaries of the streamed pieces are approximated, and
+   * the disconnected components are merged with a neighbor label when
+   * connectivity is enforced, instead of being assigned new labels.
+   */
+  itkSetMacro(UseStreaming, bool);
+  itkGetConstMacro(UseStreaming, bool);
+  itkBooleanMacro(UseStreaming);
+
 
   /** \brief Get the current average cluster residual.
    *
@@ -164,20 +191,25 @@ protected:
 
   void PrintSelf(std::ostream & os, Indent indent) const override;
 
-  /** Generate full output and require full input */
+  /** Generate full output and require full input, unless streaming */
   void EnlargeOutputRequestedRegion(DataObject *output) override;
 
-  void BeforeThreadedGenerateData() override;
+  void GenerateInputRequestedRegion() override;
 
-  void ThreadedUpdateDistanceAndLabel(const OutputImageRegionType & outputRegionForThread);
+  void BeforeThreadedGenerateData() override;
 
-  void ThreadedUpdateClusters(const OutputImageRegionType & outputRegionForThread);
+  /** Assign the pixels of a tile to the nearest cluster, and accumulate
+   * the pixels of the tile per cluster. */
+  void ThreadedUpdateTile(SizeValueType tileIndex);
 
   void ThreadedPerturbClusters(SizeValueType idx);
 
   void ThreadedConnectivity(SizeValueType idx);
 
-  void SingleThreadedConnectivity();
+  /** Relabel the components which are not connected to the center of
+   * their cluster. The components are found in parallel in slabs of the
+   * image, and merged across the slab boundaries. */
+  void RelabelDisconnectedComponents();
 
   void GenerateData() override;
 
@@ -204,6 +236,12 @@ private:
                                OutputPixelType outputLabel,
                                std::vector<IndexType> & indexStack);
 
+  /** Bin the clusters in the cells of the super grid. */
+  void BinClusters();
+
+  /** Get the region of a tile and the range of the cells around it. */
+  OutputImageRegionType GetTileRegion(SizeValueType tileIndex, IndexType & firstCell, IndexType & lastCell) const;
+
   struct UpdateCluster
   {
     size_t count;
@@ -214,17 +252,30 @@ private:
 
   using MarkerImageType = Image<unsigned char, ImageDimension>;
 
-  std::vector<UpdateClusterMap> m_UpdateClusterPerThread;
+  std::vector<UpdateClusterMap> m_UpdateClusterPerTile;
+
+  /** The labels while processing, the output itself unless streaming. */
+  typename OutputImageType::Pointer m_LabelImage;
+  typename MarkerImageType::Pointer m_MarkerImage;
 
-  typename DistanceImageType::Pointer m_DistanceImage;
-  typename MarkerImageType::Pointer   m_MarkerImage;
+  /** The label of each cluster in the output, its super grid cell. */
+  std::vector<OutputPixelType> m_ClusterLabels;
+
+  /** The clusters of each cell of the super grid, in compressed rows. */
+  std::vector<size_t> m_CellClusterOffsets;
+  std::vector<size_t> m_CellClusters;
+
+  typename InputImageType::SizeType m_CellGridSize;
+  typename InputImageType::SizeType m_CellsPerTile;
+  typename InputImageType::SizeType m_TileGridSize;
 
   bool m_EnforceConnectivity{true};
 
   bool m_InitializationPerturbation{true};
 
+  bool m_UseStreaming{false};
+
   double               m_AverageResidual;
-  std::mutex m_Mutex;
 };
 } // end namespace itk
 
@@ -36,6 +36,7 @@
 
 #include "itkMath.h"
 
+#include <algorithm>
 #include <numeric>
 
 
@@ -98,6 +99,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   os << indent << "MaximumNumberOfIterations: " << m_MaximumNumberOfIterations << std::endl;
   os << indent << "SpatialProximityWeight: " << m_SpatialProximityWeight << std::endl;
   os << indent << "EnforceConnectivity: " << m_EnforceConnectivity << std::endl;
+  os << indent << "UseStreaming: " << m_UseStreaming << std::endl;
   os << indent << "AverageResidual: " << m_AverageResidual << std::endl;
 }
 
@@ -107,7 +109,36 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 ::EnlargeOutputRequestedRegion(DataObject *output)
 {
   Superclass::EnlargeOutputRequestedRegion(output);
-  output->SetRequestedRegionToLargestPossibleRegion();
+  if ( !m_UseStreaming )
+    {
+    output->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+void
+SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * inputImage = const_cast< InputImageType * >( this->GetInput() );
+  if ( !m_UseStreaming || !inputImage )
+    {
+    return;
+    }
+
+  // Pad the requested region so that the clusters of the cells around it,
+  // and their search regions, are included.
+  typename InputImageType::RegionType inputRequestedRegion = this->GetOutput()->GetRequestedRegion();
+  typename InputImageType::SizeType   padding;
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+    padding[i] = 2 * m_SuperGridSize[i];
+    }
+  inputRequestedRegion.PadByRadius(padding);
+  inputRequestedRegion.Crop( inputImage->GetLargestPossibleRegion() );
+  inputImage->SetRequestedRegion(inputRequestedRegion);
 }
 
 
@@ -121,42 +152,80 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   typename InputImageType::Pointer inputImage = InputImageType::New();
   inputImage->Graft( const_cast<  InputImageType * >( this->GetInput() ));
 
+  // the segmented region, the whole image unless streaming
+  const typename InputImageType::RegionType region = inputImage->GetRequestedRegion();
 
   m_AverageResidual = NumericTraits<double>::max();
 
   itkDebugMacro("Shrinking Starting");
   typename InputImageType::Pointer shrunkImage;
+  typename InputImageType::RegionType gridRegion;
   {
   typedef itk::ShrinkImageFilter<InputImageType, InputImageType> ShrinkImageFilterType;
   typename ShrinkImageFilterType::Pointer shrinker = ShrinkImageFilterType::New();
   shrinker->SetInput(inputImage);
   shrinker->SetShrinkFactors(m_SuperGridSize);
-  shrinker->UpdateLargestPossibleRegion();
+  shrinker->UpdateOutputInformation();
+
+  // The super grid covers the whole image, but only the cells sampled in
+  // the segmented region are initialized.
+  gridRegion = shrinker->GetOutput()->GetLargestPossibleRegion();
+  typename InputImageType::RegionType clusterGridRegion = gridRegion;
+  if ( m_UseStreaming )
+    {
+    // the labels are the offsets of the cells in the whole super grid
+    if ( gridRegion.GetNumberOfPixels() - 1 > static_cast< SizeValueType >( NumericTraits< OutputPixelType >::max() ) )
+      {
+      itkExceptionMacro( "The " << gridRegion.GetNumberOfPixels()
+                         << " cells of the super grid of the whole image cannot be labeled with the output pixel type." );
+      }
+
+    // same mapping from the cells to the sampled pixels as the shrinker
+    typename InputImageType::PointType pt;
+    IndexType sampleIdx;
+    shrinker->GetOutput()->TransformIndexToPhysicalPoint(gridRegion.GetIndex(), pt);
+    inputImage->TransformPhysicalPointToIndex(pt, sampleIdx);
+    for (unsigned int i = 0; i < ImageDimension; ++i)
+      {
+      const double factor = m_SuperGridSize[i];
+      const IndexValueType sampleOffset =
+        std::max( IndexValueType( 0 ), sampleIdx[i] - gridRegion.GetIndex(i) * static_cast<IndexValueType>( m_SuperGridSize[i] ) );
+      IndexValueType first = Math::Ceil<IndexValueType>( ( region.GetIndex(i) - sampleOffset ) / factor );
+      IndexValueType last = Math::Floor<IndexValueType>( ( region.GetUpperIndex()[i] - sampleOffset ) / factor );
+      first = std::min( std::max( first, gridRegion.GetIndex(i) ), gridRegion.GetUpperIndex()[i] );
+      last = std::max( std::min( last, gridRegion.GetUpperIndex()[i] ), first );
+      clusterGridRegion.SetIndex(i, first);
+      clusterGridRegion.SetSize(i, last - first + 1);
+      }
+    }
+  shrinker->GetOutput()->SetRequestedRegion(clusterGridRegion);
+  shrinker->Update();
 
   shrunkImage = shrinker->GetOutput();
   }
   itkDebugMacro("Shinking Completed")
 
-  const typename InputImageType::RegionType region = inputImage->GetBufferedRegion();
+  const typename InputImageType::RegionType clusterGridRegion = shrunkImage->GetBufferedRegion();
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
-  const size_t numberOfClusters = shrunkImage->GetBufferedRegion().GetNumberOfPixels();
+  const size_t numberOfClusters = clusterGridRegion.GetNumberOfPixels();
 
 
   // allocate array of scalars
   m_Clusters.resize(numberOfClusters*numberOfClusterComponents);
   m_OldClusters.resize(numberOfClusters*numberOfClusterComponents);
+  m_ClusterLabels.resize(numberOfClusters);
 
 
   using InputConstIteratorType = ImageScanlineConstIterator<InputImageType>;
 
-  InputConstIteratorType it(shrunkImage, shrunkImage->GetLargestPossibleRegion());
+  InputConstIteratorType it(shrunkImage, clusterGridRegion);
 
   // Initialize cluster centers
   size_t cnt = 0;
   while(!it.IsAtEnd())
     {
-    const size_t         ln =  shrunkImage->GetLargestPossibleRegion().GetSize(0);
+    const size_t         ln =  clusterGridRegion.GetSize(0);
     for (unsigned x = 0; x < ln; ++x)
       {
       // construct vector as reference to the scalar array
@@ -173,6 +242,17 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
         {
         cluster[numberOfComponents+i] = cidx[i];
         }
+
+      // the output label is the offset of the cell in the whole super grid
+      size_t label = 0;
+      size_t gridStride = 1;
+      for(unsigned int i = 0; i < ImageDimension; ++i)
+        {
+        label += ( idx[i] - gridRegion.GetIndex(i) ) * gridStride;
+        gridStride *= gridRegion.GetSize(i);
+        }
+      m_ClusterLabels[cnt] = static_cast<OutputPixelType>( label );
+
       ++it;
       ++cnt;
       }
@@ -182,18 +262,36 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
   shrunkImage = nullptr;
 
-  m_DistanceImage = DistanceImageType::New();
-  m_DistanceImage->CopyInformation(inputImage);
-  m_DistanceImage->SetBufferedRegion( region );
-  m_DistanceImage->Allocate();
+  if ( m_UseStreaming )
+    {
+    m_LabelImage = OutputImageType::New();
+    m_LabelImage->CopyInformation(inputImage);
+    m_LabelImage->SetBufferedRegion( region );
+    m_LabelImage->Allocate();
+    }
+  else
+    {
+    m_LabelImage = this->GetOutput();
+    }
+  m_LabelImage->FillBuffer(NumericTraits<OutputPixelType>::ZeroValue());
 
   for (unsigned int i = 0; i < ImageDimension; ++i)
     {
     m_DistanceScales[i] = m_SpatialProximityWeight/m_SuperGridSize[i];
     }
 
+  // The tiles are blocks of cells of the super grid of about 64K pixels,
+  // so that their distance buffers stay in cache.
+  const double tileLength = std::pow( 65536.0, 1.0/ImageDimension );
+  for (unsigned int i = 0; i < ImageDimension; ++i)
+    {
+    m_CellGridSize[i] = ( region.GetSize(i) + m_SuperGridSize[i] - 1 ) / m_SuperGridSize[i];
+    m_CellsPerTile[i] = std::max( SizeValueType( 1 ), Math::Round<SizeValueType>( tileLength/m_SuperGridSize[i] ) );
+    m_CellsPerTile[i] = std::min( m_CellsPerTile[i], m_CellGridSize[i] );
+    m_TileGridSize[i] = ( m_CellGridSize[i] + m_CellsPerTile[i] - 1 ) / m_CellsPerTile[i];
+    }
 
-  m_UpdateClusterPerThread.clear();
+  m_UpdateClusterPerTile.clear();
 
   this->Superclass::BeforeThreadedGenerateData();
 }
@@ -202,23 +300,134 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
 void
 SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
-::ThreadedUpdateDistanceAndLabel(const OutputImageRegionType & outputRegionForThread)
+::BinClusters()
+{
+  const typename InputImageType::RegionType region = m_LabelImage->GetBufferedRegion();
+  const unsigned int numberOfComponents = this->GetInput()->GetNumberOfComponentsPerPixel();
+  const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
+  const size_t       numberOfClusters = m_Clusters.size()/numberOfClusterComponents;
+
+  size_t numberOfCells = 1;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+    numberOfCells *= m_CellGridSize[d];
+    }
+
+  // The cell of a cluster is the cell of the center of its search region.
+  std::vector<size_t> clusterCells(numberOfClusters);
+  m_CellClusterOffsets.assign(numberOfCells + 1, 0);
+  for (size_t i = 0; i < numberOfClusters; ++i)
+    {
+    ClusterType cluster(numberOfClusterComponents, &m_Clusters[i*numberOfClusterComponents]);
+    size_t cell = 0;
+    size_t cellStride = 1;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      const IndexValueType idx = Math::RoundHalfIntegerUp< IndexValueType >(cluster[numberOfComponents+d]);
+      double c = std::floor( ( static_cast<double>( idx ) - region.GetIndex(d) ) / m_SuperGridSize[d] );
+      c = std::max( 0.0, std::min( c, static_cast<double>( m_CellGridSize[d] - 1 ) ) );
+      cell += static_cast<size_t>( c ) * cellStride;
+      cellStride *= m_CellGridSize[d];
+      }
+    clusterCells[i] = cell;
+    ++m_CellClusterOffsets[cell + 1];
+    }
+
+  std::partial_sum(m_CellClusterOffsets.begin(), m_CellClusterOffsets.end(), m_CellClusterOffsets.begin());
+
+  // the clusters of a cell are in increasing order
+  std::vector<size_t> cellPositions(m_CellClusterOffsets.begin(), m_CellClusterOffsets.end() - 1);
+  m_CellClusters.resize(numberOfClusters);
+  for (size_t i = 0; i < numberOfClusters; ++i)
+    {
+    m_CellClusters[cellPositions[clusterCells[i]]++] = i;
+    }
+}
+
+
+template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+typename SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>::OutputImageRegionType
+SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
+::GetTileRegion(SizeValueType tileIndex, IndexType & firstCell, IndexType & lastCell) const
+{
+  const typename InputImageType::RegionType region = m_LabelImage->GetBufferedRegion();
+
+  OutputImageRegionType tileRegion;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+    const SizeValueType cellStart = ( tileIndex % m_TileGridSize[d] ) * m_CellsPerTile[d];
+    tileIndex /= m_TileGridSize[d];
+
+    const SizeValueType pixelStart = cellStart * m_SuperGridSize[d];
+    tileRegion.SetIndex( d, region.GetIndex(d) + static_cast<IndexValueType>( pixelStart ) );
+    tileRegion.SetSize( d, std::min( m_CellsPerTile[d] * m_SuperGridSize[d], region.GetSize(d) - pixelStart ) );
+
+    // the search regions of the clusters of the adjacent cells overlap the tile
+    firstCell[d] = std::max( static_cast<IndexValueType>( cellStart ) - 1, IndexValueType( 0 ) );
+    lastCell[d] = static_cast<IndexValueType>( std::min( cellStart + m_CellsPerTile[d], m_CellGridSize[d] - 1 ) );
+    }
+  return tileRegion;
+}
+
+
+template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
+void
+SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
+::ThreadedUpdateTile(SizeValueType tileIndex)
 {
   using InputConstIteratorType = ImageScanlineConstIterator<InputImageType>;
-  using DistanceIteratorType = ImageScanlineIterator<DistanceImageType>;
+  using OutputIteratorType = ImageScanlineIterator<OutputImageType>;
 
   const InputImageType *inputImage = this->GetInput();
-  OutputImageType *outputImage = this->GetOutput();
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
 
+  IndexType firstCell;
+  IndexType lastCell;
+  const OutputImageRegionType tileRegion = this->GetTileRegion(tileIndex, firstCell, lastCell);
+
+  // Gather the clusters which may reach the tile. They are visited in
+  // increasing order, so the ties are resolved as when the whole image is
+  // processed at once.
+  std::vector<size_t> tileClusters;
+  IndexType cell = firstCell;
+  while ( true )
+    {
+    size_t cellOffset = 0;
+    size_t cellStride = 1;
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+      cellOffset += cell[d] * cellStride;
+      cellStride *= m_CellGridSize[d];
+      }
+    tileClusters.insert( tileClusters.end(),
+                         m_CellClusters.begin() + m_CellClusterOffsets[cellOffset],
+                         m_CellClusters.begin() + m_CellClusterOffsets[cellOffset + 1] );
+
+    unsigned int d = 0;
+    while ( d < ImageDimension && cell[d] == lastCell[d] )
+      {
+      cell[d] = firstCell[d];
+      ++d;
+      }
+    if ( d == ImageDimension )
+      {
+      break;
+      }
+    ++cell[d];
+    }
+  std::sort(tileClusters.begin(), tileClusters.end());
+
   typename InputImageType::SizeType searchRadius;
   for (unsigned int i = 0; i < ImageDimension; ++i)
     {
     searchRadius[i] = m_SuperGridSize[i];
     }
 
-  for (size_t i = 0; i*numberOfClusterComponents < m_Clusters.size(); ++i)
+  // distance of the pixels of the tile to their nearest cluster
+  std::vector<DistanceType> distanceBuffer( tileRegion.GetNumberOfPixels(), NumericTraits<DistanceType>::max() );
+
+  for ( const size_t i : tileClusters )
     {
     ClusterType cluster(numberOfClusterComponents, &m_Clusters[i*numberOfClusterComponents]);
     typename InputImageType::RegionType localRegion;
@@ -233,7 +442,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     localRegion.SetIndex(idx);
     localRegion.GetModifiableSize().Fill(1u);
     localRegion.PadByRadius(searchRadius);
-    if (!localRegion.Crop(outputRegionForThread))
+    if (!localRegion.Crop(tileRegion))
       {
       continue;
       }
@@ -242,76 +451,77 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     const size_t         ln =  localRegion.GetSize(0);
 
     InputConstIteratorType inputIter(inputImage, localRegion);
-    DistanceIteratorType   distanceIter(m_DistanceImage, localRegion);
+    OutputIteratorType     labelIter(m_LabelImage, localRegion);
 
 
     while ( !inputIter.IsAtEnd() )
       {
-      for( size_t x = 0; x < ln; ++x )
+      IndexType currentIdx = inputIter.GetIndex();
+
+      size_t distanceOffset = 0;
+      size_t distanceStride = 1;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
         {
-        const IndexType &currentIdx = inputIter.GetIndex();
+        distanceOffset += ( currentIdx[d] - tileRegion.GetIndex(d) ) * distanceStride;
+        distanceStride *= tileRegion.GetSize(d);
+        }
 
+      for( size_t x = 0; x < ln; ++x )
+        {
         pt = ContinuousIndexType(currentIdx);
         const double distance = this->Distance(cluster,
                                                inputIter.Get(),
                                                pt);
-        if (distance < distanceIter.Get() )
+        if (distance < distanceBuffer[distanceOffset] )
           {
-          distanceIter.Set(distance);
-          outputImage->SetPixel(currentIdx, i);
+          distanceBuffer[distanceOffset] = distance;
+          labelIter.Set(i);
           }
 
-        ++distanceIter;
+        ++currentIdx[0];
+        ++distanceOffset;
+        ++labelIter;
         ++inputIter;
         }
       inputIter.NextLine();
-      distanceIter.NextLine();
+      labelIter.NextLine();
       }
-
-    // for neighborhood iterator size S
     }
 
-}
-
-
-template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
-void
-SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
-::ThreadedUpdateClusters(const OutputImageRegionType & updateRegionForThread)
-{
-  const InputImageType *inputImage = this->GetInput();
-  OutputImageType *outputImage = this->GetOutput();
-
-  const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
-  const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
-
-  using InputConstIteratorType = ImageScanlineConstIterator<InputImageType>;
-  using OutputIteratorType = ImageScanlineIterator<OutputImageType>;
+  itkDebugMacro("Estimating Centers");
+  // accumulate the pixels of the tile per cluster
+  UpdateClusterMap &clusterMap = m_UpdateClusterPerTile[tileIndex];
+  clusterMap.clear();
 
-  UpdateClusterMap clusterMap;
+  OutputIteratorType     itOut(m_LabelImage, tileRegion);
+  InputConstIteratorType itIn(inputImage, tileRegion);
 
-  itkDebugMacro("Estimating Centers");
-  // calculate new centers
-  OutputIteratorType itOut = OutputIteratorType(outputImage, updateRegionForThread);
-  InputConstIteratorType itIn = InputConstIteratorType(inputImage, updateRegionForThread);
+  // the labels come in runs, so the last cluster is kept
+  UpdateCluster  *updateCluster = nullptr;
+  OutputPixelType previousLabel = NumericTraits<OutputPixelType>::ZeroValue();
   while(!itOut.IsAtEnd() )
     {
-    const size_t         ln =  updateRegionForThread.GetSize(0);
+    IndexType idx = itOut.GetIndex();
+    const size_t         ln =  tileRegion.GetSize(0);
     for (unsigned x = 0; x < ln; ++x)
       {
-      const IndexType &idx = itOut.GetIndex();
       const InputPixelType &v = itIn.Get();
       const typename OutputImageType::PixelType l = itOut.Get();
 
-      std::pair<typename UpdateClusterMap::iterator, bool> r =  clusterMap.insert(std::make_pair(l,UpdateCluster()));
-      vnl_vector<ClusterComponentType> &cluster = r.first->second.cluster;
-      if (r.second)
+      if ( updateCluster == nullptr || l != previousLabel )
         {
-        cluster.set_size(numberOfClusterComponents);
-        cluster.fill(0.0);
-        r.first->second.count = 0;
+        std::pair<typename UpdateClusterMap::iterator, bool> r =  clusterMap.insert(std::make_pair(l,UpdateCluster()));
+        updateCluster = &r.first->second;
+        if (r.second)
+          {
+          updateCluster->cluster.set_size(numberOfClusterComponents);
+          updateCluster->cluster.fill(0.0);
+          updateCluster->count = 0;
+          }
+        previousLabel = l;
         }
-      ++r.first->second.count;
+      vnl_vector<ClusterComponentType> &cluster = updateCluster->cluster;
+      ++updateCluster->count;
 
       const typename NumericTraits<InputPixelType>::MeasurementVectorType &mv = v;
       for(unsigned int i = 0; i < numberOfComponents; ++i)
@@ -324,16 +534,13 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
         cluster[numberOfComponents+i] += idx[i];
         }
 
+      ++idx[0];
       ++itIn;
       ++itOut;
       }
     itIn.NextLine();
     itOut.NextLine();
     }
-
-  // TODO improve merge algoithm
-  std::lock_guard<std::mutex> mutexHolder(m_Mutex);
-  m_UpdateClusterPerThread.push_back(clusterMap);
 }
 
 
@@ -362,7 +569,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   using NeighborhoodType = ConstNeighborhoodIterator<TInputImage>;
 
   // get center and dimension strides for iterator neighborhoods
-  NeighborhoodType it( radius, inputImage, inputImage->GetLargestPossibleRegion() );
+  NeighborhoodType it( radius, inputImage, inputImage->GetBufferedRegion() );
   center = it.Size()/2;
   for ( unsigned int i = 0; i < ImageDimension; ++i )
     {
@@ -388,6 +595,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   localRegion.SetIndex(idx);
   localRegion.GetModifiableSize().Fill(1u);
   localRegion.PadByRadius(searchRadius);
+  localRegion.Crop(inputImage->GetBufferedRegion());
 
 
   it.SetRegion( localRegion );
@@ -450,7 +658,6 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   itkDebugMacro("Threaded Connectivity");
 
   const InputImageType *inputImage = this->GetInput();
-  OutputImageType *outputImage = this->GetOutput();
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
 
@@ -472,7 +679,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     }
 
   // get center and dimension strides for iterator neighborhoods
-  NeighborhoodType searchLabelIt( radius, outputImage, outputImage->GetLargestPossibleRegion() );
+  NeighborhoodType searchLabelIt( radius, m_LabelImage, m_LabelImage->GetBufferedRegion() );
   searchLabelIt.OverrideBoundaryCondition(&lbc);
 
 
@@ -485,8 +692,12 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     idx[d] = Math::RoundHalfIntegerUp< IndexValueType >(cluster[numberOfComponents+d]);
     }
 
+  if ( !m_LabelImage->GetBufferedRegion().IsInside(idx) )
+    {
+    return;
+    }
 
-  if( outputImage->GetPixel(idx) != clusterIndex )
+  if( m_LabelImage->GetPixel(idx) != clusterIndex )
     {
     itkDebugMacro("Searching for cluster: " << clusterIndex << " near idx: " << idx);
 
@@ -531,14 +742,11 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 template<typename TInputImage, typename TOutputImage, typename TDistancePixel>
 void
 SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
-::SingleThreadedConnectivity()
+::RelabelDisconnectedComponents()
 {
-  itkDebugMacro("Single Threaded Connectivity");
+  itkDebugMacro("Relabel Disconnected Components");
 
-  const InputImageType *inputImage = this->GetInput();
-  OutputImageType      *outputImage = this->GetOutput();
-
-  const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
+  const unsigned int numberOfComponents = this->GetInput()->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
 
   OutputPixelType nextLabel = m_Clusters.size()/numberOfClusterComponents;
@@ -546,57 +754,185 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
   const size_t minSuperSize = std::accumulate( m_SuperGridSize.Begin(), m_SuperGridSize.End(), size_t(1), std::multiplies<size_t>() )/4;
 
-  std::vector< IndexType > indexStack;
-
   // Next we relabel the remaining regions ( defined by having the a
   // label id ) not connected to the SuperPixel centroids. If the
   // region is larger than the minimum superpixel size than it gets
-  // a new label, otherwise it just gets the previously encountered
-  // label id.
-
+  // a new label, otherwise it just gets the label id of the pixel
+  // preceding its first pixel. When streaming, new labels would not be
+  // consistent between the pieces, so all the regions get the
+  // preceding label id.
+  //
+  // The regions are numbered in the order of their first pixel, as
+  // when the image is scanned in a single thread, so the labels do not
+  // depend on the number of work units.
+
+  OutputPixelType                           *labels = m_LabelImage->GetBufferPointer();
+  const typename MarkerImageType::PixelType *markers = m_MarkerImage->GetBufferPointer();
+  const OutputImageRegionType                region = m_LabelImage->GetBufferedRegion();
+  const OffsetValueType                     *offsetTable = m_LabelImage->GetOffsetTable();
+
+  // The image is split in slabs along the last dimension.
+  constexpr unsigned int slabDimension = ImageDimension - 1;
+  const SizeValueType    numberOfSlabs =
+    std::min( static_cast<SizeValueType>( region.GetSize(slabDimension) ),
+              static_cast<SizeValueType>( this->GetNumberOfWorkUnits() ) );
+  std::vector<IndexValueType> slabStarts(numberOfSlabs + 1);
+  for ( SizeValueType s = 0; s <= numberOfSlabs; ++s )
+    {
+    slabStarts[s] = region.GetIndex(slabDimension) +
+      static_cast<IndexValueType>( s * region.GetSize(slabDimension) / numberOfSlabs );
+    }
+  const OffsetValueType slabStride = offsetTable[slabDimension];
 
-  using OutputIteratorType = ImageScanlineIterator<OutputImageType>;
-  OutputIteratorType outputIter(outputImage, outputImage->GetRequestedRegion());
+  // gather the offsets of the unmarked pixels of each slab, in increasing order
+  std::vector< std::vector<OffsetValueType> > slabPixels(numberOfSlabs);
+  this->GetMultiThreader()->ParallelizeArray(0, numberOfSlabs,
+      [&](SizeValueType s)
+        {
+        const OffsetValueType first = ( slabStarts[s] - slabStarts[0] ) * slabStride;
+        const OffsetValueType last = ( slabStarts[s + 1] - slabStarts[0] ) * slabStride;
+        for ( OffsetValueType n = first; n < last; ++n )
+          {
+          if ( markers[n] == 0 )
+            {
+            slabPixels[s].push_back(n);
+            }
+          }
+        }, this);
 
-  using MarkerIteratorType = ImageScanlineIterator<MarkerImageType>;
-  MarkerIteratorType markerIter(m_MarkerImage, outputImage->GetRequestedRegion());
+  std::vector<size_t> slabOffsets(numberOfSlabs + 1, 0);
+  for ( SizeValueType s = 0; s < numberOfSlabs; ++s )
+    {
+    slabOffsets[s + 1] = slabOffsets[s] + slabPixels[s].size();
+    }
+  const size_t numberOfPixels = slabOffsets[numberOfSlabs];
+  if ( numberOfPixels == 0 )
+    {
+    return;
+    }
 
+  // The unmarked pixels are joined with their unmarked face connected
+  // neighbors of the same label. The parent of a pixel always precedes
+  // it, so the root of a region is its first pixel.
+  std::vector<OffsetValueType> pixels(numberOfPixels);
+  std::vector<size_t>          parents(numberOfPixels);
 
-  while(!markerIter.IsAtEnd())
+  auto findRoot = [&parents](size_t i)
     {
-    while (!markerIter.IsAtEndOfLine())
+    while ( parents[i] != i )
       {
-      if ( markerIter.Get() == 0 )
-        {
-        // try relabeling the connected component to the next label id
-        this->RelabelConnectedRegion( markerIter.GetIndex(),
-                                      outputIter.Get(),
-                                      nextLabel,
-                                      indexStack );
+      parents[i] = parents[parents[i]];
+      i = parents[i];
+      }
+    return i;
+    };
+  auto join = [&parents, &findRoot](size_t i, size_t j)
+    {
+    i = findRoot(i);
+    j = findRoot(j);
+    if ( i < j )
+      {
+      parents[j] = i;
+      }
+    else
+      {
+      parents[i] = j;
+      }
+    };
+  // the unmarked pixel preceding the pixel i by the offset, if any
+  auto findNeighbor = [&pixels, labels, markers](size_t first, size_t i, OffsetValueType offset, size_t & neighbor)
+    {
+    const OffsetValueType nOffset = pixels[i] - offset;
+    if ( markers[nOffset] != 0 || labels[nOffset] != labels[pixels[i]] )
+      {
+      return false;
+      }
+    neighbor = std::lower_bound( pixels.begin() + first, pixels.begin() + i, nOffset ) - pixels.begin();
+    return true;
+    };
 
-        if (indexStack.size() >= minSuperSize)
-          {
-          prevLabel = nextLabel++;
-          }
-        else
+  // join the neighbors inside each slab
+  this->GetMultiThreader()->ParallelizeArray(0, numberOfSlabs,
+      [&](SizeValueType s)
+        {
+        std::copy( slabPixels[s].begin(), slabPixels[s].end(), pixels.begin() + slabOffsets[s] );
+        std::vector<OffsetValueType>().swap(slabPixels[s]);
+        for ( size_t i = slabOffsets[s]; i < slabOffsets[s + 1]; ++i )
           {
-          for ( size_t indexStackDelabel = 0; indexStackDelabel < indexStack.size(); ++indexStackDelabel )
+          parents[i] = i;
+          const IndexType idx = m_LabelImage->ComputeIndex(pixels[i]);
+          for ( unsigned int j = 0; j < ImageDimension; ++j )
             {
-            outputImage->SetPixel(indexStack[indexStackDelabel], prevLabel);
+            const IndexValueType first = ( j == slabDimension ) ? slabStarts[s] : region.GetIndex(j);
+            size_t neighbor;
+            if ( idx[j] > first && findNeighbor( slabOffsets[s], i, offsetTable[j], neighbor ) )
+              {
+              join( i, neighbor );
+              }
             }
           }
-        }
-      else
+        }, this);
+
+  // join the neighbors across the slab boundaries
+  for ( SizeValueType s = 1; s < numberOfSlabs; ++s )
+    {
+    const OffsetValueType boundaryEnd = ( slabStarts[s] + 1 - slabStarts[0] ) * slabStride;
+    for ( size_t i = slabOffsets[s]; i < slabOffsets[s + 1] && pixels[i] < boundaryEnd; ++i )
+      {
+      size_t neighbor;
+      if ( findNeighbor( slabOffsets[s - 1], i, slabStride, neighbor ) )
         {
-        prevLabel = outputIter.Get();
+        join( i, neighbor );
         }
-      ++markerIter;
-      ++outputIter;
+      }
+    }
+
+  // The regions get their labels in the order of their first pixels.
+  std::vector<size_t> regionSizes(numberOfPixels, 0);
+  for ( size_t i = 0; i < numberOfPixels; ++i )
+    {
+    parents[i] = parents[parents[i]];
+    ++regionSizes[parents[i]];
+    }
+
+  std::vector<OutputPixelType> regionLabels(numberOfPixels);
+  for ( size_t i = 0; i < numberOfPixels; ++i )
+    {
+    if ( parents[i] != i )
+      {
+      continue;
+      }
+
+    const OffsetValueType n = pixels[i];
+    if ( n > 0 )
+      {
+      // the preceding pixel is either marked, or in a region with a
+      // preceding first pixel
+      prevLabel = ( i > 0 && pixels[i - 1] == n - 1 ) ? regionLabels[parents[i - 1]] : labels[n - 1];
+      }
+    else if ( m_UseStreaming )
+      {
+      prevLabel = labels[n];
       }
 
-    markerIter.NextLine();
-    outputIter.NextLine();
+    if ( !m_UseStreaming && regionSizes[i] >= minSuperSize )
+      {
+      regionLabels[i] = nextLabel++;
+      }
+    else
+      {
+      regionLabels[i] = prevLabel;
+      }
     }
+
+  this->GetMultiThreader()->ParallelizeArray(0, numberOfSlabs,
+      [&](SizeValueType s)
+        {
+        for ( size_t i = slabOffsets[s]; i < slabOffsets[s + 1]; ++i )
+          {
+          labels[pixels[i]] = regionLabels[parents[i]];
+          }
+        }, this);
 }
 
 
@@ -613,7 +949,7 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   const InputImageType *inputImage = this->GetInput();
   OutputImageType *outputImage = this->GetOutput();
 
-  const typename InputImageType::RegionType region = inputImage->GetBufferedRegion();
+  const typename InputImageType::RegionType region = m_LabelImage->GetBufferedRegion();
   const unsigned int numberOfComponents = inputImage->GetNumberOfComponentsPerPixel();
   const unsigned int numberOfClusterComponents = numberOfComponents+ImageDimension;
   const size_t       numberOfClusters = m_Clusters.size()/numberOfClusterComponents;
@@ -637,56 +973,69 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
 
     }
 
+  // The clusters are reduced in blocks of consecutive clusters.
+  constexpr size_t clustersPerBlock = 256;
+
+  const SizeValueType numberOfTiles = std::accumulate( m_TileGridSize.begin(), m_TileGridSize.end(), SizeValueType(1), std::multiplies<SizeValueType>() );
+  m_UpdateClusterPerTile.resize(numberOfTiles);
+
   itkDebugMacro("Entering Main Loop");
   for(unsigned int loopCnt = 0;  loopCnt<m_MaximumNumberOfIterations; ++loopCnt)
     {
     itkDebugMacro("Iteration :" << loopCnt);
 
-    m_DistanceImage->FillBuffer(NumericTraits<typename DistanceImageType::PixelType>::max());
-    m_UpdateClusterPerThread.clear();
-
-    this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
-      outputImage->GetRequestedRegion(),
-      [this](const OutputImageRegionType & outputRegionForThread)
-          { this->ThreadedUpdateDistanceAndLabel(outputRegionForThread); }, this);
+    this->BinClusters();
 
-
-    this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
-      outputImage->GetRequestedRegion(),
-      [this](const OutputImageRegionType & outputRegionForThread)
-          { this->ThreadedUpdateClusters(outputRegionForThread); }, this);
+    this->GetMultiThreader()->ParallelizeArray(0,numberOfTiles,
+        [this]( SizeValueType tileIndex)
+          { this->ThreadedUpdateTile(tileIndex); }, this);
 
     // prepare to update clusters
     swap(m_Clusters, m_OldClusters);
-    std::fill(m_Clusters.begin(), m_Clusters.end(), 0.0);
-    std::vector<size_t> clusterCount(m_Clusters.size()/numberOfClusterComponents, 0);
 
-    // reduce the produce cluster maps per-thread into m_Cluster array
-    for(unsigned int i = 0; i < m_UpdateClusterPerThread.size(); ++i)
-      {
-      UpdateClusterMap &clusterMap = m_UpdateClusterPerThread[i];
-      for(typename UpdateClusterMap::const_iterator clusterIter = clusterMap.begin(); clusterIter != clusterMap.end(); ++clusterIter)
-        {
-        const size_t clusterIdx = clusterIter->first;
-        clusterCount[clusterIdx] += clusterIter->second.count;
-
-        ClusterType cluster(numberOfClusterComponents, &m_Clusters[clusterIdx*numberOfClusterComponents]);
-        cluster += clusterIter->second.cluster;
-        }
-      }
+    // Reduce the cluster maps per-tile into m_Cluster array, in parallel
+    // over blocks of clusters. Each cluster is summed in tile order, and
+    // the residuals of the blocks in block order, so the result does not
+    // depend on the number of work units.
+    const size_t numberOfBlocks = ( numberOfClusters + clustersPerBlock - 1 ) / clustersPerBlock;
+    std::vector<double> blockResiduals(numberOfBlocks, 0.0);
+    this->GetMultiThreader()->ParallelizeArray(0, numberOfBlocks,
+        [this, numberOfClusters, numberOfClusterComponents, &blockResiduals]( SizeValueType block )
+          {
+          const size_t firstCluster = block*clustersPerBlock;
+          const size_t endCluster = std::min( firstCluster + clustersPerBlock, numberOfClusters );
+          std::fill(m_Clusters.begin() + firstCluster*numberOfClusterComponents,
+                    m_Clusters.begin() + endCluster*numberOfClusterComponents, 0.0);
+          std::vector<size_t> clusterCount(endCluster - firstCluster, 0);
 
-    // average, l1
-    double l1Residual = 0.0;
-    for (size_t i = 0; i*numberOfClusterComponents < m_Clusters.size(); ++i)
-      {
+          for(unsigned int i = 0; i < m_UpdateClusterPerTile.size(); ++i)
+            {
+            const UpdateClusterMap &clusterMap = m_UpdateClusterPerTile[i];
+            for(typename UpdateClusterMap::const_iterator clusterIter = clusterMap.lower_bound(firstCluster);
+                clusterIter != clusterMap.end() && clusterIter->first < endCluster; ++clusterIter)
+              {
+              const size_t clusterIdx = clusterIter->first;
+              clusterCount[clusterIdx - firstCluster] += clusterIter->second.count;
+
+              ClusterType cluster(numberOfClusterComponents, &m_Clusters[clusterIdx*numberOfClusterComponents]);
+              cluster += clusterIter->second.cluster;
+              }
+            }
 
-      ClusterType cluster(numberOfClusterComponents,&m_Clusters[i*numberOfClusterComponents]);
-      cluster /= clusterCount[i];
+          // average, l1
+          double l1Residual = 0.0;
+          for (size_t i = firstCluster; i < endCluster; ++i)
+            {
+            ClusterType cluster(numberOfClusterComponents,&m_Clusters[i*numberOfClusterComponents]);
+            cluster /= clusterCount[i - firstCluster];
 
-      ClusterType oldCluster(numberOfClusterComponents, &m_OldClusters[i*numberOfClusterComponents]);
-      l1Residual += Distance(cluster,oldCluster);
+            ClusterType oldCluster(numberOfClusterComponents, &m_OldClusters[i*numberOfClusterComponents]);
+            l1Residual += Distance(cluster,oldCluster);
+            }
+          blockResiduals[block] = l1Residual;
+          }, this);
 
-      }
+    const double l1Residual = std::accumulate(blockResiduals.begin(), blockResiduals.end(), 0.0);
 
     m_AverageResidual = std::sqrt(l1Residual)/ m_Clusters.size();
     this->InvokeEvent( IterationEvent() );
@@ -698,8 +1047,6 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   if (m_EnforceConnectivity)
     {
 
-    m_DistanceImage = nullptr;
-
     m_MarkerImage = MarkerImageType::New();
     m_MarkerImage->CopyInformation(inputImage);
     m_MarkerImage->SetBufferedRegion( region );
@@ -710,9 +1057,31 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
     this->GetMultiThreader()->ParallelizeArray(0,numberOfClusters,
         [this]( SizeValueType idx)
           { this->ThreadedConnectivity(idx); }, this);
-    this->SingleThreadedConnectivity();
+    this->RelabelDisconnectedComponents();
     }
 
+  if ( m_UseStreaming )
+    {
+    // copy the requested region with the labels of the super grid cells
+    this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+      outputImage->GetRequestedRegion(),
+      [this, outputImage](const OutputImageRegionType & outputRegionForThread)
+        {
+        ImageScanlineConstIterator<OutputImageType> labelIter(m_LabelImage, outputRegionForThread);
+        ImageScanlineIterator<OutputImageType>      outputIter(outputImage, outputRegionForThread);
+        while ( !outputIter.IsAtEnd() )
+          {
+          while ( !outputIter.IsAtEndOfLine() )
+            {
+            outputIter.Set( m_ClusterLabels[labelIter.Get()] );
+            ++labelIter;
+            ++outputIter;
+            }
+          labelIter.NextLine();
+          outputIter.NextLine();
+          }
+        }, this);
+    }
 
   this->AfterThreadedGenerateData();
 }
@@ -725,16 +1094,16 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
   itkDebugMacro("Starting AfterThreadedGenerateData");
 
 
-  m_DistanceImage = nullptr;
+  m_LabelImage = nullptr;
   m_MarkerImage = nullptr;
 
   // cleanup
   std::vector<ClusterComponentType>().swap(m_Clusters);
   std::vector<ClusterComponentType>().swap(m_OldClusters);
-  for(unsigned int i = 0; i < m_UpdateClusterPerThread.size(); ++i)
-    {
-    UpdateClusterMap().swap(m_UpdateClusterPerThread[i]);
-    }
+  std::vector<OutputPixelType>().swap(m_ClusterLabels);
+  std::vector<UpdateClusterMap>().swap(m_UpdateClusterPerTile);
+  std::vector<size_t>().swap(m_CellClusterOffsets);
+  std::vector<size_t>().swap(m_CellClusters);
 }
 
 
@@ -796,61 +1165,56 @@ SLICImageFilter<TInputImage, TOutputImage, TDistancePixel>
                           OutputPixelType outputLabel,
                           std::vector<IndexType> & indexStack)
 {
+  // The label and marker images share the buffered region, the face
+  // connected neighbors are visited with the offsets of the buffer.
+  const OutputImageRegionType region = m_LabelImage->GetBufferedRegion();
+  const IndexType             firstIndex = region.GetIndex();
+  const IndexType             lastIndex = region.GetUpperIndex();
+  const OffsetValueType      *offsetTable = m_LabelImage->GetOffsetTable();
 
-  OutputImageType *outputImage = this->GetOutput();
-
-  ConstantBoundaryCondition< TOutputImage > lbc;
-  lbc.SetConstant( NumericTraits<  typename OutputImageType::PixelType >::max() );
-
-  itk::Size<ImageDimension> radius;
-  radius.Fill( 1 );
-  unsigned long center;
-  unsigned long stride[ImageDimension];
-
-  typedef NeighborhoodIterator< TOutputImage,  ConstantBoundaryCondition< TOutputImage > > NeighborhoodType;
-
-  NeighborhoodType labelIt( radius, outputImage, outputImage->GetRequestedRegion() );
-  labelIt.OverrideBoundaryCondition(&lbc);
-
-  center = labelIt.Size()/2;
-  for ( unsigned int j = 0; j < ImageDimension; ++j )
-    {
-    stride[j] = labelIt.GetStride(j);
-    }
-
-  using MarkerNeighborhoodType = NeighborhoodIterator<MarkerImageType>;
-  MarkerNeighborhoodType   markerIter(radius, m_MarkerImage, outputImage->GetRequestedRegion() );
+  OutputPixelType                     *labels = m_LabelImage->GetBufferPointer();
+  typename MarkerImageType::PixelType *markers = m_MarkerImage->GetBufferPointer();
 
   indexStack.clear();
   indexStack.push_back(seed);
-  m_MarkerImage->SetPixel(seed, 1);
-  outputImage->SetPixel(seed, outputLabel);
+  const OffsetValueType seedOffset = m_LabelImage->ComputeOffset(seed);
+  markers[seedOffset] = 1;
+  labels[seedOffset] = outputLabel;
 
   size_t indexStackCount = 0;
   while( indexStackCount < indexStack.size() )
     {
-    const IndexType &idx = indexStack[indexStackCount++];
+    // copy, the stack may be reallocated
+    const IndexType       idx = indexStack[indexStackCount++];
+    const OffsetValueType offset = m_LabelImage->ComputeOffset(idx);
 
-    markerIter.SetLocation(idx);
-    labelIt.SetLocation(idx);
     for ( unsigned int j = 0; j < ImageDimension; ++j )
       {
-      unsigned int nIdx = center + stride[j];
-
-      if ( markerIter.GetPixel(nIdx) == 0  &&
-           labelIt.GetPixel(nIdx) == requiredLabel )
+      if ( idx[j] < lastIndex[j] )
         {
-        indexStack.push_back( labelIt.GetIndex(nIdx));
-        markerIter.SetPixel(nIdx, 1);
-        labelIt.SetPixel(nIdx, outputLabel);
+        const OffsetValueType nOffset = offset + offsetTable[j];
+        if ( markers[nOffset] == 0  &&
+             labels[nOffset] == requiredLabel )
+          {
+          IndexType nIdx = idx;
+          ++nIdx[j];
+          indexStack.push_back(nIdx);
+          markers[nOffset] = 1;
+          labels[nOffset] = outputLabel;
+          }
         }
-      nIdx = center - stride[j];
-      if ( markerIter.GetPixel(nIdx) == 0  &&
-           labelIt.GetPixel(nIdx) == requiredLabel )
+      if ( idx[j] > firstIndex[j] )
         {
-        indexStack.push_back( labelIt.GetIndex(nIdx));
-        markerIter.SetPixel(nIdx, 1);
-        labelIt.SetPixel(nIdx, outputLabel);
+        const OffsetValueType nOffset = offset - offsetTable[j];
+        if ( markers[nOffset] == 0  &&
+             labels[nOffset] == requiredLabel )
+          {
+          IndexType nIdx = idx;
+          --nIdx[j];
+          indexStack.push_back(nIdx);
+          markers[nOffset] = 1;
+          labels[nOffset] = outputLabel;
+          }
         }
       }
     }
@@ -20,6 +20,10 @@
 
 #include "itkSLICImageFilter.h"
 #include "itkVectorImage.h"
+#include "itkStreamingImageFilter.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIteratorWithIndex.h"
 
 #include "itkCommand.h"
 
@@ -132,6 +136,12 @@ TEST_F(SLICFixture, SetGetPrint)
   EXPECT_NO_THROW(filter->SetInitializationPerturbation(true));
   EXPECT_TRUE(filter->GetInitializationPerturbation());
 
+  EXPECT_FALSE(filter->GetUseStreaming());
+  EXPECT_NO_THROW(filter->UseStreamingOn());
+  EXPECT_TRUE(filter->GetUseStreaming());
+  EXPECT_NO_THROW(filter->UseStreamingOff());
+  EXPECT_FALSE(filter->GetUseStreaming());
+
 }
 
 TEST_F(SLICFixture, Blank2DImage)
@@ -158,3 +168,104 @@ TEST_F(SLICFixture, Blank2DImage)
   filter->Update();
   EXPECT_EQ("4e0a293a5b638f0aba2c4fe2c3418d0e", MD5Hash(filter->GetOutput()));
 }
+
+TEST_F(SLICFixture, Streamed2DImage)
+{
+
+  using namespace itk::GTest::TypedefsAndConstructors::Dimension2;
+  using Utils = FixtureUtilities<2>;
+
+  auto filter = Utils::FilterType::New();
+
+  auto image = Utils::CreateImage(100);
+  filter->SetInput(image);
+
+  filter->SetSuperGridSize(10);
+  filter->UseStreamingOn();
+  filter->Update();
+  EXPECT_EQ("68707adc3df2f7d210b1db96847fc3c5", MD5Hash(filter->GetOutput()));
+
+  auto streamedFilter = Utils::FilterType::New();
+  streamedFilter->SetInput(image);
+  streamedFilter->SetSuperGridSize(10);
+  streamedFilter->UseStreamingOn();
+
+  using StreamingFilterType = itk::StreamingImageFilter<Utils::OutputImageType, Utils::OutputImageType>;
+  auto streamer = StreamingFilterType::New();
+  streamer->SetInput(streamedFilter->GetOutput());
+  streamer->SetNumberOfStreamDivisions(4);
+  streamer->Update();
+
+  // the labels are the cells of the super grid of the whole image
+  using CalculatorType = itk::MinimumMaximumImageCalculator<Utils::OutputImageType>;
+  auto calculator = CalculatorType::New();
+  calculator->SetImage(streamer->GetOutput());
+  calculator->Compute();
+  EXPECT_LT(calculator->GetMaximum(), 100u);
+
+  // the labels only differ within a super grid cell of the boundaries of
+  // the 4 pieces, which split the last dimension; the output of the
+  // whole image was released by the hash filter, which runs in place
+  filter->Update();
+  const itk::IndexValueType pieceSize = 100 / 4;
+  unsigned int numberOfDifferences = 0;
+  itk::ImageRegionConstIteratorWithIndex<Utils::OutputImageType> it(filter->GetOutput(),
+                                                                    filter->GetOutput()->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+    {
+    const itk::IndexValueType row = it.GetIndex()[1];
+    const itk::IndexValueType distance = std::min(row % pieceSize, pieceSize - 1 - row % pieceSize);
+    if (distance >= 10 && it.Get() != streamer->GetOutput()->GetPixel(it.GetIndex()))
+      {
+      ++numberOfDifferences;
+      }
+    }
+  EXPECT_EQ(0u, numberOfDifferences);
+
+  // the 400 cells of the super grid cannot be labeled with unsigned char
+  using ByteOutputImageType = itk::Image<unsigned char, 2>;
+  auto byteFilter = itk::SLICImageFilter<Utils::InputImageType, ByteOutputImageType>::New();
+  byteFilter->SetInput(image);
+  byteFilter->SetSuperGridSize(5);
+  byteFilter->UseStreamingOn();
+  EXPECT_THROW(byteFilter->Update(), itk::ExceptionObject);
+  byteFilter->SetSuperGridSize(10);
+  EXPECT_NO_THROW(byteFilter->Update());
+
+  EXPECT_EQ("07388fe1533a4afdfc7d5fa61e69da55", MD5Hash(streamer->GetOutput()));
+}
+
+TEST_F(SLICFixture, WorkUnits2DImage)
+{
+
+  using Utils = FixtureUtilities<2>;
+
+  // a noisy image, so that many components are disconnected from the
+  // center of their cluster
+  auto image = Utils::CreateImage(150);
+  unsigned int seed = 12345;
+  for (itk::ImageRegionIteratorWithIndex<Utils::InputImageType> it(image, image->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+    {
+    seed = seed * 1103515245u + 12345u;
+    const auto & idx = it.GetIndex();
+    it.Set(static_cast<Utils::PixelType>(1000 + 500 * std::sin(0.07 * idx[0]) * std::cos(0.11 * idx[1]) + ( seed >> 16 ) % 300));
+    }
+
+  // the clusters are reduced and the disconnected components relabeled
+  // in parallel, with the same result as with a single work unit
+  std::string hashes[2];
+  double residuals[2];
+  const itk::ThreadIdType numberOfWorkUnits[2] = { 1, 5 };
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    auto filter = Utils::FilterType::New();
+    filter->SetInput(image);
+    filter->SetSuperGridSize(10);
+    filter->SetNumberOfWorkUnits(numberOfWorkUnits[i]);
+    filter->Update();
+    residuals[i] = filter->GetAverageResidual();
+    hashes[i] = MD5Hash(filter->GetOutput());
+    }
+  EXPECT_EQ(hashes[0], hashes[1]);
+  EXPECT_EQ(residuals[0], residuals[1]);
+}
@@ -19,6 +19,10 @@
 #define itkMorphologicalWatershedFromMarkersImageFilter_h
 
 #include "itkImageToImageFilter.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
 
 namespace itk
 {
@@ -60,6 +64,16 @@ namespace itk
  * the markers. The labels of the output image are the label of the marker
  * image.
  *
+ * The pixels waiting to be flooded are stored in a hierarchical queue. For
+ * the integral pixel types with a range of values of at most 65536 gray
+ * levels, the queue is an array of buckets indexed by the gray level;
+ * otherwise it is a std::map of the gray levels. The first
+ * stage, which copies the markers and finds the pixels where the flooding
+ * starts, is multi-threaded. The flooding itself is sequential: the
+ * result depends on the order in which the pixels of a same gray level are
+ * processed, and the pixels are processed in the same order whatever the
+ * number of work units.
+ *
  * The morphological watershed transform algorithm is described in
  * Chapter 9.2 of Pierre Soille's book "Morphological Image Analysis:
  * Principles and Applications", Second Edition, Springer, 2003.
@@ -173,13 +187,166 @@ protected:
    * \sa ProcessObject::EnlargeOutputRequestedRegion() */
   void EnlargeOutputRequestedRegion( DataObject *itkNotUsed(output) ) override;
 
-  /** The filter is single threaded. */
+  /** The first stage is multi-threaded, the flooding is single threaded. */
   void GenerateData() override;
 
 private:
+  /** The pixels of a gray level, as offsets in the buffers, in the order
+   * they have been queued. */
+  using QueueType = std::vector< OffsetValueType >;
+
+  /** Hierarchical queue with a std::map of the gray levels. Used for the
+   * non integral pixel types and for the wide ranges of values. */
+  class MapHierarchicalQueue
+  {
+  public:
+    void Push(const InputImagePixelType & value, OffsetValueType offset)
+    {
+      m_Levels[value].push_back(offset);
+    }
+
+    bool Empty()
+    {
+      return m_Levels.empty();
+    }
+
+    InputImagePixelType GetFrontValue() const
+    {
+      return m_Levels.begin()->first;
+    }
+
+    /** The lowest level. It stays valid when pixels are pushed. */
+    QueueType & GetFront()
+    {
+      return m_Levels.begin()->second;
+    }
+
+    void PopFront()
+    {
+      m_Levels.erase( m_Levels.begin() );
+    }
+
+  private:
+    std::map< InputImagePixelType, QueueType > m_Levels;
+  };
+
+  /** The largest number of buckets of a BucketHierarchicalQueue. */
+  static constexpr OffsetValueType MaximumNumberOfBuckets = 65536;
+
+  /** Hierarchical queue with an array of buckets indexed by the gray level.
+   * The pixels are never pushed below the level being flooded, so the
+   * lowest non empty bucket is found by moving a cursor forward. */
+  class BucketHierarchicalQueue
+  {
+  public:
+    BucketHierarchicalQueue(const InputImagePixelType & minimum, SizeValueType numberOfLevels):
+      m_Minimum( static_cast< OffsetValueType >( minimum ) ),
+      m_Levels( numberOfLevels ),
+      m_Front( numberOfLevels )
+    {}
+
+    void Push(const InputImagePixelType & value, OffsetValueType offset)
+    {
+      const auto level = static_cast< SizeValueType >( static_cast< OffsetValueType >( value ) - m_Minimum );
+      m_Levels[level].push_back(offset);
+      m_Front = std::min( m_Front, level );
+    }
+
+    bool Empty()
+    {
+      while ( m_Front < m_Levels.size() && m_Levels[m_Front].empty() )
+        {
+        ++m_Front;
+        }
+      return m_Front == m_Levels.size();
+    }
+
+    InputImagePixelType GetFrontValue() const
+    {
+      return static_cast< InputImagePixelType >( m_Minimum + static_cast< OffsetValueType >( m_Front ) );
+    }
+
+    /** The lowest level. It stays valid when pixels are pushed. */
+    QueueType & GetFront()
+    {
+      return m_Levels[m_Front];
+    }
+
+    void PopFront()
+    {
+      QueueType().swap( m_Levels[m_Front] );
+    }
+
+  private:
+    OffsetValueType          m_Minimum;
+    std::vector< QueueType > m_Levels;
+    SizeValueType            m_Front;
+  };
+
+  /** Status of the pixels, stored in m_Status. */
+  enum
+  {
+    InQueueFlag = 1,  // the pixel is a marker or has been queued
+    OnBorderFlag = 2  // some neighbors of the pixel are outside the image
+  };
+
+  /** Results of the first stage for a chunk of lines. */
+  struct WorkUnitData
+  {
+    SizeValueType       m_FirstLine;
+    SizeValueType       m_LastLine;
+    QueueType           m_Seeds;
+    InputImagePixelType m_Minimum;
+    InputImagePixelType m_Maximum;
+    SizeValueType       m_NumberOfMarkerPixels;
+  };
+
+  /** First stage on a chunk of lines: copy the markers to the output, set
+   * the status of the pixels and find the pixels where the flooding
+   * starts, in the order of the sequential algorithm. */
+  void ThreadedInitialize(WorkUnitData & workUnitData);
+
+  /** Queue the seeds of the first stage and flood the image. */
+  template< typename THierarchicalQueue >
+  void Flood(THierarchicalQueue & fah, SizeValueType numberOfMarkerPixels);
+
+  /** Position of the pixel at the given offset in the buffers. */
+  IndexType ComputePosition(OffsetValueType offset) const
+  {
+    IndexType position;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      position[d] = offset % static_cast< OffsetValueType >( m_Size[d] );
+      offset /= static_cast< OffsetValueType >( m_Size[d] );
+      }
+    return position;
+  }
+
+  /** Whether the n-th neighbor of the pixel at position is in the image. */
+  bool IsNeighborInside(const IndexType & position, unsigned int n) const
+  {
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      const OffsetValueType p = position[d] + m_NeighborOffsets[n][d];
+      if ( p < 0 || p >= static_cast< OffsetValueType >( m_Size[d] ) )
+        {
+        return false;
+        }
+      }
+    return true;
+  }
+
   bool m_FullyConnected{ false };
 
   bool m_MarkWatershedLine{ true };
+
+  // state of the execution, released at the end of GenerateData()
+  using OffsetType = typename LabelImageType::OffsetType;
+  typename LabelImageType::SizeType  m_Size;
+  std::vector< OffsetType >          m_NeighborOffsets;
+  std::vector< OffsetValueType >     m_NeighborBufferOffsets;
+  std::vector< unsigned char >       m_Status;
+  std::deque< WorkUnitData >         m_WorkUnitResults;
 }; // end of class
 } // end namespace itk
 
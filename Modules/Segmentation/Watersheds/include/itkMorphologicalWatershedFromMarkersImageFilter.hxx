@@ -19,10 +19,9 @@
 #define itkMorphologicalWatershedFromMarkersImageFilter_hxx
 
 #include <algorithm>
-#include <queue>
-#include <list>
 #include "itkMorphologicalWatershedFromMarkersImageFilter.h"
 #include "itkProgressReporter.h"
+#include "itkProgressTransformer.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkConstShapedNeighborhoodIterator.h"
@@ -89,148 +88,194 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   // the algorithm without watershed lines is from beucher
   // The 2 algorithms are very similar and so are integrated in the same filter.
 
-  //---------------------------------------------------------------------------
-  // declare the vars common to the 2 algorithms: constants, iterators,
-  // hierarchical queue, progress reporter, and status image
-  // also allocate output images and verify preconditions
-  //---------------------------------------------------------------------------
-
-  // the label used to find background in the marker image
-  static const LabelImagePixelType bgLabel =
-    NumericTraits< LabelImagePixelType >::ZeroValue();
-  // the label used to mark the watershed line in the output image
-  static const LabelImagePixelType wsLabel =
-    NumericTraits< LabelImagePixelType >::ZeroValue();
-
   this->AllocateOutputs();
 
   const LabelImageType * markerImage = this->GetMarkerImage();
   const InputImageType * inputImage = this->GetInput();
   LabelImageType * outputImage = this->GetOutput();
 
-  // Set up the progress reporter
-  // we can't found the exact number of pixel to process in the 2nd pass, so we
-  // use the maximum number possible.
-  ProgressReporter progress(this, 0, markerImage->GetRequestedRegion().GetNumberOfPixels() * 2);
-
   // mask and marker must have the same size
   if ( markerImage->GetRequestedRegion().GetSize() != inputImage->GetRequestedRegion().GetSize() )
     {
     itkExceptionMacro(<< "Marker and input must have the same size.");
     }
 
-  // FAH (in french: File d'Attente Hierarchique)
-  using QueueType = std::queue< IndexType >;
-  using MapType = std::map< InputImagePixelType, QueueType >;
-  MapType fah;
+  // the three images are buffered on regions of the same size, so a pixel
+  // has the same offset in the three buffers
+  const LabelImageRegionType region = outputImage->GetRequestedRegion();
+  m_Size = region.GetSize();
+  const SizeValueType numberOfPixels = region.GetNumberOfPixels();
 
-  // the radius which will be used for all the shaped iterators
+  // the neighbors, in the order of the shaped neighborhood iterators used
+  // by the sequential algorithm: the order of the pixels in the
+  // hierarchical queue, and so the result, depends on it.
   Size< ImageDimension > radius;
   radius.Fill(1);
+  using NeighborhoodIteratorType = ConstShapedNeighborhoodIterator< LabelImageType >;
+  NeighborhoodIteratorType neighborhoodIt( radius, outputImage, region );
+  setConnectivity(&neighborhoodIt, m_FullyConnected);
+  m_NeighborOffsets.clear();
+  m_NeighborBufferOffsets.clear();
+  for ( auto n : neighborhoodIt.GetActiveIndexList() )
+    {
+    const OffsetType offset = neighborhoodIt.GetOffset(n);
+    OffsetValueType bufferOffset = 0;
+    OffsetValueType stride = 1;
+    for ( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+      bufferOffset += offset[d] * stride;
+      stride *= static_cast< OffsetValueType >( m_Size[d] );
+      }
+    m_NeighborOffsets.push_back(offset);
+    m_NeighborBufferOffsets.push_back(bufferOffset);
+    }
+
+  //---------------------------------------------------------------------------
+  // first stage, multi-threaded on chunks of lines:
+  //  - copy markers pixels to output image, and mark the other pixels as
+  //    watershed
+  //  - set markers pixels to already processed status
+  //  - find the pixels where the flooding starts
+  //---------------------------------------------------------------------------
+  m_Status.assign( numberOfPixels, 0 );
 
-  // iterator for the marker image
-  using MarkerIteratorType = ConstShapedNeighborhoodIterator< LabelImageType >;
-  typename MarkerIteratorType::ConstIterator nmIt;
-  MarkerIteratorType
-  markerIt( radius, markerImage, markerImage->GetRequestedRegion() );
-  // add a boundary constant to avoid adding pixels on the border in the fah
-  ConstantBoundaryCondition< LabelImageType > lcbc;
-  lcbc.SetConstant( NumericTraits< LabelImagePixelType >::max() );
-  markerIt.OverrideBoundaryCondition(&lcbc);
-  setConnectivity(&markerIt, m_FullyConnected);
-
-  // iterator for the input image
-  using InputIteratorType = ConstShapedNeighborhoodIterator< InputImageType >;
-  InputIteratorType
-  inputIt( radius, inputImage, inputImage->GetRequestedRegion() );
-  typename InputIteratorType::ConstIterator niIt;
-  setConnectivity(&inputIt, m_FullyConnected);
-
-  // iterator for the output image
-  using OutputIteratorType = ShapedNeighborhoodIterator< LabelImageType >;
-  using OffsetType = typename OutputIteratorType::OffsetType;
-  typename OutputIteratorType::Iterator noIt;
-  OutputIteratorType
-  outputIt( radius, outputImage, outputImage->GetRequestedRegion() );
-  setConnectivity(&outputIt, m_FullyConnected);
+  const SizeValueType numberOfLines = numberOfPixels / m_Size[0];
+  const SizeValueType numberOfChunks = std::min( numberOfLines,
+    static_cast< SizeValueType >( this->GetNumberOfWorkUnits() ) * 4 );
+  m_WorkUnitResults.clear();
+  for ( SizeValueType chunk = 0; chunk < numberOfChunks; ++chunk )
+    {
+    WorkUnitData workUnitData;
+    workUnitData.m_FirstLine = chunk * numberOfLines / numberOfChunks;
+    workUnitData.m_LastLine = ( chunk + 1 ) * numberOfLines / numberOfChunks;
+    workUnitData.m_Minimum = NumericTraits< InputImagePixelType >::max();
+    workUnitData.m_Maximum = NumericTraits< InputImagePixelType >::NonpositiveMin();
+    workUnitData.m_NumberOfMarkerPixels = 0;
+    m_WorkUnitResults.push_back(workUnitData);
+    }
+
+  ProgressTransformer progress1( 0.0f, 0.5f, this );
+  MultiThreaderBase* multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
+  multiThreader->ParallelizeArray(
+    0, numberOfChunks, [this]( SizeValueType chunk ) { this->ThreadedInitialize( m_WorkUnitResults[chunk] ); },
+    progress1.GetProcessObject() );
+
+  InputImagePixelType minimum = NumericTraits< InputImagePixelType >::max();
+  InputImagePixelType maximum = NumericTraits< InputImagePixelType >::NonpositiveMin();
+  SizeValueType numberOfMarkerPixels = 0;
+  for ( const auto & workUnitData : m_WorkUnitResults )
+    {
+    minimum = std::min( minimum, workUnitData.m_Minimum );
+    maximum = std::max( maximum, workUnitData.m_Maximum );
+    numberOfMarkerPixels += workUnitData.m_NumberOfMarkerPixels;
+    }
 
   //---------------------------------------------------------------------------
-  // Meyer's algorithm
+  // flooding, with a bucket array as hierarchical queue when the range of
+  // the values is small enough
   //---------------------------------------------------------------------------
-  if ( m_MarkWatershedLine )
+  const bool useBuckets = NumericTraits< InputImagePixelType >::is_integer
+                          && sizeof( InputImagePixelType ) <= 4
+                          && static_cast< OffsetValueType >( maximum ) - static_cast< OffsetValueType >( minimum )
+                             < MaximumNumberOfBuckets;
+  if ( useBuckets )
     {
-    // first stage:
-    //  - set markers pixels to already processed status
-    //  - copy markers pixels to output image
-    //  - init FAH with indexes of background pixels with marker pixel(s) in
-    //    their neighborhood
-
-    ConstantBoundaryCondition< LabelImageType > lcbc2;
-    // outside pixel are watershed so they won't be use to find real watershed
-    // pixels
-    lcbc2.SetConstant(wsLabel);
-    outputIt.OverrideBoundaryCondition(&lcbc2);
-
-    // create a temporary image to store the state of each pixel (processed or
-    // not)
-    using StatusImageType = Image< bool, ImageDimension >;
-    typename StatusImageType::Pointer statusImage = StatusImageType::New();
-    statusImage->SetRegions( markerImage->GetLargestPossibleRegion() );
-    statusImage->Allocate();
-
-    // iterator for the status image
-    using StatusIteratorType = ShapedNeighborhoodIterator< StatusImageType >;
-    typename StatusIteratorType::Iterator nsIt;
-    StatusIteratorType
-                                                 statusIt( radius, statusImage, outputImage->GetRequestedRegion() );
-    ConstantBoundaryCondition< StatusImageType > bcbc;
-    bcbc.SetConstant(true);    // outside pixel are already processed
-    statusIt.OverrideBoundaryCondition(&bcbc);
-    setConnectivity(&statusIt, m_FullyConnected);
-
-    // the status image must be initialized before the first stage. In the
-    // first stage, the set to true are the neighbors of the marker (and the
-    // marker) so it's difficult (impossible ?) to init the status image at
-    // the same time
-    // the overhead should be small
-    statusImage->FillBuffer(false);
-
-    for ( markerIt.GoToBegin(), statusIt.GoToBegin(), outputIt.GoToBegin(), inputIt.GoToBegin();
-          !markerIt.IsAtEnd();
-          ++markerIt, ++outputIt )
+    BucketHierarchicalQueue fah( minimum,
+      static_cast< SizeValueType >( static_cast< OffsetValueType >( maximum ) - static_cast< OffsetValueType >( minimum ) ) + 1 );
+    this->Flood( fah, numberOfMarkerPixels );
+    }
+  else
+    {
+    MapHierarchicalQueue fah;
+    this->Flood( fah, numberOfMarkerPixels );
+    }
+
+  // clear and make sure memory is freed
+  std::deque< WorkUnitData >().swap( m_WorkUnitResults );
+  std::vector< unsigned char >().swap( m_Status );
+  m_NeighborOffsets.clear();
+  m_NeighborBufferOffsets.clear();
+}
+
+
+template< typename TInputImage, typename TLabelImage >
+void
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::ThreadedInitialize(WorkUnitData & workUnitData)
+{
+  // the label used to find background in the marker image
+  static const LabelImagePixelType bgLabel =
+    NumericTraits< LabelImagePixelType >::ZeroValue();
+  // the label used to mark the watershed line in the output image
+  static const LabelImagePixelType wsLabel =
+    NumericTraits< LabelImagePixelType >::ZeroValue();
+
+  const LabelImagePixelType * marker = this->GetMarkerImage()->GetBufferPointer();
+  const InputImagePixelType * input = this->GetInput()->GetBufferPointer();
+  LabelImagePixelType * output = this->GetOutput()->GetBufferPointer();
+  const auto numberOfNeighbors = static_cast< unsigned int >( m_NeighborBufferOffsets.size() );
+  const SizeValueType lineLength = m_Size[0];
+
+  for ( SizeValueType line = workUnitData.m_FirstLine; line < workUnitData.m_LastLine; ++line )
+    {
+    // a line is on the border when one of its coordinates, out of the first
+    // dimension, is on the border
+    bool lineOnBorder = false;
+    SizeValueType l = line;
+    for ( unsigned int d = 1; d < ImageDimension; ++d )
       {
-      LabelImagePixelType markerPixel = markerIt.GetCenterPixel();
-      if ( markerPixel != bgLabel )
-        {
-        IndexType idx = markerIt.GetIndex();
+      const SizeValueType coordinate = l % m_Size[d];
+      l /= m_Size[d];
+      lineOnBorder = lineOnBorder || coordinate == 0 || coordinate == m_Size[d] - 1;
+      }
+
+    OffsetValueType offset = line * lineLength;
+    for ( SizeValueType x = 0; x < lineLength; ++x, ++offset )
+      {
+      const bool onBorder = lineOnBorder || x == 0 || x == lineLength - 1;
+      unsigned char status = onBorder ? OnBorderFlag : 0;
 
-        // move the iterators to the right place
-        OffsetType shift = idx - statusIt.GetIndex();
-        statusIt += shift;
-        inputIt += shift;
+      const InputImagePixelType value = input[offset];
+      workUnitData.m_Minimum = std::min( workUnitData.m_Minimum, value );
+      workUnitData.m_Maximum = std::max( workUnitData.m_Maximum, value );
 
+      const LabelImagePixelType markerPixel = marker[offset];
+      if ( markerPixel != bgLabel )
+        {
         // this pixel belongs to a marker
-        // mark it as already processed
-        statusIt.SetCenterPixel(true);
-        // copy it to the output image
-        outputIt.SetCenterPixel(markerPixel);
-        // and increase progress because this pixel will not be used in the
-        // flooding stage.
-        progress.CompletedPixel();
+        // copy it to the output image, and mark it as already processed
+        output[offset] = markerPixel;
+        status |= InQueueFlag;
+        ++workUnitData.m_NumberOfMarkerPixels;
 
-        // search the background pixels in the neighborhood
-        for ( nmIt = markerIt.Begin(), nsIt = statusIt.Begin(), niIt = inputIt.Begin();
-              nmIt != markerIt.End();
-              nmIt++, nsIt++, niIt++ )
+        IndexType position;
+        if ( onBorder )
           {
-          if ( !nsIt.Get() && nmIt.Get() == bgLabel )
+          position = this->ComputePosition(offset);
+          }
+        // search the background pixels in the neighborhood. Meyer's
+        // algorithm starts from them, Beucher's algorithm from this pixel.
+        for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
+          {
+          if ( onBorder && !this->IsNeighborInside(position, n) )
+            {
+            continue;
+            }
+          const OffsetValueType neighbor = offset + m_NeighborBufferOffsets[n];
+          if ( marker[neighbor] == bgLabel )
             {
-            // this neighbor is a background pixel and is not already
-            // processed; add its index to fah
-            fah[niIt.Get()].push( markerIt.GetIndex()
-                                  + nmIt.GetNeighborhoodOffset() );
-            // mark it as already in the fah to avoid adding it several times
-            nsIt.Set(true);
+            if ( m_MarkWatershedLine )
+              {
+              // the neighbor may also be a seed of a previous marker pixel,
+              // it is checked when the seeds are queued
+              workUnitData.m_Seeds.push_back(neighbor);
+              }
+            else
+              {
+              workUnitData.m_Seeds.push_back(offset);
+              break;
+              }
             }
           }
         }
@@ -238,52 +283,83 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
         {
         // Some pixels may be never processed so, by default, non marked pixels
         // must be marked as watershed
-        outputIt.SetCenterPixel(wsLabel);
+        output[offset] = wsLabel;
+        }
+      m_Status[offset] = status;
+      }
+    }
+}
+
+
+template< typename TInputImage, typename TLabelImage >
+template< typename THierarchicalQueue >
+void
+MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
+::Flood(THierarchicalQueue & fah, SizeValueType numberOfMarkerPixels)
+{
+  // the label used to mark the watershed line in the output image
+  static const LabelImagePixelType wsLabel =
+    NumericTraits< LabelImagePixelType >::ZeroValue();
+
+  const InputImagePixelType * input = this->GetInput()->GetBufferPointer();
+  LabelImagePixelType * output = this->GetOutput()->GetBufferPointer();
+  unsigned char * status = m_Status.data();
+  const auto numberOfNeighbors = static_cast< unsigned int >( m_NeighborBufferOffsets.size() );
+
+  // Set up the progress reporter
+  // we can't found the exact number of pixel to process, so we use the
+  // maximum number possible.
+  ProgressReporter progress( this, 0, static_cast< SizeValueType >( m_Status.size() ) - numberOfMarkerPixels,
+                             100, 0.5f, 0.5f );
+
+  //---------------------------------------------------------------------------
+  // Meyer's algorithm
+  //---------------------------------------------------------------------------
+  if ( m_MarkWatershedLine )
+    {
+    // init FAH with the background pixels with marker pixel(s) in their
+    // neighborhood, in the order of the marker pixels
+    for ( const auto & workUnitData : m_WorkUnitResults )
+      {
+      for ( const auto seed : workUnitData.m_Seeds )
+        {
+        if ( !( status[seed] & InQueueFlag ) )
+          {
+          fah.Push(input[seed], seed);
+          // mark it as already in the fah to avoid adding it several times
+          status[seed] |= InQueueFlag;
+          }
         }
-      // one more pixel done in the init stage
-      progress.CompletedPixel();
       }
-    // fill the borders of the status image with "true"
-    //FillSides<StatusImageType>(statusImage, true);
-    // Now disable the boundary checks
-    //outputIt.NeedToUseBoundaryConditionOff();
-    //statusIt.NeedToUseBoundaryConditionOff();
-    //inputIt.NeedToUseBoundaryConditionOff();
-    // end of init stage
-
-    // flooding
-    // init all the iterators
-    outputIt.GoToBegin();
-    statusIt.GoToBegin();
-    inputIt.GoToBegin();
 
     // and start flooding
-    while ( !fah.empty() )
+    while ( !fah.Empty() )
       {
-      // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
-      // and remove them from the fah
-      fah.erase( fah.begin() );
+      const InputImagePixelType currentValue = fah.GetFrontValue();
+      QueueType & currentQueue = fah.GetFront();
 
-      while ( !currentQueue.empty() )
+      for ( SizeValueType i = 0; i < currentQueue.size(); ++i )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
-        outputIt += shift;
-        statusIt += shift;
-        inputIt += shift;
+        const OffsetValueType offset = currentQueue[i];
+        const bool onBorder = status[offset] & OnBorderFlag;
+        IndexType position;
+        if ( onBorder )
+          {
+          position = this->ComputePosition(offset);
+          }
 
         // iterate over the neighbors. If there is only one marker value, give
         // that value to the pixel, else keep it as is (watershed line)
         LabelImagePixelType marker = wsLabel;
         bool                collision = false;
-        for ( noIt = outputIt.Begin(); noIt != outputIt.End(); noIt++ )
+        for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
           {
-          LabelImagePixelType o = noIt.Get();
+          if ( onBorder && !this->IsNeighborInside(position, n) )
+            {
+            // outside pixel are watershed
+            continue;
+            }
+          const LabelImagePixelType o = output[offset + m_NeighborBufferOffsets[n]];
           if ( o != wsLabel )
             {
             if ( marker != wsLabel && o != marker )
@@ -292,40 +368,45 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
               break;
               }
             else
-                  { marker = o; }
+              {
+              marker = o;
+              }
             }
           }
         if ( !collision )
           {
           // set the marker value
-          outputIt.SetCenterPixel(marker);
+          output[offset] = marker;
           // and propagate to the neighbors
-          for ( niIt = inputIt.Begin(), nsIt = statusIt.Begin();
-                niIt != inputIt.End();
-                niIt++, nsIt++ )
+          for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
             {
-            if ( !nsIt.Get() )
+            if ( onBorder && !this->IsNeighborInside(position, n) )
+              {
+              // outside pixel are already processed
+              continue;
+              }
+            const OffsetValueType neighbor = offset + m_NeighborBufferOffsets[n];
+            if ( !( status[neighbor] & InQueueFlag ) )
               {
               // the pixel is not yet processed. add it to the fah
-              InputImagePixelType GrayVal = niIt.Get();
+              const InputImagePixelType GrayVal = input[neighbor];
               if ( GrayVal <= currentValue )
                 {
-                currentQueue.push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
+                currentQueue.push_back(neighbor);
                 }
               else
                 {
-                fah[GrayVal].push( inputIt.GetIndex()
-                                   + niIt.GetNeighborhoodOffset() );
+                fah.Push(GrayVal, neighbor);
                 }
               // mark it as already in the fah
-              nsIt.Set(true);
+              status[neighbor] |= InQueueFlag;
               }
             }
           }
         // one more pixel in the flooding stage
         progress.CompletedPixel();
         }
+      fah.PopFront();
       }
     }
 
@@ -334,112 +415,60 @@ MorphologicalWatershedFromMarkersImageFilter< TInputImage, TLabelImage >
   //---------------------------------------------------------------------------
   else
     {
-    // first stage:
-    //  - copy markers pixels to output image
-    //  - init FAH with indexes of pixels with background pixel in their
-    //    neighborhood
-
-    ConstantBoundaryCondition< LabelImageType > lcbc2;
-    // outside pixel are watershed so they won't be use to find real watershed
-    // pixels
-    lcbc2.SetConstant( NumericTraits< LabelImagePixelType >::max() );
-    outputIt.OverrideBoundaryCondition(&lcbc2);
-
-    for ( markerIt.GoToBegin(), outputIt.GoToBegin(), inputIt.GoToBegin();
-          !markerIt.IsAtEnd();
-          ++markerIt, ++outputIt )
+    // init FAH with the marker pixels with background pixel(s) in their
+    // neighborhood
+    for ( const auto & workUnitData : m_WorkUnitResults )
       {
-      LabelImagePixelType markerPixel = markerIt.GetCenterPixel();
-      if ( markerPixel != bgLabel )
+      for ( const auto seed : workUnitData.m_Seeds )
         {
-        IndexType  idx = markerIt.GetIndex();
-        OffsetType shift = idx - inputIt.GetIndex();
-        inputIt += shift;
-
-        // this pixels belongs to a marker
-        // copy it to the output image
-        outputIt.SetCenterPixel(markerPixel);
-        // search if it has background pixel in its neighborhood
-        bool haveBgNeighbor = false;
-        for ( nmIt = markerIt.Begin(); nmIt != markerIt.End(); nmIt++ )
-          {
-          if ( nmIt.Get() == bgLabel )
-            {
-            haveBgNeighbor = true;
-            break;
-            }
-          }
-        if ( haveBgNeighbor )
-          {
-          // there is a background pixel in the neighborhood; add to fah
-          fah[inputIt.GetCenterPixel()].push( markerIt.GetIndex() );
-          }
-        else
-          {
-          // increase progress because this pixel will not be used in the
-          // flooding stage.
-          progress.CompletedPixel();
-          }
-        }
-      else
-        {
-        outputIt.SetCenterPixel(wsLabel);
+        fah.Push(input[seed], seed);
         }
-      progress.CompletedPixel();
       }
-    // end of init stage
-
-    // flooding
-    // init all the iterators
-    outputIt.GoToBegin();
-    inputIt.GoToBegin();
 
     // and start flooding
-    while ( !fah.empty() )
+    while ( !fah.Empty() )
       {
-      // store the current vars
-      InputImagePixelType currentValue = fah.begin()->first;
-      QueueType           currentQueue = fah.begin()->second;
-      // and remove them from the fah
-      fah.erase( fah.begin() );
+      const InputImagePixelType currentValue = fah.GetFrontValue();
+      QueueType & currentQueue = fah.GetFront();
 
-      while ( !currentQueue.empty() )
+      for ( SizeValueType i = 0; i < currentQueue.size(); ++i )
         {
-        IndexType idx = currentQueue.front();
-        currentQueue.pop();
-
-        // move the iterators to the right place
-        OffsetType shift = idx - outputIt.GetIndex();
-        outputIt += shift;
-        inputIt += shift;
+        const OffsetValueType offset = currentQueue[i];
+        const bool onBorder = status[offset] & OnBorderFlag;
+        IndexType position;
+        if ( onBorder )
+          {
+          position = this->ComputePosition(offset);
+          }
 
-        LabelImagePixelType currentMarker = outputIt.GetCenterPixel();
-        // get the current value of the pixel
+        const LabelImagePixelType currentMarker = output[offset];
         // iterate over neighbors to propagate the marker
-        for ( noIt = outputIt.Begin(), niIt = inputIt.Begin();
-              noIt != outputIt.End();
-              noIt++, niIt++ )
+        for ( unsigned int n = 0; n < numberOfNeighbors; ++n )
           {
-          if ( noIt.Get() == wsLabel )
+          if ( onBorder && !this->IsNeighborInside(position, n) )
+            {
+            continue;
+            }
+          const OffsetValueType neighbor = offset + m_NeighborBufferOffsets[n];
+          if ( output[neighbor] == wsLabel )
             {
             // the pixel is not yet processed. It can be labeled with the
             // current label
-            noIt.Set(currentMarker);
-            InputImagePixelType GrayVal = niIt.Get();
+            output[neighbor] = currentMarker;
+            const InputImagePixelType GrayVal = input[neighbor];
             if ( GrayVal <= currentValue )
               {
-              currentQueue.push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
+              currentQueue.push_back(neighbor);
               }
             else
               {
-              fah[GrayVal].push( inputIt.GetIndex()
-                                 + noIt.GetNeighborhoodOffset() );
+              fah.Push(GrayVal, neighbor);
               }
             progress.CompletedPixel();
             }
           }
         }
+      fah.PopFront();
       }
     }
 }
@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMorphologicalWatershedFromMarkersImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkRandomImageSource.h"
+#include "itkTestingComparisonImageFilter.h"
+#include "itkTestingMacros.h"
+
+/*
+ * Check that the hierarchical queues with buckets and with a std::map, and
+ * the different numbers of work units, produce the same watershed, on a
+ * random image with many plateaus.
+ */
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image< unsigned char, Dimension >;
+using LabelImageType = itk::Image< unsigned short, Dimension >;
+
+// Compute the watershed of the image, with its values scaled and shifted
+// in another pixel type.
+template< typename TPixel >
+LabelImageType::Pointer
+ComputeWatershed( const ImageType * image, TPixel scale, TPixel shift, const LabelImageType * markers,
+                  bool markWatershedLine, bool fullyConnected, unsigned int numberOfWorkUnits )
+{
+  using ScaledImageType = itk::Image< TPixel, Dimension >;
+  typename ScaledImageType::Pointer input = ScaledImageType::New();
+  input->SetRegions( image->GetLargestPossibleRegion() );
+  input->Allocate();
+  itk::ImageRegionConstIterator< ImageType > iIt( image, image->GetLargestPossibleRegion() );
+  itk::ImageRegionIterator< ScaledImageType > oIt( input, input->GetLargestPossibleRegion() );
+  for( ; !iIt.IsAtEnd(); ++iIt, ++oIt )
+    {
+    oIt.Set( static_cast< TPixel >( static_cast< TPixel >( iIt.Get() ) * scale + shift ) );
+    }
+
+  using FilterType = itk::MorphologicalWatershedFromMarkersImageFilter< ScaledImageType, LabelImageType >;
+  typename FilterType::Pointer filter = FilterType::New();
+  filter->SetInput( input );
+  filter->SetMarkerImage( markers );
+  filter->SetMarkWatershedLine( markWatershedLine );
+  filter->SetFullyConnected( fullyConnected );
+  filter->SetNumberOfWorkUnits( numberOfWorkUnits );
+  filter->Update();
+  return filter->GetOutput();
+}
+}
+
+int itkMorphologicalWatershedFromMarkersImageFilterTest2( int, char *[] )
+{
+  ImageType::SizeType size;
+  size[0] = 37;
+  size[1] = 29;
+  size[2] = 23;
+
+  // 15 gray levels, so that the image has many plateaus
+  using RandomSourceType = itk::RandomImageSource< ImageType >;
+  RandomSourceType::Pointer source = RandomSourceType::New();
+  source->SetSize( size );
+  source->SetMin( 0 );
+  source->SetMax( 15 );
+  source->SetNumberOfWorkUnits( 1 );
+  TRY_EXPECT_NO_EXCEPTION( source->Update() );
+  ImageType::Pointer image = source->GetOutput();
+
+  // markers with 6 labels on a sparse grid
+  LabelImageType::Pointer markers = LabelImageType::New();
+  markers->SetRegions( size );
+  markers->Allocate();
+  markers->FillBuffer( 0 );
+  unsigned short label = 0;
+  for( itk::ImageRegionIteratorWithIndex< LabelImageType > it( markers, markers->GetLargestPossibleRegion() );
+       !it.IsAtEnd(); ++it )
+    {
+    const LabelImageType::IndexType & index = it.GetIndex();
+    if( index[0] % 9 == 4 && index[1] % 7 == 3 && index[2] % 6 == 2 )
+      {
+      it.Set( static_cast< unsigned short >( 1 + label++ % 6 ) );
+      }
+    }
+
+  using ComparisonType = itk::Testing::ComparisonImageFilter< LabelImageType, LabelImageType >;
+  ComparisonType::Pointer comparison = ComparisonType::New();
+
+  for( bool markWatershedLine : { false, true } )
+    {
+    for( bool fullyConnected : { false, true } )
+      {
+      std::cout << "MarkWatershedLine: " << markWatershedLine
+                << " FullyConnected: " << fullyConnected << std::endl;
+
+      // bucket queue
+      LabelImageType::Pointer reference =
+        ComputeWatershed< unsigned char >( image, 1, 0, markers, markWatershedLine, fullyConnected, 1 );
+      comparison->SetValidInput( reference );
+
+      // the markers are kept
+      itk::ImageRegionConstIterator< LabelImageType > mIt( markers, markers->GetLargestPossibleRegion() );
+      itk::ImageRegionConstIterator< LabelImageType > rIt( reference, reference->GetLargestPossibleRegion() );
+      for( ; !mIt.IsAtEnd(); ++mIt, ++rIt )
+        {
+        if( mIt.Get() != 0 )
+          {
+          TEST_EXPECT_EQUAL( rIt.Get(), mIt.Get() );
+          }
+        }
+
+      // several work units for the first stage; the map queue for a
+      // floating point type and for a wide range of integral values; the
+      // largest bucket queue and the map queue just above it; the bucket
+      // queue for negative values
+      const LabelImageType::Pointer outputs[] = {
+        ComputeWatershed< unsigned char >( image, 1, 0, markers, markWatershedLine, fullyConnected, 5 ),
+        ComputeWatershed< float >( image, 0.5f, 0.25f, markers, markWatershedLine, fullyConnected, 3 ),
+        ComputeWatershed< int >( image, 1000000, -7000000, markers, markWatershedLine, fullyConnected, 3 ),
+        ComputeWatershed< int >( image, 4681, 0, markers, markWatershedLine, fullyConnected, 3 ),
+        ComputeWatershed< int >( image, 4682, 0, markers, markWatershedLine, fullyConnected, 3 ),
+        ComputeWatershed< short >( image, 3, -20, markers, markWatershedLine, fullyConnected, 2 ) };
+      for( const LabelImageType::Pointer & output : outputs )
+        {
+        comparison->SetTestInput( output );
+        TRY_EXPECT_NO_EXCEPTION( comparison->Update() );
+        TEST_EXPECT_EQUAL( comparison->GetNumberOfPixelsWithDifferences(), 0u );
+        }
+      }
+    }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
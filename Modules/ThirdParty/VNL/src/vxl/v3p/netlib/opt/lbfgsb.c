@@ -22,6 +22,7 @@ extern "C" {
 #undef max
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #define abs(x) ((x) >= 0 ? (x) : -(x))
 #define min(a,b) ((a) <= (b) ? (a) : (b))
 #define max(a,b) ((a) >= (b) ? (a) : (b))
@@ -54,6 +55,185 @@ static doublereal c_b280 = .001;
 static doublereal c_b281 = .9;
 static doublereal c_b282 = .1;
 
+/*
+    ITK: the vector operations on the n variables are split in chunks of
+    LBFGSB_CHUNK_SIZE variables when n is larger than one chunk. The chunks
+    are processed in parallel by the function set with
+    v3p_netlib_lbfgsb_set_parallelize(), if any. The partial sums of the
+    dot products are added in the order of the chunks, so that the results
+    do not depend on the parallelization. Smaller problems call the BLAS
+    routines as before.
+ */
+#define LBFGSB_CHUNK_SIZE 16384
+
+extern doublereal ddot_(integer *, doublereal *, integer *, doublereal *,
+        integer *);
+extern /* Subroutine */ int dcopy_(integer *, doublereal *, integer *,
+        doublereal *, integer *), dscal_(integer *, doublereal *,
+        doublereal *, integer *), daxpy_(integer *, doublereal *,
+        doublereal *, integer *, doublereal *, integer *);
+
+static v3p_netlib_lbfgsb_parallelize_t lbfgsb_parallelize = 0;
+static void *lbfgsb_parallelize_instance = 0;
+
+void v3p_netlib_lbfgsb_set_parallelize(
+  v3p_netlib_lbfgsb_parallelize_t parallelize, void *instance)
+{
+  lbfgsb_parallelize = parallelize;
+  lbfgsb_parallelize_instance = instance;
+}
+
+void v3p_netlib_lbfgsb_get_parallelize(
+  v3p_netlib_lbfgsb_parallelize_t *parallelize, void **instance)
+{
+  *parallelize = lbfgsb_parallelize;
+  *instance = lbfgsb_parallelize_instance;
+}
+
+enum {
+  LBFGSB_VECOP_COPY, /* y = x */
+  LBFGSB_VECOP_DOT,  /* partial = x . y */
+  LBFGSB_VECOP_SCAL, /* x *= a */
+  LBFGSB_VECOP_AXPY  /* y += a * x */
+};
+
+typedef struct {
+  int type;
+  integer n;
+  doublereal a;
+  doublereal *x;
+  doublereal *y;
+  doublereal *partial;
+} lbfgsb_vector_op;
+
+static void lbfgsb_vector_op_kernel(void *arg, integer chunk)
+{
+  lbfgsb_vector_op *op = (lbfgsb_vector_op *)arg;
+  const integer begin = chunk * LBFGSB_CHUNK_SIZE;
+  const integer end = min(begin + LBFGSB_CHUNK_SIZE, op->n);
+  doublereal sum = 0.;
+  integer i;
+
+  switch (op->type) {
+  case LBFGSB_VECOP_COPY:
+    for (i = begin; i < end; ++i) {
+      op->y[i] = op->x[i];
+    }
+    break;
+  case LBFGSB_VECOP_DOT:
+    for (i = begin; i < end; ++i) {
+      sum += op->x[i] * op->y[i];
+    }
+    op->partial[chunk] = sum;
+    break;
+  case LBFGSB_VECOP_SCAL:
+    for (i = begin; i < end; ++i) {
+      op->x[i] *= op->a;
+    }
+    break;
+  case LBFGSB_VECOP_AXPY:
+    for (i = begin; i < end; ++i) {
+      op->y[i] += op->a * op->x[i];
+    }
+    break;
+  }
+}
+
+/* Process the chunks of a vector operation, and return the sum of the
+   partial dot products in the order of the chunks. */
+static doublereal lbfgsb_vector_op_run(lbfgsb_vector_op *op)
+{
+  const integer number_of_chunks = (op->n + LBFGSB_CHUNK_SIZE - 1) / LBFGSB_CHUNK_SIZE;
+  doublereal result = 0.;
+  integer i;
+
+  if (op->type == LBFGSB_VECOP_DOT) {
+    op->partial = (doublereal *)malloc(number_of_chunks * sizeof(doublereal));
+  }
+  if (lbfgsb_parallelize != 0) {
+    lbfgsb_parallelize(lbfgsb_parallelize_instance, lbfgsb_vector_op_kernel, op,
+                       number_of_chunks);
+  } else {
+    for (i = 0; i < number_of_chunks; ++i) {
+      lbfgsb_vector_op_kernel(op, i);
+    }
+  }
+  if (op->type == LBFGSB_VECOP_DOT) {
+    for (i = 0; i < number_of_chunks; ++i) {
+      result += op->partial[i];
+    }
+    free(op->partial);
+  }
+  return result;
+}
+
+/* y = x, for contiguous vectors of n elements. */
+static void lbfgsb_dcopy(integer *n, doublereal *x, doublereal *y)
+{
+  lbfgsb_vector_op op;
+  if (*n <= LBFGSB_CHUNK_SIZE) {
+    dcopy_(n, x, &c__1, y, &c__1);
+    return;
+  }
+  op.type = LBFGSB_VECOP_COPY;
+  op.n = *n;
+  op.a = 0.;
+  op.x = x;
+  op.y = y;
+  op.partial = 0;
+  lbfgsb_vector_op_run(&op);
+}
+
+/* x . y, for contiguous vectors of n elements. */
+static doublereal lbfgsb_ddot(integer *n, doublereal *x, doublereal *y)
+{
+  lbfgsb_vector_op op;
+  if (*n <= LBFGSB_CHUNK_SIZE) {
+    return ddot_(n, x, &c__1, y, &c__1);
+  }
+  op.type = LBFGSB_VECOP_DOT;
+  op.n = *n;
+  op.a = 0.;
+  op.x = x;
+  op.y = y;
+  op.partial = 0;
+  return lbfgsb_vector_op_run(&op);
+}
+
+/* x *= a, for a contiguous vector of n elements. */
+static void lbfgsb_dscal(integer *n, doublereal *a, doublereal *x)
+{
+  lbfgsb_vector_op op;
+  if (*n <= LBFGSB_CHUNK_SIZE) {
+    dscal_(n, a, x, &c__1);
+    return;
+  }
+  op.type = LBFGSB_VECOP_SCAL;
+  op.n = *n;
+  op.a = *a;
+  op.x = x;
+  op.y = 0;
+  op.partial = 0;
+  lbfgsb_vector_op_run(&op);
+}
+
+/* y += a * x, for contiguous vectors of n elements. */
+static void lbfgsb_daxpy(integer *n, doublereal *a, doublereal *x, doublereal *y)
+{
+  lbfgsb_vector_op op;
+  if (*n <= LBFGSB_CHUNK_SIZE) {
+    daxpy_(n, a, x, &c__1, y, &c__1);
+    return;
+  }
+  op.type = LBFGSB_VECOP_AXPY;
+  op.n = *n;
+  op.a = *a;
+  op.x = x;
+  op.y = y;
+  op.partial = 0;
+  lbfgsb_vector_op_run(&op);
+}
+
 static doublereal epsilon1()
 {
   //Fortran code used intrinsic epsilon(1.) function
@@ -855,8 +1035,8 @@ extern doublereal dpmeps_()
         if (s_cmp(task, "STOP", (ftnlen)4, (ftnlen)4) == 0) {
             if (s_cmp(task + 6, "CPU", (ftnlen)3, (ftnlen)3) == 0) {
 /*                                          restore the previous iterate. */
-                dcopy_(n, &t[1], &c__1, &x[1], &c__1);
-                dcopy_(n, &r__[1], &c__1, &g[1], &c__1);
+                lbfgsb_dcopy(n, &t[1], &x[1]);
+                lbfgsb_dcopy(n, &r__[1], &g[1]);
                 *f = fold;
             }
             goto L999;
@@ -903,7 +1083,7 @@ L222:
 
     if (! cnstnd && col > 0) {
 /*                                            skip the search for GCP. */
-        dcopy_(n, &x[1], &c__1, &z__[1], &c__1);
+        lbfgsb_dcopy(n, &x[1], &z__[1]);
         wrk = updatd;
         nseg = 0;
         goto L333;
@@ -1034,8 +1214,8 @@ L666:
             csave, &isave[22], &dsave[17], (ftnlen)60, (ftnlen)60);
     if (info != 0 || iback >= 20) {
 /*          restore the previous iterate. */
-        dcopy_(n, &t[1], &c__1, &x[1], &c__1);
-        dcopy_(n, &r__[1], &c__1, &g[1], &c__1);
+        lbfgsb_dcopy(n, &t[1], &x[1]);
+        lbfgsb_dcopy(n, &r__[1], &g[1]);
         *f = fold;
         if (col == 0) {
 /*             abnormal termination. */
@@ -1112,13 +1292,13 @@ L777:
         r__[i__] = g[i__] - r__[i__];
 /* L42: */
     }
-    rr = ddot_(n, &r__[1], &c__1, &r__[1], &c__1);
+    rr = lbfgsb_ddot(n, &r__[1], &r__[1]);
     if (stp == 1.) {
         dr = gd - gdold;
         ddum = -gdold;
     } else {
         dr = (gd - gdold) * stp;
-        dscal_(n, &stp, &d__[1], &c__1);
+        lbfgsb_dscal(n, &stp, &d__[1]);
         ddum = -gdold * stp;
     }
     if (dr <= epsmch * ddum) {
@@ -1724,7 +1904,7 @@ L1000:
         if (*iprint >= 0) {
             printf("Subgnorm = 0.  GCP = X.\n");
         }
-        dcopy_(n, &x[1], &c__1, &xcp[1], &c__1);
+        lbfgsb_dcopy(n, &x[1], &xcp[1]);
         return 0;
     }
     bnded = TRUE_;
@@ -1829,7 +2009,7 @@ L1000:
         dscal_(col, theta, &p[*col + 1], &c__1);
     }
 /*     Initialize GCP xcp = x. */
-    dcopy_(n, &x[1], &c__1, &xcp[1], &c__1);
+    lbfgsb_dcopy(n, &x[1], &xcp[1]);
     if (nbreak == 0 && nfree == *n + 1) {
 /*                  is a zero vector, return with the initial xcp as GCP. */
         if (*iprint > 100) {
@@ -2011,7 +2191,7 @@ L888:
     tsum += dtm;
 /*     Move free variables (i.e., the ones w/o breakpoints) and */
 /*       the variables whose breakpoints haven't been reached. */
-    daxpy_(n, &tsum, &d__[1], &c__1, &xcp[1], &c__1);
+    lbfgsb_daxpy(n, &tsum, &d__[1], &xcp[1]);
 L999:
 /*     Update c = c + dtm*p = W'(x^c - x) */
 /*       which will be used in computing r = Z'(B(x^c - x) + g). */
@@ -2970,7 +3150,7 @@ L30:
     if (s_cmp(task, "FG_LN", (ftnlen)5, (ftnlen)5) == 0) {
         goto L556;
     }
-    *dtd = ddot_(n, &d__[1], &c__1, &d__[1], &c__1);
+    *dtd = lbfgsb_ddot(n, &d__[1], &d__[1]);
     *dnorm = sqrt(*dtd);
 /*     Determine the maximum step length. */
     *stpmx = 1e10;
@@ -3009,14 +3189,14 @@ L30:
     } else {
         *stp = 1.;
     }
-    dcopy_(n, &x[1], &c__1, &t[1], &c__1);
-    dcopy_(n, &g[1], &c__1, &r__[1], &c__1);
+    lbfgsb_dcopy(n, &x[1], &t[1]);
+    lbfgsb_dcopy(n, &g[1], &r__[1]);
     *fold = *f;
     *ifun = 0;
     *iback = 0;
     s_copy(csave, "START", (ftnlen)60, (ftnlen)(5+1));
 L556:
-    *gd = ddot_(n, &g[1], &c__1, &d__[1], &c__1);
+    *gd = lbfgsb_ddot(n, &g[1], &d__[1]);
     if (*ifun == 0) {
         *gdold = *gd;
         if (*gd >= 0.) {
@@ -3037,7 +3217,7 @@ L556:
         ++(*nfgv);
         *iback = *ifun - 1;
         if (*stp == 1.) {
-            dcopy_(n, &z__[1], &c__1, &x[1], &c__1);
+            lbfgsb_dcopy(n, &z__[1], &x[1]);
         } else {
             i__1 = *n;
             for (i__ = 1; i__ <= i__1; ++i__) {
@@ -3119,8 +3299,8 @@ L556:
         *head = *head % *m + 1;
     }
 /*     Update matrices WS and WY. */
-    dcopy_(n, &d__[1], &c__1, &ws[*itail * ws_dim1 + 1], &c__1);
-    dcopy_(n, &r__[1], &c__1, &wy[*itail * wy_dim1 + 1], &c__1);
+    lbfgsb_dcopy(n, &d__[1], &ws[*itail * ws_dim1 + 1]);
+    lbfgsb_dcopy(n, &r__[1], &wy[*itail * wy_dim1 + 1]);
 /*     Set theta=yy/ys. */
     *theta = *rr / *dr;
 /*     Form the middle matrix in B. */
@@ -3143,10 +3323,10 @@ L556:
     pointr = *head;
     i__1 = *col - 1;
     for (j = 1; j <= i__1; ++j) {
-        sy[*col + j * sy_dim1] = ddot_(n, &d__[1], &c__1, &wy[pointr *
-                wy_dim1 + 1], &c__1);
-        ss[j + *col * ss_dim1] = ddot_(n, &ws[pointr * ws_dim1 + 1], &c__1, &
-                d__[1], &c__1);
+        sy[*col + j * sy_dim1] = lbfgsb_ddot(n, &d__[1], &wy[pointr *
+                wy_dim1 + 1]);
+        ss[j + *col * ss_dim1] = lbfgsb_ddot(n, &ws[pointr * ws_dim1 + 1], &
+                d__[1]);
         pointr = pointr % *m + 1;
 /* L51: */
     }
@@ -3937,7 +4117,7 @@ L999:
 /* ----------------------------------------------------------------- */
 /*     Let us try the projection, d is the Newton direction */
     *iword = 0;
-    dcopy_(n, &x[1], &c__1, &xp[1], &c__1);
+    lbfgsb_dcopy(n, &x[1], &xp[1]);
 
     i__1 = *nsub;
     for (i__ = 1; i__ <= i__1; ++i__) {
@@ -4001,7 +4181,7 @@ L999:
 /* L55: */
     }
     if (dd_p__ > 0.) {
-        dcopy_(n, &xp[1], &c__1, &x[1], &c__1);
+        lbfgsb_dcopy(n, &xp[1], &x[1]);
         if (*iprint > 0) {
             printf(" Positive dir derivative in projection ");
             printf(" Using the backtracking step ");
@@ -1,3 +1,32 @@
+/*
+ * ITK: the vector operations of setulb on the n variables are split in
+ * chunks when n is large. The chunks of a vector operation are processed by
+ * calling kernel(arg, i) for each i in [0, number_of_chunks), and can be
+ * processed concurrently. The results do not depend on how the chunks are
+ * processed.
+ */
+typedef void (*v3p_netlib_lbfgsb_kernel_t)(void *arg, v3p_netlib_integer chunk);
+
+/*
+ * Function processing the chunks of a vector operation: it must call
+ * kernel(arg, i) once for each i in [0, number_of_chunks), in any order and
+ * possibly concurrently, and return once all the calls returned.
+ */
+typedef void (*v3p_netlib_lbfgsb_parallelize_t)(void *instance,
+  v3p_netlib_lbfgsb_kernel_t kernel, void *arg,
+  v3p_netlib_integer number_of_chunks);
+
+/*
+ * Set the function processing the chunks of the vector operations of the
+ * following calls to setulb, and the instance passed to it. Like setulb,
+ * which keeps its state in static variables, it is not thread safe. A null
+ * function processes the chunks sequentially.
+ */
+extern void v3p_netlib_lbfgsb_set_parallelize(
+  v3p_netlib_lbfgsb_parallelize_t parallelize, void *instance);
+extern void v3p_netlib_lbfgsb_get_parallelize(
+  v3p_netlib_lbfgsb_parallelize_t *parallelize, void **instance);
+
 extern int v3p_netlib_setulb_(
   v3p_netlib_integer v3p_netlib_const *n, /* dimension of the problem */
   v3p_netlib_integer v3p_netlib_const *m, /* max num of metric corrections */
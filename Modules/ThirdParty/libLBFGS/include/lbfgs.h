@@ -193,6 +193,36 @@ enum {
     LBFGS_LINESEARCH_BACKTRACKING_STRONG_WOLFE = 3,
 };
 
+/**
+ * Kernel processing one chunk of a vector operation.
+ *
+ *  @param  arg         The data of the vector operation.
+ *  @param  chunk       The index of the chunk to process.
+ */
+typedef void (*lbfgs_kernel_t)(void *arg, int chunk);
+
+/**
+ * Callback interface to execute the vector operations in parallel.
+ *
+ *  The vector operations of large problems are split in chunks of a fixed
+ *  size, and their reductions are summed in the order of the chunks, so that
+ *  the results do not depend on how the chunks are distributed. This
+ *  function must call kernel(arg, i) once for each i in
+ *  [0, number_of_chunks), in any order and possibly concurrently, and return
+ *  once all the calls returned.
+ *
+ *  @param  instance    The user data sent for lbfgs() function by the client.
+ *  @param  kernel      The kernel processing one chunk.
+ *  @param  arg         The argument to pass to the kernel.
+ *  @param  number_of_chunks    The number of chunks.
+ */
+typedef void (*lbfgs_parallelize_t)(
+    void *instance,
+    lbfgs_kernel_t kernel,
+    void *arg,
+    int number_of_chunks
+    );
+
 /**
  * L-BFGS optimization parameters.
  *  Call lbfgs_parameter_init() function to initialize parameters to the
@@ -358,6 +388,15 @@ typedef struct {
      *  L1 norm of the variables x,
      */
     int             orthantwise_end;
+
+    /**
+     * Callback to execute the vector operations in parallel.
+     *  The vector operations of problems with many variables are split in
+     *  chunks, and passed to this callback with the instance argument of
+     *  lbfgs(). See ::lbfgs_parallelize_t. The default value is \c NULL,
+     *  which processes the chunks sequentially.
+     */
+    lbfgs_parallelize_t parallelize;
 } lbfgs_parameter_t;
 
 
@@ -94,11 +94,51 @@ licence.
 #define max2(a, b)      ((a) >= (b) ? (a) : (b))
 #define max3(a, b, c)   max2(max2((a), (b)), (c));
 
+/*
+    ITK: the O(n) vector operations of the main loop and of the line
+    searches are split in chunks of LBFGS_CHUNK_SIZE variables, which are
+    processed in parallel by lbfgs_parameter_t::parallelize when it is set.
+    The partial sums of the reductions are added in the order of the chunks,
+    so that the results do not depend on the parallelization. Operations
+    reading the same vectors one after the other are fused in a single pass.
+ */
+#define LBFGS_CHUNK_SIZE    16384
+
+enum {
+    VECOP_COPY2,        /* a = x; b = y. */
+    VECOP_NCOPY_DOT,    /* a = -x; r0 = y . a. */
+    VECOP_DOT2,         /* r0 = x . y; r1 = z . w. */
+    VECOP_AXPY,         /* a = x + c * y. */
+    VECOP_ADD_DOT,      /* a += c * x; r0 = y . a. */
+    VECOP_SCALE_DOT,    /* a *= c; r0 = y . a. */
+    VECOP_DIFF2_DOT2    /* a = x - y; b = z - w; r0 = b . a; r1 = b . b. */
+};
+
+struct tag_vector_workspace {
+    int n;
+    int number_of_chunks;
+    lbfgsfloatval_t *partial;   /* [2 * number_of_chunks] */
+    void *instance;
+    lbfgs_parallelize_t parallelize;
+};
+typedef struct tag_vector_workspace vector_workspace_t;
+
+struct tag_vector_op {
+    int type;
+    int n;
+    lbfgsfloatval_t *a, *b;
+    const lbfgsfloatval_t *x, *y, *z, *w;
+    lbfgsfloatval_t c;
+    lbfgsfloatval_t *partial;
+};
+typedef struct tag_vector_op vector_op_t;
+
 struct tag_callback_data {
     int n;
     void *instance;
     lbfgs_evaluate_t proc_evaluate;
     lbfgs_progress_t proc_progress;
+    const vector_workspace_t *ws;
 };
 typedef struct tag_callback_data callback_data_t;
 
@@ -114,9 +154,234 @@ static const lbfgs_parameter_t _defparam = {
     6, 1e-5, 0, 1e-5,
     0, LBFGS_LINESEARCH_DEFAULT, 40,
     1e-20, 1e20, 1e-4, 0.9, 0.9, 1.0e-16,
-    0.0, 0, -1,
+    0.0, 0, -1, NULL,
 };
 
+static void vector_op_kernel(void *arg, int chunk)
+{
+    vector_op_t *op = (vector_op_t*)arg;
+    const int begin = chunk * LBFGS_CHUNK_SIZE;
+    const int end = min2(begin + LBFGS_CHUNK_SIZE, op->n);
+    lbfgsfloatval_t r0 = 0., r1 = 0.;
+    int i;
+
+    switch (op->type) {
+    case VECOP_COPY2:
+        for (i = begin;i < end;++i) {
+            op->a[i] = op->x[i];
+            op->b[i] = op->y[i];
+        }
+        break;
+    case VECOP_NCOPY_DOT:
+        if (op->y != NULL) {
+            for (i = begin;i < end;++i) {
+                op->a[i] = -op->x[i];
+                r0 += op->y[i] * op->a[i];
+            }
+        } else {
+            for (i = begin;i < end;++i) {
+                op->a[i] = -op->x[i];
+            }
+        }
+        break;
+    case VECOP_DOT2:
+        for (i = begin;i < end;++i) {
+            r0 += op->x[i] * op->y[i];
+        }
+        if (op->z != NULL) {
+            for (i = begin;i < end;++i) {
+                r1 += op->z[i] * op->w[i];
+            }
+        }
+        break;
+    case VECOP_AXPY:
+        for (i = begin;i < end;++i) {
+            op->a[i] = op->x[i] + op->c * op->y[i];
+        }
+        break;
+    case VECOP_ADD_DOT:
+        if (op->y != NULL) {
+            for (i = begin;i < end;++i) {
+                op->a[i] += op->c * op->x[i];
+                r0 += op->y[i] * op->a[i];
+            }
+        } else {
+            for (i = begin;i < end;++i) {
+                op->a[i] += op->c * op->x[i];
+            }
+        }
+        break;
+    case VECOP_SCALE_DOT:
+        for (i = begin;i < end;++i) {
+            op->a[i] *= op->c;
+            r0 += op->y[i] * op->a[i];
+        }
+        break;
+    case VECOP_DIFF2_DOT2:
+        for (i = begin;i < end;++i) {
+            op->a[i] = op->x[i] - op->y[i];
+            op->b[i] = op->z[i] - op->w[i];
+            r0 += op->b[i] * op->a[i];
+            r1 += op->b[i] * op->b[i];
+        }
+        break;
+    }
+
+    op->partial[2 * chunk] = r0;
+    op->partial[2 * chunk + 1] = r1;
+}
+
+static void vector_op_run(
+    const vector_workspace_t *ws,
+    vector_op_t *op,
+    lbfgsfloatval_t *r0,
+    lbfgsfloatval_t *r1
+    )
+{
+    int i;
+
+    op->n = ws->n;
+    op->partial = ws->partial;
+    if (ws->parallelize != NULL && 1 < ws->number_of_chunks) {
+        ws->parallelize(ws->instance, vector_op_kernel, op, ws->number_of_chunks);
+    } else {
+        for (i = 0;i < ws->number_of_chunks;++i) {
+            vector_op_kernel(op, i);
+        }
+    }
+
+    /* Sum the partial results in the order of the chunks. */
+    if (r0 != NULL) {
+        *r0 = ws->partial[0];
+        for (i = 1;i < ws->number_of_chunks;++i) {
+            *r0 += ws->partial[2 * i];
+        }
+    }
+    if (r1 != NULL) {
+        *r1 = ws->partial[1];
+        for (i = 1;i < ws->number_of_chunks;++i) {
+            *r1 += ws->partial[2 * i + 1];
+        }
+    }
+}
+
+/* a = x; b = y. */
+static void pveccpy2(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *a, const lbfgsfloatval_t *x,
+    lbfgsfloatval_t *b, const lbfgsfloatval_t *y
+    )
+{
+    vector_op_t op = {0};
+    op.type = VECOP_COPY2;
+    op.a = a; op.x = x;
+    op.b = b; op.y = y;
+    vector_op_run(ws, &op, NULL, NULL);
+}
+
+/* a = -x; returns y . a, or zero if y is NULL. */
+static lbfgsfloatval_t pvecncpydot(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *a, const lbfgsfloatval_t *x,
+    const lbfgsfloatval_t *y
+    )
+{
+    lbfgsfloatval_t r0;
+    vector_op_t op = {0};
+    op.type = VECOP_NCOPY_DOT;
+    op.a = a; op.x = x; op.y = y;
+    vector_op_run(ws, &op, &r0, NULL);
+    return r0;
+}
+
+/* Returns x . y. */
+static lbfgsfloatval_t pvecdot(
+    const vector_workspace_t *ws,
+    const lbfgsfloatval_t *x, const lbfgsfloatval_t *y
+    )
+{
+    lbfgsfloatval_t r0;
+    vector_op_t op = {0};
+    op.type = VECOP_DOT2;
+    op.x = x; op.y = y;
+    vector_op_run(ws, &op, &r0, NULL);
+    return r0;
+}
+
+/* Euclidean norms of x and z. */
+static void pvec2norm2(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *xnorm, const lbfgsfloatval_t *x,
+    lbfgsfloatval_t *znorm, const lbfgsfloatval_t *z
+    )
+{
+    vector_op_t op = {0};
+    op.type = VECOP_DOT2;
+    op.x = x; op.y = x;
+    op.z = z; op.w = z;
+    vector_op_run(ws, &op, xnorm, znorm);
+    *xnorm = (lbfgsfloatval_t)sqrt(*xnorm);
+    *znorm = (lbfgsfloatval_t)sqrt(*znorm);
+}
+
+/* a = x + c * y. */
+static void pvecaxpy(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *a, const lbfgsfloatval_t *x,
+    const lbfgsfloatval_t c, const lbfgsfloatval_t *y
+    )
+{
+    vector_op_t op = {0};
+    op.type = VECOP_AXPY;
+    op.a = a; op.x = x; op.c = c; op.y = y;
+    vector_op_run(ws, &op, NULL, NULL);
+}
+
+/* a += c * x; returns y . a, or zero if y is NULL. */
+static lbfgsfloatval_t pvecadddot(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *a, const lbfgsfloatval_t *x, const lbfgsfloatval_t c,
+    const lbfgsfloatval_t *y
+    )
+{
+    lbfgsfloatval_t r0;
+    vector_op_t op = {0};
+    op.type = VECOP_ADD_DOT;
+    op.a = a; op.x = x; op.c = c; op.y = y;
+    vector_op_run(ws, &op, &r0, NULL);
+    return r0;
+}
+
+/* a *= c; returns y . a. */
+static lbfgsfloatval_t pvecscaledot(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *a, const lbfgsfloatval_t c,
+    const lbfgsfloatval_t *y
+    )
+{
+    lbfgsfloatval_t r0;
+    vector_op_t op = {0};
+    op.type = VECOP_SCALE_DOT;
+    op.a = a; op.c = c; op.y = y;
+    vector_op_run(ws, &op, &r0, NULL);
+    return r0;
+}
+
+/* s = x - xp; y = g - gp; ys = y . s; yy = y . y. */
+static void pvecdiff2dot2(
+    const vector_workspace_t *ws,
+    lbfgsfloatval_t *s, const lbfgsfloatval_t *x, const lbfgsfloatval_t *xp,
+    lbfgsfloatval_t *y, const lbfgsfloatval_t *g, const lbfgsfloatval_t *gp,
+    lbfgsfloatval_t *ys, lbfgsfloatval_t *yy
+    )
+{
+    vector_op_t op = {0};
+    op.type = VECOP_DIFF2_DOT2;
+    op.a = s; op.x = x; op.y = xp;
+    op.b = y; op.z = g; op.w = gp;
+    vector_op_run(ws, &op, ys, yy);
+}
+
 /* Forward function declarations. */
 
 typedef int (*line_search_proc)(
@@ -263,9 +528,12 @@ int lbfgs(
     lbfgsfloatval_t *xp = NULL;
     lbfgsfloatval_t *g = NULL, *gp = NULL, *pg = NULL;
     lbfgsfloatval_t *d = NULL, *w = NULL, *pf = NULL;
+    lbfgsfloatval_t *lmsy = NULL;
     iteration_data_t *lm = NULL, *it = NULL;
-    lbfgsfloatval_t ys, yy;
+    lbfgsfloatval_t ys, yy, dot;
     lbfgsfloatval_t xnorm, gnorm, beta;
+    const lbfgsfloatval_t *next;
+    vector_workspace_t ws;
     lbfgsfloatval_t fx = 0.;
     lbfgsfloatval_t rate = 0.;
     line_search_proc linesearch = line_search_morethuente;
@@ -276,6 +544,8 @@ int lbfgs(
     cd.instance = instance;
     cd.proc_evaluate = proc_evaluate;
     cd.proc_progress = proc_progress;
+    cd.ws = &ws;
+    ws.partial = NULL;
 
 #if     defined(USE_SSE) && (defined(__SSE__) || defined(__SSE2__))
     /* Round out the number of variables. */
@@ -374,6 +644,17 @@ int lbfgs(
         goto lbfgs_exit;
     }
 
+    /* Set up the chunks of the vector operations. */
+    ws.n = n;
+    ws.number_of_chunks = (n + LBFGS_CHUNK_SIZE - 1) / LBFGS_CHUNK_SIZE;
+    ws.partial = (lbfgsfloatval_t*)vecalloc(2 * ws.number_of_chunks * sizeof(lbfgsfloatval_t));
+    ws.instance = instance;
+    ws.parallelize = param.parallelize;
+    if (ws.partial == NULL) {
+        ret = LBFGSERR_OUTOFMEMORY;
+        goto lbfgs_exit;
+    }
+
     if (param.orthantwise_c != 0.) {
         /* Allocate working space for OW-LQN. */
         pg = (lbfgsfloatval_t*)vecalloc(n * sizeof(lbfgsfloatval_t));
@@ -390,17 +671,18 @@ int lbfgs(
         goto lbfgs_exit;
     }
 
-    /* Initialize the limited memory. */
+    /* Initialize the limited memory, stored in a single block. */
+    lmsy = (lbfgsfloatval_t*)vecalloc((size_t)2 * m * n * sizeof(lbfgsfloatval_t));
+    if (lmsy == NULL) {
+        ret = LBFGSERR_OUTOFMEMORY;
+        goto lbfgs_exit;
+    }
     for (i = 0;i < m;++i) {
         it = &lm[i];
         it->alpha = 0;
         it->ys = 0;
-        it->s = (lbfgsfloatval_t*)vecalloc(n * sizeof(lbfgsfloatval_t));
-        it->y = (lbfgsfloatval_t*)vecalloc(n * sizeof(lbfgsfloatval_t));
-        if (it->s == NULL || it->y == NULL) {
-            ret = LBFGSERR_OUTOFMEMORY;
-            goto lbfgs_exit;
-        }
+        it->s = lmsy + (size_t)2 * i * n;
+        it->y = it->s + n;
     }
 
     /* Allocate an array for storing previous values of the objective function. */
@@ -429,21 +711,12 @@ int lbfgs(
         Compute the direction;
         we assume the initial hessian matrix H_0 as the identity matrix.
      */
-    if (param.orthantwise_c == 0.) {
-        vecncpy(d, g, n);
-    } else {
-        vecncpy(d, pg, n);
-    }
+    pvecncpydot(&ws, d, (param.orthantwise_c == 0.) ? g : pg, NULL);
 
     /*
        Make sure that the initial variables are not a minimizer.
      */
-    vec2norm(&xnorm, x, n);
-    if (param.orthantwise_c == 0.) {
-        vec2norm(&gnorm, g, n);
-    } else {
-        vec2norm(&gnorm, pg, n);
-    }
+    pvec2norm2(&ws, &xnorm, x, &gnorm, (param.orthantwise_c == 0.) ? g : pg);
     if (xnorm < 1.0) xnorm = 1.0;
     if (gnorm / xnorm <= param.epsilon) {
         ret = LBFGS_ALREADY_MINIMIZED;
@@ -453,14 +726,13 @@ int lbfgs(
     /* Compute the initial step:
         step = 1.0 / sqrt(vecdot(d, d, n))
      */
-    vec2norminv(&step, d, n);
+    step = (lbfgsfloatval_t)(1.0 / sqrt(pvecdot(&ws, d, d)));
 
     k = 1;
     end = 0;
     for (;;) {
         /* Store the current position and gradient vectors. */
-        veccpy(xp, x, n);
-        veccpy(gp, g, n);
+        pveccpy2(&ws, xp, x, gp, g);
 
         /* Search for an optimal step. */
         if (param.orthantwise_c == 0.) {
@@ -474,19 +746,13 @@ int lbfgs(
         }
         if (ls < 0) {
             /* Revert to the previous point. */
-            veccpy(x, xp, n);
-            veccpy(g, gp, n);
+            pveccpy2(&ws, x, xp, g, gp);
             ret = ls;
             goto lbfgs_exit;
         }
 
         /* Compute x and g norms. */
-        vec2norm(&xnorm, x, n);
-        if (param.orthantwise_c == 0.) {
-            vec2norm(&gnorm, g, n);
-        } else {
-            vec2norm(&gnorm, pg, n);
-        }
+        pvec2norm2(&ws, &xnorm, x, &gnorm, (param.orthantwise_c == 0.) ? g : pg);
 
         /* Report the progress. */
         if (cd.proc_progress) {
@@ -541,17 +807,14 @@ int lbfgs(
                 y_{k+1} = g_{k+1} - g_{k}.
          */
         it = &lm[end];
-        vecdiff(it->s, x, xp, n);
-        vecdiff(it->y, g, gp, n);
 
         /*
-            Compute scalars ys and yy:
+            Compute scalars ys and yy along with s and y:
                 ys = y^t \cdot s = 1 / \rho.
                 yy = y^t \cdot y.
             Notice that yy is used for scaling the hessian matrix H_0 (Cholesky factor).
          */
-        vecdot(&ys, it->y, it->s, n);
-        vecdot(&yy, it->y, it->y, n);
+        pvecdiff2dot2(&ws, it->s, x, xp, it->y, g, gp, &ys, &yy);
         it->ys = ys;
 
         /*
@@ -566,35 +829,40 @@ int lbfgs(
         ++k;
         end = (end + 1) % m;
 
-        /* Compute the steepest direction. */
-        if (param.orthantwise_c == 0.) {
-            /* Compute the negative of gradients. */
-            vecncpy(d, g, n);
-        } else {
-            vecncpy(d, pg, n);
-        }
+        /*
+            Each update of the direction is fused with the dot product
+            needed by the next update: dot holds the dot product of the
+            current direction with s_{j} (first loop) or y_{j} (second loop).
+         */
+        j = (end + m - 1) % m;
+
+        /* Compute the steepest direction (the negative of gradients). */
+        dot = pvecncpydot(&ws, d, (param.orthantwise_c == 0.) ? g : pg, lm[j].s);
 
-        j = end;
         for (i = 0;i < bound;++i) {
-            j = (j + m - 1) % m;    /* if (--j == -1) j = m-1; */
             it = &lm[j];
             /* \alpha_{j} = \rho_{j} s^{t}_{j} \cdot q_{k+1}. */
-            vecdot(&it->alpha, it->s, d, n);
-            it->alpha /= it->ys;
+            it->alpha = dot / it->ys;
+            if (i + 1 < bound) {
+                j = (j + m - 1) % m;    /* if (--j == -1) j = m-1; */
+                next = lm[j].s;
+            } else {
+                next = NULL;
+            }
             /* q_{i} = q_{i+1} - \alpha_{i} y_{i}. */
-            vecadd(d, it->y, -it->alpha, n);
+            dot = pvecadddot(&ws, d, it->y, -it->alpha, next);
         }
 
-        vecscale(d, ys / yy, n);
+        dot = pvecscaledot(&ws, d, ys / yy, lm[j].y);
 
         for (i = 0;i < bound;++i) {
             it = &lm[j];
             /* \beta_{j} = \rho_{j} y^t_{j} \cdot \gamma_{i}. */
-            vecdot(&beta, it->y, d, n);
-            beta /= it->ys;
-            /* \gamma_{i+1} = \gamma_{i} + (\alpha_{j} - \beta_{j}) s_{j}. */
-            vecadd(d, it->s, it->alpha - beta, n);
+            beta = dot / it->ys;
             j = (j + 1) % m;        /* if (++j == m) j = 0; */
+            next = (i + 1 < bound) ? lm[j].y : NULL;
+            /* \gamma_{i+1} = \gamma_{i} + (\alpha_{j} - \beta_{j}) s_{j}. */
+            dot = pvecadddot(&ws, d, it->s, it->alpha - beta, next);
         }
 
         /*
@@ -623,13 +891,9 @@ lbfgs_exit:
     vecfree(pf);
 
     /* Free memory blocks used by this function. */
-    if (lm != NULL) {
-        for (i = 0;i < m;++i) {
-            vecfree(lm[i].s);
-            vecfree(lm[i].y);
-        }
-        vecfree(lm);
-    }
+    vecfree(lmsy);
+    vecfree(lm);
+    vecfree(ws.partial);
     vecfree(pg);
     vecfree(w);
     vecfree(d);
@@ -667,7 +931,7 @@ static int line_search_backtracking(
     }
 
     /* Compute the initial gradient in the search direction. */
-    vecdot(&dginit, g, s, n);
+    dginit = pvecdot(cd->ws, g, s);
 
     /* Make sure that s points to a descent direction. */
     if (0 < dginit) {
@@ -679,8 +943,7 @@ static int line_search_backtracking(
     dgtest = param->ftol * dginit;
 
     for (;;) {
-        veccpy(x, xp, n);
-        vecadd(x, s, *stp, n);
+        pvecaxpy(cd->ws, x, xp, *stp, s);
 
         /* Evaluate the function and gradient values. */
         *f = cd->proc_evaluate(cd->instance, x, g, cd->n, *stp);
@@ -697,7 +960,7 @@ static int line_search_backtracking(
 	        }
 
 	        /* Check the Wolfe condition. */
-	        vecdot(&dg, g, s, n);
+	        dg = pvecdot(cd->ws, g, s);
 	        if (dg < param->wolfe * dginit) {
     		    width = inc;
 	        } else {
@@ -839,7 +1102,7 @@ static int line_search_morethuente(
     }
 
     /* Compute the initial gradient in the search direction. */
-    vecdot(&dginit, g, s, n);
+    dginit = pvecdot(cd->ws, g, s);
 
     /* Make sure that s points to a descent direction. */
     if (0 < dginit) {
@@ -896,12 +1159,11 @@ static int line_search_morethuente(
             Compute the current value of x:
                 x <- x + (*stp) * s.
          */
-        veccpy(x, xp, n);
-        vecadd(x, s, *stp, n);
+        pvecaxpy(cd->ws, x, xp, *stp, s);
 
         /* Evaluate the function and gradient values. */
         *f = cd->proc_evaluate(cd->instance, x, g, cd->n, *stp);
-        vecdot(&dg, g, s, n);
+        dg = pvecdot(cd->ws, g, s);
 
         ftest1 = finit + *stp * dgtest;
         ++count;